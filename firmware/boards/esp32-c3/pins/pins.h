@@ -144,6 +144,7 @@
 #define HAS_CAMERA              0     // No built-in camera
 #define HAS_MICROPHONE          0     // No built-in microphone
 #define HAS_SD_CARD             0     // No built-in SD slot
+#define HAS_SD_MMC              0     // No SDMMC host on the ESP32-C3
 #define HAS_PSRAM               0     // No PSRAM
 #define HAS_USB_CDC             1
 #define HAS_WIFI                1
@@ -96,6 +96,24 @@
 #define SD_SPI_FREQ_FAST        4000000   // 4 MHz normal operation
 #define SD_SPI_FREQ_SLOW        1000000   // 1 MHz for init/recovery
 
+// ============================================================================
+// SD CARD (SDMMC MODE)
+// ============================================================================
+
+// Same slot on the SDMMC host through the GPIO matrix. D1/D2 are not
+// wired, so this board is 1-bit only.
+#define SD_MMC_PIN_CLK          7     // = SD_PIN_SCK
+#define SD_MMC_PIN_CMD          9     // = SD_PIN_MOSI
+#define SD_MMC_PIN_D0           8     // = SD_PIN_MISO
+#define SD_MMC_PIN_D1           (-1)  // Not connected
+#define SD_MMC_PIN_D2           (-1)  // Not connected
+#define SD_MMC_PIN_D3           21    // = SD_PIN_CS, held high (low selects SPI)
+#define SD_MMC_BUS_WIDTH        1
+#define SD_MMC_FREQ_KHZ         20000 // Default speed
+
+// Bus mounted first (0 = SPI, 1 = SDMMC); SDMMC falls back to SPI
+#define SD_BUS_DEFAULT          1
+
 // ============================================================================
 // UART (GNSS/GPS MODULE)
 // ============================================================================
@@ -198,6 +216,7 @@
 #define HAS_CAMERA              1
 #define HAS_MICROPHONE          1
 #define HAS_SD_CARD             1
+#define HAS_SD_MMC              1     // 1-bit SDMMC on the SD slot
 #define HAS_PSRAM               1
 #define HAS_USB_CDC             1
 #define HAS_WIFI                1
@@ -0,0 +1,373 @@
+/*
+ * SecuraCV Canary — Host Microbenchmarks (pio run -e native)
+ *
+ * Times the shared common/ modules the firmware's hot paths are built
+ * from, on the build machine instead of a board: CBOR encode/decode, the
+ * byte rings, the GNSS parser, and witness record hashing (payload hash,
+ * chain hash, Merkle leaf). Each case runs in doubling batches until it
+ * has taken at least --time-ms, then reports ns/op, ops/s and bytes/s.
+ *
+ * Absolute numbers are the host's, not the ESP32-S3's; the point is the
+ * ratio between two builds of the same code. --save writes the ops/s of
+ * every case to a baseline file, and --baseline compares a later run
+ * against it and exits non-zero when a case is slower than --tolerance.
+ *
+ *   pio run -e native && .pio/build/native/program --save bench.txt
+ *   ... change code ...
+ *   pio run -e native && .pio/build/native/program --baseline bench.txt
+ *
+ * Copyright (c) 2026 ERRERlabs / Karl May
+ * License: Apache-2.0
+ */
+
+#define GNSS_PARSER_IMPLEMENTATION
+#include "common/gnss/gnss_parser.h"
+#include "common/encoding/cbor.h"
+#include "common/encoding/cbor_reader.h"
+#include "common/core/ring_buffer.h"
+#include "common/core/spsc_ring.h"
+#include "common/witness/witness_chain.h"
+#include "common/hal/hal.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+// ════════════════════════════════════════════════════════════════════════════
+// HARNESS
+// ════════════════════════════════════════════════════════════════════════════
+
+struct BenchResult {
+  std::string name;
+  double ns_per_op;
+  double ops_per_s;
+  double bytes_per_s;
+};
+
+struct BenchOptions {
+  const char* filter = nullptr;
+  uint32_t time_ms = 250;
+  const char* save = nullptr;
+  const char* baseline = nullptr;
+  double tolerance_pct = 10.0;
+};
+
+static BenchOptions s_opts;
+static std::vector<BenchResult> s_results;
+
+// Results are folded in here so the compiler cannot drop the work
+static volatile uint32_t s_sink = 0;
+
+// fn(iterations) runs the operation that many times; bytes_per_op is the
+// payload it moves (0 for cases where a byte rate means nothing)
+template <typename Fn>
+static void bench(const char* name, size_t bytes_per_op, Fn fn) {
+  if (s_opts.filter && !strstr(name, s_opts.filter)) return;
+
+  using clock = std::chrono::steady_clock;
+  fn(16);  // Warm caches and branch predictors
+
+  uint64_t iters = 64;
+  uint64_t total_iters = 0;
+  double total_ns = 0;
+  while (total_ns < s_opts.time_ms * 1e6) {
+    auto t0 = clock::now();
+    fn(iters);
+    double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - t0).count();
+    total_iters += iters;
+    total_ns += ns;
+    if (ns < s_opts.time_ms * 1e6 / 4) iters *= 2;
+  }
+
+  BenchResult r;
+  r.name = name;
+  r.ns_per_op = total_ns / total_iters;
+  r.ops_per_s = 1e9 / r.ns_per_op;
+  r.bytes_per_s = bytes_per_op ? r.ops_per_s * bytes_per_op : 0;
+  s_results.push_back(r);
+
+  char rate[32] = "-";
+  if (r.bytes_per_s > 0) snprintf(rate, sizeof(rate), "%.1f MB/s", r.bytes_per_s / 1e6);
+  printf("%-28s %12.1f ns/op %14.0f ops/s %14s\n", name, r.ns_per_op, r.ops_per_s, rate);
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// FIXTURES
+// ════════════════════════════════════════════════════════════════════════════
+
+// Witness payload in the shape the firmware signs: small map with a
+// fix, a time bucket and a short event string
+static size_t encode_witness_payload(uint8_t* buf, size_t cap, uint32_t seq) {
+  cbor_writer_t w;
+  cbor_init(&w, buf, cap);
+  cbor_write_map(&w, 7);
+  cbor_write_tstr(&w, "v");
+  cbor_write_uint(&w, 1);
+  cbor_write_tstr(&w, "seq");
+  cbor_write_uint(&w, seq);
+  cbor_write_tstr(&w, "tb");
+  cbor_write_uint(&w, 1760400000u / 300);
+  cbor_write_tstr(&w, "type");
+  cbor_write_tstr(&w, "gnss_fix");
+  cbor_write_tstr(&w, "lat");
+  cbor_write_float(&w, 47.6062095);
+  cbor_write_tstr(&w, "lon");
+  cbor_write_float(&w, -122.3320708);
+  cbor_write_tstr(&w, "sats");
+  cbor_write_array(&w, 3);
+  cbor_write_uint(&w, 9);
+  cbor_write_float(&w, 1.2);
+  cbor_write_bool(&w, true);
+  return cbor_has_error(&w) ? 0 : cbor_size(&w);
+}
+
+static void nmea_append(std::string& out, const char* body) {
+  uint8_t sum = 0;
+  for (const char* p = body; *p; p++) sum ^= (uint8_t)*p;
+  char tail[8];
+  snprintf(tail, sizeof(tail), "*%02X\r\n", sum);
+  out += '$';
+  out += body;
+  out += tail;
+}
+
+// One second of output from a typical 1 Hz receiver
+static std::string nmea_epoch() {
+  std::string s;
+  nmea_append(s, "GPRMC,123519.00,A,4736.37257,N,12219.92425,W,0.022,,141026,,,A");
+  nmea_append(s, "GPVTG,,T,,M,0.022,N,0.041,K,A");
+  nmea_append(s, "GPGGA,123519.00,4736.37257,N,12219.92425,W,1,09,1.02,56.3,M,-17.4,M,,");
+  nmea_append(s, "GPGSA,A,3,02,05,12,13,15,18,20,25,29,,,,1.85,1.02,1.54");
+  nmea_append(s, "GPGSV,3,1,11,02,40,083,42,05,55,295,44,12,18,041,35,13,66,176,45");
+  nmea_append(s, "GPGSV,3,2,11,15,21,232,38,18,07,318,29,20,31,147,40,25,47,058,43");
+  nmea_append(s, "GPGSV,3,3,11,29,38,263,41,31,02,192,,46,35,200,");
+  nmea_append(s, "GPGLL,4736.37257,N,12219.92425,W,123519.00,A,A");
+  return s;
+}
+
+// Mirrors compute_chain_hash() in lib/securacv_crypto
+static void chain_hash(const uint8_t prev[32], const uint8_t payload_hash[32],
+                       uint32_t seq, uint32_t time_bucket, uint8_t out[32]) {
+  uint8_t buf[32 + 32 + 4 + 4];
+  memcpy(buf, prev, 32);
+  memcpy(buf + 32, payload_hash, 32);
+  for (int i = 0; i < 4; i++) {
+    buf[64 + i] = (uint8_t)(seq >> (24 - i * 8));
+    buf[68 + i] = (uint8_t)(time_bucket >> (24 - i * 8));
+  }
+  hal_sha256_domain(DOMAIN_CHAIN_HASH, buf, sizeof(buf), out);
+}
+
+static bool sha256_known_answer() {
+  // FIPS 180-2 "abc"
+  static const uint8_t expect[32] = {
+    0xba, 0x78, 0x16, 0xbf, 0x8f, 0x01, 0xcf, 0xea, 0x41, 0x41, 0x40, 0xde, 0x5d, 0xae, 0x22, 0x23,
+    0xb0, 0x03, 0x61, 0xa3, 0x96, 0x17, 0x7a, 0x9c, 0xb4, 0x10, 0xff, 0x61, 0xf2, 0x00, 0x15, 0xad,
+  };
+  uint8_t out[32];
+  hal_sha256((const uint8_t*)"abc", 3, out);
+  return memcmp(out, expect, 32) == 0;
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// CASES
+// ════════════════════════════════════════════════════════════════════════════
+
+static void bench_cbor() {
+  uint8_t buf[256];
+  size_t len = encode_witness_payload(buf, sizeof(buf), 1);
+
+  bench("cbor_encode_payload", len, [&](uint64_t n) {
+    for (uint64_t i = 0; i < n; i++) s_sink += (uint32_t)encode_witness_payload(buf, sizeof(buf), (uint32_t)i);
+  });
+
+  bench("cbor_decode_payload", len, [&](uint64_t n) {
+    for (uint64_t i = 0; i < n; i++) {
+      cbor_reader_t r;
+      cbor_item_t item;
+      cbor_reader_init(&r, buf, len);
+      while (cbor_next(&r, &item)) s_sink += (uint32_t)item.type;
+    }
+  });
+}
+
+static void bench_rings() {
+  static uint8_t storage[4096];
+  static uint8_t chunk[256];
+  static uint8_t out[256];
+  memset(chunk, 0xA5, sizeof(chunk));
+
+  bench("ring_buffer_write_read_256", sizeof(chunk), [&](uint64_t n) {
+    ring_buffer_t rb;
+    ring_buffer_init(&rb, storage, sizeof(storage));
+    for (uint64_t i = 0; i < n; i++) {
+      ring_buffer_write(&rb, chunk, sizeof(chunk));
+      s_sink += (uint32_t)ring_buffer_read(&rb, out, sizeof(out));
+    }
+  });
+
+  bench("ring_buffer_push_pop_byte", 1, [&](uint64_t n) {
+    ring_buffer_t rb;
+    ring_buffer_init(&rb, storage, sizeof(storage));
+    uint8_t b;
+    for (uint64_t i = 0; i < n; i++) {
+      ring_buffer_push(&rb, (uint8_t)i);
+      ring_buffer_pop(&rb, &b);
+      s_sink += b;
+    }
+  });
+
+  bench("spsc_ring_write_read_256", sizeof(chunk), [&](uint64_t n) {
+    static SpscRingT<4096> ring;
+    for (uint64_t i = 0; i < n; i++) {
+      ring.write(chunk, sizeof(chunk));
+      s_sink += (uint32_t)ring.read(out, sizeof(out));
+    }
+  });
+}
+
+static void bench_gnss() {
+  std::string epoch = nmea_epoch();
+  const uint8_t* data = (const uint8_t*)epoch.data();
+
+  // Sanity check before timing: the stream must actually produce a fix
+  gnss_parser_t check;
+  gnss_parser_init(&check);
+  gnss_parser_process(&check, data, epoch.size());
+  if (!gnss_parser_has_fix(&check)) {
+    fprintf(stderr, "gnss fixture did not produce a fix\n");
+    exit(2);
+  }
+
+  bench("gnss_parse_epoch", epoch.size(), [&](uint64_t n) {
+    gnss_parser_t p;
+    gnss_parser_init(&p);
+    for (uint64_t i = 0; i < n; i++) s_sink += (uint32_t)gnss_parser_process(&p, data, epoch.size());
+  });
+}
+
+static void bench_witness() {
+  uint8_t payload[256];
+  size_t len = encode_witness_payload(payload, sizeof(payload), 1);
+  uint8_t prev[32] = {0};
+  uint8_t hash[32];
+
+  bench("witness_payload_hash", len, [&](uint64_t n) {
+    for (uint64_t i = 0; i < n; i++) {
+      hal_sha256_domain(DOMAIN_PAYLOAD_HASH, payload, len, hash);
+      s_sink += hash[0];
+    }
+  });
+
+  bench("witness_chain_hash", 72, [&](uint64_t n) {
+    for (uint64_t i = 0; i < n; i++) {
+      chain_hash(prev, hash, (uint32_t)i, 5866666, prev);
+    }
+    s_sink += prev[0];
+  });
+
+  bench("witness_merkle_leaf", 32, [&](uint64_t n) {
+    for (uint64_t i = 0; i < n; i++) {
+      hal_sha256_domain(DOMAIN_MERKLE_LEAF, prev, 32, hash);
+      s_sink += hash[0];
+    }
+  });
+
+  // Everything create_record() does before the signature
+  bench("witness_record_path", len, [&](uint64_t n) {
+    for (uint64_t i = 0; i < n; i++) {
+      size_t m = encode_witness_payload(payload, sizeof(payload), (uint32_t)i);
+      hal_sha256_domain(DOMAIN_PAYLOAD_HASH, payload, m, hash);
+      chain_hash(prev, hash, (uint32_t)i, 5866666, prev);
+    }
+    s_sink += prev[0];
+  });
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// BASELINE
+// ════════════════════════════════════════════════════════════════════════════
+
+static bool save_baseline(const char* path) {
+  FILE* f = fopen(path, "w");
+  if (!f) return false;
+  for (const BenchResult& r : s_results) fprintf(f, "%s %.0f\n", r.name.c_str(), r.ops_per_s);
+  fclose(f);
+  return true;
+}
+
+// Returns the number of cases slower than the baseline by more than the tolerance
+static int compare_baseline(const char* path) {
+  FILE* f = fopen(path, "r");
+  if (!f) {
+    fprintf(stderr, "cannot open baseline %s\n", path);
+    return -1;
+  }
+
+  printf("\n%-28s %14s %14s %8s\n", "vs baseline", "then ops/s", "now ops/s", "change");
+  int regressions = 0;
+  char name[64];
+  double then;
+  while (fscanf(f, "%63s %lf", name, &then) == 2) {
+    for (const BenchResult& r : s_results) {
+      if (r.name != name || then <= 0) continue;
+      double change = (r.ops_per_s - then) / then * 100.0;
+      bool slow = change < -s_opts.tolerance_pct;
+      if (slow) regressions++;
+      printf("%-28s %14.0f %14.0f %+7.1f%%%s\n", name, then, r.ops_per_s, change, slow ? "  REGRESSION" : "");
+    }
+  }
+  fclose(f);
+  return regressions;
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// MAIN
+// ════════════════════════════════════════════════════════════════════════════
+
+static void usage(const char* prog) {
+  fprintf(stderr,
+          "usage: %s [--filter SUBSTR] [--time-ms N] [--save FILE]\n"
+          "          [--baseline FILE] [--tolerance PCT]\n", prog);
+}
+
+int main(int argc, char** argv) {
+  for (int i = 1; i < argc; i++) {
+    const char* arg = argv[i];
+    const char* val = i + 1 < argc ? argv[i + 1] : nullptr;
+    if (!strcmp(arg, "--filter") && val) { s_opts.filter = val; i++; }
+    else if (!strcmp(arg, "--time-ms") && val) { s_opts.time_ms = (uint32_t)strtoul(val, nullptr, 10); i++; }
+    else if (!strcmp(arg, "--save") && val) { s_opts.save = val; i++; }
+    else if (!strcmp(arg, "--baseline") && val) { s_opts.baseline = val; i++; }
+    else if (!strcmp(arg, "--tolerance") && val) { s_opts.tolerance_pct = strtod(val, nullptr); i++; }
+    else { usage(argv[0]); return 2; }
+  }
+  if (s_opts.time_ms == 0) s_opts.time_ms = 1;
+
+  if (!sha256_known_answer()) {
+    fprintf(stderr, "host SHA-256 failed its known-answer test\n");
+    return 2;
+  }
+
+  bench_cbor();
+  bench_rings();
+  bench_gnss();
+  bench_witness();
+
+  if (s_opts.save && !save_baseline(s_opts.save)) {
+    fprintf(stderr, "cannot write %s\n", s_opts.save);
+    return 2;
+  }
+  if (s_opts.baseline) {
+    int regressions = compare_baseline(s_opts.baseline);
+    if (regressions < 0) return 2;
+    if (regressions > 0) {
+      printf("\n%d case(s) slower than baseline by more than %.0f%%\n", regressions, s_opts.tolerance_pct);
+      return 1;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,188 @@
+/*
+ * SecuraCV Canary — Host HAL Stubs (native benchmark build)
+ *
+ * Just enough of common/hal for the modules under benchmark to link on a
+ * desktop: monotonic time from std::chrono and a portable software
+ * SHA-256 behind the hal_sha256*() interface. hal_sha256_domain() follows
+ * the firmware's sha256_domain(): SHA256(domain || 0x00 || data).
+ *
+ * Copyright (c) 2026 ERRERlabs / Karl May
+ * License: Apache-2.0
+ */
+
+#include "common/hal/hal.h"
+
+#include <chrono>
+#include <thread>
+#include <string.h>
+
+// ════════════════════════════════════════════════════════════════════════════
+// TIME
+// ════════════════════════════════════════════════════════════════════════════
+
+static const std::chrono::steady_clock::time_point s_boot = std::chrono::steady_clock::now();
+
+uint32_t hal_millis(void) {
+  auto d = std::chrono::steady_clock::now() - s_boot;
+  return (uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(d).count();
+}
+
+uint64_t hal_micros(void) {
+  auto d = std::chrono::steady_clock::now() - s_boot;
+  return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+}
+
+void hal_delay_ms(uint32_t ms) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void hal_delay_us(uint32_t us) {
+  std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// SHA-256 (FIPS 180-4, software)
+// ════════════════════════════════════════════════════════════════════════════
+
+struct Sha256State {
+  uint32_t h[8];
+  uint64_t total;
+  uint8_t block[64];
+  size_t fill;
+};
+
+static_assert(sizeof(Sha256State) <= sizeof(hal_sha256_ctx_t), "SHA-256 state must fit the HAL context");
+
+// The HAL context is a byte array with no alignment guarantee, so the
+// state is copied in and out rather than cast in place
+static inline void state_load(const hal_sha256_ctx_t* ctx, Sha256State* s) {
+  memcpy(s, ctx->internal, sizeof(*s));
+}
+
+static inline void state_store(hal_sha256_ctx_t* ctx, const Sha256State* s) {
+  memcpy(ctx->internal, s, sizeof(*s));
+}
+
+static const uint32_t K[64] = {
+  0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+  0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+  0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+  0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+  0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+  0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+  0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+  0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+static inline uint32_t rotr(uint32_t x, int n) {
+  return (x >> n) | (x << (32 - n));
+}
+
+static void sha256_block(Sha256State* s, const uint8_t* p) {
+  uint32_t w[64];
+  for (int i = 0; i < 16; i++) {
+    w[i] = ((uint32_t)p[i * 4] << 24) | ((uint32_t)p[i * 4 + 1] << 16) |
+           ((uint32_t)p[i * 4 + 2] << 8) | p[i * 4 + 3];
+  }
+  for (int i = 16; i < 64; i++) {
+    uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+    uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+    w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+  }
+
+  uint32_t a = s->h[0], b = s->h[1], c = s->h[2], d = s->h[3];
+  uint32_t e = s->h[4], f = s->h[5], g = s->h[6], h = s->h[7];
+  for (int i = 0; i < 64; i++) {
+    uint32_t t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + K[i] + w[i];
+    uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+    h = g; g = f; f = e; e = d + t1;
+    d = c; c = b; b = a; a = t1 + t2;
+  }
+  s->h[0] += a; s->h[1] += b; s->h[2] += c; s->h[3] += d;
+  s->h[4] += e; s->h[5] += f; s->h[6] += g; s->h[7] += h;
+}
+
+int hal_sha256_init(hal_sha256_ctx_t* ctx) {
+  static const uint32_t IV[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+  };
+  if (!ctx) return HAL_ERROR_INVALID_PARAM;
+  Sha256State s;
+  memcpy(s.h, IV, sizeof(IV));
+  s.total = 0;
+  s.fill = 0;
+  state_store(ctx, &s);
+  return HAL_OK;
+}
+
+int hal_sha256_update(hal_sha256_ctx_t* ctx, const uint8_t* data, size_t len) {
+  if (!ctx || (!data && len > 0)) return HAL_ERROR_INVALID_PARAM;
+  Sha256State st;
+  Sha256State* s = &st;
+  state_load(ctx, s);
+  s->total += len;
+  if (s->fill > 0) {
+    size_t n = 64 - s->fill < len ? 64 - s->fill : len;
+    memcpy(s->block + s->fill, data, n);
+    s->fill += n;
+    data += n;
+    len -= n;
+    if (s->fill == 64) {
+      sha256_block(s, s->block);
+      s->fill = 0;
+    }
+  }
+  if (s->fill == 0) {
+    for (; len >= 64; data += 64, len -= 64) sha256_block(s, data);
+    memcpy(s->block, data, len);
+    s->fill = len;
+  }
+  state_store(ctx, s);
+  return HAL_OK;
+}
+
+int hal_sha256_final(hal_sha256_ctx_t* ctx, uint8_t hash[HAL_SHA256_HASH_SIZE]) {
+  if (!ctx || !hash) return HAL_ERROR_INVALID_PARAM;
+  Sha256State st;
+  Sha256State* s = &st;
+  state_load(ctx, s);
+  uint64_t bits = s->total * 8;
+
+  s->block[s->fill++] = 0x80;
+  if (s->fill > 56) {
+    memset(s->block + s->fill, 0, 64 - s->fill);
+    sha256_block(s, s->block);
+    s->fill = 0;
+  }
+  memset(s->block + s->fill, 0, 56 - s->fill);
+  for (int i = 0; i < 8; i++) s->block[56 + i] = (uint8_t)(bits >> (56 - i * 8));
+  sha256_block(s, s->block);
+
+  for (int i = 0; i < 8; i++) {
+    hash[i * 4] = (uint8_t)(s->h[i] >> 24);
+    hash[i * 4 + 1] = (uint8_t)(s->h[i] >> 16);
+    hash[i * 4 + 2] = (uint8_t)(s->h[i] >> 8);
+    hash[i * 4 + 3] = (uint8_t)s->h[i];
+  }
+  return HAL_OK;
+}
+
+int hal_sha256(const uint8_t* data, size_t len, uint8_t hash[HAL_SHA256_HASH_SIZE]) {
+  hal_sha256_ctx_t ctx;
+  hal_sha256_init(&ctx);
+  int err = hal_sha256_update(&ctx, data, len);
+  if (err != HAL_OK) return err;
+  return hal_sha256_final(&ctx, hash);
+}
+
+int hal_sha256_domain(const char* domain, const uint8_t* data, size_t len,
+                      uint8_t hash[HAL_SHA256_HASH_SIZE]) {
+  if (!domain) return HAL_ERROR_INVALID_PARAM;
+  static const uint8_t sep = 0x00;
+  hal_sha256_ctx_t ctx;
+  hal_sha256_init(&ctx);
+  hal_sha256_update(&ctx, (const uint8_t*)domain, strlen(domain));
+  hal_sha256_update(&ctx, &sep, 1);
+  if (data && len > 0) hal_sha256_update(&ctx, data, len);
+  return hal_sha256_final(&ctx, hash);
+}
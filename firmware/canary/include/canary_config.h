@@ -51,6 +51,27 @@
 #ifndef FEATURE_BLUETOOTH
   #define FEATURE_BLUETOOTH     0
 #endif
+#ifndef FEATURE_ASYNC_SIGNER
+  #define FEATURE_ASYNC_SIGNER  1
+#endif
+#ifndef FEATURE_CHAIN_JOURNAL
+  #define FEATURE_CHAIN_JOURNAL 1
+#endif
+#ifndef FEATURE_METRICS
+  #define FEATURE_METRICS       1
+#endif
+#ifndef FEATURE_PERF_PROFILER
+  #define FEATURE_PERF_PROFILER 1
+#endif
+#ifndef FEATURE_EVENT_TRACE
+  #define FEATURE_EVENT_TRACE   1
+#endif
+#ifndef FEATURE_BENCH
+  #define FEATURE_BENCH         1
+#endif
+#ifndef FEATURE_POWER_MANAGEMENT
+  #define FEATURE_POWER_MANAGEMENT 0
+#endif
 
 // ════════════════════════════════════════════════════════════════
 // DEBUG FLAG DEFAULTS
@@ -101,6 +122,34 @@
   #define SD_MOSI_PIN  9
 #endif
 
+// SD card SDMMC host, tried before SPI when enabled. The XIAO slot has no
+// D1/D2, so it runs 1-bit on the SPI lines (SCK=CLK, MOSI=CMD, MISO=D0,
+// CS=D3 held high); a 4-bit board sets SD_MMC_BUS_WIDTH 4 and D1..D3.
+#ifndef SD_USE_SDMMC
+  #define SD_USE_SDMMC 0
+#endif
+#ifndef SD_MMC_CLK_PIN
+  #define SD_MMC_CLK_PIN  7
+#endif
+#ifndef SD_MMC_CMD_PIN
+  #define SD_MMC_CMD_PIN  9
+#endif
+#ifndef SD_MMC_D0_PIN
+  #define SD_MMC_D0_PIN   8
+#endif
+#ifndef SD_MMC_D1_PIN
+  #define SD_MMC_D1_PIN   (-1)
+#endif
+#ifndef SD_MMC_D2_PIN
+  #define SD_MMC_D2_PIN   (-1)
+#endif
+#ifndef SD_MMC_D3_PIN
+  #define SD_MMC_D3_PIN   21
+#endif
+#ifndef SD_MMC_BUS_WIDTH
+  #define SD_MMC_BUS_WIDTH 1
+#endif
+
 // GPS UART
 #ifndef GPS_RX_PIN
   #define GPS_RX_PIN   44
@@ -109,6 +158,24 @@
   #define GPS_TX_PIN   43
 #endif
 #define GPS_BAUD       9600
+#define GPS_UART_NUM   1
+#define GPS_UART_RX_BUF      4096    // Driver ring; ~0.35 s of 10 Hz NMEA at 115200
+#define GPS_UART_EVENT_QUEUE 16
+#define GPS_TASK_STACK       4096
+#define GPS_TASK_PRIORITY    6       // Above httpd and the signer so bursts never back up
+#define GPS_TASK_CORE        1       // With the record task, away from the WiFi stack
+
+// u-blox receivers are switched to one UBX-NAV-PVT frame per epoch; anything
+// that does not ACK the probe (e.g. the L76K) stays on NMEA
+#define GPS_UBX_ENABLE       1
+#define GPS_UBX_PROBE_MS     1500    // Wait for ACK-ACK before falling back
+#define GPS_UBX_RATE_MS      0       // CFG-RATE measurement period; 0 = leave as is
+
+// Fix history: every valid fix between two records is kept, then reduced
+// to the points that matter for the "trk" segment of the next record
+#define TRACK_RING_CAPACITY       64      // Fixes buffered between records
+#define TRACK_SEGMENT_MAX_POINTS  8       // Points per record segment
+#define TRACK_TOLERANCE_M         5.0     // Dropped fixes lie within this of the path
 
 // Tamper detection
 #define TAMPER_GPIO    2
@@ -137,6 +204,27 @@
   #define CAM_PIN_VSYNC   38
   #define CAM_PIN_HREF    47
   #define CAM_PIN_PCLK    13
+
+  #define CAMERA_FB_COUNT              4       // Driver frame buffers in PSRAM, shared zero-copy
+  #define CAMERA_CAPTURE_INTERVAL_MS   80      // Pause between captures while streaming
+  #define CAMERA_CAPTURE_STACK         4096
+  #define CAMERA_CAPTURE_PRIORITY      4       // Alongside the HTTP workers
+
+  // Adaptive peek: pace capture and trade quality/framesize for link speed
+  #define CAMERA_ADAPTIVE              1
+  #define CAMERA_ADAPT_TARGET_MS       150     // Per-frame send time to aim for
+  #define CAMERA_ADAPT_INTERVAL_MS     1000    // Controller step
+  #define CAMERA_CAPTURE_INTERVAL_MAX_MS 500   // Slowest pacing on a weak link
+  #define CAMERA_JPEG_QUALITY_MIN      10      // Best quality (lower is better)
+  #define CAMERA_JPEG_QUALITY_MAX      30      // Worst before framesize drops
+  #define CAMERA_JPEG_QUALITY_STEP     4
+  #define CAMERA_ADAPT_MIN_FRAMESIZE   FRAMESIZE_QVGA
+
+  // /api/peek/snapshot: stills are served from the newest frame while it is
+  // younger than the max age (?max_age_ms= overrides up to the limit)
+  #define CAMERA_SNAPSHOT_MAX_AGE_MS   1000
+  #define CAMERA_SNAPSHOT_MAX_AGE_LIMIT_MS 60000
+  #define CAMERA_SNAPSHOT_TIMEOUT_MS   2000    // Wait for a fresh capture
 #endif
 
 // ════════════════════════════════════════════════════════════════
@@ -157,6 +245,115 @@
 #define VERIFY_INTERVAL_SEC      60      // Self-verify every N seconds
 #define WATCHDOG_TIMEOUT_SEC     8       // Hardware watchdog
 #define SD_PERSIST_INTERVAL      10      // Persist every N records
+#define CHAIN_CHECKPOINT_INTERVAL 1000   // NVS rewrite interval when the journal is active
+#define WITNESS_CHECKPOINT_INTERVAL 256  // Records between signed chain checkpoints (0 = off)
+
+// ════════════════════════════════════════════════════════════════
+// WITNESS SIGNER TASK
+// ════════════════════════════════════════════════════════════════
+
+#define WITNESS_MAX_PAYLOAD      256     // Largest payload accepted by the signer queue
+#define SIGNER_QUEUE_LEN         8       // Pending records before submit() rejects
+#define SIGNER_TASK_STACK        8192
+#define SIGNER_TASK_PRIORITY     5
+#define SIGNER_TASK_CORE         0       // Arduino loop() runs on core 1
+
+// ════════════════════════════════════════════════════════════════
+// RUNTIME TASKS
+// ════════════════════════════════════════════════════════════════
+
+// Priorities run GNSS ingest (GPS_TASK_*) > signer (SIGNER_TASK_*) >
+// record > network > housekeeping. loop() is the housekeeping task
+// (serial console, BOOT button, heap stats); nothing timing-critical
+// runs there. If a task cannot be created its work falls back to loop().
+#define RECORD_TASK_STACK        6144    // Payload build; inline signing without the signer
+#define RECORD_TASK_PRIORITY     4
+#define RECORD_TASK_CORE         1
+#define NET_TASK_STACK           4096
+#define NET_TASK_PRIORITY        2
+#define NET_TASK_CORE            0       // Same core as the WiFi stack
+#define NET_TASK_PERIOD_MS       50      // WiFi supervision and SSE polling
+#if FEATURE_POWER_MANAGEMENT
+  #define HOUSEKEEPING_PERIOD_MS 100     // loop() sleep between passes; longer idle to sleep in
+#else
+  #define HOUSEKEEPING_PERIOD_MS 20      // loop() sleep between passes
+#endif
+
+// ════════════════════════════════════════════════════════════════
+// BOOT SEQUENCE
+// ════════════════════════════════════════════════════════════════
+
+// setup() runs the witness core inline; console wait, SD mount, WiFi/HTTP
+// and camera attach on boot tasks that exit once their stage is done
+#define BOOT_MAX_STAGES          16
+#define BOOT_TASK_STACK          6144    // WiFi/mDNS start is the deepest
+#define BOOT_TASK_PRIORITY       3       // Below record, above network and loop()
+#define BOOT_TASK_CORE           0       // Away from setup() and the record task
+#define BOOT_SD_BACKLOG          8       // Records held for the SD log while the card mounts
+#define BOOT_SD_BACKLOG_POLL_MS  20      // Then the record sink waits for the mount to resolve
+
+// ════════════════════════════════════════════════════════════════
+// POWER MANAGEMENT (FEATURE_POWER_MANAGEMENT)
+// ════════════════════════════════════════════════════════════════
+
+#define POWER_CPU_MAX_MHZ        240
+#define POWER_CPU_MIN_MHZ        40      // XTAL frequency, the lowest DFS step
+#define POWER_LIGHT_SLEEP        1       // Needs CONFIG_FREERTOS_USE_TICKLESS_IDLE, else DFS only
+#define POWER_UART_WAKE_THRESHOLD 3      // GNSS RX edges that wake from light sleep
+#define POWER_DUTY_WINDOW_MS     10000   // Duty-cycle averaging window (all builds)
+
+// ════════════════════════════════════════════════════════════════
+// LOG SINK (log_health output)
+// ════════════════════════════════════════════════════════════════
+
+#define LOG_SINK_RING_SIZE       32      // Entries awaiting output (power of two)
+#define LOG_SINK_TEXT_LEN        128     // Message + detail bytes kept per entry
+#define LOG_SINK_MAX_OUTPUTS     4       // Serial plus SD/remote outputs
+#define LOG_SINK_TASK_STACK      3072
+#define LOG_SINK_TASK_PRIORITY   1       // Lowest; only output waits on the UART
+#define LOG_SINK_TASK_CORE       0
+
+// ════════════════════════════════════════════════════════════════
+// SELF-VERIFICATION POLICY
+// ════════════════════════════════════════════════════════════════
+
+// 0 = verify every record, 1 = every Nth record, 2 = background auditor
+#ifndef WITNESS_VERIFY_POLICY
+  #define WITNESS_VERIFY_POLICY  0
+#endif
+#define WITNESS_VERIFY_SAMPLE_N  8       // Sampled mode: verify 1 in N records
+#define AUDITOR_RING_SIZE        16      // Deferred mode: records awaiting audit
+#define AUDITOR_TASK_STACK       6144
+#define AUDITOR_TASK_PRIORITY    1
+#define AUDITOR_INTERVAL_MS      500
+
+// ════════════════════════════════════════════════════════════════
+// CHAIN STATE JOURNAL
+// ════════════════════════════════════════════════════════════════
+
+#define JOURNAL_PARTITION_LABEL  "chainlog"
+#define JOURNAL_PARTITION_SUBTYPE 0x40   // Custom data subtype (partitions_ota.csv)
+#define JOURNAL_SECTOR_SIZE      4096
+
+// ════════════════════════════════════════════════════════════════
+// MERKLE BATCH SIGNING
+// ════════════════════════════════════════════════════════════════
+
+// 0 = sign every record, 1 = sign one Merkle root per batch
+#ifndef WITNESS_BATCH_MODE
+  #define WITNESS_BATCH_MODE     0
+#endif
+#define WITNESS_BATCH_SIZE       16      // Records per signed root
+#define WITNESS_BATCH_WINDOW_MS  5000    // Seal a partial batch after this long
+#define WITNESS_MERKLE_DEPTH     4       // Max proof length (2^depth >= batch size)
+
+// ════════════════════════════════════════════════════════════════
+// CRYPTO BACKEND
+// ════════════════════════════════════════════════════════════════
+
+#define SHA256_DOMAIN_CACHE_SIZE 12      // Cached domain midstates (sha256_domain)
+#define CRYPTO_BENCH_BYTES       256     // Boot benchmark message size (~record sized)
+#define CRYPTO_BENCH_ROUNDS      32      // Operations timed per backend and primitive
 
 // ════════════════════════════════════════════════════════════════
 // MOTION DETECTION WITH HYSTERESIS
@@ -175,11 +372,64 @@
 #define BOOT_BUTTON_HOLD_MS      1200
 
 // ════════════════════════════════════════════════════════════════
-// SD CARD SPI SPEEDS
+// SD CARD BUS SPEEDS
 // ════════════════════════════════════════════════════════════════
 
 #define SD_SPI_FAST              4000000   // 4 MHz
 #define SD_SPI_SLOW              1000000   // 1 MHz fallback
+#define SD_MMC_FREQ_KHZ          20000     // SDMMC default speed (40000 = high speed)
+
+// ════════════════════════════════════════════════════════════════
+// WITNESS LOG (SD)
+// ════════════════════════════════════════════════════════════════
+
+#define WITNESS_LOG_DIR          "/WITNESS"
+#define WITNESS_SEGMENT_RECORDS  4096    // Sequence numbers per segment file
+#define WITNESS_INDEX_STRIDE     64      // One index entry per N sequence numbers
+#define SD_WRITE_BUFFER_BYTES    4096    // Write-back buffer, written as aligned 4 KB units
+#define WITNESS_FLUSH_MS         2000    // Write a partial buffer after this long
+#define CHAIN_VERIFY_DEFAULT_LIMIT 500   // /api/chain/verify records per call
+#define CHAIN_VERIFY_MAX_LIMIT   5000
+#define WITNESS_CHECKPOINT_INDEX WITNESS_LOG_DIR "/CHECKPT.IDX"  // Seq + chain hash per checkpoint
+
+// ════════════════════════════════════════════════════════════════
+// HEALTH LOG (SD)
+// ════════════════════════════════════════════════════════════════
+
+#define HEALTH_LOG_PATH          "/HEALTH/HEALTH.LOG"
+#define HEALTH_LOG_OLD_PATH      "/HEALTH/HEALTH.OLD"  // Previous generation after rollover
+#define HEALTH_LOG_MAX_BYTES     (1024 * 1024)         // Roll over past this size
+#define HEALTH_STORE_BATCH_SECTORS 8     // RAM batch (512 B sectors, 3 entries each)
+#define HEALTH_STORE_FLUSH_MS    5000    // Write a partial batch after this long
+#define HEALTH_STORE_FLUSH_LEVEL LOG_LEVEL_CRITICAL  // This level and above write through
+#define HEALTH_STORE_RECOVER     32      // Tail entries reloaded into RAM at boot
+
+// ════════════════════════════════════════════════════════════════
+// SD COUNTERS
+// ════════════════════════════════════════════════════════════════
+
+#define STORAGE_COUNTS_PATH      "/CHAIN/COUNTS.DAT"   // Two alternating checkpoint slots
+#define STORAGE_COUNTS_SAVE_MS   60000   // Checkpoint interval while counts change
+
+// ════════════════════════════════════════════════════════════════
+// SD RETENTION
+// ════════════════════════════════════════════════════════════════
+
+#define STORAGE_RETAIN_FREE_BYTES  (64ULL * 1024 * 1024)  // Prune while the card has less free
+#define STORAGE_RETAIN_MAX_BYTES   0     // Witness log size quota (0 = card size only)
+#define STORAGE_RETAIN_MAX_RECORDS 0     // Keep segments within N seqs of the newest (0 = all)
+#define STORAGE_RETAIN_INTERVAL_MS 1000  // Between retention steps
+#define STORAGE_RETAIN_STEP_MS     20    // Card time one step may use
+
+// ════════════════════════════════════════════════════════════════
+// SD SCRUBBER
+// ════════════════════════════════════════════════════════════════
+
+#define STORAGE_SCRUB_INTERVAL_MS  1000  // Between scrub steps
+#define STORAGE_SCRUB_STEP_MS      20    // Card time one step may use
+#define STORAGE_SCRUB_PASS_MS      (6UL * 60 * 60 * 1000)  // Idle time between full passes
+#define STORAGE_SCRUB_READ_BYTES   8192  // Scrub read buffer
+#define STORAGE_SCRUB_REGIONS      8     // Flagged regions awaiting re-verification
 
 // ════════════════════════════════════════════════════════════════
 // WIFI PROVISIONING
@@ -188,6 +438,77 @@
 #define WIFI_CONNECT_TIMEOUT_MS      15000
 #define WIFI_RECONNECT_INTERVAL_MS   30000
 
+// Reconnects first try the last good BSSID and channel (no scan). If that
+// has not linked up within the fast timeout, a full scan follows. DHCP runs
+// from the start, unless a lease bound earlier in this boot is short of its
+// T1 (half the lease): that one is reused as a static address until T1.
+#define WIFI_FAST_CONNECT            1
+#define WIFI_FAST_CONNECT_TIMEOUT_MS 3000
+#define WIFI_FAST_LEASE_MAX_S        86400   // Longer leases are revalidated daily
+
+// ════════════════════════════════════════════════════════════════
+// HTTP API
+// ════════════════════════════════════════════════════════════════
+
+#define HTTP_RESP_CHUNK_SIZE     1024    // Streamed response chunk (one shared buffer)
+#define HTTP_MAX_ROUTES          32      // Routes in the router table
+#define HTTP_ROUTER_MAX_NODES    48      // Trie nodes, one per distinct path segment
+#define HTTP_ROUTER_MAX_METHODS  4       // Methods in use; one httpd handler each
+#define HTTP_ROUTER_MAX_PARAMS   4       // {name} captures per route
+#define HTTP_QUERY_MAX_PARAMS    12      // Query parameters tokenized per request
+#define HTTP_WORKER_COUNT        2       // Tasks serving detached long-lived responses
+#define HTTP_WORKER_QUEUE        2       // Detached requests waiting for a worker
+#define HTTP_WORKER_STACK        8192    // Chain verify (Ed25519 over SD reads), export chunk
+#define HTTP_WORKER_PRIORITY     4       // Below httpd (5) so short API calls win
+#define HTTP_WORKER_SEND_TIMEOUT_MS 5000 // Drop a stalled client
+
+// ════════════════════════════════════════════════════════════════
+// METRICS (/metrics)
+// ════════════════════════════════════════════════════════════════
+
+#define METRICS_MAX_SERIES       24      // Counters and gauges
+#define METRICS_MAX_HISTOGRAMS   28      // One per HTTP route plus witness/SD/GPS
+#define PERF_MAX_SCOPES          32      // Profiler scopes: HTTP routes plus subsystems
+#define TRACE_RING_EVENTS        1024    // Event tracer ring (power of two, 20 B each)
+#define TRACE_MAX_TASKS          16      // Named tasks on the timeline; the rest share one row
+
+// ════════════════════════════════════════════════════════════════
+// ON-DEVICE BENCHMARKS ('b' serial command, /api/bench)
+// ════════════════════════════════════════════════════════════════
+
+#define BENCH_TASK_STACK         8192    // Ed25519 sign needs the most
+#define BENCH_TASK_PRIORITY      1       // Below everything that does real work
+#define BENCH_TASK_CORE          1
+#define BENCH_CRYPTO_OPS         20      // Ed25519 sign and verify each
+#define BENCH_SHA256_OPS         64      // Of BENCH_SD_BLOCK bytes
+#define BENCH_CBOR_OPS           2000
+#define BENCH_SD_FILE            "/BENCH.TMP"
+#define BENCH_SD_FILE_BYTES      (1024 * 1024)
+#define BENCH_SD_BLOCK           4096    // Op size for every SD case
+#define BENCH_SD_RANDOM_OPS      64
+#define BENCH_NVS_OPS            32      // Commits to the scratch namespace
+#define BENCH_NVS_NS             "bench"
+
+// ════════════════════════════════════════════════════════════════
+// OTA UPDATE (/api/ota)
+// ════════════════════════════════════════════════════════════════
+
+#define OTA_MAX_IMAGE_SIZE       (2 * 1024 * 1024)
+#define OTA_BUF_SIZE             4096    // Receive/flash block (x OTA_BUF_COUNT)
+#define OTA_BUF_COUNT            2       // Double buffering: receive one, flash the other
+#define OTA_WRITER_STACK         4096
+#define OTA_WRITER_PRIORITY      5       // Same as httpd, so neither side starves
+#define OTA_RECV_TIMEOUT_MS      10000   // Give up when the client stalls this long
+
+// ════════════════════════════════════════════════════════════════
+// HTTP EVENT STREAM (/api/events)
+// ════════════════════════════════════════════════════════════════
+
+#define HTTP_SSE_MAX_CLIENTS     3       // Subscribers (each holds one httpd socket)
+#define HTTP_SSE_POLL_MS         500     // State diff interval
+#define HTTP_SSE_KEEPALIVE_MS    15000   // Comment frame that reaps dead sockets
+#define HTTP_SSE_LOG_BURST       8       // Log entries pushed per tick
+
 // ════════════════════════════════════════════════════════════════
 // NVS KEYS
 // ════════════════════════════════════════════════════════════════
@@ -199,9 +520,15 @@
 #define NVS_KEY_CHAIN     "chain"
 #define NVS_KEY_TAMPER    "tamper"
 #define NVS_KEY_LOGSEQ    "logseq"
+#define NVS_KEY_CKPT      "ckpt"        // Seq of the last checkpoint record
 #define NVS_KEY_WIFI_SSID "wifi_ssid"
 #define NVS_KEY_WIFI_PASS "wifi_pass"
 #define NVS_KEY_WIFI_EN   "wifi_en"
+#define NVS_KEY_WIFI_FAST "wifi_fast"   // Last good BSSID, channel and lease
+
+#define NVS_TXN_MAX_KEYS        8       // Entries one NvsTransaction can stage
+#define NVS_TXN_MAX_BYTES       256     // Staged blob bytes per transaction
+#define NVS_TXN_COMPARE_MAX     64      // Larger blobs are rewritten without a compare
 
 // ════════════════════════════════════════════════════════════════
 // MQTT (Home Assistant)
@@ -0,0 +1,88 @@
+/*
+ * SecuraCV Canary — Health Log Message Table
+ *
+ * Every fixed health-log message is listed once here and logged by ID, so
+ * a ring entry stores one byte instead of a copy of the text. The text is
+ * looked up only when an entry is rendered for Serial, /api/logs or SSE.
+ *
+ * To add a message, append an X(ID, "text") line. IDs are only meaningful
+ * inside one firmware build; anything persisted or exported is rendered
+ * text, never the numeric ID.
+ *
+ * Copyright (c) 2026 ERRERlabs / Karl May
+ * License: Apache-2.0
+ */
+
+#ifndef SECURACV_LOG_MESSAGES_H
+#define SECURACV_LOG_MESSAGES_H
+
+#include <stdint.h>
+
+// ════════════════════════════════════════════════════════════════════════════
+// MESSAGE TABLE
+// ════════════════════════════════════════════════════════════════════════════
+
+#define LOG_MESSAGE_TABLE(X)                                          \
+  X(NONE,                     "")                                     \
+  /* System */                                                        \
+  X(BOOT_COMPLETE,            "Device boot complete")                 \
+  X(POWER_UNAVAILABLE,        "Power management unavailable")         \
+  X(REBOOT_REQUESTED,         "Reboot requested")                     \
+  X(OTA_UPLOAD_FAILED,        "OTA upload failed")                    \
+  X(OTA_IMAGE_WRITTEN,        "OTA image written")                    \
+  /* Witness and crypto */                                            \
+  X(PAYLOAD_ENCODE_FAILED,    "Event payload encode failed")          \
+  X(SIGNER_QUEUE_FULL,        "Signer queue full")                    \
+  X(RECORD_CREATE_FAILED,     "Record creation failed")               \
+  X(DEFERRED_VERIFY_FAILED,   "Deferred verification failed")         \
+  X(BATCH_VERIFY_FAILED,      "Batch root verification failed")       \
+  X(CHECKPOINT_FAILED,        "Chain checkpoint failed")              \
+  X(CHAIN_CHECK_PASSED,       "Boot chain check passed")              \
+  X(CHAIN_CHECK_FAILED,       "Boot chain check failed")              \
+  X(SCRUB_REGION_FLAGGED,     "SD scrub found corrupt records")       \
+  X(SCRUB_RECHECK_PASSED,     "Scrubbed region chain intact")         \
+  X(SCRUB_RECHECK_FAILED,     "Scrubbed region chain broken")         \
+  /* Network */                                                       \
+  X(AP_START_FAILED,          "WiFi AP start failed")                 \
+  X(MDNS_STARTED,             "mDNS started")                         \
+  X(MDNS_HOSTNAME,            "canary.local")                         \
+  X(AP_ONLY_MODE,             "AP-only mode")                         \
+  X(NO_HOME_WIFI,             "No home WiFi configured")              \
+  X(WIFI_CREDS_SAVED,         "WiFi credentials saved")               \
+  X(WIFI_CREDS_CLEARED,       "WiFi credentials cleared")             \
+  X(WIFI_TIMEOUT,             "WiFi connection timeout")              \
+  X(WIFI_LOST,                "WiFi connection lost")                 \
+  X(HTTP_ROUTES_FULL,         "HTTP route table full")                \
+  X(HTTP_WORKERS_UNAVAILABLE, "HTTP workers unavailable")             \
+  X(HTTP_START_FAILED,        "HTTP server start failed")             \
+  X(HTTP_STARTED,             "HTTP server started")                  \
+  X(HTTP_PORT_80,             "port 80")                              \
+  X(PEEK_STARTED,             "Peek started")                         \
+  X(PEEK_STREAM_ENDED,        "Peek stream ended")                    \
+  X(PEEK_STOPPED,             "Peek stopped")                         \
+  X(PEEK_SNAPSHOT,            "Peek snapshot served")                 \
+  /* User */                                                          \
+  X(BULK_ACK,                 "Bulk acknowledgment")                  \
+  X(EXPORT_SENT,              "Evidence export sent")
+
+enum LogMsg : uint8_t {
+#define LOG_MSG_ENUM(id, text) LOG_MSG_##id,
+  LOG_MESSAGE_TABLE(LOG_MSG_ENUM)
+#undef LOG_MSG_ENUM
+  LOG_MSG_COUNT
+};
+
+// ════════════════════════════════════════════════════════════════════════════
+// HELPER FUNCTIONS
+// ════════════════════════════════════════════════════════════════════════════
+
+inline const char* log_msg_text(LogMsg id) {
+  static const char* const TEXT[LOG_MSG_COUNT] = {
+#define LOG_MSG_TEXT(id, text) text,
+    LOG_MESSAGE_TABLE(LOG_MSG_TEXT)
+#undef LOG_MSG_TEXT
+  };
+  return id < LOG_MSG_COUNT ? TEXT[id] : "???";
+}
+
+#endif // SECURACV_LOG_MESSAGES_H
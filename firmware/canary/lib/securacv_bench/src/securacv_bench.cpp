@@ -0,0 +1,320 @@
+/*
+ * SecuraCV Canary — On-Device Benchmarks Implementation
+ *
+ * Copyright (c) 2026 ERRERlabs / Karl May
+ * License: Apache-2.0
+ */
+
+#include "securacv_bench.h"
+
+#if FEATURE_BENCH
+
+#include <string.h>
+#include "esp_timer.h"
+#include "esp_random.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "securacv_crypto.h"
+#include "common/encoding/cbor.h"
+
+#if FEATURE_SD_STORAGE
+#include "securacv_storage.h"
+#endif
+
+// ════════════════════════════════════════════════════════════════════════════
+// PRIVATE STATE
+// ════════════════════════════════════════════════════════════════════════════
+
+static const char* const CASE_NAMES[BENCH_CASE_COUNT] = {
+  "ed25519_sign",
+  "ed25519_verify",
+  "sha256",
+  "cbor_encode",
+  "sd_seq_write",
+  "sd_seq_read",
+  "sd_rand_write",
+  "sd_rand_read",
+  "nvs_write",
+};
+
+static BenchResult s_results[BENCH_CASE_COUNT];
+static volatile BenchState s_state = BENCH_IDLE;
+static volatile BenchCase s_current = BENCH_CASE_COUNT;
+static BenchDoneFn s_on_done = nullptr;
+static void* s_on_done_ctx = nullptr;
+static uint8_t* s_buf = nullptr;          // BENCH_SD_BLOCK bytes, heap
+static int64_t s_last_yield_us = 0;
+static portMUX_TYPE s_bench_mux = portMUX_INITIALIZER_UNLOCKED;
+
+// Per-op timing for one case
+struct CaseTimer {
+  BenchResult* r;
+  int64_t t0;
+
+  CaseTimer(BenchCase c, uint32_t bytes_per_op) : r(&s_results[c]), t0(0) {
+    s_current = c;
+    r->bytes_per_op = bytes_per_op;
+    r->ops = 0;
+    r->total_us = 0;
+    r->min_us = UINT32_MAX;
+    r->max_us = 0;
+  }
+
+  void begin() { t0 = esp_timer_get_time(); }
+
+  void end() {
+    uint32_t us = (uint32_t)(esp_timer_get_time() - t0);
+    r->ops++;
+    r->total_us += us;
+    if (us < r->min_us) r->min_us = us;
+    if (us > r->max_us) r->max_us = us;
+
+    // Let IDLE run now and then, or the task watchdog fires on long CPU loops
+    if (esp_timer_get_time() - s_last_yield_us > 50000) {
+      vTaskDelay(1);
+      s_last_yield_us = esp_timer_get_time();
+    }
+  }
+
+  // Extra time charged to the case but not to any op (final flush)
+  void charge(uint32_t us) { r->total_us += us; }
+
+  ~CaseTimer() {
+    if (r->ops == 0) {
+      r->min_us = 0;
+      return;
+    }
+    r->avg_us = r->total_us / r->ops;
+    uint64_t bytes = (uint64_t)r->bytes_per_op * r->ops;
+    r->bytes_per_s = r->total_us ? (uint32_t)(bytes * 1000000ULL / r->total_us) : 0;
+    r->ran = true;
+  }
+};
+
+// ════════════════════════════════════════════════════════════════════════════
+// CASES
+// ════════════════════════════════════════════════════════════════════════════
+
+static void bench_crypto() {
+  uint8_t priv[32], pub[32], msg[32], sig[64];
+  crypto_generate_keypair(priv, pub);
+  esp_fill_random(msg, sizeof(msg));
+
+  {
+    CaseTimer t(BENCH_ED25519_SIGN, sizeof(msg));
+    for (uint32_t i = 0; i < BENCH_CRYPTO_OPS; i++) {
+      t.begin();
+      crypto_sign(priv, pub, msg, sizeof(msg), sig);
+      t.end();
+    }
+  }
+  {
+    CaseTimer t(BENCH_ED25519_VERIFY, sizeof(msg));
+    for (uint32_t i = 0; i < BENCH_CRYPTO_OPS; i++) {
+      t.begin();
+      crypto_verify(pub, msg, sizeof(msg), sig);
+      t.end();
+    }
+  }
+  memset(priv, 0, sizeof(priv));
+
+  uint8_t hash[32];
+  CaseTimer t(BENCH_SHA256, BENCH_SD_BLOCK);
+  for (uint32_t i = 0; i < BENCH_SHA256_OPS; i++) {
+    t.begin();
+    sha256_raw(s_buf, BENCH_SD_BLOCK, hash);
+    t.end();
+  }
+}
+
+// Same keys and value types as the witness event payload built in main.cpp
+static size_t encode_payload(uint8_t* buf, size_t cap, uint32_t i) {
+  cbor_writer_t w;
+  cbor_init(&w, buf, cap);
+  cbor_write_map(&w, 7);
+  cbor_write_tstr(&w, "alt");
+  cbor_write_float(&w, 56.3 + i * 0.1);
+  cbor_write_tstr(&w, "fix");
+  cbor_write_bool(&w, true);
+  cbor_write_tstr(&w, "lat");
+  cbor_write_float(&w, 47.6062095);
+  cbor_write_tstr(&w, "lon");
+  cbor_write_float(&w, -122.3320708);
+  cbor_write_tstr(&w, "spd");
+  cbor_write_float(&w, 3.5);
+  cbor_write_tstr(&w, "sats");
+  cbor_write_uint(&w, 9);
+  cbor_write_tstr(&w, "state");
+  cbor_write_tstr(&w, "MOVE");
+  return cbor_size(&w);
+}
+
+static void bench_cbor() {
+  uint8_t buf[128];
+  size_t len = encode_payload(buf, sizeof(buf), 0);
+  CaseTimer t(BENCH_CBOR_ENCODE, len);
+  for (uint32_t i = 0; i < BENCH_CBOR_OPS; i++) {
+    t.begin();
+    encode_payload(buf, sizeof(buf), i);
+    t.end();
+  }
+}
+
+#if FEATURE_SD_STORAGE
+static void bench_sd() {
+  fs::FS* fs = storage_fs();
+  if (!fs) return;
+
+  const uint32_t blocks = BENCH_SD_FILE_BYTES / BENCH_SD_BLOCK;
+
+  {
+    File f = fs->open(BENCH_SD_FILE, FILE_WRITE);
+    if (!f) return;
+    CaseTimer t(BENCH_SD_SEQ_WRITE, BENCH_SD_BLOCK);
+    for (uint32_t i = 0; i < blocks; i++) {
+      t.begin();
+      size_t n = f.write(s_buf, BENCH_SD_BLOCK);
+      t.end();
+      if (n != BENCH_SD_BLOCK) break;
+    }
+    int64_t t0 = esp_timer_get_time();
+    f.close();
+    t.charge((uint32_t)(esp_timer_get_time() - t0));
+  }
+  {
+    File f = fs->open(BENCH_SD_FILE, FILE_READ);
+    if (f) {
+      CaseTimer t(BENCH_SD_SEQ_READ, BENCH_SD_BLOCK);
+      for (uint32_t i = 0; i < blocks; i++) {
+        t.begin();
+        size_t n = f.read(s_buf, BENCH_SD_BLOCK);
+        t.end();
+        if (n != BENCH_SD_BLOCK) break;
+      }
+      f.close();
+    }
+  }
+  {
+    // Flushed per op, as a durable witness append is
+    File f = fs->open(BENCH_SD_FILE, "r+");
+    if (f) {
+      CaseTimer t(BENCH_SD_RAND_WRITE, BENCH_SD_BLOCK);
+      for (uint32_t i = 0; i < BENCH_SD_RANDOM_OPS; i++) {
+        uint32_t off = (esp_random() % blocks) * BENCH_SD_BLOCK;
+        t.begin();
+        bool ok = f.seek(off) && f.write(s_buf, BENCH_SD_BLOCK) == BENCH_SD_BLOCK;
+        f.flush();
+        t.end();
+        if (!ok) break;
+      }
+      f.close();
+    }
+  }
+  {
+    File f = fs->open(BENCH_SD_FILE, FILE_READ);
+    if (f) {
+      CaseTimer t(BENCH_SD_RAND_READ, BENCH_SD_BLOCK);
+      for (uint32_t i = 0; i < BENCH_SD_RANDOM_OPS; i++) {
+        uint32_t off = (esp_random() % blocks) * BENCH_SD_BLOCK;
+        t.begin();
+        bool ok = f.seek(off) && f.read(s_buf, BENCH_SD_BLOCK) == BENCH_SD_BLOCK;
+        t.end();
+        if (!ok) break;
+      }
+      f.close();
+    }
+  }
+  fs->remove(BENCH_SD_FILE);
+}
+#endif
+
+static void bench_nvs() {
+  CaseTimer t(BENCH_NVS_WRITE, 0);
+  for (uint32_t i = 0; i < BENCH_NVS_OPS; i++) {
+    NvsTransaction tx(BENCH_NVS_NS);
+    tx.putUInt("w", esp_random());    // A changed value, so it is not skipped
+    t.begin();
+    bool ok = tx.commit();
+    t.end();
+    if (!ok) break;
+  }
+  NvsTransaction tx(BENCH_NVS_NS);
+  tx.remove("w");
+  tx.commit();
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// TASK
+// ════════════════════════════════════════════════════════════════════════════
+
+static void bench_task(void* arg) {
+  (void)arg;
+  s_last_yield_us = esp_timer_get_time();
+  esp_fill_random(s_buf, BENCH_SD_BLOCK);
+
+  bench_crypto();
+  bench_cbor();
+#if FEATURE_SD_STORAGE
+  bench_sd();
+#endif
+  bench_nvs();
+
+  free(s_buf);
+  s_buf = nullptr;
+  s_current = BENCH_CASE_COUNT;
+  s_state = BENCH_DONE;
+  if (s_on_done) s_on_done(s_on_done_ctx);
+  vTaskDelete(nullptr);
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// PUBLIC API
+// ════════════════════════════════════════════════════════════════════════════
+
+bool bench_start(BenchDoneFn on_done, void* ctx) {
+  // Serial console and httpd may both ask; only one claims the run
+  BenchState prev;
+  portENTER_CRITICAL(&s_bench_mux);
+  prev = s_state;
+  if (prev != BENCH_RUNNING) s_state = BENCH_RUNNING;
+  portEXIT_CRITICAL(&s_bench_mux);
+  if (prev == BENCH_RUNNING) return false;
+
+  s_buf = (uint8_t*)malloc(BENCH_SD_BLOCK);
+  if (!s_buf) {
+    s_state = prev;
+    return false;
+  }
+
+  for (size_t i = 0; i < BENCH_CASE_COUNT; i++) {
+    memset(&s_results[i], 0, sizeof(s_results[i]));
+    s_results[i].name = CASE_NAMES[i];
+  }
+  s_on_done = on_done;
+  s_on_done_ctx = ctx;
+
+  if (xTaskCreatePinnedToCore(bench_task, "bench", BENCH_TASK_STACK, nullptr,
+                              BENCH_TASK_PRIORITY, nullptr, BENCH_TASK_CORE) != pdPASS) {
+    free(s_buf);
+    s_buf = nullptr;
+    s_state = BENCH_IDLE;   // The results were already cleared
+    return false;
+  }
+  return true;
+}
+
+BenchState bench_state() {
+  return s_state;
+}
+
+BenchCase bench_current() {
+  return s_current;
+}
+
+bool bench_get(size_t i, BenchResult* out) {
+  if (i >= BENCH_CASE_COUNT || s_state == BENCH_IDLE) return false;
+  *out = s_results[i];
+  return true;
+}
+
+#endif // FEATURE_BENCH
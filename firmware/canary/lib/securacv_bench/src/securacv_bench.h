@@ -0,0 +1,97 @@
+/*
+ * SecuraCV Canary — On-Device Benchmarks
+ *
+ * Timed loops over the paths whose speed depends on the board and the
+ * card: Ed25519 sign/verify, SHA-256 (the selected backend), CBOR encode
+ * of a witness-shaped payload, SD sequential and random writes and reads,
+ * and NVS commits. For qualifying SD card brands and board revisions
+ * before a fleet rollout; numbers are per op (avg/min/max us) plus
+ * bytes/s.
+ *
+ * A run takes several seconds, so it executes on its own low-priority
+ * task and never blocks loop() or httpd. Start it with the 'b' serial
+ * command or POST /api/bench; GET /api/bench reports progress and results.
+ * The witness pipeline keeps running during a run, so SD figures include
+ * whatever it writes meanwhile, as they would in the field.
+ *
+ * Side effects: a scratch file (BENCH_SD_FILE) written and removed, and
+ * BENCH_NVS_OPS commits to the "bench" NVS namespace. The device key is
+ * never used; signing runs on a throwaway keypair.
+ *
+ * Copyright (c) 2026 ERRERlabs / Karl May
+ * License: Apache-2.0
+ */
+
+#ifndef SECURACV_BENCH_H
+#define SECURACV_BENCH_H
+
+#include <Arduino.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "canary_config.h"
+
+// ════════════════════════════════════════════════════════════════════════════
+// TYPES
+// ════════════════════════════════════════════════════════════════════════════
+
+enum BenchCase : uint8_t {
+  BENCH_ED25519_SIGN = 0,
+  BENCH_ED25519_VERIFY,
+  BENCH_SHA256,
+  BENCH_CBOR_ENCODE,
+  BENCH_SD_SEQ_WRITE,
+  BENCH_SD_SEQ_READ,
+  BENCH_SD_RAND_WRITE,
+  BENCH_SD_RAND_READ,
+  BENCH_NVS_WRITE,
+  BENCH_CASE_COUNT
+};
+
+enum BenchState : uint8_t {
+  BENCH_IDLE = 0,       // Never run since boot
+  BENCH_RUNNING,
+  BENCH_DONE,
+};
+
+struct BenchResult {
+  const char* name;
+  bool ran;                 // False: not reached yet, or skipped (no card)
+  uint32_t ops;
+  uint32_t bytes_per_op;    // 0 where a byte rate means nothing (NVS)
+  uint32_t total_us;
+  uint32_t avg_us;
+  uint32_t min_us;
+  uint32_t max_us;          // Worst single op: a card's stall shows here
+  uint32_t bytes_per_s;
+};
+
+// Called on the bench task when a run finishes
+typedef void (*BenchDoneFn)(void* ctx);
+
+// ════════════════════════════════════════════════════════════════════════════
+// PUBLIC API
+// ════════════════════════════════════════════════════════════════════════════
+
+#if FEATURE_BENCH
+
+// Start a run; false if one is already running or the task could not start
+bool bench_start(BenchDoneFn on_done = nullptr, void* ctx = nullptr);
+
+BenchState bench_state();
+
+// Case running now (BENCH_CASE_COUNT when not running)
+BenchCase bench_current();
+
+// Result of case i from the current or last run; false past the end
+bool bench_get(size_t i, BenchResult* out);
+
+#else
+
+static inline bool bench_start(BenchDoneFn = nullptr, void* = nullptr) { return false; }
+static inline BenchState bench_state() { return BENCH_IDLE; }
+static inline BenchCase bench_current() { return BENCH_CASE_COUNT; }
+static inline bool bench_get(size_t, BenchResult*) { return false; }
+
+#endif // FEATURE_BENCH
+
+#endif // SECURACV_BENCH_H
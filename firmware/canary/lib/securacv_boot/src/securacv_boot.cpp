@@ -0,0 +1,175 @@
+/*
+ * SecuraCV Canary — Staged Boot Sequence Implementation
+ *
+ * One event group bit per stage, set when the stage finishes. Async
+ * stages each get a task that waits for its dependency bits, runs and
+ * exits; inline stages wait for theirs on the caller. Dependencies must
+ * be declared before the stage, so the graph has no cycles.
+ *
+ * Copyright (c) 2026 ERRERlabs / Karl May
+ * License: Apache-2.0
+ */
+
+#include "securacv_boot.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+#include "freertos/task.h"
+
+// ════════════════════════════════════════════════════════════════════════════
+// PRIVATE STATE
+// ════════════════════════════════════════════════════════════════════════════
+
+struct Stage {
+  BootStageInfo info;
+  BootStageFn fn;
+  void* ctx;
+};
+
+static Stage s_stages[BOOT_MAX_STAGES];
+static size_t s_stage_count = 0;
+static EventGroupHandle_t s_done_bits = nullptr;
+static uint32_t s_core_ready_us = 0;
+
+static inline uint32_t now_us() {
+  return (uint32_t)esp_timer_get_time();
+}
+
+static BootMask all_stages() {
+  return s_stage_count == 0 ? 0 : (BootMask)((1UL << s_stage_count) - 1);
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// STAGE EXECUTION
+// ════════════════════════════════════════════════════════════════════════════
+
+static void run_stage(Stage& s, size_t id) {
+  if (s.info.deps) boot_wait(s.info.deps, UINT32_MAX);
+
+  s.info.core = (uint8_t)xPortGetCoreID();
+  s.info.start_us = now_us();
+  s.info.state = BOOT_STAGE_RUNNING;
+  bool ok = s.fn(s.ctx);
+  s.info.end_us = now_us();
+  s.info.state = ok ? BOOT_STAGE_DONE : BOOT_STAGE_FAILED;
+
+  if (s_done_bits) xEventGroupSetBits(s_done_bits, boot_bit((BootStageId)id));
+}
+
+static void stage_task(void* arg) {
+  size_t id = (size_t)(uintptr_t)arg;
+  run_stage(s_stages[id], id);
+  vTaskDelete(nullptr);
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// PUBLIC API
+// ════════════════════════════════════════════════════════════════════════════
+
+BootStageId boot_stage(const char* name, BootStageFn fn, void* ctx, BootMask deps, BootMode mode) {
+  if (s_stage_count >= BOOT_MAX_STAGES || !fn) return BOOT_STAGE_NONE;
+  if (!s_done_bits) s_done_bits = xEventGroupCreate();
+
+  BootStageId id = (BootStageId)s_stage_count++;
+  Stage& s = s_stages[id];
+  s.info.name = name;
+  s.info.mode = mode;
+  s.info.state = BOOT_STAGE_PENDING;
+  s.info.deps = deps & (boot_bit(id) - 1);     // Only stages declared earlier
+  s.info.core = 0;
+  s.info.start_us = 0;
+  s.info.end_us = 0;
+  s.fn = fn;
+  s.ctx = ctx;
+  return id;
+}
+
+void boot_run() {
+  // Without the event group nothing can wait, so every stage runs inline
+  for (size_t i = 0; i < s_stage_count && s_done_bits; i++) {
+    Stage& s = s_stages[i];
+    if (s.info.mode != BOOT_ASYNC) continue;
+    if (xTaskCreatePinnedToCore(stage_task, s.info.name, BOOT_TASK_STACK, (void*)(uintptr_t)i,
+                                BOOT_TASK_PRIORITY, nullptr, BOOT_TASK_CORE) != pdPASS) {
+      // Finished and failed, so nothing waits forever on it
+      s.info.state = BOOT_STAGE_FAILED;
+      xEventGroupSetBits(s_done_bits, boot_bit((BootStageId)i));
+    }
+  }
+
+  for (size_t i = 0; i < s_stage_count; i++) {
+    Stage& s = s_stages[i];
+    if (s.info.mode == BOOT_ASYNC && s_done_bits) continue;
+    run_stage(s, i);
+  }
+
+  s_core_ready_us = now_us();
+}
+
+bool boot_wait(BootMask mask, uint32_t timeout_ms) {
+  mask &= all_stages();
+  if (!mask || !s_done_bits) return true;
+  TickType_t ticks = timeout_ms == UINT32_MAX ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+  EventBits_t bits = xEventGroupWaitBits(s_done_bits, mask, pdFALSE, pdTRUE, ticks);
+  return (bits & mask) == mask;
+}
+
+bool boot_done(BootStageId id) {
+  if (id < 0 || (size_t)id >= s_stage_count) return false;
+  if (!s_done_bits) return s_stages[id].info.end_us != 0;
+  return (xEventGroupGetBits(s_done_bits) & boot_bit(id)) != 0;
+}
+
+bool boot_ok(BootStageId id) {
+  return boot_done(id) && s_stages[id].info.state == BOOT_STAGE_DONE;
+}
+
+bool boot_complete() {
+  for (size_t i = 0; i < s_stage_count; i++) {
+    if (!boot_done((BootStageId)i)) return false;
+  }
+  return s_core_ready_us != 0;
+}
+
+uint32_t boot_core_ready_us() {
+  return s_core_ready_us;
+}
+
+size_t boot_stage_count() {
+  return s_stage_count;
+}
+
+bool boot_get_stage(size_t i, BootStageInfo* out) {
+  if (i >= s_stage_count) return false;
+  *out = s_stages[i].info;
+  return true;
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// REPORT
+// ════════════════════════════════════════════════════════════════════════════
+
+static const char* state_name(BootStageState st) {
+  switch (st) {
+    case BOOT_STAGE_PENDING: return "pending";
+    case BOOT_STAGE_RUNNING: return "running";
+    case BOOT_STAGE_DONE:    return "ok";
+    case BOOT_STAGE_FAILED:  return "FAILED";
+    default:                 return "?";
+  }
+}
+
+void boot_print_report() {
+  Serial.println("  Stage          Mode    Core  Start ms    End ms  Took ms  Result");
+  for (size_t i = 0; i < s_stage_count; i++) {
+    const BootStageInfo& s = s_stages[i].info;
+    bool ended = s.end_us != 0;
+    Serial.printf("  %-14s %-7s %4u  %8.1f  %8.1f  %7.1f  %s\n",
+                  s.name, s.mode == BOOT_ASYNC ? "async" : "inline", s.core,
+                  s.start_us / 1000.0f, ended ? s.end_us / 1000.0f : 0.0f,
+                  ended ? (s.end_us - s.start_us) / 1000.0f : 0.0f, state_name(s.state));
+  }
+  if (s_core_ready_us) {
+    Serial.printf("  Witness core ready at %.1f ms after power-on\n", s_core_ready_us / 1000.0f);
+  }
+}
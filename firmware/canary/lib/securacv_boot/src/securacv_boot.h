@@ -0,0 +1,105 @@
+/*
+ * SecuraCV Canary — Staged Boot Sequence
+ *
+ * setup() used to bring every subsystem up in turn, so the witness core
+ * waited behind the SD mount timeout, WiFi/mDNS start and camera init.
+ * Boot is now a list of named stages with declared dependencies:
+ *
+ *   BOOT_INLINE   Runs on the caller (setup()) in registration order,
+ *                 after its dependencies. The witness core goes here.
+ *   BOOT_ASYNC    Runs on its own task as soon as its dependencies are
+ *                 done, in parallel with everything else. Slow peripherals
+ *                 go here and attach whenever they are ready.
+ *
+ * A stage finishes whether it succeeds or not; boot_ok() tells which.
+ * Every stage records when it started and ended (microseconds since
+ * power-on, from esp_timer) for the boot profile report, and boot_run()
+ * stamps the moment the inline stages, and so the witness core, are done.
+ *
+ * Copyright (c) 2026 ERRERlabs / Karl May
+ * License: Apache-2.0
+ */
+
+#ifndef SECURACV_BOOT_H
+#define SECURACV_BOOT_H
+
+#include <Arduino.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "canary_config.h"
+
+// ════════════════════════════════════════════════════════════════════════════
+// TYPES
+// ════════════════════════════════════════════════════════════════════════════
+
+typedef int8_t BootStageId;
+static constexpr BootStageId BOOT_STAGE_NONE = -1;
+
+// Set of stages, one bit per BootStageId
+typedef uint32_t BootMask;
+static_assert(BOOT_MAX_STAGES <= 24, "stage bits share a FreeRTOS event group");
+
+enum BootMode : uint8_t {
+  BOOT_INLINE = 0,
+  BOOT_ASYNC,
+};
+
+enum BootStageState : uint8_t {
+  BOOT_STAGE_PENDING = 0,     // Waiting for dependencies
+  BOOT_STAGE_RUNNING,
+  BOOT_STAGE_DONE,
+  BOOT_STAGE_FAILED,          // Ran and returned false, or its task never started
+};
+
+// Stage body; return false if the subsystem did not come up
+typedef bool (*BootStageFn)(void* ctx);
+
+struct BootStageInfo {
+  const char* name;
+  BootMode mode;
+  BootStageState state;
+  BootMask deps;
+  uint8_t core;               // Core it ran on
+  uint32_t start_us;          // Since power-on; 0 until started
+  uint32_t end_us;            // Since power-on; 0 until finished
+};
+
+// ════════════════════════════════════════════════════════════════════════════
+// API
+// ════════════════════════════════════════════════════════════════════════════
+
+static inline BootMask boot_bit(BootStageId id) {
+  return id < 0 ? 0 : (BootMask)1 << id;
+}
+
+// Declare a stage; BOOT_STAGE_NONE when BOOT_MAX_STAGES are declared.
+// Declare every stage before boot_run(), dependencies first.
+BootStageId boot_stage(const char* name, BootStageFn fn, void* ctx,
+                       BootMask deps = 0, BootMode mode = BOOT_INLINE);
+
+// Start the async stages and run the inline ones; returns once the last
+// inline stage is done. Async stages may still be running.
+void boot_run();
+
+// Block until every stage in mask has finished; false on timeout
+bool boot_wait(BootMask mask, uint32_t timeout_ms);
+
+// Whether stage id has finished (successfully or not)
+bool boot_done(BootStageId id);
+
+// Whether stage id finished successfully
+bool boot_ok(BootStageId id);
+
+// Every declared stage has finished
+bool boot_complete();
+
+// Microseconds since power-on when boot_run() returned; 0 before
+uint32_t boot_core_ready_us();
+
+size_t boot_stage_count();
+bool boot_get_stage(size_t i, BootStageInfo* out);
+
+// Per-stage timing table on Serial
+void boot_print_report();
+
+#endif // SECURACV_BOOT_H
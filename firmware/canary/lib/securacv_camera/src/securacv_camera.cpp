@@ -9,6 +9,10 @@
 
 #if FEATURE_CAMERA_PEEK
 
+#include <string.h>
+#include "esp_random.h"
+#include "event_trace.h"
+
 // ════════════════════════════════════════════════════════════════════════════
 // GLOBAL INSTANCE
 // ════════════════════════════════════════════════════════════════════════════
@@ -43,7 +47,16 @@ const char* framesize_name(framesize_t size) {
 // ════════════════════════════════════════════════════════════════════════════
 
 CameraManager::CameraManager()
-  : m_initialized(false), m_peek_active(false), m_framesize(FRAMESIZE_VGA) {}
+  : m_initialized(false), m_peek_active(false), m_snapshot_pending(false),
+    m_grab_latest(false), m_boot_tag(0), m_framesize(FRAMESIZE_VGA),
+    m_framesize_max(FRAMESIZE_VGA), m_quality(CAMERA_JPEG_QUALITY_MIN),
+    m_capture_interval_ms(CAMERA_CAPTURE_INTERVAL_MS), m_send_ms(0), m_window_max_ms(0),
+    m_adapt_ms(0),
+    m_fb_count(0), m_latest(-1), m_frame_seq(0),
+    m_ring_mux(portMUX_INITIALIZER_UNLOCKED), m_capture_task(nullptr), m_viewers(0),
+    m_frames_captured(0), m_frames_dropped(0), m_snapshot_captures(0) {
+  memset(m_slots, 0, sizeof(m_slots));
+}
 
 bool CameraManager::begin() {
   camera_config_t config;
@@ -73,14 +86,17 @@ bool CameraManager::begin() {
   config.jpeg_quality = 12;
   config.fb_count = 1;
 
-  // Adjust for PSRAM availability
+  // Adjust for PSRAM availability. The buffers double as the viewer
+  // frame pool, so PSRAM gets the whole pool and DRAM the minimum of two
+  // (one held by viewers, one being filled).
   if (psramFound()) {
     config.jpeg_quality = 10;
-    config.fb_count = 2;
+    config.fb_count = CAMERA_FB_COUNT;
     config.grab_mode = CAMERA_GRAB_LATEST;
   } else {
     config.frame_size = FRAMESIZE_QVGA;
     config.fb_location = CAMERA_FB_IN_DRAM;
+    config.fb_count = 2;
   }
 
   esp_err_t err = esp_camera_init(&config);
@@ -91,16 +107,43 @@ bool CameraManager::begin() {
   }
 
   m_framesize = config.frame_size;
+  m_framesize_max = config.frame_size;
+  m_quality = config.jpeg_quality;
+  m_fb_count = (uint8_t)config.fb_count;
+  m_grab_latest = config.grab_mode == CAMERA_GRAB_LATEST;
+  m_boot_tag = esp_random();
   m_initialized = true;
-  Serial.println("[CAMERA] Initialized for peek/preview");
+  Serial.printf("[CAMERA] Initialized for peek/preview (%u frame buffers)\n", m_fb_count);
+
+  if (!m_capture_task) {
+    if (xTaskCreate(captureTask, "cam_capture", CAMERA_CAPTURE_STACK, this,
+                    CAMERA_CAPTURE_PRIORITY, &m_capture_task) != pdPASS) {
+      m_capture_task = nullptr;
+      Serial.println("[CAMERA] Capture task creation failed");
+    }
+  }
   return true;
 }
 
 void CameraManager::end() {
   if (m_initialized) {
-    esp_camera_deinit();
-    m_initialized = false;
     m_peek_active = false;
+    m_initialized = false;
+
+    // Viewers notice peek ending within a frame; give them time to release
+    for (int i = 0; i < 100 && heldFrames() > 0; i++) {
+      camera_fb_t* idle = nullptr;
+      portENTER_CRITICAL(&m_ring_mux);
+      if (m_latest >= 0 && m_slots[m_latest].refs == 0) {
+        idle = m_slots[m_latest].fb;
+        m_slots[m_latest].fb = nullptr;
+        m_latest = -1;
+      }
+      portEXIT_CRITICAL(&m_ring_mux);
+      if (idle) esp_camera_fb_return(idle);
+      else vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    esp_camera_deinit();
   }
 }
 
@@ -114,6 +157,14 @@ bool CameraManager::setResolution(framesize_t size) {
     return false;
   }
 
+  m_framesize = size;
+  m_framesize_max = size;
+  return true;
+}
+
+bool CameraManager::applyFramesize(framesize_t size) {
+  sensor_t* s = esp_camera_sensor_get();
+  if (!s || s->set_framesize(s, size) != 0) return false;
   m_framesize = size;
   return true;
 }
@@ -133,6 +184,272 @@ void CameraManager::returnFrame(camera_fb_t* fb) {
   }
 }
 
+// ════════════════════════════════════════════════════════════════════════════
+// SHARED FRAME RING
+// ════════════════════════════════════════════════════════════════════════════
+
+void CameraManager::captureTask(void* arg) {
+  ((CameraManager*)arg)->captureLoop();
+}
+
+void CameraManager::captureLoop() {
+  for (;;) {
+    bool streaming = m_peek_active && m_viewers > 0;
+    if (!m_initialized || (!streaming && !m_snapshot_pending)) {
+      ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(500));
+      continue;
+    }
+
+    // Leave the driver one buffer to fill, or fb_get would block. An idle
+    // newest frame is recycled; frames viewers still hold are not.
+    if (heldFrames() >= m_fb_count - 1) {
+      camera_fb_t* idle = nullptr;
+      portENTER_CRITICAL(&m_ring_mux);
+      if (m_latest >= 0 && m_slots[m_latest].refs == 0) {
+        idle = m_slots[m_latest].fb;
+        m_slots[m_latest].fb = nullptr;
+        m_latest = -1;
+      }
+      portEXIT_CRITICAL(&m_ring_mux);
+      if (idle) {
+        esp_camera_fb_return(idle);
+      } else {
+        m_frames_dropped++;
+        vTaskDelay(pdMS_TO_TICKS(m_capture_interval_ms));
+        continue;
+      }
+    }
+
+    // Cleared before the grab so a request arriving mid-capture gets its own
+    m_snapshot_pending = false;
+    camera_fb_t* fb;
+    {
+      TraceScope trace("cam_fb_get");
+      fb = esp_camera_fb_get();
+      if (fb && !streaming && !m_grab_latest) {
+        // Idle in GRAB_WHEN_EMPTY mode: the queued buffer may be minutes old
+        esp_camera_fb_return(fb);
+        fb = esp_camera_fb_get();
+      }
+    }
+    if (!fb) {
+      vTaskDelay(pdMS_TO_TICKS(100));
+      continue;
+    }
+    publish(fb);
+
+    if (!streaming) {
+      m_snapshot_captures++;
+      continue;
+    }
+
+    #if CAMERA_ADAPTIVE
+    if (millis() - m_adapt_ms >= CAMERA_ADAPT_INTERVAL_MS) {
+      adapt();
+    }
+    #endif
+
+    vTaskDelay(pdMS_TO_TICKS(m_capture_interval_ms));
+  }
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// ADAPTIVE CONTROLLER
+// ════════════════════════════════════════════════════════════════════════════
+
+// Framesizes the controller steps through, largest first
+static const framesize_t ADAPT_LADDER[] = {
+  FRAMESIZE_UXGA, FRAMESIZE_SXGA, FRAMESIZE_HD, FRAMESIZE_XGA,
+  FRAMESIZE_SVGA, FRAMESIZE_VGA, FRAMESIZE_CIF, FRAMESIZE_QVGA, FRAMESIZE_QQVGA
+};
+static const size_t ADAPT_LADDER_LEN = sizeof(ADAPT_LADDER) / sizeof(ADAPT_LADDER[0]);
+
+void CameraManager::reportSendTime(uint32_t send_ms) {
+  portENTER_CRITICAL(&m_ring_mux);
+  if (send_ms > m_window_max_ms) m_window_max_ms = send_ms;
+  portEXIT_CRITICAL(&m_ring_mux);
+}
+
+void CameraManager::adapt() {
+  m_adapt_ms = millis();
+
+  portENTER_CRITICAL(&m_ring_mux);
+  uint32_t worst = m_window_max_ms;
+  m_window_max_ms = 0;
+  portEXIT_CRITICAL(&m_ring_mux);
+  if (worst == 0) return;   // No frames sent this window
+  m_send_ms = worst;
+
+  // Never capture faster than the slowest viewer can take frames
+  uint32_t interval = worst > CAMERA_CAPTURE_INTERVAL_MS ? worst : CAMERA_CAPTURE_INTERVAL_MS;
+  m_capture_interval_ms = interval < CAMERA_CAPTURE_INTERVAL_MAX_MS ? interval : CAMERA_CAPTURE_INTERVAL_MAX_MS;
+
+  size_t rung = 0;
+  while (rung < ADAPT_LADDER_LEN && ADAPT_LADDER[rung] != m_framesize) rung++;
+
+  sensor_t* s = esp_camera_sensor_get();
+  if (!s) return;
+
+  if (worst > CAMERA_ADAPT_TARGET_MS * 3 / 2) {
+    // Too slow: cheaper JPEGs first, then a smaller frame
+    if (m_quality < CAMERA_JPEG_QUALITY_MAX) {
+      m_quality += CAMERA_JPEG_QUALITY_STEP;
+      if (m_quality > CAMERA_JPEG_QUALITY_MAX) m_quality = CAMERA_JPEG_QUALITY_MAX;
+      s->set_quality(s, m_quality);
+    } else if (rung + 1 < ADAPT_LADDER_LEN && m_framesize > CAMERA_ADAPT_MIN_FRAMESIZE &&
+               applyFramesize(ADAPT_LADDER[rung + 1])) {
+      m_quality = CAMERA_JPEG_QUALITY_MIN + CAMERA_JPEG_QUALITY_STEP;
+      s->set_quality(s, m_quality);
+    }
+  } else if (worst < CAMERA_ADAPT_TARGET_MS / 2) {
+    // Headroom: restore framesize first, then quality
+    if (m_framesize < m_framesize_max && rung > 0 && rung < ADAPT_LADDER_LEN &&
+        applyFramesize(ADAPT_LADDER[rung - 1])) {
+      m_quality = CAMERA_JPEG_QUALITY_MAX;
+      s->set_quality(s, m_quality);
+    } else if (m_quality > CAMERA_JPEG_QUALITY_MIN) {
+      m_quality -= CAMERA_JPEG_QUALITY_STEP;
+      if (m_quality < CAMERA_JPEG_QUALITY_MIN) m_quality = CAMERA_JPEG_QUALITY_MIN;
+      s->set_quality(s, m_quality);
+    }
+  }
+}
+
+uint8_t CameraManager::heldFrames() {
+  uint8_t held = 0;
+  portENTER_CRITICAL(&m_ring_mux);
+  for (uint8_t i = 0; i < CAMERA_FB_COUNT; i++) {
+    if (m_slots[i].fb) held++;
+  }
+  portEXIT_CRITICAL(&m_ring_mux);
+  return held;
+}
+
+// Take ownership of fb as the newest frame. The previous newest goes back
+// to the driver unless a viewer is still sending it.
+void CameraManager::publish(camera_fb_t* fb) {
+  camera_fb_t* done = nullptr;
+
+  portENTER_CRITICAL(&m_ring_mux);
+  int8_t slot = -1;
+  for (uint8_t i = 0; i < CAMERA_FB_COUNT; i++) {
+    if (!m_slots[i].fb) {
+      slot = i;
+      break;
+    }
+  }
+  if (slot >= 0) {
+    if (m_latest >= 0 && m_slots[m_latest].refs == 0) {
+      done = m_slots[m_latest].fb;
+      m_slots[m_latest].fb = nullptr;
+    }
+    FrameSlot& s = m_slots[slot];
+    s.fb = fb;
+    s.seq = ++m_frame_seq;
+    s.captured_ms = millis();
+    s.refs = 0;
+    m_latest = slot;
+  }
+  portEXIT_CRITICAL(&m_ring_mux);
+
+  if (slot < 0) {
+    done = fb;               // Cannot happen while captureLoop() gates on heldFrames()
+    m_frames_dropped++;
+  } else {
+    m_frames_captured++;
+  }
+  if (done) esp_camera_fb_return(done);
+}
+
+void CameraManager::addViewer() {
+  portENTER_CRITICAL(&m_ring_mux);
+  m_viewers++;
+  m_peek_active = true;
+  portEXIT_CRITICAL(&m_ring_mux);
+  if (m_capture_task) xTaskNotifyGive(m_capture_task);
+}
+
+void CameraManager::removeViewer() {
+  portENTER_CRITICAL(&m_ring_mux);
+  if (m_viewers > 0) m_viewers--;
+  if (m_viewers == 0) m_peek_active = false;
+  portEXIT_CRITICAL(&m_ring_mux);
+}
+
+bool CameraManager::acquireFrame(uint32_t after_seq, CameraFrame* out, uint32_t timeout_ms) {
+  uint32_t start = millis();
+  for (;;) {
+    bool got = false;
+    portENTER_CRITICAL(&m_ring_mux);
+    if (m_latest >= 0 && m_slots[m_latest].seq > after_seq) {
+      FrameSlot& s = m_slots[m_latest];
+      s.refs++;
+      out->data = s.fb->buf;
+      out->len = s.fb->len;
+      out->seq = s.seq;
+      out->captured_ms = s.captured_ms;
+      out->slot = (uint8_t)m_latest;
+      got = true;
+    }
+    portEXIT_CRITICAL(&m_ring_mux);
+
+    if (got) return true;
+    if (!m_peek_active || millis() - start >= timeout_ms) return false;
+    vTaskDelay(pdMS_TO_TICKS(10));
+  }
+}
+
+bool CameraManager::acquireSnapshot(uint32_t max_age_ms, CameraFrame* out, uint32_t timeout_ms) {
+  if (!m_initialized) return false;
+
+  uint32_t start = millis();
+  bool requested = false;
+  uint32_t stale_seq = UINT32_MAX;   // Anything newer answers our request
+  for (;;) {
+    uint32_t now = millis();
+    bool got = false;
+    bool request = false;
+    portENTER_CRITICAL(&m_ring_mux);
+    if (m_latest >= 0 && (now - m_slots[m_latest].captured_ms <= max_age_ms ||
+                          m_slots[m_latest].seq > stale_seq)) {
+      FrameSlot& s = m_slots[m_latest];
+      s.refs++;
+      out->data = s.fb->buf;
+      out->len = s.fb->len;
+      out->seq = s.seq;
+      out->captured_ms = s.captured_ms;
+      out->slot = (uint8_t)m_latest;
+      got = true;
+    } else if (!requested) {
+      // Concurrent pollers coalesce onto one pending capture
+      m_snapshot_pending = true;
+      stale_seq = m_frame_seq;
+      request = requested = true;
+    }
+    portEXIT_CRITICAL(&m_ring_mux);
+
+    if (got) return true;
+    if (request && m_capture_task) xTaskNotifyGive(m_capture_task);
+    if (!m_initialized || now - start >= timeout_ms) return false;
+    vTaskDelay(pdMS_TO_TICKS(10));
+  }
+}
+
+void CameraManager::releaseFrame(const CameraFrame& frame) {
+  camera_fb_t* done = nullptr;
+  portENTER_CRITICAL(&m_ring_mux);
+  if (frame.slot < CAMERA_FB_COUNT) {
+    FrameSlot& s = m_slots[frame.slot];
+    // Superseded and no longer sent by anyone: back to the driver
+    if (s.fb && s.seq == frame.seq && s.refs > 0 && --s.refs == 0 && frame.slot != m_latest) {
+      done = s.fb;
+      s.fb = nullptr;
+    }
+  }
+  portEXIT_CRITICAL(&m_ring_mux);
+  if (done) esp_camera_fb_return(done);
+}
+
 // ════════════════════════════════════════════════════════════════════════════
 // CONVENIENCE FUNCTIONS
 // ════════════════════════════════════════════════════════════════════════════
@@ -3,6 +3,23 @@
  *
  * Camera initialization, MJPEG streaming, and peek/preview.
  *
+ * While anyone is watching, a single capture task publishes each driver
+ * frame buffer into a reference-counted ring. Viewers send straight from
+ * the driver's PSRAM buffer (no copy) and the buffer goes back to the
+ * driver when the last viewer releases it and a newer frame exists, so the
+ * driver keeps capturing into the rest of its CAMERA_FB_COUNT buffers.
+ * Viewers always take the newest frame, so a slow client skips frames
+ * instead of holding up capture or the other viewers.
+ *
+ * Viewers report how long each frame took to send. Once a second the
+ * controller looks at the slowest viewer and moves capture pacing, JPEG
+ * quality and (as a last resort) framesize toward CAMERA_ADAPT_TARGET_MS,
+ * never above the resolution set with setResolution().
+ *
+ * Stills come from the same ring: acquireSnapshot() shares the newest
+ * frame while it is young enough and otherwise asks the capture task for
+ * one frame, so any number of pollers cost at most one capture per max age.
+ *
  * Copyright (c) 2026 ERRERlabs / Karl May
  * License: Apache-2.0
  */
@@ -16,6 +33,17 @@
 #if FEATURE_CAMERA_PEEK
 
 #include "esp_camera.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// A published frame held by one viewer until releaseFrame()
+struct CameraFrame {
+  const uint8_t* data;
+  size_t len;
+  uint32_t seq;
+  uint32_t captured_ms;
+  uint8_t slot;
+};
 
 // ════════════════════════════════════════════════════════════════════════════
 // CAMERA MANAGER
@@ -43,14 +71,78 @@ public:
   framesize_t getResolution() const { return m_framesize; }
   const char* getResolutionName() const;
 
-  // Capture single frame
+  // Capture single frame (bypasses the ring; not while streaming)
   camera_fb_t* captureFrame();
   void returnFrame(camera_fb_t* fb);
 
+  // Shared stream: the first viewer starts capture, the last one ends peek
+  void addViewer();
+  void removeViewer();
+  uint8_t getViewerCount() const { return m_viewers; }
+
+  // Newest frame with seq > after_seq, waiting up to timeout_ms for one.
+  // The caller owns a reference to the driver buffer until releaseFrame().
+  bool acquireFrame(uint32_t after_seq, CameraFrame* out, uint32_t timeout_ms);
+  void releaseFrame(const CameraFrame& frame);
+
+  // Newest frame no older than max_age_ms, capturing one if needed (no
+  // viewer or peek required). Release with releaseFrame().
+  bool acquireSnapshot(uint32_t max_age_ms, CameraFrame* out, uint32_t timeout_ms);
+
+  // Random per boot; with seq makes a frame ETag unique across reboots
+  uint32_t getBootTag() const { return m_boot_tag; }
+
+  // Viewer's smoothed send time for one frame (feeds the adaptive controller)
+  void reportSendTime(uint32_t send_ms);
+
+  int getJpegQuality() const { return m_quality; }
+  uint32_t getCaptureIntervalMs() const { return m_capture_interval_ms; }
+  uint32_t getSendTimeMs() const { return m_send_ms; }
+
+  uint32_t getFramesCaptured() const { return m_frames_captured; }
+  uint32_t getFramesDropped() const { return m_frames_dropped; }
+  uint32_t getSnapshotCaptures() const { return m_snapshot_captures; }
+
 private:
+  struct FrameSlot {
+    camera_fb_t* fb;        // Driver buffer, nullptr when the slot is free
+    uint32_t seq;
+    uint32_t captured_ms;
+    uint8_t refs;           // Viewers sending this frame
+  };
+
+  static void captureTask(void* arg);
+  void captureLoop();
+  void publish(camera_fb_t* fb);
+  uint8_t heldFrames();
+  void adapt();
+  bool applyFramesize(framesize_t size);
+
   bool m_initialized;
   volatile bool m_peek_active;
-  framesize_t m_framesize;
+  volatile bool m_snapshot_pending;  // A poller is waiting for a fresh frame
+  bool m_grab_latest;               // Driver overwrites stale buffers itself
+  uint32_t m_boot_tag;
+  framesize_t m_framesize;         // Current (may be below the ceiling)
+  framesize_t m_framesize_max;     // Last setResolution()
+
+  // Adaptive controller
+  int m_quality;
+  uint32_t m_capture_interval_ms;
+  uint32_t m_send_ms;              // Slowest viewer in the last window
+  uint32_t m_window_max_ms;
+  uint32_t m_adapt_ms;
+
+  FrameSlot m_slots[CAMERA_FB_COUNT];
+  uint8_t m_fb_count;       // Buffers the driver was given
+  int8_t m_latest;          // Slot holding the newest frame, -1 if none
+  uint32_t m_frame_seq;
+  portMUX_TYPE m_ring_mux;
+  TaskHandle_t m_capture_task;
+  volatile uint8_t m_viewers;
+  uint32_t m_frames_captured;
+  uint32_t m_frames_dropped;   // Capture skipped: every buffer held by viewers
+  uint32_t m_snapshot_captures; // Captures made for snapshots outside a stream
 };
 
 // ════════════════════════════════════════════════════════════════════════════
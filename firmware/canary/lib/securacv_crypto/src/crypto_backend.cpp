@@ -0,0 +1,307 @@
+/*
+ * SecuraCV Canary — Crypto Backend Selection Implementation
+ *
+ * Copyright (c) 2026 ERRERlabs / Karl May
+ * License: Apache-2.0
+ */
+
+#include "crypto_backend.h"
+#include "canary_config.h"
+
+#include <Crypto.h>
+#include <SHA256.h>
+#include <AES.h>
+#include <GCM.h>
+#include "esp_random.h"
+#include "mbedtls/sha256.h"
+#include "mbedtls/gcm.h"
+#include "common/core/midstate_cache.h"
+
+#if defined(CONFIG_MBEDTLS_HARDWARE_SHA)
+  #define MBEDTLS_SHA_HW true
+#else
+  #define MBEDTLS_SHA_HW false
+#endif
+
+#if defined(CONFIG_MBEDTLS_HARDWARE_AES)
+  #define MBEDTLS_AES_HW true
+#else
+  #define MBEDTLS_AES_HW false
+#endif
+
+// ════════════════════════════════════════════════════════════════════════════
+// SOFTWARE BACKEND (rweather Crypto)
+// ════════════════════════════════════════════════════════════════════════════
+
+static void sw_sha256(const uint8_t* data, size_t n, uint8_t out[32]) {
+  SHA256 h;
+  h.update(data, n);
+  h.finalize(out, 32);
+  h.clear();
+}
+
+// Same midstate cache as the mbedtls path, so the benchmark compares like
+// with like: state after domain||0x00, copied per call.
+static MidstateCache<SHA256, SHA256_DOMAIN_CACHE_SIZE> s_sw_midstates;
+
+static void sw_domain_starts(SHA256& h, const char* domain) {
+  uint8_t sep = 0x00;
+  h.reset();
+  h.update(domain, strlen(domain));
+  h.update(&sep, 1);
+}
+
+static void sw_sha256_domain(const char* domain, const uint8_t* data, size_t n, uint8_t out[32]) {
+  const SHA256* pre = s_sw_midstates.get(domain, 0,
+      [domain](SHA256& h) { sw_domain_starts(h, domain); });
+
+  SHA256 h;
+  if (pre) {
+    h = *pre;
+  } else {
+    sw_domain_starts(h, domain);
+  }
+  if (data && n > 0) {
+    h.update(data, n);
+  }
+  h.finalize(out, 32);
+  h.clear();
+}
+
+static bool sw_gcm_encrypt(const uint8_t key[32], const uint8_t iv[12],
+                           const uint8_t* aad, size_t aad_len,
+                           const uint8_t* in, size_t len, uint8_t* out, uint8_t tag[16]) {
+  GCM<AES256> gcm;
+  if (!gcm.setKey(key, 32) || !gcm.setIV(iv, 12)) {
+    gcm.clear();
+    return false;
+  }
+  if (aad && aad_len > 0) gcm.addAuthData(aad, aad_len);
+  gcm.encrypt(out, in, len);
+  gcm.computeTag(tag, 16);
+  gcm.clear();
+  return true;
+}
+
+static bool sw_gcm_decrypt(const uint8_t key[32], const uint8_t iv[12],
+                           const uint8_t* aad, size_t aad_len,
+                           const uint8_t* in, size_t len, uint8_t* out, const uint8_t tag[16]) {
+  GCM<AES256> gcm;
+  if (!gcm.setKey(key, 32) || !gcm.setIV(iv, 12)) {
+    gcm.clear();
+    return false;
+  }
+  if (aad && aad_len > 0) gcm.addAuthData(aad, aad_len);
+  gcm.decrypt(out, in, len);
+  bool ok = gcm.checkTag(tag, 16);
+  gcm.clear();
+  if (!ok) memset(out, 0, len);
+  return ok;
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// MBEDTLS BACKEND (SHA/AES peripherals on ESP32-S3)
+// ════════════════════════════════════════════════════════════════════════════
+
+static void hw_sha256(const uint8_t* data, size_t n, uint8_t out[32]) {
+  mbedtls_sha256_context ctx;
+  mbedtls_sha256_init(&ctx);
+  mbedtls_sha256_starts(&ctx, 0);
+  mbedtls_sha256_update(&ctx, data, n);
+  mbedtls_sha256_finish(&ctx, out);
+  mbedtls_sha256_free(&ctx);
+}
+
+// Midstate after domain||0x00, cached per domain (common/core/midstate_cache.h).
+// Domains past the cache size hash from scratch.
+static MidstateCache<mbedtls_sha256_context, SHA256_DOMAIN_CACHE_SIZE> s_midstates;
+
+static void domain_starts(mbedtls_sha256_context* ctx, const char* domain) {
+  mbedtls_sha256_init(ctx);
+  mbedtls_sha256_starts(ctx, 0);
+  mbedtls_sha256_update(ctx, (const uint8_t*)domain, strlen(domain));
+  uint8_t sep = 0x00;
+  mbedtls_sha256_update(ctx, &sep, 1);
+}
+
+static void hw_sha256_domain(const char* domain, const uint8_t* data, size_t n, uint8_t out[32]) {
+  const mbedtls_sha256_context* pre = s_midstates.get(domain, 0,
+      [domain](mbedtls_sha256_context& ctx) { domain_starts(&ctx, domain); });
+
+  mbedtls_sha256_context ctx;
+  if (pre) {
+    mbedtls_sha256_init(&ctx);
+    mbedtls_sha256_clone(&ctx, pre);
+  } else {
+    domain_starts(&ctx, domain);
+  }
+
+  if (data && n > 0) {
+    mbedtls_sha256_update(&ctx, data, n);
+  }
+
+  mbedtls_sha256_finish(&ctx, out);
+  mbedtls_sha256_free(&ctx);
+}
+
+static bool hw_gcm_encrypt(const uint8_t key[32], const uint8_t iv[12],
+                           const uint8_t* aad, size_t aad_len,
+                           const uint8_t* in, size_t len, uint8_t* out, uint8_t tag[16]) {
+  mbedtls_gcm_context ctx;
+  mbedtls_gcm_init(&ctx);
+  int ret = mbedtls_gcm_setkey(&ctx, MBEDTLS_CIPHER_ID_AES, key, 256);
+  if (ret == 0) {
+    ret = mbedtls_gcm_crypt_and_tag(&ctx, MBEDTLS_GCM_ENCRYPT, len, iv, 12,
+                                    aad, aad_len, in, out, 16, tag);
+  }
+  mbedtls_gcm_free(&ctx);
+  return ret == 0;
+}
+
+static bool hw_gcm_decrypt(const uint8_t key[32], const uint8_t iv[12],
+                           const uint8_t* aad, size_t aad_len,
+                           const uint8_t* in, size_t len, uint8_t* out, const uint8_t tag[16]) {
+  mbedtls_gcm_context ctx;
+  mbedtls_gcm_init(&ctx);
+  int ret = mbedtls_gcm_setkey(&ctx, MBEDTLS_CIPHER_ID_AES, key, 256);
+  if (ret == 0) {
+    // Zeroes the output itself on tag mismatch
+    ret = mbedtls_gcm_auth_decrypt(&ctx, len, iv, 12, aad, aad_len, tag, 16, in, out);
+  }
+  mbedtls_gcm_free(&ctx);
+  return ret == 0;
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// BACKEND TABLE
+// ════════════════════════════════════════════════════════════════════════════
+
+static const CryptoBackendOps s_backends[CRYPTO_BACKEND_COUNT] = {
+  { "software", false, sw_sha256, sw_sha256_domain, sw_gcm_encrypt, sw_gcm_decrypt },
+  { "mbedtls", MBEDTLS_SHA_HW || MBEDTLS_AES_HW, hw_sha256, hw_sha256_domain, hw_gcm_encrypt, hw_gcm_decrypt },
+};
+
+// mbedtls until the benchmark runs, matching the pre-selection behavior
+static volatile CryptoBackendId s_sha256_backend = CRYPTO_BACKEND_MBEDTLS;
+static volatile CryptoBackendId s_gcm_backend = CRYPTO_BACKEND_MBEDTLS;
+static CryptoBenchResult s_bench;
+
+// ════════════════════════════════════════════════════════════════════════════
+// BENCHMARK
+// ════════════════════════════════════════════════════════════════════════════
+
+// FIPS 180-2 test vector: SHA-256("abc")
+static const uint8_t KAT_ABC_SHA256[32] = {
+  0xba, 0x78, 0x16, 0xbf, 0x8f, 0x01, 0xcf, 0xea, 0x41, 0x41, 0x40, 0xde, 0x5d, 0xae, 0x22, 0x23,
+  0xb0, 0x03, 0x61, 0xa3, 0x96, 0x17, 0x7a, 0x9c, 0xb4, 0x10, 0xff, 0x61, 0xf2, 0x00, 0x15, 0xad
+};
+
+// Times the domain-hash path, which nearly every firmware hash goes through
+static uint32_t bench_sha256(const CryptoBackendOps& ops, const uint8_t* buf, size_t len) {
+  uint8_t out[32];
+  uint32_t t0 = micros();
+  for (uint32_t r = 0; r < CRYPTO_BENCH_ROUNDS; r++) {
+    ops.sha256_domain("securacv:bench:v1", buf, len, out);
+  }
+  return micros() - t0;
+}
+
+static uint32_t bench_gcm(const CryptoBackendOps& ops, const uint8_t key[32], const uint8_t iv[12],
+                          const uint8_t* buf, uint8_t* out, size_t len, uint8_t tag[16]) {
+  uint32_t t0 = micros();
+  for (uint32_t r = 0; r < CRYPTO_BENCH_ROUNDS; r++) {
+    ops.gcm_encrypt(key, iv, nullptr, 0, buf, len, out, tag);
+  }
+  return micros() - t0;
+}
+
+void crypto_backend_select() {
+  memset(&s_bench, 0, sizeof(s_bench));
+  s_bench.bench_bytes = CRYPTO_BENCH_BYTES;
+  s_bench.rounds = CRYPTO_BENCH_ROUNDS;
+
+  uint8_t* buf = (uint8_t*)malloc(CRYPTO_BENCH_BYTES * 3);
+  if (!buf) {
+    Serial.println("[WARN] Crypto benchmark skipped (no memory), using mbedtls");
+    s_bench.sha256_backend = s_sha256_backend;
+    s_bench.gcm_backend = s_gcm_backend;
+    return;
+  }
+  uint8_t* ct[2] = { buf + CRYPTO_BENCH_BYTES, buf + 2 * CRYPTO_BENCH_BYTES };
+  uint8_t key[32], iv[12], tag[2][16];
+  esp_fill_random(buf, CRYPTO_BENCH_BYTES);
+  esp_fill_random(key, sizeof(key));
+  esp_fill_random(iv, sizeof(iv));
+
+  for (int b = 0; b < CRYPTO_BACKEND_COUNT; b++) {
+    const CryptoBackendOps& ops = s_backends[b];
+    uint8_t out[32];
+    ops.sha256((const uint8_t*)"abc", 3, out);
+    s_bench.sha256_ok[b] = memcmp(out, KAT_ABC_SHA256, 32) == 0;
+    s_bench.sha256_us[b] = bench_sha256(ops, buf, CRYPTO_BENCH_BYTES);
+    s_bench.gcm_us[b] = bench_gcm(ops, key, iv, buf, ct[b], CRYPTO_BENCH_BYTES, tag[b]);
+  }
+
+  // Cross-check: one backend must decrypt what the other produced
+  uint8_t* pt = ct[0];
+  s_bench.gcm_agree = memcmp(ct[0], ct[1], CRYPTO_BENCH_BYTES) == 0 &&
+                      memcmp(tag[0], tag[1], 16) == 0 &&
+                      s_backends[CRYPTO_BACKEND_SOFTWARE].gcm_decrypt(key, iv, nullptr, 0, ct[1],
+                                                                      CRYPTO_BENCH_BYTES, pt, tag[1]) &&
+                      memcmp(pt, buf, CRYPTO_BENCH_BYTES) == 0;
+
+  memset(key, 0, sizeof(key));
+  free(buf);
+
+  // Only a backend that passed its checks can win
+  CryptoBackendId sha = CRYPTO_BACKEND_MBEDTLS;
+  if (s_bench.sha256_ok[CRYPTO_BACKEND_SOFTWARE] &&
+      (!s_bench.sha256_ok[CRYPTO_BACKEND_MBEDTLS] ||
+       s_bench.sha256_us[CRYPTO_BACKEND_SOFTWARE] < s_bench.sha256_us[CRYPTO_BACKEND_MBEDTLS])) {
+    sha = CRYPTO_BACKEND_SOFTWARE;
+  }
+  CryptoBackendId gcm = CRYPTO_BACKEND_MBEDTLS;
+  if (s_bench.gcm_agree &&
+      s_bench.gcm_us[CRYPTO_BACKEND_SOFTWARE] < s_bench.gcm_us[CRYPTO_BACKEND_MBEDTLS]) {
+    gcm = CRYPTO_BACKEND_SOFTWARE;
+  }
+
+  s_sha256_backend = sha;
+  s_gcm_backend = gcm;
+  s_bench.sha256_backend = sha;
+  s_bench.gcm_backend = gcm;
+  s_bench.ran = true;
+
+  Serial.printf("[OK] Crypto: sha256=%s (%u/%u us), aes-gcm=%s (%u/%u us) [sw/mbedtls, %u x %u B]\n",
+                s_backends[sha].name,
+                s_bench.sha256_us[CRYPTO_BACKEND_SOFTWARE], s_bench.sha256_us[CRYPTO_BACKEND_MBEDTLS],
+                s_backends[gcm].name,
+                s_bench.gcm_us[CRYPTO_BACKEND_SOFTWARE], s_bench.gcm_us[CRYPTO_BACKEND_MBEDTLS],
+                (unsigned)CRYPTO_BENCH_ROUNDS, (unsigned)CRYPTO_BENCH_BYTES);
+  if (!s_bench.sha256_ok[CRYPTO_BACKEND_SOFTWARE] || !s_bench.sha256_ok[CRYPTO_BACKEND_MBEDTLS]) {
+    Serial.println("[!!] SHA-256 backend failed known-answer test");
+  }
+  if (!s_bench.gcm_agree) {
+    Serial.println("[!!] AES-GCM backends disagree - keeping mbedtls");
+  }
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// ACCESSORS
+// ════════════════════════════════════════════════════════════════════════════
+
+const CryptoBackendOps& crypto_backend_sha256() {
+  return s_backends[s_sha256_backend];
+}
+
+const CryptoBackendOps& crypto_backend_gcm() {
+  return s_backends[s_gcm_backend];
+}
+
+const CryptoBackendOps& crypto_backend_get(CryptoBackendId id) {
+  return s_backends[id < CRYPTO_BACKEND_COUNT ? id : CRYPTO_BACKEND_MBEDTLS];
+}
+
+const CryptoBenchResult& crypto_backend_bench() {
+  return s_bench;
+}
@@ -0,0 +1,71 @@
+/*
+ * SecuraCV Canary — Crypto Backend Selection
+ *
+ * SHA-256 and AES-256-GCM each have a software backend (rweather Crypto)
+ * and an mbedtls backend, which the ESP32-S3 build routes to the SHA/AES
+ * peripherals. crypto_backend_select() runs a short benchmark at boot,
+ * checks both backends agree, and routes sha256_raw()/sha256_domain()
+ * and crypto_aes_gcm_*() through the faster one.
+ *
+ * Copyright (c) 2026 ERRERlabs / Karl May
+ * License: Apache-2.0
+ */
+
+#ifndef SECURACV_CRYPTO_BACKEND_H
+#define SECURACV_CRYPTO_BACKEND_H
+
+#include <Arduino.h>
+#include <stdint.h>
+#include <stddef.h>
+
+// ════════════════════════════════════════════════════════════════════════════
+// TYPES
+// ════════════════════════════════════════════════════════════════════════════
+
+enum CryptoBackendId : uint8_t {
+  CRYPTO_BACKEND_SOFTWARE = 0,   // rweather Crypto, CPU only
+  CRYPTO_BACKEND_MBEDTLS  = 1,   // mbedtls (peripheral-backed when accelerated)
+  CRYPTO_BACKEND_COUNT
+};
+
+struct CryptoBackendOps {
+  const char* name;
+  bool hw_accel;            // Build routes this backend to the peripheral
+  void (*sha256)(const uint8_t* data, size_t n, uint8_t out[32]);
+  void (*sha256_domain)(const char* domain, const uint8_t* data, size_t n, uint8_t out[32]);
+  bool (*gcm_encrypt)(const uint8_t key[32], const uint8_t iv[12],
+                      const uint8_t* aad, size_t aad_len,
+                      const uint8_t* in, size_t len, uint8_t* out, uint8_t tag[16]);
+  bool (*gcm_decrypt)(const uint8_t key[32], const uint8_t iv[12],
+                      const uint8_t* aad, size_t aad_len,
+                      const uint8_t* in, size_t len, uint8_t* out, const uint8_t tag[16]);
+};
+
+struct CryptoBenchResult {
+  bool ran;
+  uint32_t bench_bytes;                         // Message size per operation
+  uint32_t rounds;
+  uint32_t sha256_us[CRYPTO_BACKEND_COUNT];     // Total time for all rounds
+  uint32_t gcm_us[CRYPTO_BACKEND_COUNT];
+  bool sha256_ok[CRYPTO_BACKEND_COUNT];         // Passed the known-answer test
+  bool gcm_agree;                               // Both backends produced identical output
+  CryptoBackendId sha256_backend;
+  CryptoBackendId gcm_backend;
+};
+
+// ════════════════════════════════════════════════════════════════════════════
+// BACKEND API
+// ════════════════════════════════════════════════════════════════════════════
+
+// Benchmark both backends and select the faster one per primitive. Call once
+// at boot before any task hashes; until then the mbedtls backend is used.
+void crypto_backend_select();
+
+const CryptoBackendOps& crypto_backend_sha256();
+const CryptoBackendOps& crypto_backend_gcm();
+const CryptoBackendOps& crypto_backend_get(CryptoBackendId id);
+
+// Benchmark results for the status API
+const CryptoBenchResult& crypto_backend_bench();
+
+#endif // SECURACV_CRYPTO_BACKEND_H
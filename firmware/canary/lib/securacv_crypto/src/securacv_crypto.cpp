@@ -7,12 +7,13 @@
 
 #include "securacv_crypto.h"
 #include "canary_config.h"
+#include "crypto_backend.h"
 
 #include <Crypto.h>
 #include <Ed25519.h>
 #include "esp_random.h"
 #include "esp_mac.h"
-#include "mbedtls/sha256.h"
+#include "nvs.h"
 
 // ════════════════════════════════════════════════════════════════════════════
 // NVS MANAGER IMPLEMENTATION
@@ -98,34 +99,180 @@ bool NvsManager::clear() {
   return m_prefs.clear();
 }
 
+// ════════════════════════════════════════════════════════════════════════════
+// NVS TRANSACTION IMPLEMENTATION
+// ════════════════════════════════════════════════════════════════════════════
+
+NvsTransaction::NvsTransaction(const char* ns)
+  : m_ns(ns), m_count(0), m_used(0), m_rejected(false), m_written(0), m_skipped(0) {}
+
+NvsTransaction::~NvsTransaction() {
+  discard();
+}
+
+bool NvsTransaction::putBool(const char* key, bool value) {
+  uint8_t v = value ? 1 : 0;   // Same encoding as Preferences::putBool
+  return stage(key, ENTRY_U8, &v, 1);
+}
+
+bool NvsTransaction::putUChar(const char* key, uint8_t value) {
+  return stage(key, ENTRY_U8, &value, 1);
+}
+
+bool NvsTransaction::putUInt(const char* key, uint32_t value) {
+  return stage(key, ENTRY_U32, &value, sizeof(value));
+}
+
+bool NvsTransaction::putBytes(const char* key, const void* value, size_t len) {
+  // An empty blob removes the key rather than leaving the old value behind
+  if (len == 0) return stage(key, ENTRY_ERASE, nullptr, 0);
+  return stage(key, ENTRY_BLOB, value, len);
+}
+
+bool NvsTransaction::remove(const char* key) {
+  return stage(key, ENTRY_ERASE, nullptr, 0);
+}
+
+bool NvsTransaction::stage(const char* key, EntryType type, const void* value, size_t len) {
+  size_t key_len = strlen(key);
+  if (key_len == 0 || key_len >= sizeof(m_entries[0].key)) {
+    m_rejected = true;
+    return false;
+  }
+
+  Entry* e = nullptr;
+  for (uint8_t i = 0; i < m_count; i++) {
+    if (strcmp(m_entries[i].key, key) == 0) {
+      e = &m_entries[i];
+      break;
+    }
+  }
+
+  // A restaged value reuses its old bytes when it fits there
+  uint16_t off = m_used;
+  if (e && len <= e->len) {
+    off = e->off;
+  } else if (m_used + len > sizeof(m_data)) {
+    m_rejected = true;
+    return false;
+  }
+  if (!e) {
+    if (m_count >= NVS_TXN_MAX_KEYS) {
+      m_rejected = true;
+      return false;
+    }
+    e = &m_entries[m_count++];
+    memcpy(e->key, key, key_len + 1);
+  }
+
+  if (len > 0) memcpy(m_data + off, value, len);
+  if (off == m_used) m_used += len;
+  e->type = type;
+  e->off = off;
+  e->len = (uint16_t)len;
+  return true;
+}
+
+bool NvsTransaction::commit() {
+  m_written = 0;
+  m_skipped = 0;
+  bool ok = !m_rejected;
+
+  nvs_handle_t h;
+  if (m_count > 0 && nvs_open(m_ns, NVS_READWRITE, &h) != ESP_OK) {
+    ok = false;
+  } else if (m_count > 0) {
+    for (uint8_t i = 0; i < m_count; i++) {
+      const Entry& e = m_entries[i];
+      const uint8_t* v = m_data + e.off;
+      esp_err_t err = ESP_OK;
+      bool same = false;
+
+      switch (e.type) {
+        case ENTRY_U8: {
+          uint8_t cur;
+          same = nvs_get_u8(h, e.key, &cur) == ESP_OK && cur == v[0];
+          if (!same) err = nvs_set_u8(h, e.key, v[0]);
+          break;
+        }
+        case ENTRY_U32: {
+          uint32_t cur, val;
+          memcpy(&val, v, sizeof(val));
+          same = nvs_get_u32(h, e.key, &cur) == ESP_OK && cur == val;
+          if (!same) err = nvs_set_u32(h, e.key, val);
+          break;
+        }
+        case ENTRY_BLOB: {
+          size_t cur_len = 0;
+          if (e.len <= NVS_TXN_COMPARE_MAX &&
+              nvs_get_blob(h, e.key, nullptr, &cur_len) == ESP_OK && cur_len == e.len) {
+            uint8_t cur[NVS_TXN_COMPARE_MAX];
+            same = nvs_get_blob(h, e.key, cur, &cur_len) == ESP_OK && memcmp(cur, v, e.len) == 0;
+            secure_zero(cur, sizeof(cur));
+          }
+          if (!same) err = nvs_set_blob(h, e.key, v, e.len);
+          break;
+        }
+        case ENTRY_ERASE:
+          err = nvs_erase_key(h, e.key);
+          if (err == ESP_ERR_NVS_NOT_FOUND) {
+            same = true;
+            err = ESP_OK;
+          }
+          break;
+      }
+
+      if (err != ESP_OK) {
+        ok = false;
+      } else if (same) {
+        m_skipped++;
+      } else {
+        m_written++;
+      }
+    }
+
+    if (m_written > 0 && nvs_commit(h) != ESP_OK) ok = false;
+    nvs_close(h);
+  }
+
+  discard();
+  return ok;
+}
+
+void NvsTransaction::discard() {
+  // Staged values include key material
+  secure_zero(m_data, m_used);
+  m_count = 0;
+  m_used = 0;
+  m_rejected = false;
+}
+
 // ════════════════════════════════════════════════════════════════════════════
 // SHA-256 WITH DOMAIN SEPARATION
 // ════════════════════════════════════════════════════════════════════════════
 
 void sha256_raw(const uint8_t* data, size_t n, uint8_t out[32]) {
-  mbedtls_sha256_context ctx;
-  mbedtls_sha256_init(&ctx);
-  mbedtls_sha256_starts(&ctx, 0);
-  mbedtls_sha256_update(&ctx, data, n);
-  mbedtls_sha256_finish(&ctx, out);
-  mbedtls_sha256_free(&ctx);
+  crypto_backend_sha256().sha256(data, n, out);
 }
 
 void sha256_domain(const char* domain, const uint8_t* data, size_t n, uint8_t out[32]) {
-  mbedtls_sha256_context ctx;
-  mbedtls_sha256_init(&ctx);
-  mbedtls_sha256_starts(&ctx, 0);
+  crypto_backend_sha256().sha256_domain(domain, data, n, out);
+}
 
-  mbedtls_sha256_update(&ctx, (const uint8_t*)domain, strlen(domain));
-  uint8_t sep = 0x00;
-  mbedtls_sha256_update(&ctx, &sep, 1);
+// ════════════════════════════════════════════════════════════════════════════
+// AES-256-GCM
+// ════════════════════════════════════════════════════════════════════════════
 
-  if (data && n > 0) {
-    mbedtls_sha256_update(&ctx, data, n);
-  }
+bool crypto_aes_gcm_encrypt(const uint8_t key[32], const uint8_t iv[12],
+                            const uint8_t* aad, size_t aad_len,
+                            const uint8_t* in, size_t len, uint8_t* out, uint8_t tag[16]) {
+  return crypto_backend_gcm().gcm_encrypt(key, iv, aad, aad_len, in, len, out, tag);
+}
 
-  mbedtls_sha256_finish(&ctx, out);
-  mbedtls_sha256_free(&ctx);
+bool crypto_aes_gcm_decrypt(const uint8_t key[32], const uint8_t iv[12],
+                            const uint8_t* aad, size_t aad_len,
+                            const uint8_t* in, size_t len, uint8_t* out, const uint8_t tag[16]) {
+  return crypto_backend_gcm().gcm_decrypt(key, iv, aad, aad_len, in, len, out, tag);
 }
 
 // ════════════════════════════════════════════════════════════════════════════
@@ -189,11 +336,9 @@ bool nvs_load_key(uint8_t priv[32]) {
 }
 
 bool nvs_store_key(const uint8_t priv[32]) {
-  NvsManager& nvs = NvsManager::instance();
-  if (!nvs.beginReadWrite()) return false;
-  nvs.putBytes(NVS_KEY_PRIV, priv, 32);
-  nvs.end();
-  return true;
+  NvsTransaction tx;
+  tx.putBytes(NVS_KEY_PRIV, priv, 32);
+  return tx.commit();
 }
 
 uint32_t nvs_load_u32(const char* key, uint32_t def) {
@@ -205,11 +350,9 @@ uint32_t nvs_load_u32(const char* key, uint32_t def) {
 }
 
 bool nvs_store_u32(const char* key, uint32_t val) {
-  NvsManager& nvs = NvsManager::instance();
-  if (!nvs.beginReadWrite()) return false;
-  nvs.putUInt(key, val);
-  nvs.end();
-  return true;
+  NvsTransaction tx;
+  tx.putUInt(key, val);
+  return tx.commit();
 }
 
 bool nvs_load_bytes(const char* key, uint8_t* out, size_t len) {
@@ -223,137 +366,16 @@ bool nvs_load_bytes(const char* key, uint8_t* out, size_t len) {
 }
 
 bool nvs_store_bytes(const char* key, const uint8_t* data, size_t len) {
-  NvsManager& nvs = NvsManager::instance();
-  if (!nvs.beginReadWrite()) return false;
-  nvs.putBytes(key, data, len);
-  nvs.end();
-  return true;
-}
-
-// ════════════════════════════════════════════════════════════════════════════
-// CBOR WRITER IMPLEMENTATION
-// ════════════════════════════════════════════════════════════════════════════
-
-CborWriter::CborWriter(uint8_t* buf, size_t cap)
-  : buf_(buf), cap_(cap), pos_(0), error_(false) {}
-
-void CborWriter::write_byte(uint8_t b) {
-  if (pos_ < cap_) {
-    buf_[pos_++] = b;
-  } else {
-    error_ = true;
-  }
-}
-
-void CborWriter::write_map(size_t n) {
-  if (n <= 23) {
-    write_byte(0xA0 + n);
-  } else if (n <= 255) {
-    write_byte(0xB8);
-    write_byte(n);
-  } else {
-    write_byte(0xB9);
-    write_byte((n >> 8) & 0xFF);
-    write_byte(n & 0xFF);
-  }
-}
-
-void CborWriter::write_text(const char* s) {
-  size_t len = strlen(s);
-  if (len <= 23) {
-    write_byte(0x60 + len);
-  } else if (len <= 255) {
-    write_byte(0x78);
-    write_byte(len);
-  } else {
-    write_byte(0x79);
-    write_byte((len >> 8) & 0xFF);
-    write_byte(len & 0xFF);
-  }
-  for (size_t i = 0; i < len; i++) {
-    write_byte(s[i]);
-  }
-}
-
-void CborWriter::write_uint(uint64_t v) {
-  if (v <= 23) {
-    write_byte(v);
-  } else if (v <= 255) {
-    write_byte(0x18);
-    write_byte(v);
-  } else if (v <= 65535) {
-    write_byte(0x19);
-    write_byte((v >> 8) & 0xFF);
-    write_byte(v & 0xFF);
-  } else if (v <= 0xFFFFFFFF) {
-    write_byte(0x1A);
-    write_byte((v >> 24) & 0xFF);
-    write_byte((v >> 16) & 0xFF);
-    write_byte((v >> 8) & 0xFF);
-    write_byte(v & 0xFF);
-  } else {
-    write_byte(0x1B);
-    for (int i = 7; i >= 0; i--) {
-      write_byte((v >> (i * 8)) & 0xFF);
-    }
-  }
-}
-
-void CborWriter::write_int(int64_t v) {
-  if (v >= 0) {
-    write_uint((uint64_t)v);
-  } else {
-    uint64_t neg = (uint64_t)(-(v + 1));
-    if (neg <= 23) {
-      write_byte(0x20 + neg);
-    } else if (neg <= 255) {
-      write_byte(0x38);
-      write_byte(neg);
-    } else if (neg <= 65535) {
-      write_byte(0x39);
-      write_byte((neg >> 8) & 0xFF);
-      write_byte(neg & 0xFF);
-    } else {
-      write_byte(0x3A);
-      write_byte((neg >> 24) & 0xFF);
-      write_byte((neg >> 16) & 0xFF);
-      write_byte((neg >> 8) & 0xFF);
-      write_byte(neg & 0xFF);
-    }
-  }
-}
-
-void CborWriter::write_bool(bool v) {
-  write_byte(v ? 0xF5 : 0xF4);
-}
-
-void CborWriter::write_null() {
-  write_byte(0xF6);
-}
-
-void CborWriter::write_float(double v) {
-  write_byte(0xFB);
-  union { double d; uint64_t u; } conv;
-  conv.d = v;
-  for (int i = 7; i >= 0; i--) {
-    write_byte((conv.u >> (i * 8)) & 0xFF);
-  }
+  NvsTransaction tx;
+  tx.putBytes(key, data, len);
+  return tx.commit();
 }
 
-void CborWriter::write_bytes(const uint8_t* data, size_t len) {
-  if (len <= 23) {
-    write_byte(0x40 + len);
-  } else if (len <= 255) {
-    write_byte(0x58);
-    write_byte(len);
-  } else {
-    write_byte(0x59);
-    write_byte((len >> 8) & 0xFF);
-    write_byte(len & 0xFF);
-  }
-  for (size_t i = 0; i < len; i++) {
-    write_byte(data[i]);
-  }
+bool nvs_store_chain(uint32_t seq, const uint8_t head[32]) {
+  NvsTransaction tx;
+  tx.putUInt(NVS_KEY_SEQ, seq);
+  tx.putBytes(NVS_KEY_CHAIN, head, 32);
+  return tx.commit();
 }
 
 // ════════════════════════════════════════════════════════════════════════════
@@ -374,6 +396,24 @@ void hex_to_str(char* out, const uint8_t* d, size_t n) {
   out[n*2] = 0;
 }
 
+static int hex_nibble(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+bool hex_parse(uint8_t* out, const char* hex, size_t n) {
+  if (strlen(hex) != n * 2) return false;
+  for (size_t i = 0; i < n; i++) {
+    int hi = hex_nibble(hex[i*2]);
+    int lo = hex_nibble(hex[i*2+1]);
+    if (hi < 0 || lo < 0) return false;
+    out[i] = (uint8_t)((hi << 4) | lo);
+  }
+  return true;
+}
+
 void generate_device_id(char* out, size_t cap, const char* prefix) {
   uint8_t mac[6];
   esp_read_mac(mac, ESP_MAC_WIFI_STA);
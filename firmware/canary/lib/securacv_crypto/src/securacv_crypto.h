@@ -1,8 +1,8 @@
 /*
  * SecuraCV Canary — Cryptographic Primitives
  *
- * Ed25519 key management, SHA256 hash chain with domain separation,
- * and CBOR encoding helpers.
+ * Ed25519 key management and SHA256 hash chain with domain separation.
+ * CBOR encoding lives in common/encoding/cbor.h.
  *
  * Copyright (c) 2026 ERRERlabs / Karl May
  * License: Apache-2.0
@@ -15,6 +15,7 @@
 #include <Preferences.h>
 #include <stdint.h>
 #include <stddef.h>
+#include "canary_config.h"
 
 // ════════════════════════════════════════════════════════════════════════════
 // NVS MANAGER
@@ -64,6 +65,72 @@ private:
   bool m_readOnly;
 };
 
+// ════════════════════════════════════════════════════════════════════════════
+// NVS TRANSACTION
+// ════════════════════════════════════════════════════════════════════════════
+
+// Stages several key updates and applies them with one namespace open and one
+// nvs_commit(). Preferences commits after every put, so N keys through
+// NvsManager cost N commits; a transaction costs one, and a staged value that
+// already matches the stored one is not rewritten at all.
+//
+// Entries are applied in staging order. NVS has no multi-key atomicity, so a
+// reset mid-commit can leave the earlier entries written and the later ones
+// not: stage the key that makes the others meaningful last.
+//
+//   NvsTransaction tx;
+//   tx.putBytes(NVS_KEY_WIFI_SSID, ssid, ssid_len);
+//   tx.putBool(NVS_KEY_WIFI_EN, true);
+//   tx.commit();
+class NvsTransaction {
+public:
+  explicit NvsTransaction(const char* ns = NVS_MAIN_NS);
+  ~NvsTransaction();
+
+  // Staging; false when the key is too long or the transaction is full.
+  // Staging a key again replaces its earlier value.
+  bool putBool(const char* key, bool value);
+  bool putUChar(const char* key, uint8_t value);
+  bool putUInt(const char* key, uint32_t value);
+  bool putBytes(const char* key, const void* value, size_t len);
+  bool remove(const char* key);
+
+  // Apply everything staged and clear the stage. False if the namespace did
+  // not open, any write failed, or an earlier put was rejected.
+  bool commit();
+
+  // Drop everything staged without writing
+  void discard();
+
+  size_t pending() const { return m_count; }
+  uint8_t written() const { return m_written; }   // Set by the last commit()
+  uint8_t skipped() const { return m_skipped; }   // Unchanged, not rewritten
+
+  NvsTransaction(const NvsTransaction&) = delete;
+  NvsTransaction& operator=(const NvsTransaction&) = delete;
+
+private:
+  enum EntryType : uint8_t { ENTRY_U8, ENTRY_U32, ENTRY_BLOB, ENTRY_ERASE };
+
+  struct Entry {
+    char key[16];           // NVS keys are at most 15 characters
+    EntryType type;
+    uint16_t off;           // Value offset in m_data
+    uint16_t len;
+  };
+
+  bool stage(const char* key, EntryType type, const void* value, size_t len);
+
+  const char* m_ns;
+  Entry m_entries[NVS_TXN_MAX_KEYS];
+  uint8_t m_data[NVS_TXN_MAX_BYTES];
+  uint8_t m_count;
+  uint16_t m_used;
+  bool m_rejected;
+  uint8_t m_written;
+  uint8_t m_skipped;
+};
+
 // ════════════════════════════════════════════════════════════════════════════
 // SHA-256 WITH DOMAIN SEPARATION
 // ════════════════════════════════════════════════════════════════════════════
@@ -72,8 +139,26 @@ private:
 void sha256_raw(const uint8_t* data, size_t n, uint8_t out[32]);
 
 // Domain-separated SHA-256: H(domain || 0x00 || data)
+// The state after domain||0x00 is cached per domain (SHA256_DOMAIN_CACHE_SIZE
+// entries), so domain must be a string with static lifetime (a literal).
 void sha256_domain(const char* domain, const uint8_t* data, size_t n, uint8_t out[32]);
 
+// Both run on the backend picked by crypto_backend_select() (crypto_backend.h)
+
+// ════════════════════════════════════════════════════════════════════════════
+// AES-256-GCM
+// ════════════════════════════════════════════════════════════════════════════
+
+// Encrypt len bytes with a 96-bit IV and 128-bit tag; out may not alias in
+bool crypto_aes_gcm_encrypt(const uint8_t key[32], const uint8_t iv[12],
+                            const uint8_t* aad, size_t aad_len,
+                            const uint8_t* in, size_t len, uint8_t* out, uint8_t tag[16]);
+
+// Decrypt and authenticate; false (and out zeroed) on tag mismatch
+bool crypto_aes_gcm_decrypt(const uint8_t key[32], const uint8_t iv[12],
+                            const uint8_t* aad, size_t aad_len,
+                            const uint8_t* in, size_t len, uint8_t* out, const uint8_t tag[16]);
+
 // ════════════════════════════════════════════════════════════════════════════
 // ED25519 CRYPTO
 // ════════════════════════════════════════════════════════════════════════════
@@ -110,34 +195,8 @@ bool nvs_store_u32(const char* key, uint32_t val);
 bool nvs_load_bytes(const char* key, uint8_t* out, size_t len);
 bool nvs_store_bytes(const char* key, const uint8_t* data, size_t len);
 
-// ════════════════════════════════════════════════════════════════════════════
-// CBOR WRITER
-// ════════════════════════════════════════════════════════════════════════════
-
-class CborWriter {
-public:
-  CborWriter(uint8_t* buf, size_t cap);
-
-  void write_map(size_t n);
-  void write_text(const char* s);
-  void write_uint(uint64_t v);
-  void write_int(int64_t v);
-  void write_bool(bool v);
-  void write_null();
-  void write_float(double v);
-  void write_bytes(const uint8_t* data, size_t len);
-
-  size_t size() const { return pos_; }
-  bool ok() const { return !error_; }
-
-private:
-  void write_byte(uint8_t b);
-
-  uint8_t* buf_;
-  size_t cap_;
-  size_t pos_;
-  bool error_;
-};
+// Chain seq and head in one transaction; unchanged values are not rewritten
+bool nvs_store_chain(uint32_t seq, const uint8_t head[32]);
 
 // ════════════════════════════════════════════════════════════════════════════
 // UTILITY FUNCTIONS
@@ -149,6 +208,9 @@ void secure_zero(void* p, size_t n);
 // Convert bytes to hex string
 void hex_to_str(char* out, const uint8_t* d, size_t n);
 
+// Parse exactly 2n hex digits (either case) into n bytes
+bool hex_parse(uint8_t* out, const char* hex, size_t n);
+
 // Generate device ID from MAC address
 void generate_device_id(char* out, size_t cap, const char* prefix);
 
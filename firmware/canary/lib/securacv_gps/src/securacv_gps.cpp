@@ -6,8 +6,10 @@
  */
 
 #include "securacv_gps.h"
+#include "securacv_metrics.h"
+#include "perf_profiler.h"
+#include "common/gnss/nmea_tokenizer.h"
 #include <string.h>
-#include <stdlib.h>
 
 // ════════════════════════════════════════════════════════════════════════════
 // UTILITY FUNCTIONS
@@ -33,6 +35,15 @@ const char* quality_name(int q) {
   }
 }
 
+const char* gps_protocol_name(GpsProtocol p) {
+  switch (p) {
+    case GPS_PROTOCOL_NMEA:      return "NMEA";
+    case GPS_PROTOCOL_UBX_PROBE: return "UBX?";
+    case GPS_PROTOCOL_UBX:       return "UBX";
+    default:                     return "?";
+  }
+}
+
 float knots_to_mps(float knots) {
   return knots * 0.514444f;
 }
@@ -45,114 +56,318 @@ float knots_to_kmh(float knots) {
 // GPS MANAGER IMPLEMENTATION
 // ════════════════════════════════════════════════════════════════════════════
 
+static MetricId s_parse_latency = METRIC_NONE;
+static PerfScopeId s_drain_perf = PERF_SCOPE_NONE;
+
 GpsManager::GpsManager()
-  : m_serial(nullptr), m_rb_head(0), m_rb_tail(0), m_rb_count(0),
-    m_line_len(0), m_sentence_count(0), m_checksum_errors(0), m_first_fix_ms(0),
-    m_gga_count(0), m_rmc_count(0), m_gsa_count(0), m_gsv_count(0), m_vtg_count(0) {
+  : m_port((uart_port_t)GPS_UART_NUM), m_uart_ready(false), m_uart_events(nullptr),
+    m_task(nullptr), m_notify_group(nullptr), m_notify_bits(0), m_line_len(0), m_protocol(GPS_PROTOCOL_NMEA), m_probe_start_ms(0),
+    m_snap_seq(0),
+    m_sentence_count(0), m_checksum_errors(0), m_first_fix_ms(0),
+    m_gga_count(0), m_rmc_count(0), m_gsa_count(0), m_gsv_count(0), m_vtg_count(0),
+    m_ubx_pvt_count(0), m_overflows(0) {
   memset(&m_fix, 0, sizeof(m_fix));
   m_fix.hdop = 99.9;
   m_fix.pdop = 99.9;
   m_fix.vdop = 99.9;
   m_fix.fix_mode = FIX_MODE_NONE;
   memset(&m_utc, 0, sizeof(m_utc));
+  ubx_parser_init(&m_ubx);
+  m_snap.fix = m_fix;
+  m_snap.utc = m_utc;
+  track_ring_init(&m_track);
+  m_track_lock = portMUX_INITIALIZER_UNLOCKED;
+}
+
+void GpsManager::begin(uart_port_t port, uint32_t baud, int rx_pin, int tx_pin) {
+  m_port = port;
+  s_parse_latency = metrics_histogram("securacv_gps_parse_duration_seconds",
+                                      "NMEA sentence parse time");
+  s_drain_perf = perf_scope("gps_drain");
+
+  uart_config_t cfg = {};
+  cfg.baud_rate = (int)baud;
+  cfg.data_bits = UART_DATA_8_BITS;
+  cfg.parity = UART_PARITY_DISABLE;
+  cfg.stop_bits = UART_STOP_BITS_1;
+  cfg.flow_ctrl = UART_HW_FLOWCTRL_DISABLE;
+#if FEATURE_POWER_MANAGEMENT
+  cfg.source_clk = UART_SCLK_XTAL;       // APB changes with the CPU clock under DFS
+#else
+  cfg.source_clk = UART_SCLK_APB;
+#endif
+
+  if (uart_driver_install(m_port, GPS_UART_RX_BUF, 0, GPS_UART_EVENT_QUEUE, &m_uart_events, 0) != ESP_OK ||
+      uart_param_config(m_port, &cfg) != ESP_OK ||
+      uart_set_pin(m_port, tx_pin, rx_pin, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE) != ESP_OK) {
+    Serial.println("[!!] GPS UART driver install failed");
+    return;
+  }
+  m_uart_ready = true;
+
+  #if GPS_UBX_ENABLE
+  startUbxProbe();
+  #endif
+
+  if (xTaskCreatePinnedToCore(ingestTask, "gps_ingest", GPS_TASK_STACK, this,
+                              GPS_TASK_PRIORITY, &m_task, GPS_TASK_CORE) != pdPASS) {
+    m_task = nullptr;
+    Serial.println("[!!] GPS task creation failed; polling from loop()");
+  }
+  Serial.printf("[GPS] UART%d: %u baud, RX=GPIO%d, TX=GPIO%d\n", (int)port, baud, rx_pin, tx_pin);
 }
 
-void GpsManager::begin(HardwareSerial& serial, uint32_t baud, int rx_pin, int tx_pin) {
-  m_serial = &serial;
-  m_serial->begin(baud, SERIAL_8N1, rx_pin, tx_pin);
-  Serial.printf("[GPS] UART: %u baud, RX=GPIO%d, TX=GPIO%d\n", baud, rx_pin, tx_pin);
+void GpsManager::setPublishNotify(EventGroupHandle_t group, EventBits_t bits) {
+  m_notify_bits = bits;
+  m_notify_group = group;
 }
 
 void GpsManager::update() {
-  if (!m_serial) return;
-
-  // Read data into ring buffer
-  while (m_serial->available()) {
-    if (m_rb_count < RB_SIZE) {
-      m_rb[m_rb_head] = m_serial->read();
-      m_rb_head = (m_rb_head + 1) % RB_SIZE;
-      m_rb_count++;
-    } else {
-      break;
+  if (m_uart_ready && !m_task) {
+    drain();
+    checkUbxProbe();
+  }
+}
+
+void GpsManager::ingestTask(void* arg) {
+  ((GpsManager*)arg)->ingestLoop();
+}
+
+void GpsManager::ingestLoop() {
+  uart_event_t ev;
+  for (;;) {
+    // Wake periodically only while a UBX probe may need to time out
+    TickType_t wait = m_protocol == GPS_PROTOCOL_UBX_PROBE ? pdMS_TO_TICKS(100) : portMAX_DELAY;
+    if (xQueueReceive(m_uart_events, &ev, wait) != pdTRUE) {
+      checkUbxProbe();
+      continue;
+    }
+
+    switch (ev.type) {
+      case UART_DATA:
+        drain();
+        break;
+
+      case UART_FIFO_OVF:
+      case UART_BUFFER_FULL:
+        // Bytes are gone; drop the partial sentence rather than splice it
+        m_overflows++;
+        uart_flush_input(m_port);
+        xQueueReset(m_uart_events);
+        m_line_len = 0;
+        ubx_parser_init(&m_ubx);
+        break;
+
+      default:
+        break;
     }
   }
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// UBX
+// ════════════════════════════════════════════════════════════════════════════
+
+void GpsManager::sendUbx(const uint8_t* frame, size_t len) {
+  if (len > 0) uart_write_bytes(m_port, (const char*)frame, len);
+}
 
-  // Parse NMEA lines
-  char line[256];
-  size_t len;
-  while (readNmeaLine(line, sizeof(line), &len)) {
-    parseNmea(line);
+// Ask for NAV-PVT on this port; a u-blox receiver answers with ACK-ACK
+void GpsManager::startUbxProbe() {
+  uint8_t frame[16];
+  sendUbx(frame, ubx_cfg_msg(frame, sizeof(frame), UBX_CLASS_NAV, UBX_NAV_PVT, 1));
+  m_probe_start_ms = millis();
+  m_protocol = GPS_PROTOCOL_UBX_PROBE;
+}
+
+void GpsManager::checkUbxProbe() {
+  if (m_protocol == GPS_PROTOCOL_UBX_PROBE && millis() - m_probe_start_ms >= GPS_UBX_PROBE_MS) {
+    m_protocol = GPS_PROTOCOL_NMEA;
+    Serial.println("[GPS] No UBX response; using NMEA");
   }
 }
 
-float GpsManager::getSpeedMps() const {
-  return knots_to_mps(m_fix.speed_knots);
+void GpsManager::onUbxFrame() {
+  bool ack = false;
+  if (ubx_ack_for(&m_ubx, UBX_CLASS_CFG, UBX_CFG_MSG, &ack)) {
+    if (m_protocol != GPS_PROTOCOL_UBX_PROBE) return;
+    if (!ack) {
+      m_protocol = GPS_PROTOCOL_NMEA;
+      Serial.println("[GPS] Receiver refused NAV-PVT; using NMEA");
+      return;
+    }
+
+    // NAV-PVT carries everything the five NMEA sentences did
+    static const uint8_t NMEA_IDS[] = {
+      UBX_NMEA_GGA, UBX_NMEA_GSA, UBX_NMEA_GSV, UBX_NMEA_RMC, UBX_NMEA_VTG
+    };
+    uint8_t frame[16];
+    for (uint8_t id : NMEA_IDS) {
+      sendUbx(frame, ubx_cfg_msg(frame, sizeof(frame), UBX_CLASS_NMEA, id, 0));
+    }
+    if (GPS_UBX_RATE_MS > 0) {
+      sendUbx(frame, ubx_cfg_rate(frame, sizeof(frame), GPS_UBX_RATE_MS));
+    }
+    m_protocol = GPS_PROTOCOL_UBX;
+    Serial.println("[GPS] u-blox receiver: UBX NAV-PVT enabled, NMEA off");
+    return;
+  }
+
+  ubx_nav_pvt_t pvt;
+  if (ubx_is(&m_ubx, UBX_CLASS_NAV, UBX_NAV_PVT) &&
+      ubx_decode_nav_pvt(m_ubx.payload, m_ubx.len, &pvt)) {
+    MetricTimer timer(s_parse_latency);
+    applyNavPvt(pvt);
+  }
+}
+
+void GpsManager::applyNavPvt(const ubx_nav_pvt_t& pvt) {
+  uint32_t now = millis();
+  m_ubx_pvt_count++;
+
+  bool position = pvt.fix_type >= 2 && pvt.fix_type <= 4;
+  m_fix.valid = pvt.fix_ok && position;
+  m_fix.quality = m_fix.valid ? 1 : 0;
+  m_fix.fix_mode = pvt.fix_type == 2 ? FIX_MODE_2D : position ? FIX_MODE_3D : FIX_MODE_NONE;
+  m_fix.satellites = pvt.num_sv;
+  m_fix.sats_in_view = pvt.num_sv;
+  m_fix.lat = pvt.lat_e7 / 1e7;
+  m_fix.lon = pvt.lon_e7 / 1e7;
+  m_fix.altitude_m = pvt.hmsl_mm / 1000.0;
+  m_fix.geoid_sep_m = (pvt.height_mm - pvt.hmsl_mm) / 1000.0;
+  m_fix.speed_knots = pvt.ground_speed_mms / 514.444;
+  m_fix.speed_kmh = pvt.ground_speed_mms * 0.0036;
+  m_fix.course_deg = pvt.heading_e5 / 1e5;
+  m_fix.pdop = pvt.pdop_e2 / 100.0;
+  m_fix.hdop = m_fix.pdop;          // NAV-PVT has no HDOP; PDOP bounds it from above
+  m_fix.last_update_ms = now;
+
+  if (pvt.date_valid && pvt.time_valid) {
+    m_utc.year = pvt.year;
+    m_utc.month = pvt.month;
+    m_utc.day = pvt.day;
+    m_utc.hour = pvt.hour;
+    m_utc.minute = pvt.minute;
+    m_utc.second = pvt.second;
+    m_utc.centisecond = pvt.nano > 0 ? pvt.nano / 10000000 : 0;
+    m_utc.valid = true;
+    m_utc.last_seen_ms = now;
+  }
+
+  if (m_fix.valid) {
+    recordTrack(pvt.lat_e7, pvt.lon_e7, now);
+    if (m_first_fix_ms == 0) m_first_fix_ms = now;
+  }
+}
+
+void GpsManager::recordTrack(int32_t lat_e7, int32_t lon_e7, uint32_t now) {
+  portENTER_CRITICAL(&m_track_lock);
+  track_ring_push(&m_track, lat_e7, lon_e7, now);
+  portEXIT_CRITICAL(&m_track_lock);
+}
+
+size_t GpsManager::takeTrack(track_point_t* out, size_t cap) {
+  portENTER_CRITICAL(&m_track_lock);
+  size_t n = track_ring_drain(&m_track, out, cap);
+  portEXIT_CRITICAL(&m_track_lock);
+  return n;
 }
 
-bool GpsManager::readNmeaLine(char* out, size_t cap, size_t* len) {
-  while (m_rb_count > 0) {
-    uint8_t b = m_rb[m_rb_tail];
-    m_rb_tail = (m_rb_tail + 1) % RB_SIZE;
-    m_rb_count--;
+// Read everything the driver holds, parse it, then publish once
+void GpsManager::drain() {
+  PerfTimer perf(s_drain_perf);
+  uint8_t chunk[128];
+  bool parsed = false;
+  for (;;) {
+    int n = uart_read_bytes(m_port, chunk, sizeof(chunk), 0);
+    if (n <= 0) break;
+    uint32_t before = m_sentence_count + m_ubx_pvt_count;
+    feed(chunk, (size_t)n);
+    parsed |= m_sentence_count + m_ubx_pvt_count != before;
+  }
+  if (parsed) publish();
+}
+
+void GpsManager::feed(const uint8_t* data, size_t len) {
+  for (size_t i = 0; i < len; i++) {
+    uint8_t b = data[i];
+
+    // UBX and NMEA share the stream; the framer claims binary bytes
+    ubx_feed_t r = ubx_parser_feed(&m_ubx, b);
+    if (r == UBX_FEED_FRAME) onUbxFrame();
+    if (r == UBX_FEED_RESYNC) {
+      // A bad header gives back what it held; it may be NMEA or a new sync
+      uint8_t replay[UBX_REPLAY_MAX];
+      feed(replay, ubx_take_replay(&m_ubx, replay));
+    }
+    if (r != UBX_FEED_IDLE) continue;
 
     if (b == '\n' || b == '\r') {
       if (m_line_len > 0) {
-        size_t copy_len = (m_line_len < cap - 1) ? m_line_len : cap - 1;
-        memcpy(out, m_line_buf, copy_len);
-        out[copy_len] = '\0';
-        *len = copy_len;
+        m_line_buf[m_line_len] = '\0';
         m_line_len = 0;
-        return true;
+        MetricTimer timer(s_parse_latency);
+        parseNmea(m_line_buf);
       }
     } else if (m_line_len < sizeof(m_line_buf) - 1) {
       m_line_buf[m_line_len++] = b;
     }
   }
-  return false;
 }
 
-static int parse_int(const char* s, int def) {
-  if (!s || !*s) return def;
-  return atoi(s);
-}
+// Seqlock write side; only the ingesting task calls this
+void GpsManager::publish() {
+  m_snap_seq = m_snap_seq + 1;
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  m_snap.fix = m_fix;
+  m_snap.utc = m_utc;
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  m_snap_seq = m_snap_seq + 1;
 
-static double parse_double(const char* s, double def) {
-  if (!s || !*s) return def;
-  return atof(s);
+  if (m_notify_group) xEventGroupSetBits(m_notify_group, m_notify_bits);
 }
 
-static char* get_field(char* s, int field) {
-  int f = 0;
-  char* p = s;
-  while (*p && f < field) {
-    if (*p == ',') f++;
-    p++;
+void GpsManager::readSnapshot(Snapshot* out) const {
+  for (;;) {
+    uint32_t seq = m_snap_seq;
+    if (seq & 1) continue;     // Writer mid-copy; it outranks every reader
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    *out = m_snap;
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (m_snap_seq == seq) return;
   }
-  if (f != field) return nullptr;
-  return p;
 }
 
-// Validate NMEA checksum (XOR of all chars between $ and *)
-static bool validate_nmea_checksum(const char* line) {
-  if (line[0] != '$') return false;
+GnssFix GpsManager::getFix() const {
+  Snapshot snap;
+  readSnapshot(&snap);
+  return snap.fix;
+}
 
-  const char* star = strchr(line, '*');
-  if (!star || star - line < 2) return false;
+GpsUtcTime GpsManager::getUtcTime() const {
+  Snapshot snap;
+  readSnapshot(&snap);
+  return snap.utc;
+}
 
-  // Calculate XOR checksum of characters between $ and *
-  uint8_t calc = 0;
-  for (const char* p = line + 1; p < star; p++) {
-    calc ^= (uint8_t)*p;
-  }
+float GpsManager::getSpeedMps() const {
+  return knots_to_mps(getFix().speed_knots);
+}
 
-  // Parse expected checksum (2 hex digits after *)
-  if (strlen(star) < 3) return false;
-  char hex[3] = { star[1], star[2], '\0' };
-  uint8_t expected = (uint8_t)strtoul(hex, nullptr, 16);
+// Fixed-point field as double, or def if empty
+static double field_fixed(const nmea_sentence_t& s, uint8_t i, uint8_t decimals, double def) {
+  static const double SCALE[] = { 1.0, 10.0, 100.0, 1000.0 };
+  int32_t v;
+  if (decimals > 3 || !nmea_parse_fixed(nmea_field(&s, i), decimals, &v)) return def;
+  return v / SCALE[decimals];
+}
 
-  return calc == expected;
+static int field_int(const nmea_sentence_t& s, uint8_t i, int def) {
+  uint32_t v;
+  return nmea_parse_uint(nmea_field(&s, i), &v) ? (int)v : def;
 }
 
+// Tokenized once (fields and checksum in one pass); field lookups are O(1)
 void GpsManager::parseNmea(char* line) {
   m_sentence_count++;
 
@@ -160,131 +375,92 @@ void GpsManager::parseNmea(char* line) {
   Serial.println(line);
   #endif
 
-  // Verify sentence format
-  if (line[0] != '$') return;
-  char* star = strchr(line, '*');
-  if (!star) return;
-
-  // Validate checksum for data integrity
-  if (!validate_nmea_checksum(line)) {
+  nmea_sentence_t s;
+  nmea_status_t st = nmea_tokenize(line, &s);
+  if (st == NMEA_ERR_CHECKSUM) {
     m_checksum_errors++;
     return;
   }
+  if (st != NMEA_OK) return;
 
-  // Parse sentence type
-  char* type = line + 3;  // Skip $XX
-
-  if (strncmp(type, "GGA", 3) == 0) {
+  if (nmea_type_is(&s, "GGA")) {
     m_gga_count++;
-    char* lat_str = get_field(line, 2);
-    char* lat_dir = get_field(line, 3);
-    char* lon_str = get_field(line, 4);
-    char* lon_dir = get_field(line, 5);
-    char* quality = get_field(line, 6);
-    char* sats = get_field(line, 7);
-    char* hdop_str = get_field(line, 8);
-    char* alt_str = get_field(line, 9);
-    char* geoid_str = get_field(line, 11);
-
-    m_fix.quality = parse_int(quality, 0);
-    m_fix.satellites = parse_int(sats, 0);
-    m_fix.hdop = parse_double(hdop_str, 99.9);
-    m_fix.altitude_m = parse_double(alt_str, 0);
-    m_fix.geoid_sep_m = parse_double(geoid_str, 0);
-
-    if (lat_str && *lat_str) {
-      double lat_raw = parse_double(lat_str, 0);
-      int lat_deg = (int)(lat_raw / 100);
-      double lat_min = lat_raw - lat_deg * 100;
-      m_fix.lat = lat_deg + lat_min / 60.0;
-      if (lat_dir && *lat_dir == 'S') m_fix.lat = -m_fix.lat;
-    }
-
-    if (lon_str && *lon_str) {
-      double lon_raw = parse_double(lon_str, 0);
-      int lon_deg = (int)(lon_raw / 100);
-      double lon_min = lon_raw - lon_deg * 100;
-      m_fix.lon = lon_deg + lon_min / 60.0;
-      if (lon_dir && *lon_dir == 'W') m_fix.lon = -m_fix.lon;
-    }
-
+    m_fix.quality = field_int(s, 6, 0);
+    m_fix.satellites = field_int(s, 7, 0);
+    m_fix.hdop = field_fixed(s, 8, 2, 99.9);
+    m_fix.altitude_m = field_fixed(s, 9, 2, 0);
+    m_fix.geoid_sep_m = field_fixed(s, 11, 2, 0);
+
+    int32_t lat_e7, lon_e7;
+    bool have_lat = nmea_parse_coord(nmea_field(&s, 2), nmea_field(&s, 3), &lat_e7);
+    bool have_lon = nmea_parse_coord(nmea_field(&s, 4), nmea_field(&s, 5), &lon_e7);
+    if (have_lat) m_fix.lat = lat_e7 / 1e7;
+    if (have_lon) m_fix.lon = lon_e7 / 1e7;
+
+    uint32_t now = millis();
     m_fix.valid = (m_fix.quality > 0);
-    m_fix.last_gga_ms = millis();
-    m_fix.last_update_ms = millis();
+    m_fix.last_gga_ms = now;
+    m_fix.last_update_ms = now;
 
-    if (m_fix.valid && m_first_fix_ms == 0) {
-      m_first_fix_ms = millis();
+    if (m_fix.valid) {
+      if (have_lat && have_lon) recordTrack(lat_e7, lon_e7, now);
+      if (m_first_fix_ms == 0) m_first_fix_ms = now;
     }
   }
-  else if (strncmp(type, "RMC", 3) == 0) {
+  else if (nmea_type_is(&s, "RMC")) {
     m_rmc_count++;
-    char* time_str = get_field(line, 1);
-    char* speed = get_field(line, 7);
-    char* course = get_field(line, 8);
-    char* date_str = get_field(line, 9);
-
-    if (speed && *speed) {
-      m_fix.speed_knots = parse_double(speed, 0);
+    int32_t v;
+    if (nmea_parse_fixed(nmea_field(&s, 7), 3, &v)) {
+      m_fix.speed_knots = v / 1000.0;
       m_fix.speed_kmh = knots_to_kmh(m_fix.speed_knots);
     }
-
-    if (course && *course) {
-      m_fix.course_deg = parse_double(course, 0);
+    if (nmea_parse_fixed(nmea_field(&s, 8), 2, &v)) {
+      m_fix.course_deg = v / 100.0;
     }
 
     // Parse UTC time
-    if (time_str && strlen(time_str) >= 6) {
-      m_utc.hour = (time_str[0] - '0') * 10 + (time_str[1] - '0');
-      m_utc.minute = (time_str[2] - '0') * 10 + (time_str[3] - '0');
-      m_utc.second = (time_str[4] - '0') * 10 + (time_str[5] - '0');
-      if (strlen(time_str) > 7) {
-        m_utc.centisecond = parse_int(time_str + 7, 0);
-      }
+    uint8_t hh, mm, ss, cs;
+    if (nmea_parse_time(nmea_field(&s, 1), &hh, &mm, &ss, &cs)) {
+      m_utc.hour = hh;
+      m_utc.minute = mm;
+      m_utc.second = ss;
+      m_utc.centisecond = cs;
     }
 
     // Parse date
-    if (date_str && strlen(date_str) >= 6) {
-      m_utc.day = (date_str[0] - '0') * 10 + (date_str[1] - '0');
-      m_utc.month = (date_str[2] - '0') * 10 + (date_str[3] - '0');
-      int yy = (date_str[4] - '0') * 10 + (date_str[5] - '0');
-      m_utc.year = 2000 + yy;
+    uint16_t yyyy;
+    uint8_t mon, dd;
+    if (nmea_parse_date(nmea_field(&s, 9), &yyyy, &mon, &dd)) {
+      m_utc.day = dd;
+      m_utc.month = mon;
+      m_utc.year = yyyy;
       m_utc.valid = true;
       m_utc.last_seen_ms = millis();
     }
 
     m_fix.last_rmc_ms = millis();
   }
-  else if (strncmp(type, "GSA", 3) == 0) {
+  else if (nmea_type_is(&s, "GSA")) {
     m_gsa_count++;
-    char* mode = get_field(line, 2);
-    char* pdop = get_field(line, 15);
-    char* hdop = get_field(line, 16);
-    char* vdop = get_field(line, 17);
-
-    if (mode && *mode) {
-      m_fix.fix_mode = (GpsFixMode)parse_int(mode, 1);
+    int mode = field_int(s, 2, 0);
+    if (mode > 0) {
+      m_fix.fix_mode = (GpsFixMode)mode;
     }
-    m_fix.pdop = parse_double(pdop, 99.9);
-    if (hdop && *hdop) m_fix.hdop = parse_double(hdop, m_fix.hdop);
-    m_fix.vdop = parse_double(vdop, 99.9);
+    m_fix.pdop = field_fixed(s, 15, 2, 99.9);
+    m_fix.hdop = field_fixed(s, 16, 2, m_fix.hdop);
+    m_fix.vdop = field_fixed(s, 17, 2, 99.9);
     m_fix.last_gsa_ms = millis();
   }
-  else if (strncmp(type, "GSV", 3) == 0) {
+  else if (nmea_type_is(&s, "GSV")) {
     m_gsv_count++;
-    char* siv = get_field(line, 3);
-    if (siv && *siv) {
-      m_fix.sats_in_view = parse_int(siv, 0);
+    int siv = field_int(s, 3, -1);
+    if (siv >= 0) {
+      m_fix.sats_in_view = siv;
     }
   }
-  else if (strncmp(type, "VTG", 3) == 0) {
+  else if (nmea_type_is(&s, "VTG")) {
     m_vtg_count++;
-    char* course = get_field(line, 1);
-    char* speed_kmh = get_field(line, 7);
-    if (course && *course) {
-      m_fix.course_deg = parse_double(course, m_fix.course_deg);
-    }
-    if (speed_kmh && *speed_kmh) {
-      m_fix.speed_kmh = parse_double(speed_kmh, m_fix.speed_kmh);
-    }
+    m_fix.course_deg = field_fixed(s, 1, 2, m_fix.course_deg);
+    m_fix.speed_kmh = field_fixed(s, 7, 2, m_fix.speed_kmh);
   }
 }
@@ -3,6 +3,21 @@
  *
  * L76K GNSS NMEA parsing and fix management.
  *
+ * A dedicated task blocks on the UART driver's event queue, drains the
+ * driver ring in bulk as bytes arrive and parses each sentence straight
+ * away, so a loop() stalled on crypto or HTTP no longer drops NMEA. After
+ * each batch the task publishes fix and UTC time through a sequence-locked
+ * snapshot; readers copy it without taking a lock and retry on a torn read.
+ *
+ * At startup the receiver is asked for UBX-NAV-PVT. A u-blox part ACKs and
+ * has its NMEA output turned off, so each epoch is one binary frame instead
+ * of five sentences; anything else (the L76K) ignores the request and the
+ * manager stays on NMEA. Both are parsed from the same stream regardless.
+ *
+ * Every valid position also goes into a fixed-size fix history ring, which
+ * the record loop drains so each witness record can carry the simplified
+ * track travelled since the previous one.
+ *
  * Copyright (c) 2026 ERRERlabs / Karl May
  * License: Apache-2.0
  */
@@ -12,7 +27,14 @@
 
 #include <Arduino.h>
 #include <stdint.h>
+#include "driver/uart.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/event_groups.h"
+#include "freertos/task.h"
 #include "canary_config.h"
+#include "common/gnss/ubx.h"
+#include "common/gnss/track.h"
 
 // ════════════════════════════════════════════════════════════════════════════
 // TYPES
@@ -46,6 +68,12 @@ struct GnssFix {
   uint32_t last_gsa_ms;
 };
 
+enum GpsProtocol : uint8_t {
+  GPS_PROTOCOL_NMEA,
+  GPS_PROTOCOL_UBX_PROBE,     // NAV-PVT requested, waiting for ACK
+  GPS_PROTOCOL_UBX
+};
+
 struct GpsUtcTime {
   bool     valid;
   int      year;
@@ -66,20 +94,22 @@ class GpsManager {
 public:
   GpsManager();
 
-  // Initialize GPS UART
-  void begin(HardwareSerial& serial, uint32_t baud = GPS_BAUD,
+  // Install the UART driver and start the ingestion task
+  void begin(uart_port_t port = (uart_port_t)GPS_UART_NUM, uint32_t baud = GPS_BAUD,
              int rx_pin = GPS_RX_PIN, int tx_pin = GPS_TX_PIN);
 
-  // Process incoming data
+  // Set bits in group after each publish, so consumers can wait for fixes
+  void setPublishNotify(EventGroupHandle_t group, EventBits_t bits);
+
+  // Polls the UART only if the ingestion task could not be started
   void update();
 
-  // Get current fix data
-  const GnssFix& getFix() const { return m_fix; }
-  GnssFix& getFix() { return m_fix; }
+  // Consistent copies of the latest published fix and UTC time
+  GnssFix getFix() const;
+  GpsUtcTime getUtcTime() const;
 
-  // Get UTC time
-  const GpsUtcTime& getUtcTime() const { return m_utc; }
-  GpsUtcTime& getUtcTime() { return m_utc; }
+  // Move the fixes collected since the last call into out, oldest first
+  size_t takeTrack(track_point_t* out, size_t cap);
 
   // Speed in m/s
   float getSpeedMps() const;
@@ -93,25 +123,54 @@ public:
   uint32_t getGsaCount() const { return m_gsa_count; }
   uint32_t getGsvCount() const { return m_gsv_count; }
   uint32_t getVtgCount() const { return m_vtg_count; }
+  uint32_t getOverflowCount() const { return m_overflows; }
+  uint32_t getUbxPvtCount() const { return m_ubx_pvt_count; }
+  GpsProtocol getProtocol() const { return m_protocol; }
+  uint32_t getTrackOverwritten() const { return m_track.overwritten; }
 
 private:
+  struct Snapshot {
+    GnssFix fix;
+    GpsUtcTime utc;
+  };
+
+  static void ingestTask(void* arg);
+  void ingestLoop();
+  void drain();
+  void feed(const uint8_t* data, size_t len);
   void parseNmea(char* line);
-  bool readNmeaLine(char* out, size_t cap, size_t* len);
-
-  HardwareSerial* m_serial;
+  void startUbxProbe();
+  void checkUbxProbe();
+  void onUbxFrame();
+  void applyNavPvt(const ubx_nav_pvt_t& pvt);
+  void recordTrack(int32_t lat_e7, int32_t lon_e7, uint32_t now);
+  void sendUbx(const uint8_t* frame, size_t len);
+  void publish();
+  void readSnapshot(Snapshot* out) const;
+
+  uart_port_t m_port;
+  bool m_uart_ready;
+  QueueHandle_t m_uart_events;
+  TaskHandle_t m_task;
+  EventGroupHandle_t m_notify_group;
+  EventBits_t m_notify_bits;
+
+  // Working state, touched only by the ingesting task
   GnssFix m_fix;
   GpsUtcTime m_utc;
-
-  // Ring buffer for NMEA data
-  static const size_t RB_SIZE = 2048;
-  uint8_t m_rb[RB_SIZE];
-  size_t m_rb_head;
-  size_t m_rb_tail;
-  size_t m_rb_count;
-
-  // Line buffer
   char m_line_buf[256];
   size_t m_line_len;
+  ubx_parser_t m_ubx;
+  volatile GpsProtocol m_protocol;
+  uint32_t m_probe_start_ms;
+
+  // Published state: m_snap_seq is odd while publish() is writing
+  Snapshot m_snap;
+  volatile uint32_t m_snap_seq;
+
+  // Fix history; the ingesting task appends, takeTrack() drains
+  track_ring_t m_track;
+  portMUX_TYPE m_track_lock;
 
   // Statistics (queryable by application for health reporting)
   uint32_t m_sentence_count;
@@ -122,6 +181,8 @@ private:
   uint32_t m_gsa_count;
   uint32_t m_gsv_count;
   uint32_t m_vtg_count;
+  uint32_t m_ubx_pvt_count;
+  uint32_t m_overflows;        // Driver FIFO/ring overflowed; bytes were lost
 };
 
 // ════════════════════════════════════════════════════════════════════════════
@@ -134,6 +195,9 @@ const char* fix_mode_name(GpsFixMode m);
 // Quality name
 const char* quality_name(int q);
 
+// Protocol name
+const char* gps_protocol_name(GpsProtocol p);
+
 // Convert knots to m/s
 float knots_to_mps(float knots);
 
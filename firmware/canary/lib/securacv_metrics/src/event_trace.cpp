@@ -0,0 +1,176 @@
+/*
+ * SecuraCV Canary — Timeline Event Tracer Implementation
+ *
+ * Copyright (c) 2026 ERRERlabs / Karl May
+ * License: Apache-2.0
+ */
+
+#include "event_trace.h"
+
+#if FEATURE_EVENT_TRACE
+
+#include <string.h>
+#include <stdio.h>
+#include <atomic>
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+static_assert((TRACE_RING_EVENTS & (TRACE_RING_EVENTS - 1)) == 0,
+              "TRACE_RING_EVENTS must be a power of two");
+
+struct TraceEvent {
+  std::atomic<uint32_t> seq;     // Claim index + 1, stored last; 0 = empty
+  uint32_t ts_us;                // Since trace_set_enabled(true)
+  const char* name;
+  uint32_t arg;
+  uint8_t phase;
+  uint8_t core;
+  uint8_t tid;
+};
+
+struct TraceTask {
+  TaskHandle_t handle;
+  char name[configMAX_TASK_NAME_LEN];
+};
+
+volatile bool g_trace_enabled = false;
+
+static TraceEvent s_ring[TRACE_RING_EVENTS];
+static std::atomic<uint32_t> s_head{0};
+static int64_t s_epoch_us = 0;
+
+// Appended under the mux, read without it: count is published after the entry
+static TraceTask s_tasks[TRACE_MAX_TASKS];
+static std::atomic<uint8_t> s_task_count{0};
+static portMUX_TYPE s_task_mux = portMUX_INITIALIZER_UNLOCKED;
+
+// Events from tasks past TRACE_MAX_TASKS share the last tid
+static const uint8_t TRACE_TID_OTHER = TRACE_MAX_TASKS;
+
+static uint8_t task_id(TaskHandle_t self) {
+  uint8_t n = s_task_count.load(std::memory_order_acquire);
+  for (uint8_t i = 0; i < n; i++) {
+    if (s_tasks[i].handle == self) return i;
+  }
+
+  uint8_t id = TRACE_TID_OTHER;
+  portENTER_CRITICAL(&s_task_mux);
+  n = s_task_count.load(std::memory_order_relaxed);
+  for (uint8_t i = 0; i < n; i++) {
+    if (s_tasks[i].handle == self) id = i;
+  }
+  if (id == TRACE_TID_OTHER && n < TRACE_MAX_TASKS) {
+    s_tasks[n].handle = self;
+    strncpy(s_tasks[n].name, pcTaskGetName(self), sizeof(s_tasks[n].name) - 1);
+    s_tasks[n].name[sizeof(s_tasks[n].name) - 1] = '\0';
+    s_task_count.store(n + 1, std::memory_order_release);
+    id = n;
+  }
+  portEXIT_CRITICAL(&s_task_mux);
+  return id;
+}
+
+void trace_record(TracePhase phase, const char* name, uint32_t arg) {
+  uint32_t idx = s_head.fetch_add(1, std::memory_order_relaxed);
+  TraceEvent& ev = s_ring[idx & (TRACE_RING_EVENTS - 1)];
+
+  // Invalidate first so an export racing this write skips the slot
+  ev.seq.store(0, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  ev.ts_us = (uint32_t)(esp_timer_get_time() - s_epoch_us);
+  ev.name = name;
+  ev.arg = arg;
+  ev.phase = phase;
+  ev.core = (uint8_t)xPortGetCoreID();
+  ev.tid = task_id(xTaskGetCurrentTaskHandle());
+  ev.seq.store(idx + 1, std::memory_order_release);
+}
+
+void trace_set_enabled(bool on) {
+  if (on && !g_trace_enabled) {
+    for (size_t i = 0; i < TRACE_RING_EVENTS; i++) {
+      s_ring[i].seq.store(0, std::memory_order_relaxed);
+    }
+    s_head.store(0, std::memory_order_relaxed);
+    s_epoch_us = esp_timer_get_time();
+  }
+  g_trace_enabled = on;
+}
+
+size_t trace_event_count() {
+  uint32_t head = s_head.load(std::memory_order_relaxed);
+  return head < TRACE_RING_EVENTS ? head : TRACE_RING_EVENTS;
+}
+
+uint32_t trace_overwritten() {
+  uint32_t head = s_head.load(std::memory_order_relaxed);
+  return head > TRACE_RING_EVENTS ? head - TRACE_RING_EVENTS : 0;
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// CHROME TRACE EXPORT
+// ════════════════════════════════════════════════════════════════════════════
+
+// Copy one slot; false if it is empty, newer than idx, or was rewritten mid-copy
+static bool read_event(uint32_t idx, TraceEvent* out) {
+  const TraceEvent& ev = s_ring[idx & (TRACE_RING_EVENTS - 1)];
+  if (ev.seq.load(std::memory_order_acquire) != idx + 1) return false;
+  out->ts_us = ev.ts_us;
+  out->name = ev.name;
+  out->arg = ev.arg;
+  out->phase = ev.phase;
+  out->core = ev.core;
+  out->tid = ev.tid;
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return ev.seq.load(std::memory_order_relaxed) == idx + 1;
+}
+
+void trace_write_json(MetricsEmitFn emit, void* ctx) {
+  char line[160];
+  int n;
+
+  static const char HEAD[] = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  emit(HEAD, sizeof(HEAD) - 1, ctx);
+
+  // Task names as thread_name metadata, so the viewer labels each row
+  uint8_t tasks = s_task_count.load(std::memory_order_acquire);
+  bool first = true;
+  for (uint8_t i = 0; i <= tasks && i <= TRACE_TID_OTHER; i++) {
+    if (i == tasks && tasks < TRACE_MAX_TASKS) break;   // "other" only once the table is full
+    n = snprintf(line, sizeof(line),
+                 "%s{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+                 first ? "" : ",", (unsigned)i, i < tasks ? s_tasks[i].name : "other");
+    emit(line, (size_t)n, ctx);
+    first = false;
+  }
+
+  // Oldest retained event first; slots being rewritten while we read are skipped
+  uint32_t head = s_head.load(std::memory_order_acquire);
+  uint32_t start = head > TRACE_RING_EVENTS ? head - TRACE_RING_EVENTS : 0;
+  for (uint32_t idx = start; idx < head; idx++) {
+    TraceEvent ev;
+    if (!read_event(idx, &ev)) continue;
+    if (ev.phase == TRACE_INSTANT) {
+      n = snprintf(line, sizeof(line),
+                   "%s{\"ph\":\"i\",\"s\":\"t\",\"name\":\"%s\",\"ts\":%lu,\"pid\":1,\"tid\":%u,"
+                   "\"args\":{\"core\":%u,\"arg\":%lu}}",
+                   first ? "" : ",", ev.name, (unsigned long)ev.ts_us, (unsigned)ev.tid,
+                   (unsigned)ev.core, (unsigned long)ev.arg);
+    } else {
+      n = snprintf(line, sizeof(line),
+                   "%s{\"ph\":\"%c\",\"name\":\"%s\",\"ts\":%lu,\"pid\":1,\"tid\":%u,\"args\":{\"core\":%u}}",
+                   first ? "" : ",", (char)ev.phase, ev.name, (unsigned long)ev.ts_us,
+                   (unsigned)ev.tid, (unsigned)ev.core);
+    }
+    if (n < 0 || (size_t)n >= sizeof(line)) continue;
+    emit(line, (size_t)n, ctx);
+    first = false;
+  }
+
+  n = snprintf(line, sizeof(line), "],\"otherData\":{\"overwritten\":%lu}}",
+               (unsigned long)trace_overwritten());
+  emit(line, (size_t)n, ctx);
+}
+
+#endif // FEATURE_EVENT_TRACE
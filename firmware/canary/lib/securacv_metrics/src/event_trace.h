@@ -0,0 +1,104 @@
+/*
+ * SecuraCV Canary — Timeline Event Tracer
+ *
+ * The profiler answers "how long does X take"; this answers "what was
+ * running when". Begin, end and instant events are stamped with
+ * esp_timer_get_time(), the task and the core, and written into a fixed
+ * RAM ring (TRACE_RING_EVENTS, oldest overwritten). GET /api/trace
+ * streams the ring as Chrome Trace Event JSON. Open it in
+ * chrome://tracing or ui.perfetto.dev to see GNSS ingest, signer, httpd
+ * and camera work interleaved per task.
+ *
+ * Every PerfTimer scope is also a trace slice, so the profiled subsystems
+ * and HTTP routes show up without extra call sites. Tracing starts off.
+ * While off, a trace point costs one load and branch on g_trace_enabled.
+ * POST /api/trace?on=1 clears the ring and starts recording, and ?on=0
+ * stops it.
+ *
+ *   TraceScope t("cam_fb_get");        // slice for the enclosing scope
+ *   trace_instant("wifi_lost");        // zero-length marker
+ *
+ * Names must be string literals (only the pointer is stored). Call from
+ * task context, not ISRs. Timestamps count from the enable and wrap after
+ * ~71 minutes of recording.
+ *
+ * Copyright (c) 2026 ERRERlabs / Karl May
+ * License: Apache-2.0
+ */
+
+#ifndef SECURACV_EVENT_TRACE_H
+#define SECURACV_EVENT_TRACE_H
+
+#include <Arduino.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "canary_config.h"
+#include "securacv_metrics.h"
+
+enum TracePhase : uint8_t {
+  TRACE_BEGIN = 'B',
+  TRACE_END = 'E',
+  TRACE_INSTANT = 'i',
+};
+
+#if FEATURE_EVENT_TRACE
+
+extern volatile bool g_trace_enabled;
+
+void trace_record(TracePhase phase, const char* name, uint32_t arg);
+
+static inline void trace_begin(const char* name) {
+  if (g_trace_enabled) trace_record(TRACE_BEGIN, name, 0);
+}
+static inline void trace_end(const char* name) {
+  if (g_trace_enabled) trace_record(TRACE_END, name, 0);
+}
+static inline void trace_instant(const char* name, uint32_t arg = 0) {
+  if (g_trace_enabled) trace_record(TRACE_INSTANT, name, arg);
+}
+
+// Enabling clears the ring so the export covers one recording
+void trace_set_enabled(bool on);
+static inline bool trace_is_enabled() { return g_trace_enabled; }
+
+// Events currently held (at most TRACE_RING_EVENTS)
+size_t trace_event_count();
+
+// Events overwritten before they were exported since the last enable
+uint32_t trace_overwritten();
+
+// Write the ring, oldest first, as a Chrome Trace Event JSON object
+// through the same line sink as metrics_write()
+void trace_write_json(MetricsEmitFn emit, void* ctx);
+
+#else
+
+static inline void trace_begin(const char*) {}
+static inline void trace_end(const char*) {}
+static inline void trace_instant(const char*, uint32_t = 0) {}
+static inline void trace_set_enabled(bool) {}
+static inline bool trace_is_enabled() { return false; }
+static inline size_t trace_event_count() { return 0; }
+static inline uint32_t trace_overwritten() { return 0; }
+static inline void trace_write_json(MetricsEmitFn, void*) {}
+
+#endif // FEATURE_EVENT_TRACE
+
+// Emits a begin/end pair around the enclosing scope. A scope entered
+// while tracing was off emits neither, so enabling mid-scope never leaves
+// an unmatched end.
+class TraceScope {
+public:
+  explicit TraceScope(const char* name) : m_name(name), m_traced(trace_is_enabled()) {
+    if (m_traced) trace_begin(name);
+  }
+  ~TraceScope() {
+    if (m_traced) trace_end(m_name);
+  }
+
+private:
+  const char* m_name;
+  bool m_traced;
+};
+
+#endif // SECURACV_EVENT_TRACE_H
@@ -0,0 +1,135 @@
+/*
+ * SecuraCV Canary — Subsystem Timing Profiler Implementation
+ *
+ * Copyright (c) 2026 ERRERlabs / Karl May
+ * License: Apache-2.0
+ */
+
+#include "perf_profiler.h"
+
+#if FEATURE_PERF_PROFILER
+
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+
+// Bucket 2k covers [2^k, 1.5 * 2^k), bucket 2k+1 covers [1.5 * 2^k, 2^(k+1))
+static const size_t PERF_OCTAVES = 24;
+static const size_t PERF_BUCKETS = PERF_OCTAVES * 2;
+
+struct Scope {
+  const char* name;
+  uint16_t buckets[PERF_BUCKETS];   // Halved together when one saturates
+  uint32_t count;
+  uint32_t min_us;
+  uint32_t max_us;
+  uint64_t sum_us;
+};
+
+static Scope s_scopes[PERF_MAX_SCOPES];
+static size_t s_scope_count = 0;
+static portMUX_TYPE s_perf_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static size_t bucket_for(uint32_t us) {
+  if (us < 2) return 0;
+  size_t k = 31 - __builtin_clz(us);
+  if (k >= PERF_OCTAVES) return PERF_BUCKETS - 1;
+  size_t half = (us >> (k - 1)) & 1;
+  return k * 2 + half;
+}
+
+static uint32_t bucket_upper_us(size_t b) {
+  size_t k = b / 2;
+  return (b & 1) ? (2u << k) : (3u << k) / 2;
+}
+
+static void clear_scope(Scope& s) {
+  memset(s.buckets, 0, sizeof(s.buckets));
+  s.count = 0;
+  s.min_us = UINT32_MAX;
+  s.max_us = 0;
+  s.sum_us = 0;
+}
+
+PerfScopeId perf_scope(const char* name) {
+  PerfScopeId id = PERF_SCOPE_NONE;
+  portENTER_CRITICAL(&s_perf_mux);
+  for (size_t i = 0; i < s_scope_count; i++) {
+    if (strcmp(s_scopes[i].name, name) == 0) {
+      id = (PerfScopeId)i;
+      break;
+    }
+  }
+  if (id == PERF_SCOPE_NONE && s_scope_count < PERF_MAX_SCOPES) {
+    Scope& s = s_scopes[s_scope_count];
+    s.name = name;
+    clear_scope(s);
+    id = (PerfScopeId)s_scope_count++;
+  }
+  portEXIT_CRITICAL(&s_perf_mux);
+  return id;
+}
+
+void perf_record_us(PerfScopeId id, uint32_t us) {
+  if (id >= s_scope_count) return;
+
+  size_t b = bucket_for(us);
+  Scope& s = s_scopes[id];
+  portENTER_CRITICAL(&s_perf_mux);
+  if (s.buckets[b] == UINT16_MAX) {
+    // Keep the distribution's shape; recent samples gain weight
+    for (size_t i = 0; i < PERF_BUCKETS; i++) s.buckets[i] /= 2;
+  }
+  s.buckets[b]++;
+  s.count++;
+  s.sum_us += us;
+  if (us < s.min_us) s.min_us = us;
+  if (us > s.max_us) s.max_us = us;
+  portEXIT_CRITICAL(&s_perf_mux);
+}
+
+const char* perf_scope_name(PerfScopeId id) {
+  return id < s_scope_count ? s_scopes[id].name : nullptr;
+}
+
+size_t perf_scope_count() {
+  return s_scope_count;
+}
+
+bool perf_get(size_t i, PerfStats* out) {
+  if (i >= s_scope_count) return false;
+
+  Scope s;
+  portENTER_CRITICAL(&s_perf_mux);
+  s = s_scopes[i];
+  portEXIT_CRITICAL(&s_perf_mux);
+
+  out->name = s.name;
+  out->count = s.count;
+  out->min_us = s.count ? s.min_us : 0;
+  out->max_us = s.max_us;
+  out->avg_us = s.count ? (uint32_t)(s.sum_us / s.count) : 0;
+
+  uint32_t total = 0;
+  for (size_t b = 0; b < PERF_BUCKETS; b++) total += s.buckets[b];
+
+  // Smallest bucket bound with at least 99% of samples at or below it
+  out->p99_us = 0;
+  uint32_t seen = 0;
+  for (size_t b = 0; b < PERF_BUCKETS && total > 0; b++) {
+    seen += s.buckets[b];
+    if ((uint64_t)seen * 100 >= (uint64_t)total * 99) {
+      uint32_t upper = bucket_upper_us(b);
+      out->p99_us = upper < s.max_us ? upper : s.max_us;
+      break;
+    }
+  }
+  return true;
+}
+
+void perf_reset() {
+  portENTER_CRITICAL(&s_perf_mux);
+  for (size_t i = 0; i < s_scope_count; i++) clear_scope(s_scopes[i]);
+  portEXIT_CRITICAL(&s_perf_mux);
+}
+
+#endif // FEATURE_PERF_PROFILER
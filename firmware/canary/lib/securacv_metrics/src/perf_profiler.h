@@ -0,0 +1,90 @@
+/*
+ * SecuraCV Canary — Subsystem Timing Profiler
+ *
+ * Named timing scopes with min/avg/max/p99 kept in a fixed table, for
+ * finding which step eats the cycle budget. Each sample lands in a
+ * log-scale histogram (two buckets per power of two, 1 us to ~16 s), so
+ * p99 is an upper bound within 50% and costs no sorting or sample
+ * buffer. A scope costs two esp_timer reads and a short critical section
+ * (~2 us); at the loop and handler rates here that is well under 1%.
+ *
+ *   static PerfScopeId s_scope = perf_scope("wifi_check");
+ *   { PerfTimer t(s_scope); checkConnection(); }
+ *
+ * Reported in print_status(), the 'p' serial command and /api/perf.
+ * While the event tracer is recording, each scope is also a trace slice.
+ *
+ * Copyright (c) 2026 ERRERlabs / Karl May
+ * License: Apache-2.0
+ */
+
+#ifndef SECURACV_PERF_PROFILER_H
+#define SECURACV_PERF_PROFILER_H
+
+#include <Arduino.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_timer.h"
+#include "canary_config.h"
+#include "event_trace.h"
+
+typedef uint8_t PerfScopeId;
+static const PerfScopeId PERF_SCOPE_NONE = 0xFF;
+
+struct PerfStats {
+  const char* name;
+  uint32_t count;
+  uint32_t min_us;
+  uint32_t avg_us;
+  uint32_t max_us;
+  uint32_t p99_us;
+};
+
+#if FEATURE_PERF_PROFILER
+
+// Registration is idempotent on name (a string literal); PERF_SCOPE_NONE when full
+PerfScopeId perf_scope(const char* name);
+
+void perf_record_us(PerfScopeId id, uint32_t us);
+
+// Registered name, or nullptr for an unknown id
+const char* perf_scope_name(PerfScopeId id);
+
+// Snapshot of scope i (0..perf_scope_count()-1); false past the end
+size_t perf_scope_count();
+bool perf_get(size_t i, PerfStats* out);
+
+// Clear every scope's samples (registrations are kept)
+void perf_reset();
+
+#else
+
+static inline PerfScopeId perf_scope(const char*) { return PERF_SCOPE_NONE; }
+static inline void perf_record_us(PerfScopeId, uint32_t) {}
+static inline const char* perf_scope_name(PerfScopeId) { return nullptr; }
+static inline size_t perf_scope_count() { return 0; }
+static inline bool perf_get(size_t, PerfStats*) { return false; }
+static inline void perf_reset() {}
+
+#endif // FEATURE_PERF_PROFILER
+
+// Records the enclosing scope's duration (and a trace slice while tracing)
+class PerfTimer {
+public:
+  explicit PerfTimer(PerfScopeId id)
+    : m_id(id), m_start(id != PERF_SCOPE_NONE ? esp_timer_get_time() : 0),
+      m_traced(id != PERF_SCOPE_NONE && trace_is_enabled()) {
+    if (m_traced) trace_begin(perf_scope_name(id));
+  }
+  ~PerfTimer() {
+    if (m_id != PERF_SCOPE_NONE) perf_record_us(m_id, (uint32_t)(esp_timer_get_time() - m_start));
+    if (m_traced) trace_end(perf_scope_name(m_id));
+  }
+
+private:
+  PerfScopeId m_id;
+  int64_t m_start;
+  bool m_traced;      // Began while tracing, so the end is recorded too
+};
+
+#endif // SECURACV_PERF_PROFILER_H
@@ -0,0 +1,223 @@
+/*
+ * SecuraCV Canary — Metrics Registry Implementation
+ *
+ * Copyright (c) 2026 ERRERlabs / Karl May
+ * License: Apache-2.0
+ */
+
+#include "securacv_metrics.h"
+
+#if FEATURE_METRICS
+
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+
+static const uint32_t BUCKET_US[METRICS_BUCKETS] = {
+  100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 1000000
+};
+static const char* const BUCKET_LE[METRICS_BUCKETS + 1] = {
+  "0.0001", "0.00025", "0.0005", "0.001", "0.0025", "0.005",
+  "0.01", "0.025", "0.05", "0.1", "0.25", "1", "+Inf"
+};
+
+enum SeriesType : uint8_t {
+  SERIES_COUNTER,
+  SERIES_GAUGE
+};
+
+struct Series {
+  const char* name;
+  const char* help;
+  SeriesType type;
+  const uint32_t* src;
+  MetricReadFn read;
+  uint32_t value;
+};
+
+struct Histogram {
+  const char* name;
+  const char* help;
+  const char* label_key;
+  const char* label_value;
+  uint32_t buckets[METRICS_BUCKETS + 1];   // Not cumulative; last is +Inf
+  uint32_t count;
+  uint64_t sum_us;
+};
+
+// Histogram ids are offset so one MetricId space covers both tables
+static const MetricId HIST_BASE = 0x80;
+static_assert(METRICS_MAX_SERIES <= HIST_BASE, "series ids overlap histogram ids");
+static_assert(METRICS_MAX_HISTOGRAMS < METRIC_NONE - HIST_BASE, "histogram ids overlap METRIC_NONE");
+
+static Series s_series[METRICS_MAX_SERIES];
+static size_t s_series_count = 0;
+static Histogram s_hist[METRICS_MAX_HISTOGRAMS];
+static size_t s_hist_count = 0;
+static portMUX_TYPE s_metrics_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static bool same_str(const char* a, const char* b) {
+  if (!a || !b) return a == b;
+  return strcmp(a, b) == 0;
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// REGISTRATION
+// ════════════════════════════════════════════════════════════════════════════
+
+static MetricId add_series(const char* name, const char* help, SeriesType type,
+                           const uint32_t* src, MetricReadFn read) {
+  MetricId id = METRIC_NONE;
+  portENTER_CRITICAL(&s_metrics_mux);
+  for (size_t i = 0; i < s_series_count; i++) {
+    if (same_str(s_series[i].name, name)) {
+      id = (MetricId)i;
+      break;
+    }
+  }
+  if (id == METRIC_NONE && s_series_count < METRICS_MAX_SERIES) {
+    Series& s = s_series[s_series_count];
+    s.name = name;
+    s.help = help;
+    s.type = type;
+    s.src = src;
+    s.read = read;
+    s.value = 0;
+    id = (MetricId)s_series_count++;
+  }
+  portEXIT_CRITICAL(&s_metrics_mux);
+  return id;
+}
+
+MetricId metrics_counter(const char* name, const char* help, const uint32_t* src) {
+  return add_series(name, help, SERIES_COUNTER, src, nullptr);
+}
+
+MetricId metrics_gauge(const char* name, const char* help, const uint32_t* src) {
+  return add_series(name, help, SERIES_GAUGE, src, nullptr);
+}
+
+MetricId metrics_gauge(const char* name, const char* help, MetricReadFn read) {
+  return add_series(name, help, SERIES_GAUGE, nullptr, read);
+}
+
+MetricId metrics_histogram(const char* name, const char* help,
+                           const char* label_key, const char* label_value) {
+  MetricId id = METRIC_NONE;
+  portENTER_CRITICAL(&s_metrics_mux);
+  for (size_t i = 0; i < s_hist_count; i++) {
+    if (same_str(s_hist[i].name, name) && same_str(s_hist[i].label_value, label_value)) {
+      id = (MetricId)(HIST_BASE + i);
+      break;
+    }
+  }
+  if (id == METRIC_NONE && s_hist_count < METRICS_MAX_HISTOGRAMS) {
+    Histogram& h = s_hist[s_hist_count];
+    memset(&h, 0, sizeof(h));
+    h.name = name;
+    h.help = help;
+    h.label_key = label_key;
+    h.label_value = label_value;
+    id = (MetricId)(HIST_BASE + s_hist_count++);
+  }
+  portEXIT_CRITICAL(&s_metrics_mux);
+  return id;
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// OBSERVATION
+// ════════════════════════════════════════════════════════════════════════════
+
+void metrics_inc(MetricId id, uint32_t n) {
+  if (id >= s_series_count) return;
+  portENTER_CRITICAL(&s_metrics_mux);
+  s_series[id].value += n;
+  portEXIT_CRITICAL(&s_metrics_mux);
+}
+
+void metrics_observe_us(MetricId id, uint32_t us) {
+  if (id < HIST_BASE || (size_t)(id - HIST_BASE) >= s_hist_count) return;
+
+  size_t b = 0;
+  while (b < METRICS_BUCKETS && us > BUCKET_US[b]) b++;
+
+  Histogram& h = s_hist[id - HIST_BASE];
+  portENTER_CRITICAL(&s_metrics_mux);
+  h.buckets[b]++;
+  h.count++;
+  h.sum_us += us;
+  portEXIT_CRITICAL(&s_metrics_mux);
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// EXPORT
+// ════════════════════════════════════════════════════════════════════════════
+
+static void emit_line(MetricsEmitFn emit, void* ctx, char* line, int n, size_t cap) {
+  if (n <= 0) return;
+  if ((size_t)n >= cap) {
+    n = cap - 1;                         // Truncated; still one line
+    line[n - 1] = '\n';
+  }
+  emit(line, n, ctx);
+}
+
+static void emit_family(MetricsEmitFn emit, void* ctx, const char* name,
+                        const char* help, const char* type) {
+  char line[160];
+  emit_line(emit, ctx, line, snprintf(line, sizeof(line), "# HELP %s %s\n", name, help), sizeof(line));
+  emit_line(emit, ctx, line, snprintf(line, sizeof(line), "# TYPE %s %s\n", name, type), sizeof(line));
+}
+
+void metrics_write(MetricsEmitFn emit, void* ctx) {
+  char line[160];
+
+  size_t series_count = s_series_count;
+  for (size_t i = 0; i < series_count; i++) {
+    const Series& s = s_series[i];
+    uint32_t v = s.read ? s.read() : (s.src ? *s.src : s.value);
+    emit_family(emit, ctx, s.name, s.help, s.type == SERIES_COUNTER ? "counter" : "gauge");
+    emit_line(emit, ctx, line, snprintf(line, sizeof(line), "%s %u\n", s.name, (unsigned)v), sizeof(line));
+  }
+
+  size_t hist_count = s_hist_count;
+  for (size_t i = 0; i < hist_count; i++) {
+    // Copy under the lock so buckets, count and sum agree
+    Histogram h;
+    portENTER_CRITICAL(&s_metrics_mux);
+    h = s_hist[i];
+    portEXIT_CRITICAL(&s_metrics_mux);
+
+    // One HELP/TYPE per family; labelled histograms register consecutively
+    if (i == 0 || !same_str(s_hist[i - 1].name, h.name)) {
+      emit_family(emit, ctx, h.name, h.help, "histogram");
+    }
+
+    char labels[80] = "";
+    if (h.label_key && h.label_value) {
+      snprintf(labels, sizeof(labels), "%s=\"%s\",", h.label_key, h.label_value);
+    }
+
+    uint32_t cumulative = 0;
+    for (size_t b = 0; b <= METRICS_BUCKETS; b++) {
+      cumulative += h.buckets[b];
+      emit_line(emit, ctx, line, snprintf(line, sizeof(line), "%s_bucket{%sle=\"%s\"} %u\n",
+                h.name, labels, BUCKET_LE[b], (unsigned)cumulative), sizeof(line));
+    }
+
+    // Drop the trailing comma for the plain series
+    size_t llen = strlen(labels);
+    if (llen > 0) labels[llen - 1] = '\0';
+    const char* open = llen > 0 ? "{" : "";
+    const char* close = llen > 0 ? "}" : "";
+
+    emit_line(emit, ctx, line, snprintf(line, sizeof(line), "%s_sum%s%s%s %llu.%06llu\n",
+              h.name, open, labels, close,
+              (unsigned long long)(h.sum_us / 1000000), (unsigned long long)(h.sum_us % 1000000)),
+              sizeof(line));
+    emit_line(emit, ctx, line, snprintf(line, sizeof(line), "%s_count%s%s%s %u\n",
+              h.name, open, labels, close, (unsigned)h.count), sizeof(line));
+  }
+}
+
+#endif // FEATURE_METRICS
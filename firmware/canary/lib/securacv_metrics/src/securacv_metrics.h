@@ -0,0 +1,75 @@
+/*
+ * SecuraCV Canary — Metrics Registry
+ *
+ * Fixed-size registry of counters, gauges and latency histograms, exported
+ * in the Prometheus text format on /metrics. Nothing is allocated: series
+ * are registered once at startup (names and help text must be string
+ * literals) and observed from any task.
+ *
+ *   static MetricId s_parse = metrics_histogram("securacv_gps_parse_seconds", "...");
+ *   { MetricTimer t(s_parse); parse(); }
+ *
+ * Copyright (c) 2026 ERRERlabs / Karl May
+ * License: Apache-2.0
+ */
+
+#ifndef SECURACV_METRICS_H
+#define SECURACV_METRICS_H
+
+#include <Arduino.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "canary_config.h"
+
+typedef uint8_t MetricId;
+static const MetricId METRIC_NONE = 0xFF;
+
+// Gauge sampled at export time
+typedef uint32_t (*MetricReadFn)();
+
+// Export sink; called once per line
+typedef void (*MetricsEmitFn)(const char* text, size_t len, void* ctx);
+
+// Histogram bucket upper bounds in microseconds (+Inf is implicit)
+static const size_t METRICS_BUCKETS = 12;
+
+#if FEATURE_METRICS
+
+// Registration is idempotent on (name, label); METRIC_NONE when full.
+// A counter with src reads that existing field instead of its own value.
+MetricId metrics_counter(const char* name, const char* help, const uint32_t* src = nullptr);
+MetricId metrics_gauge(const char* name, const char* help, const uint32_t* src);
+MetricId metrics_gauge(const char* name, const char* help, MetricReadFn read);
+MetricId metrics_histogram(const char* name, const char* help,
+                           const char* label_key = nullptr, const char* label_value = nullptr);
+
+void metrics_inc(MetricId id, uint32_t n = 1);
+void metrics_observe_us(MetricId id, uint32_t us);
+
+// Write every series in the Prometheus text exposition format
+void metrics_write(MetricsEmitFn emit, void* ctx);
+
+#else
+
+static inline MetricId metrics_counter(const char*, const char*, const uint32_t* = nullptr) { return METRIC_NONE; }
+static inline MetricId metrics_gauge(const char*, const char*, const uint32_t*) { return METRIC_NONE; }
+static inline MetricId metrics_gauge(const char*, const char*, MetricReadFn) { return METRIC_NONE; }
+static inline MetricId metrics_histogram(const char*, const char*, const char* = nullptr, const char* = nullptr) { return METRIC_NONE; }
+static inline void metrics_inc(MetricId, uint32_t = 1) {}
+static inline void metrics_observe_us(MetricId, uint32_t) {}
+static inline void metrics_write(MetricsEmitFn, void*) {}
+
+#endif // FEATURE_METRICS
+
+// Observes the enclosing scope's duration into a histogram
+class MetricTimer {
+public:
+  explicit MetricTimer(MetricId id) : m_id(id), m_start(micros()) {}
+  ~MetricTimer() { metrics_observe_us(m_id, micros() - m_start); }
+
+private:
+  MetricId m_id;
+  uint32_t m_start;
+};
+
+#endif // SECURACV_METRICS_H
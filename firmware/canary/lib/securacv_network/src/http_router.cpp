@@ -0,0 +1,293 @@
+/*
+ * SecuraCV Canary — HTTP Route Table Implementation
+ *
+ * Nodes and routes live in fixed tables, linked by index. Each node is one
+ * path segment (a slice of the registered pattern literal); its routes hang
+ * off it, one per method. Dispatch splits the path on '/' in place and
+ * descends one node per segment, backtracking to a capture only when a
+ * literal branch dead-ends.
+ *
+ * Copyright (c) 2026 ERRERlabs / Karl May
+ * License: Apache-2.0
+ */
+
+#include "http_router.h"
+#include <string.h>
+
+static_assert(HTTP_ROUTER_MAX_NODES <= 127 && HTTP_MAX_ROUTES <= 127, "trie links are int8_t");
+
+// ════════════════════════════════════════════════════════════════════════════
+// PRIVATE STATE
+// ════════════════════════════════════════════════════════════════════════════
+
+struct TrieNode {
+  const char* seg;            // Literal text, or capture name
+  uint8_t seg_len;
+  bool capture;
+  int8_t first_child;
+  int8_t next_sibling;
+  int8_t first_route;
+};
+
+struct TrieRoute {
+  httpd_method_t method;
+  HttpRouteFn fn;
+  void* ctx;
+  int8_t next;                // Next route on the same node
+};
+
+// Per-request state, on the httpd task's stack while the handler runs
+struct HttpMatch {
+  httpd_req_t* req;
+  uint8_t param_count;
+  int8_t param_node[HTTP_ROUTER_MAX_PARAMS];
+  HttpView param[HTTP_ROUTER_MAX_PARAMS];
+  uint8_t query_count;
+  HttpView query_key[HTTP_QUERY_MAX_PARAMS];
+  HttpView query_val[HTTP_QUERY_MAX_PARAMS];
+  bool path_found;            // Some route ends here, maybe for another method
+};
+
+static TrieNode s_nodes[HTTP_ROUTER_MAX_NODES] = {
+  { "", 0, false, -1, -1, -1 },   // Root, "/"
+};
+static size_t s_node_count = 1;
+static TrieRoute s_trie_routes[HTTP_MAX_ROUTES];
+static size_t s_trie_route_count = 0;
+static httpd_method_t s_methods[HTTP_ROUTER_MAX_METHODS];
+static size_t s_method_count = 0;
+static const HttpMatch* s_current = nullptr;
+
+// ════════════════════════════════════════════════════════════════════════════
+// VIEWS
+// ════════════════════════════════════════════════════════════════════════════
+
+bool HttpView::equals(const char* s) const {
+  return ptr && strlen(s) == len && memcmp(ptr, s, len) == 0;
+}
+
+uint32_t HttpView::toU32(uint32_t def) const {
+  if (!ptr) return def;
+  uint32_t v = 0;
+  for (uint16_t i = 0; i < len && ptr[i] >= '0' && ptr[i] <= '9'; i++) {
+    uint32_t d = (uint32_t)(ptr[i] - '0');
+    if (v > (UINT32_MAX - d) / 10) return UINT32_MAX;
+    v = v * 10 + d;
+  }
+  return v;
+}
+
+bool HttpView::parseU32(uint32_t* out) const {
+  if (!ptr || len == 0) return false;
+  uint32_t v = 0;
+  for (uint16_t i = 0; i < len; i++) {
+    if (ptr[i] < '0' || ptr[i] > '9') return false;
+    uint32_t d = (uint32_t)(ptr[i] - '0');
+    if (v > (UINT32_MAX - d) / 10) return false;
+    v = v * 10 + d;
+  }
+  *out = v;
+  return true;
+}
+
+bool HttpView::copy(char* out, size_t cap) const {
+  if (!ptr || cap == 0 || len >= cap) return false;
+  memcpy(out, ptr, len);
+  out[len] = '\0';
+  return true;
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// COMPILE
+// ════════════════════════════════════════════════════════════════════════════
+
+static int8_t find_child(int8_t parent, const char* seg, size_t len, bool capture) {
+  for (int8_t c = s_nodes[parent].first_child; c >= 0; c = s_nodes[c].next_sibling) {
+    const TrieNode& n = s_nodes[c];
+    if (n.capture == capture && n.seg_len == len && memcmp(n.seg, seg, len) == 0) return c;
+  }
+  return -1;
+}
+
+static bool has_capture_child(int8_t parent) {
+  for (int8_t c = s_nodes[parent].first_child; c >= 0; c = s_nodes[c].next_sibling) {
+    if (s_nodes[c].capture) return true;
+  }
+  return false;
+}
+
+static int8_t add_child(int8_t parent, const char* seg, size_t len, bool capture) {
+  if (s_node_count >= HTTP_ROUTER_MAX_NODES || len > UINT8_MAX) return -1;
+  int8_t id = (int8_t)s_node_count++;
+  s_nodes[id] = { seg, (uint8_t)len, capture, -1, s_nodes[parent].first_child, -1 };
+  s_nodes[parent].first_child = id;
+  return id;
+}
+
+bool http_router_add(const char* pattern, httpd_method_t method, HttpRouteFn fn, void* ctx) {
+  if (!pattern || pattern[0] != '/' || !fn) return false;
+
+  int8_t node = 0;
+  uint8_t captures = 0;
+  const char* p = pattern;
+  while (*p) {
+    if (*p == '/') { p++; continue; }
+    const char* end = strchr(p, '/');
+    if (!end) end = p + strlen(p);
+    size_t len = (size_t)(end - p);
+
+    bool capture = len >= 2 && p[0] == '{' && p[len - 1] == '}';
+    const char* seg = capture ? p + 1 : p;
+    size_t seg_len = capture ? len - 2 : len;
+    if (capture && ++captures > HTTP_ROUTER_MAX_PARAMS) return false;
+
+    int8_t child = find_child(node, seg, seg_len, capture);
+    if (child < 0) {
+      // One capture per depth, or a segment would match two names
+      if (capture && has_capture_child(node)) return false;
+      child = add_child(node, seg, seg_len, capture);
+    }
+    if (child < 0) return false;
+    node = child;
+    p = end;
+  }
+
+  for (int8_t r = s_nodes[node].first_route; r >= 0; r = s_trie_routes[r].next) {
+    if (s_trie_routes[r].method == method) {
+      s_trie_routes[r].fn = fn;
+      s_trie_routes[r].ctx = ctx;
+      return true;
+    }
+  }
+
+  size_t m = 0;
+  while (m < s_method_count && s_methods[m] != method) m++;
+  if (m == s_method_count) {
+    if (s_method_count >= HTTP_ROUTER_MAX_METHODS) return false;
+    s_methods[s_method_count++] = method;
+  }
+
+  if (s_trie_route_count >= HTTP_MAX_ROUTES) return false;
+  int8_t id = (int8_t)s_trie_route_count++;
+  s_trie_routes[id] = { method, fn, ctx, s_nodes[node].first_route };
+  s_nodes[node].first_route = id;
+  return true;
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// DISPATCH
+// ════════════════════════════════════════════════════════════════════════════
+
+static int8_t match_route(int8_t node, httpd_method_t method, HttpMatch& m) {
+  int8_t r = s_nodes[node].first_route;
+  if (r >= 0) m.path_found = true;
+  for (; r >= 0; r = s_trie_routes[r].next) {
+    if (s_trie_routes[r].method == method) return r;
+  }
+  return -1;
+}
+
+static int8_t match_path(int8_t node, const char* p, const char* end,
+                         httpd_method_t method, HttpMatch& m) {
+  while (p < end && *p == '/') p++;
+  if (p == end) return match_route(node, method, m);
+
+  const char* seg_end = (const char*)memchr(p, '/', (size_t)(end - p));
+  if (!seg_end) seg_end = end;
+  size_t len = (size_t)(seg_end - p);
+
+  int8_t capture = -1;
+  for (int8_t c = s_nodes[node].first_child; c >= 0; c = s_nodes[c].next_sibling) {
+    const TrieNode& n = s_nodes[c];
+    if (n.capture) {
+      capture = c;
+    } else if (n.seg_len == len && memcmp(n.seg, p, len) == 0) {
+      int8_t r = match_path(c, seg_end, end, method, m);
+      if (r >= 0) return r;
+    }
+  }
+
+  if (capture < 0 || m.param_count >= HTTP_ROUTER_MAX_PARAMS) return -1;
+  uint8_t slot = m.param_count++;
+  m.param_node[slot] = capture;
+  m.param[slot] = { p, (uint16_t)len };
+  int8_t r = match_path(capture, seg_end, end, method, m);
+  if (r < 0) m.param_count = slot;
+  return r;
+}
+
+static void tokenize_query(const char* q, HttpMatch& m) {
+  while (*q && *q != '#' && m.query_count < HTTP_QUERY_MAX_PARAMS) {
+    const char* end = q;
+    while (*end && *end != '&' && *end != '#') end++;
+    if (end > q) {
+      const char* eq = (const char*)memchr(q, '=', (size_t)(end - q));
+      uint8_t i = m.query_count++;
+      if (eq) {
+        m.query_key[i] = { q, (uint16_t)(eq - q) };
+        m.query_val[i] = { eq + 1, (uint16_t)(end - eq - 1) };
+      } else {
+        m.query_key[i] = { q, (uint16_t)(end - q) };
+        m.query_val[i] = { end, 0 };
+      }
+    }
+    q = *end == '&' ? end + 1 : end;
+  }
+}
+
+static esp_err_t http_router_dispatch(httpd_req_t* req) {
+  HttpMatch m;
+  m.req = req;
+  m.param_count = 0;
+  m.query_count = 0;
+  m.path_found = false;
+
+  const char* uri = req->uri;
+  const char* path_end = uri + strcspn(uri, "?#");
+  int8_t r = match_path(0, uri, path_end, (httpd_method_t)req->method, m);
+  if (r < 0) {
+    return m.path_found ? httpd_resp_send_err(req, HTTPD_405_METHOD_NOT_ALLOWED, nullptr)
+                        : httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, nullptr);
+  }
+  if (*path_end == '?') tokenize_query(path_end + 1, m);
+
+  const TrieRoute& route = s_trie_routes[r];
+  req->user_ctx = route.ctx;
+  s_current = &m;
+  esp_err_t err = route.fn(req);
+  s_current = nullptr;
+  return err;
+}
+
+void http_router_attach(httpd_handle_t server) {
+  for (size_t i = 0; i < s_method_count; i++) {
+    httpd_uri_t desc = { .uri = "/*", .method = s_methods[i], .handler = http_router_dispatch, .user_ctx = nullptr };
+    httpd_register_uri_handler(server, &desc);
+  }
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// LOOKUP
+// ════════════════════════════════════════════════════════════════════════════
+
+static const HttpView NO_VIEW = { nullptr, 0 };
+
+HttpView http_path_param(httpd_req_t* req, const char* name) {
+  const HttpMatch* m = s_current;
+  if (!m || m->req != req) return NO_VIEW;
+  size_t len = strlen(name);
+  for (uint8_t i = 0; i < m->param_count; i++) {
+    const TrieNode& n = s_nodes[m->param_node[i]];
+    if (n.seg_len == len && memcmp(n.seg, name, len) == 0) return m->param[i];
+  }
+  return NO_VIEW;
+}
+
+HttpView http_query_param(httpd_req_t* req, const char* key) {
+  const HttpMatch* m = s_current;
+  if (!m || m->req != req) return NO_VIEW;
+  for (uint8_t i = 0; i < m->query_count; i++) {
+    if (m->query_key[i].equals(key)) return m->query_val[i];
+  }
+  return NO_VIEW;
+}
@@ -0,0 +1,63 @@
+/*
+ * SecuraCV Canary — HTTP Route Table
+ *
+ * httpd matches each request against every registered URI in turn and
+ * caps the table at max_uri_handlers. Routes are instead compiled at
+ * registration into a prefix trie of path segments, and httpd holds one
+ * catch-all handler per method that dispatches through it, walking the
+ * request path once.
+ *
+ * A pattern segment is either literal or a {name} capture that matches
+ * any one segment, e.g. "/api/logs/{seq}/ack". Literal children win over
+ * a capture at the same depth. Captures and query parameters are views
+ * into req->uri, valid for the duration of the handler: nothing is copied
+ * and nothing is percent-decoded (as with httpd_query_key_value()).
+ *
+ * Handlers run on the httpd task one at a time, which the per-request
+ * match state relies on. A handler that detaches to an HTTP worker must
+ * read what it needs before it returns.
+ *
+ * Copyright (c) 2026 ERRERlabs / Karl May
+ * License: Apache-2.0
+ */
+
+#ifndef SECURACV_HTTP_ROUTER_H
+#define SECURACV_HTTP_ROUTER_H
+
+#include <Arduino.h>
+#include "esp_http_server.h"
+#include "canary_config.h"
+
+// Non-owning slice of req->uri; ptr is nullptr when the value is absent
+struct HttpView {
+  const char* ptr;
+  uint16_t len;
+
+  bool present() const { return ptr != nullptr; }
+  bool equals(const char* s) const;
+  // Leading decimal digits (saturating), or def when absent
+  uint32_t toU32(uint32_t def) const;
+  // Whole value as a decimal uint32; false if absent, empty, non-digit or too large
+  bool parseU32(uint32_t* out) const;
+  // NUL-terminated copy; false if absent or longer than cap - 1
+  bool copy(char* out, size_t cap) const;
+};
+
+typedef esp_err_t (*HttpRouteFn)(httpd_req_t* req);
+
+// Add a route; the pattern must outlive the router (pass a literal).
+// Registering the same pattern and method again replaces fn and ctx.
+// ctx arrives as req->user_ctx.
+bool http_router_add(const char* pattern, httpd_method_t method, HttpRouteFn fn, void* ctx);
+
+// Register the catch-all handlers on a freshly started server
+void http_router_attach(httpd_handle_t server);
+
+// {name} capture of the route being served
+HttpView http_path_param(httpd_req_t* req, const char* name);
+
+// Query parameter of the request being served; the query string is
+// tokenized once per request, on dispatch
+HttpView http_query_param(httpd_req_t* req, const char* key);
+
+#endif // SECURACV_HTTP_ROUTER_H
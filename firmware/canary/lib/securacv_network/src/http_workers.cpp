@@ -0,0 +1,191 @@
+/*
+ * SecuraCV Canary — HTTP Worker Pool Implementation
+ *
+ * Copyright (c) 2026 ERRERlabs / Karl May
+ * License: Apache-2.0
+ */
+
+#include "http_workers.h"
+#include "lwip/sockets.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+
+struct HttpJob {
+  int fd;
+  HttpWorkerFn fn;
+  void* arg;
+};
+
+// A socket handed to a worker. released is set once httpd has dropped the
+// session, after which nothing but the worker touches the fd.
+struct DetachedSocket {
+  int fd;
+  bool released;
+};
+
+static const size_t DETACHED_SLOTS = HTTP_WORKER_COUNT + HTTP_WORKER_QUEUE;
+
+static QueueHandle_t s_jobs = nullptr;
+static DetachedSocket s_detached[DETACHED_SLOTS];
+static portMUX_TYPE s_detached_mux = portMUX_INITIALIZER_UNLOCKED;
+static uint8_t s_busy = 0;            // Guarded by s_detached_mux
+
+// ════════════════════════════════════════════════════════════════════════════
+// DETACHED SOCKET TABLE
+// ════════════════════════════════════════════════════════════════════════════
+
+static bool detached_claim(int fd) {
+  bool ok = false;
+  portENTER_CRITICAL(&s_detached_mux);
+  for (size_t i = 0; i < DETACHED_SLOTS; i++) {
+    if (s_detached[i].fd < 0) {
+      s_detached[i].fd = fd;
+      s_detached[i].released = false;
+      s_busy++;
+      ok = true;
+      break;
+    }
+  }
+  portEXIT_CRITICAL(&s_detached_mux);
+  return ok;
+}
+
+static void detached_drop(int fd) {
+  portENTER_CRITICAL(&s_detached_mux);
+  for (size_t i = 0; i < DETACHED_SLOTS; i++) {
+    if (s_detached[i].fd == fd) {
+      s_detached[i].fd = -1;
+      s_busy--;
+    }
+  }
+  portEXIT_CRITICAL(&s_detached_mux);
+}
+
+// Mark fd released if a worker owns it; returns whether it does
+static bool detached_release(int fd) {
+  bool owned = false;
+  portENTER_CRITICAL(&s_detached_mux);
+  for (size_t i = 0; i < DETACHED_SLOTS; i++) {
+    if (s_detached[i].fd == fd) {
+      s_detached[i].released = true;
+      owned = true;
+    }
+  }
+  portEXIT_CRITICAL(&s_detached_mux);
+  return owned;
+}
+
+static bool detached_is_released(int fd) {
+  bool released = false;
+  portENTER_CRITICAL(&s_detached_mux);
+  for (size_t i = 0; i < DETACHED_SLOTS; i++) {
+    if (s_detached[i].fd == fd) released = s_detached[i].released;
+  }
+  portEXIT_CRITICAL(&s_detached_mux);
+  return released;
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// WORKERS
+// ════════════════════════════════════════════════════════════════════════════
+
+static void http_worker_task(void* arg) {
+  (void)arg;
+  HttpJob job;
+
+  for (;;) {
+    if (xQueueReceive(s_jobs, &job, portMAX_DELAY) != pdTRUE) continue;
+
+    // Wait for httpd to finish tearing down the session
+    for (int i = 0; i < 100 && !detached_is_released(job.fd); i++) {
+      vTaskDelay(pdMS_TO_TICKS(10));
+    }
+
+    if (detached_is_released(job.fd)) {
+      struct timeval tv = { HTTP_WORKER_SEND_TIMEOUT_MS / 1000, (HTTP_WORKER_SEND_TIMEOUT_MS % 1000) * 1000 };
+      setsockopt(job.fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+      job.fn(job.fd, job.arg);
+      close(job.fd);
+    } else {
+      job.fn(-1, job.arg);    // Never handed over; lets the job release arg
+    }
+
+    detached_drop(job.fd);
+  }
+}
+
+bool http_workers_begin() {
+  if (s_jobs) return true;
+
+  for (size_t i = 0; i < DETACHED_SLOTS; i++) s_detached[i].fd = -1;
+
+  s_jobs = xQueueCreate(HTTP_WORKER_QUEUE, sizeof(HttpJob));
+  if (!s_jobs) return false;
+
+  for (int i = 0; i < HTTP_WORKER_COUNT; i++) {
+    char name[16];
+    snprintf(name, sizeof(name), "http_worker%d", i);
+    if (xTaskCreate(http_worker_task, name, HTTP_WORKER_STACK, nullptr,
+                    HTTP_WORKER_PRIORITY, nullptr) != pdPASS) {
+      Serial.println("[!!] HTTP worker task creation failed");
+      return i > 0;
+    }
+  }
+  return true;
+}
+
+void http_workers_close_fn(httpd_handle_t hd, int fd) {
+  (void)hd;
+  if (!detached_release(fd)) {
+    close(fd);
+  }
+}
+
+esp_err_t http_worker_detach(httpd_req_t* req, HttpWorkerFn fn, void* arg) {
+  if (!s_jobs) return ESP_FAIL;
+
+  int fd = httpd_req_to_sockfd(req);
+  if (fd < 0 || !detached_claim(fd)) return ESP_FAIL;
+
+  HttpJob job = { fd, fn, arg };
+  if (xQueueSend(s_jobs, &job, 0) != pdTRUE) {
+    detached_drop(fd);
+    return ESP_FAIL;
+  }
+
+  // httpd deletes the session after this handler returns; close_fn then
+  // leaves the socket open and marks it released for the worker
+  httpd_sess_trigger_close(req->handle, fd);
+  return ESP_OK;
+}
+
+bool http_worker_send(int fd, const void* data, size_t len) {
+  const uint8_t* p = (const uint8_t*)data;
+  while (len > 0) {
+    int n = send(fd, p, len, 0);
+    if (n <= 0) return false;
+    p += n;
+    len -= n;
+  }
+  return true;
+}
+
+bool http_worker_send_head(int fd, const char* status, const char* content_type,
+                           const char* extra) {
+  char head[384];
+  int n = snprintf(head, sizeof(head),
+    "HTTP/1.1 %s\r\n"
+    "Content-Type: %s\r\n"
+    "Cache-Control: no-cache\r\n"
+    "Access-Control-Allow-Origin: *\r\n"
+    "%s"
+    "Connection: close\r\n\r\n",
+    status, content_type, extra ? extra : "");
+  if (n < 0 || (size_t)n >= sizeof(head)) return false;
+  return http_worker_send(fd, head, n);
+}
+
+uint8_t http_workers_busy() {
+  return s_busy;
+}
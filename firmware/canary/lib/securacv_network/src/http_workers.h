@@ -0,0 +1,52 @@
+/*
+ * SecuraCV Canary — HTTP Worker Pool
+ *
+ * Long-lived responses (MJPEG peek stream, chain verification, SD
+ * exports) must not run inside the single httpd task, or every other
+ * endpoint waits behind them. A handler calls http_worker_detach() instead of responding: the
+ * socket is taken over from httpd and handed to a small pool of
+ * lower-priority worker tasks, which write the whole response (status
+ * line included) with http_worker_send() and close the socket when done.
+ *
+ * The Arduino-ESP32 2.x IDF has no httpd_req_async_handler_begin(), so the
+ * handoff uses the server's close_fn hook: httpd drops the session but
+ * leaves a detached socket open for its worker.
+ *
+ * Copyright (c) 2026 ERRERlabs / Karl May
+ * License: Apache-2.0
+ */
+
+#ifndef SECURACV_HTTP_WORKERS_H
+#define SECURACV_HTTP_WORKERS_H
+
+#include <Arduino.h>
+#include "esp_http_server.h"
+#include "canary_config.h"
+
+// Runs on a worker task and owns fd until it returns. fd is -1 if httpd
+// never released the socket; the job must then only release arg.
+typedef void (*HttpWorkerFn)(int fd, void* arg);
+
+// Start the worker tasks (idempotent). Call before httpd_start().
+bool http_workers_begin();
+
+// httpd_config_t.close_fn: closes sockets unless a worker owns them
+void http_workers_close_fn(httpd_handle_t hd, int fd);
+
+// Detach req's socket and queue fn. On ESP_OK the handler must return
+// without responding; on failure (pool full) it responds as usual.
+esp_err_t http_worker_detach(httpd_req_t* req, HttpWorkerFn fn, void* arg);
+
+// Blocking send of the whole buffer; false once the client is gone
+bool http_worker_send(int fd, const void* data, size_t len);
+
+// Status line ("200 OK") and headers of a worker-written response. extra
+// holds further header lines, each ending in CRLF. The body that follows
+// ends when the worker closes the socket.
+bool http_worker_send_head(int fd, const char* status, const char* content_type,
+                           const char* extra = nullptr);
+
+// Jobs running or queued
+uint8_t http_workers_busy();
+
+#endif // SECURACV_HTTP_WORKERS_H
@@ -0,0 +1,221 @@
+/*
+ * SecuraCV Canary — Streaming JSON Writer Implementation
+ *
+ * Copyright (c) 2026 ERRERlabs / Karl May
+ * License: Apache-2.0
+ */
+
+#include "json_writer.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+// Uppercase, matching hex_to_str() so API hex fields keep their format
+static const char HEX_DIGITS[] = "0123456789ABCDEF";
+
+JsonWriter::JsonWriter(char* buf, size_t cap)
+  : m_req(nullptr), m_buf(buf), m_cap(cap), m_len(0),
+    m_has_items(0), m_depth(0), m_after_key(false), m_error(cap == 0) {
+}
+
+JsonWriter::JsonWriter(httpd_req_t* req, char* buf, size_t cap)
+  : m_req(req), m_buf(buf), m_cap(cap), m_len(0),
+    m_has_items(0), m_depth(0), m_after_key(false), m_error(cap == 0) {
+  httpd_resp_set_type(req, "application/json");
+  httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+  httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// STRUCTURE
+// ════════════════════════════════════════════════════════════════════════════
+
+void JsonWriter::separator() {
+  if (m_after_key) {
+    m_after_key = false;
+    return;
+  }
+  if (m_depth == 0) return;
+  uint32_t bit = 1u << (m_depth - 1);
+  if (m_has_items & bit) put(',');
+  m_has_items |= bit;
+}
+
+void JsonWriter::open(char c) {
+  separator();
+  if (m_depth >= MAX_DEPTH) {
+    m_error = true;
+    return;
+  }
+  put(c);
+  m_depth++;
+  m_has_items &= ~(1u << (m_depth - 1));
+}
+
+void JsonWriter::close(char c) {
+  if (m_depth == 0) {
+    m_error = true;
+    return;
+  }
+  m_depth--;
+  put(c);
+}
+
+JsonWriter& JsonWriter::beginObject() { open('{'); return *this; }
+JsonWriter& JsonWriter::beginObject(const char* k) { key(k); open('{'); return *this; }
+JsonWriter& JsonWriter::endObject() { close('}'); return *this; }
+JsonWriter& JsonWriter::beginArray() { open('['); return *this; }
+JsonWriter& JsonWriter::beginArray(const char* k) { key(k); open('['); return *this; }
+JsonWriter& JsonWriter::endArray() { close(']'); return *this; }
+
+JsonWriter& JsonWriter::key(const char* k) {
+  separator();
+  put('"');
+  putEscaped(k, strlen(k));
+  put('"');
+  put(':');
+  m_after_key = true;
+  return *this;
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// VALUES
+// ════════════════════════════════════════════════════════════════════════════
+
+JsonWriter& JsonWriter::str(const char* s) {
+  if (!s) return null();
+  return str(s, strlen(s));
+}
+
+JsonWriter& JsonWriter::str(const char* s, size_t len) {
+  separator();
+  put('"');
+  putEscaped(s, len);
+  put('"');
+  return *this;
+}
+
+JsonWriter& JsonWriter::hex(const uint8_t* data, size_t len) {
+  separator();
+  put('"');
+  for (size_t i = 0; i < len; i++) {
+    put(HEX_DIGITS[data[i] >> 4]);
+    put(HEX_DIGITS[data[i] & 0x0F]);
+  }
+  put('"');
+  return *this;
+}
+
+JsonWriter& JsonWriter::i64(int64_t v) {
+  separator();
+  char tmp[24];
+  int n = snprintf(tmp, sizeof(tmp), "%lld", (long long)v);
+  put(tmp, n);
+  return *this;
+}
+
+JsonWriter& JsonWriter::u64(uint64_t v) {
+  separator();
+  char tmp[24];
+  int n = snprintf(tmp, sizeof(tmp), "%llu", (unsigned long long)v);
+  put(tmp, n);
+  return *this;
+}
+
+JsonWriter& JsonWriter::num(double v) {
+  if (isnan(v) || isinf(v)) return null();
+  separator();
+  char tmp[32];
+  int n = snprintf(tmp, sizeof(tmp), "%.10g", v);
+  put(tmp, n);
+  return *this;
+}
+
+JsonWriter& JsonWriter::boolean(bool v) {
+  separator();
+  if (v) put("true", 4);
+  else put("false", 5);
+  return *this;
+}
+
+JsonWriter& JsonWriter::null() {
+  separator();
+  put("null", 4);
+  return *this;
+}
+
+JsonWriter& JsonWriter::members(const char* json, size_t len) {
+  if (len == 0) return *this;
+  separator();
+  put(json, len);
+  return *this;
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// OUTPUT
+// ════════════════════════════════════════════════════════════════════════════
+
+bool JsonWriter::flush() {
+  if (!m_req) {
+    m_error = true;     // Bounded output overflowed
+    return false;
+  }
+  if (m_len > 0 && httpd_resp_send_chunk(m_req, m_buf, m_len) != ESP_OK) {
+    m_error = true;
+    return false;
+  }
+  m_len = 0;
+  return true;
+}
+
+void JsonWriter::put(char c) {
+  if (m_error) return;
+  // Bounded mode keeps one byte for the terminator
+  size_t limit = m_req ? m_cap : m_cap - 1;
+  if (m_len >= limit && !flush()) return;
+  m_buf[m_len++] = c;
+}
+
+void JsonWriter::put(const char* s, size_t n) {
+  while (n > 0 && !m_error) {
+    size_t limit = m_req ? m_cap : m_cap - 1;
+    if (m_len >= limit && !flush()) return;
+    size_t room = limit - m_len;
+    size_t take = n < room ? n : room;
+    memcpy(m_buf + m_len, s, take);
+    m_len += take;
+    s += take;
+    n -= take;
+  }
+}
+
+void JsonWriter::putEscaped(const char* s, size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    unsigned char c = (unsigned char)s[i];
+    switch (c) {
+      case '"':  put("\\\"", 2); break;
+      case '\\': put("\\\\", 2); break;
+      case '\n': put("\\n", 2); break;
+      case '\r': put("\\r", 2); break;
+      case '\t': put("\\t", 2); break;
+      default:
+        if (c < 0x20) {
+          char esc[6] = { '\\', 'u', '0', '0', HEX_DIGITS[c >> 4], HEX_DIGITS[c & 0x0F] };
+          put(esc, sizeof(esc));
+        } else {
+          put((char)c);
+        }
+    }
+  }
+}
+
+esp_err_t JsonWriter::finish() {
+  if (!m_req) {
+    if (m_cap > 0) m_buf[m_len] = '\0';
+    return m_error || m_depth != 0 ? ESP_FAIL : ESP_OK;
+  }
+  if (m_error || !flush()) {
+    return ESP_FAIL;
+  }
+  return httpd_resp_send_chunk(m_req, nullptr, 0);
+}
@@ -0,0 +1,103 @@
+/*
+ * SecuraCV Canary — Streaming JSON Writer
+ *
+ * Writes JSON into a caller-supplied fixed buffer without touching the
+ * heap. Bound to an HTTP request, the buffer is flushed with
+ * httpd_resp_send_chunk() whenever it fills, so a response can be any
+ * size. Unbound, output is limited to the buffer and overflow is an error.
+ *
+ *   JsonWriter w(req, buf, sizeof(buf));
+ *   w.beginObject();
+ *   w.field("ok", true).field("seq", device.seq);
+ *   w.beginArray("logs");
+ *   ...
+ *   w.endArray().endObject();
+ *   return w.finish();
+ *
+ * Copyright (c) 2026 ERRERlabs / Karl May
+ * License: Apache-2.0
+ */
+
+#ifndef SECURACV_JSON_WRITER_H
+#define SECURACV_JSON_WRITER_H
+
+#include <Arduino.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <type_traits>
+#include "esp_http_server.h"
+
+class JsonWriter {
+public:
+  static const uint8_t MAX_DEPTH = 16;
+
+  // Bounded: output NUL-terminated in buf, error on overflow
+  JsonWriter(char* buf, size_t cap);
+
+  // Chunked HTTP response: sets the JSON headers, flushes as buf fills
+  JsonWriter(httpd_req_t* req, char* buf, size_t cap);
+
+  JsonWriter& beginObject();
+  JsonWriter& beginObject(const char* key);
+  JsonWriter& endObject();
+  JsonWriter& beginArray();
+  JsonWriter& beginArray(const char* key);
+  JsonWriter& endArray();
+
+  JsonWriter& key(const char* k);
+
+  // Values (inside arrays, or after key())
+  JsonWriter& str(const char* s);
+  JsonWriter& str(const char* s, size_t len);
+  JsonWriter& hex(const uint8_t* data, size_t len);
+  JsonWriter& i64(int64_t v);
+  JsonWriter& u64(uint64_t v);
+  JsonWriter& num(double v);       // NaN and infinities become null
+  JsonWriter& boolean(bool v);
+  JsonWriter& null();
+
+  // Any scalar, picking the writer from its type
+  template <typename T>
+  JsonWriter& value(T v) {
+    if constexpr (std::is_same<T, bool>::value) return boolean(v);
+    else if constexpr (std::is_floating_point<T>::value) return num(v);
+    else if constexpr (std::is_integral<T>::value && std::is_signed<T>::value) return i64(v);
+    else if constexpr (std::is_integral<T>::value || std::is_enum<T>::value) return u64((uint64_t)v);
+    else if constexpr (std::is_same<T, std::nullptr_t>::value) return null();
+    else return str(v);
+  }
+
+  template <typename T>
+  JsonWriter& field(const char* k, T v) { return key(k).value(v); }
+
+  JsonWriter& fieldHex(const char* k, const uint8_t* data, size_t len) { return key(k).hex(data, len); }
+
+  // Pre-rendered object members ("a":1,"b":2), separated as one member
+  JsonWriter& members(const char* json, size_t len);
+
+  // HTTP: flush and end the chunked response. Bounded: NUL-terminate.
+  esp_err_t finish();
+
+  bool ok() const { return !m_error; }
+  size_t length() const { return m_len; }    // Bounded mode: bytes in buf
+
+private:
+  void separator();
+  void open(char c);
+  void close(char c);
+  void put(char c);
+  void put(const char* s, size_t n);
+  void putEscaped(const char* s, size_t n);
+  bool flush();
+
+  httpd_req_t* m_req;
+  char* m_buf;
+  size_t m_cap;
+  size_t m_len;
+  uint32_t m_has_items;      // Bit per depth: container already holds an item
+  uint8_t m_depth;
+  bool m_after_key;
+  bool m_error;
+};
+
+#endif // SECURACV_JSON_WRITER_H
@@ -0,0 +1,233 @@
+/*
+ * SecuraCV Canary — Pipelined OTA Ingest Implementation
+ *
+ * Copyright (c) 2026 ERRERlabs / Karl May
+ * License: Apache-2.0
+ */
+
+#include "ota_ingest.h"
+
+#if FEATURE_OTA_UPDATE
+
+#include <Update.h>
+#include "esp_ota_ops.h"
+#include "esp_partition.h"
+#include "mbedtls/sha256.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+static_assert(OTA_BUF_SIZE <= UINT16_MAX, "OtaBlock.len is 16-bit");
+static_assert(OTA_BUF_COUNT <= UINT8_MAX, "OtaBlock.index is 8-bit");
+
+// A filled block handed to the writer; len 0 ends the stream
+struct OtaBlock {
+  uint8_t index;
+  uint16_t len;
+};
+
+struct OtaPipeline {
+  uint8_t* buf[OTA_BUF_COUNT];
+  QueueHandle_t free_q;     // Buffer indices ready to receive into
+  QueueHandle_t full_q;     // OtaBlocks waiting to be flashed
+  SemaphoreHandle_t done;
+  mbedtls_sha256_context sha;
+  ota_decoder_t decoder;    // Owned by the writer once it runs
+  const esp_partition_t* base;  // Running firmware, for delta COPY/ADD
+  volatile bool write_failed;
+  uint32_t flash_us;
+};
+
+// ════════════════════════════════════════════════════════════════════════════
+// DECODER CALLBACKS (writer task)
+// ════════════════════════════════════════════════════════════════════════════
+
+// Decoded image bytes: hash, then flash
+static bool ota_write_image(void* ctx, const uint8_t* data, size_t len) {
+  OtaPipeline* p = (OtaPipeline*)ctx;
+  mbedtls_sha256_update(&p->sha, data, len);
+  return Update.write((uint8_t*)data, len) == len;
+}
+
+static bool ota_read_base(void* ctx, uint32_t offset, uint8_t* buf, size_t len) {
+  OtaPipeline* p = (OtaPipeline*)ctx;
+  return p->base && esp_partition_read(p->base, offset, buf, len) == ESP_OK;
+}
+
+// A delta only applies to the image it was made from: hash the running one
+static bool ota_check_base(void* ctx, uint32_t base_size, const uint8_t base_sha256[32]) {
+  OtaPipeline* p = (OtaPipeline*)ctx;
+  if (!p->base || base_size > p->base->size) return false;
+
+  uint8_t* buf = (uint8_t*)malloc(OTA_BUF_SIZE);
+  if (!buf) return false;
+
+  mbedtls_sha256_context sha;
+  mbedtls_sha256_init(&sha);
+  mbedtls_sha256_starts(&sha, 0);
+  bool ok = true;
+  for (uint32_t off = 0; ok && off < base_size; off += OTA_BUF_SIZE) {
+    size_t n = base_size - off < OTA_BUF_SIZE ? base_size - off : OTA_BUF_SIZE;
+    ok = esp_partition_read(p->base, off, buf, n) == ESP_OK;
+    if (ok) mbedtls_sha256_update(&sha, buf, n);
+  }
+  uint8_t digest[32];
+  mbedtls_sha256_finish(&sha, digest);
+  mbedtls_sha256_free(&sha);
+  free(buf);
+
+  return ok && memcmp(digest, base_sha256, sizeof(digest)) == 0;
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// WRITER TASK
+// ════════════════════════════════════════════════════════════════════════════
+
+static void ota_writer_task(void* arg) {
+  OtaPipeline* p = (OtaPipeline*)arg;
+  OtaBlock block;
+
+  while (xQueueReceive(p->full_q, &block, portMAX_DELAY) == pdTRUE && block.len > 0) {
+    // After a failure keep draining so the receiver never blocks forever
+    if (!p->write_failed) {
+      uint32_t t0 = micros();
+      if (!ota_decoder_feed(&p->decoder, p->buf[block.index], block.len)) {
+        p->write_failed = true;
+      }
+      p->flash_us += micros() - t0;
+    }
+    xQueueSend(p->free_q, &block.index, portMAX_DELAY);
+  }
+
+  // Nothing may touch p after this; it lives on the receiver's stack
+  xSemaphoreGive(p->done);
+  vTaskDelete(nullptr);
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// RECEIVER (httpd task)
+// ════════════════════════════════════════════════════════════════════════════
+
+// Fill one buffer (or the remainder). Returns bytes read, 0 on error.
+static size_t ota_recv_block(httpd_req_t* req, uint8_t* buf, size_t want) {
+  size_t got = 0;
+  uint32_t last_data_ms = millis();
+  while (got < want) {
+    int n = httpd_req_recv(req, (char*)buf + got, want - got);
+    if (n == HTTPD_SOCK_ERR_TIMEOUT) {
+      if (millis() - last_data_ms >= OTA_RECV_TIMEOUT_MS) return 0;
+      continue;
+    }
+    if (n <= 0) return 0;
+    got += n;
+    last_data_ms = millis();
+  }
+  return got;
+}
+
+static void ota_fail(OtaIngestResult* out, int status, const char* error) {
+  out->status = status;
+  out->error = error;
+}
+
+bool ota_ingest(httpd_req_t* req, ota_encoding_t encoding, uint32_t image_size,
+                const uint8_t* expected_sha256, OtaIngestResult* out) {
+  memset(out, 0, sizeof(*out));
+  uint32_t start_ms = millis();
+
+  OtaPipeline p;
+  memset(&p, 0, sizeof(p));
+  bool ok = true;
+
+  for (size_t i = 0; i < OTA_BUF_COUNT; i++) {
+    p.buf[i] = (uint8_t*)malloc(OTA_BUF_SIZE);
+    if (!p.buf[i]) ok = false;
+  }
+  p.free_q = xQueueCreate(OTA_BUF_COUNT, sizeof(uint8_t));
+  p.full_q = xQueueCreate(OTA_BUF_COUNT + 1, sizeof(OtaBlock));
+  p.done = xSemaphoreCreateBinary();
+  if (!p.free_q || !p.full_q || !p.done) ok = false;
+
+  p.base = esp_ota_get_running_partition();
+  ota_decoder_io_t io = { ota_write_image, ota_read_base, ota_check_base, &p };
+  if (ok && !ota_decoder_init(&p.decoder, encoding, image_size, &io)) ok = false;
+
+  TaskHandle_t writer = nullptr;
+  if (ok) {
+    for (uint8_t i = 0; i < OTA_BUF_COUNT; i++) xQueueSend(p.free_q, &i, 0);
+    mbedtls_sha256_init(&p.sha);
+    mbedtls_sha256_starts(&p.sha, 0);
+    if (xTaskCreate(ota_writer_task, "ota_writer", OTA_WRITER_STACK, &p,
+                    OTA_WRITER_PRIORITY, &writer) != pdPASS) {
+      mbedtls_sha256_free(&p.sha);
+      writer = nullptr;
+      ok = false;
+    }
+  }
+  if (!ok) {
+    ota_fail(out, 500, "ota_no_memory");
+  }
+
+  if (writer) {
+    size_t remaining = req->content_len;
+    while (remaining > 0 && !p.write_failed) {
+      uint8_t index;
+      uint32_t t0 = millis();
+      if (xQueueReceive(p.free_q, &index, pdMS_TO_TICKS(OTA_RECV_TIMEOUT_MS)) != pdTRUE) {
+        ota_fail(out, 500, "write_stalled");
+        break;
+      }
+      out->recv_stall_ms += millis() - t0;
+
+      size_t want = remaining < OTA_BUF_SIZE ? remaining : OTA_BUF_SIZE;
+      size_t got = ota_recv_block(req, p.buf[index], want);
+      if (got == 0) {
+        xQueueSend(p.free_q, &index, 0);
+        ota_fail(out, 500, "receive_failed");
+        break;
+      }
+
+      OtaBlock block = { index, (uint16_t)got };
+      xQueueSend(p.full_q, &block, portMAX_DELAY);
+      remaining -= got;
+      out->bytes += got;
+    }
+
+    // End marker, then wait for the writer to drain and exit
+    OtaBlock end = { 0, 0 };
+    xQueueSend(p.full_q, &end, portMAX_DELAY);
+    xSemaphoreTake(p.done, portMAX_DELAY);
+
+    bool decoded = !p.write_failed && ota_decoder_finish(&p.decoder);
+    mbedtls_sha256_finish(&p.sha, out->sha256);
+    mbedtls_sha256_free(&p.sha);
+    out->flash_ms = p.flash_us / 1000;
+    out->image_bytes = p.decoder.out_bytes;
+
+    // Bad input is the client's (400); a failed flash write is ours
+    if (!out->error && !decoded) {
+      if (p.decoder.status == OTA_DECODE_WRITE_FAILED) {
+        ota_fail(out, 500, "write_failed");
+      } else {
+        ota_fail(out, 400, ota_decode_status_name(p.decoder.status));
+      }
+    }
+    if (!out->error && expected_sha256 && memcmp(out->sha256, expected_sha256, 32) != 0) {
+      ota_fail(out, 400, "sha256_mismatch");
+    }
+  }
+
+  ota_decoder_free(&p.decoder);
+  for (size_t i = 0; i < OTA_BUF_COUNT; i++) {
+    free(p.buf[i]);
+  }
+  if (p.free_q) vQueueDelete(p.free_q);
+  if (p.full_q) vQueueDelete(p.full_q);
+  if (p.done) vSemaphoreDelete(p.done);
+
+  out->elapsed_ms = millis() - start_ms;
+  return out->error == nullptr;
+}
+
+#endif // FEATURE_OTA_UPDATE
@@ -0,0 +1,47 @@
+/*
+ * SecuraCV Canary — Pipelined OTA Ingest
+ *
+ * Receives an OTA image on the httpd task while a writer task flashes the
+ * previous block and feeds it to SHA-256. OTA_BUF_COUNT buffers cycle
+ * between the two through a pair of queues, so an upload takes roughly
+ * max(network, flash) instead of their sum.
+ *
+ * The body may be a zlib stream or a delta patch against the running
+ * firmware (common/encoding/ota_decode.h); the writer decodes it before
+ * flashing, and the SHA-256 covers the decoded image.
+ *
+ * Copyright (c) 2026 ERRERlabs / Karl May
+ * License: Apache-2.0
+ */
+
+#ifndef SECURACV_OTA_INGEST_H
+#define SECURACV_OTA_INGEST_H
+
+#include <Arduino.h>
+#include "esp_http_server.h"
+#include "canary_config.h"
+#include "common/encoding/ota_decode.h"
+
+#if FEATURE_OTA_UPDATE
+
+struct OtaIngestResult {
+  int status;               // HTTP status for http_send_error() on failure
+  const char* error;        // Error code, nullptr on success
+  uint8_t sha256[32];       // Digest of everything written
+  uint32_t bytes;           // Received (encoded) bytes
+  uint32_t image_bytes;     // Decoded bytes written
+  uint32_t elapsed_ms;      // Whole upload
+  uint32_t flash_ms;        // Writer busy time (flash + hash)
+  uint32_t recv_stall_ms;   // Receiver waiting for a free buffer
+};
+
+// Stream req's body into the OTA partition, decoding it per `encoding`.
+// Update.begin(image_size) must have succeeded; the caller finishes with
+// Update.end() or Update.abort(). expected_sha256 (may be null) is checked
+// against the decoded image before returning true.
+bool ota_ingest(httpd_req_t* req, ota_encoding_t encoding, uint32_t image_size,
+                const uint8_t* expected_sha256, OtaIngestResult* out);
+
+#endif // FEATURE_OTA_UPDATE
+
+#endif // SECURACV_OTA_INGEST_H
@@ -8,10 +8,27 @@
 #include "securacv_network.h"
 #include "securacv_witness.h"
 #include "securacv_crypto.h"
+#include "crypto_backend.h"
+#include "witness_journal.h"
+#include "securacv_webui.h"
 
 #if FEATURE_WIFI_AP || FEATURE_HTTP_SERVER
 
-#include <ArduinoJson.h>
+#include "json_writer.h"
+#include "http_workers.h"
+#include "http_router.h"
+#include "securacv_metrics.h"
+#include "perf_profiler.h"
+#include "event_trace.h"
+#include "securacv_bench.h"
+#include "securacv_power.h"
+#include "common/encoding/cbor.h"
+#include "common/encoding/cbor_reader.h"
+#include "mbedtls/sha256.h"
+#include "esp_netif.h"
+#include "esp_netif_net_stack.h"
+#include "lwip/dhcp.h"
+#include <atomic>
 
 #if FEATURE_SD_STORAGE
 #include "securacv_storage.h"
@@ -23,6 +40,7 @@
 
 #if FEATURE_OTA_UPDATE
 #include <Update.h>
+#include "ota_ingest.h"
 #endif
 
 // ════════════════════════════════════════════════════════════════════════════
@@ -49,7 +67,8 @@ esp_err_t http_send_json(httpd_req_t* req, const char* json) {
 esp_err_t http_send_error(httpd_req_t* req, int status_code, const char* error_code) {
   httpd_resp_set_status(req, status_code == 400 ? "400 Bad Request" :
                               status_code == 404 ? "404 Not Found" :
-                              status_code == 500 ? "500 Internal Server Error" : "400 Bad Request");
+                              status_code == 500 ? "500 Internal Server Error" :
+                              status_code == 503 ? "503 Service Unavailable" : "400 Bad Request");
   char response[128];
   snprintf(response, sizeof(response), "{\"ok\":false,\"error\":\"%s\"}", error_code);
   return http_send_json(req, response);
@@ -60,9 +79,12 @@ esp_err_t http_send_error(httpd_req_t* req, int status_code, const char* error_c
 // ════════════════════════════════════════════════════════════════════════════
 
 NetworkManager::NetworkManager()
-  : m_http_server(nullptr), m_scan_in_progress(false) {
+  : m_http_server(nullptr), m_scan_in_progress(false), m_last_event_poll_ms(0),
+    m_fast_valid(false), m_fast_attempt(false), m_fast_static(false),
+    m_lease_start_ms(0), m_lease_ms(0), m_connect_start_ms(0) {
   memset(&m_creds, 0, sizeof(m_creds));
   memset(&m_status, 0, sizeof(m_status));
+  memset(&m_fast, 0, sizeof(m_fast));
 }
 
 const char* NetworkManager::stateName(WiFiProvState s) {
@@ -77,7 +99,11 @@ const char* NetworkManager::stateName(WiFiProvState s) {
   }
 }
 
+static PerfScopeId s_wifi_check_perf = PERF_SCOPE_NONE;
+
 bool NetworkManager::begin(const char* ap_ssid, const char* ap_password) {
+  s_wifi_check_perf = perf_scope("wifi_check_connection");
+
   // Load saved credentials
   bool has_creds = loadCredentials();
 
@@ -88,12 +114,13 @@ bool NetworkManager::begin(const char* ap_ssid, const char* ap_password) {
   bool ap_ok = WiFi.softAP(ap_ssid, ap_password, AP_CHANNEL, false, AP_MAX_CONNECTIONS);
 
   if (!ap_ok) {
-    log_health(LOG_LEVEL_ERROR, LOG_CAT_NETWORK, "WiFi AP start failed", nullptr);
+    log_health(LOG_LEVEL_ERROR, LOG_CAT_NETWORK, LOG_MSG_AP_START_FAILED);
     return false;
   }
 
   m_status.ap_active = true;
   witness_get_health().wifi_active = true;
+  witness_mark_status_dirty(STATUS_DIRTY_HEALTH);
 
   IPAddress ip = WiFi.softAPIP();
   snprintf(m_status.ap_ip, sizeof(m_status.ap_ip), "%d.%d.%d.%d", ip[0], ip[1], ip[2], ip[3]);
@@ -105,7 +132,7 @@ bool NetworkManager::begin(const char* ap_ssid, const char* ap_password) {
   // Start mDNS
   if (MDNS.begin("canary")) {
     MDNS.addService("http", "tcp", 80);
-    log_health(LOG_LEVEL_INFO, LOG_CAT_NETWORK, "mDNS started", "canary.local");
+    log_health(LOG_LEVEL_INFO, LOG_CAT_NETWORK, LOG_MSG_MDNS_STARTED, LogArg::msg(LOG_MSG_MDNS_HOSTNAME));
   }
 
   // Attempt to connect to home WiFi if configured
@@ -113,7 +140,7 @@ bool NetworkManager::begin(const char* ap_ssid, const char* ap_password) {
     connectToHome();
   } else {
     m_status.state = WIFI_PROV_AP_ONLY;
-    log_health(LOG_LEVEL_INFO, LOG_CAT_NETWORK, "AP-only mode", "No home WiFi configured");
+    log_health(LOG_LEVEL_INFO, LOG_CAT_NETWORK, LOG_MSG_AP_ONLY_MODE, LogArg::msg(LOG_MSG_NO_HOME_WIFI));
   }
 
   return true;
@@ -141,38 +168,37 @@ bool NetworkManager::loadCredentials() {
   }
 
   nvs.end();
+  m_fast_valid = m_creds.configured && loadFastCache();
   return m_creds.configured;
 }
 
 bool NetworkManager::saveCredentials() {
-  NvsManager& nvs = NvsManager::instance();
-  if (!nvs.beginReadWrite()) return false;
-
-  nvs.putBytes(NVS_KEY_WIFI_SSID, m_creds.ssid, strlen(m_creds.ssid));
-  nvs.putBytes(NVS_KEY_WIFI_PASS, m_creds.password, strlen(m_creds.password));
-  nvs.putBool(NVS_KEY_WIFI_EN, m_creds.enabled);
-
-  nvs.end();
+  NvsTransaction tx;
+  tx.putBytes(NVS_KEY_WIFI_PASS, m_creds.password, strlen(m_creds.password));
+  tx.putBool(NVS_KEY_WIFI_EN, m_creds.enabled);
+  tx.putBytes(NVS_KEY_WIFI_SSID, m_creds.ssid, strlen(m_creds.ssid));   // Marks the set present
+  tx.remove(NVS_KEY_WIFI_FAST);           // Learned again on the next connect
+  if (!tx.commit()) return false;
   m_creds.configured = true;
+  m_fast_valid = false;
 
-  log_health(LOG_LEVEL_INFO, LOG_CAT_NETWORK, "WiFi credentials saved", m_creds.ssid);
+  log_health(LOG_LEVEL_INFO, LOG_CAT_NETWORK, LOG_MSG_WIFI_CREDS_SAVED, m_creds.ssid);
   return true;
 }
 
 bool NetworkManager::clearCredentials() {
-  NvsManager& nvs = NvsManager::instance();
-  if (!nvs.beginReadWrite()) return false;
-
-  nvs.remove(NVS_KEY_WIFI_SSID);
-  nvs.remove(NVS_KEY_WIFI_PASS);
-  nvs.remove(NVS_KEY_WIFI_EN);
-
-  nvs.end();
+  NvsTransaction tx;
+  tx.remove(NVS_KEY_WIFI_SSID);
+  tx.remove(NVS_KEY_WIFI_PASS);
+  tx.remove(NVS_KEY_WIFI_EN);
+  tx.remove(NVS_KEY_WIFI_FAST);
+  if (!tx.commit()) return false;
 
   memset(&m_creds, 0, sizeof(m_creds));
+  m_fast_valid = false;
   m_status.state = WIFI_PROV_AP_ONLY;
 
-  log_health(LOG_LEVEL_INFO, LOG_CAT_NETWORK, "WiFi credentials cleared", nullptr);
+  log_health(LOG_LEVEL_INFO, LOG_CAT_NETWORK, LOG_MSG_WIFI_CREDS_CLEARED);
   return true;
 }
 
@@ -190,14 +216,103 @@ void NetworkManager::connectToHome() {
   m_status.state = WIFI_PROV_CONNECTING;
   m_status.connect_attempts++;
   m_status.last_connect_ms = millis();
+  m_connect_start_ms = m_status.last_connect_ms;
 
   char msg[64];
   snprintf(msg, sizeof(msg), "Connecting to: %s", m_creds.ssid);
   log_health(LOG_LEVEL_INFO, LOG_CAT_NETWORK, msg, nullptr);
 
+#if WIFI_FAST_CONNECT
+  if (m_fast_valid) {
+    // Directed: one channel, one BSSID. The last lease is reused as a static
+    // address only while it is short of T1; otherwise DHCP as usual.
+    m_fast_attempt = true;
+    if (leaseT1Remaining(m_connect_start_ms) > 0) {
+      m_fast_static = true;
+      WiFi.config(IPAddress(m_fast.ip), IPAddress(m_fast.gateway),
+                  IPAddress(m_fast.subnet), IPAddress(m_fast.dns));
+    } else if (m_fast_static) {
+      WiFi.config(INADDR_NONE, INADDR_NONE, INADDR_NONE);
+      m_fast_static = false;
+    }
+    WiFi.begin(m_creds.ssid, m_creds.password, m_fast.channel, m_fast.bssid);
+    return;
+  }
+#endif
+  startFullConnect();
+}
+
+void NetworkManager::startFullConnect() {
+  m_fast_attempt = false;
+  if (m_fast_static) {
+    WiFi.config(INADDR_NONE, INADDR_NONE, INADDR_NONE);   // Back to DHCP
+    m_fast_static = false;
+  }
   WiFi.begin(m_creds.ssid, m_creds.password);
 }
 
+// ════════════════════════════════════════════════════════════════════════════
+// FAST RECONNECT CACHE
+// ════════════════════════════════════════════════════════════════════════════
+
+static const uint8_t WIFI_FAST_CACHE_VERSION = 1;
+
+bool NetworkManager::loadFastCache() {
+  NvsManager& nvs = NvsManager::instance();
+  if (!nvs.beginReadOnly()) return false;
+  bool ok = nvs.getBytesLength(NVS_KEY_WIFI_FAST) == sizeof(m_fast) &&
+            nvs.getBytes(NVS_KEY_WIFI_FAST, &m_fast, sizeof(m_fast)) == sizeof(m_fast);
+  nvs.end();
+
+  m_fast.ssid[sizeof(m_fast.ssid) - 1] = '\0';
+  return ok && m_fast.version == WIFI_FAST_CACHE_VERSION &&
+         m_fast.channel >= 1 && m_fast.channel <= 14 && m_fast.ip != 0 &&
+         strcmp(m_fast.ssid, m_creds.ssid) == 0;
+}
+
+// Length of the STA's DHCP binding, read from lwIP once it is bound
+void NetworkManager::noteLease(uint32_t now) {
+  esp_netif_t* netif = esp_netif_get_handle_from_ifkey("WIFI_STA_DEF");
+  struct netif* lwip = netif ? (struct netif*)esp_netif_get_netif_impl(netif) : nullptr;
+  if (!lwip || !dhcp_supplied_address(lwip)) return;
+
+  uint32_t lease_s = netif_dhcp_data(lwip)->offered_t0_lease;
+  if (lease_s > WIFI_FAST_LEASE_MAX_S) lease_s = WIFI_FAST_LEASE_MAX_S;
+  m_lease_start_ms = now;
+  m_lease_ms = lease_s * 1000;
+}
+
+// Time left before the noted lease reaches T1, 0 if it has or none is noted
+uint32_t NetworkManager::leaseT1Remaining(uint32_t now) const {
+  uint32_t elapsed = now - m_lease_start_ms;
+  return m_lease_ms && elapsed < m_lease_ms / 2 ? m_lease_ms / 2 - elapsed : 0;
+}
+
+// Written only when the association or lease differs from the cached one
+void NetworkManager::saveFastCache() {
+  WiFiFastCache c;
+  memset(&c, 0, sizeof(c));
+  c.version = WIFI_FAST_CACHE_VERSION;
+  c.channel = (uint8_t)WiFi.channel();
+  const uint8_t* bssid = WiFi.BSSID();
+  if (!bssid) return;
+  memcpy(c.bssid, bssid, sizeof(c.bssid));
+  c.ip = (uint32_t)WiFi.localIP();
+  c.gateway = (uint32_t)WiFi.gatewayIP();
+  c.subnet = (uint32_t)WiFi.subnetMask();
+  c.dns = (uint32_t)WiFi.dnsIP(0);
+  strncpy(c.ssid, m_creds.ssid, sizeof(c.ssid) - 1);
+  if (c.ip == 0) return;
+
+  if (m_fast_valid && memcmp(&c, &m_fast, sizeof(c)) == 0) return;
+
+  NvsTransaction tx;
+  tx.putBytes(NVS_KEY_WIFI_FAST, &c, sizeof(c));
+  if (!tx.commit()) return;
+  m_fast = c;
+  m_fast_valid = true;
+}
+
 void NetworkManager::updateStatus() {
   m_status.ap_active = (WiFi.getMode() & WIFI_AP) != 0;
   m_status.sta_connected = WiFi.isConnected();
@@ -217,6 +332,7 @@ void NetworkManager::updateStatus() {
 }
 
 void NetworkManager::checkConnection() {
+  PerfTimer perf(s_wifi_check_perf);
   uint32_t now = millis();
   updateStatus();
 
@@ -225,21 +341,53 @@ void NetworkManager::checkConnection() {
       if (WiFi.isConnected()) {
         m_status.state = WIFI_PROV_CONNECTED;
         m_status.connected_since_ms = now;
+        m_status.reconnect_ms = now - m_connect_start_ms;
+        m_status.reconnect_fast = m_fast_attempt;
+        if (m_fast_attempt) m_status.fast_connects++;
+        if (!m_fast_static) m_lease_ms = 0;     // A fresh DHCP exchange; noted once bound
+        saveFastCache();
 
         char msg[80];
-        snprintf(msg, sizeof(msg), "Connected to %s", m_creds.ssid);
+        snprintf(msg, sizeof(msg), "Connected to %s in %lu ms%s", m_creds.ssid,
+                 (unsigned long)m_status.reconnect_ms, m_fast_attempt ? " (cached)" : "");
         log_health(LOG_LEVEL_INFO, LOG_CAT_NETWORK, msg, m_status.sta_ip);
+      } else if (m_fast_attempt && now - m_status.last_connect_ms > WIFI_FAST_CONNECT_TIMEOUT_MS) {
+        // AP moved channel, BSSID changed or the lease went stale: scan instead,
+        // and do not retry the cache until a full connect has refreshed it
+        m_status.fast_fallbacks++;
+        m_fast_valid = false;
+        m_status.last_connect_ms = now;
+        WiFi.disconnect();
+        startFullConnect();
       } else if (now - m_status.last_connect_ms > WIFI_CONNECT_TIMEOUT_MS) {
         m_status.state = WIFI_PROV_FAILED;
-        log_health(LOG_LEVEL_WARNING, LOG_CAT_NETWORK, "WiFi connection timeout", m_creds.ssid);
+        log_health(LOG_LEVEL_WARNING, LOG_CAT_NETWORK, LOG_MSG_WIFI_TIMEOUT, m_creds.ssid);
       }
       break;
 
     case WIFI_PROV_CONNECTED:
       if (!WiFi.isConnected()) {
         m_status.state = WIFI_PROV_FAILED;
-        log_health(LOG_LEVEL_WARNING, LOG_CAT_NETWORK, "WiFi connection lost", nullptr);
+        log_health(LOG_LEVEL_WARNING, LOG_CAT_NETWORK, LOG_MSG_WIFI_LOST);
+#if WIFI_FAST_CONNECT
+        // The cached association was good a moment ago: retry it now
+        // rather than after the reconnect interval
+        if (m_fast_valid && m_creds.configured && m_creds.enabled) connectToHome();
+#endif
+      }
+#if WIFI_FAST_CONNECT
+      else if (m_fast_static && leaseT1Remaining(now) == 0) {
+        // The reused lease reached T1: renew it through DHCP
+        m_fast_static = false;
+        m_lease_ms = 0;
+        WiFi.config(INADDR_NONE, INADDR_NONE, INADDR_NONE);
+      } else if (!m_fast_static) {
+        if (m_lease_ms == 0) noteLease(now);
+        if (m_fast_valid && (uint32_t)WiFi.localIP() != m_fast.ip) {
+          saveFastCache();  // DHCP handed out a different address
+        }
       }
+#endif
       break;
 
     case WIFI_PROV_FAILED:
@@ -258,10 +406,17 @@ void NetworkManager::checkConnection() {
 static esp_err_t handle_ui(httpd_req_t* req);
 static esp_err_t handle_status(httpd_req_t* req);
 static esp_err_t handle_chain(httpd_req_t* req);
+#if FEATURE_SD_STORAGE
+static esp_err_t handle_chain_verify(httpd_req_t* req);
+static esp_err_t handle_chain_records(httpd_req_t* req);
+static esp_err_t handle_export(httpd_req_t* req);
+#endif
 static esp_err_t handle_logs(httpd_req_t* req);
 static esp_err_t handle_log_ack(httpd_req_t* req);
 static esp_err_t handle_ack_all(httpd_req_t* req);
 static esp_err_t handle_reboot(httpd_req_t* req);
+static esp_err_t handle_events(httpd_req_t* req);
+static void sse_reset();
 
 #if FEATURE_OTA_UPDATE
 static esp_err_t handle_ota(httpd_req_t* req);
@@ -272,22 +427,94 @@ static esp_err_t handle_peek_start(httpd_req_t* req);
 static esp_err_t handle_peek_stream(httpd_req_t* req);
 static esp_err_t handle_peek_stop(httpd_req_t* req);
 static esp_err_t handle_peek_status(httpd_req_t* req);
+static esp_err_t handle_peek_snapshot(httpd_req_t* req);
+#endif
+
+#if FEATURE_METRICS
+static esp_err_t handle_metrics(httpd_req_t* req);
+static void metrics_register_system();
+#endif
+
+#if FEATURE_PERF_PROFILER
+static esp_err_t handle_perf(httpd_req_t* req);
+#endif
+
+#if FEATURE_EVENT_TRACE
+static esp_err_t handle_trace(httpd_req_t* req);
+static esp_err_t handle_trace_control(httpd_req_t* req);
+#endif
+
+#if FEATURE_BENCH
+static esp_err_t handle_bench(httpd_req_t* req);
+static esp_err_t handle_bench_start(httpd_req_t* req);
 #endif
 
+// Registered routes; each handler runs through http_route_timed() so its
+// latency lands in a per-URI histogram and profiler scope
+struct HttpRoute {
+  esp_err_t (*handler)(httpd_req_t* req);
+  MetricId latency;
+  PerfScopeId perf;
+};
+
+static HttpRoute s_routes[HTTP_MAX_ROUTES];
+static size_t s_route_count = 0;
+
+static esp_err_t http_route_timed(httpd_req_t* req) {
+  const HttpRoute* route = (const HttpRoute*)req->user_ctx;
+  MetricTimer timer(route->latency);
+  PerfTimer perf(route->perf);
+  PowerBoost boost;
+  return route->handler(req);
+}
+
+static void http_route(const char* uri, httpd_method_t method,
+                       esp_err_t (*handler)(httpd_req_t* req)) {
+  // Reuse the slot across server restarts so histograms keep accumulating
+  HttpRoute* route = nullptr;
+  for (size_t i = 0; i < s_route_count; i++) {
+    if (s_routes[i].handler == handler) route = &s_routes[i];
+  }
+  if (!route) {
+    if (s_route_count >= HTTP_MAX_ROUTES) {
+      log_health(LOG_LEVEL_ERROR, LOG_CAT_NETWORK, LOG_MSG_HTTP_ROUTES_FULL, uri);
+      return;
+    }
+    route = &s_routes[s_route_count++];
+    route->handler = handler;
+    route->latency = metrics_histogram("securacv_http_request_duration_seconds",
+                                       "HTTP handler latency", "handler", uri);
+    route->perf = perf_scope(uri);
+  }
+
+  if (!http_router_add(uri, method, http_route_timed, route)) {
+    log_health(LOG_LEVEL_ERROR, LOG_CAT_NETWORK, LOG_MSG_HTTP_ROUTES_FULL, uri);
+  }
+}
+
 bool NetworkManager::startHttpServer() {
   httpd_config_t config = HTTPD_DEFAULT_CONFIG();
   config.server_port = 80;
   config.uri_match_fn = httpd_uri_match_wildcard;
   config.stack_size = 8192;
-  config.max_uri_handlers = 16;
+  config.max_uri_handlers = HTTP_ROUTER_MAX_METHODS;   // Catch-alls into the route trie
+  config.close_fn = http_workers_close_fn;
 
+  sse_reset();
+  #if FEATURE_METRICS
+  metrics_register_system();
+  #endif
+  if (!http_workers_begin()) {
+    log_health(LOG_LEVEL_WARNING, LOG_CAT_NETWORK, LOG_MSG_HTTP_WORKERS_UNAVAILABLE);
+  }
   if (httpd_start(&m_http_server, &config) != ESP_OK) {
-    log_health(LOG_LEVEL_ERROR, LOG_CAT_NETWORK, "HTTP server start failed", nullptr);
+    log_health(LOG_LEVEL_ERROR, LOG_CAT_NETWORK, LOG_MSG_HTTP_START_FAILED);
     return false;
   }
 
   registerHttpHandlers();
-  log_health(LOG_LEVEL_INFO, LOG_CAT_NETWORK, "HTTP server started", "port 80");
+  http_router_attach(m_http_server);
+  log_health(LOG_LEVEL_INFO, LOG_CAT_NETWORK, LOG_MSG_HTTP_STARTED, LogArg::msg(LOG_MSG_HTTP_PORT_80));
   return true;
 }
 
@@ -295,50 +522,71 @@ void NetworkManager::stopHttpServer() {
   if (m_http_server) {
     httpd_stop(m_http_server);
     m_http_server = nullptr;
+    sse_reset();
   }
 }
 
 void NetworkManager::registerHttpHandlers() {
   // UI
-  httpd_uri_t ui = { .uri = "/", .method = HTTP_GET, .handler = handle_ui };
-  httpd_register_uri_handler(m_http_server, &ui);
+  http_route("/", HTTP_GET, handle_ui);
 
   // API endpoints
-  httpd_uri_t status = { .uri = "/api/status", .method = HTTP_GET, .handler = handle_status };
-  httpd_register_uri_handler(m_http_server, &status);
+  http_route("/api/status", HTTP_GET, handle_status);
+
+  http_route("/api/chain", HTTP_GET, handle_chain);
 
-  httpd_uri_t chain = { .uri = "/api/chain", .method = HTTP_GET, .handler = handle_chain };
-  httpd_register_uri_handler(m_http_server, &chain);
+  #if FEATURE_SD_STORAGE
+  http_route("/api/chain/verify", HTTP_GET, handle_chain_verify);
 
-  httpd_uri_t logs = { .uri = "/api/logs", .method = HTTP_GET, .handler = handle_logs };
-  httpd_register_uri_handler(m_http_server, &logs);
+  http_route("/api/chain/records", HTTP_GET, handle_chain_records);
 
-  httpd_uri_t log_ack = { .uri = "/api/logs/*/ack", .method = HTTP_POST, .handler = handle_log_ack };
-  httpd_register_uri_handler(m_http_server, &log_ack);
+  http_route("/api/export", HTTP_GET, handle_export);
+  #endif
 
-  httpd_uri_t ack_all = { .uri = "/api/logs/ack-all", .method = HTTP_POST, .handler = handle_ack_all };
-  httpd_register_uri_handler(m_http_server, &ack_all);
+  http_route("/api/logs", HTTP_GET, handle_logs);
 
-  httpd_uri_t reboot = { .uri = "/api/reboot", .method = HTTP_POST, .handler = handle_reboot };
-  httpd_register_uri_handler(m_http_server, &reboot);
+  http_route("/api/logs/{seq}/ack", HTTP_POST, handle_log_ack);
+
+  http_route("/api/logs/ack-all", HTTP_POST, handle_ack_all);
+
+  http_route("/api/reboot", HTTP_POST, handle_reboot);
+
+  http_route("/api/events", HTTP_GET, handle_events);
 
   #if FEATURE_OTA_UPDATE
-  httpd_uri_t ota = { .uri = "/api/ota", .method = HTTP_POST, .handler = handle_ota };
-  httpd_register_uri_handler(m_http_server, &ota);
+  http_route("/api/ota", HTTP_POST, handle_ota);
   #endif
 
   #if FEATURE_CAMERA_PEEK
-  httpd_uri_t peek_start = { .uri = "/api/peek/start", .method = HTTP_POST, .handler = handle_peek_start };
-  httpd_register_uri_handler(m_http_server, &peek_start);
+  http_route("/api/peek/start", HTTP_POST, handle_peek_start);
+
+  http_route("/api/peek/stream", HTTP_GET, handle_peek_stream);
+
+  http_route("/api/peek/stop", HTTP_POST, handle_peek_stop);
+
+  http_route("/api/peek/status", HTTP_GET, handle_peek_status);
 
-  httpd_uri_t peek_stream = { .uri = "/api/peek/stream", .method = HTTP_GET, .handler = handle_peek_stream };
-  httpd_register_uri_handler(m_http_server, &peek_stream);
+  http_route("/api/peek/snapshot", HTTP_GET, handle_peek_snapshot);
+  #endif
 
-  httpd_uri_t peek_stop = { .uri = "/api/peek/stop", .method = HTTP_POST, .handler = handle_peek_stop };
-  httpd_register_uri_handler(m_http_server, &peek_stop);
+  #if FEATURE_METRICS
+  http_route("/metrics", HTTP_GET, handle_metrics);
+  #endif
 
-  httpd_uri_t peek_status = { .uri = "/api/peek/status", .method = HTTP_GET, .handler = handle_peek_status };
-  httpd_register_uri_handler(m_http_server, &peek_status);
+  #if FEATURE_PERF_PROFILER
+  http_route("/api/perf", HTTP_GET, handle_perf);
+  #endif
+
+  #if FEATURE_EVENT_TRACE
+  http_route("/api/trace", HTTP_GET, handle_trace);
+
+  http_route("/api/trace", HTTP_POST, handle_trace_control);
+  #endif
+
+  #if FEATURE_BENCH
+  http_route("/api/bench", HTTP_GET, handle_bench);
+
+  http_route("/api/bench", HTTP_POST, handle_bench_start);
   #endif
 }
 
@@ -346,54 +594,528 @@ void NetworkManager::registerHttpHandlers() {
 // HTTP HANDLERS
 // ════════════════════════════════════════════════════════════════════════════
 
-// Declare webui extern (defined in securacv_webui library)
-extern const char CANARY_UI_HTML[];
+// Handlers run one at a time on the httpd task, so they share one chunk
+// buffer; JSON and CBOR responses of any size stream through it
+static char s_resp_chunk[HTTP_RESP_CHUNK_SIZE];
+
+// One health-log entry in the /api/logs shape (also used by /api/events)
+static void write_log_entry(JsonWriter& w, const HealthLogRingEntry& entry) {
+  char message[96], detail[96];
+  log_field_render(entry.message, message, sizeof(message));
+  log_field_render(entry.detail, detail, sizeof(detail));
+
+  w.beginObject();
+  w.field("seq", entry.seq);
+  w.field("timestamp_ms", entry.timestamp_ms);
+  w.field("level", (int)entry.level);
+  w.field("level_name", log_level_name(entry.level));
+  w.field("category", log_category_name(entry.category));
+  w.field("message", message);
+  if (detail[0]) {
+    w.field("detail", detail);
+  }
+  w.field("ack_status", ack_status_name(entry.ack_status));
+  w.endObject();
+}
+
+// Whether a request header's comma-separated list contains token as a
+// whole element. Parameters after ';' are ignored, except that q=0 marks
+// the element as refused ("gzip;q=0").
+static bool header_has_token(httpd_req_t* req, const char* field, const char* token) {
+  char value[128];
+  esp_err_t err = httpd_req_get_hdr_value_str(req, field, value, sizeof(value));
+  // A truncated value is still NUL-terminated; match against what fits
+  if (err != ESP_OK && err != ESP_ERR_HTTPD_RESULT_TRUNC) {
+    return false;
+  }
+
+  size_t token_len = strlen(token);
+  const char* p = value;
+  while (*p) {
+    while (*p == ' ' || *p == '\t' || *p == ',') p++;
+    const char* start = p;
+    while (*p && *p != ',' && *p != ';') p++;
+    const char* end = p;
+    while (end > start && (end[-1] == ' ' || end[-1] == '\t')) end--;
+
+    bool refused = false;
+    while (*p == ';') {
+      p++;
+      while (*p == ' ' || *p == '\t') p++;
+      if ((p[0] == 'q' || p[0] == 'Q') && p[1] == '=') {
+        const char* q = p + 2;
+        refused = *q == '0';
+        for (q++; refused && *q && *q != ',' && *q != ';' && *q != ' '; q++) {
+          refused = *q == '.' || *q == '0';
+        }
+      }
+      while (*p && *p != ',' && *p != ';') p++;
+    }
+
+    if (!refused && (size_t)(end - start) == token_len && memcmp(start, token, token_len) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
 
 static esp_err_t handle_ui(httpd_req_t* req) {
   witness_get_health().http_requests++;
+
+  // The UI only changes with a firmware image, so browsers revalidate
+  // cheaply against the ETag instead of re-downloading it
+  httpd_resp_set_hdr(req, "ETag", CANARY_UI_ETAG);
+  httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
+  httpd_resp_set_hdr(req, "Vary", "Accept-Encoding");
+
+  if (header_has_token(req, "If-None-Match", CANARY_UI_ETAG)) {
+    httpd_resp_set_status(req, "304 Not Modified");
+    return httpd_resp_send(req, nullptr, 0);
+  }
+
   httpd_resp_set_type(req, "text/html");
+  if (CANARY_UI_HTML_GZ_LEN > 0 && header_has_token(req, "Accept-Encoding", "gzip")) {
+    httpd_resp_set_hdr(req, "Content-Encoding", "gzip");
+    return httpd_resp_send(req, (const char*)CANARY_UI_HTML_GZ, CANARY_UI_HTML_GZ_LEN);
+  }
   return httpd_resp_send(req, CANARY_UI_HTML, HTTPD_RESP_USE_STRLEN);
 }
 
+// ════════════════════════════════════════════════════════════════════════════
+// STATUS CACHE
+// ════════════════════════════════════════════════════════════════════════════
+
+// /api/status is assembled from sections pre-rendered into fixed buffers.
+// Writers flag a section with witness_mark_status_dirty() and only those are
+// rendered again on the next request; uptime and free heap are always live.
+// A section that overflows its buffer is written straight to the response.
+
+static void status_section_identity(JsonWriter& w) {
+  DeviceIdentity& device = witness_get_device();
+  w.field("ok", true);
+  w.field("device_id", device.device_id);
+  w.field("device_type", DEVICE_TYPE);
+  w.field("firmware", FIRMWARE_VERSION);
+  w.field("ruleset", RULESET_ID);
+  w.fieldHex("fingerprint", device.pubkey_fp, 8);
+  w.fieldHex("pubkey", device.pubkey, 32);
+  w.field("boot_count", device.boot_count);
+}
+
+static void status_section_health(JsonWriter& w) {
+  SystemHealth& health = witness_get_health();
+  w.field("min_heap", health.min_heap);
+  w.field("crypto_healthy", health.crypto_healthy);
+  w.field("gps_healthy", health.gps_healthy);
+  w.field("sd_healthy", health.sd_healthy);
+  w.field("wifi_active", health.wifi_active);
+  w.field("cpu_duty_pct", health.cpu_duty_pct);
+  w.field("light_sleep", health.light_sleep);
+}
+
+static void status_section_logs(JsonWriter& w) {
+  SystemHealth& health = witness_get_health();
+  w.field("logs_stored", health.logs_stored);
+  w.field("unacked_count", health.logs_unacked);
+}
+
+static void status_section_chain(JsonWriter& w) {
+  DeviceIdentity& device = witness_get_device();
+  SystemHealth& health = witness_get_health();
+
+  w.field("chain_seq", device.seq);
+  w.field("witness_count", health.records_created);
+
+#if FEATURE_SD_STORAGE
+  // Counters are kept in RAM by the storage manager; no card access here
+  SDStatus sd = storage_get_instance().getStatus();
+  w.beginObject("storage");
+  w.field("mounted", sd.mounted);
+  w.field("bus", sd.bus == SD_BUS_SDMMC ? "sdmmc" : sd.bus == SD_BUS_SPI ? "spi" : "none");
+  w.field("records", sd.witness_count);
+  w.field("logs", sd.health_count);
+  w.field("free_bytes", sd.free_bytes);
+  w.field("write_amp_x100", sd.write_amp_x100);
+  w.field("pruned", sd.pruned_segments);
+  w.beginObject("scrub");
+  w.field("passes", sd.scrub_passes);
+  w.field("records", sd.scrub_records);
+  w.field("regions", sd.scrub_regions);
+  w.field("pending", sd.scrub_pending);
+  w.field("kb_s", sd.scrub_kb_s);
+  w.endObject();
+  w.endObject();
+#endif
+
+  w.beginObject("verify");
+  w.field("policy", verify_policy_name(witness_get_verify_policy()));
+  w.field("verified", health.records_verified);
+  w.field("skipped", health.verify_skipped);
+  w.field("pending", health.audit_pending);
+  w.field("overruns", health.audit_overruns);
+  w.field("failures", health.verify_failures);
+  w.endObject();
+
+#if FEATURE_CHAIN_JOURNAL
+  const JournalStats& js = journal_get_stats();
+  w.beginObject("journal");
+  w.field("active", journal_available());
+  w.field("appends", js.appends);
+  w.field("errors", js.append_errors);
+  w.field("erases", js.sector_erases);
+  w.field("capacity", js.capacity);
+  w.field("last_us", js.last_append_us);
+  w.field("max_us", js.max_append_us);
+  w.endObject();
+  w.field("chain_persists", health.chain_persists);
+#endif
+
+  w.beginObject("batch");
+  w.field("enabled", witness_get_batch_mode());
+  w.field("size", WITNESS_BATCH_SIZE);
+  w.field("sealed", health.batches_sealed);
+  w.field("pending", health.batch_pending);
+  w.field("seal_us", health.stage_seal_us);
+  w.endObject();
+
+  w.beginObject("signer");
+  w.field("running", witness_signer_running());
+  w.field("queue_depth", health.signer_queue_depth);
+  w.field("queue_peak", health.signer_queue_peak);
+  w.field("dropped", health.signer_dropped);
+  w.field("queue_us", health.stage_queue_us);
+  w.field("hash_us", health.stage_hash_us);
+  w.field("sign_us", health.stage_sign_us);
+  w.field("verify_us", health.stage_verify_us);
+  w.field("total_max_us", health.stage_total_max_us);
+  w.endObject();
+}
+
+static void status_section_crypto(JsonWriter& w) {
+  const CryptoBenchResult& cb = crypto_backend_bench();
+  w.beginObject("crypto");
+  w.field("sha256", crypto_backend_sha256().name);
+  w.field("aes_gcm", crypto_backend_gcm().name);
+  w.field("hw_accel", crypto_backend_get(CRYPTO_BACKEND_MBEDTLS).hw_accel);
+  w.field("benchmarked", cb.ran);
+  w.field("bench_bytes", cb.bench_bytes);
+  w.field("bench_rounds", cb.rounds);
+  w.field("sha256_sw_us", cb.sha256_us[CRYPTO_BACKEND_SOFTWARE]);
+  w.field("sha256_mbedtls_us", cb.sha256_us[CRYPTO_BACKEND_MBEDTLS]);
+  w.field("gcm_sw_us", cb.gcm_us[CRYPTO_BACKEND_SOFTWARE]);
+  w.field("gcm_mbedtls_us", cb.gcm_us[CRYPTO_BACKEND_MBEDTLS]);
+  w.field("gcm_agree", cb.gcm_agree);
+  w.endObject();
+}
+
+struct StatusSection {
+  uint32_t dirty_bit;
+  void (*render)(JsonWriter& w);
+  char* buf;
+  size_t cap;
+  size_t len;           // Rendered "{...}"; 0 if it did not fit
+};
+
+static char s_status_identity[384];
+static char s_status_health[128];
+static char s_status_logs[64];
+static char s_status_chain[768];
+static char s_status_crypto[384];
+
+// Response order; the live fields follow the first section
+static StatusSection s_status_sections[] = {
+  { STATUS_DIRTY_IDENTITY, status_section_identity, s_status_identity, sizeof(s_status_identity), 0 },
+  { STATUS_DIRTY_HEALTH,   status_section_health,   s_status_health,   sizeof(s_status_health),   0 },
+  { STATUS_DIRTY_LOGS,     status_section_logs,     s_status_logs,     sizeof(s_status_logs),     0 },
+  { STATUS_DIRTY_CHAIN,    status_section_chain,    s_status_chain,    sizeof(s_status_chain),    0 },
+  { STATUS_DIRTY_IDENTITY, status_section_crypto,   s_status_crypto,   sizeof(s_status_crypto),   0 },
+};
+
+// httpd task only. Bits are taken before rendering, so a change that lands
+// mid-render is picked up by the next request.
+static void status_cache_refresh() {
+  uint32_t dirty = witness_take_status_dirty();
+  for (StatusSection& sec : s_status_sections) {
+    if (!(dirty & sec.dirty_bit) && sec.len > 0) continue;
+
+    JsonWriter b(sec.buf, sec.cap);
+    b.beginObject();
+    sec.render(b);
+    b.endObject();
+    sec.len = b.finish() == ESP_OK ? b.length() : 0;
+  }
+}
+
+static void status_write_section(JsonWriter& w, const StatusSection& sec) {
+  if (sec.len >= 2) {
+    w.members(sec.buf + 1, sec.len - 2);   // Strip the braces
+  } else {
+    sec.render(w);
+  }
+}
+
 static esp_err_t handle_status(httpd_req_t* req) {
   witness_get_health().http_requests++;
 
+  status_cache_refresh();
+
+  JsonWriter w(req, s_resp_chunk, sizeof(s_resp_chunk));
+  w.beginObject();
+  status_write_section(w, s_status_sections[0]);
+  w.field("uptime_sec", uptime_seconds());
+  w.field("free_heap", ESP.getFreeHeap());
+  for (size_t i = 1; i < sizeof(s_status_sections) / sizeof(s_status_sections[0]); i++) {
+    status_write_section(w, s_status_sections[i]);
+  }
+  w.endObject();
+  return w.finish();
+}
+
+#if FEATURE_METRICS
+// ════════════════════════════════════════════════════════════════════════════
+// METRICS (/metrics)
+// ════════════════════════════════════════════════════════════════════════════
+
+// Existing SystemHealth counters are exported in place rather than copied
+static void metrics_register_system() {
   DeviceIdentity& device = witness_get_device();
   SystemHealth& health = witness_get_health();
 
-  StaticJsonDocument<1024> doc;
-  doc["ok"] = true;
-  doc["device_id"] = device.device_id;
-  doc["device_type"] = DEVICE_TYPE;
-  doc["firmware"] = FIRMWARE_VERSION;
-  doc["ruleset"] = RULESET_ID;
+  metrics_counter("securacv_http_requests_total", "HTTP requests handled", &health.http_requests);
+  metrics_counter("securacv_http_errors_total", "HTTP error responses", &health.http_errors);
+  metrics_counter("securacv_records_created_total", "Witness records chained", &health.records_created);
+  metrics_counter("securacv_verify_failures_total", "Record self-verification failures", &health.verify_failures);
+  metrics_counter("securacv_signer_dropped_total", "Records dropped by the signer queue", &health.signer_dropped);
+  metrics_counter("securacv_sd_writes_total", "Witness records appended to SD", &health.sd_writes);
+  metrics_counter("securacv_sd_errors_total", "Failed SD appends", &health.sd_errors);
+  metrics_counter("securacv_gps_sentences_total", "NMEA sentences parsed", &health.gps_sentences);
+  metrics_counter("securacv_gps_ubx_pvt_total", "UBX NAV-PVT frames parsed", &health.ubx_pvt_count);
+  metrics_counter("securacv_logs_stored_total", "Health log entries written", &health.logs_stored);
+
+  metrics_gauge("securacv_uptime_seconds", "Seconds since boot", uptime_seconds);
+  metrics_gauge("securacv_free_heap_bytes", "Free heap", []() -> uint32_t { return ESP.getFreeHeap(); });
+  metrics_gauge("securacv_min_heap_bytes", "Lowest free heap seen", &health.min_heap);
+  metrics_gauge("securacv_cpu_duty_percent", "Non-idle CPU share over the last window", &health.cpu_duty_pct);
+  metrics_gauge("securacv_chain_seq", "Current chain sequence", &device.seq);
+  metrics_gauge("securacv_signer_queue_depth", "Jobs waiting for the signer", &health.signer_queue_depth);
+  metrics_gauge("securacv_batch_pending", "Records awaiting a batch signature", &health.batch_pending);
+  metrics_gauge("securacv_logs_unacked", "Health log entries needing attention", &health.logs_unacked);
+
+  const WiFiStatus& wifi = network_get_instance().getStatus();
+  metrics_gauge("securacv_wifi_reconnect_ms", "Last STA connect, begin to link up", &wifi.reconnect_ms);
+  metrics_counter("securacv_wifi_fast_fallbacks_total", "Cached reconnects that fell back to a scan",
+                  &wifi.fast_fallbacks);
+}
+
+#endif
+
+#if FEATURE_METRICS || FEATURE_EVENT_TRACE
+// Chunked response sink for metrics_write() and trace_write_json()
+struct MetricsOut {
+  httpd_req_t* req;
+  size_t len;
+  bool failed;
+};
+
+// Lines are shorter than the chunk buffer, so a line never splits a flush.
+// Once a send fails the remaining lines are dropped.
+static void metrics_emit(const char* text, size_t len, void* ctx) {
+  MetricsOut* out = (MetricsOut*)ctx;
+  if (out->failed) return;
+  if (out->len + len > sizeof(s_resp_chunk)) {
+    if (httpd_resp_send_chunk(out->req, s_resp_chunk, out->len) != ESP_OK) {
+      out->failed = true;
+      return;
+    }
+    out->len = 0;
+  }
+  memcpy(s_resp_chunk + out->len, text, len);
+  out->len += len;
+}
+
+// Flush what is buffered and end the chunked response
+static esp_err_t metrics_out_finish(MetricsOut& out) {
+  if (out.failed) return ESP_FAIL;
+  if (out.len > 0 && httpd_resp_send_chunk(out.req, s_resp_chunk, out.len) != ESP_OK) return ESP_FAIL;
+  return httpd_resp_send_chunk(out.req, nullptr, 0);
+}
+#endif
+
+#if FEATURE_METRICS
+static esp_err_t handle_metrics(httpd_req_t* req) {
+  witness_get_health().http_requests++;
+
+  httpd_resp_set_type(req, "text/plain; version=0.0.4");
+  httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
 
-  char fp_hex[17];
-  hex_to_str(fp_hex, device.pubkey_fp, 8);
-  doc["fingerprint"] = fp_hex;
+  MetricsOut out = { req, 0, false };
+  metrics_write(metrics_emit, &out);
+  return metrics_out_finish(out);
+}
+#endif
 
-  char pubkey_hex[65];
-  hex_to_str(pubkey_hex, device.pubkey, 32);
-  doc["pubkey"] = pubkey_hex;
+#if FEATURE_PERF_PROFILER
+// Profiler scopes since boot or the last serial 'p' (which resets them)
+static esp_err_t handle_perf(httpd_req_t* req) {
+  witness_get_health().http_requests++;
 
-  doc["uptime_sec"] = uptime_seconds();
-  doc["boot_count"] = device.boot_count;
-  doc["chain_seq"] = device.seq;
-  doc["witness_count"] = health.records_created;
-  doc["free_heap"] = ESP.getFreeHeap();
-  doc["min_heap"] = health.min_heap;
+  JsonWriter w(req, s_resp_chunk, sizeof(s_resp_chunk));
+  w.beginObject();
+  w.field("ok", true);
+  w.beginArray("scopes");
+  PerfStats ps;
+  for (size_t i = 0; perf_get(i, &ps); i++) {
+    w.beginObject();
+    w.field("name", ps.name);
+    w.field("count", ps.count);
+    w.field("min_us", ps.min_us);
+    w.field("avg_us", ps.avg_us);
+    w.field("max_us", ps.max_us);
+    w.field("p99_us", ps.p99_us);
+    w.endObject();
+  }
+  w.endArray();
+  w.endObject();
+  return w.finish();
+}
+#endif
 
-  doc["crypto_healthy"] = health.crypto_healthy;
-  doc["gps_healthy"] = health.gps_healthy;
-  doc["sd_healthy"] = health.sd_healthy;
-  doc["wifi_active"] = health.wifi_active;
+#if FEATURE_BENCH
+static const char* bench_state_name(BenchState s) {
+  switch (s) {
+    case BENCH_RUNNING: return "running";
+    case BENCH_DONE:    return "done";
+    default:            return "idle";
+  }
+}
 
-  doc["logs_stored"] = health.logs_stored;
-  doc["unacked_count"] = health.logs_unacked;
+// Progress and results of the current or last run
+static esp_err_t handle_bench(httpd_req_t* req) {
+  witness_get_health().http_requests++;
 
-  String response;
-  serializeJson(doc, response);
-  return http_send_json(req, response.c_str());
+  JsonWriter w(req, s_resp_chunk, sizeof(s_resp_chunk));
+  w.beginObject();
+  w.field("ok", true);
+  w.field("state", bench_state_name(bench_state()));
+  BenchResult r;
+  w.beginArray("results");
+  for (size_t i = 0; bench_get(i, &r); i++) {
+    w.beginObject();
+    w.field("name", r.name);
+    w.field("ran", r.ran);
+    w.field("running", bench_current() == (BenchCase)i);
+    if (r.ran) {
+      w.field("ops", r.ops);
+      w.field("bytes_per_op", r.bytes_per_op);
+      w.field("avg_us", r.avg_us);
+      w.field("min_us", r.min_us);
+      w.field("max_us", r.max_us);
+      w.field("bytes_per_s", r.bytes_per_s);
+    }
+    w.endObject();
+  }
+  w.endArray();
+  w.endObject();
+  return w.finish();
+}
+
+// Starts a run on the bench task; poll GET /api/bench for the outcome
+static esp_err_t handle_bench_start(httpd_req_t* req) {
+  witness_get_health().http_requests++;
+
+  if (!bench_start()) return http_send_error(req, 503, "bench_busy");
+  httpd_resp_set_status(req, "202 Accepted");
+  return http_send_json(req, "{\"ok\":true,\"state\":\"running\"}");
+}
+#endif
+
+// Query parameter value; false if absent or longer than cap
+static bool query_str(httpd_req_t* req, const char* key, char* out, size_t cap) {
+  return http_query_param(req, key).copy(out, cap);
+}
+
+// Unsigned integer query parameter, or def if absent
+static uint32_t query_u32(httpd_req_t* req, const char* key, uint32_t def) {
+  return http_query_param(req, key).toU32(def);
+}
+
+#if FEATURE_EVENT_TRACE
+// The trace ring as Chrome Trace Event JSON (chrome://tracing, ui.perfetto.dev)
+static esp_err_t handle_trace(httpd_req_t* req) {
+  witness_get_health().http_requests++;
+
+  httpd_resp_set_type(req, "application/json");
+  httpd_resp_set_hdr(req, "Content-Disposition", "attachment; filename=\"canary-trace.json\"");
+  httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
+
+  MetricsOut out = { req, 0, false };
+  trace_write_json(metrics_emit, &out);
+  return metrics_out_finish(out);
+}
+
+// ?on=1 clears the ring and starts recording, ?on=0 stops it
+static esp_err_t handle_trace_control(httpd_req_t* req) {
+  witness_get_health().http_requests++;
+
+  uint32_t on = query_u32(req, "on", UINT32_MAX);
+  if (on > 1) {
+    return http_send_error(req, 400, "invalid_on");
+  }
+  trace_set_enabled(on == 1);
+
+  char response[96];
+  snprintf(response, sizeof(response), "{\"ok\":true,\"enabled\":%s,\"events\":%u,\"overwritten\":%lu}",
+           trace_is_enabled() ? "true" : "false", (unsigned)trace_event_count(),
+           (unsigned long)trace_overwritten());
+  return http_send_json(req, response);
+}
+#endif
+
+// Copy a flat CBOR payload map into JSON. Scalars only; nested items are
+// skipped, and strings are read in place from the payload buffer.
+static void cbor_payload_to_json(const uint8_t* payload, size_t len, JsonWriter& w) {
+  w.beginObject("payload");
+
+  cbor_reader_t r;
+  cbor_item_t map;
+  cbor_reader_init(&r, payload, len);
+  if (!cbor_next(&r, &map) || map.type != CBOR_ITEM_MAP || map.indefinite) {
+    w.endObject();
+    return;
+  }
+
+  char key[24];
+  for (uint64_t i = 0; i < map.v.count; i++) {
+    cbor_item_t k, v;
+    if (!cbor_next(&r, &k) || !cbor_next(&r, &v)) break;
+    if (k.type != CBOR_ITEM_TSTR || k.indefinite || k.len >= sizeof(key)) {
+      if (!cbor_skip(&r, &k) || !cbor_skip(&r, &v)) break;
+      continue;
+    }
+    memcpy(key, k.data, k.len);
+    key[k.len] = '\0';
+
+    switch (v.type) {
+      case CBOR_ITEM_UINT:  w.field(key, v.v.uint); break;
+      case CBOR_ITEM_NINT:  w.field(key, v.v.sint); break;
+      case CBOR_ITEM_FLOAT: w.field(key, v.v.flt); break;
+      case CBOR_ITEM_BOOL:  w.field(key, v.v.boolean); break;
+      case CBOR_ITEM_NULL:  w.key(key).null(); break;
+      case CBOR_ITEM_TSTR:
+        if (!v.indefinite) {
+          w.key(key).str((const char*)v.data, v.len);
+          break;
+        }
+        // fall through
+      default:
+        if (!cbor_skip(&r, &v)) {
+          w.endObject();
+          return;
+        }
+        break;
+    }
+  }
+  w.endObject();
 }
 
 static esp_err_t handle_chain(httpd_req_t* req) {
@@ -402,133 +1124,594 @@ static esp_err_t handle_chain(httpd_req_t* req) {
   DeviceIdentity& device = witness_get_device();
   WitnessRecord& last = witness_get_last_record();
 
-  StaticJsonDocument<512> doc;
-  doc["ok"] = true;
+#if FEATURE_SD_STORAGE
+  // ?seq=N: one stored record with its payload decoded
+  uint32_t seq = query_u32(req, "seq", 0);
+  if (seq > 0) {
+    if (!storage_is_mounted()) {
+      return http_send_error(req, 500, "storage_unavailable");
+    }
+    WitnessLogHeader hdr;
+    uint8_t payload[WITNESS_MAX_PAYLOAD];
+    if (!storage_get_instance().readWitness(seq, &hdr, payload, sizeof(payload))) {
+      return http_send_error(req, 404, "not_found");
+    }
+
+    JsonWriter w(req, s_resp_chunk, sizeof(s_resp_chunk));
+    w.beginObject();
+    w.field("ok", true);
+    w.field("seq", hdr.seq);
+    w.field("time_bucket", hdr.time_bucket);
+    w.field("type", record_type_name((RecordType)hdr.record_type));
+    w.fieldHex("hash", hdr.chain_hash, 32);
+    w.field("batched", (hdr.flags & WITNESS_LOG_FLAG_BATCHED) != 0);
+    cbor_payload_to_json(payload, hdr.payload_len, w);
+    w.endObject();
+    return w.finish();
+  }
+#endif
+
+  JsonWriter w(req, s_resp_chunk, sizeof(s_resp_chunk));
+  w.beginObject();
+  w.field("ok", true);
+  w.fieldHex("chain_head", device.chain_head, 32);
+  w.field("sequence", device.seq);
 
-  char chain_hex[65];
-  hex_to_str(chain_hex, device.chain_head, 32);
-  doc["chain_head"] = chain_hex;
-  doc["sequence"] = device.seq;
+  // Latest signed checkpoint and the boot check that started from one
+  SystemHealth& health = witness_get_health();
+  w.beginObject("checkpoint");
+  w.field("seq", device.checkpoint_seq);
+  w.field("interval", (uint32_t)WITNESS_CHECKPOINT_INTERVAL);
+  if (health.boot_check_done) {
+    w.beginObject("boot_check");
+    w.field("ok", health.boot_check_ok);
+    w.field("from_checkpoint", health.boot_check_from);
+    w.field("records", health.boot_check_records);
+    w.field("elapsed_ms", health.boot_check_ms);
+    w.endObject();
+  }
+  w.endObject();
 
   if (last.seq > 0) {
-    JsonArray blocks = doc.createNestedArray("blocks");
-    JsonObject block = blocks.createNestedObject();
-    char hash[65];
-    hex_to_str(hash, last.chain_hash, 32);
-    block["seq"] = last.seq;
-    block["hash"] = hash;
-    block["type"] = record_type_name(last.type);
-    block["verified"] = last.verified;
+    w.beginArray("blocks");
+    w.beginObject();
+    w.field("seq", last.seq);
+    w.fieldHex("hash", last.chain_hash, 32);
+    w.field("type", record_type_name(last.type));
+    w.field("verified", last.verified);
+
+    // Batched records export their inclusion proof against the signed root
+    if (last.batched) {
+      w.fieldHex("sig", last.signature, 64);
+      w.beginObject("batch");
+      w.fieldHex("root", last.merkle_root, 32);
+      w.field("first_seq", last.batch_first_seq);
+      w.field("size", last.batch_size);
+      w.field("index", last.leaf_index);
+      w.beginArray("proof");
+      for (uint8_t i = 0; i < last.proof_len; i++) {
+        w.hex(last.proof[i], 32);
+      }
+      w.endArray();
+      w.endObject();
+    }
+    w.endObject();
+    w.endArray();
   }
 
-  String response;
-  serializeJson(doc, response);
-  return http_send_json(req, response.c_str());
+  w.endObject();
+  return w.finish();
 }
 
-static esp_err_t handle_logs(httpd_req_t* req) {
+#if FEATURE_SD_STORAGE
+// Each record costs an SD read and an Ed25519 check, so a full-limit run
+// takes seconds: it runs on an HTTP worker, which writes the response.
+// The job slot hands the query to the worker; one request is in flight
+// until the worker has taken it.
+struct ChainVerifyJob {
+  uint32_t from;
+  uint32_t to;
+  uint32_t limit;
+};
+
+static ChainVerifyJob s_verify_job;
+static std::atomic<bool> s_verify_busy{false};
+
+static void chain_verify_worker(int fd, void* arg) {
+  ChainVerifyJob job = *(ChainVerifyJob*)arg;
+  s_verify_busy.store(false, std::memory_order_release);
+  if (fd < 0) return;
+
+  // from=0: start at the latest checkpoint (to is ignored)
+  WitnessRangeReport report;
+  uint32_t checkpoint = 0;
+  bool ran = job.from == 0 ? storage_verify_from_checkpoint(job.limit, &report, &checkpoint)
+                           : storage_verify_witness_range(job.from, job.to, job.limit, &report);
+  if (!ran) {
+    static const char BODY[] = "{\"ok\":false,\"error\":\"storage_unavailable\"}";
+    if (http_worker_send_head(fd, "500 Internal Server Error", "application/json")) {
+      http_worker_send(fd, BODY, sizeof(BODY) - 1);
+    }
+    return;
+  }
+
+  char body[512];
+  JsonWriter w(body, sizeof(body));
+  w.beginObject();
+  w.field("ok", report.chain_failures == 0 && report.sig_failures == 0);
+  w.field("from", report.start_seq);
+  w.field("to", report.end_seq);
+  w.field("records", report.records);
+  w.field("sig_checks", report.sig_checks);
+  w.field("chain_failures", report.chain_failures);
+  w.field("sig_failures", report.sig_failures);
+  w.field("unverified", report.unverified);
+  w.field("gaps", report.gaps);
+  w.field("anchored", report.anchored);
+  if (checkpoint) w.field("checkpoint", checkpoint);
+  if (report.first_bad_seq) w.field("first_bad_seq", report.first_bad_seq);
+  w.field("elapsed_ms", report.elapsed_ms);
+  w.field("records_per_sec", report.records_per_sec);
+  if (report.records >= job.limit) w.field("next", report.end_seq + 1);
+  w.endObject();
+  if (w.finish() != ESP_OK) return;
+
+  if (http_worker_send_head(fd, "200 OK", "application/json")) {
+    http_worker_send(fd, body, w.length());
+  }
+}
+
+static esp_err_t handle_chain_verify(httpd_req_t* req) {
   witness_get_health().http_requests++;
 
-  HealthLogRingEntry* ring = witness_get_health_log_ring();
-  size_t count = witness_get_health_log_count();
-  size_t head = witness_get_health_log_head();
-
-  DynamicJsonDocument doc(4096);
-  doc["ok"] = true;
-  doc["total"] = count;
-
-  JsonArray logs = doc.createNestedArray("logs");
-
-  for (size_t i = 0; i < count; i++) {
-    size_t idx = (head + 100 - 1 - i) % 100;
-    HealthLogRingEntry& entry = ring[idx];
-
-    JsonObject log = logs.createNestedObject();
-    log["seq"] = entry.seq;
-    log["timestamp_ms"] = entry.timestamp_ms;
-    log["level"] = (int)entry.level;
-    log["level_name"] = log_level_name(entry.level);
-    log["category"] = log_category_name(entry.category);
-    log["message"] = entry.message;
-    if (entry.detail[0]) {
-      log["detail"] = entry.detail;
+  uint32_t from = query_u32(req, "from", 1);
+  uint32_t to = query_u32(req, "to", 0);
+  uint32_t limit = query_u32(req, "limit", CHAIN_VERIFY_DEFAULT_LIMIT);
+  if (limit == 0 || limit > CHAIN_VERIFY_MAX_LIMIT) limit = CHAIN_VERIFY_MAX_LIMIT;
+
+  if (!storage_is_mounted()) {
+    return http_send_error(req, 500, "storage_unavailable");
+  }
+  if (s_verify_busy.exchange(true, std::memory_order_acq_rel)) {
+    return http_send_error(req, 503, "verify_busy");
+  }
+
+  s_verify_job = { from, to, limit };
+  if (http_worker_detach(req, chain_verify_worker, &s_verify_job) != ESP_OK) {
+    s_verify_busy.store(false, std::memory_order_release);
+    return http_send_error(req, 503, "workers_busy");
+  }
+  return ESP_OK;
+}
+
+// ─── /api/chain/records: RFC 8742 CBOR sequence ───────────────────────────
+//
+// Items, each a definite-length map:
+//   1. descriptor  {"stream":"witness","device_id","pubkey","from","to"}
+//   2. one per stored record {"seq","hash","sig","type","flags",
+//      "time_bucket",["batch_size","leaf_index"],"payload": 24(bstr)}
+//   3. trailer     {"records":N,"complete":bool[,"next":seq]}
+// The payload is embedded as tag 24 (encoded CBOR data item), exactly as
+// stored, so signatures can be checked without re-encoding. Records are
+// encoded from the storage callback into the worker's chunk buffer, which
+// is flushed to the socket as it fills.
+//
+// This and /api/export read the whole range off the card, so both run on
+// an HTTP worker. The body is not chunked; it ends when the worker closes
+// the connection.
+
+struct ChainExport {
+  int fd;
+  uint8_t* buf;         // Worker-owned; s_resp_chunk belongs to httpd
+  size_t cap;
+  size_t len;           // Bytes pending in buf
+  uint32_t records;
+  uint32_t last_seq;
+  bool failed;
+  mbedtls_sha256_context* sha;   // Hashes every byte sent, if set
+};
+
+// Query of a queued export, handed over like a /api/chain/verify job
+struct ChainExportJob {
+  uint32_t from;
+  uint32_t to;
+  uint32_t limit;
+  bool logs;
+};
+
+static ChainExportJob s_export_job;
+static std::atomic<bool> s_export_busy{false};
+
+static esp_err_t chain_export_queue(httpd_req_t* req, HttpWorkerFn fn, const ChainExportJob& job) {
+  if (s_export_busy.exchange(true, std::memory_order_acq_rel)) {
+    return http_send_error(req, 503, "export_busy");
+  }
+  s_export_job = job;
+  if (http_worker_detach(req, fn, &s_export_job) != ESP_OK) {
+    s_export_busy.store(false, std::memory_order_release);
+    return http_send_error(req, 503, "workers_busy");
+  }
+  return ESP_OK;
+}
+
+static ChainExportJob chain_export_take(void* arg) {
+  ChainExportJob job = *(ChainExportJob*)arg;
+  s_export_busy.store(false, std::memory_order_release);
+  return job;
+}
+
+static bool chain_export_flush(ChainExport& ex) {
+  if (ex.len > 0 && !http_worker_send(ex.fd, ex.buf, ex.len)) {
+    ex.failed = true;
+    return false;
+  }
+  if (ex.sha && ex.len > 0) mbedtls_sha256_update(ex.sha, ex.buf, ex.len);
+  ex.len = 0;
+  return true;
+}
+
+// Encode one item at the buffer tail, flushing first if it does not fit
+template <typename Encode>
+static bool chain_export_item(ChainExport& ex, Encode encode) {
+  for (int attempt = 0; attempt < 2; attempt++) {
+    CborWriter w(ex.buf + ex.len, ex.cap - ex.len);
+    encode(w);
+    if (w.ok()) {
+      ex.len += w.size();
+      return true;
     }
-    log["ack_status"] = ack_status_name(entry.ack_status);
+    if (ex.len == 0 || !chain_export_flush(ex)) break;
   }
+  ex.failed = true;     // Larger than the whole buffer, or the socket closed
+  return false;
+}
 
-  String response;
-  serializeJson(doc, response);
-  return http_send_json(req, response.c_str());
+static bool chain_export_record(const WitnessLogHeader& hdr, const uint8_t* payload, void* ctx) {
+  ChainExport& ex = *(ChainExport*)ctx;
+  bool batched = (hdr.flags & WITNESS_LOG_FLAG_BATCHED) != 0;
+  bool ok = chain_export_item(ex, [&](CborWriter& w) {
+    w.map(batched ? 9 : 7);
+    w.key("seq").uint(hdr.seq);
+    w.key("hash").bytes(hdr.chain_hash, 32);
+    w.key("sig").bytes(hdr.signature, 64);
+    w.key("type").uint(hdr.record_type);
+    w.key("flags").uint(hdr.flags);
+    w.key("time_bucket").uint(hdr.time_bucket);
+    if (batched) {
+      w.key("batch_size").uint(hdr.batch_size);
+      w.key("leaf_index").uint(hdr.leaf_index);
+    }
+    w.key("payload").tag(24).bytes(payload, hdr.payload_len);
+  });
+  if (!ok) return false;
+  ex.records++;
+  ex.last_seq = hdr.seq;
+  return true;
 }
 
-static esp_err_t handle_log_ack(httpd_req_t* req) {
+static void chain_records_worker(int fd, void* arg) {
+  ChainExportJob job = chain_export_take(arg);
+  if (fd < 0) return;
+  if (!http_worker_send_head(fd, "200 OK", "application/cbor-seq")) return;
+
+  uint8_t chunk[HTTP_RESP_CHUNK_SIZE];
+  DeviceIdentity& device = witness_get_device();
+  ChainExport ex = { fd, chunk, sizeof(chunk), 0, 0, 0, false, nullptr };
+
+  chain_export_item(ex, [&](CborWriter& w) {
+    w.map(5);
+    w.key("stream").str("witness");
+    w.key("device_id").str(device.device_id);
+    w.key("pubkey").bytes(device.pubkey, 32);
+    w.key("from").uint(job.from);
+    w.key("to").uint(job.to);
+  });
+
+  if (!ex.failed) {
+    storage_get_instance().exportWitness(job.from, job.to, chain_export_record, &ex, job.limit);
+  }
+
+  // A client that sees no trailer knows the stream was cut short
+  bool truncated = job.limit && ex.records >= job.limit;
+  bool complete = !ex.failed && !truncated;
+  if (!ex.failed) {
+    chain_export_item(ex, [&](CborWriter& w) {
+      w.map(truncated ? 3 : 2);
+      w.key("records").uint(ex.records);
+      w.key("complete").boolean(complete);
+      if (truncated) w.key("next").uint(ex.last_seq + 1);
+    });
+  }
+  if (!ex.failed) chain_export_flush(ex);
+}
+
+static esp_err_t handle_chain_records(httpd_req_t* req) {
   witness_get_health().http_requests++;
 
-  const char* uri = req->uri;
-  const char* seq_start = strstr(uri, "/logs/");
-  if (!seq_start) {
-    return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid URI");
+  if (!storage_is_mounted()) {
+    return http_send_error(req, 500, "storage_unavailable");
   }
-  seq_start += 6;
-  uint32_t seq = atoi(seq_start);
 
-  bool success = acknowledge_log_entry(seq, ACK_STATUS_ACKNOWLEDGED, "");
+  uint32_t from = query_u32(req, "from", 1);
+  uint32_t to = query_u32(req, "to", 0);
+  uint32_t limit = query_u32(req, "limit", 0);
+  if (from == 0) from = 1;
+  if (to != 0 && to < from) {
+    return http_send_error(req, 400, "invalid_range");
+  }
+
+  return chain_export_queue(req, chain_records_worker, { from, to, limit, false });
+}
+
+// ─── /api/export: evidence bundle, RFC 8742 CBOR sequence ─────────────────
+//
+// Assembled straight into the response, so nothing is staged on the card
+// and the download starts at once. Items:
+//   1. manifest  {"stream":"bundle","version","device_id","pubkey",
+//                 "firmware","ruleset","from","to"}
+//   2. chain     {"stream":"chain","seq","head","boot_count","tamper_count"}
+//   3. {"stream":"witness"}, then one item per record as /api/chain/records
+//   4. {"stream":"logs"}, then one item per persisted health log entry
+//      {"seq","ts","level","cat","msg"[,"detail"]}
+//   5. trailer   {"records","logs","complete","sha256"}
+// sha256 covers every byte before the trailer, hashed as it is sent.
+
+#define EXPORT_BUNDLE_VERSION  1
+
+static bool export_log_record(const HealthLogRecord& rec, void* ctx) {
+  ChainExport& ex = *(ChainExport*)ctx;
+  size_t msg_len = rec.msg_len < sizeof(rec.text) ? rec.msg_len : sizeof(rec.text);
+  size_t detail_len = rec.detail_len < sizeof(rec.text) - msg_len ? rec.detail_len
+                                                                  : sizeof(rec.text) - msg_len;
+  return chain_export_item(ex, [&](CborWriter& w) {
+    w.map(detail_len ? 6 : 5);
+    w.key("seq").uint(rec.seq);
+    w.key("ts").uint(rec.timestamp_ms);
+    w.key("level").uint(rec.level);
+    w.key("cat").uint(rec.category);
+    w.key("msg").str(rec.text, msg_len);
+    if (detail_len) w.key("detail").str(rec.text + msg_len, detail_len);
+  });
+}
 
-  StaticJsonDocument<128> doc;
-  doc["ok"] = success;
-  if (!success) {
-    doc["error"] = "Log entry not found";
+static void export_worker(int fd, void* arg) {
+  ChainExportJob job = chain_export_take(arg);
+  if (fd < 0) return;
+
+  DeviceIdentity& device = witness_get_device();
+  char disposition[112];
+  snprintf(disposition, sizeof(disposition),
+           "Content-Disposition: attachment; filename=\"%s-export.cbor\"\r\n", device.device_id);
+  if (!http_worker_send_head(fd, "200 OK", "application/cbor-seq", disposition)) return;
+
+  uint8_t chunk[HTTP_RESP_CHUNK_SIZE];
+  mbedtls_sha256_context sha;
+  mbedtls_sha256_init(&sha);
+  mbedtls_sha256_starts(&sha, 0);
+  ChainExport ex = { fd, chunk, sizeof(chunk), 0, 0, 0, false, &sha };
+
+  chain_export_item(ex, [&](CborWriter& w) {
+    w.map(8);
+    w.key("stream").str("bundle");
+    w.key("version").uint(EXPORT_BUNDLE_VERSION);
+    w.key("device_id").str(device.device_id);
+    w.key("pubkey").bytes(device.pubkey, 32);
+    w.key("firmware").str(FIRMWARE_VERSION);
+    w.key("ruleset").str(RULESET_ID);
+    w.key("from").uint(job.from);
+    w.key("to").uint(job.to);
+  });
+  chain_export_item(ex, [&](CborWriter& w) {
+    w.map(5);
+    w.key("stream").str("chain");
+    w.key("seq").uint(device.seq);
+    w.key("head").bytes(device.chain_head, 32);
+    w.key("boot_count").uint(device.boot_count);
+    w.key("tamper_count").uint(device.tamper_count);
+  });
+
+  chain_export_item(ex, [&](CborWriter& w) {
+    w.map(1);
+    w.key("stream").str("witness");
+  });
+  if (!ex.failed) {
+    storage_get_instance().exportWitness(job.from, job.to, chain_export_record, &ex);
+  }
+
+  uint32_t log_count = 0;
+  if (job.logs && !ex.failed) {
+    chain_export_item(ex, [&](CborWriter& w) {
+      w.map(1);
+      w.key("stream").str("logs");
+    });
+    if (!ex.failed) log_count = storage_get_instance().exportHealth(export_log_record, &ex);
   }
 
-  String response;
-  serializeJson(doc, response);
-  return http_send_json(req, response.c_str());
+  // Everything so far goes out (and into the hash) before the trailer
+  uint8_t digest[32];
+  bool sent = !ex.failed && chain_export_flush(ex);
+  ex.sha = nullptr;
+  mbedtls_sha256_finish(&sha, digest);
+  mbedtls_sha256_free(&sha);
+
+  if (sent) {
+    chain_export_item(ex, [&](CborWriter& w) {
+      w.map(4);
+      w.key("records").uint(ex.records);
+      w.key("logs").uint(log_count);
+      w.key("complete").boolean(true);
+      w.key("sha256").bytes(digest, 32);
+    });
+  }
+
+  if (!sent || ex.failed || !chain_export_flush(ex)) return;
+  log_health(LOG_LEVEL_INFO, LOG_CAT_USER, LOG_MSG_EXPORT_SENT, LogArg::seq(ex.records));
 }
 
-static esp_err_t handle_ack_all(httpd_req_t* req) {
+static esp_err_t handle_export(httpd_req_t* req) {
+  witness_get_health().http_requests++;
+
+  if (!storage_is_mounted()) {
+    return http_send_error(req, 500, "storage_unavailable");
+  }
+
+  uint32_t from = query_u32(req, "from", 1);
+  uint32_t to = query_u32(req, "to", 0);
+  bool logs = query_u32(req, "logs", 1) != 0;
+  if (from == 0) from = 1;
+  if (to != 0 && to < from) {
+    return http_send_error(req, 400, "invalid_range");
+  }
+
+  return chain_export_queue(req, export_worker, { from, to, 0, logs });
+}
+#endif
+
+// Level filter: numeric or a log_level_name() ("WARN"), minimum severity
+static bool parse_log_level(const char* s, uint8_t* out) {
+  if (isdigit((unsigned char)s[0])) {
+    *out = (uint8_t)atoi(s);
+    return true;
+  }
+  for (uint8_t l = LOG_LEVEL_DEBUG; l <= LOG_LEVEL_TAMPER; l++) {
+    if (strcasecmp(s, log_level_name((LogLevel)l)) == 0) {
+      *out = l;
+      return true;
+    }
+  }
+  return false;
+}
+
+static bool parse_log_category(const char* s, uint8_t* out) {
+  for (uint8_t c = LOG_CAT_SYSTEM; c <= LOG_CAT_BLUETOOTH; c++) {
+    if (strcasecmp(s, log_category_name((LogCategory)c)) == 0) {
+      *out = c;
+      return true;
+    }
+  }
+  return false;
+}
+
+// GET /api/logs[?since=S|before=B][&limit=N][&level=L][&category=C][&unacked=true]
+//
+// Without a cursor (or with before=B) entries come newest first and
+// "next_before" pages further back. With since=S only entries after S are
+// returned, oldest first, and "next_since" continues the cursor. Entries
+// are copied out of the ring one at a time under its lock and streamed,
+// never materialized as a page.
+static esp_err_t handle_logs(httpd_req_t* req) {
   witness_get_health().http_requests++;
 
-  HealthLogRingEntry* ring = witness_get_health_log_ring();
   size_t count = witness_get_health_log_count();
+  size_t cap = witness_get_health_log_capacity();
+  uint32_t newest = witness_get_health_log_newest_seq();
+
+  uint32_t since = query_u32(req, "since", 0);
+  uint32_t before = query_u32(req, "before", 0);
+  uint32_t limit = query_u32(req, "limit", cap);
+  if (limit == 0 || limit > cap) limit = cap;
+
+  char val[16];
+  bool by_level = false, by_category = false;
+  uint8_t min_level = 0, category = 0;
+  if (query_str(req, "level", val, sizeof(val))) {
+    if (!parse_log_level(val, &min_level)) return http_send_error(req, 400, "invalid_level");
+    by_level = true;
+  }
+  if (query_str(req, "category", val, sizeof(val))) {
+    if (!parse_log_category(val, &category)) return http_send_error(req, 400, "invalid_category");
+    by_category = true;
+  }
+  bool unacked_only = http_query_param(req, "unacked").equals("true");
+
+  JsonWriter w(req, s_resp_chunk, sizeof(s_resp_chunk));
+  w.beginObject();
+  w.field("ok", true);
+  w.field("total", count);
+  if (count > 0) {
+    w.field("newest_seq", newest);
+  }
 
-  uint32_t acked = 0;
-  for (size_t i = 0; i < count; i++) {
-    if (ring[i].ack_status == ACK_STATUS_UNREAD) {
-      ring[i].ack_status = ACK_STATUS_ACKNOWLEDGED;
-      acked++;
+  // Cursors seek straight to their seq, and the level/category/unacked
+  // indexes skip non-matching entries a bitmap word at a time
+  HealthLogFilter filter = { LOG_LEVEL_DEBUG, 0, unacked_only };
+  if (by_level) filter.min_level = (LogLevel)min_level;
+  if (by_category) filter.categories = (uint16_t)(1u << category);
+
+  bool forward = since > 0;
+  uint32_t returned = 0;
+  uint32_t last_seq = 0;
+  bool more = false;
+
+  w.beginArray("logs");
+  HealthLogRingEntry entry;
+  bool found = forward ? witness_health_log_next(filter, since, &entry)
+                       : witness_health_log_prev(filter, before, &entry);
+  while (found) {
+    if (returned == limit) {
+      more = true;
+      break;
     }
+    write_log_entry(w, entry);
+    last_seq = entry.seq;
+    returned++;
+    found = forward ? witness_health_log_next(filter, last_seq, &entry)
+                    : witness_health_log_prev(filter, last_seq, &entry);
+  }
+  w.endArray();
+
+  w.field("returned", returned);
+  if (forward) {
+    w.field("next_since", returned > 0 ? last_seq : since);
+  } else if (more) {
+    w.field("next_before", last_seq);
+  }
+  w.field("more", more);
+
+  w.endObject();
+  return w.finish();
+}
+
+static esp_err_t handle_log_ack(httpd_req_t* req) {
+  witness_get_health().http_requests++;
+
+  uint32_t seq;
+  if (!http_path_param(req, "seq").parseU32(&seq)) {
+    return http_send_error(req, 400, "invalid_seq");
   }
-  witness_get_health().logs_unacked = 0;
 
-  log_health(LOG_LEVEL_INFO, LOG_CAT_USER, "Bulk acknowledgment", nullptr);
+  bool success = acknowledge_log_entry(seq, ACK_STATUS_ACKNOWLEDGED, "");
+
+  return http_send_json(req, success ? "{\"ok\":true}"
+                                     : "{\"ok\":false,\"error\":\"Log entry not found\"}");
+}
+
+static esp_err_t handle_ack_all(httpd_req_t* req) {
+  witness_get_health().http_requests++;
+
+  size_t acked = acknowledge_all_log_entries(ACK_STATUS_ACKNOWLEDGED);
 
-  StaticJsonDocument<128> doc;
-  doc["ok"] = true;
-  doc["acknowledged"] = acked;
+  log_health(LOG_LEVEL_INFO, LOG_CAT_USER, LOG_MSG_BULK_ACK);
 
-  String response;
-  serializeJson(doc, response);
-  return http_send_json(req, response.c_str());
+  char response[48];
+  snprintf(response, sizeof(response), "{\"ok\":true,\"acknowledged\":%u}", (unsigned)acked);
+  return http_send_json(req, response);
 }
 
 static esp_err_t handle_reboot(httpd_req_t* req) {
   witness_get_health().http_requests++;
 
-  log_health(LOG_LEVEL_NOTICE, LOG_CAT_USER, "Reboot requested", nullptr);
+  log_health(LOG_LEVEL_NOTICE, LOG_CAT_USER, LOG_MSG_REBOOT_REQUESTED);
 
   DeviceIdentity& device = witness_get_device();
-  nvs_store_u32(NVS_KEY_SEQ, device.seq);
-  nvs_store_bytes(NVS_KEY_CHAIN, device.chain_head, 32);
-
-  StaticJsonDocument<64> doc;
-  doc["ok"] = true;
-  doc["message"] = "Rebooting...";
+  nvs_store_chain(device.seq, device.chain_head);
 
-  String response;
-  serializeJson(doc, response);
-  http_send_json(req, response.c_str());
+  http_send_json(req, "{\"ok\":true,\"message\":\"Rebooting...\"}");
 
   delay(500);
+#if FEATURE_SD_STORAGE
+  storage_flush();
+#endif
   ESP.restart();
   return ESP_OK;
 }
@@ -537,38 +1720,83 @@ static esp_err_t handle_reboot(httpd_req_t* req) {
 static esp_err_t handle_ota(httpd_req_t* req) {
   witness_get_health().http_requests++;
 
-  if (req->content_len <= 0 || req->content_len > 2 * 1024 * 1024) {
+  if (req->content_len <= 0 || req->content_len > OTA_MAX_IMAGE_SIZE) {
     return http_send_error(req, 400, "invalid_size");
   }
 
-  if (!Update.begin(req->content_len)) {
-    return http_send_error(req, 500, "ota_begin_failed");
+  // Optional end-to-end check: X-OTA-SHA256: <64 hex digits>
+  uint8_t expected[32];
+  char expected_hex[65];
+  bool has_expected = false;
+  if (httpd_req_get_hdr_value_str(req, "X-OTA-SHA256", expected_hex, sizeof(expected_hex)) == ESP_OK) {
+    if (!hex_parse(expected, expected_hex, sizeof(expected))) {
+      return http_send_error(req, 400, "invalid_sha256");
+    }
+    has_expected = true;
   }
 
-  char buf[4096];
-  int remaining = req->content_len;
-  while (remaining > 0) {
-    int recv_len = httpd_req_recv(req, buf, MIN(remaining, sizeof(buf)));
-    if (recv_len <= 0) {
-      Update.abort();
-      return http_send_error(req, 500, "receive_failed");
+  // Optional transfer encoding: X-OTA-Encoding: zlib|delta, which needs
+  // X-OTA-Image-Size: <decoded bytes>. The SHA-256 is of the decoded image.
+  ota_encoding_t encoding = OTA_ENCODING_RAW;
+  uint32_t image_size = req->content_len;
+  char value[16];
+  if (httpd_req_get_hdr_value_str(req, "X-OTA-Encoding", value, sizeof(value)) == ESP_OK &&
+      !ota_encoding_parse(value, &encoding)) {
+    return http_send_error(req, 400, "invalid_encoding");
+  }
+  if (encoding != OTA_ENCODING_RAW) {
+    image_size = 0;
+    if (httpd_req_get_hdr_value_str(req, "X-OTA-Image-Size", value, sizeof(value)) == ESP_OK) {
+      image_size = strtoul(value, nullptr, 10);
     }
-    if (Update.write((uint8_t*)buf, recv_len) != recv_len) {
-      Update.abort();
-      return http_send_error(req, 500, "write_failed");
+    if (image_size == 0 || image_size > OTA_MAX_IMAGE_SIZE) {
+      return http_send_error(req, 400, "invalid_image_size");
     }
-    remaining -= recv_len;
   }
 
-  if (Update.end(true)) {
-    const char* resp = "{\"ok\":true,\"message\":\"Rebooting...\"}";
-    http_send_json(req, resp);
-    delay(500);
-    ESP.restart();
-    return ESP_OK;
-  } else {
+  if (!Update.begin(image_size)) {
+    return http_send_error(req, 500, "ota_begin_failed");
+  }
+
+  OtaIngestResult res;
+  if (!ota_ingest(req, encoding, image_size, has_expected ? expected : nullptr, &res)) {
+    Update.abort();
+    log_health(LOG_LEVEL_ERROR, LOG_CAT_SYSTEM, LOG_MSG_OTA_UPLOAD_FAILED, res.error);
+    return http_send_error(req, res.status, res.error);
+  }
+
+  if (!Update.end(true)) {
     return http_send_error(req, 500, "ota_end_failed");
   }
+
+  char sha_hex[65];
+  hex_to_str(sha_hex, res.sha256, 32);
+  char detail[48];
+  snprintf(detail, sizeof(detail), "%u B (%s) in %u ms", (unsigned)res.image_bytes,
+           ota_encoding_name(encoding), (unsigned)res.elapsed_ms);
+  log_health(LOG_LEVEL_NOTICE, LOG_CAT_SYSTEM, LOG_MSG_OTA_IMAGE_WRITTEN, detail);
+
+  JsonWriter w(req, s_resp_chunk, sizeof(s_resp_chunk));
+  w.beginObject();
+  w.field("ok", true);
+  w.field("message", "Rebooting...");
+  w.field("bytes", res.bytes);
+  w.field("image_bytes", res.image_bytes);
+  w.field("encoding", ota_encoding_name(encoding));
+  w.field("sha256", sha_hex);
+  w.field("verified", has_expected);
+  w.field("elapsed_ms", res.elapsed_ms);
+  w.field("flash_ms", res.flash_ms);
+  w.field("recv_stall_ms", res.recv_stall_ms);
+  w.endObject();
+  w.finish();
+
+  delay(500);
+#if FEATURE_SD_STORAGE
+  storage_flush();
+#endif
+  ESP.restart();
+  return ESP_OK;
 }
 #endif
 
@@ -581,100 +1809,431 @@ static esp_err_t handle_peek_start(httpd_req_t* req) {
   }
 
   camera_set_peek_active(true);
-  log_health(LOG_LEVEL_INFO, LOG_CAT_NETWORK, "Peek started", nullptr);
+  log_health(LOG_LEVEL_INFO, LOG_CAT_NETWORK, LOG_MSG_PEEK_STARTED);
+
+  JsonWriter w(req, s_resp_chunk, sizeof(s_resp_chunk));
+  w.beginObject();
+  w.field("ok", true);
+  w.field("message", "Peek stream activated");
+  w.field("resolution", camera_get_instance().getResolutionName());
+  w.endObject();
+  return w.finish();
+}
+
+// Runs on an HTTP worker so the MJPEG loop never holds the httpd task
+static void peek_stream_worker(int fd, void* arg) {
+  (void)arg;
+  if (fd < 0) return;
+  static const char HEADERS[] =
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Type: multipart/x-mixed-replace; boundary=frame\r\n"
+    "Cache-Control: no-store, no-cache, must-revalidate\r\n"
+    "Access-Control-Allow-Origin: *\r\n"
+    "Connection: close\r\n\r\n";
+
+  if (!http_worker_send(fd, HEADERS, sizeof(HEADERS) - 1)) return;
+
+  // Frames come from the shared capture ring; a slow viewer just skips
+  CameraManager& cam = camera_get_instance();
+  cam.addViewer();
+
+  uint32_t last_seq = 0;
+  uint32_t send_ema_ms = 0;
+  while (cam.isPeekActive()) {
+    CameraFrame frame;
+    if (!cam.acquireFrame(last_seq, &frame, 1000)) continue;
 
-  StaticJsonDocument<128> doc;
-  doc["ok"] = true;
-  doc["message"] = "Peek stream activated";
-  doc["resolution"] = camera_get_instance().getResolutionName();
+    char part_buf[128];
+    int part_len = snprintf(part_buf, sizeof(part_buf),
+      "--frame\r\nContent-Type: image/jpeg\r\nContent-Length: %u\r\n\r\n",
+      (unsigned)frame.len);
+
+    uint32_t t0 = millis();
+    bool ok = http_worker_send(fd, part_buf, part_len) &&
+              http_worker_send(fd, frame.data, frame.len) &&
+              http_worker_send(fd, "\r\n", 2);
+    last_seq = frame.seq;
+    cam.releaseFrame(frame);
+    if (!ok) break;
+
+    // Blocking send time tracks the link: a full socket buffer stalls it
+    uint32_t send_ms = millis() - t0;
+    send_ema_ms = send_ema_ms ? (send_ema_ms * 3 + send_ms) / 4 : send_ms;
+    cam.reportSendTime(send_ema_ms);
+  }
 
-  String response;
-  serializeJson(doc, response);
-  return http_send_json(req, response.c_str());
+  cam.removeViewer();
+  log_health(LOG_LEVEL_INFO, LOG_CAT_NETWORK, LOG_MSG_PEEK_STREAM_ENDED);
 }
 
 static esp_err_t handle_peek_stream(httpd_req_t* req) {
   witness_get_health().http_requests++;
 
+  if (!camera_get_instance().isInitialized()) {
+    return http_send_error(req, 503, "camera_not_initialized");
+  }
+
+  if (http_worker_detach(req, peek_stream_worker, nullptr) != ESP_OK) {
+    return http_send_error(req, 503, "workers_busy");
+  }
+  return ESP_OK;
+}
+
+static esp_err_t handle_peek_stop(httpd_req_t* req) {
+  witness_get_health().http_requests++;
+
+  camera_set_peek_active(false);
+  log_health(LOG_LEVEL_INFO, LOG_CAT_NETWORK, LOG_MSG_PEEK_STOPPED);
+
+  return http_send_json(req, "{\"ok\":true,\"message\":\"Peek stopped\"}");
+}
+
+static esp_err_t handle_peek_status(httpd_req_t* req) {
+  witness_get_health().http_requests++;
+
+  CameraManager& cam = camera_get_instance();
+
+  JsonWriter w(req, s_resp_chunk, sizeof(s_resp_chunk));
+  w.beginObject();
+  w.field("ok", true);
+  w.field("camera_initialized", cam.isInitialized());
+  w.field("peek_active", cam.isPeekActive());
+  w.field("viewers", cam.getViewerCount());
+  w.field("frames_captured", cam.getFramesCaptured());
+  w.field("frames_dropped", cam.getFramesDropped());
+  w.field("snapshot_captures", cam.getSnapshotCaptures());
+  w.field("jpeg_quality", cam.getJpegQuality());
+  w.field("capture_interval_ms", cam.getCaptureIntervalMs());
+  w.field("send_ms", cam.getSendTimeMs());
+  w.field("resolution", (int)cam.getResolution());
+  w.field("resolution_name", cam.getResolutionName());
+  w.endObject();
+  return w.finish();
+}
+
+// Still image from the shared frame ring. Does not start peek: pollers
+// share one capture per max age and revalidate against the frame's ETag.
+static esp_err_t handle_peek_snapshot(httpd_req_t* req) {
+  witness_get_health().http_requests++;
+
   CameraManager& cam = camera_get_instance();
   if (!cam.isInitialized()) {
-    return httpd_resp_send(req, "Camera not initialized", HTTPD_RESP_USE_STRLEN);
+    return http_send_error(req, 503, "camera_not_initialized");
+  }
+
+  uint32_t max_age_ms = query_u32(req, "max_age_ms", CAMERA_SNAPSHOT_MAX_AGE_MS);
+  if (max_age_ms > CAMERA_SNAPSHOT_MAX_AGE_LIMIT_MS) max_age_ms = CAMERA_SNAPSHOT_MAX_AGE_LIMIT_MS;
+
+  CameraFrame frame;
+  if (!cam.acquireSnapshot(max_age_ms, &frame, CAMERA_SNAPSHOT_TIMEOUT_MS)) {
+    return http_send_error(req, 503, "capture_failed");
   }
 
-  cam.setPeekActive(true);
+  char etag[24];
+  snprintf(etag, sizeof(etag), "\"%08x-%u\"", (unsigned)cam.getBootTag(), (unsigned)frame.seq);
+  char age[12];
+  snprintf(age, sizeof(age), "%u", (unsigned)(millis() - frame.captured_ms));
 
-  httpd_resp_set_type(req, "multipart/x-mixed-replace; boundary=frame");
-  httpd_resp_set_hdr(req, "Cache-Control", "no-store, no-cache, must-revalidate");
+  httpd_resp_set_hdr(req, "ETag", etag);
+  httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
+  httpd_resp_set_hdr(req, "X-Frame-Age-Ms", age);
   httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
 
-  while (cam.isPeekActive()) {
-    camera_fb_t* fb = cam.captureFrame();
-    if (!fb) {
-      vTaskDelay(pdMS_TO_TICKS(100));
-      continue;
+  esp_err_t err;
+  if (header_has_token(req, "If-None-Match", etag)) {
+    httpd_resp_set_status(req, "304 Not Modified");
+    err = httpd_resp_send(req, nullptr, 0);
+  } else {
+    httpd_resp_set_type(req, "image/jpeg");
+    err = httpd_resp_send(req, (const char*)frame.data, frame.len);
+
+    // Audited like a peek, once per captured frame handed out; pollers
+    // sharing one capture add no entries
+    static uint32_t s_logged_seq = 0;
+    if (frame.seq != s_logged_seq) {
+      s_logged_seq = frame.seq;
+      log_health(LOG_LEVEL_INFO, LOG_CAT_NETWORK, LOG_MSG_PEEK_SNAPSHOT, LogArg::seq(frame.seq));
     }
+  }
 
-    char part_buf[128];
-    int part_len = snprintf(part_buf, sizeof(part_buf),
-      "--frame\r\nContent-Type: image/jpeg\r\nContent-Length: %u\r\n\r\n",
-      (unsigned)fb->len);
+  cam.releaseFrame(frame);
+  return err;
+}
+#endif
 
-    esp_err_t res = httpd_resp_send_chunk(req, part_buf, part_len);
-    if (res != ESP_OK) {
-      cam.returnFrame(fb);
-      break;
-    }
+// ════════════════════════════════════════════════════════════════════════════
+// SERVER-SENT EVENTS
+// ════════════════════════════════════════════════════════════════════════════
+//
+// /api/events sends its headers and an initial snapshot, then returns with
+// the response left open. pollEvents() queues a work item on the httpd
+// task that diffs device state and writes "status", "chain", "log" and
+// "wifi" frames straight to each subscriber socket as HTTP chunks. All
+// subscriber state is only touched on the httpd task. Chain state is read
+// through witness_get_chain_snapshot(), under the writers' chain lock.
+
+struct SseState {
+  uint32_t chain_seq;
+  uint32_t witness_count;
+  uint32_t boot_count;
+  uint32_t free_heap_kb;
+  uint32_t min_heap;
+  uint32_t logs_stored;
+  uint32_t unacked_count;
+  uint32_t log_seq;
+  WiFiProvState wifi_state;
+  bool sta_connected;
+  bool crypto_healthy;
+  bool gps_healthy;
+  bool sd_healthy;
+  bool wifi_active;
+};
+
+static const size_t SSE_FRAME_MAX = 768;
+static const size_t SSE_CHUNK_HEAD = 5;     // "xxx\r\n", fixed width
+
+static int s_sse_fds[HTTP_SSE_MAX_CLIENTS];
+static uint8_t s_sse_clients = 0;
+static SseState s_sse_last;
+static uint32_t s_sse_keepalive_ms = 0;
+static std::atomic<bool> s_sse_work_pending{false};
+
+static void sse_reset() {
+  for (size_t i = 0; i < HTTP_SSE_MAX_CLIENTS; i++) s_sse_fds[i] = -1;
+  s_sse_clients = 0;
+  s_sse_work_pending = false;
+}
 
-    res = httpd_resp_send_chunk(req, (const char*)fb->buf, fb->len);
-    if (res != ESP_OK) {
-      cam.returnFrame(fb);
-      break;
+static void sse_capture(SseState& st, WitnessChainSnapshot& chain) {
+  DeviceIdentity& device = witness_get_device();
+  SystemHealth& health = witness_get_health();
+  const WiFiStatus& wifi = network_get_instance().getStatus();
+
+  witness_get_chain_snapshot(&chain);
+  st.chain_seq = chain.seq;
+  st.witness_count = health.records_created;
+  st.boot_count = device.boot_count;
+  st.free_heap_kb = ESP.getFreeHeap() / 1024;
+  st.min_heap = health.min_heap;
+  st.logs_stored = health.logs_stored;
+  st.unacked_count = health.logs_unacked;
+  st.log_seq = device.log_seq;
+  st.wifi_state = wifi.state;
+  st.sta_connected = wifi.sta_connected;
+  st.crypto_healthy = health.crypto_healthy;
+  st.gps_healthy = health.gps_healthy;
+  st.sd_healthy = health.sd_healthy;
+  st.wifi_active = health.wifi_active;
+}
+
+// Status fields that differ from prev (all of them when prev is null).
+// Returns false if nothing but uptime changed.
+static bool sse_status_json(const SseState& st, const SseState* prev, char* out, size_t cap) {
+  JsonWriter w(out, cap);
+  w.beginObject();
+  w.field("uptime_sec", uptime_seconds());
+  bool changed = false;
+
+#define SSE_DIFF(key, member, value) \
+  if (!prev || st.member != prev->member) { w.field(key, value); changed = true; }
+  SSE_DIFF("chain_seq", chain_seq, st.chain_seq);
+  SSE_DIFF("witness_count", witness_count, st.witness_count);
+  SSE_DIFF("boot_count", boot_count, st.boot_count);
+  SSE_DIFF("free_heap", free_heap_kb, ESP.getFreeHeap());   // KB granularity
+  SSE_DIFF("min_heap", min_heap, st.min_heap);
+  SSE_DIFF("logs_stored", logs_stored, st.logs_stored);
+  SSE_DIFF("unacked_count", unacked_count, st.unacked_count);
+  SSE_DIFF("crypto_healthy", crypto_healthy, st.crypto_healthy);
+  SSE_DIFF("gps_healthy", gps_healthy, st.gps_healthy);
+  SSE_DIFF("sd_healthy", sd_healthy, st.sd_healthy);
+  SSE_DIFF("wifi_active", wifi_active, st.wifi_active);
+#undef SSE_DIFF
+
+  if (!prev) {
+    DeviceIdentity& device = witness_get_device();
+    w.field("ok", true);
+    w.field("device_id", device.device_id);
+    w.field("firmware", FIRMWARE_VERSION);
+    w.fieldHex("fingerprint", device.pubkey_fp, 8);
+    w.fieldHex("pubkey", device.pubkey, 32);
+  }
+
+  w.endObject();
+  return w.finish() == ESP_OK && changed;
+}
+
+static bool sse_chain_json(const WitnessChainSnapshot& chain, char* out, size_t cap) {
+  JsonWriter w(out, cap);
+  w.beginObject();
+  w.fieldHex("chain_head", chain.chain_head, 32);
+  w.field("sequence", chain.seq);
+  if (chain.last_seq > 0) {
+    w.beginArray("blocks").beginObject();
+    w.field("seq", chain.last_seq);
+    w.fieldHex("hash", chain.last_hash, 32);
+    w.field("type", record_type_name(chain.last_type));
+    w.field("verified", chain.last_verified);
+    w.endObject().endArray();
+  }
+  w.endObject();
+  return w.finish() == ESP_OK;
+}
+
+static bool sse_log_json(const HealthLogRingEntry& entry, char* out, size_t cap) {
+  JsonWriter w(out, cap);
+  write_log_entry(w, entry);
+  return w.finish() == ESP_OK;
+}
+
+// Wrap an SSE event in one HTTP chunk. data == nullptr sends a comment
+// frame (keepalive). Returns the frame length, or 0 if it does not fit.
+static size_t sse_frame(char* frame, const char* event, const char* data) {
+  char* body = frame + SSE_CHUNK_HEAD;
+  size_t room = SSE_FRAME_MAX - SSE_CHUNK_HEAD - 2;
+  int n = data ? snprintf(body, room, "event: %s\ndata: %s\n\n", event, data)
+               : snprintf(body, room, ": %s\n\n", event);
+  if (n <= 0 || (size_t)n >= room) return 0;
+
+  char head[SSE_CHUNK_HEAD + 1];
+  snprintf(head, sizeof(head), "%03x\r\n", (unsigned)n);
+  memcpy(frame, head, SSE_CHUNK_HEAD);
+  memcpy(body + n, "\r\n", 2);
+  return SSE_CHUNK_HEAD + n + 2;
+}
+
+static void sse_broadcast(httpd_handle_t hd, const char* event, const char* data) {
+  char frame[SSE_FRAME_MAX];
+  size_t len = sse_frame(frame, event, data);
+  if (len == 0) return;
+  for (size_t i = 0; i < HTTP_SSE_MAX_CLIENTS; i++) {
+    if (s_sse_fds[i] < 0) continue;
+    // The slot is released by sse_session_closed() once httpd tears the
+    // session down, so it cannot be reused while the close is pending
+    if (httpd_socket_send(hd, s_sse_fds[i], frame, len, 0) != (int)len) {
+      httpd_sess_trigger_close(hd, s_sse_fds[i]);
     }
+  }
+}
 
-    res = httpd_resp_send_chunk(req, "\r\n", 2);
-    cam.returnFrame(fb);
+// Session teardown (client closed, socket error); ctx is slot + 1
+static void sse_session_closed(void* ctx) {
+  size_t slot = (size_t)(uintptr_t)ctx - 1;
+  if (slot < HTTP_SSE_MAX_CLIENTS && s_sse_fds[slot] >= 0) {
+    s_sse_fds[slot] = -1;
+    s_sse_clients--;
+  }
+}
+
+// Runs on the httpd task via httpd_queue_work()
+static void sse_publish_work(void* arg) {
+  httpd_handle_t hd = (httpd_handle_t)arg;
+  s_sse_work_pending = false;
+  if (s_sse_clients == 0) return;
 
-    if (res != ESP_OK) break;
+  SseState now;
+  WitnessChainSnapshot chain;
+  sse_capture(now, chain);
+  char data[SSE_FRAME_MAX - 64];
 
-    #if FEATURE_WATCHDOG
-    esp_task_wdt_reset();
-    #endif
-    vTaskDelay(pdMS_TO_TICKS(80));
+  if (sse_status_json(now, &s_sse_last, data, sizeof(data))) {
+    sse_broadcast(hd, "status", data);
   }
 
-  cam.setPeekActive(false);
-  httpd_resp_send_chunk(req, NULL, 0);
-  log_health(LOG_LEVEL_INFO, LOG_CAT_NETWORK, "Peek stream ended", nullptr);
+  if (now.chain_seq != s_sse_last.chain_seq) {
+    if (sse_chain_json(chain, data, sizeof(data))) {
+      sse_broadcast(hd, "chain", data);
+    }
+  }
 
-  return ESP_OK;
+  if (now.wifi_state != s_sse_last.wifi_state || now.sta_connected != s_sse_last.sta_connected) {
+    const WiFiStatus& wifi = network_get_instance().getStatus();
+    snprintf(data, sizeof(data),
+             "{\"state\":\"%s\",\"sta_connected\":%s,\"reconnect_ms\":%lu,\"reconnect_fast\":%s}",
+             NetworkManager::stateName(now.wifi_state), now.sta_connected ? "true" : "false",
+             (unsigned long)wifi.reconnect_ms, wifi.reconnect_fast ? "true" : "false");
+    sse_broadcast(hd, "wifi", data);
+  }
+
+  // New log entries, oldest first. A burst larger than HTTP_SSE_LOG_BURST
+  // sends only the newest; clients page older ones from /api/logs.
+  if (now.log_seq != s_sse_last.log_seq) {
+    uint32_t first, newest;
+    witness_get_health_log_range(&first, &newest);
+    if (first <= s_sse_last.log_seq) first = s_sse_last.log_seq + 1;
+    if (newest >= HTTP_SSE_LOG_BURST && first <= newest - HTTP_SSE_LOG_BURST) {
+      first = newest - HTTP_SSE_LOG_BURST + 1;
+    }
+    for (uint32_t seq = first; newest > 0 && seq <= newest; seq++) {
+      HealthLogRingEntry entry;
+      if (witness_get_health_log(seq, &entry) && sse_log_json(entry, data, sizeof(data))) {
+        sse_broadcast(hd, "log", data);
+      }
+    }
+  }
+
+  uint32_t ms = millis();
+  if (ms - s_sse_keepalive_ms >= HTTP_SSE_KEEPALIVE_MS) {
+    s_sse_keepalive_ms = ms;
+    sse_broadcast(hd, "keepalive", nullptr);
+  }
+
+  s_sse_last = now;
 }
 
-static esp_err_t handle_peek_stop(httpd_req_t* req) {
-  witness_get_health().http_requests++;
+// Called once per network tick via network_update(); at most one work
+// item is ever queued
+void NetworkManager::pollEvents() {
+  if (!m_http_server || s_sse_clients == 0 || s_sse_work_pending) return;
 
-  camera_set_peek_active(false);
-  log_health(LOG_LEVEL_INFO, LOG_CAT_NETWORK, "Peek stopped", nullptr);
+  uint32_t now = millis();
+  if (now - m_last_event_poll_ms < HTTP_SSE_POLL_MS) return;
 
-  return http_send_json(req, "{\"ok\":true,\"message\":\"Peek stopped\"}");
+  bool idle = false;
+  if (!s_sse_work_pending.compare_exchange_strong(idle, true)) return;
+  m_last_event_poll_ms = now;
+  if (httpd_queue_work(m_http_server, sse_publish_work, m_http_server) != ESP_OK) {
+    s_sse_work_pending = false;
+  }
 }
 
-static esp_err_t handle_peek_status(httpd_req_t* req) {
+static esp_err_t handle_events(httpd_req_t* req) {
   witness_get_health().http_requests++;
 
-  CameraManager& cam = camera_get_instance();
+  size_t slot = 0;
+  while (slot < HTTP_SSE_MAX_CLIENTS && s_sse_fds[slot] >= 0) slot++;
+  if (slot == HTTP_SSE_MAX_CLIENTS) {
+    return http_send_error(req, 503, "too_many_subscribers");
+  }
 
-  StaticJsonDocument<256> doc;
-  doc["ok"] = true;
-  doc["camera_initialized"] = cam.isInitialized();
-  doc["peek_active"] = cam.isPeekActive();
-  doc["resolution"] = (int)cam.getResolution();
-  doc["resolution_name"] = cam.getResolutionName();
+  httpd_resp_set_type(req, "text/event-stream");
+  httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+  httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
 
-  String response;
-  serializeJson(doc, response);
-  return http_send_json(req, response.c_str());
+  // Full snapshot so the client starts from a consistent view
+  SseState now;
+  WitnessChainSnapshot chain;
+  sse_capture(now, chain);
+  char data[SSE_FRAME_MAX - 64];
+  char body[SSE_FRAME_MAX];
+  sse_status_json(now, nullptr, data, sizeof(data));
+  int n = snprintf(body, sizeof(body), "retry: 3000\nevent: status\ndata: %s\n\n", data);
+  if (n <= 0 || (size_t)n >= sizeof(body)) {
+    return http_send_error(req, 500, "snapshot_too_large");
+  }
+  if (httpd_resp_send_chunk(req, body, n) != ESP_OK) {
+    return ESP_FAIL;
+  }
+
+  // Leave the response open; the session's free hook releases the slot
+  s_sse_fds[slot] = httpd_req_to_sockfd(req);
+  req->sess_ctx = (void*)(uintptr_t)(slot + 1);
+  req->free_ctx = sse_session_closed;
+  if (s_sse_clients++ == 0) {
+    s_sse_last = now;
+    s_sse_keepalive_ms = millis();
+  }
+  return ESP_OK;
 }
-#endif
 
 // ════════════════════════════════════════════════════════════════════════════
 // CONVENIENCE FUNCTIONS
@@ -690,6 +2249,7 @@ bool network_start_http() {
 
 void network_update() {
   network_get_instance().checkConnection();
+  network_get_instance().pollEvents();
 }
 
 httpd_handle_t network_get_http_server() {
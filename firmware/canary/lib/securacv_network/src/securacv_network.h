@@ -49,6 +49,23 @@ struct WiFiStatus {
   uint32_t connect_attempts;
   uint32_t last_connect_ms;
   uint32_t connected_since_ms;
+  uint32_t reconnect_ms;          // Last connect, from WiFi.begin() to link up (0 = none yet)
+  bool reconnect_fast;            // Last connect used the cached BSSID/channel/lease
+  uint32_t fast_connects;
+  uint32_t fast_fallbacks;        // Cached attempt timed out; fell back to a full scan
+};
+
+// Last good association, persisted so a reconnect skips scan and DHCP.
+// Bound to the SSID it was learned on.
+struct WiFiFastCache {
+  uint8_t version;
+  uint8_t channel;
+  uint8_t bssid[6];
+  uint32_t ip;
+  uint32_t gateway;
+  uint32_t subnet;
+  uint32_t dns;
+  char ssid[33];
 };
 
 // ════════════════════════════════════════════════════════════════════════════
@@ -66,6 +83,9 @@ public:
   bool startHttpServer();
   void stopHttpServer();
 
+  // Push state changes to /api/events subscribers (call from loop)
+  void pollEvents();
+
   // Status
   const WiFiStatus& getStatus() const { return m_status; }
   const WiFiCredentials& getCredentials() const { return m_creds; }
@@ -86,11 +106,25 @@ public:
 
 private:
   void registerHttpHandlers();
+  bool loadFastCache();
+  void saveFastCache();
+  void startFullConnect();
+  void noteLease(uint32_t now);
+  uint32_t leaseT1Remaining(uint32_t now) const;
+
+  WiFiFastCache m_fast;
+  bool m_fast_valid;
+  bool m_fast_attempt;            // Current attempt is the directed one
+  bool m_fast_static;             // Running on the reused lease, not a DHCP one
+  uint32_t m_lease_start_ms;      // DHCP lease bound this boot, for static reuse
+  uint32_t m_lease_ms;            // Its length; 0 = none noted
+  uint32_t m_connect_start_ms;    // First WiFi.begin() of this attempt, for reconnect_ms
 
   WiFiCredentials m_creds;
   WiFiStatus m_status;
   httpd_handle_t m_http_server;
   bool m_scan_in_progress;
+  uint32_t m_last_event_poll_ms;
 };
 
 // ════════════════════════════════════════════════════════════════════════════
@@ -0,0 +1,155 @@
+/*
+ * SecuraCV Canary — Power Management Implementation
+ *
+ * Copyright (c) 2026 ERRERlabs / Karl May
+ * License: Apache-2.0
+ */
+
+#include "securacv_power.h"
+#include "securacv_witness.h"
+#include "log_level.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_freertos_hooks.h"
+
+#if FEATURE_POWER_MANAGEMENT
+#include "driver/gpio.h"
+#include "driver/uart.h"
+#include "esp_sleep.h"
+#endif
+
+static PowerMode s_mode = POWER_MODE_FULL;
+
+// Tick samples per core; written from each core's tick ISR
+static volatile uint32_t s_busy_ticks[portNUM_PROCESSORS];
+static uint32_t s_window_start_ms = 0;
+static uint32_t s_window_busy[portNUM_PROCESSORS];
+
+#if FEATURE_POWER_MANAGEMENT
+static esp_pm_lock_handle_t s_boost_lock = nullptr;
+#endif
+
+const char* power_mode_name(PowerMode m) {
+  switch (m) {
+    case POWER_MODE_FULL:        return "full";
+    case POWER_MODE_DFS:         return "dfs";
+    case POWER_MODE_LIGHT_SLEEP: return "light_sleep";
+    default:                     return "?";
+  }
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// DUTY CYCLE SAMPLING
+// ════════════════════════════════════════════════════════════════════════════
+
+static void IRAM_ATTR sample_tick(int core) {
+  if (xTaskGetCurrentTaskHandleForCPU(core) != xTaskGetIdleTaskHandleForCPU(core)) {
+    s_busy_ticks[core] = s_busy_ticks[core] + 1;
+  }
+}
+
+static void IRAM_ATTR tick_hook_core0() { sample_tick(0); }
+#if portNUM_PROCESSORS > 1
+static void IRAM_ATTR tick_hook_core1() { sample_tick(1); }
+#endif
+
+void power_update() {
+  uint32_t now = millis();
+  uint32_t elapsed = now - s_window_start_ms;
+  if (elapsed < POWER_DUTY_WINDOW_MS) return;
+
+  uint32_t busy = 0;
+  for (int core = 0; core < portNUM_PROCESSORS; core++) {
+    uint32_t ticks = s_busy_ticks[core];
+    busy += ticks - s_window_busy[core];
+    s_window_busy[core] = ticks;
+  }
+  s_window_start_ms = now;
+
+  // Busy time over wall time, averaged across cores
+  uint64_t busy_ms = (uint64_t)busy * portTICK_PERIOD_MS;
+  uint32_t pct = (uint32_t)(busy_ms * 100 / ((uint64_t)elapsed * portNUM_PROCESSORS));
+  if (pct > 100) pct = 100;
+
+  SystemHealth& health = witness_get_health();
+  if (health.cpu_duty_pct != pct) {
+    health.cpu_duty_pct = pct;
+    witness_mark_status_dirty(STATUS_DIRTY_HEALTH);
+  }
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// POWER MANAGEMENT
+// ════════════════════════════════════════════════════════════════════════════
+
+#if FEATURE_POWER_MANAGEMENT
+PowerBoost::PowerBoost() {
+  if (s_boost_lock) esp_pm_lock_acquire(s_boost_lock);
+}
+
+PowerBoost::~PowerBoost() {
+  if (s_boost_lock) esp_pm_lock_release(s_boost_lock);
+}
+
+static void enable_wake_sources() {
+  // A few RX edges wake the chip; the bytes that did it are lost, so the
+  // first sentence of a burst may fail its checksum
+  uart_set_wakeup_threshold((uart_port_t)GPS_UART_NUM, POWER_UART_WAKE_THRESHOLD);
+  esp_sleep_enable_uart_wakeup(GPS_UART_NUM);
+
+  gpio_wakeup_enable((gpio_num_t)BOOT_BUTTON_GPIO, GPIO_INTR_LOW_LEVEL);
+#if FEATURE_TAMPER_GPIO
+  gpio_wakeup_enable((gpio_num_t)TAMPER_GPIO, GPIO_INTR_LOW_LEVEL);
+#endif
+  esp_sleep_enable_gpio_wakeup();
+}
+
+static PowerMode configure_pm() {
+  esp_pm_config_esp32s3_t pm = {};
+  pm.max_freq_mhz = POWER_CPU_MAX_MHZ;
+  pm.min_freq_mhz = POWER_CPU_MIN_MHZ;
+  pm.light_sleep_enable = POWER_LIGHT_SLEEP;
+
+  esp_err_t err = esp_pm_configure(&pm);
+  if (err == ESP_OK) return pm.light_sleep_enable ? POWER_MODE_LIGHT_SLEEP : POWER_MODE_DFS;
+
+  // Light sleep needs CONFIG_FREERTOS_USE_TICKLESS_IDLE; scale clocks without it
+  if (err == ESP_ERR_NOT_SUPPORTED && pm.light_sleep_enable) {
+    pm.light_sleep_enable = false;
+    if (esp_pm_configure(&pm) == ESP_OK) return POWER_MODE_DFS;
+  }
+  return POWER_MODE_FULL;
+}
+#endif
+
+PowerMode power_begin() {
+  esp_register_freertos_tick_hook_for_cpu(tick_hook_core0, 0);
+#if portNUM_PROCESSORS > 1
+  esp_register_freertos_tick_hook_for_cpu(tick_hook_core1, 1);
+#endif
+  s_window_start_ms = millis();
+
+#if FEATURE_POWER_MANAGEMENT
+  if (esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "boost", &s_boost_lock) != ESP_OK) {
+    s_boost_lock = nullptr;
+  }
+  s_mode = configure_pm();
+  if (s_mode == POWER_MODE_LIGHT_SLEEP) enable_wake_sources();
+
+  if (s_mode == POWER_MODE_FULL) {
+    log_health(LOG_LEVEL_WARNING, LOG_CAT_SYSTEM, LOG_MSG_POWER_UNAVAILABLE);
+  } else {
+    Serial.printf("[OK] Power: %s, %d-%d MHz\n", power_mode_name(s_mode),
+                  POWER_CPU_MIN_MHZ, POWER_CPU_MAX_MHZ);
+  }
+#endif
+
+  SystemHealth& health = witness_get_health();
+  health.light_sleep = s_mode == POWER_MODE_LIGHT_SLEEP;
+  witness_mark_status_dirty(STATUS_DIRTY_HEALTH);
+  return s_mode;
+}
+
+PowerMode power_get_mode() {
+  return s_mode;
+}
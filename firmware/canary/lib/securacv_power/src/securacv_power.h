@@ -0,0 +1,63 @@
+/*
+ * SecuraCV Canary — Power Management
+ *
+ * Power-managed run mode for solar and battery installs. With
+ * FEATURE_POWER_MANAGEMENT the CPU clock scales down while every task is
+ * blocked, and when the sdkconfig has tickless idle the chip enters
+ * automatic light sleep between GNSS bursts and record deadlines. The
+ * GNSS UART and the BOOT/tamper GPIOs are wake sources.
+ *
+ * The WiFi driver holds its own power lock while the AP is up, so the AP
+ * and HTTP server stay responsive; on AP builds the saving comes from
+ * frequency scaling, and light sleep only takes over when WiFi is off.
+ * HTTP handlers and record signing hold a PowerBoost so they always run
+ * at full clock.
+ *
+ * The duty cycle is measured in every build: each core's tick interrupt
+ * samples whether a non-idle task was running. Ticks are suppressed
+ * during light sleep, so sleep counts as idle.
+ *
+ * Copyright (c) 2026 ERRERlabs / Karl May
+ * License: Apache-2.0
+ */
+
+#ifndef SECURACV_POWER_H
+#define SECURACV_POWER_H
+
+#include <Arduino.h>
+#include <stdint.h>
+#include "canary_config.h"
+
+#if FEATURE_POWER_MANAGEMENT
+#include "esp_pm.h"
+#endif
+
+enum PowerMode : uint8_t {
+  POWER_MODE_FULL,          // No power management (fixed clock)
+  POWER_MODE_DFS,           // Frequency scaling only
+  POWER_MODE_LIGHT_SLEEP    // Frequency scaling plus automatic light sleep
+};
+
+// Configure power management and wake sources, and start duty-cycle
+// sampling. Call after the GNSS UART driver is installed.
+PowerMode power_begin();
+
+PowerMode power_get_mode();
+
+// Fold the current window into SystemHealth; call periodically
+void power_update();
+
+const char* power_mode_name(PowerMode m);
+
+// Holds the CPU at full clock for the enclosing scope
+class PowerBoost {
+public:
+#if FEATURE_POWER_MANAGEMENT
+  PowerBoost();
+  ~PowerBoost();
+#else
+  PowerBoost() {}
+#endif
+};
+
+#endif // SECURACV_POWER_H
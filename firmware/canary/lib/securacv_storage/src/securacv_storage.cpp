@@ -6,6 +6,11 @@
  */
 
 #include "securacv_storage.h"
+#include "securacv_witness.h"
+#include <esp_rom_crc.h>
+#if SD_USE_SDMMC
+#include <SD_MMC.h>
+#endif
 
 #if FEATURE_SD_STORAGE
 
@@ -16,6 +21,9 @@
 static StorageManager s_storage;
 static SPIClass s_sd_spi(FSPI);
 
+// Filesystem of whichever host mounted the card; paths are the same on both
+static fs::FS* s_fs = &SD;
+
 StorageManager& storage_get_instance() {
   return s_storage;
 }
@@ -25,45 +33,151 @@ StorageManager& storage_get_instance() {
 // ════════════════════════════════════════════════════════════════════════════
 
 StorageManager::StorageManager()
-  : m_spi(nullptr), m_mounted(false), m_write_errors(0),
-    m_read_errors(0), m_last_write_ms(0) {}
+  : m_spi(nullptr), m_mounted(false), m_bus(SD_BUS_NONE), m_write_errors(0),
+    m_read_errors(0), m_last_write_ms(0), m_log_lock(nullptr),
+    m_append_off(0), m_last_seq(0), m_wbuf_base(0), m_wbuf_len(0), m_wbuf_clean(0),
+    m_wbuf_ms(0), m_idx_pending_count(0), m_ckpt_pending_valid(false), m_ckpt_count(0),
+    m_health_lock(nullptr), m_health_off(0),
+    m_health_sector(0), m_health_batch_ms(0), m_health_persisted(0), m_health_gen(0) {
+  m_active.loaded = false;
+  m_cached.loaded = false;
+  memset(m_health_batch, 0, sizeof(m_health_batch));
+  memset(&m_ckpt_latest, 0, sizeof(m_ckpt_latest));
+  memset(&m_witness_io, 0, sizeof(m_witness_io));
+  memset(&m_health_io, 0, sizeof(m_health_io));
+  memset(&m_counts, 0, sizeof(m_counts));
+  m_counts_valid = false;
+  m_counts_dirty = false;
+  m_counts_saved_ms = 0;
+  m_total_bytes = m_used_bytes = 0;
+  m_space_witness = m_space_health = 0;
+  m_witness_bytes = 0;
+  m_health_old_bytes = 0;
+  memset(&m_retain, 0, sizeof(m_retain));
+  memset(&m_scrub, 0, sizeof(m_scrub));
+}
 
-bool StorageManager::begin(SPIClass* spi) {
-  if (spi) {
-    m_spi = spi;
-  } else {
-    m_spi = &s_sd_spi;
+// SDMMC moves several times the data per clock that SPI does, so it is
+// tried first. SPI is the fallback, fast then slow: a card that answers in
+// SD mode can still be reset into SPI mode, but not the other way round.
+bool StorageManager::mountCard(bool try_sdmmc) {
+#if SD_USE_SDMMC
+  if (try_sdmmc) {
+    bool pins;
+    if (SD_MMC_BUS_WIDTH == 4) {
+      pins = SD_MMC.setPins(SD_MMC_CLK_PIN, SD_MMC_CMD_PIN, SD_MMC_D0_PIN,
+                            SD_MMC_D1_PIN, SD_MMC_D2_PIN, SD_MMC_D3_PIN);
+    } else {
+      // D3 low at CMD0 would select SPI mode
+      if (SD_MMC_D3_PIN >= 0) {
+        pinMode(SD_MMC_D3_PIN, OUTPUT);
+        digitalWrite(SD_MMC_D3_PIN, HIGH);
+      }
+      pins = SD_MMC.setPins(SD_MMC_CLK_PIN, SD_MMC_CMD_PIN, SD_MMC_D0_PIN);
+    }
+    if (pins && SD_MMC.begin("/sdcard", SD_MMC_BUS_WIDTH != 4, false, SD_MMC_FREQ_KHZ)) {
+      s_fs = &SD_MMC;
+      m_bus = SD_BUS_SDMMC;
+      return true;
+    }
+    Serial.println("[WARN] SDMMC mount failed, trying SPI");
+  }
+#else
+  (void)try_sdmmc;
+#endif
+
+  if (m_spi == &s_sd_spi) {
     m_spi->begin(SD_SCK_PIN, SD_MISO_PIN, SD_MOSI_PIN, SD_CS_PIN);
   }
+  if (SD.begin(SD_CS_PIN, *m_spi, SD_SPI_FAST) || SD.begin(SD_CS_PIN, *m_spi, SD_SPI_SLOW)) {
+    s_fs = &SD;
+    m_bus = SD_BUS_SPI;
+    return true;
+  }
+  m_bus = SD_BUS_NONE;
+  return false;
+}
 
-  if (!SD.begin(SD_CS_PIN, *m_spi, SD_SPI_FAST)) {
-    // Try slower speed
-    if (!SD.begin(SD_CS_PIN, *m_spi, SD_SPI_SLOW)) {
-      m_mounted = false;
-      return false;
-    }
+static uint64_t card_total_bytes(SDBus bus) {
+#if SD_USE_SDMMC
+  if (bus == SD_BUS_SDMMC) return SD_MMC.totalBytes();
+#endif
+  return SD.totalBytes();
+}
+
+static uint64_t card_used_bytes(SDBus bus) {
+#if SD_USE_SDMMC
+  if (bus == SD_BUS_SDMMC) return SD_MMC.usedBytes();
+#endif
+  return SD.usedBytes();
+}
+
+bool StorageManager::begin(SPIClass* spi) {
+  m_spi = spi ? spi : &s_sd_spi;
+  if (!mountCard(spi == nullptr)) {
+    m_mounted = false;
+    return false;
   }
 
   m_mounted = true;
 
+  if (!m_log_lock) {
+    m_log_lock = xSemaphoreCreateMutex();
+  }
+  if (!m_health_lock) {
+    m_health_lock = xSemaphoreCreateMutex();
+  }
+
   // Create directories
   ensureDirectories();
 
+  // The only free-space scan; the logs keep it current from here on
+  m_total_bytes = card_total_bytes(m_bus);
+  m_used_bytes = card_used_bytes(m_bus);
+  m_space_witness = m_space_health = 0;
+
+  // Same lock order as saveCounts(): the health log may still be appending
+  xSemaphoreTake(m_health_lock, portMAX_DELAY);
+  m_counts_valid = loadCounts();
+  xSemaphoreTake(m_log_lock, portMAX_DELAY);
+  reconcileWitnessCounts();
+  loadCheckpoints();
+  xSemaphoreGive(m_log_lock);
+  xSemaphoreGive(m_health_lock);
+  saveCounts();
+
+  // A pass cut short by an unmount starts over
+  m_scrub.active = false;
+  m_scrub.bad = false;
+
   return true;
 }
 
 void StorageManager::end() {
-  SD.end();
+  checkpoint();
+  if (m_health_lock) xSemaphoreTake(m_health_lock, portMAX_DELAY);
+  if (m_health_file) m_health_file.close();
+  if (m_health_lock) xSemaphoreGive(m_health_lock);
+
+  if (m_log_lock) xSemaphoreTake(m_log_lock, portMAX_DELAY);
+  closeSegment();
+  m_cached.loaded = false;
+  if (m_log_lock) xSemaphoreGive(m_log_lock);
+#if SD_USE_SDMMC
+  if (m_bus == SD_BUS_SDMMC) SD_MMC.end();
+#endif
+  if (m_bus == SD_BUS_SPI) SD.end();
+  m_bus = SD_BUS_NONE;
   m_mounted = false;
 }
 
 bool StorageManager::ensureDirectories() {
   if (!m_mounted) return false;
 
-  if (!SD.exists("/WITNESS")) SD.mkdir("/WITNESS");
-  if (!SD.exists("/HEALTH")) SD.mkdir("/HEALTH");
-  if (!SD.exists("/CHAIN")) SD.mkdir("/CHAIN");
-  if (!SD.exists("/EXPORT")) SD.mkdir("/EXPORT");
+  if (!s_fs->exists("/WITNESS")) s_fs->mkdir("/WITNESS");
+  if (!s_fs->exists("/HEALTH")) s_fs->mkdir("/HEALTH");
+  if (!s_fs->exists("/CHAIN")) s_fs->mkdir("/CHAIN");
+  if (!s_fs->exists("/EXPORT")) s_fs->mkdir("/EXPORT");
 
   return true;
 }
@@ -74,14 +188,50 @@ SDStatus StorageManager::getStatus() {
 
   status.mounted = m_mounted;
   status.healthy = m_mounted;
+  status.bus = m_bus;
+  status.bus_width = m_bus == SD_BUS_SDMMC ? SD_MMC_BUS_WIDTH : 1;
   status.write_errors = m_write_errors;
   status.read_errors = m_read_errors;
   status.last_write_ms = m_last_write_ms;
 
+  if (m_log_lock) xSemaphoreTake(m_log_lock, portMAX_DELAY);
+  status.witness_count = m_counts.witness_count;
+  int64_t space = m_space_witness;
+  status.bytes_appended = m_witness_io.appended;
+  status.bytes_written = m_witness_io.written;
+  status.syncs = m_witness_io.syncs;
+  status.checkpoints = m_ckpt_count;
+  status.checkpoint_seq = m_ckpt_latest.magic ? m_ckpt_latest.seq : 0;
+  if (m_log_lock) xSemaphoreGive(m_log_lock);
+  if (m_health_lock) xSemaphoreTake(m_health_lock, portMAX_DELAY);
+  status.health_count = m_counts.health_count + m_counts.health_old;
+  space += m_space_health;
+  status.bytes_appended += m_health_io.appended;
+  status.bytes_written += m_health_io.written;
+  status.syncs += m_health_io.syncs;
+  if (m_health_lock) xSemaphoreGive(m_health_lock);
+  if (status.bytes_appended > 0) {
+    uint64_t amp = status.bytes_written * 100 / status.bytes_appended;
+    status.write_amp_x100 = amp > UINT16_MAX ? UINT16_MAX : (uint16_t)amp;
+  }
+
+  // Acks live in the RAM ring; persisted entries carry no ack state
+  status.unacked_count = witness_get_health().logs_unacked;
+
+  status.pruned_segments = m_retain.pruned;
+  status.scrub_passes = m_scrub.passes;
+  status.scrub_records = m_scrub.records;
+  status.scrub_regions = m_scrub.regions;
+  status.scrub_pending = m_scrub.queue_count;
+  if (m_scrub.read_ms > 0) status.scrub_kb_s = (uint32_t)(m_scrub.bytes / m_scrub.read_ms);
+
   if (m_mounted) {
-    status.total_bytes = SD.totalBytes();
-    status.used_bytes = SD.usedBytes();
-    status.free_bytes = status.total_bytes - status.used_bytes;
+    int64_t used = (int64_t)m_used_bytes + space;
+    if (used < 0) used = 0;
+    if ((uint64_t)used > m_total_bytes) used = m_total_bytes;
+    status.total_bytes = m_total_bytes;
+    status.used_bytes = used;
+    status.free_bytes = m_total_bytes - used;
   }
 
   return status;
@@ -89,18 +239,1331 @@ SDStatus StorageManager::getStatus() {
 
 bool StorageManager::fileExists(const char* path) {
   if (!m_mounted) return false;
-  return SD.exists(path);
+  return s_fs->exists(path);
 }
 
 size_t StorageManager::fileSize(const char* path) {
   if (!m_mounted) return 0;
-  File f = SD.open(path, FILE_READ);
+  File f = s_fs->open(path, FILE_READ);
   if (!f) return 0;
   size_t sz = f.size();
   f.close();
   return sz;
 }
 
+// Account one write of len bytes at offset: the card programs every sector
+// it touches, and the flush that follows commits the FAT and directory entry.
+void StorageManager::countWrite(WriteStats& io, uint32_t offset, size_t len) {
+  uint32_t first = offset / SD_SECTOR_SIZE;
+  uint32_t last = (offset + len + SD_SECTOR_SIZE - 1) / SD_SECTOR_SIZE;
+  io.written += (uint64_t)(last - first) * SD_SECTOR_SIZE;
+  io.syncs++;
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// WITNESS LOG
+// ════════════════════════════════════════════════════════════════════════════
+
+static uint32_t witness_log_crc(const WitnessLogHeader& hdr, const uint8_t* payload) {
+  WitnessLogHeader tmp = hdr;
+  tmp.crc = 0;
+  uint32_t crc = esp_rom_crc32_le(0, (const uint8_t*)&tmp, sizeof(tmp));
+  if (hdr.payload_len > 0) {
+    crc = esp_rom_crc32_le(crc, payload, hdr.payload_len);
+  }
+  return crc;
+}
+
+static inline uint32_t index_slot(uint32_t seq) {
+  return (seq % WITNESS_SEGMENT_RECORDS) / WITNESS_INDEX_STRIDE;
+}
+
+void StorageManager::segmentPath(char* out, size_t cap, uint32_t segment, const char* ext) {
+  snprintf(out, cap, WITNESS_LOG_DIR "/%08X.%s", (unsigned)segment, ext);
+}
+
+void StorageManager::closeSegment() {
+  if (m_seg_file) writeWitnessBuffer();
+  if (m_seg_file) m_seg_file.close();
+  if (m_idx_file) m_idx_file.close();
+  m_active.loaded = false;
+  m_append_off = 0;
+  m_wbuf_base = m_wbuf_len = m_wbuf_clean = 0;
+  m_idx_pending_count = 0;
+  m_ckpt_pending_valid = false;
+}
+
+// Point the write-back buffer at the aligned unit holding m_append_off. The
+// bytes already in that unit are read back so it can be written whole.
+void StorageManager::loadWriteBuffer() {
+  m_wbuf_base = m_append_off & ~(uint32_t)(SD_WRITE_BUFFER_BYTES - 1);
+  m_wbuf_len = m_append_off - m_wbuf_base;
+  if (m_wbuf_len > 0 &&
+      (!m_seg_file.seek(m_wbuf_base) || m_seg_file.read(m_wbuf, m_wbuf_len) != m_wbuf_len)) {
+    // Unaligned from here on, but still correct
+    m_read_errors++;
+    m_wbuf_base = m_append_off;
+    m_wbuf_len = 0;
+  }
+  m_wbuf_clean = m_wbuf_len;
+}
+
+// Write the unwritten part of the buffer, then the index entries for it.
+// A full buffer moves on to the next unit. Caller holds m_log_lock.
+bool StorageManager::writeWitnessBuffer() {
+  if (m_wbuf_clean == m_wbuf_len && m_idx_pending_count == 0 && !m_ckpt_pending_valid) return true;
+
+  if (m_wbuf_clean < m_wbuf_len) {
+    uint32_t from = m_wbuf_clean & ~(uint32_t)(SD_SECTOR_SIZE - 1);
+    size_t len = m_wbuf_len - from;
+    bool ok = m_seg_file.seek(m_wbuf_base + from) &&
+              m_seg_file.write(m_wbuf + from, len) == len;
+    m_seg_file.flush();
+    countWrite(m_witness_io, m_wbuf_base + from, len);
+
+    if (!ok) {
+      // Kept in RAM and retried; a torn tail on the card is rewritten with it
+      m_write_errors++;
+      return false;
+    }
+    m_wbuf_clean = m_wbuf_len;
+    m_last_write_ms = millis();
+  }
+
+  // Index after data so a crash never leaves an entry pointing at nothing
+  if (m_idx_pending_count > 0) {
+    size_t len = m_idx_pending_count * sizeof(WitnessIndexEntry);
+    m_idx_file.write((const uint8_t*)m_idx_pending, len);
+    m_idx_file.flush();
+    countWrite(m_witness_io, 0, len);
+    m_witness_bytes += len;
+    m_space_witness += len;
+    m_idx_pending_count = 0;
+  }
+  if (m_ckpt_pending_valid) writeCheckpointEntry();
+
+  if (m_wbuf_len == SD_WRITE_BUFFER_BYTES) {
+    m_wbuf_base += SD_WRITE_BUFFER_BYTES;
+    m_wbuf_len = m_wbuf_clean = 0;
+  }
+  return true;
+}
+
+// Read and validate one record. Returns false at end of data or on a torn/corrupt entry.
+bool StorageManager::readHeaderAt(File& f, uint32_t offset, WitnessLogHeader* hdr,
+                                  uint8_t* payload, size_t cap) {
+  if (!f.seek(offset)) return false;
+  if (f.read((uint8_t*)hdr, sizeof(*hdr)) != sizeof(*hdr)) return false;
+  if (hdr->magic != WITNESS_LOG_MAGIC || hdr->payload_len > WITNESS_MAX_PAYLOAD) return false;
+
+  uint8_t buf[WITNESS_MAX_PAYLOAD];
+  if (hdr->payload_len > 0 && f.read(buf, hdr->payload_len) != hdr->payload_len) return false;
+  if (witness_log_crc(*hdr, buf) != hdr->crc) return false;
+
+  if (payload) {
+    if (hdr->payload_len > cap) return false;
+    memcpy(payload, buf, hdr->payload_len);
+  }
+  return true;
+}
+
+bool StorageManager::loadIndex(uint32_t segment, SegmentIndex* idx) {
+  idx->segment = segment;
+  idx->loaded = true;
+  for (size_t i = 0; i < INDEX_SLOTS; i++) idx->offsets[i] = UINT32_MAX;
+
+  char path[32];
+  segmentPath(path, sizeof(path), segment, "IDX");
+  if (s_fs->exists(path)) {
+    File f = s_fs->open(path, FILE_READ);
+    if (!f) return false;
+    WitnessIndexEntry e;
+    while (f.read((uint8_t*)&e, sizeof(e)) == sizeof(e)) {
+      if (e.seq / WITNESS_SEGMENT_RECORDS != segment) continue;
+      uint32_t slot = index_slot(e.seq);
+      if (idx->offsets[slot] == UINT32_MAX) idx->offsets[slot] = e.offset;
+    }
+    f.close();
+    return true;
+  }
+
+  // No index file: rebuild in memory from the segment itself
+  segmentPath(path, sizeof(path), segment, "WIT");
+  if (!s_fs->exists(path)) return true;
+  File f = s_fs->open(path, FILE_READ);
+  if (!f) return false;
+  WitnessLogHeader hdr;
+  uint32_t off = 0;
+  while (readHeaderAt(f, off, &hdr, nullptr, 0)) {
+    uint32_t slot = index_slot(hdr.seq);
+    if (idx->offsets[slot] == UINT32_MAX) idx->offsets[slot] = off;
+    off += sizeof(hdr) + hdr.payload_len;
+  }
+  f.close();
+  return true;
+}
+
+// Find the valid end of the active segment and repair index entries lost to a
+// crash between the data write and the index write.
+bool StorageManager::recoverTail(uint32_t segment) {
+  uint32_t off = 0;
+  for (size_t i = INDEX_SLOTS; i-- > 0;) {
+    if (m_active.offsets[i] != UINT32_MAX) {
+      off = m_active.offsets[i];
+      break;
+    }
+  }
+
+  WitnessLogHeader hdr;
+  while (readHeaderAt(m_seg_file, off, &hdr, nullptr, 0)) {
+    if (hdr.seq / WITNESS_SEGMENT_RECORDS != segment) break;
+    uint32_t slot = index_slot(hdr.seq);
+    if (m_active.offsets[slot] == UINT32_MAX) {
+      m_active.offsets[slot] = off;
+      WitnessIndexEntry e = { hdr.seq, off };
+      m_idx_file.write((const uint8_t*)&e, sizeof(e));
+    }
+    if (hdr.seq > m_last_seq) m_last_seq = hdr.seq;
+    off += sizeof(hdr) + hdr.payload_len;
+  }
+  m_idx_file.flush();
+
+  // Anything past here is a torn write and gets overwritten by the next append
+  m_append_off = off;
+  return true;
+}
+
+bool StorageManager::openSegmentForAppend(uint32_t segment) {
+  closeSegment();
+
+  char wit[32], idx[32];
+  segmentPath(wit, sizeof(wit), segment, "WIT");
+  segmentPath(idx, sizeof(idx), segment, "IDX");
+
+  if (!s_fs->exists(WITNESS_LOG_DIR)) s_fs->mkdir(WITNESS_LOG_DIR);
+  if (!s_fs->exists(wit)) {
+    File f = s_fs->open(wit, FILE_WRITE);
+    if (!f) return false;
+    f.close();
+    if (m_counts.witness_first == UINT32_MAX || segment < m_counts.witness_first) {
+      m_counts.witness_first = segment;
+    }
+  }
+
+  m_seg_file = s_fs->open(wit, "r+");
+  m_idx_file = s_fs->open(idx, FILE_APPEND);
+  if (!m_seg_file || !m_idx_file) {
+    closeSegment();
+    return false;
+  }
+
+  if (!loadIndex(segment, &m_active)) {
+    closeSegment();
+    return false;
+  }
+  recoverTail(segment);
+  loadWriteBuffer();
+  return true;
+}
+
+bool StorageManager::appendWitness(uint32_t seq, uint32_t time_bucket, uint8_t record_type,
+                                   uint8_t flags, uint8_t batch_size, uint8_t leaf_index,
+                                   const uint8_t* chain_hash, const uint8_t* signature,
+                                   const uint8_t* payload, size_t payload_len,
+                                   SDDurability durability) {
+  if (!m_mounted || !m_log_lock || payload_len > WITNESS_MAX_PAYLOAD) return false;
+
+  WitnessLogHeader hdr;
+  memset(&hdr, 0, sizeof(hdr));
+  hdr.magic = WITNESS_LOG_MAGIC;
+  hdr.seq = seq;
+  hdr.time_bucket = time_bucket;
+  hdr.record_type = record_type;
+  hdr.flags = flags;
+  hdr.payload_len = (uint16_t)payload_len;
+  hdr.batch_size = batch_size;
+  hdr.leaf_index = leaf_index;
+  memcpy(hdr.chain_hash, chain_hash, 32);
+  memcpy(hdr.signature, signature, 64);
+  hdr.crc = witness_log_crc(hdr, payload);
+
+  xSemaphoreTake(m_log_lock, portMAX_DELAY);
+
+  uint32_t segment = seq / WITNESS_SEGMENT_RECORDS;
+  if (!m_active.loaded || m_active.segment != segment) {
+    if (!openSegmentForAppend(segment)) {
+      m_write_errors++;
+      xSemaphoreGive(m_log_lock);
+      return false;
+    }
+  }
+
+  // Append-only: never rewrite an existing sequence number
+  if (m_last_seq != 0 && seq <= m_last_seq) {
+    xSemaphoreGive(m_log_lock);
+    return false;
+  }
+
+  // Copy into the write-back buffer; a record that crosses the end of the
+  // buffer is split and the full unit written first
+  const uint8_t* parts[2] = { (const uint8_t*)&hdr, payload };
+  size_t sizes[2] = { sizeof(hdr), payload_len };
+  uint32_t start_len = m_wbuf_len;
+  bool was_clean = m_wbuf_clean == m_wbuf_len;
+  for (int p = 0; p < 2; p++) {
+    size_t done = 0;
+    while (done < sizes[p]) {
+      if (m_wbuf_len == SD_WRITE_BUFFER_BYTES && !writeWitnessBuffer()) {
+        // Nothing has moved on yet, so the partial copy can be dropped
+        m_wbuf_len = start_len;
+        xSemaphoreGive(m_log_lock);
+        return false;
+      }
+      size_t n = sizes[p] - done;
+      if (n > SD_WRITE_BUFFER_BYTES - m_wbuf_len) n = SD_WRITE_BUFFER_BYTES - m_wbuf_len;
+      memcpy(m_wbuf + m_wbuf_len, parts[p] + done, n);
+      m_wbuf_len += n;
+      done += n;
+    }
+  }
+  if (was_clean) m_wbuf_ms = millis();
+  m_witness_io.appended += sizeof(hdr) + payload_len;
+  m_witness_bytes += sizeof(hdr) + payload_len;
+  m_space_witness += sizeof(hdr) + payload_len;
+
+  uint32_t slot = index_slot(seq);
+  if (m_active.offsets[slot] == UINT32_MAX) {
+    m_active.offsets[slot] = m_append_off;
+    // If writes keep failing the entry is left to recoverTail() on next open
+    if (m_idx_pending_count < sizeof(m_idx_pending) / sizeof(m_idx_pending[0])) {
+      m_idx_pending[m_idx_pending_count++] = { seq, m_append_off };
+    }
+  }
+  if (m_cached.loaded && m_cached.segment == segment) {
+    m_cached.offsets[slot] = m_active.offsets[slot];
+  }
+
+  m_counts.witness_count++;
+  m_counts.witness_seq = seq;
+  m_counts.witness_off = m_append_off;
+  m_counts_dirty = true;
+
+  // Checkpoints go straight to the card so their index entry can follow
+  if (record_type == RECORD_CHECKPOINT) {
+    m_ckpt_pending.magic = WITNESS_CHECKPOINT_MAGIC;
+    m_ckpt_pending.seq = seq;
+    memcpy(m_ckpt_pending.chain_hash, chain_hash, 32);
+    m_ckpt_pending.crc = esp_rom_crc32_le(0, (const uint8_t*)&m_ckpt_pending,
+                                          offsetof(WitnessCheckpointEntry, crc));
+    m_ckpt_pending_valid = true;
+    durability = SD_DURABLE_NOW;
+  }
+
+  m_append_off += sizeof(hdr) + payload_len;
+  m_last_seq = seq;
+
+  // A failed write stays buffered and is retried with the next one
+  bool ok = true;
+  if (durability == SD_DURABLE_NOW || m_wbuf_len == SD_WRITE_BUFFER_BYTES) {
+    ok = writeWitnessBuffer() || durability != SD_DURABLE_NOW;
+  }
+
+  xSemaphoreGive(m_log_lock);
+  return ok;
+}
+
+// ─── Checkpoint index ─────────────────────────────────────────────────────
+//
+// CHECKPT.IDX is an array of WitnessCheckpointEntry. Entries are written at
+// m_ckpt_count * entry size, so a torn entry at the end is overwritten by
+// the next one rather than shifting everything after it.
+
+static bool checkpoint_entry_valid(const WitnessCheckpointEntry& e) {
+  return e.magic == WITNESS_CHECKPOINT_MAGIC &&
+         e.crc == esp_rom_crc32_le(0, (const uint8_t*)&e, offsetof(WitnessCheckpointEntry, crc));
+}
+
+// Caller holds m_log_lock
+void StorageManager::loadCheckpoints() {
+  memset(&m_ckpt_latest, 0, sizeof(m_ckpt_latest));
+  m_ckpt_count = 0;
+  m_ckpt_pending_valid = false;
+
+  File f = s_fs->open(WITNESS_CHECKPOINT_INDEX, FILE_READ);
+  if (!f) return;
+  m_ckpt_count = f.size() / sizeof(WitnessCheckpointEntry);
+
+  // Newest valid entry; normally the last one
+  for (uint32_t i = m_ckpt_count; i-- > 0;) {
+    WitnessCheckpointEntry e;
+    if (f.seek(i * sizeof(e)) && f.read((uint8_t*)&e, sizeof(e)) == sizeof(e) &&
+        checkpoint_entry_valid(e)) {
+      m_ckpt_latest = e;
+      break;
+    }
+    m_read_errors++;
+  }
+  f.close();
+}
+
+// Called from writeWitnessBuffer() once the checkpoint's record is written
+void StorageManager::writeCheckpointEntry() {
+  m_ckpt_pending_valid = false;
+
+  if (!s_fs->exists(WITNESS_CHECKPOINT_INDEX)) {
+    File f = s_fs->open(WITNESS_CHECKPOINT_INDEX, FILE_WRITE);
+    if (f) f.close();
+  }
+  File f = s_fs->open(WITNESS_CHECKPOINT_INDEX, "r+");
+  uint32_t off = m_ckpt_count * sizeof(WitnessCheckpointEntry);
+  bool ok = f && f.seek(off) &&
+            f.write((const uint8_t*)&m_ckpt_pending, sizeof(m_ckpt_pending)) == sizeof(m_ckpt_pending);
+  if (f) {
+    f.flush();
+    f.close();
+  }
+  countWrite(m_witness_io, off, sizeof(m_ckpt_pending));
+
+  if (!ok) {
+    // The next checkpoint is indexed instead; checks start one earlier
+    m_write_errors++;
+    return;
+  }
+  m_witness_bytes += sizeof(m_ckpt_pending);
+  m_space_witness += sizeof(m_ckpt_pending);
+  m_ckpt_latest = m_ckpt_pending;
+  m_ckpt_count++;
+}
+
+bool StorageManager::latestCheckpoint(WitnessCheckpointEntry* out) {
+  if (!m_mounted || !m_log_lock) return false;
+  xSemaphoreTake(m_log_lock, portMAX_DELAY);
+  bool ok = m_ckpt_latest.magic == WITNESS_CHECKPOINT_MAGIC &&
+            (m_counts.witness_first == UINT32_MAX ||
+             m_ckpt_latest.seq / WITNESS_SEGMENT_RECORDS >= m_counts.witness_first);
+  if (ok) *out = m_ckpt_latest;
+  xSemaphoreGive(m_log_lock);
+  return ok;
+}
+
+bool StorageManager::flushWitness() {
+  if (!m_log_lock) return false;
+  xSemaphoreTake(m_log_lock, portMAX_DELAY);
+  bool ok = !m_seg_file || writeWitnessBuffer();
+  xSemaphoreGive(m_log_lock);
+  return ok;
+}
+
+// Offset of the first indexed record at or after from_slot in a segment
+bool StorageManager::indexLookup(uint32_t segment, uint32_t from_slot, uint32_t* offset) {
+  xSemaphoreTake(m_log_lock, portMAX_DELAY);
+
+  // Readers open their own handle, so buffered records must be on the card
+  if (m_active.loaded && m_active.segment == segment) writeWitnessBuffer();
+
+  const SegmentIndex* idx = nullptr;
+  if (m_active.loaded && m_active.segment == segment) {
+    idx = &m_active;
+  } else {
+    if (!m_cached.loaded || m_cached.segment != segment) {
+      if (!loadIndex(segment, &m_cached)) {
+        m_cached.loaded = false;
+        m_read_errors++;
+        xSemaphoreGive(m_log_lock);
+        return false;
+      }
+    }
+    idx = &m_cached;
+  }
+
+  bool found = false;
+  for (uint32_t i = from_slot; i < INDEX_SLOTS; i++) {
+    if (idx->offsets[i] != UINT32_MAX) {
+      *offset = idx->offsets[i];
+      found = true;
+      break;
+    }
+  }
+
+  xSemaphoreGive(m_log_lock);
+  return found;
+}
+
+bool StorageManager::readWitness(uint32_t seq, WitnessLogHeader* hdr,
+                                 uint8_t* payload, size_t payload_cap) {
+  if (!m_mounted || !m_log_lock) return false;
+
+  uint32_t segment = seq / WITNESS_SEGMENT_RECORDS;
+  uint32_t off;
+  if (!indexLookup(segment, index_slot(seq), &off)) return false;
+
+  char path[32];
+  segmentPath(path, sizeof(path), segment, "WIT");
+  File f = s_fs->open(path, FILE_READ);
+  if (!f) {
+    m_read_errors++;
+    return false;
+  }
+
+  // At most one stride of header hops from the indexed entry
+  bool found = false;
+  for (uint32_t i = 0; i < WITNESS_INDEX_STRIDE; i++) {
+    if (!readHeaderAt(f, off, hdr, payload, payload_cap)) break;
+    if (hdr->seq == seq) {
+      found = true;
+      break;
+    }
+    if (hdr->seq > seq) break;
+    off += sizeof(*hdr) + hdr->payload_len;
+  }
+
+  f.close();
+  return found;
+}
+
+uint32_t StorageManager::exportWitness(uint32_t start_seq, uint32_t end_seq,
+                                       WitnessLogCallback cb, void* ctx, uint32_t limit) {
+  if (!m_mounted || !m_log_lock || !cb) return 0;
+
+  uint32_t count = 0;
+  uint32_t last_segment = (end_seq ? end_seq : m_last_seq) / WITNESS_SEGMENT_RECORDS;
+  uint8_t payload[WITNESS_MAX_PAYLOAD];
+
+  for (uint32_t segment = start_seq / WITNESS_SEGMENT_RECORDS; ; segment++) {
+    char path[32];
+    segmentPath(path, sizeof(path), segment, "WIT");
+    if (!s_fs->exists(path)) {
+      if (segment >= last_segment) break;
+      continue;  // Gap (e.g. card absent for a whole segment)
+    }
+
+    uint32_t from_slot = (segment == start_seq / WITNESS_SEGMENT_RECORDS) ? index_slot(start_seq) : 0;
+    uint32_t off;
+    if (indexLookup(segment, from_slot, &off)) {
+      File f = s_fs->open(path, FILE_READ);
+      if (!f) {
+        m_read_errors++;
+        break;
+      }
+
+      WitnessLogHeader hdr;
+      while (readHeaderAt(f, off, &hdr, payload, sizeof(payload))) {
+        off += sizeof(hdr) + hdr.payload_len;
+        if (hdr.seq < start_seq) continue;
+        if (end_seq && hdr.seq > end_seq) {
+          f.close();
+          return count;
+        }
+        count++;
+        if (!cb(hdr, payload, ctx) || (limit && count >= limit)) {
+          f.close();
+          return count;
+        }
+      }
+      f.close();
+    }
+
+    if (end_seq && segment >= last_segment) break;
+  }
+
+  return count;
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// HEALTH LOG
+// ════════════════════════════════════════════════════════════════════════════
+
+static uint32_t health_sector_crc(const HealthLogSector& sec) {
+  return esp_rom_crc32_le(0, (const uint8_t*)&sec, offsetof(HealthLogSector, crc));
+}
+
+static bool health_sector_valid(const HealthLogSector& sec) {
+  return sec.magic == HEALTH_LOG_SECTOR_MAGIC && sec.version == HEALTH_LOG_SECTOR_VERSION &&
+         sec.count >= 1 && sec.count <= HEALTH_LOG_SECTOR_RECORDS &&
+         health_sector_crc(sec) == sec.crc;
+}
+
+static void health_sink_output(const LogSinkEntry& entry, void* ctx) {
+  ((StorageManager*)ctx)->appendHealth(entry);
+}
+
+bool StorageManager::openHealthFile() {
+  if (!s_fs->exists(HEALTH_LOG_PATH)) {
+    File f = s_fs->open(HEALTH_LOG_PATH, FILE_WRITE);
+    if (!f) return false;
+    f.close();
+  }
+  m_health_file = s_fs->open(HEALTH_LOG_PATH, "r+");
+  m_health_off = 0;
+  return (bool)m_health_file;
+}
+
+// Find the end of valid data and replay the last HEALTH_STORE_RECOVER
+// entries into the RAM ring. Returns the number restored.
+uint32_t StorageManager::recoverHealthTail() {
+  HealthLogSector& sec = m_health_batch[0];   // Batch is empty until begin returns
+  uint32_t sectors = m_health_file.size() / HEALTH_LOG_SECTOR_SIZE;
+
+  // A torn final write damages at most the last batch (a partial sector is
+  // already dropped by the division above). Deeper damage is left in place
+  // and appended after rather than overwritten.
+  uint32_t end = sectors;
+  while (end > 0 && sectors - end < HEALTH_STORE_BATCH_SECTORS) {
+    if (m_health_file.seek((end - 1) * HEALTH_LOG_SECTOR_SIZE) &&
+        m_health_file.read((uint8_t*)&sec, sizeof(sec)) == sizeof(sec) &&
+        health_sector_valid(sec)) {
+      break;
+    }
+    end--;
+  }
+  if (end > 0 && sectors - end >= HEALTH_STORE_BATCH_SECTORS) end = sectors;
+  m_health_off = end * HEALTH_LOG_SECTOR_SIZE;
+
+  // Walk back to the sector holding the first entry to restore
+  uint32_t start = end;
+  uint32_t wanted = 0;
+  while (start > 0 && wanted < HEALTH_STORE_RECOVER) {
+    if (!m_health_file.seek((start - 1) * HEALTH_LOG_SECTOR_SIZE) ||
+        m_health_file.read((uint8_t*)&sec, sizeof(sec)) != sizeof(sec)) {
+      break;
+    }
+    start--;
+    if (health_sector_valid(sec)) wanted += sec.count;
+  }
+  uint32_t skip = wanted > HEALTH_STORE_RECOVER ? wanted - HEALTH_STORE_RECOVER : 0;
+
+  uint32_t restored = 0;
+  for (uint32_t i = start; i < end; i++) {
+    if (!m_health_file.seek(i * HEALTH_LOG_SECTOR_SIZE) ||
+        m_health_file.read((uint8_t*)&sec, sizeof(sec)) != sizeof(sec)) {
+      m_read_errors++;
+      break;
+    }
+    if (!health_sector_valid(sec)) continue;   // Corrupt in the middle: skip it
+
+    for (uint8_t r = 0; r < sec.count; r++) {
+      if (skip > 0) {
+        skip--;
+        continue;
+      }
+      const HealthLogRecord& rec = sec.records[r];
+      char msg[sizeof(rec.text) + 1], detail[sizeof(rec.text) + 1];
+      size_t ml = rec.msg_len < sizeof(rec.text) ? rec.msg_len : sizeof(rec.text);
+      size_t dl = rec.detail_len < sizeof(rec.text) - ml ? rec.detail_len : sizeof(rec.text) - ml;
+      memcpy(msg, rec.text, ml);
+      msg[ml] = '\0';
+      memcpy(detail, rec.text + ml, dl);
+      detail[dl] = '\0';
+      witness_restore_health_log(rec.seq, rec.timestamp_ms, (LogLevel)rec.level,
+                                 (LogCategory)rec.category, msg, detail);
+      restored++;
+    }
+  }
+
+  memset(&sec, 0, sizeof(sec));
+  return restored;
+}
+
+bool StorageManager::beginHealthLog() {
+  if (!m_mounted) return false;
+  if (!m_health_lock) m_health_lock = xSemaphoreCreateMutex();
+  if (!m_health_lock) return false;
+
+  xSemaphoreTake(m_health_lock, portMAX_DELAY);
+  if (m_health_file) m_health_file.close();
+  bool ok = openHealthFile();
+  m_health_old_bytes = fileSize(HEALTH_LOG_OLD_PATH);
+  uint32_t restored = ok ? recoverHealthTail() : 0;
+  if (ok) reconcileHealthCounts();
+  if (m_health_old_bytes == 0) m_counts.health_old = 0;   // Pruned before a checkpoint
+  m_health_sector = 0;
+  xSemaphoreGive(m_health_lock);
+
+  if (!ok) {
+    m_write_errors++;
+    return false;
+  }
+  saveCounts();
+  if (restored > 0) {
+    Serial.printf("[OK] Health log: %u entries recovered from SD\n", (unsigned)restored);
+  }
+  return log_sink_add(health_sink_output, this, LOG_LEVEL_INFO);
+}
+
+// Write every filled sector of the batch at m_health_off. Caller holds the lock.
+bool StorageManager::writeHealthBatch() {
+  uint8_t used = m_health_sector + (m_health_batch[m_health_sector].count > 0 ? 1 : 0);
+  if (used == 0) return true;
+
+  // Roll over to a fresh generation rather than growing without bound
+  size_t bytes = (size_t)used * HEALTH_LOG_SECTOR_SIZE;
+  if (m_health_off + bytes > HEALTH_LOG_MAX_BYTES) {
+    m_health_file.close();
+    if (s_fs->remove(HEALTH_LOG_OLD_PATH)) m_space_health -= m_health_old_bytes;
+    s_fs->rename(HEALTH_LOG_PATH, HEALTH_LOG_OLD_PATH);
+    m_health_old_bytes = m_health_off;
+    m_health_gen++;
+    openHealthFile();
+    m_counts.health_old = m_counts.health_count;
+    m_counts.health_count = 0;
+    m_counts.health_seq = 0;
+    m_counts.health_end = 0;
+    m_counts_dirty = true;
+  }
+
+  uint32_t entries = 0;
+  for (uint8_t i = 0; i < used; i++) {
+    HealthLogSector& sec = m_health_batch[i];
+    sec.magic = HEALTH_LOG_SECTOR_MAGIC;
+    sec.version = HEALTH_LOG_SECTOR_VERSION;
+    sec.crc = health_sector_crc(sec);
+    entries += sec.count;
+  }
+
+  bool ok = m_health_file && m_health_file.seek(m_health_off) &&
+            m_health_file.write((const uint8_t*)m_health_batch, bytes) == bytes;
+  m_health_file.flush();
+  m_health_io.appended += (uint64_t)entries * sizeof(HealthLogRecord);
+  countWrite(m_health_io, m_health_off, bytes);
+
+  if (ok) {
+    const HealthLogSector& last = m_health_batch[used - 1];
+    m_health_off += bytes;
+    m_space_health += bytes;
+    m_health_persisted += entries;
+    m_last_write_ms = millis();
+    m_counts.health_count += entries;
+    m_counts.health_seq = last.records[last.count - 1].seq;
+    m_counts.health_end = m_health_off;
+    m_counts_dirty = true;
+  } else {
+    // The torn tail is overwritten by the next batch at the same offset
+    m_write_errors++;
+  }
+
+  memset(m_health_batch, 0, bytes);
+  m_health_sector = 0;
+  return ok;
+}
+
+void StorageManager::appendHealth(const LogSinkEntry& entry) {
+  if (!m_health_lock) return;
+  xSemaphoreTake(m_health_lock, portMAX_DELAY);
+
+  if (m_health_batch[m_health_sector].count == HEALTH_LOG_SECTOR_RECORDS) {
+    m_health_sector++;
+  }
+
+  HealthLogSector& sec = m_health_batch[m_health_sector];
+  if (m_health_sector == 0 && sec.count == 0) m_health_batch_ms = millis();
+  if (sec.count == 0) sec.first_seq = entry.seq;
+
+  HealthLogRecord& rec = sec.records[sec.count++];
+  rec.seq = entry.seq;
+  rec.timestamp_ms = entry.timestamp_ms;
+  rec.level = entry.level;
+  rec.category = entry.category;
+  rec.msg_len = entry.msg_len;
+  rec.detail_len = entry.detail_len;
+  memcpy(rec.text, entry.text, entry.msg_len + entry.detail_len);
+
+  bool full = m_health_sector == HEALTH_STORE_BATCH_SECTORS - 1 &&
+              sec.count == HEALTH_LOG_SECTOR_RECORDS;
+  if (full || entry.level >= HEALTH_STORE_FLUSH_LEVEL) {
+    writeHealthBatch();
+  }
+
+  xSemaphoreGive(m_health_lock);
+}
+
+bool StorageManager::flushHealth() {
+  if (!m_health_lock) return false;
+  xSemaphoreTake(m_health_lock, portMAX_DELAY);
+  bool ok = writeHealthBatch();
+  xSemaphoreGive(m_health_lock);
+  return ok;
+}
+
+uint32_t StorageManager::exportHealth(HealthLogCallback cb, void* ctx) {
+  if (!m_mounted || !m_health_lock || !cb) return 0;
+
+  // Entries appended during the export are left out
+  xSemaphoreTake(m_health_lock, portMAX_DELAY);
+  writeHealthBatch();
+  uint32_t current_end = m_health_off;
+  uint32_t gen0 = m_health_gen;
+  xSemaphoreGive(m_health_lock);
+
+  // The export pins generations gen0 - 1 (HEALTH.OLD) and gen0 (HEALTH.LOG)
+  // as they were at the start. A rollover meanwhile renames HEALTH.LOG to
+  // HEALTH.OLD and drops the older one, and retention may delete
+  // HEALTH.OLD, so every sector is read under the lock after checking
+  // which file (if any) still holds the pinned generation.
+  static const char* const PATHS[2] = { HEALTH_LOG_PATH, HEALTH_LOG_OLD_PATH };
+  uint32_t count = 0;
+  HealthLogSector sec;
+  for (uint32_t g = 0; g < 2; g++) {
+    uint32_t gen = gen0 - 1 + g;
+    uint32_t end = g == 1 ? current_end : UINT32_MAX;
+    uint32_t open_age = UINT32_MAX;
+    File f;
+    for (uint32_t off = 0; off + HEALTH_LOG_SECTOR_SIZE <= end; off += HEALTH_LOG_SECTOR_SIZE) {
+      xSemaphoreTake(m_health_lock, portMAX_DELAY);
+      uint32_t age = m_health_gen - gen;   // 0 = HEALTH.LOG, 1 = HEALTH.OLD
+      bool live = age == 0 || (age == 1 && m_health_old_bytes > 0);
+      if (live && age != open_age) {
+        if (f) f.close();
+        f = s_fs->open(PATHS[age], FILE_READ);
+        open_age = age;
+        if (f && end == UINT32_MAX) end = f.size();
+      }
+      bool ok = live && f && off + HEALTH_LOG_SECTOR_SIZE <= end && f.seek(off) &&
+                f.read((uint8_t*)&sec, sizeof(sec)) == sizeof(sec);
+      xSemaphoreGive(m_health_lock);
+
+      if (!ok) {
+        if (live && f) m_read_errors++;
+        break;
+      }
+      if (!health_sector_valid(sec)) continue;
+      for (uint8_t r = 0; r < sec.count; r++) {
+        count++;
+        if (!cb(sec.records[r], ctx)) {
+          f.close();
+          return count;
+        }
+      }
+    }
+    if (f) f.close();
+  }
+  return count;
+}
+
+void StorageManager::poll(uint32_t now_ms) {
+  if (m_log_lock) {
+    xSemaphoreTake(m_log_lock, portMAX_DELAY);
+    if (m_seg_file && m_wbuf_clean < m_wbuf_len && now_ms - m_wbuf_ms >= WITNESS_FLUSH_MS) {
+      writeWitnessBuffer();
+    }
+    xSemaphoreGive(m_log_lock);
+  }
+
+  bool save_due = false;
+  if (m_health_lock) {
+    xSemaphoreTake(m_health_lock, portMAX_DELAY);
+    bool pending = m_health_sector > 0 || m_health_batch[0].count > 0;
+    if (pending && now_ms - m_health_batch_ms >= HEALTH_STORE_FLUSH_MS) {
+      writeHealthBatch();
+    }
+    // saveCounts() clears the flag and stamps the time under this lock
+    save_due = m_counts_dirty && now_ms - m_counts_saved_ms >= STORAGE_COUNTS_SAVE_MS;
+    xSemaphoreGive(m_health_lock);
+  }
+
+  if (save_due) {
+    checkpoint();
+  }
+  retentionStep(now_ms);
+  scrubStep(now_ms);
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// RETENTION
+// ════════════════════════════════════════════════════════════════════════════
+
+uint64_t StorageManager::spaceUsed() {
+  xSemaphoreTake(m_log_lock, portMAX_DELAY);
+  int64_t used = (int64_t)m_used_bytes + m_space_witness;
+  xSemaphoreGive(m_log_lock);
+  xSemaphoreTake(m_health_lock, portMAX_DELAY);
+  used += m_space_health;
+  xSemaphoreGive(m_health_lock);
+  return used < 0 ? 0 : (uint64_t)used;
+}
+
+// One bounded retention step. The oldest segment is closed and never
+// changes, so it is counted without the log lock, which is only held to
+// check the quotas and to delete.
+void StorageManager::retentionStep(uint32_t now_ms) {
+  if (!m_mounted || !m_log_lock || !m_health_lock) return;
+  if (now_ms - m_retain.last_ms < STORAGE_RETAIN_INTERVAL_MS) return;
+  m_retain.last_ms = now_ms;
+
+  uint64_t used = spaceUsed();
+  bool low_space = used + STORAGE_RETAIN_FREE_BYTES > m_total_bytes;
+
+  // Diagnostics are worth less than evidence
+  if (low_space) {
+    xSemaphoreTake(m_health_lock, portMAX_DELAY);
+    bool removed = m_health_old_bytes > 0 && s_fs->remove(HEALTH_LOG_OLD_PATH);
+    if (removed) {
+      m_space_health -= m_health_old_bytes;
+      m_health_old_bytes = 0;
+      m_counts.health_old = 0;
+      m_counts_dirty = true;
+    }
+    xSemaphoreGive(m_health_lock);
+    if (removed) return;
+  }
+
+  xSemaphoreTake(m_log_lock, portMAX_DELAY);
+  uint32_t segment = m_counts.witness_first;
+  uint32_t newest = m_last_seq / WITNESS_SEGMENT_RECORDS;
+  bool due = segment != UINT32_MAX && segment < newest &&
+             !(m_active.loaded && m_active.segment == segment) &&
+             (low_space ||
+              (STORAGE_RETAIN_MAX_BYTES > 0 && m_witness_bytes > STORAGE_RETAIN_MAX_BYTES) ||
+              (STORAGE_RETAIN_MAX_RECORDS > 0 &&
+               m_last_seq + 1 - (segment + 1) * WITNESS_SEGMENT_RECORDS >= STORAGE_RETAIN_MAX_RECORDS));
+  xSemaphoreGive(m_log_lock);
+
+  if (!due) {
+    m_retain.active = false;
+    return;
+  }
+  if (!m_retain.active || m_retain.segment != segment) {
+    m_retain.active = true;
+    m_retain.segment = segment;
+    m_retain.off = 0;
+    m_retain.records = 0;
+  }
+
+  char wit[32], idx[32];
+  segmentPath(wit, sizeof(wit), segment, "WIT");
+  segmentPath(idx, sizeof(idx), segment, "IDX");
+
+  // Count what the counters will lose, resuming where the last step stopped
+  File f = s_fs->open(wit, FILE_READ);
+  if (f) {
+    uint32_t start = millis();
+    WitnessLogHeader hdr;
+    bool more = true;
+    while (more && millis() - start < STORAGE_RETAIN_STEP_MS) {
+      more = readHeaderAt(f, m_retain.off, &hdr, nullptr, 0) &&
+             hdr.seq / WITNESS_SEGMENT_RECORDS == segment;
+      if (more) {
+        m_retain.records++;
+        m_retain.off += sizeof(hdr) + hdr.payload_len;
+      }
+    }
+    f.close();
+    if (more) return;
+  }
+
+  xSemaphoreTake(m_log_lock, portMAX_DELAY);
+  uint64_t freed = fileSize(wit) + fileSize(idx);
+  bool ok = !s_fs->exists(wit) || s_fs->remove(wit);
+  if (ok) {
+    s_fs->remove(idx);
+    m_witness_bytes = m_witness_bytes > freed ? m_witness_bytes - freed : 0;
+    m_space_witness -= freed;
+    m_counts.witness_count -= m_retain.records < m_counts.witness_count
+                              ? m_retain.records : m_counts.witness_count;
+    if (m_cached.loaded && m_cached.segment == segment) m_cached.loaded = false;
+
+    // Segments are normally contiguous; skip any gap up to the newest
+    uint32_t next = segment + 1;
+    while (next < newest) {
+      segmentPath(wit, sizeof(wit), next, "WIT");
+      if (s_fs->exists(wit)) break;
+      next++;
+    }
+    m_counts.witness_first = next;
+    m_counts_dirty = true;
+    m_retain.pruned++;
+  } else {
+    m_write_errors++;
+  }
+  m_retain.active = false;
+  xSemaphoreGive(m_log_lock);
+
+  // Checkpoint now; a checkpoint older than the prune is detected at boot
+  // by its witness_first and rebuilt
+  if (ok) saveCounts();
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// SCRUBBER
+// ════════════════════════════════════════════════════════════════════════════
+
+// Check the record at segment offset off, avail bytes of which are in p.
+// Returns the bytes consumed: the whole record if it is good, one byte
+// while looking for the next good record, or 0 if more data is needed.
+size_t StorageManager::scrubRecord(const uint8_t* p, size_t avail, uint32_t off, bool eof) {
+  WitnessLogHeader hdr;
+  size_t len = 0;
+  bool good = false;
+
+  if (avail >= sizeof(hdr)) {
+    memcpy(&hdr, p, sizeof(hdr));
+    good = hdr.magic == WITNESS_LOG_MAGIC && hdr.payload_len <= WITNESS_MAX_PAYLOAD;
+    len = sizeof(hdr) + hdr.payload_len;
+    if (good && avail < len) {
+      if (!eof) return 0;
+      good = false;
+    }
+  } else if (!eof) {
+    return 0;
+  }
+
+  good = good && witness_log_crc(hdr, p + sizeof(hdr)) == hdr.crc &&
+         hdr.seq / WITNESS_SEGMENT_RECORDS == m_scrub.segment && hdr.seq > m_scrub.prev_seq;
+  if (!good) {
+    if (!m_scrub.bad) {
+      m_scrub.bad = true;
+      m_scrub.bad_off = off;
+    }
+    // Nothing short of a header can be a record
+    return avail < sizeof(hdr) ? avail : 1;
+  }
+
+  if (m_scrub.bad) scrubFlag(off, hdr.seq);
+  m_scrub.prev_seq = hdr.seq;
+  m_scrub.records++;
+  return len;
+}
+
+// Close the open bad region at end_off and queue it for a chain check. A
+// full queue keeps the older regions; the new one is still counted.
+void StorageManager::scrubFlag(uint32_t end_off, uint32_t next_seq) {
+  m_scrub.bad = false;
+  m_scrub.regions++;
+  Serial.printf("[!!] SD scrub: segment %08X bytes %u-%u failed CRC\n",
+                (unsigned)m_scrub.segment, (unsigned)m_scrub.bad_off, (unsigned)end_off);
+
+  if (m_scrub.queue_count == STORAGE_SCRUB_REGIONS) return;
+  WitnessScrubRegion& r = m_scrub.queue[(m_scrub.queue_head + m_scrub.queue_count) % STORAGE_SCRUB_REGIONS];
+  r.segment = m_scrub.segment;
+  r.offset = m_scrub.bad_off;
+  r.bytes = end_off - m_scrub.bad_off;
+  r.prev_seq = m_scrub.prev_seq;
+  r.next_seq = next_seq;
+  m_scrub.queue_count++;
+}
+
+// One bounded scrub step: read and CRC-check as much of the current
+// segment as STORAGE_SCRUB_STEP_MS allows. Segments are read through their
+// own handle, so the log lock is only held to find where the log ends.
+void StorageManager::scrubStep(uint32_t now_ms) {
+  if (!m_mounted || !m_log_lock) return;
+  if (now_ms - m_scrub.last_ms < STORAGE_SCRUB_INTERVAL_MS) return;
+  if (!m_scrub.active && m_scrub.passes > 0 && now_ms - m_scrub.rest_ms < STORAGE_SCRUB_PASS_MS) return;
+  m_scrub.last_ms = now_ms;
+
+  xSemaphoreTake(m_log_lock, portMAX_DELAY);
+  uint32_t first = m_counts.witness_first;
+  uint32_t newest = m_last_seq / WITNESS_SEGMENT_RECORDS;
+  if (first != UINT32_MAX && (!m_scrub.active || m_scrub.segment < first)) {
+    // New pass, or retention pruned the segment being scrubbed
+    if (!m_scrub.active) {
+      m_scrub.prev_seq = 0;
+      m_scrub.records = 0;
+    }
+    m_scrub.active = true;
+    m_scrub.segment = first;
+    m_scrub.off = 0;
+    m_scrub.bad = false;
+  }
+  // Buffered records are not on the card yet
+  uint32_t limit = UINT32_MAX;
+  if (m_active.loaded && m_active.segment == m_scrub.segment) limit = m_wbuf_base + m_wbuf_clean;
+  xSemaphoreGive(m_log_lock);
+  if (!m_scrub.active) return;
+
+  char path[32];
+  segmentPath(path, sizeof(path), m_scrub.segment, "WIT");
+  bool done = true;
+  File f;
+  if (s_fs->exists(path)) f = s_fs->open(path, FILE_READ);
+  if (f) {
+    if (f.size() < limit) limit = f.size();
+    uint32_t start = millis();
+    uint32_t base = m_scrub.off;   // Segment offset of m_scrub_buf[0]
+    size_t have = 0;
+    bool eof = base >= limit;
+    if (!eof && !f.seek(base)) {
+      m_read_errors++;
+      eof = true;
+    }
+
+    while (millis() - start < STORAGE_SCRUB_STEP_MS) {
+      if (!eof) {
+        size_t want = sizeof(m_scrub_buf) - have;
+        if (want > limit - (base + have)) want = limit - (base + have);
+        size_t n = f.read(m_scrub_buf + have, want);
+        if (n < want) m_read_errors++;
+        have += n;
+        m_scrub.bytes += n;
+        eof = n < want || base + have >= limit;
+      }
+
+      size_t pos = 0, used;
+      while (pos < have && (used = scrubRecord(m_scrub_buf + pos, have - pos, base + pos, eof)) > 0) {
+        pos += used;
+      }
+      // A record cut by the end of the buffer is completed by the next read
+      memmove(m_scrub_buf, m_scrub_buf + pos, have - pos);
+      base += pos;
+      have -= pos;
+      if (eof && have == 0) break;
+    }
+    m_scrub.read_ms += millis() - start;
+    f.close();
+
+    // What is still buffered is read again by the next step
+    m_scrub.off = base;
+    done = eof && have == 0;
+  }
+  if (!done) return;
+
+  // A bad region reaching the end of the segment is a torn tail
+  if (m_scrub.bad) scrubFlag(m_scrub.off, 0);
+
+  uint32_t next = m_scrub.segment + 1;
+  while (next < newest) {
+    segmentPath(path, sizeof(path), next, "WIT");
+    if (s_fs->exists(path)) break;
+    next++;
+  }
+  if (m_scrub.segment >= newest) {
+    m_scrub.active = false;
+    m_scrub.passes++;
+    m_scrub.rest_ms = now_ms;
+    return;
+  }
+  m_scrub.segment = next;
+  m_scrub.off = 0;
+}
+
+bool StorageManager::takeScrubRegion(WitnessScrubRegion* out) {
+  if (m_scrub.queue_count == 0) return false;
+  *out = m_scrub.queue[m_scrub.queue_head];
+  m_scrub.queue_head = (m_scrub.queue_head + 1) % STORAGE_SCRUB_REGIONS;
+  m_scrub.queue_count--;
+  return true;
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// SD COUNTERS
+// ════════════════════════════════════════════════════════════════════════════
+
+static uint32_t counts_crc(const StorageCounts& c) {
+  return esp_rom_crc32_le(0, (const uint8_t*)&c, offsetof(StorageCounts, crc));
+}
+
+bool StorageManager::loadCounts() {
+  memset(&m_counts, 0, sizeof(m_counts));
+  File f = s_fs->open(STORAGE_COUNTS_PATH, FILE_READ);
+  if (!f) return false;
+
+  bool found = false;
+  StorageCounts slot;
+  for (int i = 0; i < 2 && f.read((uint8_t*)&slot, sizeof(slot)) == sizeof(slot); i++) {
+    if (slot.magic != STORAGE_COUNTS_MAGIC || counts_crc(slot) != slot.crc) continue;
+    if (!found || (int32_t)(slot.generation - m_counts.generation) > 0) {
+      m_counts = slot;
+      found = true;
+    }
+  }
+  f.close();
+  return found;
+}
+
+// Write the next slot. The other slot still holds the previous checkpoint,
+// so a torn write falls back one generation instead of to a full rescan.
+bool StorageManager::saveCounts() {
+  if (!m_mounted || !m_log_lock || !m_health_lock) return false;
+
+  // Health fields under the health lock, witness fields under the log lock;
+  // the dirty flag is set under either, so it is cleared under both
+  xSemaphoreTake(m_health_lock, portMAX_DELAY);
+  StorageCounts c = m_counts;
+  xSemaphoreTake(m_log_lock, portMAX_DELAY);
+  m_counts_dirty = false;
+  c.witness_count = m_counts.witness_count;
+  c.witness_seq = m_counts.witness_seq;
+  c.witness_off = m_counts.witness_off;
+  c.witness_first = m_counts.witness_first;
+  xSemaphoreGive(m_log_lock);
+
+  c.magic = STORAGE_COUNTS_MAGIC;
+  c.generation = m_counts.generation + 1;
+  c.crc = counts_crc(c);
+
+  if (!s_fs->exists(STORAGE_COUNTS_PATH)) {
+    File f = s_fs->open(STORAGE_COUNTS_PATH, FILE_WRITE);
+    if (f) f.close();
+  }
+  uint32_t off = (c.generation % 2) * sizeof(c);
+  File f = s_fs->open(STORAGE_COUNTS_PATH, "r+");
+  bool ok = f && f.seek(off) && f.write((const uint8_t*)&c, sizeof(c)) == sizeof(c);
+  if (f) f.close();
+  countWrite(m_health_io, off, sizeof(c));
+
+  if (ok) {
+    m_counts.generation = c.generation;
+    m_counts_saved_ms = millis();
+  } else {
+    m_write_errors++;
+    m_counts_dirty = true;
+  }
+  xSemaphoreGive(m_health_lock);
+  return ok;
+}
+
+bool StorageManager::checkpoint() {
+  // Counts may never run ahead of what is on the card
+  if (!flushWitness()) return false;
+  flushHealth();
+  return saveCounts();
+}
+
+// Count valid records in one segment from off on, advancing witness_seq
+uint32_t StorageManager::countSegment(File& f, uint32_t segment, uint32_t off) {
+  uint32_t count = 0;
+  WitnessLogHeader hdr;
+  while (readHeaderAt(f, off, &hdr, nullptr, 0) && hdr.seq / WITNESS_SEGMENT_RECORDS == segment) {
+    if (hdr.seq > m_counts.witness_seq) {
+      m_counts.witness_seq = hdr.seq;
+      m_counts.witness_off = off;
+    }
+    count++;
+    off += sizeof(hdr) + hdr.payload_len;
+  }
+  return count;
+}
+
+// Count witness records the checkpoint does not cover: those after its
+// last record, or all of them if that record is not where it says or a
+// segment was pruned after it was saved. Also totals the witness files for
+// retention. Caller holds m_log_lock.
+void StorageManager::reconcileWitnessCounts() {
+  bool delta = m_counts_valid && m_counts.witness_seq != 0;
+  uint32_t added;
+
+  for (;;) {
+    uint32_t from_seg = 0;
+    uint32_t from_off = 0;
+    if (delta) {
+      from_seg = m_counts.witness_seq / WITNESS_SEGMENT_RECORDS;
+      char path[32];
+      segmentPath(path, sizeof(path), from_seg, "WIT");
+      File f = s_fs->open(path, FILE_READ);
+      WitnessLogHeader hdr;
+      delta = f && readHeaderAt(f, m_counts.witness_off, &hdr, nullptr, 0) &&
+              hdr.seq == m_counts.witness_seq;
+      if (delta) from_off = m_counts.witness_off + sizeof(hdr) + hdr.payload_len;
+      if (f) f.close();
+    }
+    if (!delta) {
+      from_seg = 0;
+      m_counts.witness_count = 0;
+      m_counts.witness_seq = 0;
+      m_counts.witness_off = 0;
+    }
+
+    added = 0;
+    uint32_t first = UINT32_MAX;
+    uint64_t bytes = 0;
+    File dir = s_fs->open(WITNESS_LOG_DIR);
+    if (dir) {
+      for (File f = dir.openNextFile(); f; f = dir.openNextFile()) {
+        const char* name = strrchr(f.name(), '/');
+        name = name ? name + 1 : f.name();
+        char* ext;
+        uint32_t segment = strtoul(name, &ext, 16);
+        if (ext == name + 8 && strcmp(ext, ".IDX") == 0) {
+          bytes += f.size();
+        } else if (ext == name + 8 && strcmp(ext, ".WIT") == 0) {
+          bytes += f.size();
+          if (segment < first) first = segment;
+          if (segment >= from_seg) {
+            added += countSegment(f, segment, segment == from_seg ? from_off : 0);
+          }
+        }
+        f.close();
+      }
+      dir.close();
+    }
+
+    // Pruned after the checkpoint: its count still includes that segment
+    if (delta && first != UINT32_MAX && m_counts.witness_first != UINT32_MAX &&
+        first > m_counts.witness_first) {
+      delta = false;
+      continue;
+    }
+    m_counts.witness_count += added;
+    m_counts.witness_first = first;
+    m_witness_bytes = bytes;
+    break;
+  }
+
+  if (!delta) {
+    Serial.printf("[OK] SD counters rebuilt: %u witness records\n", (unsigned)m_counts.witness_count);
+  } else if (added > 0) {
+    Serial.printf("[OK] SD counters: %u witness records since last checkpoint\n", (unsigned)added);
+  }
+}
+
+uint32_t StorageManager::countHealthSectors(File& f, uint32_t from, uint32_t to, uint32_t* last_seq) {
+  HealthLogSector& sec = m_health_batch[0];   // Batch is empty until begin returns
+  uint32_t count = 0;
+  for (uint32_t i = from; i < to; i++) {
+    if (!f.seek(i * HEALTH_LOG_SECTOR_SIZE) || f.read((uint8_t*)&sec, sizeof(sec)) != sizeof(sec)) {
+      m_read_errors++;
+      break;
+    }
+    if (!health_sector_valid(sec)) continue;
+    count += sec.count;
+    *last_seq = sec.records[sec.count - 1].seq;
+  }
+  memset(&sec, 0, sizeof(sec));
+  return count;
+}
+
+// Count health log entries the checkpoint does not cover. Runs after
+// recoverHealthTail() has found m_health_off. Caller holds m_health_lock.
+void StorageManager::reconcileHealthCounts() {
+  HealthLogSector& sec = m_health_batch[0];
+  uint32_t end = m_health_off / HEALTH_LOG_SECTOR_SIZE;
+  uint32_t from = m_counts.health_end / HEALTH_LOG_SECTOR_SIZE;
+
+  // A rollover since the checkpoint shows up as a shorter file or a
+  // different entry in the checkpoint's last sector
+  bool delta = m_counts_valid && from <= end;
+  if (delta && from > 0) {
+    delta = m_health_file.seek((from - 1) * HEALTH_LOG_SECTOR_SIZE) &&
+            m_health_file.read((uint8_t*)&sec, sizeof(sec)) == sizeof(sec) &&
+            health_sector_valid(sec) && sec.records[sec.count - 1].seq == m_counts.health_seq;
+    memset(&sec, 0, sizeof(sec));
+  }
+  if (!delta) {
+    from = 0;
+    m_counts.health_count = 0;
+    m_counts.health_seq = 0;
+    m_counts.health_old = 0;
+    File old = s_fs->open(HEALTH_LOG_OLD_PATH, FILE_READ);
+    if (old) {
+      uint32_t old_seq = 0;
+      m_counts.health_old = countHealthSectors(old, 0, old.size() / HEALTH_LOG_SECTOR_SIZE, &old_seq);
+      old.close();
+    }
+  }
+
+  uint32_t last_seq = m_counts.health_seq;
+  uint32_t added = countHealthSectors(m_health_file, from, end, &last_seq);
+  m_counts.health_seq = last_seq;
+  m_counts.health_count += added;
+  m_counts.health_end = m_health_off;
+
+  if (!delta) {
+    Serial.printf("[OK] SD counters rebuilt: %u health log entries\n",
+                  (unsigned)(m_counts.health_count + m_counts.health_old));
+  } else if (added > 0) {
+    Serial.printf("[OK] SD counters: %u health log entries since last checkpoint\n", (unsigned)added);
+  }
+}
+
 // ════════════════════════════════════════════════════════════════════════════
 // CONVENIENCE FUNCTIONS
 // ════════════════════════════════════════════════════════════════════════════
@@ -113,4 +1576,75 @@ bool storage_is_mounted() {
   return storage_get_instance().isMounted();
 }
 
+fs::FS* storage_fs() {
+  return storage_get_instance().isMounted() ? s_fs : nullptr;
+}
+
+void storage_flush() {
+  storage_get_instance().checkpoint();
+}
+
+static bool verify_feed(const WitnessLogHeader& hdr, const uint8_t* payload, void* ctx) {
+  WitnessRangeVerifier* v = (WitnessRangeVerifier*)ctx;
+  v->feed(hdr.seq, hdr.time_bucket, hdr.flags & WITNESS_LOG_FLAG_BATCHED,
+          hdr.batch_size, hdr.leaf_index, hdr.chain_hash, hdr.signature,
+          payload, hdr.payload_len);
+  return true;
+}
+
+bool storage_verify_witness_range(uint32_t start_seq, uint32_t end_seq, uint32_t limit,
+                                  WitnessRangeReport* out) {
+  StorageManager& storage = storage_get_instance();
+  if (!storage.isMounted()) return false;
+
+  // Start on a batch boundary so the first batch root can be checked
+  WitnessLogHeader hdr;
+  if (storage.readWitness(start_seq, &hdr, nullptr, 0) &&
+      (hdr.flags & WITNESS_LOG_FLAG_BATCHED) && hdr.leaf_index <= start_seq) {
+    start_seq -= hdr.leaf_index;
+  }
+
+  uint8_t anchor[32];
+  bool anchored = start_seq > 0 && storage.readWitness(start_seq - 1, &hdr, nullptr, 0);
+  if (anchored) memcpy(anchor, hdr.chain_hash, 32);
+
+  WitnessRangeVerifier verifier;
+  verifier.begin(start_seq, anchored ? anchor : nullptr);
+  storage.exportWitness(start_seq, end_seq, verify_feed, &verifier, limit);
+  *out = verifier.finish();
+  return true;
+}
+
+bool storage_verify_from_checkpoint(uint32_t limit, WitnessRangeReport* out,
+                                    uint32_t* checkpoint_seq) {
+  StorageManager& storage = storage_get_instance();
+  if (!storage.isMounted()) return false;
+
+  // The index entry is only a pointer; the stored record must agree
+  WitnessCheckpointEntry cp;
+  WitnessLogHeader hdr;
+  bool have = storage.latestCheckpoint(&cp) && storage.readWitness(cp.seq, &hdr, nullptr, 0) &&
+              hdr.record_type == RECORD_CHECKPOINT &&
+              memcmp(hdr.chain_hash, cp.chain_hash, 32) == 0;
+
+  uint32_t start;
+  if (have) {
+    start = cp.seq;
+  } else {
+    uint32_t last = storage.lastWitnessSeq();
+    start = last > limit ? last - limit + 1 : 1;
+  }
+  if (checkpoint_seq) *checkpoint_seq = have ? cp.seq : 0;
+  return storage_verify_witness_range(start, 0, limit, out);
+}
+
+bool storage_recheck_scrub_region(WitnessScrubRegion* region, WitnessRangeReport* out) {
+  StorageManager& storage = storage_get_instance();
+  if (!storage.isMounted() || !storage.takeScrubRegion(region)) return false;
+
+  uint32_t start = region->prev_seq ? region->prev_seq : region->segment * WITNESS_SEGMENT_RECORDS;
+  uint32_t end = region->next_seq ? region->next_seq : (region->segment + 1) * WITNESS_SEGMENT_RECORDS;
+  return storage_verify_witness_range(start, end, CHAIN_VERIFY_MAX_LIMIT, out);
+}
+
 #endif // FEATURE_SD_STORAGE
@@ -3,6 +3,77 @@
  *
  * Manages append-only storage for witness records and health logs.
  *
+ * Witness log layout:
+ * /WITNESS/
+ * ├── 00000000.WIT   # Segment: seq [0, WITNESS_SEGMENT_RECORDS)
+ * ├── 00000000.IDX   # Sparse index: first record of every stride
+ * ├── 00000001.WIT
+ * ├── 00000001.IDX
+ * └── CHECKPT.IDX    # Every checkpoint record: seq and chain hash
+ *
+ * Each .WIT segment is a sequence of fixed-size WitnessLogHeader entries,
+ * each followed by its payload. The segment for a sequence number is
+ * seq / WITNESS_SEGMENT_RECORDS, the index slot is the stride within that
+ * segment, so a lookup is one index probe plus at most one stride of
+ * header hops.
+ *
+ * Appends collect in an SD_WRITE_BUFFER_BYTES write-back buffer that
+ * mirrors one aligned unit of the segment file. It reaches the card when
+ * it fills, as one aligned write; when it is WITNESS_FLUSH_MS old; or at
+ * once for SD_DURABLE_NOW records such as tamper alerts. A partial write
+ * starts at the sector holding the first unwritten byte. Index entries
+ * are written only after their record's data. A crash therefore loses at
+ * most the buffered, batched records and never leaves a dangling index.
+ *
+ * Checkpoint records (RECORD_CHECKPOINT) are written through at once and
+ * then listed in CHECKPT.IDX, so the latest is found without a scan and a
+ * verifier (storage_verify_from_checkpoint()) starts there. An entry lost
+ * to a crash only means the check starts one checkpoint earlier. Entries
+ * for pruned segments stay in the file and are skipped.
+ *
+ * Health log layout:
+ * /HEALTH/
+ * ├── HEALTH.LOG     # Current generation, 512-byte HealthLogSector units
+ * └── HEALTH.OLD     # Previous generation after rollover
+ *
+ * Log entries collect in a RAM batch and are appended as whole sectors
+ * when the batch fills, when it is HEALTH_STORE_FLUSH_MS old, or at once
+ * for CRITICAL and above. Sectors are never rewritten, so a crash can
+ * only tear the sector being written; its CRC fails and recovery resumes
+ * after the last good one.
+ *
+ * SD counters:
+ * Record and entry counts are kept in RAM, updated on append and
+ * checkpointed to /CHAIN/COUNTS.DAT. At boot the checkpoint is checked
+ * against the last record it counted, and only records after that are
+ * counted: none after an orderly shutdown, the unsaved tail after a
+ * crash. Only a missing or mismatched checkpoint means a full rescan.
+ * getStatus() never touches the card.
+ *
+ * Retention:
+ * poll() runs one bounded retention step per STORAGE_RETAIN_INTERVAL_MS.
+ * While free space is under STORAGE_RETAIN_FREE_BYTES, HEALTH.OLD goes
+ * first; after that, and whenever the witness log is over its byte or
+ * record quota, the oldest segment is pruned. Its records are counted
+ * STORAGE_RETAIN_STEP_MS at a time before its .WIT and .IDX are deleted,
+ * so the counters stay exact and no step blocks the card for long. The
+ * segment being appended to is never pruned. Used and free space are
+ * sampled once at mount and then adjusted by what the logs write and
+ * retention frees (cluster slack is not counted).
+ *
+ * Scrubbing:
+ * Every stored record carries a CRC32 (esp_rom_crc32_le) over its header
+ * and payload, so corruption can be found without SHA-256 or Ed25519.
+ * poll() also runs one scrub step per STORAGE_SCRUB_INTERVAL_MS, reading
+ * the segments oldest first in STORAGE_SCRUB_READ_BYTES blocks and
+ * checking the CRCs in memory; a full pass is followed by
+ * STORAGE_SCRUB_PASS_MS of rest. Bytes that do not parse as good records
+ * are skipped to the next good one and reported as a WitnessScrubRegion:
+ * corrupt when good records follow, torn when it runs to the end of a
+ * segment. takeScrubRegion() hands each one over for a full chain check
+ * (storage_recheck_scrub_region()). The active segment is scrubbed only
+ * up to what has reached the card.
+ *
  * Copyright (c) 2026 ERRERlabs / Karl May
  * License: Apache-2.0
  */
@@ -16,6 +87,10 @@
 #include <SPI.h>
 #include "canary_config.h"
 #include "log_level.h"
+#include "log_sink.h"
+#include "common/health/health_log_format.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
 
 #if FEATURE_SD_STORAGE
 
@@ -23,20 +98,127 @@
 // TYPES
 // ════════════════════════════════════════════════════════════════════════════
 
+// Host interface the card was mounted on
+enum SDBus : uint8_t {
+  SD_BUS_NONE  = 0,
+  SD_BUS_SPI   = 1,
+  SD_BUS_SDMMC = 2,
+};
+
+// When an append must reach the card
+enum SDDurability : uint8_t {
+  SD_DURABLE_BATCHED = 0,   // Buffered until full or WITNESS_FLUSH_MS old
+  SD_DURABLE_NOW     = 1,   // Written and flushed before append returns
+};
+
 struct SDStatus {
   bool mounted;
   bool healthy;
+  SDBus bus;
+  uint8_t bus_width;        // Data lines (1 for SPI)
   uint64_t total_bytes;
   uint64_t used_bytes;
   uint64_t free_bytes;
-  uint32_t witness_count;   // TODO: Implement file counting in getStatus()
-  uint32_t health_count;    // TODO: Implement file counting in getStatus()
-  uint32_t unacked_count;   // TODO: Implement acknowledgment tracking
+  uint32_t witness_count;   // Records in all witness segments
+  uint32_t health_count;    // Entries in both health log generations
+  uint32_t unacked_count;   // Entries needing attention (RAM ring ack state)
   uint32_t last_write_ms;
   uint32_t write_errors;
   uint32_t read_errors;
+  uint64_t bytes_appended;  // Record bytes handed to the log writers
+  uint64_t bytes_written;   // Whole sectors programmed for them
+  uint32_t syncs;           // File flushes (each also commits FAT metadata)
+  uint16_t write_amp_x100;  // bytes_written / bytes_appended x 100
+  uint32_t pruned_segments; // Witness segments deleted by retention
+  uint32_t checkpoints;     // Entries in CHECKPT.IDX
+  uint32_t checkpoint_seq;  // Latest indexed checkpoint (0 = none)
+  uint32_t scrub_passes;    // Full scrub passes completed
+  uint32_t scrub_records;   // Records that passed their CRC this pass
+  uint32_t scrub_regions;   // Bad regions found since boot
+  uint32_t scrub_pending;   // Regions waiting for a chain check
+  uint32_t scrub_kb_s;      // Read rate while scrubbing (KB/s)
 };
 
+#define WITNESS_LOG_MAGIC          0x57495431  // "WIT1"
+#define WITNESS_LOG_FLAG_BATCHED   0x01        // Signature covers a Merkle batch root
+
+// On-disk witness record header (little-endian, followed by payload_len bytes)
+struct __attribute__((packed)) WitnessLogHeader {
+  uint32_t magic;
+  uint32_t seq;
+  uint32_t time_bucket;
+  uint8_t  record_type;
+  uint8_t  flags;
+  uint16_t payload_len;
+  uint8_t  batch_size;      // Batched records: leaves in the batch
+  uint8_t  leaf_index;      // Batched records: position in the batch
+  uint16_t reserved;
+  uint8_t  chain_hash[32];
+  uint8_t  signature[64];
+  uint32_t crc;             // CRC32 over header (crc = 0) and payload
+};
+
+// Sparse index entry, appended for the first record of each stride
+struct WitnessIndexEntry {
+  uint32_t seq;
+  uint32_t offset;
+};
+
+#define WITNESS_CHECKPOINT_MAGIC   0x434B5031  // "CKP1"
+
+// Checkpoint index entry, appended once the checkpoint record is on the card
+struct __attribute__((packed)) WitnessCheckpointEntry {
+  uint32_t magic;
+  uint32_t seq;
+  uint8_t  chain_hash[32];
+  uint32_t crc;             // CRC32 over all preceding bytes
+};
+
+// Bytes of a segment that failed the scrub's CRC check
+struct WitnessScrubRegion {
+  uint32_t segment;
+  uint32_t offset;
+  uint32_t bytes;
+  uint32_t prev_seq;        // Last good record before it (0 = none)
+  uint32_t next_seq;        // First good record after it (0 = torn tail)
+};
+
+#define SD_SECTOR_SIZE             512
+
+static_assert(SD_WRITE_BUFFER_BYTES % SD_SECTOR_SIZE == 0 &&
+              (SD_WRITE_BUFFER_BYTES & (SD_WRITE_BUFFER_BYTES - 1)) == 0,
+              "SD write buffer must be a power-of-two number of sectors");
+
+// Health log sectors use the shared on-card format
+typedef health_log_record_t HealthLogRecord;
+typedef health_log_sector_t HealthLogSector;
+
+static_assert(HEALTH_LOG_SECTOR_SIZE == SD_SECTOR_SIZE, "health log sector must be one SD sector");
+static_assert(LOG_SINK_TEXT_LEN <= sizeof(((HealthLogRecord*)nullptr)->text),
+              "health log record must hold a full sink entry");
+
+#define STORAGE_COUNTS_MAGIC       0x434E5431  // "CNT1"
+
+// SD counter checkpoint. COUNTS.DAT holds two slots written in turn; the
+// valid slot with the higher generation is current.
+struct __attribute__((packed)) StorageCounts {
+  uint32_t magic;
+  uint32_t generation;
+  uint32_t witness_count;   // Records in all segments
+  uint32_t witness_seq;     // Last record counted (0 = none)
+  uint32_t witness_off;     // Its offset in segment witness_seq / WITNESS_SEGMENT_RECORDS
+  uint32_t health_count;    // Entries in HEALTH.LOG
+  uint32_t health_old;      // Entries in HEALTH.OLD
+  uint32_t health_seq;      // Last entry counted
+  uint32_t health_end;      // HEALTH.LOG offset counted through
+  uint32_t witness_first;   // Oldest segment counted (UINT32_MAX = none)
+  uint32_t crc;             // CRC32 over all preceding bytes
+};
+
+// Export callbacks; return false to stop
+typedef bool (*WitnessLogCallback)(const WitnessLogHeader& hdr, const uint8_t* payload, void* ctx);
+typedef bool (*HealthLogCallback)(const HealthLogRecord& rec, void* ctx);
+
 // ════════════════════════════════════════════════════════════════════════════
 // STORAGE MANAGER
 // ════════════════════════════════════════════════════════════════════════════
@@ -45,7 +227,8 @@ class StorageManager {
 public:
   StorageManager();
 
-  // Initialize SD card
+  // Initialize SD card: the SDMMC host first when SD_USE_SDMMC, then SPI.
+  // Passing an SPI bus skips SDMMC.
   bool begin(SPIClass* spi = nullptr);
   void end();
 
@@ -60,12 +243,184 @@ public:
   bool fileExists(const char* path);
   size_t fileSize(const char* path);
 
+  // Witness log (append-only; sequence numbers must be increasing). Returns
+  // false if the record was not accepted, or for SD_DURABLE_NOW if it is
+  // still only buffered.
+  bool appendWitness(uint32_t seq, uint32_t time_bucket, uint8_t record_type, uint8_t flags,
+                     uint8_t batch_size, uint8_t leaf_index,
+                     const uint8_t* chain_hash, const uint8_t* signature,
+                     const uint8_t* payload, size_t payload_len,
+                     SDDurability durability = SD_DURABLE_BATCHED);
+  bool flushWitness();
+
+  // Read one record by sequence number. payload may be null.
+  bool readWitness(uint32_t seq, WitnessLogHeader* hdr, uint8_t* payload, size_t payload_cap);
+
+  // Stream records in [start_seq, end_seq] (end_seq 0 = to end). Returns count.
+  uint32_t exportWitness(uint32_t start_seq, uint32_t end_seq,
+                         WitnessLogCallback cb, void* ctx, uint32_t limit = 0);
+
+  // Highest sequence number appended this boot (or recovered from the log)
+  uint32_t lastWitnessSeq() const { return m_last_seq; }
+
+  // Latest indexed checkpoint whose record is still stored
+  bool latestCheckpoint(WitnessCheckpointEntry* out);
+
+  // Oldest region flagged by the scrubber, removed from the queue. Call
+  // from the task that runs poll().
+  bool takeScrubRegion(WitnessScrubRegion* out);
+
+  // Health log: recover the tail into the RAM ring, then persist every
+  // log_health() entry through the log sink. Call before anything is logged.
+  bool beginHealthLog();
+  void appendHealth(const LogSinkEntry& entry);
+  bool flushHealth();
+
+  // Time-based flushes of both logs, counter checkpoints and retention;
+  // call from housekeeping
+  void poll(uint32_t now_ms);
+
+  // Flush both logs and checkpoint the counters
+  bool checkpoint();
+  uint32_t healthPersisted() const { return m_health_persisted; }
+
+  // Stream persisted entries oldest first (HEALTH.OLD, then HEALTH.LOG) after
+  // writing out the RAM batch, following the files through a rollover that
+  // happens mid-export. Returns count.
+  uint32_t exportHealth(HealthLogCallback cb, void* ctx);
+
 private:
+  static const size_t INDEX_SLOTS = WITNESS_SEGMENT_RECORDS / WITNESS_INDEX_STRIDE;
+
+  // Write amplification, one set per log under that log's lock
+  struct WriteStats {
+    uint64_t appended;
+    uint64_t written;
+    uint32_t syncs;
+  };
+
+  // Segment being counted for pruning; only touched from poll()
+  struct RetentionJob {
+    bool     active;
+    uint32_t segment;
+    uint32_t off;            // Next record to count
+    uint32_t records;        // Counted so far
+    uint32_t last_ms;
+    uint32_t pruned;
+  };
+
+  // Scrub position and results; only touched from poll() and takeScrubRegion()
+  struct ScrubJob {
+    bool     active;
+    uint32_t segment;
+    uint32_t off;            // Next byte to check
+    uint32_t prev_seq;       // Last good record
+    bool     bad;            // Inside a bad region starting at bad_off
+    uint32_t bad_off;
+    uint32_t last_ms;
+    uint32_t rest_ms;        // When the last pass ended
+    uint32_t passes;
+    uint32_t records;
+    uint32_t regions;
+    uint64_t bytes;          // Read since boot
+    uint32_t read_ms;        // Card time spent on them
+    WitnessScrubRegion queue[STORAGE_SCRUB_REGIONS];
+    uint8_t  queue_head;
+    uint8_t  queue_count;
+  };
+
+  struct SegmentIndex {
+    uint32_t segment;
+    bool     loaded;
+    uint32_t offsets[INDEX_SLOTS];   // UINT32_MAX = no record in that stride
+  };
+
+  bool mountCard(bool try_sdmmc);
+  bool openSegmentForAppend(uint32_t segment);
+  void loadWriteBuffer();
+  bool writeWitnessBuffer();
+  static void countWrite(WriteStats& io, uint32_t offset, size_t len);
+  void closeSegment();
+  bool loadIndex(uint32_t segment, SegmentIndex* idx);
+  bool indexLookup(uint32_t segment, uint32_t from_slot, uint32_t* offset);
+  bool recoverTail(uint32_t segment);
+  bool readHeaderAt(File& f, uint32_t offset, WitnessLogHeader* hdr, uint8_t* payload, size_t cap);
+  void segmentPath(char* out, size_t cap, uint32_t segment, const char* ext);
+  bool openHealthFile();
+  bool writeHealthBatch();
+  uint32_t recoverHealthTail();
+  bool loadCounts();
+  bool saveCounts();
+  void reconcileWitnessCounts();
+  void reconcileHealthCounts();
+  uint32_t countSegment(File& f, uint32_t segment, uint32_t off);
+  uint32_t countHealthSectors(File& f, uint32_t from, uint32_t to, uint32_t* last_seq);
+  void loadCheckpoints();
+  void writeCheckpointEntry();
+  uint64_t spaceUsed();
+  void retentionStep(uint32_t now_ms);
+  void scrubStep(uint32_t now_ms);
+  size_t scrubRecord(const uint8_t* p, size_t avail, uint32_t off, bool eof);
+  void scrubFlag(uint32_t end_off, uint32_t next_seq);
+
   SPIClass* m_spi;
   bool m_mounted;
+  SDBus m_bus;
   uint32_t m_write_errors;
   uint32_t m_read_errors;
   uint32_t m_last_write_ms;
+
+  // Witness log state (guarded by m_log_lock). Lock order: m_health_lock,
+  // then m_log_lock; nothing waits for m_health_lock holding m_log_lock.
+  SemaphoreHandle_t m_log_lock;
+  File m_seg_file;
+  File m_idx_file;
+  uint32_t m_append_off;
+  uint32_t m_last_seq;
+  SegmentIndex m_active;   // Segment currently appended to
+  SegmentIndex m_cached;   // Last segment read from
+  uint8_t  m_wbuf[SD_WRITE_BUFFER_BYTES];
+  uint32_t m_wbuf_base;    // Segment offset of m_wbuf[0], aligned
+  uint32_t m_wbuf_len;     // Buffered bytes; m_wbuf_base + m_wbuf_len == m_append_off
+  uint32_t m_wbuf_clean;   // Leading bytes already on the card
+  uint32_t m_wbuf_ms;      // When the oldest unwritten record arrived
+  WitnessIndexEntry m_idx_pending[2];   // Written after the data they point at
+  uint8_t  m_idx_pending_count;
+  WitnessCheckpointEntry m_ckpt_pending;   // Written after its record, like the index
+  bool     m_ckpt_pending_valid;
+  WitnessCheckpointEntry m_ckpt_latest;    // magic 0 = none
+  uint32_t m_ckpt_count;
+  WriteStats m_witness_io;
+
+  // Health log state (guarded by m_health_lock, the outer of the two locks)
+  SemaphoreHandle_t m_health_lock;
+  File m_health_file;
+  uint32_t m_health_off;         // Sector-aligned append offset
+  HealthLogSector m_health_batch[HEALTH_STORE_BATCH_SECTORS];
+  uint8_t m_health_sector;       // Sector being filled
+  uint32_t m_health_batch_ms;    // When the oldest buffered entry arrived
+  uint32_t m_health_persisted;
+  uint32_t m_health_gen;         // Rollovers since mount; exportHealth() pins one
+
+  WriteStats m_health_io;
+
+  // Counters: witness fields are guarded by m_log_lock, health fields by
+  // m_health_lock. Saving takes m_health_lock, then m_log_lock.
+  StorageCounts m_counts;
+  bool m_counts_valid;           // Loaded checkpoint passed its CRC
+  volatile bool m_counts_dirty;
+  uint32_t m_counts_saved_ms;
+
+  // Space: sampled at mount, then adjusted by each log under its own lock
+  uint64_t m_total_bytes;
+  uint64_t m_used_bytes;         // At mount
+  int64_t  m_space_witness;      // Net witness log growth since (m_log_lock)
+  int64_t  m_space_health;       // Net health log growth since (m_health_lock)
+  uint64_t m_witness_bytes;      // All .WIT and .IDX files (m_log_lock)
+  uint32_t m_health_old_bytes;   // HEALTH.OLD (m_health_lock)
+  RetentionJob m_retain;
+  ScrubJob m_scrub;
+  uint8_t  m_scrub_buf[STORAGE_SCRUB_READ_BYTES];
 };
 
 // ════════════════════════════════════════════════════════════════════════════
@@ -78,6 +433,35 @@ StorageManager& storage_get_instance();
 bool storage_init(SPIClass* spi = nullptr);
 bool storage_is_mounted();
 
+// Filesystem of the mounted card (SD or SD_MMC), nullptr when unmounted.
+// For scratch files outside /WITNESS and /HEALTH (the bench).
+fs::FS* storage_fs();
+
+// Write buffered witness records and health log entries and checkpoint
+// the counters now (before a deliberate restart)
+void storage_flush();
+
+// Verify stored records in [start_seq, end_seq] (end_seq 0 = to end), at most
+// limit records. The start is widened to the enclosing Merkle batch and
+// anchored on the preceding record when it is stored.
+struct WitnessRangeReport;
+bool storage_verify_witness_range(uint32_t start_seq, uint32_t end_seq, uint32_t limit,
+                                  WitnessRangeReport* out);
+
+// Verify from the latest stored checkpoint record (included, so its
+// signature and its link to the record before it are checked) to the end
+// of the log, at most limit records. With no checkpoint the last limit
+// records are checked instead. checkpoint_seq (may be null) is set to the
+// checkpoint used, 0 if none.
+bool storage_verify_from_checkpoint(uint32_t limit, WitnessRangeReport* out,
+                                    uint32_t* checkpoint_seq);
+
+// Take the oldest scrubbed region and verify the chain across it, from
+// its last good record to its first good one (a torn tail: to the start
+// of the next segment). Records lost in the region show as gaps. Returns
+// false when nothing is waiting.
+bool storage_recheck_scrub_region(WitnessScrubRegion* region, WitnessRangeReport* out);
+
 #endif // FEATURE_SD_STORAGE
 
 #endif // SECURACV_STORAGE_H
@@ -1,13 +1,26 @@
 /*
  * SecuraCV Canary — Web UI
  *
- * Dashboard HTML/CSS/JS as PROGMEM string.
+ * Dashboard HTML/CSS/JS as PROGMEM string, plus the gzip copy the
+ * pre-build script generates from it.
  *
  * Copyright (c) 2026 ERRERlabs / Karl May
  * License: Apache-2.0
  */
 
 #include "securacv_webui.h"
+#include "canary_config.h"
+
+#if __has_include("securacv_webui_gz.h")
+#include "securacv_webui_gz.h"
+const uint8_t* const CANARY_UI_HTML_GZ = CANARY_UI_HTML_GZ_DATA;
+const size_t CANARY_UI_HTML_GZ_LEN = CANARY_UI_HTML_GZ_SIZE;
+const char CANARY_UI_ETAG[] = "\"" FIRMWARE_VERSION "-" CANARY_UI_HTML_DIGEST "\"";
+#else
+const uint8_t* const CANARY_UI_HTML_GZ = nullptr;
+const size_t CANARY_UI_HTML_GZ_LEN = 0;
+const char CANARY_UI_ETAG[] = "\"" FIRMWARE_VERSION "\"";
+#endif
 
 const char CANARY_UI_HTML[] PROGMEM = R"rawliteral(<!DOCTYPE html>
 <html lang="en">
@@ -1620,6 +1633,12 @@ const char CANARY_UI_HTML[] PROGMEM = R"rawliteral(<!DOCTYPE html>
     let currentPanel = 'status';
     let pendingAckSeq = null;
     let logFilter = 'all';
+    let logEntries = [];
+
+    // Live updates (/api/events); polling only while the stream is down
+    let liveStatus = {};
+    let eventsLive = false;
+    let pollTimers = [];
     
     // Peek state
     let peekActive = false;
@@ -1876,6 +1895,12 @@ const char CANARY_UI_HTML[] PROGMEM = R"rawliteral(<!DOCTYPE html>
     async function refreshStatus() {
       const data = await api('/api/status');
       if (!data.ok) return;
+      applyStatus(data);
+    }
+
+    // Merge a full status or an /api/events delta and redraw
+    function applyStatus(delta) {
+      const data = Object.assign(liveStatus, delta);
       
       document.getElementById('deviceId').textContent = data.device_id;
       document.getElementById('uptime').textContent = formatUptime(data.uptime_sec);
@@ -1959,10 +1984,13 @@ const char CANARY_UI_HTML[] PROGMEM = R"rawliteral(<!DOCTYPE html>
 
     // Chain visualization
     async function loadChain() {
-      const data = await api('/api/chain');
+      renderChain(await api('/api/chain'));
+    }
+
+    function renderChain(data) {
       const viz = document.getElementById('chainViz');
       
-      if (!data.ok || !data.blocks?.length) {
+      if (data.ok === false || !data.blocks?.length) {
         viz.innerHTML = '<div class="empty-state"><div class="empty-icon">⛓</div><p>No chain data</p></div>';
         return;
       }
@@ -1980,17 +2008,36 @@ const char CANARY_UI_HTML[] PROGMEM = R"rawliteral(<!DOCTYPE html>
     async function loadLogs() {
       const filter = logFilter === 'unread' ? '?unacked=true' : '';
       const data = await api('/api/logs' + filter);
+      logEntries = data.ok && data.logs ? data.logs : [];
+      renderLogs();
+    }
+
+    // New entry pushed over /api/events (always unread, so every filter shows it)
+    function addLogEntry(log) {
+      if (logEntries.some(l => l.seq === log.seq)) return;
+      logEntries.unshift(log);
+      if (currentPanel === 'logs') renderLogs();
+    }
+
+    // After a (re)connect, fetch entries logged while the stream was down
+    async function catchUpLogs() {
+      if (!logEntries.length) return;
+      const data = await api('/api/logs?since=' + logEntries[0].seq);
+      if (data.ok) data.logs.forEach(addLogEntry);
+    }
+
+    function renderLogs() {
       const list = document.getElementById('logList');
       
-      if (!data.ok || !data.logs?.length) {
+      if (!logEntries.length) {
         list.innerHTML = '<div class="empty-state"><div class="empty-icon">📋</div><p>No log entries</p></div>';
         return;
       }
       
       document.getElementById('logsSubtitle').textContent = 
-        `${data.logs.length} entries${logFilter === 'unread' ? ' (unread only)' : ''}`;
+        `${logEntries.length} entries${logFilter === 'unread' ? ' (unread only)' : ''}`;
       
-      list.innerHTML = data.logs.map(log => `
+      list.innerHTML = logEntries.map(log => `
         <div class="log-item ${log.ack_status === 'unread' ? 'unread' : ''} ${log.level >= 4 ? 'error' : ''} ${log.level >= 5 ? 'critical' : ''}">
           <div class="log-level ${getLevelClass(log.level)}">${log.level_name}</div>
           <div class="log-content">
@@ -2047,13 +2094,9 @@ const char CANARY_UI_HTML[] PROGMEM = R"rawliteral(<!DOCTYPE html>
       `).join('');
     }
 
-    async function exportWitness() {
-      const data = await api('/api/export', 'POST');
-      if (data.ok && data.download_url) {
-        window.location.href = data.download_url;
-      } else {
-        alert('Export failed: ' + (data.error || 'Unknown error'));
-      }
+    function exportWitness() {
+      // Streamed bundle; the browser saves it as it arrives
+      window.location.href = '/api/export';
     }
 
     // Acknowledgment
@@ -3266,6 +3309,29 @@ const char CANARY_UI_HTML[] PROGMEM = R"rawliteral(<!DOCTYPE html>
     // Initialize
     // ══════════════════════════════════════════════════════════════════
 
+    function startPolling() {
+      if (pollTimers.length) return;
+      pollTimers = [setInterval(refreshStatus, 2000), setInterval(loadWifiStatus, 5000)];
+    }
+
+    function stopPolling() {
+      pollTimers.forEach(clearInterval);
+      pollTimers = [];
+    }
+
+    function connectEvents() {
+      if (!window.EventSource) { startPolling(); return; }
+      const es = new EventSource(API_BASE + '/api/events');
+      // EventSource reconnects on its own; poll until it does. A refused
+      // stream (too many subscribers) closes for good and keeps polling.
+      es.onopen = () => { eventsLive = true; stopPolling(); catchUpLogs(); };
+      es.onerror = () => { eventsLive = false; startPolling(); };
+      es.addEventListener('status', e => applyStatus(JSON.parse(e.data)));
+      es.addEventListener('chain', e => renderChain(JSON.parse(e.data)));
+      es.addEventListener('log', e => addLogEntry(JSON.parse(e.data)));
+      es.addEventListener('wifi', () => loadWifiStatus());
+    }
+
     refreshStatus();
     loadChain();
     loadWifiStatus();
@@ -3275,10 +3341,9 @@ const char CANARY_UI_HTML[] PROGMEM = R"rawliteral(<!DOCTYPE html>
     loadBtSettings();
     loadBtPairedDevices();
     updateResolutionUI();
-    setInterval(refreshStatus, 2000);
-    setInterval(loadWifiStatus, 5000);
+    connectEvents();
     setInterval(() => {
-      if (currentPanel === 'logs') loadLogs();
+      if (currentPanel === 'logs' && !eventsLive) loadLogs();
       else if (currentPanel === 'witness') loadWitness();
       else if (currentPanel === 'opera') refreshOpera();
       else if (currentPanel === 'community') refreshChirpStatus();
@@ -15,4 +15,11 @@
 // Main dashboard HTML
 extern const char CANARY_UI_HTML[] PROGMEM;
 
+// Gzip copy generated by scripts/gzip_webui.py (size 0 if not generated)
+extern const uint8_t* const CANARY_UI_HTML_GZ;
+extern const size_t CANARY_UI_HTML_GZ_LEN;
+
+// Strong validator for the UI: "<firmware version>-<content digest>"
+extern const char CANARY_UI_ETAG[];
+
 #endif // SECURACV_WEBUI_H
@@ -0,0 +1,194 @@
+/*
+ * SecuraCV Canary — Asynchronous Log Sink Implementation
+ *
+ * Bounded MPSC queue after Vyukov: each slot carries a sequence number.
+ * A producer claims position pos when slot.seq == pos, fills it, then
+ * publishes by setting seq = pos + 1. The consumer reads a slot once
+ * seq == pos + 1 and frees it for the next lap with seq = pos + size.
+ *
+ * Copyright (c) 2026 ERRERlabs / Karl May
+ * License: Apache-2.0
+ */
+
+#include "log_sink.h"
+#include <atomic>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+static_assert((LOG_SINK_RING_SIZE & (LOG_SINK_RING_SIZE - 1)) == 0, "log sink ring must be a power of two");
+static_assert(LOG_SINK_TEXT_LEN <= 255, "entry lengths are uint8_t");
+
+struct Slot {
+  std::atomic<uint32_t> seq;
+  LogSinkEntry entry;
+};
+
+struct Output {
+  LogOutputFn fn;
+  void* ctx;
+  LogLevel min_level;
+};
+
+static Slot s_ring[LOG_SINK_RING_SIZE];
+static std::atomic<uint32_t> s_head{0};     // Next position producers claim
+static std::atomic<uint32_t> s_tail{0};     // Next position the sink reads; sink writes only
+
+static void serial_output(const LogSinkEntry& entry, void* ctx);
+
+// Serial is output 0 from the start, so early-boot entries always print
+static Output s_outputs[LOG_SINK_MAX_OUTPUTS] = { { serial_output, nullptr, LOG_LEVEL_DEBUG } };
+static std::atomic<uint32_t> s_output_count{1};
+
+static TaskHandle_t s_sink_task = nullptr;
+
+static std::atomic<uint32_t> s_queued{0};
+static std::atomic<uint32_t> s_dropped{0};
+static uint32_t s_written = 0;
+static std::atomic<uint32_t> s_peak{0};
+
+// ════════════════════════════════════════════════════════════════════════════
+// OUTPUTS
+// ════════════════════════════════════════════════════════════════════════════
+
+size_t log_sink_format(const LogSinkEntry& e, char* out, size_t cap) {
+  int n = snprintf(out, cap, "[%s/%s] %.*s", log_level_name(e.level), log_category_name(e.category),
+                   (int)e.msg_len, e.text);
+  if (n > 0 && (size_t)n < cap && e.detail_len > 0) {
+    n += snprintf(out + n, cap - n, " | %.*s", (int)e.detail_len, e.text + e.msg_len);
+  }
+  if (n < 0) n = 0;
+  return (size_t)n < cap ? (size_t)n : cap - 1;
+}
+
+static void serial_output(const LogSinkEntry& entry, void* ctx) {
+  (void)ctx;
+  char line[LOG_SINK_TEXT_LEN + 32];
+  log_sink_format(entry, line, sizeof(line));
+  Serial.println(line);
+}
+
+static void dispatch(const LogSinkEntry& entry) {
+  uint32_t count = s_output_count.load(std::memory_order_acquire);
+  for (uint32_t i = 0; i < count; i++) {
+    if (entry.level >= s_outputs[i].min_level) s_outputs[i].fn(entry, s_outputs[i].ctx);
+  }
+  s_written++;
+}
+
+bool log_sink_add(LogOutputFn fn, void* ctx, LogLevel min_level) {
+  // Registration happens at startup from one task; readers see the count last
+  uint32_t n = s_output_count.load(std::memory_order_relaxed);
+  if (!fn || n >= LOG_SINK_MAX_OUTPUTS) return false;
+  s_outputs[n] = { fn, ctx, min_level };
+  s_output_count.store(n + 1, std::memory_order_release);
+  return true;
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// RING
+// ════════════════════════════════════════════════════════════════════════════
+
+static void ring_init() {
+  for (uint32_t i = 0; i < LOG_SINK_RING_SIZE; i++) {
+    s_ring[i].seq.store(i, std::memory_order_relaxed);
+  }
+}
+
+static void fill_entry(LogSinkEntry& e, uint32_t seq, LogLevel level, LogCategory category,
+                       const char* message, const char* detail) {
+  e.seq = seq;
+  e.timestamp_ms = millis();
+  e.level = level;
+  e.category = category;
+
+  size_t msg = message ? strnlen(message, LOG_SINK_TEXT_LEN) : 0;
+  if (msg) memcpy(e.text, message, msg);
+  size_t det = detail ? strnlen(detail, LOG_SINK_TEXT_LEN - msg) : 0;
+  if (det) memcpy(e.text + msg, detail, det);
+  e.msg_len = (uint8_t)msg;
+  e.detail_len = (uint8_t)det;
+}
+
+void log_sink_push(uint32_t seq, LogLevel level, LogCategory category,
+                   const char* message, const char* detail) {
+  if (!s_sink_task) {
+    // No task yet (early boot) or it failed to start: write through
+    LogSinkEntry e;
+    fill_entry(e, seq, level, category, message, detail);
+    dispatch(e);
+    return;
+  }
+
+  uint32_t pos = s_head.load(std::memory_order_relaxed);
+  Slot* slot;
+  for (;;) {
+    slot = &s_ring[pos & (LOG_SINK_RING_SIZE - 1)];
+    int32_t dif = (int32_t)(slot->seq.load(std::memory_order_acquire) - pos);
+    if (dif == 0) {
+      if (s_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+    } else if (dif < 0) {
+      s_dropped.fetch_add(1, std::memory_order_relaxed);
+      return;
+    } else {
+      pos = s_head.load(std::memory_order_relaxed);
+    }
+  }
+
+  fill_entry(slot->entry, seq, level, category, message, detail);
+  slot->seq.store(pos + 1, std::memory_order_release);
+
+  s_queued.fetch_add(1, std::memory_order_relaxed);
+  uint32_t depth = pos + 1 - s_tail.load(std::memory_order_relaxed);
+  uint32_t peak = s_peak.load(std::memory_order_relaxed);
+  while (depth > peak && !s_peak.compare_exchange_weak(peak, depth, std::memory_order_relaxed)) {}
+
+  xTaskNotifyGive(s_sink_task);
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// SINK TASK
+// ════════════════════════════════════════════════════════════════════════════
+
+static void sink_task(void* arg) {
+  (void)arg;
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+    uint32_t tail = s_tail.load(std::memory_order_relaxed);
+    for (;;) {
+      Slot& slot = s_ring[tail & (LOG_SINK_RING_SIZE - 1)];
+      if (slot.seq.load(std::memory_order_acquire) != tail + 1) break;
+      dispatch(slot.entry);
+      slot.seq.store(tail + LOG_SINK_RING_SIZE, std::memory_order_release);
+      s_tail.store(++tail, std::memory_order_relaxed);
+    }
+  }
+}
+
+bool log_sink_begin() {
+  if (s_sink_task) return true;
+  ring_init();
+
+  BaseType_t ret = xTaskCreatePinnedToCore(
+    sink_task, "log_sink", LOG_SINK_TASK_STACK, nullptr,
+    LOG_SINK_TASK_PRIORITY, &s_sink_task, LOG_SINK_TASK_CORE);
+
+  if (ret != pdPASS) {
+    s_sink_task = nullptr;
+    Serial.println("[!!] Log sink task creation failed; logging inline");
+    return false;
+  }
+
+  Serial.printf("[OK] Log sink running (ring %d)\n", LOG_SINK_RING_SIZE);
+  return true;
+}
+
+LogSinkStats log_sink_get_stats() {
+  LogSinkStats st;
+  st.queued = s_queued.load(std::memory_order_relaxed);
+  st.written = s_written;
+  st.dropped = s_dropped.load(std::memory_order_relaxed);
+  st.peak_depth = s_peak.load(std::memory_order_relaxed);
+  return st;
+}
@@ -0,0 +1,73 @@
+/*
+ * SecuraCV Canary — Asynchronous Log Sink
+ *
+ * log_health() used to print straight to Serial from whatever task logged,
+ * so an HTTP handler or the record path could stall for milliseconds on
+ * the UART. Now it only copies a compact entry into a bounded lock-free
+ * MPSC ring (per-slot sequence numbers, one CAS per entry, never blocks)
+ * and a low-priority sink task formats entries for the registered outputs.
+ * Serial is always registered; SD or remote outputs add themselves with
+ * log_sink_add().
+ *
+ * When the ring is full new entries are dropped and counted rather than
+ * waiting. Until log_sink_begin() starts the task, entries print inline.
+ *
+ * Copyright (c) 2026 ERRERlabs / Karl May
+ * License: Apache-2.0
+ */
+
+#ifndef SECURACV_LOG_SINK_H
+#define SECURACV_LOG_SINK_H
+
+#include <Arduino.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "canary_config.h"
+#include "log_level.h"
+
+// ════════════════════════════════════════════════════════════════════════════
+// TYPES
+// ════════════════════════════════════════════════════════════════════════════
+
+// Message and detail packed back to back: text[0..msg_len) is the message,
+// text[msg_len..msg_len+detail_len) the detail. Not NUL-terminated.
+struct LogSinkEntry {
+  uint32_t seq;
+  uint32_t timestamp_ms;
+  LogLevel level;
+  LogCategory category;
+  uint8_t msg_len;
+  uint8_t detail_len;
+  char text[LOG_SINK_TEXT_LEN];
+};
+
+// Output; runs on the sink task
+typedef void (*LogOutputFn)(const LogSinkEntry& entry, void* ctx);
+
+struct LogSinkStats {
+  uint32_t queued;
+  uint32_t written;
+  uint32_t dropped;          // Ring full; entry never reached the outputs
+  uint32_t peak_depth;
+};
+
+// ════════════════════════════════════════════════════════════════════════════
+// API
+// ════════════════════════════════════════════════════════════════════════════
+
+// Start the sink task; false if it could not be created (entries stay inline)
+bool log_sink_begin();
+
+// Register an output for entries at or above min_level; false when full
+bool log_sink_add(LogOutputFn fn, void* ctx, LogLevel min_level);
+
+// Queue an entry; safe from any task, never blocks
+void log_sink_push(uint32_t seq, LogLevel level, LogCategory category,
+                   const char* message, const char* detail);
+
+// Write "[LEVEL/CAT] message | detail" into out (NUL-terminated); returns length
+size_t log_sink_format(const LogSinkEntry& entry, char* out, size_t cap);
+
+LogSinkStats log_sink_get_stats();
+
+#endif // SECURACV_LOG_SINK_H
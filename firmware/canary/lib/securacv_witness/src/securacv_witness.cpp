@@ -7,11 +7,20 @@
 
 #include "securacv_witness.h"
 #include "securacv_crypto.h"
+#include "witness_journal.h"
+#include "securacv_metrics.h"
+#include "perf_profiler.h"
+#include "log_sink.h"
 #include "canary_config.h"
+#include "common/encoding/cbor.h"
 
 #include <Arduino.h>
 #include <Crypto.h>
 #include <Ed25519.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
 
 // ════════════════════════════════════════════════════════════════════════════
 // GLOBAL STATE
@@ -26,11 +35,109 @@ static uint32_t g_state_entered_ms = 0;
 static uint32_t g_pending_state_ms = 0;
 static float g_speed_ema = 0.0f;
 
-// Health log ring buffer
-static const size_t HEALTH_LOG_RING_SIZE = 100;
+// Chain lock: serializes seq/chain_head updates between loop() and the signer
+static SemaphoreHandle_t g_chain_mutex = nullptr;
+
+// Delivery lock. Final records go to the sink and callbacks after the chain
+// lock is released, but still in chain order: a chain holder with records
+// to hand out takes this before letting go of the chain lock and gives it
+// back once they are delivered. Recursive, as a sealed batch and the record
+// that sealed it are delivered under one hold.
+static SemaphoreHandle_t g_deliver_mutex = nullptr;
+
+// Signer pipeline
+struct WitnessJob {
+  RecordType type;
+  uint16_t len;
+  uint32_t enqueue_us;
+  WitnessRecordCallback cb;
+  void* ctx;
+  uint8_t payload[WITNESS_MAX_PAYLOAD];
+};
+
+static QueueHandle_t g_signer_queue = nullptr;
+static TaskHandle_t g_signer_task = nullptr;
+
+// Self-verification policy and deferred audit ring
+static VerifyPolicy g_verify_policy = (VerifyPolicy)WITNESS_VERIFY_POLICY;
+static uint32_t g_verify_sample_n = WITNESS_VERIFY_SAMPLE_N;
+static WitnessRecord g_audit_ring[AUDITOR_RING_SIZE];
+static size_t g_audit_head = 0;
+static size_t g_audit_count = 0;
+static portMUX_TYPE g_audit_mux = portMUX_INITIALIZER_UNLOCKED;
+static TaskHandle_t g_auditor_task = nullptr;
+
+// Merkle batch: chained records awaiting the batch signature
+struct BatchSlot {
+  WitnessRecord rec;
+  WitnessRecordCallback cb;
+  void* ctx;
+  uint16_t payload_len;
+  uint8_t payload[WITNESS_MAX_PAYLOAD];
+};
+
+static_assert(WITNESS_BATCH_SIZE <= (1 << WITNESS_MERKLE_DEPTH), "batch exceeds Merkle depth");
+static_assert(WITNESS_BATCH_SIZE <= 255, "batch size must fit in uint8_t");
+
+static bool g_batch_mode = WITNESS_BATCH_MODE;
+static BatchSlot g_batch_buf[2][WITNESS_BATCH_SIZE];
+static BatchSlot* g_batch = g_batch_buf[0];      // Open batch; chain lock
+static size_t g_batch_count = 0;
+
+// Sealed batch awaiting delivery (the other buffer); delivery lock
+static BatchSlot* g_sealed = nullptr;
+static size_t g_sealed_count = 0;
+static bool g_sealed_ok = false;
+static uint32_t g_batch_opened_ms = 0;
+static uint8_t g_merkle_tree[WITNESS_MERKLE_DEPTH + 1][WITNESS_BATCH_SIZE][32];
+
+// Chain checkpoints: the next is attempted once seq reaches this
+static uint32_t g_checkpoint_due_seq = 0;
+
+// Record sink (SD witness log)
+static WitnessSinkFn g_sink = nullptr;
+static void* g_sink_ctx = nullptr;
+
+// Health log ring buffer. Entry seq lives in slot seq % HEALTH_LOG_RING_SIZE,
+// so a seq is found without scanning; the slot's stored seq is the
+// generation check that tells a live entry from one already overwritten.
+// Entries are compact (interned messages, typed args), so ~400 fit in the
+// RAM that 100 text entries used to.
+static const size_t HEALTH_LOG_RING_SIZE = 400;
 static HealthLogRingEntry g_health_log_ring[HEALTH_LOG_RING_SIZE];
 static size_t g_health_log_ring_head = 0;
 static size_t g_health_log_ring_count = 0;
+static uint32_t g_health_log_newest_seq = 0;
+static portMUX_TYPE g_health_log_mux = portMUX_INITIALIZER_UNLOCKED;
+
+// Query indexes: a bitmap of ring slots per level, per category and for
+// unread entries, kept in step on insert and ack. A filtered scan ORs and
+// ANDs whole words, so it touches 32 slots per step and stops on a match.
+static const size_t HEALTH_LOG_INDEX_WORDS = (HEALTH_LOG_RING_SIZE + 31) / 32;
+static const size_t HEALTH_LOG_LEVELS = 8;
+static const size_t HEALTH_LOG_CATEGORIES = 16;
+static uint32_t g_health_log_level_bits[HEALTH_LOG_LEVELS][HEALTH_LOG_INDEX_WORDS];
+static uint32_t g_health_log_cat_bits[HEALTH_LOG_CATEGORIES][HEALTH_LOG_INDEX_WORDS];
+static uint32_t g_health_log_unread_bits[HEALTH_LOG_INDEX_WORDS];
+
+// Runtime text (SSIDs, IPs, formatted details) shared by all entries.
+// Positions are absolute byte counts; text whose bytes have since been
+// overwritten is detected by distance from the write position.
+static const size_t HEALTH_LOG_TEXT_ARENA = 2048;
+static const size_t HEALTH_LOG_TEXT_MAX = 79;
+static char g_health_log_text[HEALTH_LOG_TEXT_ARENA];
+static uint32_t g_health_log_text_pos = 0;
+
+// Record creation latency (hash, chain lock, sign, verify)
+static MetricId g_record_latency = METRIC_NONE;
+
+// Profiler scopes (perf_profiler.h)
+static PerfScopeId g_record_perf = PERF_SCOPE_NONE;
+static PerfScopeId g_state_perf = PERF_SCOPE_NONE;
+
+// /api/status sections changed since the last render
+static uint32_t g_status_dirty = STATUS_DIRTY_ALL;
+static portMUX_TYPE g_status_mux = portMUX_INITIALIZER_UNLOCKED;
 
 // ════════════════════════════════════════════════════════════════════════════
 // GLOBAL STATE ACCESSORS
@@ -39,12 +146,177 @@ static size_t g_health_log_ring_count = 0;
 DeviceIdentity& witness_get_device() { return g_device; }
 SystemHealth& witness_get_health() { return g_health; }
 WitnessRecord& witness_get_last_record() { return g_last_record; }
+
+void witness_get_chain_snapshot(WitnessChainSnapshot* out) {
+  if (g_chain_mutex) xSemaphoreTake(g_chain_mutex, portMAX_DELAY);
+  out->seq = g_device.seq;
+  memcpy(out->chain_head, g_device.chain_head, sizeof(out->chain_head));
+  out->last_seq = g_last_record.seq;
+  memcpy(out->last_hash, g_last_record.chain_hash, sizeof(out->last_hash));
+  out->last_type = g_last_record.type;
+  out->last_verified = g_last_record.verified;
+  if (g_chain_mutex) xSemaphoreGive(g_chain_mutex);
+}
 FixState witness_get_state() { return g_state; }
 float witness_get_speed_ema() { return g_speed_ema; }
 
 HealthLogRingEntry* witness_get_health_log_ring() { return g_health_log_ring; }
 size_t witness_get_health_log_count() { return g_health_log_ring_count; }
 size_t witness_get_health_log_head() { return g_health_log_ring_head; }
+size_t witness_get_health_log_capacity() { return HEALTH_LOG_RING_SIZE; }
+
+// Caller holds g_health_log_mux
+static uint32_t health_log_oldest_locked() {
+  return g_health_log_ring_count > 0 ? g_health_log_newest_seq - (uint32_t)g_health_log_ring_count + 1 : 0;
+}
+
+// Caller holds g_health_log_mux
+static HealthLogRingEntry* health_log_find_locked(uint32_t seq) {
+  if (seq == 0 || seq > g_health_log_newest_seq ||
+      g_health_log_newest_seq - seq >= g_health_log_ring_count) {
+    return nullptr;
+  }
+  HealthLogRingEntry& entry = g_health_log_ring[seq % HEALTH_LOG_RING_SIZE];
+  return entry.seq == seq ? &entry : nullptr;
+}
+
+void witness_get_health_log_range(uint32_t* oldest, uint32_t* newest) {
+  portENTER_CRITICAL(&g_health_log_mux);
+  *oldest = health_log_oldest_locked();
+  *newest = g_health_log_ring_count > 0 ? g_health_log_newest_seq : 0;
+  portEXIT_CRITICAL(&g_health_log_mux);
+}
+
+uint32_t witness_get_health_log_newest_seq() {
+  uint32_t oldest, newest;
+  witness_get_health_log_range(&oldest, &newest);
+  return newest;
+}
+
+uint32_t witness_get_health_log_oldest_seq() {
+  uint32_t oldest, newest;
+  witness_get_health_log_range(&oldest, &newest);
+  return oldest;
+}
+
+bool witness_get_health_log(uint32_t seq, HealthLogRingEntry* out) {
+  portENTER_CRITICAL(&g_health_log_mux);
+  const HealthLogRingEntry* entry = health_log_find_locked(seq);
+  if (entry) *out = *entry;
+  portEXIT_CRITICAL(&g_health_log_mux);
+  return entry != nullptr;
+}
+
+static inline void index_set(uint32_t* bits, size_t slot) { bits[slot / 32] |= 1u << (slot % 32); }
+static inline void index_clear(uint32_t* bits, size_t slot) { bits[slot / 32] &= ~(1u << (slot % 32)); }
+
+// Slots of word w that match the filter
+static uint32_t index_word(const HealthLogFilter& f, size_t w) {
+  uint32_t bits = 0;
+  for (size_t l = f.min_level; l < HEALTH_LOG_LEVELS; l++) bits |= g_health_log_level_bits[l][w];
+  if (f.categories) {
+    uint32_t cats = 0;
+    for (size_t c = 0; c < HEALTH_LOG_CATEGORIES; c++) {
+      if (f.categories & (1u << c)) cats |= g_health_log_cat_bits[c][w];
+    }
+    bits &= cats;
+  }
+  if (f.unacked_only) bits &= g_health_log_unread_bits[w];
+  return bits;
+}
+
+// Bits of word w that fall inside slots [from, to)
+static uint32_t index_range_mask(size_t w, size_t from, size_t to) {
+  uint32_t mask = UINT32_MAX;
+  if (w == from / 32) mask &= UINT32_MAX << (from % 32);
+  if (w * 32 + 32 > to) mask &= (1u << (to - w * 32)) - 1;
+  return mask;
+}
+
+// First / last matching slot in [from, to), or -1
+static int index_scan_forward(const HealthLogFilter& f, size_t from, size_t to) {
+  for (size_t w = from / 32; from < to && w * 32 < to; w++) {
+    uint32_t bits = index_word(f, w) & index_range_mask(w, from, to);
+    if (bits) return (int)(w * 32 + __builtin_ctz(bits));
+  }
+  return -1;
+}
+
+static int index_scan_back(const HealthLogFilter& f, size_t from, size_t to) {
+  if (from >= to) return -1;
+  for (size_t w = (to - 1) / 32 + 1; w-- > from / 32;) {
+    uint32_t bits = index_word(f, w) & index_range_mask(w, from, to);
+    if (bits) return (int)(w * 32 + 31 - __builtin_clz(bits));
+  }
+  return -1;
+}
+
+// Caller holds g_health_log_mux
+static const HealthLogRingEntry* health_log_next_locked(const HealthLogFilter& f, uint32_t after) {
+  if (g_health_log_ring_count == 0) return nullptr;
+  uint32_t oldest = health_log_oldest_locked();
+  uint32_t newest = g_health_log_newest_seq;
+  uint32_t start = after >= oldest ? after + 1 : oldest;
+  if (after >= newest) return nullptr;
+
+  // The live range is contiguous in seq, so at most two runs of slots
+  size_t len = newest - start + 1;
+  size_t s0 = start % HEALTH_LOG_RING_SIZE;
+  size_t run = len < HEALTH_LOG_RING_SIZE - s0 ? len : HEALTH_LOG_RING_SIZE - s0;
+  int slot = index_scan_forward(f, s0, s0 + run);
+  if (slot >= 0) return health_log_find_locked(start + (uint32_t)(slot - s0));
+  slot = index_scan_forward(f, 0, len - run);
+  if (slot >= 0) return health_log_find_locked(start + (uint32_t)(run + slot));
+  return nullptr;
+}
+
+// Caller holds g_health_log_mux
+static const HealthLogRingEntry* health_log_prev_locked(const HealthLogFilter& f, uint32_t before) {
+  if (g_health_log_ring_count == 0) return nullptr;
+  uint32_t oldest = health_log_oldest_locked();
+  uint32_t newest = g_health_log_newest_seq;
+  if (before != 0 && before <= oldest) return nullptr;
+  uint32_t end = (before == 0 || before > newest) ? newest : before - 1;
+
+  size_t len = end - oldest + 1;
+  size_t e1 = end % HEALTH_LOG_RING_SIZE + 1;   // One past the newest slot
+  size_t run = len < e1 ? len : e1;
+  int slot = index_scan_back(f, e1 - run, e1);
+  if (slot >= 0) return health_log_find_locked(end - (uint32_t)(e1 - 1 - slot));
+  slot = index_scan_back(f, HEALTH_LOG_RING_SIZE - (len - run), HEALTH_LOG_RING_SIZE);
+  if (slot >= 0) return health_log_find_locked(end - (uint32_t)(run + HEALTH_LOG_RING_SIZE - 1 - slot));
+  return nullptr;
+}
+
+bool witness_health_log_next(const HealthLogFilter& f, uint32_t after, HealthLogRingEntry* out) {
+  portENTER_CRITICAL(&g_health_log_mux);
+  const HealthLogRingEntry* entry = health_log_next_locked(f, after);
+  if (entry) *out = *entry;
+  portEXIT_CRITICAL(&g_health_log_mux);
+  return entry != nullptr;
+}
+
+bool witness_health_log_prev(const HealthLogFilter& f, uint32_t before, HealthLogRingEntry* out) {
+  portENTER_CRITICAL(&g_health_log_mux);
+  const HealthLogRingEntry* entry = health_log_prev_locked(f, before);
+  if (entry) *out = *entry;
+  portEXIT_CRITICAL(&g_health_log_mux);
+  return entry != nullptr;
+}
+
+void witness_mark_status_dirty(uint32_t bits) {
+  portENTER_CRITICAL(&g_status_mux);
+  g_status_dirty |= bits;
+  portEXIT_CRITICAL(&g_status_mux);
+}
+
+uint32_t witness_take_status_dirty() {
+  portENTER_CRITICAL(&g_status_mux);
+  uint32_t bits = g_status_dirty;
+  g_status_dirty = 0;
+  portEXIT_CRITICAL(&g_status_mux);
+  return bits;
+}
 
 // ════════════════════════════════════════════════════════════════════════════
 // UTILITIES
@@ -72,12 +344,22 @@ const char* state_name_short(FixState s) {
   }
 }
 
+const char* verify_policy_name(VerifyPolicy p) {
+  switch (p) {
+    case VERIFY_ALWAYS:   return "always";
+    case VERIFY_SAMPLED:  return "sampled";
+    case VERIFY_DEFERRED: return "deferred";
+    default:              return "unknown";
+  }
+}
+
 const char* record_type_name(RecordType t) {
   switch (t) {
     case RECORD_BOOT_ATTESTATION: return "BOOT";
     case RECORD_WITNESS_EVENT:    return "EVNT";
     case RECORD_TAMPER_ALERT:     return "TAMP";
     case RECORD_STATE_CHANGE:     return "STCH";
+    case RECORD_CHECKPOINT:       return "CKPT";
     default:                      return "???";
   }
 }
@@ -134,6 +416,7 @@ bool witness_provision_device() {
   g_device.boot_count = nvs_load_u32(NVS_KEY_BOOTS, 0) + 1;
   nvs_store_u32(NVS_KEY_BOOTS, g_device.boot_count);
   g_device.log_seq = nvs_load_u32(NVS_KEY_LOGSEQ, 0);
+  g_device.checkpoint_seq = nvs_load_u32(NVS_KEY_CKPT, 0);
 
   if (!nvs_load_bytes(NVS_KEY_CHAIN, g_device.chain_head, 32)) {
     // Initialize genesis chain hash
@@ -142,12 +425,42 @@ bool witness_provision_device() {
     nvs_store_bytes(NVS_KEY_CHAIN, g_device.chain_head, 32);
   }
 
+  #if FEATURE_CHAIN_JOURNAL
+  // The journal is ahead of NVS whenever the last checkpoint was not reached
+  if (journal_begin(g_device.pubkey_fp)) {
+    uint32_t j_seq;
+    uint8_t j_head[32];
+    if (journal_recover(&j_seq, j_head) && j_seq > g_device.seq) {
+      Serial.printf("[OK] Chain head recovered from journal (seq %u -> %u)\n", g_device.seq, j_seq);
+      g_device.seq = j_seq;
+      memcpy(g_device.chain_head, j_head, 32);
+      witness_persist_chain_state();
+    }
+  }
+  #endif
+
+  if (!g_chain_mutex) {
+    g_chain_mutex = xSemaphoreCreateMutex();
+  }
+  if (!g_deliver_mutex) {
+    g_deliver_mutex = xSemaphoreCreateRecursiveMutex();
+  }
+
+  // A chain with no checkpoint yet (or older than one interval) gets one
+  // with its next record
+  g_checkpoint_due_seq = g_device.checkpoint_seq + WITNESS_CHECKPOINT_INTERVAL;
+
   g_device.boot_ms = millis();
   g_device.initialized = true;
   g_health.crypto_healthy = true;
   g_health.min_heap = ESP.getFreeHeap();
   g_state_entered_ms = millis();
   g_pending_state = STATE_NO_FIX;
+  witness_mark_status_dirty(STATUS_DIRTY_ALL);
+  g_record_latency = metrics_histogram("securacv_witness_record_duration_seconds",
+                                       "Witness record creation time");
+  g_record_perf = perf_scope("witness_create_record");
+  g_state_perf = perf_scope("witness_update_state");
 
   Serial.printf("[OK] Device ID: %s\n", g_device.device_id);
   Serial.printf("[OK] Boot count: %u\n", g_device.boot_count);
@@ -170,11 +483,45 @@ static void update_chain(const uint8_t payload_hash[32], uint32_t tb, WitnessRec
   memcpy(g_device.chain_head, rec->chain_hash, 32);
 }
 
+void witness_set_record_sink(WitnessSinkFn fn, void* ctx) {
+  g_sink_ctx = ctx;
+  g_sink = fn;
+}
+
+static void emit_to_sink(const WitnessRecord* rec, const uint8_t* payload, size_t len) {
+  if (g_sink) g_sink(rec, payload, len, g_sink_ctx);
+}
+
+// Chain lock held: reserve the next turn at delivery
+static void deliver_take() {
+  if (g_deliver_mutex) xSemaphoreTakeRecursive(g_deliver_mutex, portMAX_DELAY);
+}
+
+static void deliver_give() {
+  if (g_deliver_mutex) xSemaphoreGiveRecursive(g_deliver_mutex);
+}
+
+static void maybe_persist_chain_state() {
+  #if FEATURE_CHAIN_JOURNAL
+  // Journal every final record; NVS becomes a rare checkpoint
+  if (journal_available() && journal_append(g_device.seq, g_device.chain_head)) {
+    if ((g_device.seq - g_device.seq_persisted) >= CHAIN_CHECKPOINT_INTERVAL) {
+      witness_persist_chain_state();
+    }
+    return;
+  }
+  #endif
+
+  if ((g_device.seq - g_device.seq_persisted) >= SD_PERSIST_INTERVAL) {
+    witness_persist_chain_state();
+  }
+}
+
 void witness_persist_chain_state() {
-  nvs_store_u32(NVS_KEY_SEQ, g_device.seq);
-  nvs_store_bytes(NVS_KEY_CHAIN, g_device.chain_head, 32);
+  nvs_store_chain(g_device.seq, g_device.chain_head);
   g_device.seq_persisted = g_device.seq;
   g_health.chain_persists++;
+  witness_mark_status_dirty(STATUS_DIRTY_CHAIN);
 
   #if DEBUG_CHAIN
   Serial.print("[CHAIN] Persisted seq=");
@@ -182,51 +529,765 @@ void witness_persist_chain_state() {
   #endif
 }
 
+// ════════════════════════════════════════════════════════════════════════════
+// SELF-VERIFICATION POLICY
+// ════════════════════════════════════════════════════════════════════════════
+
+// Whether a freshly signed record is verified before witness_create_record returns
+static bool policy_verifies_inline(const WitnessRecord* rec) {
+  // Attestations, tamper alerts and checkpoints always get full assurance
+  if (rec->type == RECORD_BOOT_ATTESTATION || rec->type == RECORD_TAMPER_ALERT ||
+      rec->type == RECORD_CHECKPOINT) {
+    return true;
+  }
+
+  switch (g_verify_policy) {
+    case VERIFY_SAMPLED:
+      return g_verify_sample_n <= 1 || (rec->seq % g_verify_sample_n) == 0;
+    case VERIFY_DEFERRED:
+      return g_auditor_task == nullptr;  // No auditor running: verify inline
+    default:
+      return true;
+  }
+}
+
+static void audit_enqueue(const WitnessRecord* rec) {
+  portENTER_CRITICAL(&g_audit_mux);
+  size_t idx = (g_audit_head + g_audit_count) % AUDITOR_RING_SIZE;
+  if (g_audit_count == AUDITOR_RING_SIZE) {
+    // Oldest unaudited record is dropped; counted so it shows in health
+    g_audit_head = (g_audit_head + 1) % AUDITOR_RING_SIZE;
+    g_health.audit_overruns++;
+  } else {
+    g_audit_count++;
+  }
+  g_audit_ring[idx] = *rec;
+  g_health.audit_pending = g_audit_count;
+  portEXIT_CRITICAL(&g_audit_mux);
+}
+
+static bool audit_dequeue(WitnessRecord* out) {
+  bool have = false;
+  portENTER_CRITICAL(&g_audit_mux);
+  if (g_audit_count > 0) {
+    *out = g_audit_ring[g_audit_head];
+    g_audit_head = (g_audit_head + 1) % AUDITOR_RING_SIZE;
+    g_audit_count--;
+    g_health.audit_pending = g_audit_count;
+    have = true;
+  }
+  portEXIT_CRITICAL(&g_audit_mux);
+  return have;
+}
+
+static void auditor_task(void* arg) {
+  (void)arg;
+  WitnessRecord rec;
+
+  for (;;) {
+    vTaskDelay(pdMS_TO_TICKS(AUDITOR_INTERVAL_MS));
+
+    while (audit_dequeue(&rec)) {
+      // Recompute the chain link, then check the signature over it
+      uint8_t expected[32];
+      compute_chain_hash(rec.prev_hash, rec.payload_hash, rec.seq, rec.time_bucket, expected);
+      bool ok = memcmp(expected, rec.chain_hash, 32) == 0 &&
+                crypto_verify(g_device.pubkey, rec.chain_hash, 32, rec.signature);
+
+      if (ok) {
+        g_health.records_verified++;
+        g_health.records_audited++;
+        if (g_last_record.seq == rec.seq) {
+          g_last_record.verified = true;
+        }
+      } else {
+        g_health.verify_failures++;
+        g_health.crypto_healthy = false;
+        log_health(LOG_LEVEL_CRITICAL, LOG_CAT_CRYPTO, LOG_MSG_DEFERRED_VERIFY_FAILED, LogArg::seq(rec.seq));
+      }
+      witness_mark_status_dirty(STATUS_DIRTY_CHAIN | STATUS_DIRTY_HEALTH);
+    }
+  }
+}
+
+void witness_set_verify_policy(VerifyPolicy policy, uint32_t sample_n) {
+  g_verify_policy = policy;
+  g_verify_sample_n = sample_n > 0 ? sample_n : 1;
+  witness_mark_status_dirty(STATUS_DIRTY_CHAIN);
+}
+
+VerifyPolicy witness_get_verify_policy() {
+  return g_verify_policy;
+}
+
+bool witness_auditor_begin() {
+  if (g_auditor_task) return true;
+
+  BaseType_t ret = xTaskCreatePinnedToCore(
+    auditor_task, "witness_audit", AUDITOR_TASK_STACK, nullptr,
+    AUDITOR_TASK_PRIORITY, &g_auditor_task, SIGNER_TASK_CORE);
+
+  if (ret != pdPASS) {
+    g_auditor_task = nullptr;
+    Serial.println("[!!] Auditor task creation failed");
+    return false;
+  }
+
+  Serial.printf("[OK] Witness auditor running (ring %d)\n", AUDITOR_RING_SIZE);
+  return true;
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// MERKLE BATCH SIGNING
+// ════════════════════════════════════════════════════════════════════════════
+
+static void merkle_leaf(const uint8_t chain_hash[32], uint8_t out[32]) {
+  sha256_domain("securacv:merkle:leaf:v1", chain_hash, 32, out);
+}
+
+static void merkle_node(const uint8_t left[32], const uint8_t right[32], uint8_t out[32]) {
+  uint8_t buf[64];
+  memcpy(buf, left, 32);
+  memcpy(buf + 32, right, 32);
+  sha256_domain("securacv:merkle:node:v1", buf, sizeof(buf), out);
+}
+
+// Signed message: H("securacv:batch:v1" || 0x00 || root || first_seq LE || size)
+static void batch_digest(const uint8_t root[32], uint32_t first_seq, uint8_t size, uint8_t out[32]) {
+  uint8_t buf[37];
+  memcpy(buf, root, 32);
+  buf[32] = (uint8_t)(first_seq & 0xFF);
+  buf[33] = (uint8_t)((first_seq >> 8) & 0xFF);
+  buf[34] = (uint8_t)((first_seq >> 16) & 0xFF);
+  buf[35] = (uint8_t)((first_seq >> 24) & 0xFF);
+  buf[36] = size;
+  sha256_domain("securacv:batch:v1", buf, sizeof(buf), out);
+}
+
+// Build the tree, sign the root once and hand out proofs. Chain lock held.
+// Returns true if a batch was sealed: the caller then holds the delivery
+// lock and must call deliver_sealed() once it has released the chain lock.
+static bool batch_seal_locked() {
+  size_t n = g_batch_count;
+  if (n == 0) return false;
+
+  uint32_t t0 = micros();
+
+  // Level 0 = leaves; an odd node at the end of a level is carried up as-is
+  size_t width[WITNESS_MERKLE_DEPTH + 1];
+  size_t levels = 0;
+  width[0] = n;
+  for (size_t i = 0; i < n; i++) {
+    merkle_leaf(g_batch[i].rec.chain_hash, g_merkle_tree[0][i]);
+  }
+  while (width[levels] > 1) {
+    size_t w = width[levels];
+    size_t nw = (w + 1) / 2;
+    for (size_t j = 0; j < w / 2; j++) {
+      merkle_node(g_merkle_tree[levels][2 * j], g_merkle_tree[levels][2 * j + 1],
+                  g_merkle_tree[levels + 1][j]);
+    }
+    if (w & 1) {
+      memcpy(g_merkle_tree[levels + 1][nw - 1], g_merkle_tree[levels][w - 1], 32);
+    }
+    width[++levels] = nw;
+  }
+  const uint8_t* root = g_merkle_tree[levels][0];
+
+  uint32_t first_seq = g_batch[0].rec.seq;
+  uint8_t digest[32];
+  uint8_t sig[64];
+  batch_digest(root, first_seq, (uint8_t)n, digest);
+  crypto_sign(g_device.privkey, g_device.pubkey, digest, 32, sig);
+
+  // One verification per batch regardless of the per-record policy
+  bool ok = crypto_verify(g_device.pubkey, digest, 32, sig);
+
+  for (size_t i = 0; i < n; i++) {
+    WitnessRecord& rec = g_batch[i].rec;
+    rec.pending = false;
+    rec.batched = true;
+    rec.batch_first_seq = first_seq;
+    rec.batch_size = (uint8_t)n;
+    rec.leaf_index = (uint8_t)i;
+    memcpy(rec.merkle_root, root, 32);
+    memcpy(rec.signature, sig, 64);
+    rec.verified = ok;
+
+    uint8_t p = 0;
+    for (size_t level = 0; level < levels; level++) {
+      size_t sib = (i >> level) ^ 1;
+      if (sib < width[level]) {
+        memcpy(rec.proof[p++], g_merkle_tree[level][sib], 32);
+      }
+    }
+    rec.proof_len = p;
+  }
+
+  g_health.stage_seal_us = micros() - t0;
+  g_health.batches_sealed++;
+  if (ok) {
+    g_health.records_verified += n;
+  } else {
+    g_health.verify_failures++;
+  }
+  g_last_record = g_batch[n - 1].rec;
+
+  // Waits out a delivery still running on another task, which then no
+  // longer needs the other buffer
+  deliver_take();
+  g_sealed = g_batch;
+  g_sealed_count = n;
+  g_sealed_ok = ok;
+  g_batch = g_batch == g_batch_buf[0] ? g_batch_buf[1] : g_batch_buf[0];
+  g_batch_count = 0;
+  g_health.batch_pending = 0;
+  witness_mark_status_dirty(STATUS_DIRTY_CHAIN);
+
+  maybe_persist_chain_state();
+  return true;
+}
+
+// Chain lock released: hand out the batch batch_seal_locked() sealed, then
+// give up the delivery turn it took
+static void deliver_sealed() {
+  if (!g_sealed_ok) {
+    log_health(LOG_LEVEL_CRITICAL, LOG_CAT_CRYPTO, LOG_MSG_BATCH_VERIFY_FAILED);
+  }
+  for (size_t i = 0; i < g_sealed_count; i++) {
+    BatchSlot& slot = g_sealed[i];
+    if (g_sealed_ok) emit_to_sink(&slot.rec, slot.payload, slot.payload_len);
+    if (slot.cb) slot.cb(&slot.rec, g_sealed_ok, slot.ctx);
+  }
+  g_sealed = nullptr;
+  g_sealed_count = 0;
+  deliver_give();
+}
+
+void witness_set_batch_mode(bool enabled) {
+  if (!enabled) witness_batch_flush();
+  g_batch_mode = enabled;
+  witness_mark_status_dirty(STATUS_DIRTY_CHAIN);
+}
+
+bool witness_get_batch_mode() {
+  return g_batch_mode;
+}
+
+void witness_batch_poll() {
+  if (g_batch_count == 0) return;
+  if (g_chain_mutex) xSemaphoreTake(g_chain_mutex, portMAX_DELAY);
+  bool due = g_batch_count >= WITNESS_BATCH_SIZE ||
+             (g_batch_count > 0 && (millis() - g_batch_opened_ms) >= WITNESS_BATCH_WINDOW_MS);
+  bool sealed = due && batch_seal_locked();
+  if (g_chain_mutex) xSemaphoreGive(g_chain_mutex);
+  if (sealed) deliver_sealed();
+}
+
+void witness_batch_flush() {
+  if (g_chain_mutex) xSemaphoreTake(g_chain_mutex, portMAX_DELAY);
+  bool sealed = batch_seal_locked();
+  if (g_chain_mutex) xSemaphoreGive(g_chain_mutex);
+  if (sealed) deliver_sealed();
+}
+
+bool witness_verify_inclusion(const WitnessRecord* rec) {
+  if (!rec->batched || rec->batch_size == 0 || rec->leaf_index >= rec->batch_size) {
+    return false;
+  }
+
+  uint8_t h[32];
+  merkle_leaf(rec->chain_hash, h);
+
+  size_t idx = rec->leaf_index;
+  size_t w = rec->batch_size;
+  uint8_t p = 0;
+  while (w > 1) {
+    size_t sib = idx ^ 1;
+    if (sib < w) {
+      if (p >= rec->proof_len) return false;
+      if (idx & 1) {
+        merkle_node(rec->proof[p], h, h);
+      } else {
+        merkle_node(h, rec->proof[p], h);
+      }
+      p++;
+    }
+    idx >>= 1;
+    w = (w + 1) / 2;
+  }
+
+  if (p != rec->proof_len || memcmp(h, rec->merkle_root, 32) != 0) {
+    return false;
+  }
+
+  uint8_t digest[32];
+  batch_digest(rec->merkle_root, rec->batch_first_seq, rec->batch_size, digest);
+  return crypto_verify(g_device.pubkey, digest, 32, rec->signature);
+}
+
+// Root over a contiguous run of chain hashes, same shape as batch_seal_locked()
+static void merkle_root(const uint8_t (*hashes)[32], size_t n, uint8_t root[32]) {
+  uint8_t level[WITNESS_BATCH_SIZE][32];
+  for (size_t i = 0; i < n; i++) {
+    merkle_leaf(hashes[i], level[i]);
+  }
+  size_t w = n;
+  while (w > 1) {
+    size_t nw = (w + 1) / 2;
+    for (size_t j = 0; j < w / 2; j++) {
+      merkle_node(level[2 * j], level[2 * j + 1], level[j]);
+    }
+    if (w & 1) {
+      memcpy(level[nw - 1], level[w - 1], 32);
+    }
+    w = nw;
+  }
+  memcpy(root, level[0], 32);
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// RANGE VERIFICATION
+// ════════════════════════════════════════════════════════════════════════════
+
+void WitnessRangeVerifier::begin(uint32_t start_seq, const uint8_t* anchor_hash) {
+  memset(&m_report, 0, sizeof(m_report));
+  m_report.start_seq = start_seq;
+  m_report.anchored = anchor_hash != nullptr;
+  m_start_ms = millis();
+
+  m_have_prev = anchor_hash != nullptr;
+  m_prev_seq = start_seq - 1;
+  if (anchor_hash) memcpy(m_prev_hash, anchor_hash, 32);
+
+  m_batch_size = 0;
+  m_batch_count = 0;
+}
+
+void WitnessRangeVerifier::fail(uint32_t seq, bool chain) {
+  if (chain) {
+    m_report.chain_failures++;
+  } else {
+    m_report.sig_failures++;
+  }
+  if (m_report.first_bad_seq == 0) m_report.first_bad_seq = seq;
+}
+
+// Verify the accumulated batch once, or count it unverified if the range cut it
+void WitnessRangeVerifier::flushBatch(bool complete) {
+  if (m_batch_count == 0) return;
+
+  if (complete) {
+    uint8_t root[32];
+    uint8_t digest[32];
+    merkle_root(m_batch_hashes, m_batch_count, root);
+    batch_digest(root, m_batch_first, m_batch_size, digest);
+    m_report.sig_checks++;
+    if (!crypto_verify(g_device.pubkey, digest, 32, m_batch_sig)) {
+      m_report.sig_failures += m_batch_count;
+      if (m_report.first_bad_seq == 0) m_report.first_bad_seq = m_batch_first;
+    }
+  } else {
+    m_report.unverified += m_batch_count;
+  }
+
+  m_batch_size = 0;
+  m_batch_count = 0;
+}
+
+void WitnessRangeVerifier::feed(uint32_t seq, uint32_t time_bucket, uint8_t flags_batched,
+                                uint8_t batch_size, uint8_t leaf_index,
+                                const uint8_t chain_hash[32], const uint8_t signature[64],
+                                const uint8_t* payload, size_t payload_len) {
+  m_report.records++;
+  m_report.end_seq = seq;
+
+  // Link check needs the immediate predecessor
+  if (m_have_prev && seq == m_prev_seq + 1) {
+    uint8_t payload_hash[32];
+    uint8_t expected[32];
+    sha256_domain("securacv:payload:v1", payload, payload_len, payload_hash);
+    compute_chain_hash(m_prev_hash, payload_hash, seq, time_bucket, expected);
+    if (memcmp(expected, chain_hash, 32) != 0) {
+      fail(seq, true);
+    }
+  } else if (m_have_prev || seq != m_report.start_seq) {
+    m_report.gaps += (seq > m_prev_seq + 1) ? (seq - m_prev_seq - 1) : 1;
+  }
+
+  m_have_prev = true;
+  m_prev_seq = seq;
+  memcpy(m_prev_hash, chain_hash, 32);
+
+  if (!flags_batched) {
+    flushBatch(false);
+    m_report.sig_checks++;
+    if (!crypto_verify(g_device.pubkey, chain_hash, 32, signature)) {
+      fail(seq, false);
+    }
+    return;
+  }
+
+  // Batched: gather the batch, check the root once when its last leaf arrives
+  bool continues = m_batch_count > 0 && leaf_index == m_batch_count &&
+                   batch_size == m_batch_size && seq == m_batch_first + leaf_index &&
+                   memcmp(signature, m_batch_sig, 64) == 0;
+  if (!continues) {
+    flushBatch(false);
+    if (leaf_index != 0 || batch_size == 0 || batch_size > WITNESS_BATCH_SIZE) {
+      m_report.unverified++;
+      return;
+    }
+    m_batch_first = seq;
+    m_batch_size = batch_size;
+    memcpy(m_batch_sig, signature, 64);
+  }
+
+  memcpy(m_batch_hashes[m_batch_count++], chain_hash, 32);
+  if (m_batch_count == m_batch_size) {
+    flushBatch(true);
+  }
+}
+
+const WitnessRangeReport& WitnessRangeVerifier::finish() {
+  flushBatch(false);
+  m_report.elapsed_ms = millis() - m_start_ms;
+  m_report.records_per_sec = m_report.elapsed_ms
+    ? (uint32_t)((uint64_t)m_report.records * 1000 / m_report.elapsed_ms)
+    : m_report.records;
+  return m_report;
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// CHAIN CHECKPOINTS
+// ════════════════════════════════════════════════════════════════════════════
+
+// Exact only under the chain lock
+static bool checkpoint_due() {
+  return WITNESS_CHECKPOINT_INTERVAL > 0 && (int32_t)(g_device.seq - g_checkpoint_due_seq) >= 0;
+}
+
+// if_due: only write it if still due once the lock is held, since another
+// task may have checkpointed since the caller looked
+static bool checkpoint(WitnessRecord* out, bool if_due) {
+  if (!g_device.initialized) return false;
+  WitnessRecord rec;
+  if (!out) out = &rec;
+
+  if (g_chain_mutex) xSemaphoreTake(g_chain_mutex, portMAX_DELAY);
+  if (if_due && !checkpoint_due()) {
+    if (g_chain_mutex) xSemaphoreGive(g_chain_mutex);
+    return false;
+  }
+
+  // Only final records are covered; the payload is built under the lock so
+  // "head" is exactly the link the checkpoint extends
+  bool sealed = batch_seal_locked();
+
+  uint8_t payload[96];
+  CborWriter cbor(payload, sizeof(payload));
+  cbor.map(5)                                   // Keys in deterministic order
+      .key("seq").uint(g_device.seq)
+      .key("head").bytes(g_device.chain_head, 32)
+      .key("prev").uint(g_device.checkpoint_seq)
+      .key("boots").uint(g_device.boot_count)
+      .key("tampers").uint(g_device.tamper_count);
+  size_t len = cbor.size();
+
+  uint8_t payload_hash[32];
+  sha256_domain("securacv:payload:v1", payload, len, payload_hash);
+  update_chain(payload_hash, time_bucket(), out);
+  out->type = RECORD_CHECKPOINT;
+  out->payload_len = len;
+  out->pending = false;
+  out->batched = false;
+  out->batch_first_seq = 0;
+  out->batch_size = 0;
+  out->leaf_index = 0;
+  out->proof_len = 0;
+
+  crypto_sign(g_device.privkey, g_device.pubkey, out->chain_hash, 32, out->signature);
+  out->verified = crypto_verify(g_device.pubkey, out->chain_hash, 32, out->signature);
+
+  // Retried one interval later either way, so a failing signer cannot
+  // turn every record into a checkpoint attempt
+  g_checkpoint_due_seq = out->seq + WITNESS_CHECKPOINT_INTERVAL;
+
+  if (!out->verified) {
+    g_health.verify_failures++;
+    witness_mark_status_dirty(STATUS_DIRTY_CHAIN);
+    if (g_chain_mutex) xSemaphoreGive(g_chain_mutex);
+    if (sealed) deliver_sealed();
+    log_health(LOG_LEVEL_CRITICAL, LOG_CAT_CRYPTO, LOG_MSG_CHECKPOINT_FAILED, LogArg::seq(out->seq));
+    return false;
+  }
+
+  g_health.records_created++;
+  g_health.records_verified++;
+  g_health.checkpoints++;
+  g_device.checkpoint_seq = out->seq;
+  g_last_record = *out;
+  nvs_store_u32(NVS_KEY_CKPT, out->seq);
+
+  maybe_persist_chain_state();
+
+  witness_mark_status_dirty(STATUS_DIRTY_CHAIN);
+  deliver_take();
+  if (g_chain_mutex) xSemaphoreGive(g_chain_mutex);
+  if (sealed) deliver_sealed();
+  emit_to_sink(out, payload, len);
+  deliver_give();
+  return true;
+}
+
+bool witness_checkpoint(WitnessRecord* out) {
+  return checkpoint(out, false);
+}
+
+// After each record; the unlocked read only decides whether to try, and
+// checkpoint() tests again under the lock
+static void maybe_checkpoint() {
+  if (checkpoint_due()) {
+    checkpoint(nullptr, true);
+  }
+}
+
 // ════════════════════════════════════════════════════════════════════════════
 // RECORD CREATION
 // ════════════════════════════════════════════════════════════════════════════
 
-bool witness_create_record(const uint8_t* payload, size_t len, RecordType type, WitnessRecord* out) {
+// Create and chain a record. cb (if any) is invoked once the record is signed:
+// immediately for individually signed records, at seal time for batched ones.
+// The sink and callbacks run after the chain lock is released.
+static bool create_record(const uint8_t* payload, size_t len, RecordType type, WitnessRecord* out,
+                          WitnessRecordCallback cb, void* ctx) {
+  MetricTimer timer(g_record_latency);
+  PerfTimer perf(g_record_perf);
+  uint32_t t0 = micros();
+
   // Hash payload
   uint8_t payload_hash[32];
   sha256_domain("securacv:payload:v1", payload, len, payload_hash);
+  uint32_t t1 = micros();
+
+  if (g_chain_mutex) xSemaphoreTake(g_chain_mutex, portMAX_DELAY);
+
+  // Attestations and tamper alerts are signed on their own; seal first so
+  // every batch covers a contiguous sequence range
+  bool batch = g_batch_mode && type != RECORD_BOOT_ATTESTATION && type != RECORD_TAMPER_ALERT &&
+               len <= WITNESS_MAX_PAYLOAD;
+  bool sealed = !batch && batch_seal_locked();
 
   // Update chain
   uint32_t tb = time_bucket();
   update_chain(payload_hash, tb, out);
   out->type = type;
   out->payload_len = len;
+  out->pending = batch;
+  out->batched = false;
+  out->batch_first_seq = 0;
+  out->batch_size = 0;
+  out->leaf_index = 0;
+  out->proof_len = 0;
+
+  if (batch) {
+    memset(out->signature, 0, sizeof(out->signature));
+    out->verified = false;
+
+    if (g_batch_count == 0) g_batch_opened_ms = millis();
+    BatchSlot& slot = g_batch[g_batch_count++];
+    slot.rec = *out;
+    slot.cb = cb;
+    slot.ctx = ctx;
+    slot.payload_len = (uint16_t)len;
+    memcpy(slot.payload, payload, len);
+
+    g_health.stage_hash_us = t1 - t0;
+    g_health.records_created++;
+    g_health.batch_pending = g_batch_count;
+
+    // The record that fills the batch comes back final
+    if (g_batch_count >= WITNESS_BATCH_SIZE && batch_seal_locked()) {
+      sealed = true;
+      *out = g_sealed[g_sealed_count - 1].rec;
+    }
+
+    witness_mark_status_dirty(STATUS_DIRTY_CHAIN);
+    if (g_chain_mutex) xSemaphoreGive(g_chain_mutex);
+    if (sealed) deliver_sealed();
+    maybe_checkpoint();
+    return true;
+  }
 
   // Sign chain hash
   crypto_sign(g_device.privkey, g_device.pubkey, out->chain_hash, 32, out->signature);
+  uint32_t t2 = micros();
 
-  // Verify immediately
-  out->verified = crypto_verify(g_device.pubkey, out->chain_hash, 32, out->signature);
+  // Self-verify according to policy
+  bool verify_now = policy_verifies_inline(out);
+  out->verified = verify_now &&
+                  crypto_verify(g_device.pubkey, out->chain_hash, 32, out->signature);
+  uint32_t t3 = micros();
 
-  if (!out->verified) {
+  g_health.stage_hash_us = t1 - t0;
+  g_health.stage_sign_us = t2 - t1;
+  g_health.stage_verify_us = t3 - t2;
+
+  if (verify_now && !out->verified) {
     g_health.verify_failures++;
+    witness_mark_status_dirty(STATUS_DIRTY_CHAIN);
+    if (g_chain_mutex) xSemaphoreGive(g_chain_mutex);
+    if (sealed) deliver_sealed();
+    if (cb) cb(out, false, ctx);
     return false;
   }
 
   g_health.records_created++;
-  g_health.records_verified++;
-
-  // Persist chain state periodically
-  if ((g_device.seq - g_device.seq_persisted) >= SD_PERSIST_INTERVAL) {
-    witness_persist_chain_state();
+  if (verify_now) {
+    g_health.records_verified++;
+  } else if (g_verify_policy == VERIFY_DEFERRED) {
+    audit_enqueue(out);
+  } else {
+    g_health.verify_skipped++;
   }
+  g_last_record = *out;
 
-  #if FEATURE_SD_STORAGE
-  g_health.sd_writes++;
-  #endif
+  // Persist chain state periodically
+  maybe_persist_chain_state();
 
+  // Delivered in chain order, after any batch this record sealed
+  witness_mark_status_dirty(STATUS_DIRTY_CHAIN);
+  deliver_take();
+  if (g_chain_mutex) xSemaphoreGive(g_chain_mutex);
+  if (sealed) deliver_sealed();
+  emit_to_sink(out, payload, len);
+  if (cb) cb(out, true, ctx);
+  deliver_give();
+  maybe_checkpoint();
   return true;
 }
 
+bool witness_create_record(const uint8_t* payload, size_t len, RecordType type, WitnessRecord* out) {
+  return create_record(payload, len, type, out, nullptr, nullptr);
+}
+
 bool witness_verify_record(const WitnessRecord* rec) {
+  if (rec->batched) {
+    return witness_verify_inclusion(rec);
+  }
   return crypto_verify(g_device.pubkey, rec->chain_hash, 32, rec->signature);
 }
 
+// ════════════════════════════════════════════════════════════════════════════
+// ASYNC SIGNER PIPELINE
+// ════════════════════════════════════════════════════════════════════════════
+
+static void signer_task(void* arg) {
+  (void)arg;
+  WitnessJob job;
+
+  for (;;) {
+    // Wake periodically in batch mode so a partial batch is sealed on time
+    TickType_t wait = g_batch_mode ? pdMS_TO_TICKS(WITNESS_BATCH_WINDOW_MS / 2) : portMAX_DELAY;
+    if (xQueueReceive(g_signer_queue, &job, wait) != pdTRUE) {
+      witness_batch_poll();
+      continue;
+    }
+
+    uint32_t start = micros();
+    g_health.stage_queue_us = start - job.enqueue_us;
+
+    WitnessRecord rec;
+    create_record(job.payload, job.len, job.type, &rec, job.cb, job.ctx);
+    witness_batch_poll();
+
+    uint32_t total = micros() - job.enqueue_us;
+    if (total > g_health.stage_total_max_us) {
+      g_health.stage_total_max_us = total;
+    }
+    g_health.signer_queue_depth = uxQueueMessagesWaiting(g_signer_queue);
+    witness_mark_status_dirty(STATUS_DIRTY_CHAIN);
+  }
+}
+
+bool witness_signer_begin() {
+  if (g_signer_task) return true;
+
+  if (!g_chain_mutex) {
+    g_chain_mutex = xSemaphoreCreateMutex();
+    if (!g_chain_mutex) return false;
+  }
+  if (!g_deliver_mutex) {
+    g_deliver_mutex = xSemaphoreCreateRecursiveMutex();
+    if (!g_deliver_mutex) return false;
+  }
+
+  g_signer_queue = xQueueCreate(SIGNER_QUEUE_LEN, sizeof(WitnessJob));
+  if (!g_signer_queue) {
+    Serial.println("[!!] Signer queue allocation failed");
+    return false;
+  }
+
+  BaseType_t ret = xTaskCreatePinnedToCore(
+    signer_task, "witness_signer", SIGNER_TASK_STACK, nullptr,
+    SIGNER_TASK_PRIORITY, &g_signer_task, SIGNER_TASK_CORE);
+
+  if (ret != pdPASS) {
+    vQueueDelete(g_signer_queue);
+    g_signer_queue = nullptr;
+    g_signer_task = nullptr;
+    Serial.println("[!!] Signer task creation failed");
+    return false;
+  }
+
+  Serial.printf("[OK] Witness signer on core %d (queue %d)\n", SIGNER_TASK_CORE, SIGNER_QUEUE_LEN);
+  return true;
+}
+
+bool witness_signer_running() {
+  return g_signer_task != nullptr;
+}
+
+bool witness_submit_record(const uint8_t* payload, size_t len, RecordType type,
+                           WitnessRecordCallback cb, void* ctx) {
+  if (len > WITNESS_MAX_PAYLOAD) {
+    g_health.signer_dropped++;
+    return false;
+  }
+
+  // No signer yet (early boot or disabled): create inline
+  if (!g_signer_queue) {
+    WitnessRecord rec;
+    return create_record(payload, len, type, &rec, cb, ctx);
+  }
+
+  WitnessJob job;
+  job.type = type;
+  job.len = (uint16_t)len;
+  job.cb = cb;
+  job.ctx = ctx;
+  memcpy(job.payload, payload, len);
+  job.enqueue_us = micros();
+
+  if (xQueueSend(g_signer_queue, &job, 0) != pdTRUE) {
+    g_health.signer_dropped++;
+    witness_mark_status_dirty(STATUS_DIRTY_CHAIN);
+    return false;
+  }
+
+  uint32_t depth = uxQueueMessagesWaiting(g_signer_queue);
+  g_health.signer_queue_depth = depth;
+  if (depth > g_health.signer_queue_peak) {
+    g_health.signer_queue_peak = depth;
+  }
+  witness_mark_status_dirty(STATUS_DIRTY_CHAIN);
+  return true;
+}
+
+size_t witness_signer_queue_depth() {
+  return g_signer_queue ? uxQueueMessagesWaiting(g_signer_queue) : 0;
+}
+
 // ════════════════════════════════════════════════════════════════════════════
 // STATE MACHINE
 // ════════════════════════════════════════════════════════════════════════════
@@ -242,6 +1303,7 @@ void witness_log_state_transition(FixState from, FixState to, const char* reason
 }
 
 void witness_update_state(bool has_valid_fix, uint32_t last_fix_ms, float speed_mps) {
+  PerfTimer perf(g_state_perf);
   uint32_t now = millis();
   g_speed_ema = g_speed_ema * (1.0f - SPEED_EMA_ALPHA) + speed_mps * SPEED_EMA_ALPHA;
 
@@ -313,43 +1375,165 @@ void witness_update_state(bool has_valid_fix, uint32_t last_fix_ms, float speed_
 // HEALTH LOGGING
 // ════════════════════════════════════════════════════════════════════════════
 
-void log_health(LogLevel level, LogCategory category, const char* message, const char* detail) {
-  // Skip DEBUG by default
-  if (level < LOG_LEVEL_INFO) return;
+// Store an argument into a ring field. Caller holds g_health_log_mux.
+static void log_field_store(LogField& field, const LogArg& arg) {
+  field.kind = arg.kind;
+  field.len = 0;
+  field.reserved = 0;
+  field.value = arg.value;
+  if (arg.kind != LOG_ARG_TEXT) return;
 
-  HealthLogRingEntry& entry = g_health_log_ring[g_health_log_ring_head];
-  entry.seq = ++g_device.log_seq;
-  entry.timestamp_ms = millis();
-  entry.level = level;
-  entry.category = category;
-  entry.ack_status = ACK_STATUS_UNREAD;
+  size_t len = strnlen(arg.text, HEALTH_LOG_TEXT_MAX);
+  uint32_t pos = g_health_log_text_pos;
+  size_t at = pos % HEALTH_LOG_TEXT_ARENA;
+  size_t first = len < HEALTH_LOG_TEXT_ARENA - at ? len : HEALTH_LOG_TEXT_ARENA - at;
+  memcpy(&g_health_log_text[at], arg.text, first);
+  memcpy(g_health_log_text, arg.text + first, len - first);
+  g_health_log_text_pos = pos + (uint32_t)len;
 
-  strncpy(entry.message, message ? message : "", sizeof(entry.message) - 1);
-  entry.message[sizeof(entry.message) - 1] = '\0';
+  field.len = (uint8_t)len;
+  field.value = pos;
+}
 
-  if (detail) {
-    strncpy(entry.detail, detail, sizeof(entry.detail) - 1);
-    entry.detail[sizeof(entry.detail) - 1] = '\0';
-  } else {
-    entry.detail[0] = '\0';
+size_t log_field_render(const LogField& field, char* out, size_t cap) {
+  if (cap == 0) return 0;
+  int n = 0;
+  switch (field.kind) {
+    case LOG_ARG_MSG:
+      n = snprintf(out, cap, "%s", log_msg_text((LogMsg)field.value));
+      break;
+    case LOG_ARG_SEQ:
+      n = snprintf(out, cap, "seq=%u", (unsigned)field.value);
+      break;
+    case LOG_ARG_TEXT: {
+      size_t len = field.len < cap - 1 ? field.len : cap - 1;
+      portENTER_CRITICAL(&g_health_log_mux);
+      bool live = g_health_log_text_pos - field.value <= HEALTH_LOG_TEXT_ARENA;
+      if (live) {
+        for (size_t i = 0; i < len; i++) {
+          out[i] = g_health_log_text[(field.value + i) % HEALTH_LOG_TEXT_ARENA];
+        }
+      }
+      portEXIT_CRITICAL(&g_health_log_mux);
+      if (!live) return (size_t)snprintf(out, cap, "...");
+      out[len] = '\0';
+      return len;
+    }
+    default:
+      out[0] = '\0';
+      return 0;
+  }
+  return n < 0 ? 0 : ((size_t)n < cap ? (size_t)n : cap - 1);
+}
+
+// Argument as text for the sink, which copies it before returning
+static const char* log_arg_text(const LogArg& arg, char* scratch, size_t cap) {
+  switch (arg.kind) {
+    case LOG_ARG_MSG:  return log_msg_text((LogMsg)arg.value);
+    case LOG_ARG_TEXT: return arg.text;
+    case LOG_ARG_SEQ:
+      snprintf(scratch, cap, "seq=%u", (unsigned)arg.value);
+      return scratch;
+    default:           return nullptr;
   }
+}
+
+// Take the slot for seq and drop its previous occupant from the indexes.
+// Caller holds g_health_log_mux, fills the entry, then calls health_log_index().
+static HealthLogRingEntry& health_log_claim(uint32_t seq) {
+  // Entries logged before provisioning restored log_seq from NVS are not
+  // contiguous with the ones after it; the range restarts at the new seq
+  if (seq != g_health_log_newest_seq + 1) g_health_log_ring_count = 0;
+  g_health_log_newest_seq = seq;
 
-  g_health_log_ring_head = (g_health_log_ring_head + 1) % HEALTH_LOG_RING_SIZE;
+  size_t slot = seq % HEALTH_LOG_RING_SIZE;
+  HealthLogRingEntry& entry = g_health_log_ring[slot];
+  index_clear(g_health_log_level_bits[entry.level % HEALTH_LOG_LEVELS], slot);
+  index_clear(g_health_log_cat_bits[entry.category % HEALTH_LOG_CATEGORIES], slot);
+  index_clear(g_health_log_unread_bits, slot);
+
+  g_health_log_ring_head = (slot + 1) % HEALTH_LOG_RING_SIZE;
   if (g_health_log_ring_count < HEALTH_LOG_RING_SIZE) {
     g_health_log_ring_count++;
   }
+  return entry;
+}
+
+static void health_log_index(const HealthLogRingEntry& entry) {
+  size_t slot = entry.seq % HEALTH_LOG_RING_SIZE;
+  index_set(g_health_log_level_bits[entry.level % HEALTH_LOG_LEVELS], slot);
+  index_set(g_health_log_cat_bits[entry.category % HEALTH_LOG_CATEGORIES], slot);
+  if (entry.ack_status == ACK_STATUS_UNREAD) index_set(g_health_log_unread_bits, slot);
+}
+
+static void log_health_args(LogLevel level, LogCategory category, const LogArg& message, const LogArg& detail) {
+  // Skip DEBUG by default
+  if (level < LOG_LEVEL_INFO) return;
+
+  portENTER_CRITICAL(&g_health_log_mux);
+  uint32_t seq = ++g_device.log_seq;
+  HealthLogRingEntry& entry = health_log_claim(seq);
+  entry.seq = seq;
+  entry.timestamp_ms = millis();
+  entry.level = level;
+  entry.category = category;
+  entry.ack_status = ACK_STATUS_UNREAD;
+  entry.reserved = 0;
+  log_field_store(entry.message, message);
+  log_field_store(entry.detail, detail);
+  health_log_index(entry);
 
   g_health.logs_stored++;
   if (log_level_requires_attention(level)) {
     g_health.logs_unacked++;
   }
+  portEXIT_CRITICAL(&g_health_log_mux);
+  witness_mark_status_dirty(STATUS_DIRTY_LOGS);
 
-  // Also print to Serial
-  Serial.printf("[%s/%s] %s", log_level_name(level), log_category_name(category), message);
-  if (detail && detail[0]) {
-    Serial.printf(" | %s", detail);
+  // Serial and other outputs are written by the sink task
+  char msg_scratch[16], detail_scratch[16];
+  log_sink_push(seq, level, category,
+                log_arg_text(message, msg_scratch, sizeof(msg_scratch)),
+                log_arg_text(detail, detail_scratch, sizeof(detail_scratch)));
+}
+
+void log_health(LogLevel level, LogCategory category, LogMsg message, LogArg detail) {
+  log_health_args(level, category, LogArg::msg(message), detail);
+}
+
+void log_health(LogLevel level, LogCategory category, LogMsg message, const char* detail) {
+  log_health_args(level, category, LogArg::msg(message), LogArg::str(detail));
+}
+
+void log_health(LogLevel level, LogCategory category, const char* message, const char* detail) {
+  log_health_args(level, category, LogArg::str(message ? message : ""), LogArg::str(detail));
+}
+
+void witness_restore_health_log(uint32_t seq, uint32_t timestamp_ms, LogLevel level,
+                                LogCategory category, const char* message, const char* detail) {
+  if (seq == 0) return;
+
+  portENTER_CRITICAL(&g_health_log_mux);
+  if (seq <= g_health_log_newest_seq && g_health_log_ring_count > 0) {
+    portEXIT_CRITICAL(&g_health_log_mux);
+    return;
   }
-  Serial.println();
+  if (seq > g_device.log_seq) g_device.log_seq = seq;
+
+  HealthLogRingEntry& entry = health_log_claim(seq);
+  entry.seq = seq;
+  entry.timestamp_ms = timestamp_ms;
+  entry.level = level;
+  entry.category = category;
+  entry.ack_status = log_level_is_security(level) ? ACK_STATUS_UNREAD : ACK_STATUS_ARCHIVED;
+  entry.reserved = 0;
+  log_field_store(entry.message, LogArg::str(message ? message : ""));
+  log_field_store(entry.detail, LogArg::str(detail && detail[0] ? detail : nullptr));
+  health_log_index(entry);
+
+  if (entry.ack_status == ACK_STATUS_UNREAD) g_health.logs_unacked++;
+  portEXIT_CRITICAL(&g_health_log_mux);
+  witness_mark_status_dirty(STATUS_DIRTY_LOGS);
 }
 
 void health_log(LogLevel level, LogCategory category, const char* message) {
@@ -357,15 +1541,46 @@ void health_log(LogLevel level, LogCategory category, const char* message) {
 }
 
 bool acknowledge_log_entry(uint32_t log_seq, AckStatus new_status, const char* reason) {
+  bool found = false;
+  bool dirty = false;
+
+  portENTER_CRITICAL(&g_health_log_mux);
+  HealthLogRingEntry* entry = health_log_find_locked(log_seq);
+  if (entry) {
+    if (entry->ack_status == ACK_STATUS_UNREAD && log_level_requires_attention(entry->level)) {
+      if (g_health.logs_unacked > 0) g_health.logs_unacked--;
+      dirty = true;
+    }
+    entry->ack_status = new_status;
+    if (new_status == ACK_STATUS_UNREAD) {
+      index_set(g_health_log_unread_bits, log_seq % HEALTH_LOG_RING_SIZE);
+    } else {
+      index_clear(g_health_log_unread_bits, log_seq % HEALTH_LOG_RING_SIZE);
+    }
+    found = true;
+  }
+  portEXIT_CRITICAL(&g_health_log_mux);
+
+  if (dirty) witness_mark_status_dirty(STATUS_DIRTY_LOGS);
+  return found;
+}
+
+size_t acknowledge_all_log_entries(AckStatus new_status) {
+  size_t acked = 0;
+
+  portENTER_CRITICAL(&g_health_log_mux);
   for (size_t i = 0; i < g_health_log_ring_count; i++) {
-    HealthLogRingEntry& entry = g_health_log_ring[i];
-    if (entry.seq == log_seq) {
-      if (entry.ack_status == ACK_STATUS_UNREAD && log_level_requires_attention(entry.level)) {
-        if (g_health.logs_unacked > 0) g_health.logs_unacked--;
-      }
+    HealthLogRingEntry& entry = g_health_log_ring[(g_health_log_ring_head + HEALTH_LOG_RING_SIZE - 1 - i) %
+                                                  HEALTH_LOG_RING_SIZE];
+    if (entry.ack_status == ACK_STATUS_UNREAD) {
       entry.ack_status = new_status;
-      return true;
+      acked++;
     }
   }
-  return false;
+  memset(g_health_log_unread_bits, 0, sizeof(g_health_log_unread_bits));
+  g_health.logs_unacked = 0;
+  portEXIT_CRITICAL(&g_health_log_mux);
+
+  witness_mark_status_dirty(STATUS_DIRTY_LOGS);
+  return acked;
 }
@@ -14,6 +14,7 @@
 #include <stdint.h>
 #include "canary_config.h"
 #include "log_level.h"
+#include "log_messages.h"
 
 // ════════════════════════════════════════════════════════════════════════════
 // TYPES
@@ -32,6 +33,13 @@ enum RecordType : uint8_t {
   RECORD_WITNESS_EVENT    = 1,
   RECORD_TAMPER_ALERT     = 2,
   RECORD_STATE_CHANGE     = 3,
+  RECORD_CHECKPOINT       = 7,   // Signed chain summary (record_type_t numbering)
+};
+
+enum VerifyPolicy : uint8_t {
+  VERIFY_ALWAYS   = 0,   // Verify every signature inline
+  VERIFY_SAMPLED  = 1,   // Verify every Nth routine record inline
+  VERIFY_DEFERRED = 2,   // Hand routine records to the background auditor
 };
 
 struct WitnessRecord {
@@ -44,6 +52,18 @@ struct WitnessRecord {
   uint8_t     signature[64];
   size_t      payload_len;
   bool        verified;
+  bool        pending;        // Batch mode: chained, not yet signed (signature zero)
+
+  // Merkle batch membership (batched=false: signature covers chain_hash).
+  // When batched, signature covers H(root || batch_first_seq || batch_size)
+  // and proof[] links chain_hash to merkle_root.
+  bool        batched;
+  uint32_t    batch_first_seq;
+  uint8_t     batch_size;
+  uint8_t     leaf_index;
+  uint8_t     proof_len;
+  uint8_t     merkle_root[32];
+  uint8_t     proof[WITNESS_MERKLE_DEPTH][32];
 };
 
 struct DeviceIdentity {
@@ -57,6 +77,7 @@ struct DeviceIdentity {
   uint32_t boot_ms;
   uint32_t tamper_count;
   uint32_t log_seq;
+  uint32_t checkpoint_seq;   // Last checkpoint record (0 = none yet)
   bool     initialized;
   bool     tamper_active;
   char     device_id[32];
@@ -73,6 +94,7 @@ struct SystemHealth {
   uint32_t gsa_count;
   uint32_t gsv_count;
   uint32_t vtg_count;
+  uint32_t ubx_pvt_count;
   uint32_t chain_persists;
   uint32_t state_changes;
   uint32_t tamper_events;
@@ -86,21 +108,85 @@ struct SystemHealth {
   uint32_t sd_errors;
   uint32_t logs_stored;
   uint32_t logs_unacked;
+
+  // Signer pipeline (queue depth and last per-stage latency in microseconds)
+  uint32_t signer_queue_depth;
+  uint32_t signer_queue_peak;
+  uint32_t signer_dropped;
+  uint32_t stage_queue_us;
+  uint32_t stage_hash_us;
+  uint32_t stage_sign_us;
+  uint32_t stage_verify_us;
+  uint32_t stage_total_max_us;
+
+  // Self-verification policy
+  uint32_t verify_skipped;     // Not verified under VERIFY_SAMPLED
+  uint32_t audit_pending;      // Waiting for the auditor
+  uint32_t audit_overruns;     // Evicted from the audit ring unverified
+  uint32_t records_audited;
+
+  // Merkle batch signing
+  uint32_t batches_sealed;
+  uint32_t batch_pending;      // Chained, awaiting the batch signature
+  uint32_t stage_seal_us;      // Last tree build + sign + verify
+
+  // Chain checkpoints and the boot chain check
+  uint32_t checkpoints;        // Written this boot
+  uint32_t boot_check_from;    // Checkpoint seq the check started at (0 = none)
+  uint32_t boot_check_records;
+  uint32_t boot_check_ms;
+  bool     boot_check_done;
+  bool     boot_check_ok;
+
+  // Power (securacv_power)
+  uint32_t cpu_duty_pct;       // Non-idle share of CPU time, both cores
+
   bool     gps_healthy;
   bool     crypto_healthy;
   bool     sd_healthy;
   bool     wifi_active;
+  bool     light_sleep;        // Automatic light sleep enabled
 };
 
-// Health log ring buffer entry
+// Typed health-log argument. Fixed text is an interned LogMsg; anything
+// built at runtime is copied into a shared text arena at log time.
+enum LogArgKind : uint8_t {
+  LOG_ARG_NONE = 0,
+  LOG_ARG_MSG  = 1,   // value = LogMsg
+  LOG_ARG_TEXT = 2,   // value = arena position, len = bytes
+  LOG_ARG_SEQ  = 3    // value = record seq, rendered "seq=N"
+};
+
+// What a caller passes; text is only read during the log_health() call
+struct LogArg {
+  LogArgKind kind;
+  uint32_t value;
+  const char* text;
+
+  static LogArg none() { return {LOG_ARG_NONE, 0, nullptr}; }
+  static LogArg msg(LogMsg id) { return {LOG_ARG_MSG, id, nullptr}; }
+  static LogArg str(const char* s) { return {s ? LOG_ARG_TEXT : LOG_ARG_NONE, 0, s}; }
+  static LogArg seq(uint32_t s) { return {LOG_ARG_SEQ, s, nullptr}; }
+};
+
+// What a ring entry stores
+struct LogField {
+  LogArgKind kind;
+  uint8_t len;
+  uint16_t reserved;
+  uint32_t value;
+};
+
+// Health log ring buffer entry (28 bytes; text is rendered on demand)
 struct HealthLogRingEntry {
   uint32_t seq;
   uint32_t timestamp_ms;
   LogLevel level;
   LogCategory category;
   AckStatus ack_status;
-  char message[80];
-  char detail[48];
+  uint8_t reserved;
+  LogField message;
+  LogField detail;
 };
 
 // ════════════════════════════════════════════════════════════════════════════
@@ -116,6 +202,18 @@ SystemHealth& witness_get_health();
 // Get last witness record
 WitnessRecord& witness_get_last_record();
 
+// Chain head and newest record, copied together under the chain lock so a
+// reader on another task never sees one record's seq with another's hash
+struct WitnessChainSnapshot {
+  uint32_t   seq;
+  uint8_t    chain_head[32];
+  uint32_t   last_seq;          // 0 before the first record
+  uint8_t    last_hash[32];
+  RecordType last_type;
+  bool       last_verified;
+};
+void witness_get_chain_snapshot(WitnessChainSnapshot* out);
+
 // Get current fix state
 FixState witness_get_state();
 
@@ -133,15 +231,155 @@ bool witness_provision_device();
 // RECORD CREATION
 // ════════════════════════════════════════════════════════════════════════════
 
-// Create a witness record with given payload
+// Create a witness record with given payload. In batch mode the record
+// usually comes back pending: chained, but unsigned until its batch is
+// sealed, when the final copy reaches the sink.
 bool witness_create_record(const uint8_t* payload, size_t len, RecordType type, WitnessRecord* out);
 
-// Verify record signature
+// Verify record signature (batched records are checked via their inclusion proof)
 bool witness_verify_record(const WitnessRecord* rec);
 
 // Persist chain state to NVS
 void witness_persist_chain_state();
 
+// Record sink, invoked with the payload once a record is final (signed, or
+// sealed in batch mode) on the task that completed it, in chain order but
+// outside the chain lock. Used to append records to the SD witness log.
+// Must not create records.
+typedef void (*WitnessSinkFn)(const WitnessRecord* rec, const uint8_t* payload, size_t len, void* ctx);
+void witness_set_record_sink(WitnessSinkFn fn, void* ctx = nullptr);
+
+// ════════════════════════════════════════════════════════════════════════════
+// ASYNC SIGNER PIPELINE
+// ════════════════════════════════════════════════════════════════════════════
+
+// Completion callback, invoked on the signer task once the record is chained
+// and signed (ok=false if signing or self-verification failed). In batch mode
+// it fires when the record's batch is sealed. Must not create records.
+typedef void (*WitnessRecordCallback)(const WitnessRecord* rec, bool ok, void* ctx);
+
+// Start the signer task pinned to SIGNER_TASK_CORE. Records submitted after
+// this are chained and signed in submission order off the caller's task.
+bool witness_signer_begin();
+
+// Whether the signer task is running
+bool witness_signer_running();
+
+// Queue a payload for signing without blocking. The payload is copied.
+// Returns false if the queue is full or the payload exceeds WITNESS_MAX_PAYLOAD.
+// Falls back to synchronous creation if the signer has not been started.
+bool witness_submit_record(const uint8_t* payload, size_t len, RecordType type,
+                           WitnessRecordCallback cb = nullptr, void* ctx = nullptr);
+
+// Records waiting in the signer queue
+size_t witness_signer_queue_depth();
+
+// ════════════════════════════════════════════════════════════════════════════
+// SELF-VERIFICATION POLICY
+// ════════════════════════════════════════════════════════════════════════════
+
+// Select how freshly signed records are self-verified. Boot attestations and
+// tamper alerts are always verified inline regardless of policy.
+void witness_set_verify_policy(VerifyPolicy policy, uint32_t sample_n = WITNESS_VERIFY_SAMPLE_N);
+VerifyPolicy witness_get_verify_policy();
+const char* verify_policy_name(VerifyPolicy p);
+
+// Start the low-priority auditor task used by VERIFY_DEFERRED. Failures raise
+// verify_failures and clear crypto_healthy asynchronously.
+bool witness_auditor_begin();
+
+// ════════════════════════════════════════════════════════════════════════════
+// MERKLE BATCH SIGNING
+// ════════════════════════════════════════════════════════════════════════════
+
+// In batch mode routine records are chained immediately but signed as one
+// Merkle root per WITNESS_BATCH_SIZE records or WITNESS_BATCH_WINDOW_MS.
+// Boot attestations and tamper alerts seal the open batch and are signed
+// individually. witness_create_record() returns batched records pending;
+// the sealed copy (with proof) goes to the submit callback and last record.
+void witness_set_batch_mode(bool enabled);
+bool witness_get_batch_mode();
+
+// Seal the open batch if it is full or its window has elapsed. Called by
+// the signer task; call from loop() when the signer is not running.
+void witness_batch_poll();
+
+// Seal the open batch now (e.g. before export or shutdown)
+void witness_batch_flush();
+
+// Verify a batched record's inclusion proof and the batch root signature
+bool witness_verify_inclusion(const WitnessRecord* rec);
+
+// ════════════════════════════════════════════════════════════════════════════
+// CHAIN CHECKPOINTS
+// ════════════════════════════════════════════════════════════════════════════
+
+// Every WITNESS_CHECKPOINT_INTERVAL records the chain gains a signed
+// RECORD_CHECKPOINT, chained and stored like any other record. Its payload
+// (CBOR, keys in deterministic order) restates what it extends:
+//   {"seq": last covered seq, "head": bstr(32) chain head at that seq,
+//    "prev": previous checkpoint seq, "boots": n, "tampers": n}
+// Once its signature and its link to "head" check out, everything before
+// it is vouched for, so boot checks and audits verify forward from the
+// latest checkpoint instead of seq 1. Checkpoints seal any open batch
+// first and are always verified inline.
+
+// Write a checkpoint now (e.g. before an export); also called whenever
+// a record brings the chain WITNESS_CHECKPOINT_INTERVAL past the last one
+bool witness_checkpoint(WitnessRecord* out = nullptr);
+
+// ════════════════════════════════════════════════════════════════════════════
+// RANGE VERIFICATION
+// ════════════════════════════════════════════════════════════════════════════
+
+struct WitnessRangeReport {
+  uint32_t start_seq;
+  uint32_t end_seq;           // Last sequence fed
+  uint32_t records;
+  uint32_t sig_checks;        // Ed25519 verifications performed
+  uint32_t chain_failures;    // Recomputed chain hash mismatch
+  uint32_t sig_failures;      // Records whose signature (or batch root) failed
+  uint32_t unverified;        // Batched records whose batch was cut by the range
+  uint32_t gaps;              // Missing sequence numbers (link not checkable)
+  uint32_t first_bad_seq;     // 0 if none
+  uint32_t elapsed_ms;
+  uint32_t records_per_sec;
+  bool     anchored;          // First record's link checked against its predecessor
+};
+
+// Incremental verifier for a stream of stored records in ascending seq order.
+// Chain hashes are recomputed link by link; Merkle-batched records cost one
+// signature check per batch instead of one per record.
+class WitnessRangeVerifier {
+public:
+  // anchor_hash: chain hash of record start_seq - 1, or null if unavailable
+  void begin(uint32_t start_seq, const uint8_t* anchor_hash);
+
+  void feed(uint32_t seq, uint32_t time_bucket, uint8_t flags_batched,
+            uint8_t batch_size, uint8_t leaf_index,
+            const uint8_t chain_hash[32], const uint8_t signature[64],
+            const uint8_t* payload, size_t payload_len);
+
+  const WitnessRangeReport& finish();
+
+private:
+  void fail(uint32_t seq, bool chain);
+  void flushBatch(bool complete);
+
+  WitnessRangeReport m_report;
+  uint32_t m_start_ms;
+  bool m_have_prev;
+  uint32_t m_prev_seq;
+  uint8_t m_prev_hash[32];
+
+  // Current Merkle batch
+  uint32_t m_batch_first;
+  uint8_t m_batch_size;
+  uint8_t m_batch_count;
+  uint8_t m_batch_sig[64];
+  uint8_t m_batch_hashes[WITNESS_BATCH_SIZE][32];
+};
+
 // ════════════════════════════════════════════════════════════════════════════
 // STATE MACHINE
 // ════════════════════════════════════════════════════════════════════════════
@@ -156,19 +394,77 @@ void witness_log_state_transition(FixState from, FixState to, const char* reason
 // HEALTH LOGGING
 // ════════════════════════════════════════════════════════════════════════════
 
-// Log a health event
+// Log a health event. Prefer a LogMsg; the const char* forms copy their
+// text into the arena and are for messages built at runtime.
+void log_health(LogLevel level, LogCategory category, LogMsg message, LogArg detail = LogArg::none());
+void log_health(LogLevel level, LogCategory category, LogMsg message, const char* detail);
 void log_health(LogLevel level, LogCategory category, const char* message, const char* detail = nullptr);
 
+// Re-insert an entry recovered from persistent storage at boot, before
+// anything new is logged. Not passed to the sink. Later entries continue
+// from its seq. ALERT/TAMPER entries come back unread, the rest archived.
+void witness_restore_health_log(uint32_t seq, uint32_t timestamp_ms, LogLevel level,
+                                LogCategory category, const char* message, const char* detail);
+
+// Render one field of an entry as text; returns the length written.
+// Arena text overwritten since the entry was logged renders as "...".
+size_t log_field_render(const LogField& field, char* out, size_t cap);
+
 // Public wrapper for external modules
 void health_log(LogLevel level, LogCategory category, const char* message);
 
-// Acknowledge a log entry
+// Acknowledge a log entry (O(1): looked up by seq)
 bool acknowledge_log_entry(uint32_t log_seq, AckStatus new_status, const char* reason);
 
+// Acknowledge every unread entry in the ring; returns how many changed
+size_t acknowledge_all_log_entries(AckStatus new_status);
+
 // Get health log ring buffer
 HealthLogRingEntry* witness_get_health_log_ring();
 size_t witness_get_health_log_count();
 size_t witness_get_health_log_head();
+size_t witness_get_health_log_capacity();
+
+// Seq-addressed access. Live seqs are the contiguous range oldest..newest
+// (both 0 when empty). Entries are copied out under the log lock, since
+// the producer may overwrite a slot at any time; get returns false for a
+// seq outside the range.
+void witness_get_health_log_range(uint32_t* oldest, uint32_t* newest);
+uint32_t witness_get_health_log_newest_seq();
+uint32_t witness_get_health_log_oldest_seq();
+bool witness_get_health_log(uint32_t seq, HealthLogRingEntry* out);
+
+// Indexed filtered walk. Each call costs one bitmap word per 32 entries
+// skipped, so a page of matches is found without visiting non-matches.
+struct HealthLogFilter {
+  LogLevel min_level;        // Entries at or above
+  uint16_t categories;       // Bit per LogCategory; 0 = any
+  bool unacked_only;         // Only ACK_STATUS_UNREAD
+};
+
+// Oldest match with seq > after (since-cursor paging), copied into out
+bool witness_health_log_next(const HealthLogFilter& filter, uint32_t after, HealthLogRingEntry* out);
+// Newest match with seq < before, or the newest match when before is 0
+bool witness_health_log_prev(const HealthLogFilter& filter, uint32_t before, HealthLogRingEntry* out);
+
+// ════════════════════════════════════════════════════════════════════════════
+// STATUS CACHE
+// ════════════════════════════════════════════════════════════════════════════
+
+// /api/status sections, re-rendered only after a writer marks them dirty
+enum StatusDirtyBits : uint32_t {
+  STATUS_DIRTY_IDENTITY = 1u << 0,   // Device identity, crypto backends
+  STATUS_DIRTY_HEALTH   = 1u << 1,   // Subsystem health flags, min heap
+  STATUS_DIRTY_LOGS     = 1u << 2,   // Health log counters
+  STATUS_DIRTY_CHAIN    = 1u << 3,   // Chain, verify, journal, batch, signer
+  STATUS_DIRTY_ALL      = 0x0F
+};
+
+// Safe from any task
+void witness_mark_status_dirty(uint32_t bits);
+
+// Return and clear the pending bits
+uint32_t witness_take_status_dirty();
 
 // ════════════════════════════════════════════════════════════════════════════
 // UTILITIES
@@ -0,0 +1,206 @@
+/*
+ * SecuraCV Canary — Chain State Journal Implementation
+ *
+ * Copyright (c) 2026 ERRERlabs / Karl May
+ * License: Apache-2.0
+ */
+
+#include "witness_journal.h"
+
+#if FEATURE_CHAIN_JOURNAL
+
+#include <esp_partition.h>
+#include <esp_rom_crc.h>
+
+// ════════════════════════════════════════════════════════════════════════════
+// LAYOUT
+// ════════════════════════════════════════════════════════════════════════════
+
+// 48 bytes: a multiple of 16 so writes stay aligned with flash encryption on
+struct JournalEntry {
+  uint32_t magic;
+  uint32_t seq;
+  uint8_t  chain_head[32];
+  uint8_t  key_tag[4];
+  uint32_t crc;              // CRC32 over all preceding fields
+};
+
+static_assert(sizeof(JournalEntry) == 48, "journal entry layout");
+
+static const uint32_t JOURNAL_MAGIC = 0x4A524E31;  // "JRN1"
+static const uint32_t ENTRIES_PER_SECTOR = JOURNAL_SECTOR_SIZE / sizeof(JournalEntry);
+
+// ════════════════════════════════════════════════════════════════════════════
+// STATE
+// ════════════════════════════════════════════════════════════════════════════
+
+static const esp_partition_t* s_part = nullptr;
+static uint32_t s_sectors = 0;
+static uint32_t s_write_sector = 0;
+static uint32_t s_write_slot = 0;
+static uint8_t s_key_tag[4];
+
+static bool s_have_latest = false;
+static uint32_t s_latest_seq = 0;
+static uint8_t s_latest_head[32];
+
+static JournalStats s_stats;
+
+// ════════════════════════════════════════════════════════════════════════════
+// HELPERS
+// ════════════════════════════════════════════════════════════════════════════
+
+static uint32_t entry_crc(const JournalEntry& e) {
+  return esp_rom_crc32_le(0, (const uint8_t*)&e, offsetof(JournalEntry, crc));
+}
+
+static size_t entry_offset(uint32_t sector, uint32_t slot) {
+  return (size_t)sector * JOURNAL_SECTOR_SIZE + (size_t)slot * sizeof(JournalEntry);
+}
+
+static bool read_entry(uint32_t sector, uint32_t slot, JournalEntry* e) {
+  return esp_partition_read(s_part, entry_offset(sector, slot), e, sizeof(*e)) == ESP_OK;
+}
+
+static bool entry_valid(const JournalEntry& e) {
+  return e.magic == JOURNAL_MAGIC && e.crc == entry_crc(e) &&
+         memcmp(e.key_tag, s_key_tag, sizeof(s_key_tag)) == 0;
+}
+
+static bool entry_erased(const JournalEntry& e) {
+  const uint8_t* p = (const uint8_t*)&e;
+  for (size_t i = 0; i < sizeof(e); i++) {
+    if (p[i] != 0xFF) return false;
+  }
+  return true;
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// JOURNAL API
+// ════════════════════════════════════════════════════════════════════════════
+
+bool journal_begin(const uint8_t key_tag[4]) {
+  memcpy(s_key_tag, key_tag, sizeof(s_key_tag));
+  memset(&s_stats, 0, sizeof(s_stats));
+  s_have_latest = false;
+
+  s_part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                    (esp_partition_subtype_t)JOURNAL_PARTITION_SUBTYPE,
+                                    JOURNAL_PARTITION_LABEL);
+  if (!s_part) {
+    Serial.println("[WARN] Chain journal partition not found - using NVS only");
+    return false;
+  }
+
+  s_sectors = s_part->size / JOURNAL_SECTOR_SIZE;
+  if (s_sectors < 2) {
+    Serial.println("[WARN] Chain journal partition too small");
+    s_part = nullptr;
+    return false;
+  }
+  s_stats.capacity = s_sectors * ENTRIES_PER_SECTOR;
+
+  // Newest sector = highest seq in slot 0 (entries are appended in seq order)
+  JournalEntry e;
+  int32_t best = -1;
+  uint32_t best_seq = 0;
+  for (uint32_t sec = 0; sec < s_sectors; sec++) {
+    if (!read_entry(sec, 0, &e) || !entry_valid(e)) continue;
+    if (best < 0 || e.seq > best_seq) {
+      best = (int32_t)sec;
+      best_seq = e.seq;
+    }
+  }
+
+  if (best < 0) {
+    s_write_sector = 0;
+    s_write_slot = 0;
+    Serial.printf("[OK] Chain journal empty (%u entries)\n", s_stats.capacity);
+    return true;
+  }
+
+  // Walk the newest sector; torn slots are skipped, never rewritten
+  uint32_t next_slot = 0;
+  for (uint32_t slot = 0; slot < ENTRIES_PER_SECTOR; slot++) {
+    if (!read_entry((uint32_t)best, slot, &e)) break;
+    if (entry_erased(e)) continue;
+    next_slot = slot + 1;
+    if (entry_valid(e)) {
+      s_have_latest = true;
+      s_latest_seq = e.seq;
+      memcpy(s_latest_head, e.chain_head, 32);
+    }
+  }
+
+  s_write_sector = (uint32_t)best;
+  s_write_slot = next_slot;
+  if (s_write_slot >= ENTRIES_PER_SECTOR) {
+    s_write_sector = (s_write_sector + 1) % s_sectors;
+    s_write_slot = 0;
+  }
+
+  Serial.printf("[OK] Chain journal: seq=%u (%u entries)\n", s_latest_seq, s_stats.capacity);
+  return true;
+}
+
+bool journal_available() {
+  return s_part != nullptr;
+}
+
+bool journal_recover(uint32_t* seq_out, uint8_t chain_head_out[32]) {
+  if (!s_part || !s_have_latest) return false;
+  *seq_out = s_latest_seq;
+  memcpy(chain_head_out, s_latest_head, 32);
+  return true;
+}
+
+bool journal_append(uint32_t seq, const uint8_t chain_head[32]) {
+  if (!s_part) return false;
+
+  uint32_t t0 = micros();
+
+  if (s_write_slot == 0) {
+    if (esp_partition_erase_range(s_part, entry_offset(s_write_sector, 0), JOURNAL_SECTOR_SIZE) != ESP_OK) {
+      s_stats.append_errors++;
+      return false;
+    }
+    s_stats.sector_erases++;
+  }
+
+  JournalEntry e;
+  e.magic = JOURNAL_MAGIC;
+  e.seq = seq;
+  memcpy(e.chain_head, chain_head, 32);
+  memcpy(e.key_tag, s_key_tag, sizeof(s_key_tag));
+  e.crc = entry_crc(e);
+
+  esp_err_t err = esp_partition_write(s_part, entry_offset(s_write_sector, s_write_slot), &e, sizeof(e));
+
+  // Advance even on failure so a bad slot is not retried forever
+  if (++s_write_slot >= ENTRIES_PER_SECTOR) {
+    s_write_slot = 0;
+    s_write_sector = (s_write_sector + 1) % s_sectors;
+  }
+
+  if (err != ESP_OK) {
+    s_stats.append_errors++;
+    return false;
+  }
+
+  s_have_latest = true;
+  s_latest_seq = seq;
+  memcpy(s_latest_head, chain_head, 32);
+
+  s_stats.appends++;
+  s_stats.last_append_us = micros() - t0;
+  if (s_stats.last_append_us > s_stats.max_append_us) {
+    s_stats.max_append_us = s_stats.last_append_us;
+  }
+  return true;
+}
+
+const JournalStats& journal_get_stats() {
+  return s_stats;
+}
+
+#endif // FEATURE_CHAIN_JOURNAL
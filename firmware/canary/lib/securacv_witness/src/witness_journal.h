@@ -0,0 +1,57 @@
+/*
+ * SecuraCV Canary — Chain State Journal
+ *
+ * Circular write-ahead journal of (seq, chain_head) in a dedicated flash
+ * partition. Every final record appends one small entry; NVS is rewritten
+ * only at CHAIN_CHECKPOINT_INTERVAL. At boot the newest valid entry wins
+ * over the NVS copy, so a brownout loses no chain state.
+ *
+ * Copyright (c) 2026 ERRERlabs / Karl May
+ * License: Apache-2.0
+ */
+
+#ifndef SECURACV_WITNESS_JOURNAL_H
+#define SECURACV_WITNESS_JOURNAL_H
+
+#include <Arduino.h>
+#include <stdint.h>
+#include "canary_config.h"
+
+#if FEATURE_CHAIN_JOURNAL
+
+// ════════════════════════════════════════════════════════════════════════════
+// TYPES
+// ════════════════════════════════════════════════════════════════════════════
+
+struct JournalStats {
+  uint32_t appends;
+  uint32_t append_errors;
+  uint32_t sector_erases;
+  uint32_t last_append_us;
+  uint32_t max_append_us;
+  uint32_t capacity;         // Entries before the journal wraps
+};
+
+// ════════════════════════════════════════════════════════════════════════════
+// JOURNAL API
+// ════════════════════════════════════════════════════════════════════════════
+
+// Locate the partition and find the write position. key_tag binds entries to
+// the device key so a re-provisioned device never adopts a stale head.
+bool journal_begin(const uint8_t key_tag[4]);
+
+// Whether the journal partition is present and usable
+bool journal_available();
+
+// Newest valid entry for this key; false if the journal is empty
+bool journal_recover(uint32_t* seq_out, uint8_t chain_head_out[32]);
+
+// Append one entry (erases the next sector when crossing a boundary)
+bool journal_append(uint32_t seq, const uint8_t chain_head[32]);
+
+// Counters for the status API
+const JournalStats& journal_get_stats();
+
+#endif // FEATURE_CHAIN_JOURNAL
+
+#endif // SECURACV_WITNESS_JOURNAL_H
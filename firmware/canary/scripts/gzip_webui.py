@@ -0,0 +1,96 @@
+#!/usr/bin/env python3
+"""
+SecuraCV Canary — Web UI Pre-compression (PlatformIO pre-build script)
+
+Extracts the CANARY_UI_HTML raw literal from securacv_webui.cpp, gzips it
+and writes securacv_webui_gz.h next to it. The firmware serves that copy
+with Content-Encoding: gzip; without the header it falls back to the
+uncompressed literal.
+
+The output is deterministic (mtime 0, fixed level) so unchanged HTML
+produces an identical header and does not trigger a rebuild.
+
+Usage:
+    extra_scripts = pre:scripts/gzip_webui.py    (platformio.ini)
+    python scripts/gzip_webui.py                 (standalone)
+
+Copyright (c) 2026 ERRERlabs / Karl May
+License: Apache-2.0
+"""
+
+import gzip
+import hashlib
+import os
+import sys
+
+WEBUI_DIR = os.path.join("lib", "securacv_webui", "src")
+SOURCE_NAME = "securacv_webui.cpp"
+OUTPUT_NAME = "securacv_webui_gz.h"
+LITERAL_OPEN = 'CANARY_UI_HTML[] PROGMEM = R"rawliteral('
+LITERAL_CLOSE = ')rawliteral"'
+BYTES_PER_LINE = 16
+
+
+def extract_html(source):
+    start = source.find(LITERAL_OPEN)
+    if start < 0:
+        raise ValueError("CANARY_UI_HTML literal not found")
+    start += len(LITERAL_OPEN)
+    end = source.find(LITERAL_CLOSE, start)
+    if end < 0:
+        raise ValueError("CANARY_UI_HTML literal is not terminated")
+    return source[start:end].encode("utf-8")
+
+
+def render_header(html, packed):
+    digest = hashlib.sha256(html).hexdigest()[:16]
+    lines = [
+        "/*",
+        " * SecuraCV Canary — Web UI (gzip)",
+        " *",
+        " * GENERATED by scripts/gzip_webui.py from " + SOURCE_NAME + ". Do not edit.",
+        " * %d bytes -> %d bytes gzip" % (len(html), len(packed)),
+        " */",
+        "",
+        "#ifndef SECURACV_WEBUI_GZ_H",
+        "#define SECURACV_WEBUI_GZ_H",
+        "",
+        '#define CANARY_UI_HTML_DIGEST "%s"' % digest,
+        "#define CANARY_UI_HTML_GZ_SIZE %d" % len(packed),
+        "",
+        "static const uint8_t CANARY_UI_HTML_GZ_DATA[CANARY_UI_HTML_GZ_SIZE] PROGMEM = {",
+    ]
+    for i in range(0, len(packed), BYTES_PER_LINE):
+        chunk = packed[i:i + BYTES_PER_LINE]
+        lines.append("  " + ", ".join("0x%02x" % b for b in chunk) + ",")
+    lines += ["};", "", "#endif // SECURACV_WEBUI_GZ_H", ""]
+    return "\n".join(lines)
+
+
+def generate(project_dir):
+    src_dir = os.path.join(project_dir, WEBUI_DIR)
+    src_path = os.path.join(src_dir, SOURCE_NAME)
+    out_path = os.path.join(src_dir, OUTPUT_NAME)
+
+    with open(src_path, "r", encoding="utf-8") as f:
+        html = extract_html(f.read())
+
+    packed = gzip.compress(html, compresslevel=9, mtime=0)
+    header = render_header(html, packed)
+
+    if os.path.exists(out_path):
+        with open(out_path, "r", encoding="utf-8") as f:
+            if f.read() == header:
+                return
+    with open(out_path, "w", encoding="utf-8") as f:
+        f.write(header)
+    print("[gzip_webui] %s: %d -> %d bytes" % (OUTPUT_NAME, len(html), len(packed)))
+
+
+try:
+    Import("env")  # noqa: F821 (provided by PlatformIO)
+    generate(env["PROJECT_DIR"])  # noqa: F821
+except NameError:
+    if __name__ == "__main__":
+        generate(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+        sys.exit(0)
@@ -8,6 +8,8 @@ Uses watchdog for cross-platform file system events.
 Usage:
     python ota_deploy.py [device_ip]
     python ota_deploy.py --watch 192.168.4.1
+    python ota_deploy.py --compress                 (zlib, decoded on device)
+    python ota_deploy.py --base running.bin         (delta from the running build)
     CANARY_IP=192.168.4.1 python ota_deploy.py
 
 Requirements:
@@ -18,11 +20,16 @@ License: Apache-2.0
 """
 
 import argparse
+import hashlib
 import os
 import sys
 import time
+import zlib
 from pathlib import Path
 
+# Shared patch builder: firmware/common/tools/ota_patch.py
+sys.path.insert(0, str(Path(__file__).resolve().parents[2] / "common" / "tools"))
+
 try:
     import requests
 except ImportError:
@@ -82,7 +89,19 @@ def find_firmware(build_dir: str) -> Path | None:
     return latest
 
 
-def deploy_firmware(firmware_path: Path, ip: str, port: int) -> bool:
+def encode_firmware(image: bytes, compress: bool, base_path: Path | None) -> tuple[bytes, str]:
+    """Transfer body and X-OTA-Encoding for an image."""
+    if base_path is not None:
+        import ota_patch
+        patch, _ = ota_patch.make_patch(base_path.read_bytes(), image)
+        return zlib.compress(patch, 9), "delta"
+    if compress:
+        return zlib.compress(image, 9), "zlib"
+    return image, "raw"
+
+
+def deploy_firmware(firmware_path: Path, ip: str, port: int,
+                    compress: bool = False, base_path: Path | None = None) -> bool:
     """Deploy firmware to device via OTA."""
     url = f"http://{ip}:{port}{OTA_ENDPOINT}"
     size = firmware_path.stat().st_size
@@ -94,10 +113,24 @@ def deploy_firmware(firmware_path: Path, ip: str, port: int) -> bool:
         with open(firmware_path, "rb") as f:
             firmware_data = f.read()
 
+        # The device hashes the image while flashing and rejects a mismatch
+        # with 400 sha256_mismatch before the new partition is marked bootable
+        digest = hashlib.sha256(firmware_data).hexdigest()
+        headers = {
+            "Content-Type": "application/octet-stream",
+            "X-OTA-SHA256": digest,
+        }
+
+        body, encoding = encode_firmware(firmware_data, compress, base_path)
+        if encoding != "raw":
+            headers["X-OTA-Encoding"] = encoding
+            headers["X-OTA-Image-Size"] = str(size)
+            log_info(f"Sending {encoding}: {len(body)} bytes ({100.0 * len(body) / size:.1f}%)")
+
         response = requests.post(
             url,
-            data=firmware_data,
-            headers={"Content-Type": "application/octet-stream"},
+            data=body,
+            headers=headers,
             timeout=120,
         )
 
@@ -143,7 +176,8 @@ def check_device(ip: str, port: int) -> bool:
     return True
 
 
-def watch_and_deploy(build_dir: str, ip: str, port: int) -> None:
+def watch_and_deploy(build_dir: str, ip: str, port: int,
+                     compress: bool = False, base_path: Path | None = None) -> None:
     """Watch for firmware changes and deploy automatically."""
     try:
         from watchdog.observers import Observer
@@ -174,7 +208,7 @@ def watch_and_deploy(build_dir: str, ip: str, port: int) -> None:
                     if firmware and str(firmware) != self.last_deployed:
                         print()
                         log_info("New firmware detected!")
-                        if deploy_firmware(firmware, ip, port):
+                        if deploy_firmware(firmware, ip, port, compress, base_path):
                             self.last_deployed = str(firmware)
                         print()
 
@@ -204,7 +238,8 @@ def watch_and_deploy(build_dir: str, ip: str, port: int) -> None:
     observer.join()
 
 
-def single_deploy(build_dir: str, ip: str, port: int) -> None:
+def single_deploy(build_dir: str, ip: str, port: int,
+                  compress: bool = False, base_path: Path | None = None) -> None:
     """Deploy the most recent firmware once."""
     firmware = find_firmware(build_dir)
 
@@ -214,7 +249,7 @@ def single_deploy(build_dir: str, ip: str, port: int) -> None:
         sys.exit(1)
 
     check_device(ip, port)
-    success = deploy_firmware(firmware, ip, port)
+    success = deploy_firmware(firmware, ip, port, compress, base_path)
     sys.exit(0 if success else 1)
 
 
@@ -256,14 +291,26 @@ def main() -> None:
         help=f"PlatformIO build directory (default: {BUILD_DIR})",
     )
 
+    parser.add_argument(
+        "--compress",
+        "-z",
+        action="store_true",
+        help="Send the image zlib-compressed",
+    )
+    parser.add_argument(
+        "--base",
+        type=Path,
+        help="Image the device is running; sends a delta patch from it",
+    )
+
     args = parser.parse_args()
 
     print_banner()
 
     if args.watch:
-        watch_and_deploy(args.build_dir, args.ip, args.port)
+        watch_and_deploy(args.build_dir, args.ip, args.port, args.compress, args.base)
     else:
-        single_deploy(args.build_dir, args.ip, args.port)
+        single_deploy(args.build_dir, args.ip, args.port, args.compress, args.base)
 
 
 if __name__ == "__main__":
@@ -74,6 +74,10 @@ deploy_firmware() {
   log_info "Deploying: $firmware_path ($firmware_size bytes)"
   log_info "Target: http://${CANARY_IP}:${CANARY_PORT}${OTA_ENDPOINT}"
 
+  # X-OTA-SHA256, as in ota_deploy.py
+  local sha256
+  sha256=$( (sha256sum "$firmware_path" 2>/dev/null || shasum -a 256 "$firmware_path") | cut -d' ' -f1)
+
   # Upload firmware using curl
   local response
   local http_code
@@ -83,6 +87,7 @@ deploy_firmware() {
     --max-time 120 \
     -X POST \
     -H "Content-Type: application/octet-stream" \
+    -H "X-OTA-SHA256: ${sha256}" \
     --data-binary "@${firmware_path}" \
     "http://${CANARY_IP}:${CANARY_PORT}${OTA_ENDPOINT}" 2>&1)
 
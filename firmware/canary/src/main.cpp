@@ -9,13 +9,28 @@
  */
 
 #include <Arduino.h>
+#include <atomic>
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
 #include "canary_config.h"
 #include "log_level.h"
 
 // Library components
 #include "securacv_crypto.h"
+#include "crypto_backend.h"
 #include "securacv_witness.h"
+#include "witness_journal.h"
+#include "log_sink.h"
 #include "securacv_gps.h"
+#include "securacv_metrics.h"
+#include "perf_profiler.h"
+#include "securacv_bench.h"
+#include "securacv_power.h"
+#include "securacv_boot.h"
+#include "common/encoding/cbor.h"
+#include "common/encoding/cbor_schema.h"
 
 #if FEATURE_SD_STORAGE
 #include "securacv_storage.h"
@@ -40,10 +55,74 @@
 static GpsManager s_gps;
 static uint32_t g_last_record_ms = 0;
 
+// Runtime tasks; either handle stays null if its work runs from loop()
+static EventGroupHandle_t s_rt_events = nullptr;
+static constexpr EventBits_t RT_EVT_FIX = 1 << 0;   // GNSS task published a fix
+static TaskHandle_t s_record_task = nullptr;
+static TaskHandle_t s_net_task = nullptr;
+
+// Async boot stages other code waits on (BOOT_STAGE_NONE when compiled out)
+static BootStageId s_boot_storage = BOOT_STAGE_NONE;
+static BootStageId s_boot_wifi = BOOT_STAGE_NONE;
+
+// Witness event payload: keys and value headers are encoded at compile time.
+// Keys are in deterministic order (shorter first, then bytewise).
+static constexpr auto WITNESS_EVENT_SCHEMA = cbor_schema::map(
+  cbor_schema::field<cbor_schema::Float>("alt"),
+  cbor_schema::field<cbor_schema::Bool>("fix"),
+  cbor_schema::field<cbor_schema::Float>("lat"),
+  cbor_schema::field<cbor_schema::Float>("lon"),
+  cbor_schema::field<cbor_schema::Float>("spd"),
+  cbor_schema::field<cbor_schema::Bytes<TRACK_SEGMENT_MAX_BYTES>>("trk"),   // track.h segment
+  cbor_schema::field<cbor_schema::Uint<0xFFFF>>("sats"),
+  cbor_schema::field<cbor_schema::Text<5>>("state"));   // state_name_short()
+
+static_assert(WITNESS_EVENT_SCHEMA.deterministic(), "event keys out of deterministic order");
+static_assert(WITNESS_EVENT_SCHEMA.kMaxSize <= WITNESS_MAX_PAYLOAD, "event payload exceeds signer queue slot");
+
+#if FEATURE_ASYNC_SIGNER
+static void on_record_signed(const WitnessRecord* rec, bool ok, void* ctx);
+#endif
+
+#if FEATURE_SD_STORAGE
+static void on_record_final(const WitnessRecord* rec, const uint8_t* payload, size_t len, void* ctx);
+static void sd_attach(bool mounted);
+static MetricId s_sd_write_latency = METRIC_NONE;
+
+// Records finalized while the SD stage is still mounting. The stage writes
+// them out, in order, before later records go straight to the card.
+enum SdAttach : uint8_t {
+  SD_ATTACH_PENDING = 0,
+  SD_ATTACH_READY,
+  SD_ATTACH_ABSENT,
+};
+
+struct SdPendingRecord {
+  WitnessRecord rec;
+  uint8_t payload[WITNESS_MAX_PAYLOAD];
+  size_t len;
+};
+
+static std::atomic<uint8_t> s_sd_attach{SD_ATTACH_PENDING};
+static SemaphoreHandle_t s_sd_backlog_lock = nullptr;
+static SdPendingRecord s_sd_backlog[BOOT_SD_BACKLOG];
+static size_t s_sd_backlog_len = 0;
+#endif
+
+// Runtime tasks
+static void runtime_begin();
+
 // Serial command helpers
 static void handle_serial_commands();
 static void print_banner();
 static void print_status();
+static void print_ready();
+#if FEATURE_PERF_PROFILER
+static void print_perf(bool idle_scopes);
+#endif
+#if FEATURE_BENCH
+static void print_bench(void* ctx);
+#endif
 
 // ════════════════════════════════════════════════════════════════════════════
 // UTILITY FUNCTIONS
@@ -61,28 +140,44 @@ static void serial_wait_for_cdc(uint32_t timeout_ms) {
 }
 
 // ════════════════════════════════════════════════════════════════════════════
-// SETUP
+// BOOT STAGES
 // ════════════════════════════════════════════════════════════════════════════
 
-void setup() {
-  Serial.begin(115200);
-  serial_wait_for_cdc(SERIAL_CDC_WAIT_MS);
+// The witness core (identity, GNSS, signer, record task) comes up inline on
+// setup(); the console wait, SD mount, WiFi/HTTP and camera attach on boot
+// tasks meanwhile. See securacv_boot.h.
 
-  print_banner();
+static bool stage_log(void*) {
+  // log_health() output moves off the calling task from here on
+  return log_sink_begin();
+}
 
+static bool stage_crypto(void*) {
+  // Pick SHA-256 / AES-GCM backends before anything hashes
+  crypto_backend_select();
+  return true;
+}
+
+static bool stage_identity(void*) {
   // Provision device identity (keys, chain state)
   if (!witness_provision_device()) {
     Serial.println("[!!] Device provisioning failed - HALTING");
     while (true) { delay(1000); }
   }
-
-  DeviceIdentity& device = witness_get_device();
-  Serial.printf("[OK] Device ID: %s\n", device.device_id);
-
+  Serial.printf("[OK] Device ID: %s\n", witness_get_device().device_id);
   pinMode(BOOT_BUTTON_GPIO, INPUT_PULLUP);
+  return true;
+}
+
+static bool stage_console(void*) {
+  // Output before the host attaches is lost; the boot profile is kept
+  serial_wait_for_cdc(SERIAL_CDC_WAIT_MS);
+  print_banner();
+  return true;
+}
 
-  // Setup watchdog
 #if FEATURE_WATCHDOG
+static bool stage_watchdog(void*) {
   Serial.printf("[..] Watchdog timer: %us timeout\n", WATCHDOG_TIMEOUT_SEC);
   esp_task_wdt_config_t wdt_config = {
     .timeout_ms = WATCHDOG_TIMEOUT_SEC * 1000,
@@ -95,70 +190,235 @@ void setup() {
   }
   esp_task_wdt_add(NULL);
   Serial.println("[OK] Watchdog configured");
+  return true;
+}
 #endif
 
-  // Initialize SD card storage
 #if FEATURE_SD_STORAGE
+static bool stage_storage(void*) {
   Serial.println("[..] Initializing SD card storage...");
-  if (storage_init(nullptr)) {
+  bool ok = storage_init(nullptr);
+  if (ok) {
     Serial.println("[OK] SD card ready for witness records");
-    witness_get_health().sd_healthy = true;
+    s_sd_write_latency = metrics_histogram("securacv_sd_write_duration_seconds",
+                                           "SD witness log append time");
+    if (!storage_get_instance().beginHealthLog()) {
+      Serial.println("[WARN] Health log will not persist");
+    }
   } else {
     Serial.println("[WARN] SD card not available - records will not persist");
-    witness_get_health().sd_healthy = false;
   }
+  sd_attach(ok);
+  witness_get_health().sd_healthy = ok;
+  witness_mark_status_dirty(STATUS_DIRTY_HEALTH);
+  return ok;
+}
 #endif
 
-  // Start WiFi Access Point and HTTP server
 #if FEATURE_WIFI_AP
+static bool stage_wifi(void*) {
   Serial.println("[..] Starting WiFi Access Point...");
-  NetworkManager& net = network_get_instance();
-  if (net.begin(device.ap_ssid, AP_PASSWORD_DEFAULT)) {
-    Serial.println("[OK] WiFi AP active");
-#if FEATURE_HTTP_SERVER
-    Serial.println("[..] Starting HTTP server...");
-    net.startHttpServer();
-#endif
-  } else {
+  if (!network_get_instance().begin(witness_get_device().ap_ssid, AP_PASSWORD_DEFAULT)) {
     Serial.println("[WARN] WiFi AP failed to start");
+    return false;
   }
+  Serial.println("[OK] WiFi AP active");
+  return true;
+}
+
+#if FEATURE_HTTP_SERVER
+static bool stage_http(void*) {
+  // After the SD stage, so no handler sees the card half mounted
+  if (!boot_ok(s_boot_wifi)) return false;
+  Serial.println("[..] Starting HTTP server...");
+  network_get_instance().startHttpServer();
+  return true;
+}
+#endif
 #endif
 
-  // Initialize camera for peek/preview
 #if FEATURE_CAMERA_PEEK
+static bool stage_camera(void*) {
   Serial.println("[..] Initializing camera for peek/preview...");
-  if (camera_init()) {
-    Serial.println("[OK] Camera ready for peek");
-  } else {
+  if (!camera_init()) {
     Serial.println("[WARN] Camera init failed - peek disabled");
+    return false;
   }
+  Serial.println("[OK] Camera ready for peek");
+  return true;
+}
 #endif
 
-  // Initialize GPS
-  Serial.println();
+static bool stage_gnss(void*) {
   Serial.printf("[..] GNSS: %u baud, RX=GPIO%d, TX=GPIO%d\n", GPS_BAUD, GPS_RX_PIN, GPS_TX_PIN);
-  s_gps.begin(Serial1, GPS_BAUD, GPS_RX_PIN, GPS_TX_PIN);
+  s_gps.begin((uart_port_t)GPS_UART_NUM, GPS_BAUD, GPS_RX_PIN, GPS_TX_PIN);
+
+  // Clock scaling and light sleep (needs the GNSS UART for its wake source)
+  power_begin();
+  return true;
+}
 
-  // Create boot attestation record
+static bool stage_attest(void*) {
+  // Reaches the SD log through the backlog if the card is still mounting
   Serial.println("[..] Creating boot attestation record...");
+  DeviceIdentity& device = witness_get_device();
   uint8_t boot_payload[64];
   CborWriter cbor(boot_payload, sizeof(boot_payload));
-  cbor.write_map(3);
-  cbor.write_text("type"); cbor.write_text("boot");
-  cbor.write_text("boot"); cbor.write_uint(device.boot_count);
-  cbor.write_text("ver"); cbor.write_text(FIRMWARE_VERSION);
+  cbor.map(3)                                   // Keys in deterministic order
+      .key("ver").str(FIRMWARE_VERSION)
+      .key("boot").uint(device.boot_count)
+      .key("type").str("boot");
 
   WitnessRecord boot_rec;
-  if (witness_create_record(boot_payload, cbor.size(), RECORD_BOOT_ATTESTATION, &boot_rec)) {
-    Serial.printf("[OK] Boot attestation: seq=%u\n", boot_rec.seq);
+  if (!witness_create_record(boot_payload, cbor.size(), RECORD_BOOT_ATTESTATION, &boot_rec)) {
+    return false;
   }
+  Serial.printf("[OK] Boot attestation: seq=%u\n", boot_rec.seq);
+  return true;
+}
 
-  // Log boot event
-  log_health(LOG_LEVEL_INFO, LOG_CAT_SYSTEM, "Device boot complete", FIRMWARE_VERSION);
+#if FEATURE_SD_STORAGE
+// Verify the stored chain from the latest checkpoint through the boot
+// attestation. The work is bounded by WITNESS_CHECKPOINT_INTERVAL, not by
+// how many records the unit has ever made.
+static bool stage_chain_check(void*) {
+  if (!boot_ok(s_boot_storage)) return false;
+
+  WitnessRangeReport report;
+  uint32_t from = 0;
+  if (!storage_verify_from_checkpoint(CHAIN_VERIFY_MAX_LIMIT, &report, &from)) return false;
+
+  SystemHealth& health = witness_get_health();
+  bool ok = report.chain_failures == 0 && report.sig_failures == 0;
+  health.boot_check_from = from;
+  health.boot_check_records = report.records;
+  health.boot_check_ms = report.elapsed_ms;
+  health.boot_check_done = true;
+  health.boot_check_ok = ok;
+
+  if (ok) {
+    Serial.printf("[OK] Chain check: %u records from %s %u in %u ms\n",
+                  (unsigned)report.records, from ? "checkpoint" : "seq",
+                  (unsigned)report.start_seq, (unsigned)report.elapsed_ms);
+    log_health(LOG_LEVEL_INFO, LOG_CAT_WITNESS, LOG_MSG_CHAIN_CHECK_PASSED, LogArg::seq(report.start_seq));
+  } else {
+    Serial.printf("[!!] Chain check failed at seq %u\n", (unsigned)report.first_bad_seq);
+    health.crypto_healthy = false;
+    log_health(LOG_LEVEL_CRITICAL, LOG_CAT_WITNESS, LOG_MSG_CHAIN_CHECK_FAILED, LogArg::seq(report.first_bad_seq));
+  }
+  witness_mark_status_dirty(STATUS_DIRTY_CHAIN | STATUS_DIRTY_HEALTH);
+  return ok;
+}
+
+// Verify the chain across one region the SD scrubber found failing its
+// CRC. Records lost in the region only show as gaps; a failure means the
+// records that survive no longer chain.
+static void scrub_recheck() {
+  WitnessScrubRegion region;
+  WitnessRangeReport report;
+  if (!storage_recheck_scrub_region(&region, &report)) return;
+
+  log_health(LOG_LEVEL_WARNING, LOG_CAT_STORAGE, LOG_MSG_SCRUB_REGION_FLAGGED, LogArg::seq(region.prev_seq));
+
+  bool ok = report.chain_failures == 0 && report.sig_failures == 0;
+  if (ok) {
+    Serial.printf("[OK] Scrub recheck: seq %u-%u, %u records, %u missing\n",
+                  (unsigned)report.start_seq, (unsigned)report.end_seq,
+                  (unsigned)report.records, (unsigned)report.gaps);
+    log_health(LOG_LEVEL_NOTICE, LOG_CAT_STORAGE, LOG_MSG_SCRUB_RECHECK_PASSED, LogArg::seq(report.start_seq));
+  } else {
+    Serial.printf("[!!] Scrub recheck failed at seq %u\n", (unsigned)report.first_bad_seq);
+    witness_get_health().crypto_healthy = false;
+    log_health(LOG_LEVEL_CRITICAL, LOG_CAT_WITNESS, LOG_MSG_SCRUB_RECHECK_FAILED, LogArg::seq(report.first_bad_seq));
+    witness_mark_status_dirty(STATUS_DIRTY_HEALTH);
+  }
+}
+#endif
+
+static bool stage_workers(void*) {
+  bool ok = true;
+
+  // Move routine record signing off the loop() task
+#if FEATURE_ASYNC_SIGNER
+  if (!witness_signer_begin()) {
+    Serial.println("[WARN] Signer task unavailable - signing inline");
+    ok = false;
+  }
+#endif
+
+  // Deferred self-verification needs the background auditor
+  if (witness_get_verify_policy() == VERIFY_DEFERRED && !witness_auditor_begin()) {
+    Serial.println("[WARN] Auditor unavailable - verifying inline");
+    ok = false;
+  }
+  return ok;
+}
 
+static bool stage_runtime(void*) {
   g_last_record_ms = millis();
 
-  // Print ready banner
+  // Split the runtime into prioritized tasks; loop() keeps housekeeping
+  runtime_begin();
+  return s_record_task != nullptr;
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// SETUP
+// ════════════════════════════════════════════════════════════════════════════
+
+void setup() {
+  Serial.begin(115200);
+
+#if FEATURE_SD_STORAGE
+  // Records finalized before the card mounts wait in the SD backlog
+  s_sd_backlog_lock = xSemaphoreCreateMutex();
+  witness_set_record_sink(on_record_final, nullptr);
+#endif
+
+  BootStageId log = boot_stage("log", stage_log, nullptr);
+  BootStageId crypto = boot_stage("crypto", stage_crypto, nullptr, boot_bit(log));
+  BootStageId identity = boot_stage("identity", stage_identity, nullptr, boot_bit(crypto));
+
+  // Peripherals, each on its own task as soon as what it needs is up
+  boot_stage("console", stage_console, nullptr, boot_bit(log), BOOT_ASYNC);
+#if FEATURE_SD_STORAGE
+  s_boot_storage = boot_stage("sd", stage_storage, nullptr, boot_bit(log), BOOT_ASYNC);
+#endif
+#if FEATURE_WIFI_AP
+  s_boot_wifi = boot_stage("wifi_ap", stage_wifi, nullptr, boot_bit(identity), BOOT_ASYNC);
+#if FEATURE_HTTP_SERVER
+  boot_stage("http", stage_http, nullptr, boot_bit(s_boot_wifi) | boot_bit(s_boot_storage), BOOT_ASYNC);
+#endif
+#endif
+#if FEATURE_CAMERA_PEEK
+  boot_stage("camera", stage_camera, nullptr, boot_bit(log), BOOT_ASYNC);
+#endif
+
+  // Rest of the witness core
+#if FEATURE_WATCHDOG
+  boot_stage("watchdog", stage_watchdog, nullptr);
+#endif
+  BootStageId gnss = boot_stage("gnss", stage_gnss, nullptr);
+  BootStageId attest = boot_stage("attest", stage_attest, nullptr, boot_bit(identity));
+  BootStageId workers = boot_stage("workers", stage_workers, nullptr, boot_bit(attest));
+#if FEATURE_SD_STORAGE
+  // Once the boot attestation has reached the log, so its link is checked too
+  boot_stage("chain_check", stage_chain_check, nullptr, boot_bit(attest) | boot_bit(s_boot_storage),
+             BOOT_ASYNC);
+#endif
+  boot_stage("runtime", stage_runtime, nullptr, boot_bit(gnss) | boot_bit(workers));
+
+  boot_run();
+
+  // Log boot event
+  log_health(LOG_LEVEL_INFO, LOG_CAT_SYSTEM, LOG_MSG_BOOT_COMPLETE, FIRMWARE_VERSION);
+  Serial.printf("[OK] Witnessing %u ms after power-on; peripherals attaching\n",
+                (unsigned)(boot_core_ready_us() / 1000));
+}
+
+// Printed from loop() once every boot stage, async ones included, is done
+static void print_ready() {
+  DeviceIdentity& device = witness_get_device();
   Serial.println();
   Serial.println("╔══════════════════════════════════════════════════════════════╗");
   Serial.println("║               WITNESS DEVICE READY                           ║");
@@ -172,14 +432,154 @@ void setup() {
   Serial.println("║  mDNS       : http://canary.local                             ║");
 #endif
   Serial.println("╠══════════════════════════════════════════════════════════════╣");
-  Serial.println("║  Commands: h=help, i=identity, s=status, g=gps               ║");
+  Serial.println("║  Commands: h=help, i=identity, s=status, g=gps, t=boot       ║");
   Serial.println("║  Hold BOOT button 1.2s to print all info                     ║");
   Serial.println("╚══════════════════════════════════════════════════════════════╝");
   Serial.println();
+  Serial.println("=== Boot Profile ===");
+  boot_print_report();
+  Serial.println();
 }
 
 // ════════════════════════════════════════════════════════════════════════════
-// LOOP
+// RUNTIME TASKS
+// ════════════════════════════════════════════════════════════════════════════
+
+// State machine, GNSS health and witness records; runs on the record task
+static void record_step(uint32_t now) {
+  const GnssFix fix = s_gps.getFix();
+  witness_update_state(fix.valid, fix.last_update_ms, knots_to_mps(fix.speed_knots));
+
+  SystemHealth& health = witness_get_health();
+  if (health.gps_healthy != fix.valid) {
+    health.gps_healthy = fix.valid;
+    witness_mark_status_dirty(STATUS_DIRTY_HEALTH);
+  }
+
+  // Sync GPS stats to health
+  health.gps_sentences = s_gps.getSentenceCount();
+  health.gga_count = s_gps.getGgaCount();
+  health.rmc_count = s_gps.getRmcCount();
+  health.gsa_count = s_gps.getGsaCount();
+  health.gsv_count = s_gps.getGsvCount();
+  health.vtg_count = s_gps.getVtgCount();
+  health.ubx_pvt_count = s_gps.getUbxPvtCount();
+  if (s_gps.getFirstFixMs() > 0 && health.gps_lock_ms == 0) {
+    health.gps_lock_ms = s_gps.getFirstFixMs();
+  }
+
+  // Create witness records at interval
+  if (now - g_last_record_ms >= RECORD_INTERVAL_MS) {
+    g_last_record_ms = now;
+    PowerBoost boost;
+
+    // Build witness event payload (keys pre-encoded, see WITNESS_EVENT_SCHEMA)
+    uint8_t payload[WITNESS_EVENT_SCHEMA.kMaxSize];
+    FixState state = witness_get_state();
+
+    // Path since the previous record, reduced to its significant points
+    static track_point_t s_track[TRACK_RING_CAPACITY];
+    track_point_t seg[TRACK_SEGMENT_MAX_POINTS];
+    uint8_t trk[TRACK_SEGMENT_MAX_BYTES];
+    size_t track_n = s_gps.takeTrack(s_track, TRACK_RING_CAPACITY);
+    size_t seg_n = track_simplify(s_track, track_n, TRACK_TOLERANCE_M, seg, TRACK_SEGMENT_MAX_POINTS);
+    cbor_schema::ByteSpan trk_span = { trk, track_encode(seg, seg_n, trk, sizeof(trk)) };
+
+    size_t payload_len = WITNESS_EVENT_SCHEMA.encode(payload, sizeof(payload),
+        fix.altitude_m, fix.valid, fix.lat, fix.lon, fix.speed_kmh, trk_span,
+        (uint64_t)fix.satellites, state_name_short(state));
+    if (payload_len == 0) {
+      log_health(LOG_LEVEL_ERROR, LOG_CAT_WITNESS, LOG_MSG_PAYLOAD_ENCODE_FAILED);
+    } else {
+#if FEATURE_ASYNC_SIGNER
+      if (!witness_submit_record(payload, payload_len, RECORD_WITNESS_EVENT, on_record_signed, nullptr)) {
+        log_health(LOG_LEVEL_WARNING, LOG_CAT_WITNESS, LOG_MSG_SIGNER_QUEUE_FULL);
+      }
+#else
+      WitnessRecord rec;
+      if (witness_create_record(payload, payload_len, RECORD_WITNESS_EVENT, &rec)) {
+        health.records_created++;
+      } else {
+        log_health(LOG_LEVEL_ERROR, LOG_CAT_WITNESS, LOG_MSG_RECORD_CREATE_FAILED);
+      }
+#endif
+    }
+  }
+
+#if !FEATURE_ASYNC_SIGNER
+  // Seal a partial Merkle batch once its window elapses
+  witness_batch_poll();
+#endif
+}
+
+static void record_task(void* arg) {
+  (void)arg;
+#if FEATURE_WATCHDOG
+  esp_task_wdt_add(NULL);
+#endif
+  for (;;) {
+    // Wake on each published fix, or at the record deadline if none arrives
+    uint32_t elapsed = millis() - g_last_record_ms;
+    uint32_t wait_ms = elapsed >= RECORD_INTERVAL_MS ? 0 : RECORD_INTERVAL_MS - elapsed;
+    xEventGroupWaitBits(s_rt_events, RT_EVT_FIX, pdTRUE, pdFALSE, pdMS_TO_TICKS(wait_ms));
+#if FEATURE_WATCHDOG
+    esp_task_wdt_reset();
+#endif
+    record_step(millis());
+  }
+}
+
+#if FEATURE_WIFI_AP
+static void network_step() {
+  // Check the WiFi connection and push state changes to /api/events
+  // subscribers, once per tick
+  network_update();
+}
+
+static void network_task(void* arg) {
+  (void)arg;
+  // Nothing to supervise until the AP stage has run (before the watchdog
+  // subscription, as WiFi start can outlast its timeout)
+  boot_wait(boot_bit(s_boot_wifi), UINT32_MAX);
+#if FEATURE_WATCHDOG
+  esp_task_wdt_add(NULL);
+#endif
+  TickType_t last_wake = xTaskGetTickCount();
+  for (;;) {
+    vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(NET_TASK_PERIOD_MS));
+#if FEATURE_WATCHDOG
+    esp_task_wdt_reset();
+#endif
+    network_step();
+  }
+}
+#endif
+
+static void runtime_begin() {
+  s_rt_events = xEventGroupCreate();
+  if (s_rt_events &&
+      xTaskCreatePinnedToCore(record_task, "record", RECORD_TASK_STACK, nullptr,
+                              RECORD_TASK_PRIORITY, &s_record_task, RECORD_TASK_CORE) == pdPASS) {
+    s_gps.setPublishNotify(s_rt_events, RT_EVT_FIX);
+  } else {
+    s_record_task = nullptr;
+    Serial.println("[!!] Record task creation failed; recording from loop()");
+  }
+
+#if FEATURE_WIFI_AP
+  if (xTaskCreatePinnedToCore(network_task, "network", NET_TASK_STACK, nullptr,
+                              NET_TASK_PRIORITY, &s_net_task, NET_TASK_CORE) != pdPASS) {
+    s_net_task = nullptr;
+    Serial.println("[!!] Network task creation failed; polling from loop()");
+  }
+#endif
+
+  Serial.printf("[OK] Runtime: record task %s, network task %s\n",
+                s_record_task ? "running" : "inline", s_net_task ? "running" : "inline");
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// LOOP (HOUSEKEEPING)
 // ════════════════════════════════════════════════════════════════════════════
 
 void loop() {
@@ -205,71 +605,127 @@ void loop() {
     boot_btn_start = 0;
   }
 
-  // Update GPS
+  // GNSS is ingested on its own task; this only polls if that failed
   s_gps.update();
 
-  // Update state machine
-  const GnssFix& fix = s_gps.getFix();
-  witness_update_state(fix.valid, fix.last_update_ms, s_gps.getSpeedMps());
-
-  // Update health metrics
+  // Update heap metrics
   SystemHealth& health = witness_get_health();
   uint32_t now = millis();
   health.uptime_sec = now / 1000;
   health.free_heap = ESP.getFreeHeap();
   if (health.free_heap < health.min_heap || health.min_heap == 0) {
     health.min_heap = health.free_heap;
+    witness_mark_status_dirty(STATUS_DIRTY_HEALTH);
   }
-  health.gps_healthy = fix.valid;
 
-  // Sync GPS stats to health
-  health.gps_sentences = s_gps.getSentenceCount();
-  health.gga_count = s_gps.getGgaCount();
-  health.rmc_count = s_gps.getRmcCount();
-  health.gsa_count = s_gps.getGsaCount();
-  health.gsv_count = s_gps.getGsvCount();
-  health.vtg_count = s_gps.getVtgCount();
-  if (s_gps.getFirstFixMs() > 0 && health.gps_lock_ms == 0) {
-    health.gps_lock_ms = s_gps.getFirstFixMs();
+  // Duty cycle into SystemHealth
+  power_update();
+
+#if FEATURE_SD_STORAGE
+  // Write out partial witness and health log buffers once they are old
+  // enough, then chain-check whatever the scrubber flagged
+  if (boot_done(s_boot_storage)) {
+    storage_get_instance().poll(now);
+    scrub_recheck();
   }
+#endif
 
+  // Fallbacks for tasks that could not be started
+  if (!s_record_task) record_step(now);
 #if FEATURE_WIFI_AP
-  // Check WiFi connection periodically
-  network_get_instance().checkConnection();
+  if (!s_net_task && boot_done(s_boot_wifi)) network_step();
 #endif
 
-  // Create witness records at interval
-  if (now - g_last_record_ms >= RECORD_INTERVAL_MS) {
-    g_last_record_ms = now;
+  // Ready banner and boot profile once the last peripheral has attached
+  static bool s_ready_printed = false;
+  if (!s_ready_printed && boot_complete()) {
+    s_ready_printed = true;
+    print_ready();
+  }
 
-    // Build witness event payload
-    uint8_t payload[256];
-    CborWriter cbor(payload, sizeof(payload));
+  // Print status every 20 records (records complete on other tasks)
+  static uint32_t s_status_mark = 0;
+  if (health.records_created / 20 != s_status_mark) {
+    s_status_mark = health.records_created / 20;
+    print_status();
+  }
 
-    FixState state = witness_get_state();
+  delay(HOUSEKEEPING_PERIOD_MS);
+}
+
+#if FEATURE_ASYNC_SIGNER
+// Runs on the signer task
+static void on_record_signed(const WitnessRecord* rec, bool ok, void* ctx) {
+  (void)rec;
+  (void)ctx;
+  if (!ok) {
+    log_health(LOG_LEVEL_ERROR, LOG_CAT_WITNESS, LOG_MSG_RECORD_CREATE_FAILED);
+  }
+}
+#endif
+
+#if FEATURE_SD_STORAGE
+// Append a finalized record to the SD witness log
+static void sd_append(const WitnessRecord* rec, const uint8_t* payload, size_t len) {
+  MetricTimer timer(s_sd_write_latency);
+  SystemHealth& health = witness_get_health();
+  bool ok = storage_get_instance().appendWitness(
+    rec->seq, rec->time_bucket, (uint8_t)rec->type,
+    rec->batched ? WITNESS_LOG_FLAG_BATCHED : 0, rec->batch_size, rec->leaf_index,
+    rec->chain_hash, rec->signature, payload, len,
+    rec->type == RECORD_TAMPER_ALERT || rec->type == RECORD_CHECKPOINT
+      ? SD_DURABLE_NOW : SD_DURABLE_BATCHED);
+  if (ok) {
+    health.sd_writes++;
+    witness_mark_status_dirty(STATUS_DIRTY_CHAIN);
+  } else {
+    health.sd_errors++;
+  }
+}
+
+// Runs on the SD boot task: drain the backlog, then open the direct path
+static void sd_attach(bool mounted) {
+  if (s_sd_backlog_lock) xSemaphoreTake(s_sd_backlog_lock, portMAX_DELAY);
+  for (size_t i = 0; mounted && i < s_sd_backlog_len; i++) {
+    const SdPendingRecord& p = s_sd_backlog[i];
+    sd_append(&p.rec, p.payload, p.len);
+  }
+  s_sd_backlog_len = 0;
+  s_sd_attach.store(mounted ? SD_ATTACH_READY : SD_ATTACH_ABSENT, std::memory_order_release);
+  if (s_sd_backlog_lock) xSemaphoreGive(s_sd_backlog_lock);
+}
 
-    cbor.write_map(7);
-    cbor.write_text("state"); cbor.write_text(state_name_short(state));
-    cbor.write_text("fix"); cbor.write_bool(fix.valid);
-    cbor.write_text("lat"); cbor.write_float(fix.lat);
-    cbor.write_text("lon"); cbor.write_float(fix.lon);
-    cbor.write_text("alt"); cbor.write_float(fix.altitude_m);
-    cbor.write_text("spd"); cbor.write_float(fix.speed_kmh);
-    cbor.write_text("sats"); cbor.write_uint(fix.satellites);
-
-    WitnessRecord rec;
-    if (witness_create_record(payload, cbor.size(), RECORD_WITNESS_EVENT, &rec)) {
-      health.records_created++;
-
-      // Print status every 20 records
-      if (health.records_created % 20 == 0) {
-        print_status();
+// Called in chain order; holds records until the SD stage has finished.
+// With the backlog full the caller waits for the stage instead: records
+// back up in the witness queue, before the chain, rather than leave a gap
+// in the card's log.
+static void on_record_final(const WitnessRecord* rec, const uint8_t* payload, size_t len, void* ctx) {
+  (void)ctx;
+  uint8_t st = s_sd_attach.load(std::memory_order_acquire);
+  if (st == SD_ATTACH_PENDING && s_sd_backlog_lock) {
+    xSemaphoreTake(s_sd_backlog_lock, portMAX_DELAY);
+    st = s_sd_attach.load(std::memory_order_relaxed);
+    while (st == SD_ATTACH_PENDING && s_sd_backlog_len >= BOOT_SD_BACKLOG) {
+      xSemaphoreGive(s_sd_backlog_lock);
+      vTaskDelay(pdMS_TO_TICKS(BOOT_SD_BACKLOG_POLL_MS));
+      xSemaphoreTake(s_sd_backlog_lock, portMAX_DELAY);
+      st = s_sd_attach.load(std::memory_order_relaxed);
+    }
+    if (st == SD_ATTACH_PENDING) {
+      if (len <= WITNESS_MAX_PAYLOAD) {
+        SdPendingRecord& p = s_sd_backlog[s_sd_backlog_len++];
+        p.rec = *rec;
+        memcpy(p.payload, payload, len);
+        p.len = len;
+      } else {
+        witness_get_health().sd_errors++;
       }
-    } else {
-      log_health(LOG_LEVEL_ERROR, LOG_CAT_WITNESS, "Record creation failed", nullptr);
     }
+    xSemaphoreGive(s_sd_backlog_lock);
   }
+  if (st == SD_ATTACH_READY) sd_append(rec, payload, len);
 }
+#endif
 
 // ════════════════════════════════════════════════════════════════════════════
 // SERIAL COMMANDS
@@ -288,6 +744,13 @@ static void handle_serial_commands() {
       Serial.println("  i - Device identity");
       Serial.println("  s - Status");
       Serial.println("  g - GPS info");
+      Serial.println("  t - Boot profile");
+#if FEATURE_PERF_PROFILER
+      Serial.println("  p - Timing profile (then reset)");
+#endif
+#if FEATURE_BENCH
+      Serial.println("  b - Benchmark crypto/CBOR/SD/NVS (writes a scratch file)");
+#endif
       Serial.println("  r - Reboot");
       Serial.println();
       break;
@@ -310,7 +773,7 @@ static void handle_serial_commands() {
 
     case 'g':
     case 'G': {
-      const GnssFix& fix = s_gps.getFix();
+      const GnssFix fix = s_gps.getFix();
       Serial.println("\n=== GPS ===");
       Serial.printf("  Fix: %s\n", fix.valid ? "Yes" : "No");
       if (fix.valid) {
@@ -320,16 +783,48 @@ static void handle_serial_commands() {
         Serial.printf("  Speed: %.1f km/h\n", fix.speed_kmh);
         Serial.printf("  Sats: %u\n", fix.satellites);
       }
-      Serial.printf("  Sentences: %u (errors: %u)\n",
-                    s_gps.getSentenceCount(), s_gps.getChecksumErrors());
+      Serial.printf("  Protocol: %s\n", gps_protocol_name(s_gps.getProtocol()));
+      Serial.printf("  Sentences: %u (errors: %u), UBX PVT: %u\n",
+                    s_gps.getSentenceCount(), s_gps.getChecksumErrors(), s_gps.getUbxPvtCount());
       Serial.println();
       break;
     }
 
+    case 't':
+    case 'T':
+      Serial.println("\n=== Boot Profile ===");
+      boot_print_report();
+      Serial.println();
+      break;
+
+#if FEATURE_PERF_PROFILER
+    case 'p':
+    case 'P':
+      Serial.println("\n=== Timing Profile ===");
+      print_perf(true);
+      perf_reset();
+      Serial.println();
+      break;
+#endif
+
+#if FEATURE_BENCH
+    case 'b':
+    case 'B':
+      if (bench_start(print_bench, nullptr)) {
+        Serial.println("\n[..] Benchmark running, results follow in a few seconds");
+      } else {
+        Serial.println("\n[WARN] Benchmark already running (or no memory)");
+      }
+      break;
+#endif
+
     case 'r':
     case 'R':
       Serial.println("\nRebooting...");
       delay(500);
+#if FEATURE_SD_STORAGE
+      storage_flush();
+#endif
       ESP.restart();
       break;
 
@@ -353,13 +848,38 @@ static void print_banner() {
 static void print_status() {
   SystemHealth& health = witness_get_health();
   DeviceIdentity& device = witness_get_device();
-  const GnssFix& fix = s_gps.getFix();
+  const GnssFix fix = s_gps.getFix();
 
   Serial.println("\n=== Status ===");
   Serial.printf("  Uptime: %us\n", health.uptime_sec);
   Serial.printf("  Free heap: %u bytes\n", health.free_heap);
   Serial.printf("  Min heap: %u bytes\n", health.min_heap);
   Serial.printf("  Records: %u (seq: %u)\n", health.records_created, device.seq);
+  Serial.printf("  Verify: %s (skipped %u, pending %u, failures %u)\n",
+                verify_policy_name(witness_get_verify_policy()), health.verify_skipped,
+                health.audit_pending, health.verify_failures);
+#if FEATURE_CHAIN_JOURNAL
+  if (journal_available()) {
+    const JournalStats& js = journal_get_stats();
+    Serial.printf("  Journal: %u appends, %u erases, last %uus (NVS persists %u)\n",
+                  js.appends, js.sector_erases, js.last_append_us, health.chain_persists);
+  }
+#endif
+  Serial.printf("  Crypto: sha256=%s aes-gcm=%s%s\n",
+                crypto_backend_sha256().name, crypto_backend_gcm().name,
+                crypto_backend_get(CRYPTO_BACKEND_MBEDTLS).hw_accel ? " (hw accel available)" : "");
+  if (witness_get_batch_mode()) {
+    Serial.printf("  Batch: %u sealed, %u pending, last seal %uus\n",
+                  health.batches_sealed, health.batch_pending, health.stage_seal_us);
+  }
+#if FEATURE_ASYNC_SIGNER
+  Serial.printf("  Signer: queue %u/%u (peak %u, dropped %u)\n",
+                health.signer_queue_depth, SIGNER_QUEUE_LEN,
+                health.signer_queue_peak, health.signer_dropped);
+  Serial.printf("  Stages: queue %uus hash %uus sign %uus verify %uus (max %uus)\n",
+                health.stage_queue_us, health.stage_hash_us, health.stage_sign_us,
+                health.stage_verify_us, health.stage_total_max_us);
+#endif
 
   FixState state = witness_get_state();
   Serial.printf("  State: %s\n", state_name(state));
@@ -378,5 +898,47 @@ static void print_status() {
   Serial.printf("  WiFi: %s\n", health.wifi_active ? "OK" : "Down");
 #endif
 
+  LogSinkStats ls = log_sink_get_stats();
+  Serial.printf("  Log sink: %u written, %u dropped (peak %u/%u)\n",
+                ls.written, ls.dropped, ls.peak_depth, LOG_SINK_RING_SIZE);
+  Serial.printf("  Power: %s, CPU duty %u%%\n", power_mode_name(power_get_mode()), health.cpu_duty_pct);
+
+#if FEATURE_PERF_PROFILER
+  Serial.println("  Timing (us):");
+  print_perf(false);
+#endif
+
+  Serial.println();
+}
+
+#if FEATURE_PERF_PROFILER
+// One line per profiler scope; idle_scopes includes those never entered
+static void print_perf(bool idle_scopes) {
+  Serial.printf("    %-28s %8s %7s %7s %7s %7s\n", "scope", "count", "min", "avg", "p99", "max");
+  PerfStats ps;
+  for (size_t i = 0; perf_get(i, &ps); i++) {
+    if (ps.count == 0 && !idle_scopes) continue;
+    Serial.printf("    %-28s %8u %7u %7u %7u %7u\n",
+                  ps.name, ps.count, ps.min_us, ps.avg_us, ps.p99_us, ps.max_us);
+  }
+}
+#endif
+
+#if FEATURE_BENCH
+// Runs on the bench task when the run completes
+static void print_bench(void* ctx) {
+  (void)ctx;
+  Serial.println("\n=== Benchmark ===");
+  Serial.printf("    %-16s %6s %9s %9s %9s %12s\n", "case", "ops", "avg_us", "min_us", "max_us", "bytes/s");
+  BenchResult r;
+  for (size_t i = 0; bench_get(i, &r); i++) {
+    if (!r.ran) {
+      Serial.printf("    %-16s skipped\n", r.name);
+      continue;
+    }
+    Serial.printf("    %-16s %6u %9u %9u %9u %12u\n",
+                  r.name, r.ops, r.avg_us, r.min_us, r.max_us, r.bytes_per_s);
+  }
   Serial.println();
 }
+#endif
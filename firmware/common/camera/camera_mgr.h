@@ -12,11 +12,18 @@
  *
  * Privacy note: Camera is used for witness event capture only.
  * No raw video is stored - only coarse state is recorded.
+ *
+ * Motion gating: with the gate enabled, cam_capture_gated() and
+ * cam_stream_get_frame() keep the sensor at a small probe framesize,
+ * decode each probe at 1/8 scale to grayscale and run it through
+ * motion_detect.h. Full-size JPEGs are only produced for hold_ms after
+ * motion is seen, so an empty scene costs a tiny JPEG per probe interval.
  */
 
 #pragma once
 
 #include "../core/types.h"
+#include "motion_detect.h"
 #include <stdint.h>
 #include <stddef.h>
 #include <stdbool.h>
@@ -33,6 +40,9 @@ extern "C" {
 #define CAM_JPEG_QUALITY_STREAM     15      // Slightly lower for streaming
 #define CAM_FB_COUNT_DEFAULT        2       // Double buffering
 
+#define CAM_MOTION_PROBE_INTERVAL_MS 200    // Min time between idle probes
+#define CAM_MOTION_HOLD_MS          5000    // Full-size capture after motion
+
 // ============================================================================
 // TYPES
 // ============================================================================
@@ -88,6 +98,10 @@ typedef struct {
     uint32_t frames_streamed;
     uint32_t last_capture_ms;
     uint32_t avg_capture_time_ms;
+    bool motion_gated;          // Gate enabled
+    bool motion_active;         // Inside a motion hold (full-size capture)
+    uint32_t frames_probed;     // Low-resolution motion probes
+    uint32_t motion_events;     // Idle-to-motion transitions
 } cam_status_t;
 
 /**
@@ -127,6 +141,17 @@ typedef struct {
     bool use_psram;             // Use PSRAM for frame buffers
 } cam_config_t;
 
+/**
+ * @brief Motion gate configuration
+ */
+typedef struct {
+    bool enabled;
+    cam_resolution_t probe_resolution;  // Idle framesize (QQVGA or QVGA)
+    uint16_t probe_interval_ms;         // Min time between probes
+    uint16_t hold_ms;                   // Full-size capture after motion
+    motion_config_t detect;             // Detector tuning
+} cam_motion_gate_t;
+
 // ============================================================================
 // INITIALIZATION
 // ============================================================================
@@ -184,6 +209,43 @@ result_t cam_capture(cam_frame_t* frame);
  */
 void cam_release_frame(cam_frame_t* frame);
 
+// ============================================================================
+// MOTION GATING
+// ============================================================================
+
+/**
+ * @brief Fill a gate config with defaults (disabled, QVGA probe)
+ * @param gate Output config
+ */
+void cam_motion_gate_default(cam_motion_gate_t* gate);
+
+/**
+ * @brief Configure the motion gate
+ * @param gate New configuration (resets the background)
+ * @return RESULT_OK on success, RESULT_INVALID_PARAM for a probe
+ *         resolution above QVGA
+ */
+result_t cam_motion_gate_set(const cam_motion_gate_t* gate);
+
+/**
+ * @brief Get the motion gate configuration
+ * @param gate Output config
+ * @return RESULT_OK on success
+ */
+result_t cam_motion_gate_get(cam_motion_gate_t* gate);
+
+/**
+ * @brief Capture a full-size frame only when the scene is moving
+ * @param frame Output frame (caller must release with cam_release_frame)
+ * @param motion Result of the last probe (optional)
+ * @return RESULT_OK with a full-size frame, RESULT_EMPTY when the scene
+ *         is still or the probe interval has not elapsed
+ *
+ * With the gate disabled this is cam_capture(). Callers can poll it as
+ * fast as they like; probes are rate-limited by probe_interval_ms.
+ */
+result_t cam_capture_gated(cam_frame_t* frame, motion_result_t* motion);
+
 // ============================================================================
 // CONFIGURATION
 // ============================================================================
@@ -245,7 +307,8 @@ bool cam_is_streaming(void);
  * @return RESULT_OK on success, RESULT_EMPTY if no frame available
  *
  * This is optimized for streaming - it returns the latest frame
- * and may skip frames if the consumer is slow.
+ * and may skip frames if the consumer is slow. Honours the motion
+ * gate: RESULT_EMPTY while the scene is still.
  */
 result_t cam_stream_get_frame(cam_frame_t* frame);
 
@@ -280,8 +343,12 @@ result_t cam_register_http_endpoints(void);
 
 #include "esp_camera.h"
 #include "esp_timer.h"
+#include "img_converters.h"
 #include "../hal/hal.h"
 
+// Probe decode buffer: QVGA at 1/8 scale in RGB565, reused in place for luma
+#define CAM_MOTION_PROBE_BUF_SIZE   ((320 / 8) * (240 / 8) * 2)
+
 // Module state
 static struct {
     bool initialized;
@@ -289,8 +356,16 @@ static struct {
     cam_config_t config;
     cam_status_t status;
     uint32_t total_capture_time_ms;
+    cam_resolution_t sensor_resolution;     // Framesize the sensor is set to
+    bool gate_configured;                   // cam_motion_gate_set() was called
+    cam_motion_gate_t gate;
+    motion_detector_t motion;
+    uint32_t last_probe_ms;
+    uint32_t hold_until_ms;
 } g_cam = {0};
 
+static uint8_t g_cam_probe_buf[CAM_MOTION_PROBE_BUF_SIZE];
+
 // Resolution lookup table
 static const struct {
     framesize_t esp_size;
@@ -360,6 +435,12 @@ result_t cam_init(const cam_config_t* config) {
     g_cam.status.resolution = config->resolution;
     g_cam.status.format = config->format;
     g_cam.status.jpeg_quality = config->jpeg_quality;
+    g_cam.sensor_resolution = config->resolution;
+
+    if (!g_cam.gate_configured) {
+        cam_motion_gate_default(&g_cam.gate);
+        motion_init(&g_cam.motion, &g_cam.gate.detect);
+    }
 
     LOG_I("Camera initialized: %s", cam_resolution_name(config->resolution));
     return RESULT_OK;
@@ -453,6 +534,7 @@ result_t cam_set_resolution(cam_resolution_t resolution) {
 
     g_cam.config.resolution = resolution;
     g_cam.status.resolution = resolution;
+    g_cam.sensor_resolution = resolution;
 
     return RESULT_OK;
 }
@@ -481,6 +563,171 @@ result_t cam_set_quality(uint8_t quality) {
     return RESULT_OK;
 }
 
+// ----------------------------------------------------------------------------
+// Motion gating
+// ----------------------------------------------------------------------------
+
+// Switch the sensor framesize; frames already queued keep the old size
+static result_t cam_apply_framesize(cam_resolution_t res) {
+    if (g_cam.sensor_resolution == res) {
+        return RESULT_OK;
+    }
+
+    sensor_t* s = esp_camera_sensor_get();
+    if (!s || s->set_framesize(s, g_res_table[res].esp_size) != 0) {
+        return RESULT_ERROR;
+    }
+
+    g_cam.sensor_resolution = res;
+    return RESULT_OK;
+}
+
+// Full-size capture, skipping frames queued before a framesize switch
+static result_t cam_capture_full(cam_frame_t* frame) {
+    result_t res = cam_apply_framesize(g_cam.config.resolution);
+    if (res != RESULT_OK) {
+        return res;
+    }
+
+    uint16_t width = g_res_table[g_cam.config.resolution].width;
+    for (uint8_t i = 0; i <= g_cam.config.fb_count; i++) {
+        res = cam_capture(frame);
+        if (res != RESULT_OK || frame->width == width) {
+            return res;
+        }
+        cam_release_frame(frame);
+    }
+    return RESULT_EMPTY;
+}
+
+// Grab a probe frame, decode it at 1/8 scale and feed the detector
+static result_t cam_motion_probe(motion_result_t* mr) {
+    cam_resolution_t probe = g_cam.gate.probe_resolution;
+    result_t res = cam_apply_framesize(probe);
+    if (res != RESULT_OK) {
+        return res;
+    }
+
+    camera_fb_t* fb = esp_camera_fb_get();
+    if (!fb) {
+        return RESULT_ERROR;
+    }
+
+    size_t w = fb->width / 8;
+    size_t h = fb->height / 8;
+    bool ok = fb->width == g_res_table[probe].width &&
+              fb->format == PIXFORMAT_JPEG &&
+              jpg2rgb565(fb->buf, fb->len, g_cam_probe_buf, JPG_SCALE_8X);
+    esp_camera_fb_return(fb);
+
+    if (!ok) {
+        // Stale frame from before the switch, or a corrupt JPEG
+        return RESULT_EMPTY;
+    }
+    g_cam.status.frames_probed++;
+
+    // RGB565 (big-endian) to 8-bit luma, in place
+    for (size_t i = 0; i < w * h; i++) {
+        uint8_t hi = g_cam_probe_buf[2 * i];
+        uint8_t lo = g_cam_probe_buf[2 * i + 1];
+        uint16_t r = hi & 0xF8;
+        uint16_t g = ((hi & 0x07) << 5) | ((lo >> 3) & 0x1C);
+        uint16_t b = (lo & 0x1F) << 3;
+        g_cam_probe_buf[i] = (uint8_t)((r * 77 + g * 150 + b * 29) >> 8);
+    }
+
+    motion_feed_gray(&g_cam.motion, g_cam_probe_buf, w, h, w, mr);
+    return RESULT_OK;
+}
+
+void cam_motion_gate_default(cam_motion_gate_t* gate) {
+    if (!gate) return;
+    gate->enabled = false;
+    gate->probe_resolution = CAM_RESOLUTION_QVGA;
+    gate->probe_interval_ms = CAM_MOTION_PROBE_INTERVAL_MS;
+    gate->hold_ms = CAM_MOTION_HOLD_MS;
+    motion_config_default(&gate->detect);
+}
+
+result_t cam_motion_gate_set(const cam_motion_gate_t* gate) {
+    if (!gate || gate->probe_resolution > CAM_RESOLUTION_QVGA) {
+        return RESULT_INVALID_PARAM;
+    }
+
+    g_cam.gate = *gate;
+    g_cam.gate_configured = true;
+    motion_init(&g_cam.motion, &gate->detect);
+    g_cam.hold_until_ms = 0;
+    g_cam.last_probe_ms = hal_millis() - gate->probe_interval_ms;
+    g_cam.status.motion_gated = gate->enabled;
+    g_cam.status.motion_active = false;
+
+    // Leave the probe framesize behind when the gate is turned off
+    if (!gate->enabled && g_cam.initialized) {
+        cam_apply_framesize(g_cam.config.resolution);
+    }
+
+    LOG_I("Camera motion gate %s (probe %s)", gate->enabled ? "enabled" : "disabled",
+          cam_resolution_name(gate->probe_resolution));
+    return RESULT_OK;
+}
+
+result_t cam_motion_gate_get(cam_motion_gate_t* gate) {
+    if (!gate) return RESULT_INVALID_PARAM;
+    *gate = g_cam.gate;
+    return RESULT_OK;
+}
+
+result_t cam_capture_gated(cam_frame_t* frame, motion_result_t* motion) {
+    if (!g_cam.initialized || !frame) {
+        return RESULT_NOT_INITIALIZED;
+    }
+
+    if (motion) {
+        memset(motion, 0, sizeof(*motion));
+    }
+
+    if (!g_cam.gate.enabled) {
+        return cam_capture(frame);
+    }
+
+    frame->data = NULL;
+    frame->_fb = NULL;
+
+    uint32_t now = hal_millis();
+    if (g_cam.status.motion_active && (int32_t)(now - g_cam.hold_until_ms) >= 0) {
+        g_cam.status.motion_active = false;
+    }
+
+    if (!g_cam.status.motion_active) {
+        if (now - g_cam.last_probe_ms < g_cam.gate.probe_interval_ms) {
+            return RESULT_EMPTY;
+        }
+        g_cam.last_probe_ms = now;
+
+        motion_result_t mr;
+        result_t res = cam_motion_probe(&mr);
+        if (res != RESULT_OK) {
+            return res;
+        }
+        if (motion) {
+            *motion = mr;
+        }
+        if (!mr.motion) {
+            return RESULT_EMPTY;
+        }
+
+        // Probing resumes when the hold expires; continued motion re-arms it
+        g_cam.status.motion_active = true;
+        g_cam.status.motion_events++;
+        g_cam.hold_until_ms = now + g_cam.gate.hold_ms;
+        LOG_D("Motion: %u/%u blocks, max delta %u", mr.changed_blocks,
+              mr.total_blocks, mr.max_delta);
+    }
+
+    return cam_capture_full(frame);
+}
+
 const char* cam_resolution_name(cam_resolution_t res) {
     if (res <= CAM_RESOLUTION_UXGA) {
         return g_res_table[res].name;
@@ -527,7 +774,7 @@ result_t cam_stream_get_frame(cam_frame_t* frame) {
         return RESULT_INVALID_STATE;
     }
 
-    result_t res = cam_capture(frame);
+    result_t res = cam_capture_gated(frame, NULL);
     if (res == RESULT_OK) {
         g_cam.status.frames_streamed++;
     }
@@ -0,0 +1,223 @@
+/**
+ * @file motion_detect.h
+ * @brief Block-based motion detection on small grayscale frames
+ *
+ * Splits a downscaled luma image into a coarse grid, keeps a running
+ * background mean per block, and reports motion when enough blocks move
+ * away from their background. Used by camera_mgr.h to gate full-size
+ * capture, but works on any 8-bit grayscale buffer.
+ *
+ * Features:
+ * - Zero-allocation: state is a fixed-size struct owned by the caller
+ * - Background adapts quickly to an empty scene and slowly while motion
+ *   is present, so a parked object is absorbed instead of firing forever
+ * - Optional global-change guard: when nearly every block changes at once
+ *   (lights switched, auto-exposure step) the background is re-primed
+ *   instead of reporting motion
+ *
+ * Example:
+ *   motion_detector_t det;
+ *   motion_result_t mr;
+ *   motion_init(&det, NULL);                 // Defaults
+ *   motion_feed_gray(&det, luma, 40, 30, 40, &mr);
+ *   if (mr.motion) { ... capture full frame ... }
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// CONSTANTS
+// ============================================================================
+
+#define MOTION_GRID_MAX_W           16      // Max blocks across
+#define MOTION_GRID_MAX_H           12      // Max blocks down
+#define MOTION_BLOCKS_MAX           (MOTION_GRID_MAX_W * MOTION_GRID_MAX_H)
+
+#define MOTION_DEFAULT_GRID_W       8
+#define MOTION_DEFAULT_GRID_H       6
+#define MOTION_DEFAULT_THRESHOLD    12      // Mean luma delta per block
+#define MOTION_DEFAULT_MIN_BLOCKS   2
+#define MOTION_DEFAULT_BG_SHIFT     3       // Background EMA weight 1/8
+#define MOTION_DEFAULT_GLOBAL_PCT   90      // Re-prime above this share
+
+// Background means are kept in 12.4 fixed point
+#define MOTION_BG_FRAC_BITS         4
+
+// ============================================================================
+// TYPES
+// ============================================================================
+
+/**
+ * @brief Detector tuning
+ */
+typedef struct {
+    uint8_t grid_w;             // Blocks across (1..MOTION_GRID_MAX_W)
+    uint8_t grid_h;             // Blocks down (1..MOTION_GRID_MAX_H)
+    uint8_t threshold;          // Mean luma delta for a block to count as changed
+    uint8_t min_blocks;         // Changed blocks needed to report motion
+    uint8_t bg_shift;           // Background EMA weight 1/2^n (0 = replace)
+    uint8_t global_pct;         // Treat >= this % changed as lighting (0 = off)
+} motion_config_t;
+
+/**
+ * @brief Detector state
+ */
+typedef struct {
+    motion_config_t config;
+    uint16_t background[MOTION_BLOCKS_MAX];  // Per-block mean, 12.4 fixed point
+    bool primed;                // Background holds a real frame
+    uint32_t frames;            // Frames fed
+    uint32_t motion_frames;     // Frames that reported motion
+} motion_detector_t;
+
+/**
+ * @brief Result of one frame
+ */
+typedef struct {
+    bool motion;                // Motion above threshold
+    bool reprimed;              // Global change; background reset
+    uint16_t changed_blocks;    // Blocks over threshold
+    uint16_t total_blocks;      // Blocks in the grid
+    uint8_t max_delta;          // Largest block delta (luma)
+    uint8_t score;              // changed_blocks as % of total
+} motion_result_t;
+
+// ============================================================================
+// API
+// ============================================================================
+
+/**
+ * @brief Fill a config with defaults
+ * @param config Output config
+ */
+static inline void motion_config_default(motion_config_t* config) {
+    config->grid_w = MOTION_DEFAULT_GRID_W;
+    config->grid_h = MOTION_DEFAULT_GRID_H;
+    config->threshold = MOTION_DEFAULT_THRESHOLD;
+    config->min_blocks = MOTION_DEFAULT_MIN_BLOCKS;
+    config->bg_shift = MOTION_DEFAULT_BG_SHIFT;
+    config->global_pct = MOTION_DEFAULT_GLOBAL_PCT;
+}
+
+/**
+ * @brief Forget the background; the next frame primes it
+ * @param det Detector
+ */
+static inline void motion_reset(motion_detector_t* det) {
+    memset(det->background, 0, sizeof(det->background));
+    det->primed = false;
+}
+
+/**
+ * @brief Initialize a detector
+ * @param det Detector
+ * @param config Tuning, or NULL for defaults (grid is clamped to the max)
+ */
+static inline void motion_init(motion_detector_t* det, const motion_config_t* config) {
+    memset(det, 0, sizeof(*det));
+    if (config) {
+        det->config = *config;
+    } else {
+        motion_config_default(&det->config);
+    }
+    if (det->config.grid_w == 0) det->config.grid_w = 1;
+    if (det->config.grid_h == 0) det->config.grid_h = 1;
+    if (det->config.grid_w > MOTION_GRID_MAX_W) det->config.grid_w = MOTION_GRID_MAX_W;
+    if (det->config.grid_h > MOTION_GRID_MAX_H) det->config.grid_h = MOTION_GRID_MAX_H;
+    if (det->config.bg_shift > 8) det->config.bg_shift = 8;
+}
+
+/**
+ * @brief Feed one grayscale frame
+ * @param det Detector
+ * @param gray 8-bit luma pixels
+ * @param width Frame width (at least grid_w)
+ * @param height Frame height (at least grid_h)
+ * @param stride Bytes per row
+ * @param out Result (optional)
+ * @return true if motion was detected
+ *
+ * The first frame after init/reset primes the background and never
+ * reports motion. Pixels past the last whole block are ignored.
+ */
+static inline bool motion_feed_gray(motion_detector_t* det, const uint8_t* gray,
+                                    size_t width, size_t height, size_t stride,
+                                    motion_result_t* out) {
+    motion_result_t r;
+    memset(&r, 0, sizeof(r));
+
+    const motion_config_t* c = &det->config;
+    size_t bw = width / c->grid_w;
+    size_t bh = height / c->grid_h;
+    r.total_blocks = (uint16_t)(c->grid_w * c->grid_h);
+
+    if (!gray || bw == 0 || bh == 0) {
+        if (out) *out = r;
+        return false;
+    }
+
+    // Block means in 12.4 fixed point
+    uint16_t cur[MOTION_BLOCKS_MAX];
+    uint32_t area = (uint32_t)(bw * bh);
+    for (uint8_t gy = 0; gy < c->grid_h; gy++) {
+        for (uint8_t gx = 0; gx < c->grid_w; gx++) {
+            uint32_t sum = 0;
+            const uint8_t* row = gray + (gy * bh) * stride + gx * bw;
+            for (size_t y = 0; y < bh; y++, row += stride) {
+                for (size_t x = 0; x < bw; x++) sum += row[x];
+            }
+            cur[gy * c->grid_w + gx] = (uint16_t)((sum << MOTION_BG_FRAC_BITS) / area);
+        }
+    }
+
+    det->frames++;
+
+    if (!det->primed) {
+        memcpy(det->background, cur, r.total_blocks * sizeof(uint16_t));
+        det->primed = true;
+        if (out) *out = r;
+        return false;
+    }
+
+    bool changed[MOTION_BLOCKS_MAX];
+    for (uint16_t i = 0; i < r.total_blocks; i++) {
+        int32_t diff = (int32_t)cur[i] - (int32_t)det->background[i];
+        uint32_t delta = (uint32_t)(diff < 0 ? -diff : diff) >> MOTION_BG_FRAC_BITS;
+        if (delta > r.max_delta) r.max_delta = (uint8_t)(delta > 255 ? 255 : delta);
+        changed[i] = delta >= c->threshold;
+        if (changed[i]) r.changed_blocks++;
+    }
+    r.score = (uint8_t)((r.changed_blocks * 100u) / r.total_blocks);
+
+    if (c->global_pct > 0 && r.total_blocks > c->min_blocks && r.score >= c->global_pct) {
+        memcpy(det->background, cur, r.total_blocks * sizeof(uint16_t));
+        r.reprimed = true;
+        if (out) *out = r;
+        return false;
+    }
+
+    // Changed blocks learn 4x slower so real motion isn't absorbed at once
+    for (uint16_t i = 0; i < r.total_blocks; i++) {
+        uint8_t shift = changed[i] ? (uint8_t)(c->bg_shift + 2) : c->bg_shift;
+        int32_t diff = (int32_t)cur[i] - (int32_t)det->background[i];
+        det->background[i] = (uint16_t)((int32_t)det->background[i] + diff / (1 << shift));
+    }
+
+    r.motion = r.changed_blocks >= c->min_blocks && r.changed_blocks > 0;
+    if (r.motion) det->motion_frames++;
+    if (out) *out = r;
+    return r.motion;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -4,6 +4,10 @@
  *
  * Provides a unified logging interface with multiple log levels,
  * compile-time filtering, and configurable output backends.
+ *
+ * Build with LOG_DEFERRED=1 (C++ only) to have the LOG_E..LOG_V macros
+ * emit binary frames through log_defer.h instead of formatting on the
+ * device; tools/log_decode.py renders them on the host.
  */
 
 #pragma once
@@ -89,33 +93,39 @@ void log_writev(log_level_t level, const char* tag, const char* fmt, va_list arg
 #define LOG_TAG "APP"
 #endif
 
+#if defined(LOG_DEFERRED) && LOG_DEFERRED && defined(__cplusplus)
+#define LOG_EMIT_(level, level_char, fmt, ...) LOG_DEFER_WRITE(level, level_char, fmt, ##__VA_ARGS__)
+#else
+#define LOG_EMIT_(level, level_char, fmt, ...) log_write(level, LOG_TAG, fmt, ##__VA_ARGS__)
+#endif
+
 // Compile-time filtered log macros
 #if LOG_LEVEL >= LOG_LEVEL_ERROR
-#define LOG_E(fmt, ...) log_write(LOG_LEVEL_ERROR, LOG_TAG, fmt, ##__VA_ARGS__)
+#define LOG_E(fmt, ...) LOG_EMIT_(LOG_LEVEL_ERROR, "\x01", fmt, ##__VA_ARGS__)
 #else
 #define LOG_E(fmt, ...) ((void)0)
 #endif
 
 #if LOG_LEVEL >= LOG_LEVEL_WARN
-#define LOG_W(fmt, ...) log_write(LOG_LEVEL_WARN, LOG_TAG, fmt, ##__VA_ARGS__)
+#define LOG_W(fmt, ...) LOG_EMIT_(LOG_LEVEL_WARN, "\x02", fmt, ##__VA_ARGS__)
 #else
 #define LOG_W(fmt, ...) ((void)0)
 #endif
 
 #if LOG_LEVEL >= LOG_LEVEL_INFO
-#define LOG_I(fmt, ...) log_write(LOG_LEVEL_INFO, LOG_TAG, fmt, ##__VA_ARGS__)
+#define LOG_I(fmt, ...) LOG_EMIT_(LOG_LEVEL_INFO, "\x03", fmt, ##__VA_ARGS__)
 #else
 #define LOG_I(fmt, ...) ((void)0)
 #endif
 
 #if LOG_LEVEL >= LOG_LEVEL_DEBUG
-#define LOG_D(fmt, ...) log_write(LOG_LEVEL_DEBUG, LOG_TAG, fmt, ##__VA_ARGS__)
+#define LOG_D(fmt, ...) LOG_EMIT_(LOG_LEVEL_DEBUG, "\x04", fmt, ##__VA_ARGS__)
 #else
 #define LOG_D(fmt, ...) ((void)0)
 #endif
 
 #if LOG_LEVEL >= LOG_LEVEL_VERBOSE
-#define LOG_V(fmt, ...) log_write(LOG_LEVEL_VERBOSE, LOG_TAG, fmt, ##__VA_ARGS__)
+#define LOG_V(fmt, ...) LOG_EMIT_(LOG_LEVEL_VERBOSE, "\x05", fmt, ##__VA_ARGS__)
 #else
 #define LOG_V(fmt, ...) ((void)0)
 #endif
@@ -157,3 +167,7 @@ void log_hexdump(const char* tag, const void* data, size_t len);
 #ifdef __cplusplus
 }
 #endif
+
+#if defined(LOG_DEFERRED) && LOG_DEFERRED && defined(__cplusplus)
+#include "log_defer.h"
+#endif
@@ -0,0 +1,330 @@
+/**
+ * @file log_defer.h
+ * @brief Deferred-formatting binary log transport
+ *
+ * With LOG_DEFERRED set, the LOG_E..LOG_V macros in log.h stop formatting
+ * on the device. Each call site interns a record (level byte plus format
+ * string) in a .rodata.log_fmt.* section at build time. At run time it
+ * writes only the record's address, the tag pointer, a timestamp and the
+ * raw argument bytes into a ring. A low-priority task drains the ring to
+ * UART or a socket, and tools/log_decode.py renders the text on the host
+ * from the firmware ELF. A call costs a few dozen bytes of memcpy, not a
+ * vsnprintf plus UART time.
+ *
+ * Frame (in the ring: a length byte, then these; on the wire: COBS
+ * encoded and terminated by 0x00):
+ *   [record u32 LE][tag u32 LE][timestamp_ms u32 LE][args...]
+ * Arguments are encoded by C++ type, and the decoder reads them by
+ * conversion spec:
+ *   integers, bool, char, enums  4 bytes LE (8 for 64-bit types, %ll)
+ *   float, double                float32, 4 bytes (%f %e %g)
+ *   pointers                     4 bytes (%p)
+ *   C strings                    u8 length + bytes, cut at LOG_DEFER_MAX_STR (%s)
+ * A record address of 0 is a drop marker; its tag field holds the
+ * number of frames lost since the previous marker.
+ *
+ * - The format string must be a literal; printf format checking still
+ *   applies, so a type that does not match its conversion is a warning
+ * - Frames are whole or absent: a full ring, or a producer that cannot
+ *   get the ring lock within LOG_DEFER_LOCK_SPINS, drops the frame and
+ *   counts it. Logging never blocks.
+ * - Record and tag strings must stay in the image (string literals or
+ *   static const char*), since only their addresses leave the device
+ *
+ * C++17 only (header-only, no allocation)
+ *
+ * Example:
+ *   // build flags: -DLOG_DEFERRED=1
+ *   static SpscRingT<4096> log_ring;
+ *   log_defer::init(&log_ring, millis32);
+ *   LOG_I("fix %d sats, hdop %.1f", sats, hdop);   // ~20 bytes into the ring
+ *   // log task
+ *   log_defer::drain(uart_write, nullptr, 32);
+ */
+
+#pragma once
+
+#ifndef __cplusplus
+#error "log_defer.h requires C++17"
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <atomic>
+#include <type_traits>
+#include "spsc_ring.h"
+
+// ============================================================================
+// CONFIGURATION
+// ============================================================================
+
+#ifndef LOG_DEFER_MAX_FRAME
+#define LOG_DEFER_MAX_FRAME 96          // Bytes after the length byte, at most 255
+#endif
+
+#ifndef LOG_DEFER_MAX_STR
+#define LOG_DEFER_MAX_STR 32            // Per %s argument
+#endif
+
+#ifndef LOG_DEFER_LOCK_SPINS
+#define LOG_DEFER_LOCK_SPINS 64
+#endif
+
+// One subsection per call site: records in inline functions are COMDAT
+// and may not share a section name with the rest of the translation unit.
+// The linker gathers .rodata.log_fmt.* into flash rodata.
+#define LOG_DEFER_STR_(x) #x
+#define LOG_DEFER_STR(x) LOG_DEFER_STR_(x)
+#define LOG_DEFER_SECTION(n) ".rodata.log_fmt." LOG_DEFER_STR(n)
+
+static_assert(LOG_DEFER_MAX_FRAME <= 255, "frame length must fit the u8 length prefix");
+
+namespace log_defer {
+
+// ============================================================================
+// TYPES
+// ============================================================================
+
+typedef uint32_t (*clock_fn)(void);
+
+/**
+ * @brief Transport for drain(); returns false to stop draining
+ */
+typedef bool (*write_fn)(const uint8_t* data, size_t len, void* ctx);
+
+typedef struct {
+    uint32_t frames;            // Written to the ring
+    uint32_t dropped;           // Ring full or lock busy
+    uint32_t truncated;         // Arguments cut at LOG_DEFER_MAX_FRAME
+    uint32_t drained;           // Sent by drain()
+} log_defer_stats_t;
+
+// ============================================================================
+// STATE
+// ============================================================================
+
+namespace detail {
+
+struct State {
+    SpscRing* ring = nullptr;
+    clock_fn clock = nullptr;
+    std::atomic_flag lock = ATOMIC_FLAG_INIT;
+    std::atomic<uint32_t> frames{0};
+    std::atomic<uint32_t> dropped{0};
+    std::atomic<uint32_t> truncated{0};
+    std::atomic<uint32_t> drained{0};
+    uint32_t reported = 0;     // dropped at the last marker (consumer only)
+};
+
+inline State& state() {
+    static State s;
+    return s;
+}
+
+inline void put_u32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+struct Frame {
+    uint8_t buf[1 + LOG_DEFER_MAX_FRAME];
+    size_t len = 1;
+    bool cut = false;
+
+    void put(const void* data, size_t n) {
+        if (cut || len + n > sizeof(buf)) {
+            cut = true;
+            return;
+        }
+        memcpy(buf + len, data, n);
+        len += n;
+    }
+};
+
+template <typename T>
+inline void encode(Frame& f, T v) {
+    using D = std::decay_t<T>;
+    uint8_t b[8];
+    if constexpr (std::is_same_v<D, const char*> || std::is_same_v<D, char*>) {
+        size_t n = v ? strnlen(v, LOG_DEFER_MAX_STR) : 0;
+        uint8_t len = (uint8_t)n;
+        f.put(&len, 1);
+        f.put(v, n);
+    } else if constexpr (std::is_floating_point_v<D>) {
+        float x = (float)v;
+        memcpy(b, &x, 4);
+        f.put(b, 4);
+    } else if constexpr (std::is_pointer_v<D>) {
+        put_u32(b, (uint32_t)(uintptr_t)v);
+        f.put(b, 4);
+    } else if constexpr (std::is_enum_v<D>) {
+        put_u32(b, (uint32_t)(std::underlying_type_t<D>)v);
+        f.put(b, 4);
+    } else {
+        static_assert(std::is_integral_v<D>, "unsupported deferred log argument");
+        if constexpr (sizeof(D) > 4) {
+            uint64_t x = (uint64_t)v;
+            put_u32(b, (uint32_t)x);
+            put_u32(b + 4, (uint32_t)(x >> 32));
+            f.put(b, 8);
+        } else {
+            put_u32(b, (uint32_t)v);
+            f.put(b, 4);
+        }
+    }
+}
+
+inline bool frame_to_ring(const Frame& f) {
+    State& s = state();
+    if (!s.ring) return false;
+
+    int spins = LOG_DEFER_LOCK_SPINS;
+    while (s.lock.test_and_set(std::memory_order_acquire)) {
+        if (--spins == 0) return false;
+    }
+    bool ok = s.ring->space() >= f.len;
+    if (ok) s.ring->write(f.buf, f.len);
+    s.lock.clear(std::memory_order_release);
+    return ok;
+}
+
+// Never called; gives deferred call sites printf format checking
+#if defined(__GNUC__)
+__attribute__((format(printf, 1, 2)))
+#endif
+inline void format_check(const char* fmt, ...) { (void)fmt; }
+
+} // namespace detail
+
+// ============================================================================
+// PUBLIC API
+// ============================================================================
+
+/**
+ * @brief Attach the ring frames are written to
+ * @param ring Ring shared by all producers; drained by one consumer
+ * @param clock Millisecond timestamp source (NULL: timestamps are 0)
+ */
+inline void init(SpscRing* ring, clock_fn clock) {
+    detail::State& s = detail::state();
+    s.clock = clock;
+    s.ring = ring;
+}
+
+/**
+ * @brief Write one frame; called by the LOG_ macros, not directly
+ * @param record Interned record: level byte, then the format string
+ * @param tag Module tag (address only is sent)
+ */
+template <typename... Args>
+inline void emit(const char* record, const char* tag, Args... args) {
+    detail::State& s = detail::state();
+    detail::Frame f;
+    uint8_t hdr[12];
+    detail::put_u32(hdr, (uint32_t)(uintptr_t)record);
+    detail::put_u32(hdr + 4, (uint32_t)(uintptr_t)tag);
+    detail::put_u32(hdr + 8, s.clock ? s.clock() : 0);
+    f.put(hdr, sizeof(hdr));
+    (detail::encode(f, args), ...);
+    f.buf[0] = (uint8_t)(f.len - 1);
+
+    if (f.cut) s.truncated.fetch_add(1, std::memory_order_relaxed);
+    if (detail::frame_to_ring(f)) {
+        s.frames.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        s.dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Send up to max_frames frames, COBS encoded, through fn
+ *
+ * Call from a single low-priority task. A drop marker goes out first
+ * whenever frames were lost since the last one.
+ *
+ * @return Frames sent
+ */
+inline size_t drain(write_fn fn, void* ctx, size_t max_frames) {
+    detail::State& s = detail::state();
+    if (!s.ring || !fn) return 0;
+
+    uint8_t frame[LOG_DEFER_MAX_FRAME + 8];
+    uint8_t wire[LOG_DEFER_MAX_FRAME + 8 + 3];
+    size_t sent = 0;
+
+    while (sent < max_frames) {
+        size_t len;
+        uint32_t lost = s.dropped.load(std::memory_order_relaxed) - s.reported;
+        if (lost > 0) {
+            memset(frame, 0, 12);
+            detail::put_u32(frame + 4, lost);
+            len = 12;
+        } else {
+            uint8_t n;
+            if (s.ring->peek(&n, 1) == 0) break;
+            if (s.ring->count() < (size_t)n + 1) break;
+            s.ring->consume(1);
+            len = s.ring->read(frame, n);
+        }
+
+        // COBS: every zero is replaced by the distance to the next one
+        size_t out = 1, code_at = 0;
+        uint8_t code = 1;
+        for (size_t i = 0; i < len; i++) {
+            if (frame[i] == 0) {
+                wire[code_at] = code;
+                code_at = out++;
+                code = 1;
+            } else {
+                wire[out++] = frame[i];
+                if (++code == 0xFF) {
+                    wire[code_at] = code;
+                    code_at = out++;
+                    code = 1;
+                }
+            }
+        }
+        wire[code_at] = code;
+        wire[out++] = 0x00;
+
+        if (!fn(wire, out, ctx)) break;
+        if (lost > 0) {
+            s.reported += lost;
+        } else {
+            s.drained.fetch_add(1, std::memory_order_relaxed);
+        }
+        sent++;
+    }
+    return sent;
+}
+
+inline log_defer_stats_t stats() {
+    detail::State& s = detail::state();
+    log_defer_stats_t st;
+    st.frames = s.frames.load(std::memory_order_relaxed);
+    st.dropped = s.dropped.load(std::memory_order_relaxed);
+    st.truncated = s.truncated.load(std::memory_order_relaxed);
+    st.drained = s.drained.load(std::memory_order_relaxed);
+    return st;
+}
+
+} // namespace log_defer
+
+// ============================================================================
+// CALL SITE
+// ============================================================================
+
+// The record is a function-local static in its own log_fmt section, so
+// its address is fixed at link time and the host finds it in the ELF
+#define LOG_DEFER_WRITE(level, level_char, fmt, ...) \
+    do { \
+        if ((level) <= log_get_level()) { \
+            __attribute__((section(LOG_DEFER_SECTION(__COUNTER__)), used)) \
+            static const char log_defer_rec_[] = level_char fmt; \
+            if (false) log_defer::detail::format_check(fmt, ##__VA_ARGS__); \
+            log_defer::emit(log_defer_rec_, LOG_TAG, ##__VA_ARGS__); \
+        } \
+    } while (0)
@@ -0,0 +1,102 @@
+/**
+ * @file midstate_cache.h
+ * @brief Per-domain cache of hash state after a constant prefix
+ *
+ * Domain-separated hashes (H(domain || 0x00 || data)) spend a compression
+ * on the domain tag every call. The state after the prefix never changes,
+ * so it is built once per domain and each hash starts from a copy.
+ *
+ * - Slots are claimed once and never evicted: size N for the domains the
+ *   firmware actually uses, extra domains just miss
+ * - Lock-free: a slot is claimed with a CAS, its key published with
+ *   release, and its state marked ready only once fully built, so any
+ *   task may look up while another builds
+ * - A miss (cache full, or the entry still being built) returns nullptr
+ *   and the caller hashes the prefix itself
+ * - Two tasks missing the same domain at once may each claim a slot; the
+ *   duplicate is only a wasted slot
+ *
+ * The hash library stays with the caller: State is its context type (or a
+ * wrapper), built in place by the callback passed to get().
+ *
+ * C++17 only (header-only, no allocation)
+ *
+ * Example:
+ *   static MidstateCache<mbedtls_sha256_context, 12> s_midstates;
+ *   const mbedtls_sha256_context* pre = s_midstates.get(domain, 0,
+ *       [&](mbedtls_sha256_context& ctx) { domain_starts(&ctx, domain); });
+ *   if (pre) mbedtls_sha256_clone(&ctx, pre); else domain_starts(&ctx, domain);
+ */
+
+#pragma once
+
+#ifndef __cplusplus
+#error "midstate_cache.h requires C++17"
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <atomic>
+
+// ============================================================================
+// MIDSTATE CACHE
+// ============================================================================
+
+template <typename State, size_t N>
+class MidstateCache {
+    static_assert(N > 0, "empty cache");
+
+public:
+    constexpr MidstateCache() : entries_{}, claimed_(0) {}
+
+    MidstateCache(const MidstateCache&) = delete;
+    MidstateCache& operator=(const MidstateCache&) = delete;
+
+    /**
+     * @brief Prefix state for (domain, variant), built by build(State&) on first use
+     * @param domain  Tag with static lifetime (a literal); matched by pointer, then by content
+     * @param variant Caller-defined prefix shape (e.g. with or without separator)
+     * @return Ready state to copy from, or nullptr on a miss
+     */
+    template <typename Build>
+    const State* get(const char* domain, uint8_t variant, Build&& build) {
+        size_t n = count();
+        for (size_t i = 0; i < n; i++) {
+            Entry& e = entries_[i];
+            const char* d = e.domain.load(std::memory_order_acquire);
+            if (!d || e.variant != variant) continue;
+            if (d != domain && strcmp(d, domain) != 0) continue;
+            return e.ready.load(std::memory_order_acquire) ? &e.state : nullptr;
+        }
+
+        size_t idx = claimed_.load(std::memory_order_relaxed);
+        do {
+            if (idx >= N) return nullptr;
+        } while (!claimed_.compare_exchange_weak(idx, idx + 1, std::memory_order_relaxed));
+
+        Entry& e = entries_[idx];
+        e.variant = variant;
+        e.domain.store(domain, std::memory_order_release);
+        build(e.state);
+        e.ready.store(true, std::memory_order_release);
+        return &e.state;
+    }
+
+    /** @brief Slots claimed so far (at most N) */
+    size_t count() const {
+        size_t n = claimed_.load(std::memory_order_acquire);
+        return n < N ? n : N;
+    }
+
+private:
+    struct Entry {
+        std::atomic<const char*> domain;   // nullptr until the slot's key is set
+        uint8_t variant;
+        std::atomic<bool> ready;
+        State state;
+    };
+
+    Entry entries_[N];
+    std::atomic<size_t> claimed_;
+};
@@ -2,7 +2,10 @@
  * @file ring_buffer.h
  * @brief Generic ring buffer implementation
  *
- * Thread-safe ring buffer for byte streams or fixed-size elements.
+ * Ring buffer for byte streams or fixed-size elements.
+ *
+ * Not thread-safe: counters are plain fields. For data crossing a task or
+ * ISR boundary use spsc_ring.h.
  */
 
 #pragma once
@@ -0,0 +1,205 @@
+/**
+ * @file spsc_ring.h
+ * @brief Lock-free single-producer / single-consumer byte ring
+ *
+ * Variant of ring_buffer.h for data crossing a task or ISR boundary
+ * (UART ingest, log sinks, radio queues). Exactly one context may write
+ * and exactly one may read; no locks are taken.
+ *
+ * - Power-of-two capacity: indices are free-running and masked, no modulo
+ * - head is published with release after the bytes are stored and read
+ *   with acquire before they are loaded (and the same for tail), so the
+ *   ring is safe across cores
+ * - Bulk write/read move at most two memcpy spans
+ * - Zero-copy: write_contiguous()/commit() and peek_contiguous()/consume()
+ *   expose the ring's own memory
+ *
+ * C++17 only (header-only, no allocation)
+ *
+ * Example:
+ *   static SpscRingT<1024> rx;                 // or SpscRing over a PSRAM buffer
+ *   // ISR / producer task
+ *   rx.write(data, len);
+ *   // consumer task
+ *   const uint8_t* p;
+ *   size_t n = rx.peek_contiguous(&p);
+ *   parse(p, n);
+ *   rx.consume(n);
+ */
+
+#pragma once
+
+#ifndef __cplusplus
+#error "spsc_ring.h requires C++17"
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <atomic>
+
+// ============================================================================
+// SPSC BYTE RING (external storage)
+// ============================================================================
+
+class SpscRing {
+public:
+    SpscRing() : buf_(nullptr), mask_(0), head_(0), tail_(0) {}
+
+    /**
+     * @brief Attach storage; capacity must be a power of two
+     * @return false (and the ring stays unusable) otherwise
+     */
+    bool init(uint8_t* buffer, size_t capacity) {
+        if (!buffer || capacity == 0 || (capacity & (capacity - 1)) != 0) {
+            buf_ = nullptr;
+            mask_ = 0;
+            return false;
+        }
+        buf_ = buffer;
+        mask_ = capacity - 1;
+        head_.store(0, std::memory_order_relaxed);
+        tail_.store(0, std::memory_order_relaxed);
+        return true;
+    }
+
+    /**
+     * @brief Empty the ring; only while neither side is active
+     */
+    void reset() {
+        head_.store(0, std::memory_order_relaxed);
+        tail_.store(0, std::memory_order_relaxed);
+    }
+
+    size_t capacity() const { return buf_ ? mask_ + 1 : 0; }
+
+    // Either side may call these; the answer is a snapshot
+    size_t count() const {
+        return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+    }
+    size_t space() const { return capacity() - count(); }
+    bool empty() const { return count() == 0; }
+    bool full() const { return space() == 0; }
+
+    // ------------------------------------------------------------------------
+    // Producer side
+    // ------------------------------------------------------------------------
+
+    /**
+     * @brief Copy up to len bytes in
+     * @return Bytes written (less than len if the ring filled)
+     */
+    size_t write(const uint8_t* data, size_t len) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        const size_t free = capacity() - (head - tail_.load(std::memory_order_acquire));
+        if (len > free) len = free;
+        if (len == 0) return 0;
+
+        const size_t at = head & mask_;
+        const size_t first = (len < mask_ + 1 - at) ? len : mask_ + 1 - at;
+        memcpy(buf_ + at, data, first);
+        memcpy(buf_, data + first, len - first);
+        head_.store(head + len, std::memory_order_release);
+        return len;
+    }
+
+    /**
+     * @brief Largest free span that is contiguous in memory
+     * @param region Set to the start of the span
+     * @return Span length; fill it, then commit() what was written
+     */
+    size_t write_contiguous(uint8_t** region) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        const size_t free = capacity() - (head - tail_.load(std::memory_order_acquire));
+        const size_t at = head & mask_;
+        const size_t span = mask_ + 1 - at;
+        *region = buf_ + at;
+        return free < span ? free : span;
+    }
+
+    /**
+     * @brief Publish n bytes filled through write_contiguous()
+     */
+    void commit(size_t n) {
+        head_.store(head_.load(std::memory_order_relaxed) + n, std::memory_order_release);
+    }
+
+    // ------------------------------------------------------------------------
+    // Consumer side
+    // ------------------------------------------------------------------------
+
+    /**
+     * @brief Copy up to len bytes out without consuming them
+     * @return Bytes copied
+     */
+    size_t peek(uint8_t* data, size_t len) const {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        const size_t avail = head_.load(std::memory_order_acquire) - tail;
+        if (len > avail) len = avail;
+        if (len == 0) return 0;
+
+        const size_t at = tail & mask_;
+        const size_t first = (len < mask_ + 1 - at) ? len : mask_ + 1 - at;
+        memcpy(data, buf_ + at, first);
+        memcpy(data + first, buf_, len - first);
+        return len;
+    }
+
+    /**
+     * @brief Copy up to len bytes out and consume them
+     * @return Bytes read
+     */
+    size_t read(uint8_t* data, size_t len) {
+        len = peek(data, len);
+        consume(len);
+        return len;
+    }
+
+    /**
+     * @brief Largest readable span that is contiguous in memory
+     * @param region Set to the start of the span
+     * @return Span length; call consume() once done with it
+     */
+    size_t peek_contiguous(const uint8_t** region) const {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        const size_t avail = head_.load(std::memory_order_acquire) - tail;
+        const size_t at = tail & mask_;
+        const size_t span = mask_ + 1 - at;
+        *region = buf_ + at;
+        return avail < span ? avail : span;
+    }
+
+    /**
+     * @brief Release n bytes back to the producer
+     */
+    void consume(size_t n) {
+        tail_.store(tail_.load(std::memory_order_relaxed) + n, std::memory_order_release);
+    }
+
+private:
+    uint8_t* buf_;
+    size_t mask_;
+
+    // Free-running; head - tail is the fill level even across wraparound.
+    // Separate cache lines keep the two sides from false sharing.
+    alignas(32) std::atomic<size_t> head_;   // Written by producer only
+    alignas(32) std::atomic<size_t> tail_;   // Written by consumer only
+};
+
+// ============================================================================
+// SPSC BYTE RING (inline storage)
+// ============================================================================
+
+template <size_t N>
+class SpscRingT : public SpscRing {
+    static_assert(N > 0 && (N & (N - 1)) == 0, "SpscRingT capacity must be a power of two");
+
+public:
+    SpscRingT() { init(storage_, N); }
+
+    SpscRingT(const SpscRingT&) = delete;
+    SpscRingT& operator=(const SpscRingT&) = delete;
+
+private:
+    uint8_t storage_[N];
+};
@@ -166,6 +166,7 @@ typedef enum {
     RECORD_TYPE_PRESENCE = 4,
     RECORD_TYPE_MESH_EVENT = 5,
     RECORD_TYPE_CHIRP = 6,
+    RECORD_TYPE_CHECKPOINT = 7,     // Signed chain summary (witness_chain.h)
 } record_type_t;
 
 /**
@@ -3,13 +3,22 @@
  * @brief Minimal CBOR (RFC 8949) encoder
  *
  * Provides a lightweight CBOR encoder for building PWK-compatible
- * witness record payloads. Only encoding is supported - decoding
- * is handled by the backend.
+ * witness record payloads. This is the one encoder shared by all
+ * firmware projects; decoding lives in cbor_reader.h.
  *
  * Features:
  * - Zero-allocation design (writes to user-provided buffer)
  * - Supports: integers, strings, bytes, floats, bools, null, maps, arrays
+ * - Shortest-form integers and floats (cbor_write_float)
  * - ~1KB code size
+ *
+ * Deterministic encoding (RFC 8949 section 4.2.1): definite lengths and
+ * shortest heads are always used. Callers must also write map keys in
+ * bytewise order of their encodings (shorter keys first); cbor_schema.h
+ * checks this at compile time.
+ *
+ * For maps with a fixed key set, see cbor_schema.h (keys encoded at
+ * compile time).
  */
 
 #pragma once
@@ -176,6 +185,17 @@ static inline void cbor_write_tstr(cbor_writer_t* w, const char* str) {
     cbor_write_bytes(w, (const uint8_t*)str, len);
 }
 
+/**
+ * @brief Write text string (UTF-8) of known length
+ * @param w Writer context
+ * @param str String (need not be null-terminated)
+ * @param len String length in bytes
+ */
+static inline void cbor_write_tstr_len(cbor_writer_t* w, const char* str, size_t len) {
+    cbor_write_type_value(w, 3, len);
+    cbor_write_bytes(w, (const uint8_t*)str, len);
+}
+
 /**
  * @brief Write array header (fixed length)
  * @param w Writer context
@@ -198,6 +218,17 @@ static inline void cbor_write_map(cbor_writer_t* w, size_t count) {
     cbor_write_type_value(w, 5, count);
 }
 
+/**
+ * @brief Write tag header (major type 6)
+ * @param w Writer context
+ * @param tag Tag number (e.g. 24 for an embedded CBOR byte string)
+ *
+ * Note: You must write exactly one data item after this.
+ */
+static inline void cbor_write_tag(cbor_writer_t* w, uint64_t tag) {
+    cbor_write_type_value(w, 6, tag);
+}
+
 /**
  * @brief Write boolean
  * @param w Writer context
@@ -258,6 +289,81 @@ static inline void cbor_write_float32(cbor_writer_t* w, float val) {
     cbor_write_byte(w, conv.u & 0xFF);
 }
 
+/**
+ * @brief Exact float16 bits for a float, if one exists
+ * @param f Value (finite or infinite; NaN handled by the caller)
+ * @param half Output half-precision bits
+ * @return true if f is exactly representable as float16
+ */
+static inline bool cbor_float_to_half(float f, uint16_t* half) {
+    union {
+        float f;
+        uint32_t u;
+    } conv;
+    conv.f = f;
+    uint16_t sign = (uint16_t)((conv.u >> 16) & 0x8000);
+    int32_t exp = (int32_t)((conv.u >> 23) & 0xFF);
+    uint32_t mant = conv.u & 0x7FFFFF;
+
+    if (exp == 0xFF) {                       // Infinity
+        *half = sign | 0x7C00;
+        return mant == 0;
+    }
+    if (exp == 0) {                          // Zero (float32 subnormals don't fit)
+        *half = sign;
+        return mant == 0;
+    }
+
+    int32_t e = exp - 127;
+    if (e >= -14 && e <= 15) {               // Half normal: 10 mantissa bits
+        if (mant & 0x1FFF) return false;
+        *half = sign | (uint16_t)((e + 15) << 10) | (uint16_t)(mant >> 13);
+        return true;
+    }
+    if (e >= -24 && e < -14) {               // Half subnormal: m * 2^-24
+        uint32_t full = mant | 0x800000;
+        uint32_t shift = (uint32_t)(-e - 1);
+        if (full & ((1u << shift) - 1)) return false;
+        *half = sign | (uint16_t)(full >> shift);
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Write a float in its shortest lossless form
+ *
+ * Picks float16, float32 or float64, whichever is the shortest that
+ * round-trips exactly; NaN is written as the canonical 0xF97E00. This is
+ * the preferred/deterministic float encoding of RFC 8949 section 4.2.
+ *
+ * @param w Writer context
+ * @param val Float value
+ */
+static inline void cbor_write_float(cbor_writer_t* w, double val) {
+    if (val != val) {
+        cbor_write_byte(w, 0xF9);
+        cbor_write_byte(w, 0x7E);
+        cbor_write_byte(w, 0x00);
+        return;
+    }
+
+    float f = (float)val;
+    if ((double)f != val) {
+        cbor_write_float64(w, val);
+        return;
+    }
+
+    uint16_t half;
+    if (cbor_float_to_half(f, &half)) {
+        cbor_write_byte(w, 0xF9);
+        cbor_write_byte(w, (uint8_t)(half >> 8));
+        cbor_write_byte(w, (uint8_t)(half & 0xFF));
+    } else {
+        cbor_write_float32(w, f);
+    }
+}
+
 // ============================================================================
 // CONVENIENCE MACROS
 // ============================================================================
@@ -287,11 +393,11 @@ static inline void cbor_write_float32(cbor_writer_t* w, float val) {
 } while(0)
 
 /**
- * @brief Write a string key with float value
+ * @brief Write a string key with float value (shortest form)
  */
 #define CBOR_KV_FLOAT(w, key, val) do { \
     cbor_write_tstr(w, key); \
-    cbor_write_float64(w, val); \
+    cbor_write_float(w, val); \
 } while(0)
 
 /**
@@ -351,17 +457,20 @@ public:
     // Map/Array containers
     CborWriter& map(size_t count) { cbor_write_map(&w_, count); return *this; }
     CborWriter& array(size_t count) { cbor_write_array(&w_, count); return *this; }
+    CborWriter& tag(uint64_t t) { cbor_write_tag(&w_, t); return *this; }
 
     // Key (string for map keys)
     CborWriter& key(const char* k) { cbor_write_tstr(&w_, k); return *this; }
 
     // Value types
     CborWriter& str(const char* s) { cbor_write_tstr(&w_, s); return *this; }
+    CborWriter& str(const char* s, size_t len) { cbor_write_tstr_len(&w_, s, len); return *this; }
     CborWriter& bytes(const uint8_t* data, size_t len) { cbor_write_bstr(&w_, data, len); return *this; }
     CborWriter& uint(uint64_t v) { cbor_write_uint(&w_, v); return *this; }
     CborWriter& int_(int64_t v) { cbor_write_int(&w_, v); return *this; }
-    CborWriter& flt(double v) { cbor_write_float64(&w_, v); return *this; }
+    CborWriter& flt(double v) { cbor_write_float(&w_, v); return *this; }
     CborWriter& flt32(float v) { cbor_write_float32(&w_, v); return *this; }
+    CborWriter& flt64(double v) { cbor_write_float64(&w_, v); return *this; }
     CborWriter& boolean(bool v) { cbor_write_bool(&w_, v); return *this; }
     CborWriter& null() { cbor_write_null(&w_); return *this; }
 
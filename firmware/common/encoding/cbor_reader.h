@@ -0,0 +1,425 @@
+/**
+ * @file cbor_reader.h
+ * @brief Pull-style CBOR (RFC 8949) reader
+ *
+ * Counterpart to cbor.h for consumers that read records back: export,
+ * audit verification, mesh payload parsing.
+ *
+ * Features:
+ * - Zero-allocation, zero-copy: byte and text strings are returned as
+ *   pointers into the input, never copied
+ * - Reads from a complete buffer or from a streaming source through a
+ *   caller-provided window (e.g. a witness payload being read from SD)
+ * - Reports definite and indefinite containers; cbor_skip() skips a
+ *   whole item including nested contents
+ *
+ * In streaming mode, string pointers are valid only until the next call
+ * on the reader, and the window must hold the largest item header
+ * (9 bytes) and the longest single string.
+ *
+ * Example:
+ *   cbor_reader_t r;
+ *   cbor_item_t it;
+ *   cbor_reader_init(&r, payload, len);
+ *   if (cbor_next(&r, &it) && it.type == CBOR_ITEM_MAP) {
+ *       for (uint64_t i = 0; i < it.v.count; i++) {
+ *           cbor_item_t key, val;
+ *           if (!cbor_next(&r, &key) || !cbor_next(&r, &val)) break;
+ *           if (cbor_text_equals(&key, "lat")) cbor_item_to_double(&val, &lat);
+ *           else cbor_skip(&r, &val);
+ *       }
+ *   }
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// CONSTANTS
+// ============================================================================
+
+#define CBOR_READER_MAX_DEPTH   16      // Nesting limit for cbor_skip()
+
+// ============================================================================
+// TYPES
+// ============================================================================
+
+/**
+ * @brief Decoded item kinds
+ */
+typedef enum {
+    CBOR_ITEM_UINT = 0,         // v.uint
+    CBOR_ITEM_NINT,             // v.sint (negative)
+    CBOR_ITEM_BSTR,             // data/len (or indefinite: chunks follow)
+    CBOR_ITEM_TSTR,             // data/len (or indefinite: chunks follow)
+    CBOR_ITEM_ARRAY,            // v.count items follow (or indefinite)
+    CBOR_ITEM_MAP,              // v.count pairs follow (or indefinite)
+    CBOR_ITEM_TAG,              // v.tag, one item follows
+    CBOR_ITEM_BOOL,             // v.boolean
+    CBOR_ITEM_NULL,
+    CBOR_ITEM_UNDEFINED,
+    CBOR_ITEM_FLOAT,            // v.flt (float16/32/64 widened)
+    CBOR_ITEM_SIMPLE,           // v.simple (unassigned simple value)
+    CBOR_ITEM_BREAK,            // End of an indefinite container/string
+} cbor_item_type_t;
+
+/**
+ * @brief Reader status
+ */
+typedef enum {
+    CBOR_READ_OK = 0,
+    CBOR_READ_END,              // Clean end of input at an item boundary
+    CBOR_READ_TRUNCATED,        // Input ended inside an item
+    CBOR_READ_MALFORMED,        // Reserved additional info or bad structure
+    CBOR_READ_OVERFLOW,         // Negative integer below INT64_MIN
+    CBOR_READ_TOO_LONG,         // String larger than the stream window
+    CBOR_READ_DEPTH,            // Nesting deeper than CBOR_READER_MAX_DEPTH
+} cbor_read_status_t;
+
+/**
+ * @brief One decoded item
+ */
+typedef struct {
+    cbor_item_type_t type;
+    bool indefinite;            // Indefinite-length container or string
+    union {
+        uint64_t uint;
+        int64_t sint;
+        double flt;
+        bool boolean;
+        uint64_t count;
+        uint64_t tag;
+        uint8_t simple;
+    } v;
+    const uint8_t* data;        // String contents (in place, not terminated)
+    size_t len;                 // String length
+} cbor_item_t;
+
+/**
+ * @brief Streaming source: copy up to max bytes into dst
+ * @return Bytes provided (0 = end of input)
+ */
+typedef size_t (*cbor_source_fn)(void* ctx, uint8_t* dst, size_t max);
+
+/**
+ * @brief CBOR reader context
+ */
+typedef struct {
+    const uint8_t* buf;         // Input (buffer mode) or window (stream mode)
+    size_t len;                 // Valid bytes in buf
+    size_t pos;                 // Read position in buf
+    size_t offset;              // Input offset of buf[0]
+    uint8_t* window;            // Stream window (NULL in buffer mode)
+    size_t window_cap;
+    cbor_source_fn source;
+    void* source_ctx;
+    bool eof;                   // Source exhausted
+    cbor_read_status_t status;
+} cbor_reader_t;
+
+// ============================================================================
+// INITIALIZATION
+// ============================================================================
+
+/**
+ * @brief Read from a complete buffer
+ * @param r Reader context
+ * @param buf Input (must outlive all returned string pointers)
+ * @param len Input length
+ */
+static inline void cbor_reader_init(cbor_reader_t* r, const uint8_t* buf, size_t len) {
+    memset(r, 0, sizeof(*r));
+    r->buf = buf;
+    r->len = len;
+    r->eof = true;
+}
+
+/**
+ * @brief Read from a streaming source through a window buffer
+ * @param r Reader context
+ * @param window Scratch window (at least 9 bytes; bounds the longest string)
+ * @param cap Window capacity
+ * @param source Source callback
+ * @param ctx Source context
+ */
+static inline void cbor_reader_init_stream(cbor_reader_t* r, uint8_t* window, size_t cap,
+                                           cbor_source_fn source, void* ctx) {
+    memset(r, 0, sizeof(*r));
+    r->buf = window;
+    r->window = window;
+    r->window_cap = cap;
+    r->source = source;
+    r->source_ctx = ctx;
+}
+
+/**
+ * @brief Reader status after cbor_next() returned false
+ */
+static inline cbor_read_status_t cbor_reader_status(const cbor_reader_t* r) {
+    return r->status;
+}
+
+/**
+ * @brief Input offset of the next unread byte
+ */
+static inline size_t cbor_reader_offset(const cbor_reader_t* r) {
+    return r->offset + r->pos;
+}
+
+// ============================================================================
+// INTERNAL HELPERS
+// ============================================================================
+
+// Make n bytes available at buf[pos]; refills (and compacts) in stream mode
+static inline bool cbor_reader_ensure(cbor_reader_t* r, size_t n) {
+    if (r->len - r->pos >= n) return true;
+    if (!r->window) return false;
+    if (n > r->window_cap) {
+        r->status = CBOR_READ_TOO_LONG;
+        return false;
+    }
+
+    size_t keep = r->len - r->pos;
+    if (r->pos > 0) {
+        memmove(r->window, r->window + r->pos, keep);
+        r->offset += r->pos;
+        r->pos = 0;
+        r->len = keep;
+    }
+    while (r->len < n && !r->eof) {
+        size_t got = r->source(r->source_ctx, r->window + r->len, r->window_cap - r->len);
+        if (got == 0) {
+            r->eof = true;
+        }
+        r->len += got;
+    }
+    return r->len >= n;
+}
+
+static inline uint64_t cbor_reader_be(const uint8_t* p, size_t n) {
+    uint64_t v = 0;
+    for (size_t i = 0; i < n; i++) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+static inline double cbor_half_to_double(uint16_t h) {
+    int exp = (h >> 10) & 0x1F;
+    int mant = h & 0x3FF;
+    double val;
+    if (exp == 0) {
+        val = mant * (1.0 / 16777216.0);                 // mant * 2^-24 (subnormal)
+    } else if (exp != 31) {
+        val = (mant + 1024) * (double)(1u << exp) / 33554432.0;   // (1024+mant) * 2^(exp-25)
+    } else {
+        union { uint64_t u; double d; } conv;
+        conv.u = mant == 0 ? 0x7FF0000000000000ULL : 0x7FF8000000000000ULL;
+        val = conv.d;
+    }
+    return (h & 0x8000) ? -val : val;
+}
+
+static inline bool cbor_reader_fail(cbor_reader_t* r, cbor_read_status_t status) {
+    if (r->status == CBOR_READ_OK) r->status = status;
+    return false;
+}
+
+// ============================================================================
+// READING
+// ============================================================================
+
+/**
+ * @brief Read the next item header (and string contents, in place)
+ *
+ * Containers report their count only; their children are returned by
+ * subsequent calls. Use cbor_skip() to step over a container.
+ *
+ * @param r Reader context
+ * @param item Output item
+ * @return true if an item was read; false at end of input or on error
+ *         (see cbor_reader_status())
+ */
+static inline bool cbor_next(cbor_reader_t* r, cbor_item_t* item) {
+    if (r->status != CBOR_READ_OK) return false;
+    if (!cbor_reader_ensure(r, 1)) {
+        return cbor_reader_fail(r, r->len == r->pos ? CBOR_READ_END : CBOR_READ_TRUNCATED);
+    }
+
+    uint8_t ib = r->buf[r->pos];
+    uint8_t major = ib >> 5;
+    uint8_t ai = ib & 0x1F;
+    size_t arg_len = ai < 24 ? 0 : ai == 24 ? 1 : ai == 25 ? 2 : ai == 26 ? 4 : ai == 27 ? 8 : 0;
+
+    if (ai >= 28 && ai <= 30) return cbor_reader_fail(r, CBOR_READ_MALFORMED);
+    if (ai == 31 && (major == 0 || major == 1 || major == 6)) {
+        return cbor_reader_fail(r, CBOR_READ_MALFORMED);
+    }
+    if (!cbor_reader_ensure(r, 1 + arg_len)) {
+        return cbor_reader_fail(r, CBOR_READ_TRUNCATED);
+    }
+
+    uint64_t arg = ai < 24 ? ai : cbor_reader_be(r->buf + r->pos + 1, arg_len);
+    r->pos += 1 + arg_len;
+
+    memset(item, 0, sizeof(*item));
+    item->indefinite = (ai == 31);
+
+    switch (major) {
+        case 0:
+            item->type = CBOR_ITEM_UINT;
+            item->v.uint = arg;
+            return true;
+
+        case 1:
+            if (arg > (uint64_t)INT64_MAX) return cbor_reader_fail(r, CBOR_READ_OVERFLOW);
+            item->type = CBOR_ITEM_NINT;
+            item->v.sint = -1 - (int64_t)arg;
+            return true;
+
+        case 2:
+        case 3:
+            item->type = major == 2 ? CBOR_ITEM_BSTR : CBOR_ITEM_TSTR;
+            if (item->indefinite) return true;       // Chunks follow, then BREAK
+            if (arg > SIZE_MAX || !cbor_reader_ensure(r, (size_t)arg)) {
+                return cbor_reader_fail(r, CBOR_READ_TRUNCATED);
+            }
+            item->data = r->buf + r->pos;
+            item->len = (size_t)arg;
+            r->pos += (size_t)arg;
+            return true;
+
+        case 4:
+        case 5:
+            item->type = major == 4 ? CBOR_ITEM_ARRAY : CBOR_ITEM_MAP;
+            item->v.count = item->indefinite ? 0 : arg;
+            return true;
+
+        case 6:
+            item->type = CBOR_ITEM_TAG;
+            item->v.tag = arg;
+            return true;
+
+        default:
+            break;
+    }
+
+    // Major type 7: simple values and floats
+    switch (ai) {
+        case 20: item->type = CBOR_ITEM_BOOL; item->v.boolean = false; return true;
+        case 21: item->type = CBOR_ITEM_BOOL; item->v.boolean = true; return true;
+        case 22: item->type = CBOR_ITEM_NULL; return true;
+        case 23: item->type = CBOR_ITEM_UNDEFINED; return true;
+        case 25:
+            item->type = CBOR_ITEM_FLOAT;
+            item->v.flt = cbor_half_to_double((uint16_t)arg);
+            return true;
+        case 26: {
+            union { uint32_t u; float f; } conv;
+            conv.u = (uint32_t)arg;
+            item->type = CBOR_ITEM_FLOAT;
+            item->v.flt = conv.f;
+            return true;
+        }
+        case 27: {
+            union { uint64_t u; double d; } conv;
+            conv.u = arg;
+            item->type = CBOR_ITEM_FLOAT;
+            item->v.flt = conv.d;
+            return true;
+        }
+        case 31:
+            item->type = CBOR_ITEM_BREAK;
+            item->indefinite = false;
+            return true;
+        default:
+            item->type = CBOR_ITEM_SIMPLE;
+            item->v.simple = (uint8_t)arg;
+            return true;
+    }
+}
+
+/**
+ * @brief Skip the contents of an item just returned by cbor_next()
+ *
+ * No-op for scalars and definite strings. For containers, tags and
+ * indefinite strings, consumes everything up to the end of the item.
+ *
+ * @param r Reader context
+ * @param item Item returned by the preceding cbor_next()
+ * @return true on success
+ */
+static inline bool cbor_skip(cbor_reader_t* r, const cbor_item_t* item) {
+    // Per level: items still expected, or UINT64_MAX for "until BREAK"
+    uint64_t pending[CBOR_READER_MAX_DEPTH];
+    int depth = 0;
+
+#define CBOR_SKIP_PUSH(it) do { \
+        uint64_t need_ = (it)->indefinite ? UINT64_MAX : \
+            (it)->type == CBOR_ITEM_MAP ? (it)->v.count * 2 : \
+            (it)->type == CBOR_ITEM_TAG ? 1 : \
+            ((it)->type == CBOR_ITEM_ARRAY ? (it)->v.count : 0); \
+        if (need_ > 0) { \
+            if (depth >= CBOR_READER_MAX_DEPTH) return cbor_reader_fail(r, CBOR_READ_DEPTH); \
+            pending[depth++] = need_; \
+        } \
+    } while (0)
+
+    CBOR_SKIP_PUSH(item);
+    while (depth > 0) {
+        cbor_item_t child;
+        if (!cbor_next(r, &child)) {
+            return cbor_reader_fail(r, CBOR_READ_TRUNCATED);
+        }
+        if (child.type == CBOR_ITEM_BREAK) {
+            if (pending[depth - 1] != UINT64_MAX) return cbor_reader_fail(r, CBOR_READ_MALFORMED);
+            depth--;
+        } else {
+            if (pending[depth - 1] != UINT64_MAX) pending[depth - 1]--;
+            CBOR_SKIP_PUSH(&child);
+        }
+        while (depth > 0 && pending[depth - 1] == 0) {
+            depth--;
+        }
+    }
+#undef CBOR_SKIP_PUSH
+    return true;
+}
+
+// ============================================================================
+// ITEM HELPERS
+// ============================================================================
+
+/**
+ * @brief Compare a definite text string item with a C string
+ */
+static inline bool cbor_text_equals(const cbor_item_t* item, const char* str) {
+    size_t n = strlen(str);
+    return item->type == CBOR_ITEM_TSTR && !item->indefinite &&
+           item->len == n && memcmp(item->data, str, n) == 0;
+}
+
+/**
+ * @brief Numeric value of an integer or float item
+ * @return false if the item is not numeric
+ */
+static inline bool cbor_item_to_double(const cbor_item_t* item, double* out) {
+    switch (item->type) {
+        case CBOR_ITEM_UINT:  *out = (double)item->v.uint; return true;
+        case CBOR_ITEM_NINT:  *out = (double)item->v.sint; return true;
+        case CBOR_ITEM_FLOAT: *out = item->v.flt; return true;
+        default: return false;
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
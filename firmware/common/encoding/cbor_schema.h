@@ -0,0 +1,338 @@
+/**
+ * @file cbor_schema.h
+ * @brief Compile-time CBOR map schemas
+ *
+ * For payloads with a fixed set of keys (witness events, boot records),
+ * the map header, every key and each value's leading byte are encoded at
+ * compile time. At runtime only the values are written, so encoding is a
+ * sequence of short memcpys, and the worst-case size is a constant that
+ * sizes the output buffer exactly.
+ *
+ * Output is identical to writing the same map with cbor.h: definite-length
+ * map, text keys in schema order, shortest-form integer headers and (for
+ * Float) shortest lossless floats. Declare keys in deterministic order
+ * and static_assert(schema.deterministic()) for canonical payloads.
+ *
+ * C++17 only (header-only, no allocation)
+ *
+ * Example:
+ *   static constexpr auto kSchema = cbor_schema::map(
+ *       cbor_schema::field<cbor_schema::Bool>("fix"),
+ *       cbor_schema::field<cbor_schema::Float>("lat"),
+ *       cbor_schema::field<cbor_schema::Text<5>>("state"));
+ *   static_assert(kSchema.deterministic(), "keys out of order");
+ *
+ *   uint8_t buf[kSchema.kMaxSize];
+ *   size_t len = kSchema.encode(buf, sizeof(buf), true, 37.7749, "MOVE");
+ *   // len == 0 if a value does not fit its declared bound
+ */
+
+#pragma once
+
+#ifndef __cplusplus
+#error "cbor_schema.h requires C++17"
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <tuple>
+#include <utility>
+
+#include "cbor.h"
+
+namespace cbor_schema {
+
+// ============================================================================
+// INTERNAL HELPERS
+// ============================================================================
+
+namespace detail {
+
+/**
+ * @brief Bytes needed for a CBOR initial byte plus argument
+ */
+constexpr size_t head_size(uint64_t val) {
+    return val <= 23 ? 1 : val <= 0xFF ? 2 : val <= 0xFFFF ? 3 : val <= 0xFFFFFFFF ? 5 : 9;
+}
+
+/**
+ * @brief Write a CBOR initial byte plus argument (shortest form)
+ * @return Pointer past the written bytes
+ */
+inline uint8_t* put_head(uint8_t* p, uint8_t major, uint64_t val) {
+    uint8_t mt = major << 5;
+    size_t n = head_size(val);
+    if (n == 1) {
+        *p++ = mt | (uint8_t)val;
+        return p;
+    }
+    *p++ = mt | (n == 2 ? 24 : n == 3 ? 25 : n == 5 ? 26 : 27);
+    for (size_t i = n - 1; i > 0; i--) {
+        *p++ = (uint8_t)(val >> ((i - 1) * 8));
+    }
+    return p;
+}
+
+inline uint8_t* put_be(uint8_t* p, uint64_t bits, size_t n) {
+    for (size_t i = n; i > 0; i--) {
+        *p++ = (uint8_t)(bits >> ((i - 1) * 8));
+    }
+    return p;
+}
+
+} // namespace detail
+
+// ============================================================================
+// VALUE KINDS
+// ============================================================================
+
+/*
+ * Each kind declares:
+ *   kLead     constant leading bytes folded into the field prefix (0 or 1)
+ *   kLeadByte that byte, when kLead == 1
+ *   kMaxBody  worst-case bytes written at runtime
+ *   put()     writes the value, returns nullptr if it exceeds the bound
+ */
+
+/**
+ * @brief Float in its shortest lossless form (3, 5 or 9 bytes)
+ */
+struct Float {
+    static constexpr size_t kLead = 0;
+    static constexpr uint8_t kLeadByte = 0;
+    static constexpr size_t kMaxBody = 9;
+
+    static uint8_t* put(uint8_t* p, double val) {
+        cbor_writer_t w;
+        cbor_init(&w, p, kMaxBody);
+        cbor_write_float(&w, val);
+        return p + cbor_size(&w);
+    }
+};
+
+/**
+ * @brief IEEE 754 double (major type 7, always 9 bytes)
+ */
+struct Float64 {
+    static constexpr size_t kLead = 1;
+    static constexpr uint8_t kLeadByte = 0xFB;
+    static constexpr size_t kMaxBody = 8;
+
+    static uint8_t* put(uint8_t* p, double val) {
+        uint64_t bits;
+        memcpy(&bits, &val, sizeof(bits));
+        return detail::put_be(p, bits, 8);
+    }
+};
+
+/**
+ * @brief IEEE 754 single (major type 7, always 5 bytes)
+ */
+struct Float32 {
+    static constexpr size_t kLead = 1;
+    static constexpr uint8_t kLeadByte = 0xFA;
+    static constexpr size_t kMaxBody = 4;
+
+    static uint8_t* put(uint8_t* p, float val) {
+        uint32_t bits;
+        memcpy(&bits, &val, sizeof(bits));
+        return detail::put_be(p, bits, 4);
+    }
+};
+
+/**
+ * @brief Boolean (single byte 0xF4/0xF5)
+ */
+struct Bool {
+    static constexpr size_t kLead = 0;
+    static constexpr uint8_t kLeadByte = 0;
+    static constexpr size_t kMaxBody = 1;
+
+    static uint8_t* put(uint8_t* p, bool val) {
+        *p++ = val ? 0xF5 : 0xF4;
+        return p;
+    }
+};
+
+/**
+ * @brief Unsigned integer bounded by MaxValue
+ */
+template <uint64_t MaxValue = 0xFFFFFFFF>
+struct Uint {
+    static constexpr size_t kLead = 0;
+    static constexpr uint8_t kLeadByte = 0;
+    static constexpr size_t kMaxBody = detail::head_size(MaxValue);
+
+    static uint8_t* put(uint8_t* p, uint64_t val) {
+        if (val > MaxValue) return nullptr;
+        return detail::put_head(p, 0, val);
+    }
+};
+
+/**
+ * @brief Text string of at most MaxLen bytes
+ */
+template <size_t MaxLen>
+struct Text {
+    static constexpr size_t kLead = 0;
+    static constexpr uint8_t kLeadByte = 0;
+    static constexpr size_t kMaxBody = detail::head_size(MaxLen) + MaxLen;
+
+    static uint8_t* put(uint8_t* p, const char* str) {
+        size_t len = strlen(str);
+        if (len > MaxLen) return nullptr;
+        p = detail::put_head(p, 3, len);
+        memcpy(p, str, len);
+        return p + len;
+    }
+};
+
+/**
+ * @brief Byte string value (pointer plus length)
+ */
+struct ByteSpan {
+    const uint8_t* data;
+    size_t len;
+};
+
+/**
+ * @brief Byte string of at most MaxLen bytes
+ */
+template <size_t MaxLen>
+struct Bytes {
+    static constexpr size_t kLead = 0;
+    static constexpr uint8_t kLeadByte = 0;
+    static constexpr size_t kMaxBody = detail::head_size(MaxLen) + MaxLen;
+
+    static uint8_t* put(uint8_t* p, const ByteSpan& val) {
+        if (val.len > MaxLen) return nullptr;
+        p = detail::put_head(p, 2, val.len);
+        if (val.len) memcpy(p, val.data, val.len);
+        return p + val.len;
+    }
+};
+
+// ============================================================================
+// FIELDS
+// ============================================================================
+
+/**
+ * @brief Map entry: pre-encoded key plus the value's constant lead byte
+ */
+template <typename Kind, size_t KeyLen>
+struct Field {
+    using kind = Kind;
+    static constexpr size_t kPrefix = 1 + KeyLen + Kind::kLead;
+
+    uint8_t prefix[kPrefix];
+};
+
+/**
+ * @brief Declare a field; the key is encoded at compile time
+ * @param key String literal (at most 23 bytes)
+ */
+template <typename Kind, size_t N>
+constexpr Field<Kind, N - 1> field(const char (&key)[N]) {
+    static_assert(N - 1 <= 23, "schema keys must fit a one-byte text header");
+    Field<Kind, N - 1> f{};
+    f.prefix[0] = (uint8_t)(0x60 | (N - 1));
+    for (size_t i = 0; i + 1 < N; i++) {
+        f.prefix[1 + i] = (uint8_t)key[i];
+    }
+    if constexpr (Kind::kLead == 1) {
+        f.prefix[N] = Kind::kLeadByte;
+    }
+    return f;
+}
+
+// ============================================================================
+// MAP SCHEMA
+// ============================================================================
+
+/**
+ * @brief Fixed-key CBOR map
+ */
+template <typename... Fields>
+class Map {
+public:
+    static_assert(sizeof...(Fields) <= 23, "schema maps must fit a one-byte header");
+
+    static constexpr size_t kCount = sizeof...(Fields);
+
+    /** Worst-case encoded size; size output buffers with this */
+    static constexpr size_t kMaxSize = 1 + ((Fields::kPrefix + Fields::kind::kMaxBody) + ... + 0);
+
+    constexpr explicit Map(Fields... fields) : fields_(fields...) {}
+
+    /**
+     * @brief Whether keys are in deterministic (RFC 8949 4.2.1) order
+     *
+     * True when each encoded key sorts bytewise before the next, i.e.
+     * shorter keys first, then lexicographic. Use in a static_assert.
+     */
+    constexpr bool deterministic() const {
+        return sorted_impl(std::index_sequence_for<Fields...>{});
+    }
+
+    /**
+     * @brief Encode one map, values in schema order
+     * @param out Output buffer
+     * @param cap Buffer capacity (must be at least kMaxSize)
+     * @return Bytes written, or 0 if cap is short or a value exceeds its bound
+     */
+    template <typename... Values>
+    size_t encode(uint8_t* out, size_t cap, const Values&... values) const {
+        static_assert(sizeof...(Values) == kCount, "one value per schema field");
+        if (cap < kMaxSize) return 0;
+        return encode_impl(out, std::index_sequence_for<Fields...>{}, values...);
+    }
+
+private:
+    static constexpr bool key_less(const uint8_t* a, size_t a_len, const uint8_t* b, size_t b_len) {
+        for (size_t i = 0; i < a_len && i < b_len; i++) {
+            if (a[i] != b[i]) return a[i] < b[i];
+        }
+        return a_len < b_len;
+    }
+
+    template <size_t... I>
+    constexpr bool sorted_impl(std::index_sequence<I...>) const {
+        if constexpr (sizeof...(I) < 2) {
+            return true;
+        } else {
+            const uint8_t* keys[] = { std::get<I>(fields_).prefix... };
+            const size_t lens[] = { (Fields::kPrefix - Fields::kind::kLead)... };
+            for (size_t i = 1; i < sizeof...(I); i++) {
+                if (!key_less(keys[i - 1], lens[i - 1], keys[i], lens[i])) return false;
+            }
+            return true;
+        }
+    }
+
+    template <size_t... I, typename... Values>
+    size_t encode_impl(uint8_t* out, std::index_sequence<I...>, const Values&... values) const {
+        uint8_t* p = out;
+        *p++ = (uint8_t)(0xA0 | kCount);
+        ((p = p ? put_field(std::get<I>(fields_), p, values) : nullptr), ...);
+        return p ? (size_t)(p - out) : 0;
+    }
+
+    template <typename F, typename V>
+    static uint8_t* put_field(const F& f, uint8_t* p, const V& val) {
+        memcpy(p, f.prefix, F::kPrefix);
+        return F::kind::put(p + F::kPrefix, val);
+    }
+
+    std::tuple<Fields...> fields_;
+};
+
+/**
+ * @brief Declare a map schema (use as a static constexpr)
+ */
+template <typename... Fields>
+constexpr Map<Fields...> map(Fields... fields) {
+    return Map<Fields...>(fields...);
+}
+
+} // namespace cbor_schema
@@ -0,0 +1,470 @@
+/**
+ * @file ota_decode.h
+ * @brief Streaming decoder for compressed and delta OTA images
+ *
+ * Turns the bytes of an OTA transfer back into the firmware image as they
+ * arrive, so nothing larger than one network block is ever buffered. The
+ * decoded image goes to a write callback (flash staging, Update.write());
+ * integrity is still the caller's SHA-256 over those decoded bytes.
+ *
+ * Encodings:
+ * - raw:   the image itself, passed through
+ * - zlib:  the image as one zlib stream (RFC 1950, Adler-32 checked)
+ * - delta: a zlib-compressed SCVD patch against the running image
+ *
+ * SCVD patch (all integers little-endian, lengths LEB128 varints):
+ *
+ *   header  "SCVD" | u8 version (1) | 3 reserved | u32 target_size |
+ *           u32 base_size | base_sha256[32]
+ *   ops     0x01 COPY  varint base_off, varint len        out = base
+ *           0x02 ADD   varint base_off, varint len, data  out = base + data
+ *           0x03 DATA  varint len, data                   out = data
+ *           0x00 END
+ *
+ * ADD is bsdiff's trick: code that only moved leaves small differences
+ * in every relocated pointer, and those bytes compress to almost nothing.
+ * common/tools/ota_patch.py builds patches. Every op is bounds-checked
+ * against base_size and target_size, and the header's base hash is handed
+ * to check_base() before the first byte is produced, so a patch is never
+ * applied to an image it was not made from.
+ *
+ * Inflate uses tinfl from the ESP32 mask ROM (miniz on the host). zlib
+ * and delta allocate a 32 KiB dictionary, the ~11 KiB inflator and a
+ * small scratch buffer for base reads; raw allocates nothing.
+ *
+ * Example:
+ *   ota_decoder_io_t io = { stage_write, base_read, base_check, &dl };
+ *   ota_decoder_t d;
+ *   if (!ota_decoder_init(&d, OTA_ENCODING_DELTA, image_size, &io)) fail();
+ *   while ((n = recv(buf, sizeof(buf))) > 0) {
+ *       if (!ota_decoder_feed(&d, buf, n)) break;
+ *   }
+ *   bool ok = ota_decoder_finish(&d);   // false: see d.status
+ *   ota_decoder_free(&d);
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(ESP_PLATFORM)
+#include "rom/miniz.h"
+#else
+#include "miniz.h"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// CONSTANTS
+// ============================================================================
+
+#define OTA_PATCH_MAGIC         "SCVD"
+#define OTA_PATCH_VERSION       1
+#define OTA_PATCH_HEADER_SIZE   48
+#define OTA_DECODE_SCRATCH      1024    // Base bytes read per COPY/ADD step
+
+#define OTA_PATCH_OP_END        0x00
+#define OTA_PATCH_OP_COPY       0x01
+#define OTA_PATCH_OP_ADD        0x02
+#define OTA_PATCH_OP_DATA       0x03
+
+// ============================================================================
+// TYPES
+// ============================================================================
+
+/**
+ * @brief How the transferred bytes encode the image
+ */
+typedef enum {
+    OTA_ENCODING_RAW = 0,
+    OTA_ENCODING_ZLIB,
+    OTA_ENCODING_DELTA,
+} ota_encoding_t;
+
+/**
+ * @brief Decoder status
+ */
+typedef enum {
+    OTA_DECODE_OK = 0,
+    OTA_DECODE_NO_MEMORY,
+    OTA_DECODE_BAD_STREAM,      // Corrupt zlib data or Adler-32 mismatch
+    OTA_DECODE_BAD_PATCH,       // Bad header, unknown op, malformed varint, trailing bytes
+    OTA_DECODE_BASE_MISMATCH,   // check_base() rejected the patch's base image
+    OTA_DECODE_BASE_RANGE,      // COPY/ADD outside the base image
+    OTA_DECODE_SIZE,            // Output longer or shorter than the image size
+    OTA_DECODE_TRUNCATED,       // Input ended before the stream did
+    OTA_DECODE_READ_FAILED,     // read_base() failed
+    OTA_DECODE_WRITE_FAILED,    // write() failed
+} ota_decode_status_t;
+
+/**
+ * @brief Decoder callbacks; all but write may be NULL for raw and zlib
+ */
+typedef struct {
+    /** Consume len decoded image bytes, in order */
+    bool (*write)(void* ctx, const uint8_t* data, size_t len);
+    /** Read len bytes of the base (running) image at offset */
+    bool (*read_base)(void* ctx, uint32_t offset, uint8_t* buf, size_t len);
+    /** Accept the patch's base: first base_size bytes hash to base_sha256 */
+    bool (*check_base)(void* ctx, uint32_t base_size, const uint8_t base_sha256[32]);
+    void* ctx;
+} ota_decoder_io_t;
+
+/**
+ * @brief Decoder context
+ */
+typedef struct {
+    ota_encoding_t encoding;
+    ota_decode_status_t status;
+    ota_decoder_io_t io;
+    uint32_t image_size;        // Expected output, 0 = unchecked
+    uint32_t in_bytes;          // Transfer bytes fed
+    uint32_t out_bytes;         // Image bytes written
+
+    // Inflate
+    tinfl_decompressor* inflator;
+    uint8_t* dict;              // TINFL_LZ_DICT_SIZE circular output window
+    size_t dict_ofs;
+    bool inflated;              // Stream end seen
+
+    // Patch parser
+    uint8_t* scratch;           // OTA_DECODE_SCRATCH
+    uint8_t header[OTA_PATCH_HEADER_SIZE];
+    uint8_t header_fill;
+    uint8_t state;
+    uint8_t op;
+    uint8_t field;              // Varint being read for op
+    uint8_t varint_shift;
+    uint32_t varint;
+    uint32_t base_off;
+    uint32_t len;               // Bytes left in the current op
+    uint32_t target_size;
+    uint32_t base_size;
+} ota_decoder_t;
+
+// Patch parser states
+#define OTA_PATCH_ST_HEADER     0
+#define OTA_PATCH_ST_OP         1
+#define OTA_PATCH_ST_VARINT     2
+#define OTA_PATCH_ST_PAYLOAD    3
+#define OTA_PATCH_ST_END        4
+
+// ============================================================================
+// NAMES
+// ============================================================================
+
+/**
+ * @brief Manifest/header spelling of an encoding
+ */
+static inline const char* ota_encoding_name(ota_encoding_t e) {
+    switch (e) {
+        case OTA_ENCODING_ZLIB:  return "zlib";
+        case OTA_ENCODING_DELTA: return "delta";
+        default:                 return "raw";
+    }
+}
+
+/**
+ * @brief Parse "raw", "zlib" or "delta"
+ * @return false for anything else
+ */
+static inline bool ota_encoding_parse(const char* s, ota_encoding_t* out) {
+    if (strcmp(s, "raw") == 0)   { *out = OTA_ENCODING_RAW;   return true; }
+    if (strcmp(s, "zlib") == 0)  { *out = OTA_ENCODING_ZLIB;  return true; }
+    if (strcmp(s, "delta") == 0) { *out = OTA_ENCODING_DELTA; return true; }
+    return false;
+}
+
+/**
+ * @brief Short snake_case name of a status, for logs and API errors
+ */
+static inline const char* ota_decode_status_name(ota_decode_status_t s) {
+    switch (s) {
+        case OTA_DECODE_OK:            return "ok";
+        case OTA_DECODE_NO_MEMORY:     return "decode_no_memory";
+        case OTA_DECODE_BAD_STREAM:    return "decode_bad_stream";
+        case OTA_DECODE_BAD_PATCH:     return "decode_bad_patch";
+        case OTA_DECODE_BASE_MISMATCH: return "decode_base_mismatch";
+        case OTA_DECODE_BASE_RANGE:    return "decode_base_range";
+        case OTA_DECODE_SIZE:          return "decode_size_mismatch";
+        case OTA_DECODE_TRUNCATED:     return "decode_truncated";
+        case OTA_DECODE_READ_FAILED:   return "decode_read_failed";
+        case OTA_DECODE_WRITE_FAILED:  return "decode_write_failed";
+        default:                       return "decode_error";
+    }
+}
+
+// ============================================================================
+// INTERNAL HELPERS
+// ============================================================================
+
+static inline bool ota_decode_fail(ota_decoder_t* d, ota_decode_status_t status) {
+    if (d->status == OTA_DECODE_OK) d->status = status;
+    return false;
+}
+
+static inline uint32_t ota_decode_le32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// Hand image bytes to the caller, never past image_size
+static inline bool ota_decode_output(ota_decoder_t* d, const uint8_t* data, size_t len) {
+    if (d->image_size && len > d->image_size - d->out_bytes) {
+        return ota_decode_fail(d, OTA_DECODE_SIZE);
+    }
+    if (!d->io.write(d->io.ctx, data, len)) {
+        return ota_decode_fail(d, OTA_DECODE_WRITE_FAILED);
+    }
+    d->out_bytes += (uint32_t)len;
+    return true;
+}
+
+static inline bool ota_decode_parse_header(ota_decoder_t* d) {
+    const uint8_t* h = d->header;
+    if (memcmp(h, OTA_PATCH_MAGIC, 4) != 0 || h[4] != OTA_PATCH_VERSION) {
+        return ota_decode_fail(d, OTA_DECODE_BAD_PATCH);
+    }
+    d->target_size = ota_decode_le32(h + 8);
+    d->base_size = ota_decode_le32(h + 12);
+    if (d->image_size && d->target_size != d->image_size) {
+        return ota_decode_fail(d, OTA_DECODE_SIZE);
+    }
+    d->image_size = d->target_size;
+    if (!d->io.check_base(d->io.ctx, d->base_size, h + 16)) {
+        return ota_decode_fail(d, OTA_DECODE_BASE_MISMATCH);
+    }
+    return true;
+}
+
+// Base bytes [off, off + len) exist, and len more output bytes fit
+static inline bool ota_decode_check_op(ota_decoder_t* d) {
+    if (d->op != OTA_PATCH_OP_DATA &&
+        (d->base_off > d->base_size || d->len > d->base_size - d->base_off)) {
+        return ota_decode_fail(d, OTA_DECODE_BASE_RANGE);
+    }
+    if (d->len > d->target_size - d->out_bytes) {
+        return ota_decode_fail(d, OTA_DECODE_SIZE);
+    }
+    return true;
+}
+
+static inline bool ota_decode_copy(ota_decoder_t* d) {
+    while (d->len > 0) {
+        size_t n = d->len < OTA_DECODE_SCRATCH ? d->len : OTA_DECODE_SCRATCH;
+        if (!d->io.read_base(d->io.ctx, d->base_off, d->scratch, n)) {
+            return ota_decode_fail(d, OTA_DECODE_READ_FAILED);
+        }
+        if (!ota_decode_output(d, d->scratch, n)) return false;
+        d->base_off += (uint32_t)n;
+        d->len -= (uint32_t)n;
+    }
+    return true;
+}
+
+// An op's varints are all read: run it or start its payload
+static inline bool ota_decode_op_ready(ota_decoder_t* d) {
+    if (!ota_decode_check_op(d)) return false;
+    if (d->op == OTA_PATCH_OP_COPY) {
+        if (!ota_decode_copy(d)) return false;
+        d->state = OTA_PATCH_ST_OP;
+    } else {
+        d->state = d->len > 0 ? OTA_PATCH_ST_PAYLOAD : OTA_PATCH_ST_OP;
+    }
+    return true;
+}
+
+/**
+ * @brief Run decompressed SCVD patch bytes through the op parser
+ */
+static inline bool ota_decode_patch(ota_decoder_t* d, const uint8_t* p, size_t len) {
+    while (len > 0) {
+        switch (d->state) {
+            case OTA_PATCH_ST_HEADER: {
+                size_t n = OTA_PATCH_HEADER_SIZE - d->header_fill;
+                if (n > len) n = len;
+                memcpy(d->header + d->header_fill, p, n);
+                p += n;
+                len -= n;
+                d->header_fill += (uint8_t)n;
+                if (d->header_fill == OTA_PATCH_HEADER_SIZE) {
+                    if (!ota_decode_parse_header(d)) return false;
+                    d->state = OTA_PATCH_ST_OP;
+                }
+                break;
+            }
+
+            case OTA_PATCH_ST_OP:
+                d->op = *p++;
+                len--;
+                if (d->op == OTA_PATCH_OP_END) {
+                    if (d->out_bytes != d->target_size) return ota_decode_fail(d, OTA_DECODE_SIZE);
+                    d->state = OTA_PATCH_ST_END;
+                } else if (d->op <= OTA_PATCH_OP_DATA) {
+                    d->field = d->op == OTA_PATCH_OP_DATA ? 1 : 0;
+                    d->base_off = 0;
+                    d->varint = 0;
+                    d->varint_shift = 0;
+                    d->state = OTA_PATCH_ST_VARINT;
+                } else {
+                    return ota_decode_fail(d, OTA_DECODE_BAD_PATCH);
+                }
+                break;
+
+            case OTA_PATCH_ST_VARINT: {
+                uint8_t b = *p++;
+                len--;
+                // Five groups at most, and the fifth may only carry 4 bits
+                if (d->varint_shift == 28 && (b & 0xF0)) return ota_decode_fail(d, OTA_DECODE_BAD_PATCH);
+                d->varint |= (uint32_t)(b & 0x7F) << d->varint_shift;
+                if (b & 0x80) {
+                    d->varint_shift += 7;
+                    break;
+                }
+                if (d->field == 0) {
+                    d->base_off = d->varint;
+                    d->field = 1;
+                    d->varint = 0;
+                    d->varint_shift = 0;
+                    break;
+                }
+                d->len = d->varint;
+                if (!ota_decode_op_ready(d)) return false;
+                break;
+            }
+
+            case OTA_PATCH_ST_PAYLOAD: {
+                size_t n = d->len < OTA_DECODE_SCRATCH ? d->len : OTA_DECODE_SCRATCH;
+                if (n > len) n = len;
+                if (d->op == OTA_PATCH_OP_ADD) {
+                    if (!d->io.read_base(d->io.ctx, d->base_off, d->scratch, n)) {
+                        return ota_decode_fail(d, OTA_DECODE_READ_FAILED);
+                    }
+                    for (size_t i = 0; i < n; i++) d->scratch[i] = (uint8_t)(d->scratch[i] + p[i]);
+                    if (!ota_decode_output(d, d->scratch, n)) return false;
+                    d->base_off += (uint32_t)n;
+                } else if (!ota_decode_output(d, p, n)) {
+                    return false;
+                }
+                p += n;
+                len -= n;
+                d->len -= (uint32_t)n;
+                if (d->len == 0) d->state = OTA_PATCH_ST_OP;
+                break;
+            }
+
+            default:
+                return ota_decode_fail(d, OTA_DECODE_BAD_PATCH);   // Bytes after END
+        }
+    }
+    return true;
+}
+
+// Route inflated bytes to the image or the patch parser
+static inline bool ota_decode_inflated(ota_decoder_t* d, const uint8_t* p, size_t len) {
+    return d->encoding == OTA_ENCODING_DELTA ? ota_decode_patch(d, p, len)
+                                             : ota_decode_output(d, p, len);
+}
+
+// ============================================================================
+// API
+// ============================================================================
+
+/**
+ * @brief Prepare to decode one image
+ * @param d Decoder context
+ * @param encoding Transfer encoding
+ * @param image_size Decoded image size to enforce, 0 = unchecked
+ * @param io Callbacks (copied); delta needs read_base and check_base
+ * @return false (d->status says why) if buffers could not be allocated
+ */
+static inline bool ota_decoder_init(ota_decoder_t* d, ota_encoding_t encoding,
+                                    uint32_t image_size, const ota_decoder_io_t* io) {
+    memset(d, 0, sizeof(*d));
+    d->encoding = encoding;
+    d->image_size = image_size;
+    d->io = *io;
+    d->target_size = UINT32_MAX;
+    if (encoding == OTA_ENCODING_RAW) return true;
+
+    if (encoding == OTA_ENCODING_DELTA && (!io->read_base || !io->check_base)) {
+        return ota_decode_fail(d, OTA_DECODE_BAD_PATCH);
+    }
+    d->inflator = (tinfl_decompressor*)malloc(sizeof(tinfl_decompressor));
+    d->dict = (uint8_t*)malloc(TINFL_LZ_DICT_SIZE);
+    if (encoding == OTA_ENCODING_DELTA) d->scratch = (uint8_t*)malloc(OTA_DECODE_SCRATCH);
+    if (!d->inflator || !d->dict || (encoding == OTA_ENCODING_DELTA && !d->scratch)) {
+        return ota_decode_fail(d, OTA_DECODE_NO_MEMORY);
+    }
+    tinfl_init(d->inflator);
+    return true;
+}
+
+/**
+ * @brief Decode the next len transfer bytes
+ * @return false on the first error; later calls keep returning false
+ */
+static inline bool ota_decoder_feed(ota_decoder_t* d, const uint8_t* data, size_t len) {
+    if (d->status != OTA_DECODE_OK) return false;
+    d->in_bytes += (uint32_t)len;
+    if (d->encoding == OTA_ENCODING_RAW) return ota_decode_output(d, data, len);
+
+    while (true) {
+        // Bytes after the end of the zlib stream are not part of the image
+        if (d->inflated) return len == 0 || ota_decode_fail(d, OTA_DECODE_BAD_STREAM);
+
+        size_t in_len = len;
+        size_t out_len = TINFL_LZ_DICT_SIZE - d->dict_ofs;
+        tinfl_status st = tinfl_decompress(d->inflator, data, &in_len, d->dict,
+                                           d->dict + d->dict_ofs, &out_len,
+                                           TINFL_FLAG_PARSE_ZLIB_HEADER | TINFL_FLAG_HAS_MORE_INPUT);
+        data += in_len;
+        len -= in_len;
+        if (out_len > 0 && !ota_decode_inflated(d, d->dict + d->dict_ofs, out_len)) return false;
+        d->dict_ofs = (d->dict_ofs + out_len) & (TINFL_LZ_DICT_SIZE - 1);
+
+        if (st < TINFL_STATUS_DONE) return ota_decode_fail(d, OTA_DECODE_BAD_STREAM);
+        if (st == TINFL_STATUS_DONE) d->inflated = true;
+        else if (st == TINFL_STATUS_NEEDS_MORE_INPUT && len == 0) return true;
+    }
+}
+
+/**
+ * @brief The transfer has ended: check the image is complete
+ * @return true if every stream ended cleanly and the size is right
+ */
+static inline bool ota_decoder_finish(ota_decoder_t* d) {
+    if (d->status != OTA_DECODE_OK) return false;
+    if (d->encoding != OTA_ENCODING_RAW && !d->inflated) {
+        return ota_decode_fail(d, OTA_DECODE_TRUNCATED);
+    }
+    if (d->encoding == OTA_ENCODING_DELTA && d->state != OTA_PATCH_ST_END) {
+        return ota_decode_fail(d, OTA_DECODE_TRUNCATED);
+    }
+    if (d->image_size && d->out_bytes != d->image_size) {
+        return ota_decode_fail(d, OTA_DECODE_SIZE);
+    }
+    return true;
+}
+
+/**
+ * @brief Release the decoder's buffers (safe after a failed init)
+ */
+static inline void ota_decoder_free(ota_decoder_t* d) {
+    free(d->inflator);
+    free(d->dict);
+    free(d->scratch);
+    d->inflator = NULL;
+    d->dict = NULL;
+    d->scratch = NULL;
+}
+
+#ifdef __cplusplus
+}
+#endif
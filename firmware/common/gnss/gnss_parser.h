@@ -4,11 +4,22 @@
  *
  * Parses standard NMEA sentences from GPS/GNSS receivers.
  * Supports GGA, RMC, GSA, GSV, and VTG sentences.
+ *
+ * Sentences are split once by nmea_tokenizer.h (fields and checksum in a
+ * single pass) and numbers are parsed in fixed point; only the final
+ * gnss_fix_t values are converted to double.
+ *
+ * UBX frames from u-blox receivers are framed out of the same byte
+ * stream (ubx.h); a NAV-PVT frame updates fix and time in one step.
+ * Switching the receiver to UBX output is up to the caller, using the
+ * CFG builders in ubx.h.
  */
 
 #pragma once
 
 #include "../core/types.h"
+#include "nmea_tokenizer.h"
+#include "ubx.h"
 #include <stdint.h>
 #include <stddef.h>
 #include <stdbool.h>
@@ -40,6 +51,7 @@ typedef struct {
     char sentence_buf[GNSS_NMEA_MAX_LEN];
     size_t sentence_len;
     bool in_sentence;
+    ubx_parser_t ubx;
 
     // Statistics
     uint32_t gga_count;
@@ -47,6 +59,7 @@ typedef struct {
     uint32_t gsa_count;
     uint32_t gsv_count;
     uint32_t vtg_count;
+    uint32_t ubx_pvt_count;
     uint32_t checksum_errors;
     uint32_t parse_errors;
 
@@ -103,11 +116,12 @@ void gnss_parser_set_time_callback(
 /**
  * @brief Process incoming byte
  *
- * Call this for each byte received from the GNSS module.
+ * Call this for each byte received from the GNSS module. NMEA and UBX
+ * may be interleaved.
  *
  * @param parser Parser state
  * @param byte Incoming byte
- * @return true if a complete sentence was parsed
+ * @return true if a complete sentence or UBX frame was parsed
  */
 bool gnss_parser_process_byte(gnss_parser_t* parser, uint8_t byte);
 
@@ -166,7 +180,8 @@ typedef struct {
     uint32_t gsa_count;
     uint32_t gsv_count;
     uint32_t vtg_count;
-    uint32_t checksum_errors;
+    uint32_t ubx_pvt_count;
+    uint32_t checksum_errors;          // NMEA and UBX
     uint32_t parse_errors;
 } gnss_stats_t;
 
@@ -218,3 +233,309 @@ static inline double gnss_knots_to_mps(double knots) {
 #ifdef __cplusplus
 }
 #endif
+
+// ============================================================================
+// IMPLEMENTATION (Header-only for common/)
+// ============================================================================
+
+#ifdef GNSS_PARSER_IMPLEMENTATION
+
+#include <math.h>
+#include "../hal/hal.h"
+
+void gnss_parser_init(gnss_parser_t* parser) {
+    memset(parser, 0, sizeof(*parser));
+    gnss_parser_reset(parser);
+}
+
+void gnss_parser_reset(gnss_parser_t* parser) {
+    memset(&parser->fix, 0, sizeof(parser->fix));
+    memset(&parser->time, 0, sizeof(parser->time));
+    parser->fix.hdop = 99.9;
+    parser->fix.pdop = 99.9;
+    parser->fix.vdop = 99.9;
+    parser->fix.mode = GPS_MODE_NONE;
+    parser->sentence_len = 0;
+    parser->in_sentence = false;
+    ubx_parser_init(&parser->ubx);
+}
+
+void gnss_parser_set_fix_callback(
+    gnss_parser_t* parser,
+    void (*callback)(const gnss_fix_t* fix, void* user_data),
+    void* user_data
+) {
+    parser->on_fix_update = callback;
+    parser->user_data = user_data;
+}
+
+void gnss_parser_set_time_callback(
+    gnss_parser_t* parser,
+    void (*callback)(const gnss_time_t* time, void* user_data),
+    void* user_data
+) {
+    parser->on_time_update = callback;
+    parser->user_data = user_data;
+}
+
+// Fixed-point field as double, or def if empty
+static double gnss_field_fixed(const nmea_sentence_t* s, uint8_t i, uint8_t decimals, double def) {
+    static const double SCALE[] = { 1.0, 10.0, 100.0, 1000.0 };
+    int32_t v;
+    if (decimals > 3 || !nmea_parse_fixed(nmea_field(s, i), decimals, &v)) return def;
+    return v / SCALE[decimals];
+}
+
+static uint32_t gnss_field_uint(const nmea_sentence_t* s, uint8_t i, uint32_t def) {
+    uint32_t v;
+    return nmea_parse_uint(nmea_field(s, i), &v) ? v : def;
+}
+
+static void gnss_parse_gga(gnss_parser_t* parser, const nmea_sentence_t* s) {
+    gnss_fix_t* fix = &parser->fix;
+    parser->gga_count++;
+
+    int32_t lat_e7, lon_e7;
+    if (nmea_parse_coord(nmea_field(s, 2), nmea_field(s, 3), &lat_e7)) {
+        fix->latitude = lat_e7 / 1e7;
+    }
+    if (nmea_parse_coord(nmea_field(s, 4), nmea_field(s, 5), &lon_e7)) {
+        fix->longitude = lon_e7 / 1e7;
+    }
+
+    fix->quality = (gps_fix_quality_t)gnss_field_uint(s, 6, GPS_FIX_INVALID);
+    fix->satellites = (uint8_t)gnss_field_uint(s, 7, 0);
+    fix->hdop = gnss_field_fixed(s, 8, 2, 99.9);
+    fix->altitude_m = gnss_field_fixed(s, 9, 2, 0);
+    fix->geoid_sep_m = gnss_field_fixed(s, 11, 2, 0);
+    fix->valid = fix->quality != GPS_FIX_INVALID;
+    fix->last_update_ms = hal_millis();
+
+    if (parser->on_fix_update) {
+        parser->on_fix_update(fix, parser->user_data);
+    }
+}
+
+static void gnss_parse_rmc(gnss_parser_t* parser, const nmea_sentence_t* s) {
+    gnss_fix_t* fix = &parser->fix;
+    gnss_time_t* t = &parser->time;
+    parser->rmc_count++;
+
+    int32_t v;
+    if (nmea_parse_fixed(nmea_field(s, 7), 3, &v)) {
+        fix->speed_knots = v / 1000.0;
+        fix->speed_kmh = gnss_knots_to_kmh(fix->speed_knots);
+    }
+    if (nmea_parse_fixed(nmea_field(s, 8), 2, &v)) {
+        fix->course_deg = v / 100.0;
+    }
+
+    bool have_time = nmea_parse_time(nmea_field(s, 1), &t->hour, &t->minute,
+                                     &t->second, &t->centisecond);
+    if (nmea_parse_date(nmea_field(s, 9), &t->year, &t->month, &t->day) && have_time) {
+        t->valid = true;
+        t->last_update_ms = hal_millis();
+        if (parser->on_time_update) {
+            parser->on_time_update(t, parser->user_data);
+        }
+    }
+}
+
+static void gnss_parse_gsa(gnss_parser_t* parser, const nmea_sentence_t* s) {
+    gnss_fix_t* fix = &parser->fix;
+    parser->gsa_count++;
+
+    uint32_t mode;
+    if (nmea_parse_uint(nmea_field(s, 2), &mode)) {
+        fix->mode = (gps_fix_mode_t)mode;
+    }
+    fix->pdop = gnss_field_fixed(s, 15, 2, 99.9);
+    fix->hdop = gnss_field_fixed(s, 16, 2, fix->hdop);
+    fix->vdop = gnss_field_fixed(s, 17, 2, 99.9);
+}
+
+static void gnss_parse_gsv(gnss_parser_t* parser, const nmea_sentence_t* s) {
+    parser->gsv_count++;
+    uint32_t siv;
+    if (nmea_parse_uint(nmea_field(s, 3), &siv)) {
+        parser->fix.sats_in_view = (uint8_t)siv;
+    }
+}
+
+static void gnss_parse_vtg(gnss_parser_t* parser, const nmea_sentence_t* s) {
+    gnss_fix_t* fix = &parser->fix;
+    parser->vtg_count++;
+    fix->course_deg = gnss_field_fixed(s, 1, 2, fix->course_deg);
+    fix->speed_kmh = gnss_field_fixed(s, 7, 2, fix->speed_kmh);
+}
+
+// Dispatch one complete sentence; false if it was rejected
+static bool gnss_parse_sentence(gnss_parser_t* parser, char* line) {
+    nmea_sentence_t s;
+    nmea_status_t st = nmea_tokenize(line, &s);
+    if (st == NMEA_ERR_CHECKSUM) {
+        parser->checksum_errors++;
+        return false;
+    }
+    if (st != NMEA_OK) {
+        parser->parse_errors++;
+        return false;
+    }
+
+    if (nmea_type_is(&s, "GGA")) gnss_parse_gga(parser, &s);
+    else if (nmea_type_is(&s, "RMC")) gnss_parse_rmc(parser, &s);
+    else if (nmea_type_is(&s, "GSA")) gnss_parse_gsa(parser, &s);
+    else if (nmea_type_is(&s, "GSV")) gnss_parse_gsv(parser, &s);
+    else if (nmea_type_is(&s, "VTG")) gnss_parse_vtg(parser, &s);
+    return true;
+}
+
+static void gnss_parse_nav_pvt(gnss_parser_t* parser, const ubx_nav_pvt_t* pvt) {
+    gnss_fix_t* fix = &parser->fix;
+    gnss_time_t* t = &parser->time;
+    uint32_t now = hal_millis();
+    parser->ubx_pvt_count++;
+
+    bool position = pvt->fix_type >= 2 && pvt->fix_type <= 4;
+    fix->valid = pvt->fix_ok && position;
+    fix->quality = fix->valid ? GPS_FIX_GPS : GPS_FIX_INVALID;
+    fix->mode = pvt->fix_type == 2 ? GPS_MODE_2D :
+                (pvt->fix_type == 3 || pvt->fix_type == 4) ? GPS_MODE_3D : GPS_MODE_NONE;
+    fix->satellites = pvt->num_sv;
+    fix->latitude = pvt->lat_e7 / 1e7;
+    fix->longitude = pvt->lon_e7 / 1e7;
+    fix->altitude_m = pvt->hmsl_mm / 1000.0;
+    fix->geoid_sep_m = (pvt->height_mm - pvt->hmsl_mm) / 1000.0;
+    fix->speed_knots = pvt->ground_speed_mms / 514.444;
+    fix->speed_kmh = pvt->ground_speed_mms * 0.0036;
+    fix->course_deg = pvt->heading_e5 / 1e5;
+    fix->pdop = pvt->pdop_e2 / 100.0;
+    fix->last_update_ms = now;
+
+    if (parser->on_fix_update) {
+        parser->on_fix_update(fix, parser->user_data);
+    }
+
+    if (pvt->date_valid && pvt->time_valid) {
+        t->year = pvt->year;
+        t->month = pvt->month;
+        t->day = pvt->day;
+        t->hour = pvt->hour;
+        t->minute = pvt->minute;
+        t->second = pvt->second;
+        t->centisecond = pvt->nano > 0 ? (uint8_t)(pvt->nano / 10000000) : 0;
+        t->valid = true;
+        t->last_update_ms = now;
+        if (parser->on_time_update) {
+            parser->on_time_update(t, parser->user_data);
+        }
+    }
+}
+
+bool gnss_parser_process_byte(gnss_parser_t* parser, uint8_t byte) {
+    ubx_feed_t ubx = ubx_parser_feed(&parser->ubx, byte);
+    if (ubx == UBX_FEED_FRAME) {
+        ubx_nav_pvt_t pvt;
+        if (ubx_is(&parser->ubx, UBX_CLASS_NAV, UBX_NAV_PVT) &&
+            ubx_decode_nav_pvt(parser->ubx.payload, parser->ubx.len, &pvt)) {
+            gnss_parse_nav_pvt(parser, &pvt);
+            return true;
+        }
+        return false;
+    }
+    if (ubx == UBX_FEED_BUSY) {
+        return false;
+    }
+    if (ubx == UBX_FEED_RESYNC) {
+        uint8_t replay[UBX_REPLAY_MAX];
+        size_t n = ubx_take_replay(&parser->ubx, replay);
+        bool updated = false;
+        for (size_t i = 0; i < n; i++) {
+            updated |= gnss_parser_process_byte(parser, replay[i]);
+        }
+        return updated;
+    }
+
+    if (byte == '$') {
+        parser->in_sentence = true;
+        parser->sentence_len = 0;
+    }
+    if (!parser->in_sentence) {
+        return false;
+    }
+
+    if (byte == '\r' || byte == '\n') {
+        parser->in_sentence = false;
+        parser->sentence_buf[parser->sentence_len] = '\0';
+        return gnss_parse_sentence(parser, parser->sentence_buf);
+    }
+
+    if (parser->sentence_len < GNSS_NMEA_MAX_LEN - 1) {
+        parser->sentence_buf[parser->sentence_len++] = (char)byte;
+    } else {
+        // Overlong sentence; drop it and wait for the next '$'
+        parser->in_sentence = false;
+        parser->parse_errors++;
+    }
+    return false;
+}
+
+int gnss_parser_process(gnss_parser_t* parser, const uint8_t* data, size_t len) {
+    int parsed = 0;
+    for (size_t i = 0; i < len; i++) {
+        if (gnss_parser_process_byte(parser, data[i])) parsed++;
+    }
+    return parsed;
+}
+
+const gnss_fix_t* gnss_parser_get_fix(const gnss_parser_t* parser) {
+    return &parser->fix;
+}
+
+const gnss_time_t* gnss_parser_get_time(const gnss_parser_t* parser) {
+    return &parser->time;
+}
+
+bool gnss_parser_has_fix(const gnss_parser_t* parser) {
+    return parser->fix.valid;
+}
+
+uint32_t gnss_parser_fix_age_ms(const gnss_parser_t* parser) {
+    if (!parser->fix.valid) return UINT32_MAX;
+    return hal_millis() - parser->fix.last_update_ms;
+}
+
+void gnss_parser_get_stats(const gnss_parser_t* parser, gnss_stats_t* stats) {
+    stats->gga_count = parser->gga_count;
+    stats->rmc_count = parser->rmc_count;
+    stats->gsa_count = parser->gsa_count;
+    stats->gsv_count = parser->gsv_count;
+    stats->vtg_count = parser->vtg_count;
+    stats->ubx_pvt_count = parser->ubx_pvt_count;
+    stats->checksum_errors = parser->checksum_errors + parser->ubx.checksum_errors;
+    stats->parse_errors = parser->parse_errors;
+}
+
+#define GNSS_EARTH_RADIUS_M     6371000.0
+#define GNSS_DEG_TO_RAD         (M_PI / 180.0)
+
+double gnss_distance_m(double lat1, double lon1, double lat2, double lon2) {
+    double dlat = (lat2 - lat1) * GNSS_DEG_TO_RAD;
+    double dlon = (lon2 - lon1) * GNSS_DEG_TO_RAD;
+    double a = sin(dlat / 2) * sin(dlat / 2) +
+               cos(lat1 * GNSS_DEG_TO_RAD) * cos(lat2 * GNSS_DEG_TO_RAD) *
+               sin(dlon / 2) * sin(dlon / 2);
+    return GNSS_EARTH_RADIUS_M * 2 * atan2(sqrt(a), sqrt(1 - a));
+}
+
+double gnss_bearing_deg(double lat1, double lon1, double lat2, double lon2) {
+    double phi1 = lat1 * GNSS_DEG_TO_RAD;
+    double phi2 = lat2 * GNSS_DEG_TO_RAD;
+    double dlon = (lon2 - lon1) * GNSS_DEG_TO_RAD;
+    double y = sin(dlon) * cos(phi2);
+    double x = cos(phi1) * sin(phi2) - sin(phi1) * cos(phi2) * cos(dlon);
+    double deg = atan2(y, x) / GNSS_DEG_TO_RAD;
+    return deg < 0 ? deg + 360.0 : deg;
+}
+
+#endif // GNSS_PARSER_IMPLEMENTATION
@@ -0,0 +1,277 @@
+/**
+ * @file nmea_tokenizer.h
+ * @brief Single-pass NMEA 0183 tokenizer and fixed-point field parsers
+ *
+ * Shared by gnss_parser.h and the canary GpsManager.
+ *
+ * Features:
+ * - One pass over the sentence: field boundaries are recorded and the
+ *   checksum is accumulated together, so looking up field i is O(1)
+ * - Zero-allocation, in place: commas and '*' are overwritten with NUL,
+ *   and each field is a C string pointing into the caller's line
+ * - Integer-only number parsing: coordinates come out in degrees x 1e7
+ *   and decimal fields in caller-chosen fixed point, with no atof()
+ *
+ * Example:
+ *   nmea_sentence_t s;
+ *   if (nmea_tokenize(line, &s) == NMEA_OK && nmea_type_is(&s, "GGA")) {
+ *       int32_t lat_e7;
+ *       if (nmea_parse_coord(nmea_field(&s, 2), nmea_field(&s, 3), &lat_e7)) ...
+ *   }
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// CONSTANTS
+// ============================================================================
+
+#define NMEA_MAX_FIELDS         24      // GSV/GSA plus the NMEA 4.1 system ID
+
+// ============================================================================
+// TYPES
+// ============================================================================
+
+/**
+ * @brief Tokenizer result
+ */
+typedef enum {
+    NMEA_OK = 0,
+    NMEA_ERR_FORMAT,            // No leading '$' or no "*hh" checksum
+    NMEA_ERR_CHECKSUM,          // Checksum mismatch
+    NMEA_ERR_FIELDS,            // More than NMEA_MAX_FIELDS fields
+} nmea_status_t;
+
+/**
+ * @brief Tokenized sentence
+ *
+ * fields[0] is the address ("GPGGA"); data fields start at 1, matching
+ * the field numbers in the NMEA 0183 tables. Pointers are into the line
+ * passed to nmea_tokenize() and valid as long as it is.
+ */
+typedef struct {
+    const char* fields[NMEA_MAX_FIELDS];
+    uint8_t count;
+} nmea_sentence_t;
+
+// ============================================================================
+// TOKENIZER
+// ============================================================================
+
+static inline int nmea_hex_nibble(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+/**
+ * @brief Split a sentence into fields and verify its checksum
+ * @param line NUL-terminated sentence starting with '$' (modified in place)
+ * @param out Tokenized fields
+ * @return NMEA_OK, or why the sentence was rejected
+ */
+static inline nmea_status_t nmea_tokenize(char* line, nmea_sentence_t* out) {
+    out->count = 0;
+    if (!line || line[0] != '$') return NMEA_ERR_FORMAT;
+
+    uint8_t calc = 0;
+    bool overflow = false;
+    char* p = line + 1;
+    out->fields[out->count++] = p;
+
+    for (; *p && *p != '*'; p++) {
+        calc ^= (uint8_t)*p;
+        if (*p == ',') {
+            *p = '\0';
+            if (out->count < NMEA_MAX_FIELDS) {
+                out->fields[out->count++] = p + 1;
+            } else {
+                overflow = true;
+            }
+        }
+    }
+
+    if (*p != '*') return NMEA_ERR_FORMAT;
+    *p = '\0';
+
+    int hi = nmea_hex_nibble(p[1]);
+    int lo = hi < 0 ? -1 : nmea_hex_nibble(p[2]);
+    if (lo < 0) return NMEA_ERR_FORMAT;
+    if ((uint8_t)((hi << 4) | lo) != calc) return NMEA_ERR_CHECKSUM;
+
+    return overflow ? NMEA_ERR_FIELDS : NMEA_OK;
+}
+
+/**
+ * @brief Field i, or "" if the sentence is shorter
+ */
+static inline const char* nmea_field(const nmea_sentence_t* s, uint8_t i) {
+    return i < s->count ? s->fields[i] : "";
+}
+
+/**
+ * @brief Whether the sentence type (address minus talker ID) is type
+ * @param s Tokenized sentence
+ * @param type Three-letter type, e.g. "GGA"
+ */
+static inline bool nmea_type_is(const nmea_sentence_t* s, const char* type) {
+    const char* addr = s->fields[0];
+    return s->count > 0 && strlen(addr) == 5 && memcmp(addr + 2, type, 3) == 0;
+}
+
+// ============================================================================
+// FIXED-POINT FIELD PARSERS
+// ============================================================================
+
+/**
+ * @brief Parse an unsigned integer field
+ * @return false if empty or not all digits
+ */
+static inline bool nmea_parse_uint(const char* f, uint32_t* out) {
+    if (!f || !*f) return false;
+    uint64_t v = 0;
+    for (; *f; f++) {
+        if (*f < '0' || *f > '9') return false;
+        v = v * 10 + (uint32_t)(*f - '0');
+        if (v > UINT32_MAX) return false;
+    }
+    *out = (uint32_t)v;
+    return true;
+}
+
+/**
+ * @brief Parse a decimal field into fixed point
+ * @param f Field such as "-12.345"
+ * @param decimals Fractional digits to keep ("12.345", 2 -> 1234)
+ * @param out Value x 10^decimals (extra digits are truncated)
+ * @return false if empty, malformed or out of int32 range
+ */
+static inline bool nmea_parse_fixed(const char* f, uint8_t decimals, int32_t* out) {
+    if (!f || !*f) return false;
+
+    bool neg = false;
+    if (*f == '-' || *f == '+') {
+        neg = *f == '-';
+        f++;
+    }
+
+    // v stays within int32 at every step, so a run of junk digits cannot
+    // overflow the accumulator
+    int64_t v = 0;
+    bool digits = false;
+    for (; *f >= '0' && *f <= '9'; f++) {
+        v = v * 10 + (*f - '0');
+        if (v > INT32_MAX) return false;
+        digits = true;
+    }
+
+    uint8_t kept = 0;
+    if (*f == '.') {
+        for (f++; *f >= '0' && *f <= '9'; f++) {
+            if (kept < decimals) {
+                v = v * 10 + (*f - '0');
+                if (v > INT32_MAX) return false;
+                kept++;
+            }
+            digits = true;
+        }
+    }
+    if (*f || !digits) return false;
+
+    for (; kept < decimals; kept++) {
+        v *= 10;
+        if (v > INT32_MAX) return false;
+    }
+
+    *out = (int32_t)(neg ? -v : v);
+    return true;
+}
+
+/**
+ * @brief Parse a ddmm.mmmm / dddmm.mmmm coordinate
+ * @param f Coordinate field
+ * @param hemi Hemisphere field ("N", "S", "E", "W")
+ * @param deg_e7 Signed degrees x 1e7
+ * @return false if empty, malformed or out of range (90 degrees for N/S,
+ *         180 otherwise)
+ */
+static inline bool nmea_parse_coord(const char* f, const char* hemi, int32_t* deg_e7) {
+    if (!f || !*f) return false;
+
+    // Degrees are everything before the two integer minute digits
+    const char* dot = strchr(f, '.');
+    size_t int_len = dot ? (size_t)(dot - f) : strlen(f);
+    if (int_len < 3 || int_len > 5) return false;
+
+    int32_t deg = 0;
+    for (size_t i = 0; i < int_len - 2; i++) {
+        if (f[i] < '0' || f[i] > '9') return false;
+        deg = deg * 10 + (f[i] - '0');
+    }
+
+    int32_t min_e6;
+    if (!nmea_parse_fixed(f + int_len - 2, 6, &min_e6) || min_e6 < 0 || min_e6 >= 60000000) {
+        return false;
+    }
+    bool lat = hemi && (hemi[0] == 'N' || hemi[0] == 'S');
+    int32_t limit = lat ? 90 : 180;
+    if (deg > limit) return false;
+
+    // degrees x 1e7 = minutes x 1e6 / 6, rounded
+    int32_t e7 = deg * 10000000 + (min_e6 + 3) / 6;
+    if (e7 > limit * 10000000) return false;
+    *deg_e7 = (hemi && (hemi[0] == 'S' || hemi[0] == 'W')) ? -e7 : e7;
+    return true;
+}
+
+/**
+ * @brief Parse hhmmss[.ss] UTC time
+ * @return false if shorter than six digits
+ */
+static inline bool nmea_parse_time(const char* f, uint8_t* hour, uint8_t* minute,
+                                   uint8_t* second, uint8_t* centisecond) {
+    if (!f) return false;
+    for (int i = 0; i < 6; i++) {
+        if (f[i] < '0' || f[i] > '9') return false;
+    }
+    *hour = (uint8_t)((f[0] - '0') * 10 + (f[1] - '0'));
+    *minute = (uint8_t)((f[2] - '0') * 10 + (f[3] - '0'));
+    *second = (uint8_t)((f[4] - '0') * 10 + (f[5] - '0'));
+
+    int32_t frac = 0;
+    if (f[6] == '.' && nmea_parse_fixed(f + 6, 2, &frac)) {
+        *centisecond = (uint8_t)frac;
+    } else {
+        *centisecond = 0;
+    }
+    return true;
+}
+
+/**
+ * @brief Parse ddmmyy date
+ * @return false if not six digits
+ */
+static inline bool nmea_parse_date(const char* f, uint16_t* year, uint8_t* month, uint8_t* day) {
+    if (!f) return false;
+    for (int i = 0; i < 6; i++) {
+        if (f[i] < '0' || f[i] > '9') return false;
+    }
+    *day = (uint8_t)((f[0] - '0') * 10 + (f[1] - '0'));
+    *month = (uint8_t)((f[2] - '0') * 10 + (f[3] - '0'));
+    *year = (uint16_t)(2000 + (f[4] - '0') * 10 + (f[5] - '0'));
+    return true;
+}
+
+#ifdef __cplusplus
+}
+#endif
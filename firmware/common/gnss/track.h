@@ -0,0 +1,263 @@
+/**
+ * @file track.h
+ * @brief Fixed-memory fix history and on-device track compression
+ *
+ * Collects every position fix between two witness records in a ring,
+ * then reduces them to a few significant points and packs those into a
+ * compact byte string for the record payload. A record then describes
+ * the path travelled since the previous one instead of a single sample.
+ *
+ * Features:
+ * - Zero-allocation: the ring, the simplifier's work area and the
+ *   encoder all use fixed-size caller-owned storage
+ * - Top-down Douglas-Peucker that stops at a point budget: the most
+ *   significant vertex is added first, so the output is always the best
+ *   shape for its size and never exceeds TRACK_SEGMENT_MAX_POINTS
+ * - Distances in metres on a local equirectangular projection, which is
+ *   well under 0.1% off at the tens-of-metres scale of one segment
+ *
+ * Segment encoding (all values zigzag LEB128 varints):
+ *   first point:  lat_e7, lon_e7, age_ds  (age before the newest point)
+ *   each next:    dlat_e7, dlon_e7, dt_ds (deltas from the previous)
+ * Points are in time order; ds = deciseconds.
+ *
+ * Example:
+ *   track_ring_push(&ring, lat_e7, lon_e7, now);
+ *   ...
+ *   track_point_t seg[TRACK_SEGMENT_MAX_POINTS];
+ *   size_t n = track_simplify(pts, count, TRACK_TOLERANCE_M, seg, TRACK_SEGMENT_MAX_POINTS);
+ *   size_t len = track_encode(seg, n, buf, sizeof(buf));
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// CONSTANTS
+// ============================================================================
+
+#ifndef TRACK_RING_CAPACITY
+#define TRACK_RING_CAPACITY         64      // Fixes kept between records
+#endif
+
+#ifndef TRACK_SEGMENT_MAX_POINTS
+#define TRACK_SEGMENT_MAX_POINTS    8       // Points per encoded segment
+#endif
+
+#ifndef TRACK_TOLERANCE_M
+#define TRACK_TOLERANCE_M           5.0     // Default simplification tolerance
+#endif
+
+// Worst case per point: two 5-byte and one 3-byte varint
+#define TRACK_POINT_MAX_BYTES       13
+#define TRACK_SEGMENT_MAX_BYTES     (TRACK_SEGMENT_MAX_POINTS * TRACK_POINT_MAX_BYTES)
+
+// ============================================================================
+// TYPES
+// ============================================================================
+
+/**
+ * @brief One position fix
+ */
+typedef struct {
+    int32_t lat_e7;             // Degrees x 1e7
+    int32_t lon_e7;             // Degrees x 1e7
+    uint32_t t_ms;              // Local millis() when the fix was taken
+} track_point_t;
+
+/**
+ * @brief Fix history ring; the oldest fix is overwritten when full
+ */
+typedef struct {
+    track_point_t pts[TRACK_RING_CAPACITY];
+    uint16_t head;              // Next write index
+    uint16_t count;
+    uint32_t overwritten;       // Fixes lost to a full ring
+} track_ring_t;
+
+// ============================================================================
+// RING
+// ============================================================================
+
+static inline void track_ring_init(track_ring_t* r) {
+    memset(r, 0, sizeof(*r));
+}
+
+/**
+ * @brief Append a fix
+ */
+static inline void track_ring_push(track_ring_t* r, int32_t lat_e7, int32_t lon_e7, uint32_t t_ms) {
+    track_point_t* p = &r->pts[r->head];
+    p->lat_e7 = lat_e7;
+    p->lon_e7 = lon_e7;
+    p->t_ms = t_ms;
+    r->head = (uint16_t)((r->head + 1) % TRACK_RING_CAPACITY);
+    if (r->count < TRACK_RING_CAPACITY) {
+        r->count++;
+    } else {
+        r->overwritten++;
+    }
+}
+
+/**
+ * @brief Copy out all fixes oldest first and empty the ring
+ * @param r Ring
+ * @param out Output (at least TRACK_RING_CAPACITY for no loss)
+ * @param cap Output capacity; the newest cap fixes are kept
+ * @return Fixes copied
+ */
+static inline size_t track_ring_drain(track_ring_t* r, track_point_t* out, size_t cap) {
+    size_t n = r->count < cap ? r->count : cap;
+    size_t start = (r->head + TRACK_RING_CAPACITY - n) % TRACK_RING_CAPACITY;
+    for (size_t i = 0; i < n; i++) {
+        out[i] = r->pts[(start + i) % TRACK_RING_CAPACITY];
+    }
+    r->count = 0;
+    return n;
+}
+
+// ============================================================================
+// SIMPLIFICATION
+// ============================================================================
+
+/**
+ * @brief Distance in metres from p to the segment a-b
+ *
+ * Projects onto a local plane at a's latitude (x east, y north).
+ */
+static inline double track_segment_distance_m(const track_point_t* a, const track_point_t* b,
+                                              const track_point_t* p) {
+    static const double M_PER_E7 = 0.0111319490793;   // 6378137 m * pi / 180 / 1e7
+    double kx = M_PER_E7 * cos(a->lat_e7 * (3.14159265358979 / 180.0 / 1e7));
+
+    double bx = (double)(b->lon_e7 - a->lon_e7) * kx;
+    double by = (double)(b->lat_e7 - a->lat_e7) * M_PER_E7;
+    double px = (double)(p->lon_e7 - a->lon_e7) * kx;
+    double py = (double)(p->lat_e7 - a->lat_e7) * M_PER_E7;
+
+    double len2 = bx * bx + by * by;
+    double t = len2 > 0 ? (px * bx + py * by) / len2 : 0;
+    if (t < 0) t = 0;
+    if (t > 1) t = 1;
+    double dx = px - t * bx;
+    double dy = py - t * by;
+    return sqrt(dx * dx + dy * dy);
+}
+
+/**
+ * @brief Reduce a track to its most significant points
+ * @param pts Fixes in time order
+ * @param count Number of fixes (at most TRACK_RING_CAPACITY)
+ * @param tolerance_m Stop once every dropped fix is within this of the path
+ * @param out Kept points in time order
+ * @param max_out Point budget (at least 2 to keep both ends)
+ * @return Points written
+ *
+ * Endpoints are always kept. Each round adds the fix farthest from the
+ * current simplified path, until that distance is within tolerance or
+ * the budget is spent.
+ */
+static inline size_t track_simplify(const track_point_t* pts, size_t count, double tolerance_m,
+                                    track_point_t* out, size_t max_out) {
+    if (count > TRACK_RING_CAPACITY) count = TRACK_RING_CAPACITY;
+    if (count == 0 || max_out == 0) return 0;
+    if (count <= 2 || max_out == 1) {
+        size_t n = count < max_out ? count : max_out;
+        // With a budget of one, the newest fix is the most useful
+        memcpy(out, pts + (count - n), n * sizeof(track_point_t));
+        return n;
+    }
+
+    bool keep[TRACK_RING_CAPACITY];
+    memset(keep, 0, sizeof(keep));
+    keep[0] = keep[count - 1] = true;
+    size_t kept = 2;
+
+    while (kept < max_out) {
+        double best = tolerance_m;
+        size_t best_i = 0;
+        size_t a = 0;
+        for (size_t b = 1; b < count; b++) {
+            if (!keep[b]) continue;
+            for (size_t i = a + 1; i < b; i++) {
+                double d = track_segment_distance_m(&pts[a], &pts[b], &pts[i]);
+                if (d > best) {
+                    best = d;
+                    best_i = i;
+                }
+            }
+            a = b;
+        }
+        if (best_i == 0) break;
+        keep[best_i] = true;
+        kept++;
+    }
+
+    size_t n = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (keep[i]) out[n++] = pts[i];
+    }
+    return n;
+}
+
+// ============================================================================
+// ENCODING
+// ============================================================================
+
+static inline size_t track_put_varint(uint8_t* out, size_t cap, size_t pos, int64_t v) {
+    uint64_t z = ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+    do {
+        if (pos >= cap) return 0;
+        uint8_t b = (uint8_t)(z & 0x7F);
+        z >>= 7;
+        out[pos++] = z ? (uint8_t)(b | 0x80) : b;
+    } while (z);
+    return pos;
+}
+
+/**
+ * @brief Pack points into a segment
+ * @param pts Points in time order
+ * @param count Number of points
+ * @param out Output buffer (TRACK_SEGMENT_MAX_BYTES fits a full segment)
+ * @param cap Output capacity
+ * @return Bytes written; points that do not fit are dropped from the end
+ */
+static inline size_t track_encode(const track_point_t* pts, size_t count, uint8_t* out, size_t cap) {
+    if (count == 0) return 0;
+
+    const track_point_t* newest = &pts[count - 1];
+    size_t len = 0;
+    for (size_t i = 0; i < count; i++) {
+        int64_t dlat, dlon, dt;
+        if (i == 0) {
+            dlat = pts[0].lat_e7;
+            dlon = pts[0].lon_e7;
+            dt = (newest->t_ms - pts[0].t_ms) / 100;
+        } else {
+            dlat = (int64_t)pts[i].lat_e7 - pts[i - 1].lat_e7;
+            dlon = (int64_t)pts[i].lon_e7 - pts[i - 1].lon_e7;
+            dt = (pts[i].t_ms - pts[i - 1].t_ms) / 100;
+        }
+
+        size_t pos = track_put_varint(out, cap, len, dlat);
+        if (pos) pos = track_put_varint(out, cap, pos, dlon);
+        if (pos) pos = track_put_varint(out, cap, pos, dt);
+        if (!pos) break;
+        len = pos;
+    }
+    return len;
+}
+
+#ifdef __cplusplus
+}
+#endif
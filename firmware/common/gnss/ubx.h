@@ -0,0 +1,398 @@
+/**
+ * @file ubx.h
+ * @brief u-blox UBX binary protocol: framing, NAV-PVT decoding, config
+ *
+ * A u-blox receiver can replace its five NMEA sentences per epoch with
+ * one 100-byte UBX-NAV-PVT frame carrying position, velocity, time and
+ * fix quality. This header frames UBX out of a mixed UBX/NMEA byte
+ * stream, decodes NAV-PVT and ACK, and builds the CFG messages that
+ * switch the output over.
+ *
+ * Features:
+ * - Zero-allocation byte-at-a-time framer with Fletcher-8 checksum
+ * - Demultiplexes: bytes outside a UBX frame are handed back so the
+ *   caller can feed them to its NMEA parser
+ * - A header whose length is beyond any expected message is taken as
+ *   corruption: the framer gives its bytes back (UBX_FEED_RESYNC) and
+ *   resyncs on the next '$' or 0xB5 0x62 instead of swallowing NMEA
+ * - Little-endian field access, safe on unaligned payloads
+ *
+ * Example:
+ *   ubx_parser_t ubx;
+ *   ubx_parser_init(&ubx);
+ *   void demux(uint8_t b) {
+ *       ubx_feed_t r = ubx_parser_feed(&ubx, b);
+ *       if (r == UBX_FEED_IDLE) nmea_feed(b);
+ *       else if (r == UBX_FEED_FRAME && ubx_is(&ubx, UBX_CLASS_NAV, UBX_NAV_PVT)) ...
+ *       else if (r == UBX_FEED_RESYNC) {
+ *           uint8_t replay[UBX_REPLAY_MAX];
+ *           size_t n = ubx_take_replay(&ubx, replay);
+ *           for (size_t i = 0; i < n; i++) demux(replay[i]);
+ *       }
+ *   }
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// CONSTANTS
+// ============================================================================
+
+#define UBX_SYNC1               0xB5
+#define UBX_SYNC2               0x62
+#define UBX_FRAME_OVERHEAD      8       // Sync, class, id, length, checksum
+#define UBX_MAX_PAYLOAD         100     // NAV-PVT is 92; a longer length is corruption
+#define UBX_REPLAY_MAX          4       // Header bytes after the sync pair
+
+#define UBX_CLASS_NAV           0x01
+#define UBX_CLASS_ACK           0x05
+#define UBX_CLASS_CFG           0x06
+#define UBX_CLASS_NMEA          0xF0    // Standard NMEA messages in CFG-MSG
+
+#define UBX_NAV_PVT             0x07
+#define UBX_ACK_NAK             0x00
+#define UBX_ACK_ACK             0x01
+#define UBX_CFG_MSG             0x01
+#define UBX_CFG_RATE            0x08
+
+#define UBX_NMEA_GGA            0x00
+#define UBX_NMEA_GSA            0x02
+#define UBX_NMEA_GSV            0x03
+#define UBX_NMEA_RMC            0x04
+#define UBX_NMEA_VTG            0x05
+
+#define UBX_NAV_PVT_LEN         92
+
+// ============================================================================
+// TYPES
+// ============================================================================
+
+/**
+ * @brief Framer state
+ */
+typedef enum {
+    UBX_STATE_SYNC1 = 0,
+    UBX_STATE_SYNC2,
+    UBX_STATE_CLASS,
+    UBX_STATE_ID,
+    UBX_STATE_LEN1,
+    UBX_STATE_LEN2,
+    UBX_STATE_PAYLOAD,
+    UBX_STATE_CK_A,
+    UBX_STATE_CK_B,
+} ubx_state_t;
+
+/**
+ * @brief Result of feeding one byte
+ */
+typedef enum {
+    UBX_FEED_IDLE = 0,          // Not UBX; pass the byte to the NMEA parser
+    UBX_FEED_BUSY,              // Consumed as part of a frame
+    UBX_FEED_FRAME,             // Frame complete: cls, id, payload, len are valid
+    UBX_FEED_RESYNC,            // Bad header dropped; feed ubx_take_replay() bytes again
+} ubx_feed_t;
+
+/**
+ * @brief Framer
+ */
+typedef struct {
+    ubx_state_t state;
+    uint8_t cls;
+    uint8_t id;
+    uint16_t len;
+    uint16_t pos;
+    uint8_t ck_a;
+    uint8_t ck_b;
+    uint8_t payload[UBX_MAX_PAYLOAD];
+    uint8_t replay[UBX_REPLAY_MAX];
+    uint8_t replay_len;
+
+    // Statistics
+    uint32_t frames;
+    uint32_t checksum_errors;
+    uint32_t bad_length;        // Headers with a length over UBX_MAX_PAYLOAD
+} ubx_parser_t;
+
+/**
+ * @brief Decoded UBX-NAV-PVT (subset)
+ */
+typedef struct {
+    uint32_t itow_ms;           // GPS time of week
+    uint16_t year;
+    uint8_t month;
+    uint8_t day;
+    uint8_t hour;
+    uint8_t minute;
+    uint8_t second;
+    int32_t nano;               // Fraction of second, may be negative
+    bool date_valid;
+    bool time_valid;
+    uint8_t fix_type;           // 0 none, 1 DR, 2 2D, 3 3D, 4 GNSS+DR, 5 time only
+    bool fix_ok;                // gnssFixOK: within DOP/accuracy masks
+    uint8_t num_sv;
+    int32_t lon_e7;             // Degrees x 1e7
+    int32_t lat_e7;
+    int32_t height_mm;          // Above ellipsoid
+    int32_t hmsl_mm;            // Above mean sea level
+    uint32_t h_acc_mm;
+    uint32_t v_acc_mm;
+    int32_t ground_speed_mms;
+    int32_t heading_e5;         // Heading of motion, degrees x 1e5
+    uint16_t pdop_e2;           // Position DOP x 100
+} ubx_nav_pvt_t;
+
+// ============================================================================
+// FRAMING
+// ============================================================================
+
+/**
+ * @brief Initialize a framer
+ */
+static inline void ubx_parser_init(ubx_parser_t* p) {
+    memset(p, 0, sizeof(*p));
+}
+
+static inline void ubx_ck_add(ubx_parser_t* p, uint8_t b) {
+    p->ck_a = (uint8_t)(p->ck_a + b);
+    p->ck_b = (uint8_t)(p->ck_b + p->ck_a);
+}
+
+/**
+ * @brief Feed one byte of a mixed UBX/NMEA stream
+ * @param p Framer
+ * @param b Received byte
+ * @return What the byte was; on UBX_FEED_FRAME the frame stays valid
+ *         until the next call
+ */
+static inline ubx_feed_t ubx_parser_feed(ubx_parser_t* p, uint8_t b) {
+    switch (p->state) {
+        case UBX_STATE_SYNC1:
+            if (b != UBX_SYNC1) return UBX_FEED_IDLE;
+            p->state = UBX_STATE_SYNC2;
+            return UBX_FEED_BUSY;
+
+        case UBX_STATE_SYNC2:
+            if (b != UBX_SYNC2) {
+                // 0xB5 never occurs in NMEA text; drop it, keep this byte
+                p->state = UBX_STATE_SYNC1;
+                return b == UBX_SYNC1 ? ubx_parser_feed(p, b) : UBX_FEED_IDLE;
+            }
+            p->ck_a = p->ck_b = 0;
+            p->state = UBX_STATE_CLASS;
+            return UBX_FEED_BUSY;
+
+        case UBX_STATE_CLASS:
+            p->cls = b;
+            ubx_ck_add(p, b);
+            p->state = UBX_STATE_ID;
+            return UBX_FEED_BUSY;
+
+        case UBX_STATE_ID:
+            p->id = b;
+            ubx_ck_add(p, b);
+            p->state = UBX_STATE_LEN1;
+            return UBX_FEED_BUSY;
+
+        case UBX_STATE_LEN1:
+            p->len = b;
+            ubx_ck_add(p, b);
+            p->state = UBX_STATE_LEN2;
+            return UBX_FEED_BUSY;
+
+        case UBX_STATE_LEN2:
+            p->len |= (uint16_t)b << 8;
+            if (p->len > UBX_MAX_PAYLOAD) {
+                // The sync pair was noise or the header is corrupt; hand
+                // back what followed it so NMEA text is not swallowed
+                p->bad_length++;
+                p->replay[0] = p->cls;
+                p->replay[1] = p->id;
+                p->replay[2] = (uint8_t)(p->len & 0xFF);
+                p->replay[3] = b;
+                p->replay_len = UBX_REPLAY_MAX;
+                p->state = UBX_STATE_SYNC1;
+                return UBX_FEED_RESYNC;
+            }
+            ubx_ck_add(p, b);
+            p->pos = 0;
+            p->state = p->len ? UBX_STATE_PAYLOAD : UBX_STATE_CK_A;
+            return UBX_FEED_BUSY;
+
+        case UBX_STATE_PAYLOAD:
+            p->payload[p->pos++] = b;
+            ubx_ck_add(p, b);
+            if (p->pos >= p->len) p->state = UBX_STATE_CK_A;
+            return UBX_FEED_BUSY;
+
+        case UBX_STATE_CK_A:
+            p->state = b == p->ck_a ? UBX_STATE_CK_B : UBX_STATE_SYNC1;
+            if (b != p->ck_a) p->checksum_errors++;
+            return UBX_FEED_BUSY;
+
+        case UBX_STATE_CK_B:
+            p->state = UBX_STATE_SYNC1;
+            if (b != p->ck_b) {
+                p->checksum_errors++;
+                return UBX_FEED_BUSY;
+            }
+            p->frames++;
+            return UBX_FEED_FRAME;
+    }
+
+    p->state = UBX_STATE_SYNC1;
+    return UBX_FEED_IDLE;
+}
+
+/**
+ * @brief Take the bytes a UBX_FEED_RESYNC gave back
+ * @param p Framer
+ * @param out At least UBX_REPLAY_MAX bytes
+ * @return Byte count; feed them through the demux again, in order,
+ *         since they may hold a '$' or a fresh sync pair
+ */
+static inline size_t ubx_take_replay(ubx_parser_t* p, uint8_t* out) {
+    size_t n = p->replay_len;
+    memcpy(out, p->replay, n);
+    p->replay_len = 0;
+    return n;
+}
+
+/**
+ * @brief Whether the completed frame is cls/id
+ */
+static inline bool ubx_is(const ubx_parser_t* p, uint8_t cls, uint8_t id) {
+    return p->cls == cls && p->id == id;
+}
+
+/**
+ * @brief Build a frame
+ * @param out Output buffer
+ * @param cap Output capacity
+ * @return Frame length, or 0 if it does not fit
+ */
+static inline size_t ubx_build(uint8_t* out, size_t cap, uint8_t cls, uint8_t id,
+                               const uint8_t* payload, uint16_t len) {
+    size_t total = (size_t)len + UBX_FRAME_OVERHEAD;
+    if (total > cap) return 0;
+
+    out[0] = UBX_SYNC1;
+    out[1] = UBX_SYNC2;
+    out[2] = cls;
+    out[3] = id;
+    out[4] = (uint8_t)(len & 0xFF);
+    out[5] = (uint8_t)(len >> 8);
+    if (len) memcpy(out + 6, payload, len);
+
+    uint8_t a = 0, b = 0;
+    for (size_t i = 2; i < total - 2; i++) {
+        a = (uint8_t)(a + out[i]);
+        b = (uint8_t)(b + a);
+    }
+    out[total - 2] = a;
+    out[total - 1] = b;
+    return total;
+}
+
+// ============================================================================
+// CONFIGURATION MESSAGES
+// ============================================================================
+
+/**
+ * @brief CFG-MSG: output rate of one message on the current port
+ * @param rate Messages per navigation epoch (0 = off)
+ * @return Frame length
+ */
+static inline size_t ubx_cfg_msg(uint8_t* out, size_t cap, uint8_t msg_cls, uint8_t msg_id,
+                                 uint8_t rate) {
+    uint8_t payload[3] = { msg_cls, msg_id, rate };
+    return ubx_build(out, cap, UBX_CLASS_CFG, UBX_CFG_MSG, payload, sizeof(payload));
+}
+
+/**
+ * @brief CFG-RATE: measurement period, one solution per measurement
+ * @param meas_ms Measurement period (100 = 10 Hz)
+ * @return Frame length
+ */
+static inline size_t ubx_cfg_rate(uint8_t* out, size_t cap, uint16_t meas_ms) {
+    uint8_t payload[6] = {
+        (uint8_t)(meas_ms & 0xFF), (uint8_t)(meas_ms >> 8),
+        1, 0,       // navRate: every measurement
+        1, 0,       // timeRef: GPS time
+    };
+    return ubx_build(out, cap, UBX_CLASS_CFG, UBX_CFG_RATE, payload, sizeof(payload));
+}
+
+// ============================================================================
+// DECODING
+// ============================================================================
+
+static inline uint16_t ubx_u16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t ubx_u32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline int32_t ubx_i32(const uint8_t* p) {
+    return (int32_t)ubx_u32(p);
+}
+
+/**
+ * @brief Decode a NAV-PVT payload
+ * @return false if the payload is too short
+ */
+static inline bool ubx_decode_nav_pvt(const uint8_t* payload, uint16_t len, ubx_nav_pvt_t* out) {
+    if (len < UBX_NAV_PVT_LEN) return false;
+
+    out->itow_ms = ubx_u32(payload + 0);
+    out->year = ubx_u16(payload + 4);
+    out->month = payload[6];
+    out->day = payload[7];
+    out->hour = payload[8];
+    out->minute = payload[9];
+    out->second = payload[10];
+    out->date_valid = (payload[11] & 0x01) != 0;
+    out->time_valid = (payload[11] & 0x02) != 0;
+    out->nano = ubx_i32(payload + 16);
+    out->fix_type = payload[20];
+    out->fix_ok = (payload[21] & 0x01) != 0;
+    out->num_sv = payload[23];
+    out->lon_e7 = ubx_i32(payload + 24);
+    out->lat_e7 = ubx_i32(payload + 28);
+    out->height_mm = ubx_i32(payload + 32);
+    out->hmsl_mm = ubx_i32(payload + 36);
+    out->h_acc_mm = ubx_u32(payload + 40);
+    out->v_acc_mm = ubx_u32(payload + 44);
+    out->ground_speed_mms = ubx_i32(payload + 60);
+    out->heading_e5 = ubx_i32(payload + 64);
+    out->pdop_e2 = ubx_u16(payload + 76);
+    return true;
+}
+
+/**
+ * @brief Whether a completed frame ACKs or NAKs cls/id
+ * @param p Framer holding a complete ACK-ACK or ACK-NAK frame
+ * @param ack Set to true for ACK, false for NAK
+ * @return true if the frame answers cls/id
+ */
+static inline bool ubx_ack_for(const ubx_parser_t* p, uint8_t cls, uint8_t id, bool* ack) {
+    if (p->cls != UBX_CLASS_ACK || p->len < 2) return false;
+    if (p->id != UBX_ACK_ACK && p->id != UBX_ACK_NAK) return false;
+    if (p->payload[0] != cls || p->payload[1] != id) return false;
+    *ack = p->id == UBX_ACK_ACK;
+    return true;
+}
+
+#ifdef __cplusplus
+}
+#endif
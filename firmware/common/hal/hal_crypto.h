@@ -26,6 +26,9 @@ extern "C" {
 #define HAL_ED25519_SIGNATURE_SIZE  64
 #define HAL_SHA256_HASH_SIZE        32
 #define HAL_SHA256_BLOCK_SIZE       64
+#define HAL_AES256_KEY_SIZE         32
+#define HAL_GCM_IV_SIZE             12
+#define HAL_GCM_TAG_SIZE            16
 
 // ============================================================================
 // ED25519 SIGNATURES
@@ -137,6 +140,91 @@ int hal_sha256_final(hal_sha256_ctx_t* ctx, uint8_t hash[HAL_SHA256_HASH_SIZE]);
 int hal_sha256_domain(const char* domain, const uint8_t* data, size_t len,
                       uint8_t hash[HAL_SHA256_HASH_SIZE]);
 
+// ============================================================================
+// AES-256-GCM
+// ============================================================================
+
+/**
+ * @brief Encrypt and authenticate with AES-256-GCM
+ * @param key Key (32 bytes)
+ * @param iv Nonce (12 bytes, never reused with the same key)
+ * @param aad Additional authenticated data (may be NULL)
+ * @param aad_len AAD length
+ * @param in Plaintext
+ * @param len Plaintext length
+ * @param out Output ciphertext (len bytes, must not alias in)
+ * @param tag Output authentication tag (16 bytes)
+ * @return 0 on success, negative on error
+ */
+int hal_aes256_gcm_encrypt(const uint8_t key[HAL_AES256_KEY_SIZE],
+                           const uint8_t iv[HAL_GCM_IV_SIZE],
+                           const uint8_t* aad, size_t aad_len,
+                           const uint8_t* in, size_t len, uint8_t* out,
+                           uint8_t tag[HAL_GCM_TAG_SIZE]);
+
+/**
+ * @brief Decrypt and verify AES-256-GCM
+ *
+ * On tag mismatch the output is zeroed and an error returned.
+ *
+ * @return 0 on success, negative on error or authentication failure
+ */
+int hal_aes256_gcm_decrypt(const uint8_t key[HAL_AES256_KEY_SIZE],
+                           const uint8_t iv[HAL_GCM_IV_SIZE],
+                           const uint8_t* aad, size_t aad_len,
+                           const uint8_t* in, size_t len, uint8_t* out,
+                           const uint8_t tag[HAL_GCM_TAG_SIZE]);
+
+// ============================================================================
+// BACKEND SELECTION
+// ============================================================================
+
+/**
+ * @brief Crypto backend implementing SHA-256 and AES-GCM
+ */
+typedef enum {
+    HAL_CRYPTO_BACKEND_SOFTWARE = 0,    /**< Portable CPU implementation */
+    HAL_CRYPTO_BACKEND_HARDWARE = 1,    /**< Platform accelerator (e.g. ESP32-S3 SHA/AES) */
+    HAL_CRYPTO_BACKEND_COUNT
+} hal_crypto_backend_t;
+
+/**
+ * @brief Boot microbenchmark results
+ */
+typedef struct {
+    bool ran;
+    uint32_t bench_bytes;                               /**< Message size per operation */
+    uint32_t rounds;                                    /**< Operations timed per backend */
+    uint32_t sha256_us[HAL_CRYPTO_BACKEND_COUNT];       /**< Total time, all rounds */
+    uint32_t gcm_us[HAL_CRYPTO_BACKEND_COUNT];
+    bool sha256_ok[HAL_CRYPTO_BACKEND_COUNT];           /**< Passed known-answer test */
+    bool gcm_agree;                                     /**< Backends produced identical output */
+    hal_crypto_backend_t sha256_backend;                /**< Selected for SHA-256 */
+    hal_crypto_backend_t gcm_backend;                   /**< Selected for AES-GCM */
+} hal_crypto_bench_t;
+
+/**
+ * @brief Benchmark available backends and select the fastest per primitive
+ *
+ * A backend that fails its known-answer or cross-check is never selected.
+ * All backends produce identical output, so selection only affects speed.
+ * Call once at boot, before other tasks hash.
+ *
+ * @param result Output benchmark results (may be NULL)
+ * @return 0 on success, negative on error
+ */
+int hal_crypto_select_backend(hal_crypto_bench_t* result);
+
+/**
+ * @brief Get the backend currently used for SHA-256
+ */
+hal_crypto_backend_t hal_crypto_sha256_backend(void);
+
+/**
+ * @brief Get the backend currently used for AES-GCM
+ */
+hal_crypto_backend_t hal_crypto_gcm_backend(void);
+
 // ============================================================================
 // SECURE MEMORY
 // ============================================================================
@@ -3,6 +3,16 @@
  * @brief HAL I2C Interface
  *
  * Provides a hardware-independent I2C interface.
+ *
+ * Two ways to move data:
+ * - Blocking: hal_i2c_write(), hal_i2c_read() and hal_i2c_write_read().
+ *   The calling task waits for the bus, which at 100-400 kHz is about
+ *   25-100 us per byte.
+ * - Queued: attach a device with hal_i2c_add_device(), then submit jobs
+ *   with hal_i2c_submit(). A job is a batch of operations run back to
+ *   back for one device (e.g. a command write, then a status and payload
+ *   read) with one completion. On ESP-IDF this maps onto the i2c_master
+ *   driver's asynchronous mode (trans_queue_depth plus on_trans_done).
  */
 
 #pragma once
@@ -107,6 +117,122 @@ bool hal_i2c_probe(i2c_bus_t bus, uint8_t addr);
  */
 int hal_i2c_scan(i2c_bus_t bus, uint8_t* addrs, size_t max_addrs);
 
+// ============================================================================
+// QUEUED TRANSACTIONS
+// ============================================================================
+
+typedef int hal_i2c_device_t;
+
+/**
+ * @brief Per-device settings for queued jobs
+ *
+ * queue_depth bounds the jobs in flight for the device; submitting past
+ * it blocks up to the hal_i2c_submit() timeout.
+ */
+typedef struct {
+    uint8_t addr;                   // 7-bit device address
+    uint32_t freq_hz;               // 0: the bus frequency
+    uint8_t queue_depth;            // Jobs in flight, at least 1
+} hal_i2c_device_config_t;
+
+#define HAL_I2C_DEVICE_CONFIG_DEFAULT { \
+    .addr = 0, \
+    .freq_hz = 0, \
+    .queue_depth = 4, \
+}
+
+typedef enum {
+    HAL_I2C_OP_WRITE = 0,
+    HAL_I2C_OP_READ,
+    HAL_I2C_OP_WRITE_READ,          // Repeated start between the phases
+} hal_i2c_op_type_t;
+
+/**
+ * @brief One operation of a job
+ */
+typedef struct {
+    hal_i2c_op_type_t type;
+    const uint8_t* write_data;      // WRITE, WRITE_READ
+    size_t write_len;
+    uint8_t* read_data;             // READ, WRITE_READ
+    size_t read_len;
+    uint32_t delay_us;              // Bus idle before this op (device turnaround)
+    int result;                     // Set when run: bytes moved or negative
+} hal_i2c_op_t;
+
+typedef struct hal_i2c_job hal_i2c_job_t;
+
+/**
+ * @brief Completion callback, called from the driver's ISR or task context
+ *
+ * Keep it short: set a flag, give a semaphore or notify a task.
+ */
+typedef void (*hal_i2c_done_cb_t)(hal_i2c_job_t* job, void* user_data);
+
+/**
+ * @brief A batch of operations for one device
+ *
+ * Operations run in order with no other device's traffic between them.
+ * The first failing operation ends the job; later ones keep result 0.
+ * The job and all op buffers are owned by the caller and must stay valid
+ * until it completes.
+ */
+struct hal_i2c_job {
+    hal_i2c_op_t* ops;
+    size_t op_count;
+    uint32_t timeout_ms;            // Whole job, from when it reaches the bus
+    hal_i2c_done_cb_t on_done;      // NULL: collect with hal_i2c_wait()
+    void* user_data;
+    size_t ops_done;                // Set on completion
+    int result;                     // 0 if every op succeeded, else its error
+};
+
+/**
+ * @brief Attach a device for queued jobs
+ * @param bus I2C bus number (initialized with hal_i2c_init)
+ * @param config Device configuration
+ * @param device Receives the device handle
+ * @return 0 on success, negative on error
+ */
+int hal_i2c_add_device(i2c_bus_t bus, const hal_i2c_device_config_t* config,
+                       hal_i2c_device_t* device);
+
+/**
+ * @brief Detach a device; fails while jobs are in flight
+ * @param device Device handle
+ * @return 0 on success, negative on error
+ */
+int hal_i2c_remove_device(hal_i2c_device_t device);
+
+/**
+ * @brief Queue a job; returns once it is queued, not when done
+ *
+ * Jobs on one device run in submission order. Jobs for different devices
+ * on the bus interleave at job boundaries.
+ *
+ * @param device Device handle
+ * @param job Job (ops_done and result are set when it completes)
+ * @param timeout_ms Time to wait for a free queue slot, 0 to fail at once
+ * @return 0 on success, negative on error (queue full after timeout)
+ */
+int hal_i2c_submit(hal_i2c_device_t device, hal_i2c_job_t* job, uint32_t timeout_ms);
+
+/**
+ * @brief Collect the oldest completed job without a callback
+ * @param device Device handle
+ * @param job Receives the completed job
+ * @param timeout_ms Time to wait for one to complete
+ * @return 0 on success, negative on error (nothing completed in time)
+ */
+int hal_i2c_wait(hal_i2c_device_t device, hal_i2c_job_t** job, uint32_t timeout_ms);
+
+/**
+ * @brief Jobs queued or running on the device
+ * @param device Device handle
+ * @return Count, negative on error
+ */
+int hal_i2c_in_flight(hal_i2c_device_t device);
+
 #ifdef __cplusplus
 }
 #endif
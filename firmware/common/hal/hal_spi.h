@@ -3,6 +3,17 @@
  * @brief HAL SPI Interface
  *
  * Provides a hardware-independent SPI interface.
+ *
+ * Two ways to move data:
+ * - Blocking: hal_spi_begin() / hal_spi_transfer() / hal_spi_end() on the
+ *   bus. The calling task waits for the whole transfer.
+ * - Queued: attach a device with hal_spi_add_device(), then hand
+ *   transactions to hal_spi_queue(). They run back to back by DMA while
+ *   the caller signs records or services the network, and completion is
+ *   reported by callback (ISR context) or collected with hal_spi_wait().
+ *
+ * A device uses one mode or the other at a time; a blocking transfer on
+ * a bus with queued transactions waits for the queue to drain first.
  */
 
 #pragma once
@@ -111,6 +122,121 @@ int hal_spi_write_byte(spi_bus_t bus, uint8_t data);
  */
 int hal_spi_set_freq(spi_bus_t bus, uint32_t freq_hz);
 
+// ============================================================================
+// ASYNC (DMA) TRANSACTIONS
+// ============================================================================
+
+typedef int hal_spi_device_t;
+
+/**
+ * @brief Per-device settings for queued transactions
+ *
+ * queue_depth bounds the transactions in flight for the device; queuing
+ * past it blocks up to the hal_spi_queue() timeout.
+ */
+typedef struct {
+    int cs_pin;                     // Driven by the driver around each transaction
+    uint32_t freq_hz;
+    spi_mode_t mode;
+    uint8_t queue_depth;            // In-flight transactions, at least 1
+} hal_spi_device_config_t;
+
+#define HAL_SPI_DEVICE_CONFIG_DEFAULT { \
+    .cs_pin = -1, \
+    .freq_hz = 10000000, \
+    .mode = SPI_MODE_0, \
+    .queue_depth = 4, \
+}
+
+// Keep CS asserted after this transaction (command then data phase)
+#define HAL_SPI_TRANS_KEEP_CS       (1u << 0)
+
+typedef struct hal_spi_trans hal_spi_trans_t;
+
+/**
+ * @brief Completion callback, called from ISR context
+ *
+ * Keep it short: set a flag, give a semaphore or notify a task.
+ */
+typedef void (*hal_spi_done_cb_t)(hal_spi_trans_t* trans, void* user_data);
+
+/**
+ * @brief One queued transaction
+ *
+ * Owned by the caller and must stay valid, with its buffers, until it
+ * completes. Buffers must come from hal_spi_dma_alloc(): other memory
+ * (flash, PSRAM on most parts, unaligned stack) is bounced through an
+ * internal copy, which costs the time DMA was meant to save.
+ */
+struct hal_spi_trans {
+    const uint8_t* tx_data;         // NULL for read-only
+    uint8_t* rx_data;               // NULL for write-only
+    size_t len;                     // Bytes; multiple of 4 when rx_data is set
+    uint32_t flags;                 // HAL_SPI_TRANS_*
+    hal_spi_done_cb_t on_done;      // NULL: collect with hal_spi_wait()
+    void* user_data;
+    int result;                     // Set on completion: bytes moved or negative
+};
+
+/**
+ * @brief Attach a device for queued transactions
+ * @param bus SPI bus number (initialized with hal_spi_init)
+ * @param config Device configuration
+ * @param device Receives the device handle
+ * @return 0 on success, negative on error
+ */
+int hal_spi_add_device(spi_bus_t bus, const hal_spi_device_config_t* config,
+                       hal_spi_device_t* device);
+
+/**
+ * @brief Detach a device; fails while transactions are in flight
+ * @param device Device handle
+ * @return 0 on success, negative on error
+ */
+int hal_spi_remove_device(hal_spi_device_t device);
+
+/**
+ * @brief Allocate a DMA-capable buffer (internal RAM, 4-byte aligned)
+ * @param len Buffer size in bytes, rounded up to a multiple of 4
+ * @return Buffer, or NULL if no DMA-capable memory is left
+ */
+void* hal_spi_dma_alloc(size_t len);
+
+/**
+ * @brief Free a buffer from hal_spi_dma_alloc
+ * @param buf Buffer (NULL is ignored)
+ */
+void hal_spi_dma_free(void* buf);
+
+/**
+ * @brief Queue a transaction; returns once it is queued, not when done
+ *
+ * Transactions on one device run in queue order. Those on different
+ * devices of the same bus interleave at transaction boundaries.
+ *
+ * @param device Device handle
+ * @param trans Transaction (result is set when it completes)
+ * @param timeout_ms Time to wait for a free queue slot, 0 to fail at once
+ * @return 0 on success, negative on error (queue full after timeout)
+ */
+int hal_spi_queue(hal_spi_device_t device, hal_spi_trans_t* trans, uint32_t timeout_ms);
+
+/**
+ * @brief Collect the oldest completed transaction without a callback
+ * @param device Device handle
+ * @param trans Receives the completed transaction
+ * @param timeout_ms Time to wait for one to complete
+ * @return 0 on success, negative on error (nothing completed in time)
+ */
+int hal_spi_wait(hal_spi_device_t device, hal_spi_trans_t** trans, uint32_t timeout_ms);
+
+/**
+ * @brief Transactions queued or running on the device
+ * @param device Device handle
+ * @return Count, negative on error
+ */
+int hal_spi_in_flight(hal_spi_device_t device);
+
 #ifdef __cplusplus
 }
 #endif
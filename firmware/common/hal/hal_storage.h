@@ -23,11 +23,11 @@ typedef void* nvs_handle_t;
 
 /**
  * @brief Open NVS namespace
- * @param namespace Namespace name (max 15 chars)
+ * @param name_space Namespace name (max 15 chars)
  * @param handle Output handle
  * @return 0 on success, negative on error
  */
-int hal_nvs_open(const char* namespace, nvs_handle_t* handle);
+int hal_nvs_open(const char* name_space, nvs_handle_t* handle);
 
 /**
  * @brief Close NVS namespace
@@ -111,16 +111,68 @@ int hal_nvs_commit(nvs_handle_t handle);
 // SD CARD INTERFACE
 // ============================================================================
 
+/**
+ * @brief Host interface for the card
+ *
+ * SDMMC moves 1 or 4 bits per clock at up to 40 MHz, against SPI's one
+ * bit at the few MHz most SPI wiring tolerates. hal_sd_mount() with
+ * HAL_SD_BUS_SDMMC falls back to SPI on the spi pins if the card does not
+ * come up; the reverse is not possible once a card is in SPI mode.
+ */
+typedef enum {
+    HAL_SD_BUS_SPI = 0,
+    HAL_SD_BUS_SDMMC,
+} hal_sd_bus_t;
+
 typedef struct {
     int cs_pin;
     int sck_pin;
     int miso_pin;
     int mosi_pin;
     uint32_t freq_hz;
+
+    // SDMMC host (ignored for HAL_SD_BUS_SPI). Boards list these as
+    // SD_MMC_PIN_* in boards/<board-id>/pins/pins.h.
+    hal_sd_bus_t bus;
+    int clk_pin;
+    int cmd_pin;
+    int d0_pin;
+    int d1_pin;                     // -1 in 1-bit mode
+    int d2_pin;                     // -1 in 1-bit mode
+    int d3_pin;                     // Driven high in 1-bit mode (low selects SPI)
+    uint8_t bus_width;              // 1 or 4
+    uint32_t sdmmc_freq_khz;        // 20000 default speed, 40000 high speed
 } sd_config_t;
 
+/**
+ * @brief When a write must reach the card
+ */
+typedef enum {
+    HAL_SD_DURABLE_BATCHED = 0,     // Held in the write-back buffer
+    HAL_SD_DURABLE_NOW,             // Written and synced before returning
+} hal_sd_durability_t;
+
+#define HAL_SD_SECTOR_SIZE          512
+#define HAL_SD_WRITE_BUFFER_SIZE    4096    // Write-back unit per open file
+
+/**
+ * @brief Write accounting since mount
+ *
+ * write_amp_x100 = bytes_written * 100 / bytes_requested. It counts every
+ * sector a write touches, so small appends that each rewrite a partial
+ * sector show up as amplification.
+ */
+typedef struct {
+    uint64_t bytes_requested;       // Bytes passed to hal_sd_fwrite()
+    uint64_t bytes_written;         // Whole sectors sent to the card
+    uint32_t syncs;                 // Buffer writes followed by a FAT commit
+    uint16_t write_amp_x100;
+} sd_write_stats_t;
+
 typedef struct {
     bool mounted;
+    hal_sd_bus_t bus;               // Interface actually mounted
+    uint8_t bus_width;
     uint64_t total_bytes;
     uint64_t used_bytes;
     uint64_t free_bytes;
@@ -129,6 +181,9 @@ typedef struct {
 
 /**
  * @brief Mount SD card
+ *
+ * The file API below is the same on either bus.
+ *
  * @param config SD card configuration
  * @return 0 on success, negative on error
  */
@@ -179,6 +234,12 @@ int hal_sd_fread(void* file, void* buf, size_t size);
 
 /**
  * @brief Write to file
+ *
+ * Appends go through a HAL_SD_WRITE_BUFFER_SIZE write-back buffer. It
+ * reaches the card as one aligned write when full, and partially on
+ * hal_sd_fflush(). Same as hal_sd_fwrite_durable() with
+ * HAL_SD_DURABLE_BATCHED.
+ *
  * @param file File handle
  * @param buf Data to write
  * @param size Number of bytes to write
@@ -187,12 +248,33 @@ int hal_sd_fread(void* file, void* buf, size_t size);
 int hal_sd_fwrite(void* file, const void* buf, size_t size);
 
 /**
- * @brief Flush file buffers
+ * @brief Write to file with an explicit durability class
+ * @param file File handle
+ * @param buf Data to write
+ * @param size Number of bytes to write
+ * @param durability HAL_SD_DURABLE_NOW to write and sync before returning
+ * @return Number of bytes written, negative on error
+ */
+int hal_sd_fwrite_durable(void* file, const void* buf, size_t size, hal_sd_durability_t durability);
+
+/**
+ * @brief Write buffered data and commit it to the card
+ *
+ * A partial buffer is written from the start of the sector holding the
+ * first unwritten byte.
+ *
  * @param file File handle
  * @return 0 on success, negative on error
  */
 int hal_sd_fflush(void* file);
 
+/**
+ * @brief Get write accounting since mount
+ * @param stats Output statistics
+ * @return 0 on success, negative on error
+ */
+int hal_sd_write_stats(sd_write_stats_t* stats);
+
 /**
  * @brief Seek to position in file
  * @param file File handle
@@ -21,6 +21,7 @@
 
 #include "../core/types.h"
 #include "../core/log.h"
+#include "health_log_format.h"
 #include <stdint.h>
 #include <stdbool.h>
 
@@ -104,6 +105,10 @@ typedef struct {
     health_log_level_t min_serial_level; // Minimum level to print
     uint16_t max_entries;                // Maximum entries to keep
     bool persist_to_sd;                  // Save to SD card
+    uint8_t batch_sectors;               // RAM batch before an SD append
+    uint32_t flush_interval_ms;          // Max age of a buffered entry
+    health_log_level_t flush_level;      // Write through at or above this
+    uint16_t recover_entries;            // Tail reloaded by health_log_init()
 } health_log_config_t;
 
 #define HEALTH_LOG_CONFIG_DEFAULT { \
@@ -111,8 +116,29 @@ typedef struct {
     .min_serial_level = HEALTH_LOG_DEBUG, \
     .max_entries = 256, \
     .persist_to_sd = true, \
+    .batch_sectors = 8, \
+    .flush_interval_ms = 5000, \
+    .flush_level = HEALTH_LOG_CRITICAL, \
+    .recover_entries = 32, \
 }
 
+// ============================================================================
+// SD PERSISTENCE FORMAT
+// ============================================================================
+
+/**
+ * @brief Persistent health log layout
+ *
+ * With persist_to_sd, entries collect in a RAM batch of batch_sectors
+ * sectors and are appended to HEALTH_LOG_STORE_FILE as whole sectors when
+ * the batch fills, when its oldest entry is flush_interval_ms old, or at
+ * once for flush_level and above. Sectors are only ever appended, so a
+ * crash can tear at most the batch being written; health_log_init() skips
+ * sectors that fail validation and reloads the last recover_entries
+ * entries. The sector layout is health_log_sector_t (health_log_format.h).
+ */
+#define HEALTH_LOG_STORE_FILE       "/logs/health.hls"
+
 // ============================================================================
 // INITIALIZATION
 // ============================================================================
@@ -201,8 +227,44 @@ size_t health_log_get(
     uint32_t offset
 );
 
+/**
+ * @brief Filter for indexed queries
+ *
+ * Implementations keep a bitmap of buffer slots per level, per category
+ * and for unacknowledged entries, updated on insert and acknowledge. A
+ * query combines whole words of those bitmaps, so its cost is the number
+ * of matches plus one word per 32 entries, never a full buffer scan.
+ */
+typedef struct {
+    health_log_level_t min_level;   // Entries at or above this level
+    uint32_t categories;            // Bit per health_log_category_t; 0 = any
+    bool unacked_only;              // Only HEALTH_ACK_UNREAD entries
+} health_log_filter_t;
+
+/**
+ * @brief Get matching entries after a sequence number, oldest first
+ *
+ * Pages like /api/logs?since=: pass the last returned sequence back as
+ * since_sequence to continue.
+ *
+ * @param filter Filter (NULL matches everything)
+ * @param since_sequence Return entries with a greater sequence (0 = all)
+ * @param entries Output array
+ * @param max_entries Maximum to return
+ * @return Number of entries returned
+ */
+size_t health_log_query(
+    const health_log_filter_t* filter,
+    uint32_t since_sequence,
+    health_log_entry_t* entries,
+    size_t max_entries
+);
+
 /**
  * @brief Get entries by category
+ *
+ * Shorthand for health_log_query() with one category; uses the index.
+ *
  * @param category Category to filter
  * @param entries Output array
  * @param max_entries Maximum to return
@@ -216,6 +278,9 @@ size_t health_log_get_by_category(
 
 /**
  * @brief Get entries by minimum level
+ *
+ * Shorthand for health_log_query() with min_level; uses the index.
+ *
  * @param min_level Minimum level
  * @param entries Output array
  * @param max_entries Maximum to return
@@ -261,6 +326,21 @@ result_t health_log_acknowledge_level(health_log_level_t max_level);
  */
 void health_log_clear(void);
 
+/**
+ * @brief Write the RAM batch to SD now
+ *
+ * Call before a deliberate restart; nothing buffered survives a reset.
+ *
+ * @return RESULT_OK on success (or nothing to write)
+ */
+result_t health_log_flush(void);
+
+/**
+ * @brief Flush the RAM batch once it is flush_interval_ms old
+ * @param now_ms Current time
+ */
+void health_log_poll(uint32_t now_ms);
+
 /**
  * @brief Export logs to file
  * @param path Output file path
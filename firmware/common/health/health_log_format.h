@@ -0,0 +1,62 @@
+/**
+ * @file health_log_format.h
+ * @brief On-card sector format of the persistent health log
+ *
+ * The one definition of a persisted health log sector, shared by every
+ * writer (the canary's StorageManager, health_log.h implementations) and
+ * every reader or decoder. Do not redeclare it elsewhere.
+ *
+ * A log file is a run of HEALTH_LOG_SECTOR_SIZE sectors, only ever
+ * appended. Each holds up to HEALTH_LOG_SECTOR_RECORDS entries and ends in
+ * a CRC32 over everything before it. A reader accepts a sector only if
+ * magic, version, count and CRC all check out, and skips it otherwise, so
+ * a torn write or a sector from another layout version is dropped rather
+ * than misread. A layout change bumps HEALTH_LOG_SECTOR_VERSION.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#define HEALTH_LOG_SECTOR_MAGIC     0x484C5332  // "HLS2"
+#define HEALTH_LOG_SECTOR_VERSION   1
+#define HEALTH_LOG_SECTOR_SIZE      512
+#define HEALTH_LOG_SECTOR_RECORDS   3
+#define HEALTH_LOG_RECORD_TEXT      152
+
+/**
+ * @brief One persisted entry
+ *
+ * text holds message then detail, not NUL-terminated; writers cut the
+ * detail first when both do not fit in HEALTH_LOG_RECORD_TEXT bytes.
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t seq;
+    uint32_t timestamp_ms;      // millis() of the boot that logged it
+    uint8_t level;
+    uint8_t category;
+    uint8_t msg_len;
+    uint8_t detail_len;
+    char text[HEALTH_LOG_RECORD_TEXT];
+} health_log_record_t;
+
+/**
+ * @brief Unit of every persistent write
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t magic;             // HEALTH_LOG_SECTOR_MAGIC
+    uint32_t first_seq;
+    uint8_t count;              // Records used (1..HEALTH_LOG_SECTOR_RECORDS)
+    uint8_t version;            // HEALTH_LOG_SECTOR_VERSION
+    uint8_t reserved[6];
+    health_log_record_t records[HEALTH_LOG_SECTOR_RECORDS];
+    uint32_t crc;               // CRC32 over all preceding bytes
+} health_log_sector_t;
+
+#ifdef __cplusplus
+static_assert(sizeof(health_log_sector_t) == HEALTH_LOG_SECTOR_SIZE,
+              "health log sector must fill one SD sector");
+#else
+_Static_assert(sizeof(health_log_sector_t) == HEALTH_LOG_SECTOR_SIZE,
+               "health log sector must fill one SD sector");
+#endif
@@ -195,10 +195,52 @@ result_t sd_storage_remount(void);
 
 /**
  * @brief Witness storage paths
+ *
+ * Records live in append-only segment files, one per
+ * WITNESS_SEGMENT_RECORDS sequence numbers, named by segment number
+ * (seq / WITNESS_SEGMENT_RECORDS) in 8-digit hex. Each segment has a
+ * sparse index beside it holding the offset of the first record in
+ * every WITNESS_INDEX_STRIDE sequence numbers, so a lookup by sequence
+ * is one index probe plus at most one stride of header hops.
  */
 #define WITNESS_DIR             "/witness"
-#define WITNESS_RECORDS_FILE    "/witness/records.bin"
-#define WITNESS_INDEX_FILE      "/witness/index.bin"
+#define WITNESS_SEGMENT_EXT     ".wit"
+#define WITNESS_INDEX_EXT       ".idx"
+#define WITNESS_SEGMENT_RECORDS 4096
+#define WITNESS_INDEX_STRIDE    64
+
+#define WITNESS_LOG_MAGIC       0x57495431  // "WIT1"
+#define WITNESS_LOG_FLAG_BATCHED 0x01       // Signature covers a Merkle batch root
+
+/**
+ * @brief On-disk witness record header
+ *
+ * Fixed size, little-endian, followed by payload_len bytes of payload.
+ * crc is CRC32 over the header (with crc = 0) and the payload; a record
+ * that fails the check marks the end of valid data in its segment.
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint32_t sequence;
+    uint32_t time_bucket;
+    uint8_t record_type;
+    uint8_t flags;
+    uint16_t payload_len;
+    uint8_t batch_size;
+    uint8_t leaf_index;
+    uint16_t reserved;
+    uint8_t chain_hash[32];
+    uint8_t signature[64];
+    uint32_t crc;
+} witness_log_header_t;
+
+/**
+ * @brief Sparse index entry (appended for the first record of a stride)
+ */
+typedef struct {
+    uint32_t sequence;
+    uint32_t offset;
+} witness_index_entry_t;
 
 /**
  * @brief Initialize witness storage
@@ -230,14 +272,21 @@ uint32_t witness_storage_count(void);
 
 /**
  * @brief Read witness record by sequence number
+ *
+ * Constant-time: the segment and index slot are derived from the
+ * sequence number directly.
+ *
  * @param sequence Sequence number
  * @param record Output record
- * @return RESULT_OK on success
+ * @return RESULT_OK on success, RESULT_NOT_FOUND if not stored
  */
 result_t witness_storage_read(uint32_t sequence, witness_record_t* record);
 
 /**
  * @brief Export witness records to file
+ *
+ * Seeks to start_seq through the index, then streams sequentially.
+ *
  * @param start_seq Starting sequence number
  * @param end_seq Ending sequence number (0 = to end)
  * @param output_path Output file path
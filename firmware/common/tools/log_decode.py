@@ -0,0 +1,230 @@
+#!/usr/bin/env python3
+"""
+SecuraCV — Deferred Log Decoder
+
+Renders the binary frames written by common/core/log_defer.h. The device
+sends only the address of each call site's interned record (level byte
+plus format string), the tag address, a timestamp and raw argument
+bytes; this script reads the strings back out of the firmware ELF and
+formats the text on the host.
+
+Input is a capture file, stdin, or a serial port (needs pyserial). Frames
+are COBS encoded and terminated by 0x00, so decoding can start anywhere
+in a stream.
+
+The ELF must be the exact image running on the device: records are
+looked up by address.
+
+Usage:
+    python log_decode.py firmware.elf capture.bin
+    python log_decode.py firmware.elf -               (stdin)
+    python log_decode.py firmware.elf --port /dev/ttyUSB0 --baud 921600
+
+Copyright (c) 2026 ERRERlabs / Karl May
+License: Apache-2.0
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+LEVEL_NAMES = {1: "E", 2: "W", 3: "I", 4: "D", 5: "V"}
+MAX_STRING = 512
+
+# printf conversion: flags, width, precision, length, type
+CONVERSION = re.compile(r"%([-+ #0]*)(\d+|\*)?(\.\d+|\.\*)?(hh|h|ll|l|j|z|t|L)?([diouxXcfFeEgGsp%])")
+
+
+# ════════════════════════════════════════════════════════════════════════════
+# ELF IMAGE
+# ════════════════════════════════════════════════════════════════════════════
+
+class ElfImage:
+    """Allocated sections of an ELF32/ELF64 file, addressable by vaddr."""
+
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            data = f.read()
+        if data[:4] != b"\x7fELF":
+            raise ValueError(f"{path}: not an ELF file")
+        is64 = data[4] == 2
+        endian = "<" if data[5] == 1 else ">"
+        if is64:
+            shoff, = struct.unpack_from(endian + "Q", data, 0x28)
+            shentsize, shnum = struct.unpack_from(endian + "HH", data, 0x3A)
+            fmt = endian + "IIQQQQIIQQ"
+        else:
+            shoff, = struct.unpack_from(endian + "I", data, 0x20)
+            shentsize, shnum = struct.unpack_from(endian + "HH", data, 0x2E)
+            fmt = endian + "IIIIIIIIII"
+
+        SHT_PROGBITS, SHF_ALLOC = 1, 0x2
+        self.sections = []
+        for i in range(shnum):
+            fields = struct.unpack_from(fmt, data, shoff + i * shentsize)
+            sh_type, sh_flags, sh_addr, sh_offset, sh_size = fields[1:6]
+            if sh_type == SHT_PROGBITS and sh_flags & SHF_ALLOC and sh_addr:
+                self.sections.append((sh_addr, data[sh_offset:sh_offset + sh_size]))
+
+    def cstring(self, addr):
+        for base, blob in self.sections:
+            if base <= addr < base + len(blob):
+                off = addr - base
+                end = blob.find(b"\0", off, off + MAX_STRING)
+                if end < 0:
+                    end = min(len(blob), off + MAX_STRING)
+                return blob[off:end].decode("utf-8", "replace")
+        return None
+
+
+# ════════════════════════════════════════════════════════════════════════════
+# FRAMES
+# ════════════════════════════════════════════════════════════════════════════
+
+def cobs_decode(data):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data):
+            return None
+        out += data[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def render(fmt, args):
+    """Format with printf semantics, consuming encoded args in order."""
+    out = []
+    pos = 0
+    for m in CONVERSION.finditer(fmt):
+        out.append(fmt[pos:m.start()])
+        pos = m.end()
+        flags, width, prec, length, conv = m.groups()
+        if conv == "%":
+            out.append("%")
+            continue
+        if width == "*":
+            width = str(args.int32(True))
+        if prec == ".*":
+            prec = "." + str(args.int32(True))
+        spec = "%" + (flags or "") + (width or "") + (prec or "")
+
+        if conv == "s":
+            out.append((spec + "s") % args.string())
+        elif conv in "fFeEgG":
+            out.append((spec + conv) % args.float32())
+        elif conv == "p":
+            out.append("0x%08x" % args.uint32())
+        elif conv == "c":
+            out.append((spec + "c") % chr(args.uint32() & 0xFF))
+        else:
+            signed = conv in "di"
+            value = args.int64(signed) if length in ("ll", "j") else args.int32(signed)
+            out.append((spec + ("d" if conv in "diu" else conv)) % value)
+    out.append(fmt[pos:])
+    return "".join(out)
+
+
+class Args:
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def take(self, n):
+        if self.pos + n > len(self.data):
+            raise IndexError("frame truncated")
+        chunk = self.data[self.pos:self.pos + n]
+        self.pos += n
+        return chunk
+
+    def uint32(self):
+        return struct.unpack("<I", self.take(4))[0]
+
+    def int32(self, signed):
+        return struct.unpack("<i" if signed else "<I", self.take(4))[0]
+
+    def int64(self, signed):
+        return struct.unpack("<q" if signed else "<Q", self.take(8))[0]
+
+    def float32(self):
+        return struct.unpack("<f", self.take(4))[0]
+
+    def string(self):
+        n = self.take(1)[0]
+        return self.take(n).decode("utf-8", "replace")
+
+
+def decode_frame(elf, frame):
+    if len(frame) < 12:
+        return f"<short frame: {frame.hex()}>"
+    record, tag, ts = struct.unpack_from("<III", frame, 0)
+    if record == 0:
+        return f"<{tag} frames dropped>"
+
+    rec = elf.cstring(record)
+    if not rec:
+        return f"[{ts / 1000:10.3f}] <unknown record 0x{record:08x}: {frame[12:].hex()}>"
+    level = LEVEL_NAMES.get(ord(rec[0]), "?")
+    tag_text = elf.cstring(tag) or f"0x{tag:08x}"
+    try:
+        text = render(rec[1:], Args(frame[12:]))
+    except (IndexError, TypeError, ValueError) as e:
+        text = f"{rec[1:]!r} <bad args: {e}>"
+    return f"[{ts / 1000:10.3f}] {level} {tag_text}: {text}"
+
+
+def stream(source, elf):
+    buf = bytearray()
+    while True:
+        chunk = source.read(256)
+        if not chunk:
+            break
+        buf += chunk
+        while True:
+            end = buf.find(b"\0")
+            if end < 0:
+                break
+            raw = bytes(buf[:end])
+            del buf[:end + 1]
+            if not raw:
+                continue
+            frame = cobs_decode(raw)
+            print(decode_frame(elf, frame) if frame is not None else f"<bad COBS: {raw.hex()}>",
+                  flush=True)
+
+
+def main():
+    ap = argparse.ArgumentParser(description="Decode deferred-format log frames")
+    ap.add_argument("elf", help="firmware ELF the device is running")
+    ap.add_argument("input", nargs="?", default="-", help="capture file or - for stdin")
+    ap.add_argument("--port", help="read from a serial port instead")
+    ap.add_argument("--baud", type=int, default=115200)
+    args = ap.parse_args()
+
+    elf = ElfImage(args.elf)
+    if args.port:
+        import serial  # pip install pyserial
+        with serial.Serial(args.port, args.baud, timeout=1) as port:
+            class Blocking:
+                def read(self, n):
+                    while True:
+                        data = port.read(n)
+                        if data:
+                            return data
+            stream(Blocking(), elf)
+    elif args.input == "-":
+        stream(sys.stdin.buffer, elf)
+    else:
+        with open(args.input, "rb") as f:
+            stream(f, elf)
+
+
+if __name__ == "__main__":
+    try:
+        main()
+    except KeyboardInterrupt:
+        pass
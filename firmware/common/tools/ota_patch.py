@@ -0,0 +1,299 @@
+#!/usr/bin/env python3
+"""
+SecuraCV — Compressed and Delta OTA Image Builder
+
+Builds the transfer encodings that common/encoding/ota_decode.h turns back
+into a firmware image on the device:
+
+    zlib    the image as one zlib stream
+    delta   a zlib-compressed SCVD patch from a base image (the firmware
+            the device is running) to the new one
+
+The patch is COPY runs of unchanged base bytes, ADD runs where the new
+bytes differ from the base in only a few places (code that moved: mostly
+equal, some relocated pointers), and DATA for genuinely new bytes. Every
+patch is applied back to the base here and compared with the new image
+before it is written.
+
+With --manifest the encoding fields are merged into an existing manifest
+(from canary-ota's mock_ota_server.py generate); "sha256" and "size"
+always describe the decoded image, so the device's integrity check is
+unchanged.
+
+Usage:
+    python ota_patch.py zlib  new.bin -o new.bin.z
+    python ota_patch.py delta base.bin new.bin -o new.scvd --base-version 1.2.0
+    python ota_patch.py delta base.bin new.bin -o new.scvd --manifest manifest.json
+    python ota_patch.py apply base.bin new.scvd -o check.bin
+
+Copyright (c) 2026 ERRERlabs / Karl May
+License: Apache-2.0
+"""
+
+import argparse
+import hashlib
+import json
+import os
+import struct
+import sys
+import zlib
+
+MAGIC = b"SCVD"
+VERSION = 1
+
+OP_END = 0x00
+OP_COPY = 0x01
+OP_ADD = 0x02
+OP_DATA = 0x03
+
+BLOCK = 16          # Bytes hashed per base index entry
+STEP = 4            # Base index stride; images are mostly word aligned
+MIN_MATCH = 32      # Shorter exact matches cost more than they save
+
+
+# ════════════════════════════════════════════════════════════════════════════
+# ENCODING
+# ════════════════════════════════════════════════════════════════════════════
+
+def varint(n):
+    out = bytearray()
+    while True:
+        b = n & 0x7F
+        n >>= 7
+        if n:
+            out.append(b | 0x80)
+        else:
+            out.append(b)
+            return bytes(out)
+
+
+def build_index(base):
+    index = {}
+    for p in range(0, len(base) - BLOCK + 1, STEP):
+        index.setdefault(base[p:p + BLOCK], p)
+    return index
+
+
+def match_length(a, ap, b, bp):
+    limit = min(len(a) - ap, len(b) - bp)
+    n = 0
+    while n + 64 <= limit and a[ap + n:ap + n + 64] == b[bp + n:bp + n + 64]:
+        n += 64
+    while n < limit and a[ap + n] == b[bp + n]:
+        n += 1
+    return n
+
+
+class PatchWriter:
+    def __init__(self, base, target):
+        self.base = base
+        self.target = target
+        self.out = bytearray()
+        self.counts = {"copy": 0, "add": 0, "data": 0}
+
+    def copy(self, base_off, length):
+        self.out += bytes([OP_COPY]) + varint(base_off) + varint(length)
+        self.counts["copy"] += length
+
+    def gap(self, start, end, delta):
+        """New bytes [start, end): ADD against the base where they line up, else DATA."""
+        if start == end:
+            return
+        seg = self.target[start:end]
+        b = start + delta
+        if 0 <= b and b + len(seg) <= len(self.base):
+            diff = bytes((t - self.base[b + k]) & 0xFF for k, t in enumerate(seg))
+            if diff.count(0) * 2 >= len(diff):
+                self.out += bytes([OP_ADD]) + varint(b) + varint(len(diff)) + diff
+                self.counts["add"] += len(diff)
+                return
+        self.out += bytes([OP_DATA]) + varint(len(seg)) + seg
+        self.counts["data"] += len(seg)
+
+
+def make_patch(base, target):
+    """Greedy block-match diff; returns (uncompressed patch, op byte counts)."""
+    index = build_index(base)
+    w = PatchWriter(base, target)
+
+    i = 0
+    pending = 0     # Start of target bytes not yet covered by an op
+    delta = 0       # base - target offset of the last copy
+    while i + BLOCK <= len(target):
+        p = index.get(target[i:i + BLOCK])
+        n = match_length(base, p, target, i) if p is not None else 0
+        if n < MIN_MATCH:
+            i += 1
+            continue
+        while i > pending and p > 0 and base[p - 1] == target[i - 1]:
+            i -= 1
+            p -= 1
+            n += 1
+        w.gap(pending, i, delta)
+        w.copy(p, n)
+        delta = p - i
+        i += n
+        pending = i
+    w.gap(pending, len(target), delta)
+    w.out.append(OP_END)
+
+    header = MAGIC + struct.pack("<B3xII", VERSION, len(target), len(base))
+    header += hashlib.sha256(base).digest()
+    return header + bytes(w.out), w.counts
+
+
+# ════════════════════════════════════════════════════════════════════════════
+# REFERENCE DECODER
+# ════════════════════════════════════════════════════════════════════════════
+
+def read_varint(buf, pos):
+    n = shift = 0
+    while True:
+        b = buf[pos]
+        pos += 1
+        n |= (b & 0x7F) << shift
+        if not b & 0x80:
+            return n, pos
+        shift += 7
+        if shift > 28:
+            raise ValueError("varint too long")
+
+
+def apply_patch(base, encoded):
+    """Decode a delta transfer the way the device does."""
+    patch = zlib.decompress(encoded)
+    if patch[:4] != MAGIC or patch[4] != VERSION:
+        raise ValueError("not an SCVD v1 patch")
+    target_size, base_size = struct.unpack_from("<II", patch, 8)
+    if base_size > len(base) or hashlib.sha256(base[:base_size]).digest() != patch[16:48]:
+        raise ValueError("patch was made from a different base image")
+
+    out = bytearray()
+    pos = 48
+    while True:
+        op = patch[pos]
+        pos += 1
+        if op == OP_END:
+            break
+        if op in (OP_COPY, OP_ADD):
+            off, pos = read_varint(patch, pos)
+        length, pos = read_varint(patch, pos)
+        if op == OP_COPY:
+            out += base[off:off + length]
+        elif op == OP_ADD:
+            data = patch[pos:pos + length]
+            out += bytes((base[off + k] + d) & 0xFF for k, d in enumerate(data))
+            pos += length
+        elif op == OP_DATA:
+            out += patch[pos:pos + length]
+            pos += length
+        else:
+            raise ValueError(f"unknown op 0x{op:02x}")
+    if pos != len(patch) or len(out) != target_size:
+        raise ValueError("patch length or target size mismatch")
+    return bytes(out)
+
+
+# ════════════════════════════════════════════════════════════════════════════
+# COMMANDS
+# ════════════════════════════════════════════════════════════════════════════
+
+def read_file(path):
+    with open(path, "rb") as f:
+        return f.read()
+
+
+def write_output(path, data, target, fields, manifest_path):
+    with open(path, "wb") as f:
+        f.write(data)
+
+    fields = dict(fields)
+    fields["sha256"] = hashlib.sha256(target).hexdigest()
+    fields["size"] = len(target)
+    fields["transfer_size"] = len(data)
+
+    print(f"Image:    {len(target):,} bytes")
+    print(f"Transfer: {len(data):,} bytes ({100.0 * len(data) / len(target):.1f}%) -> {path}")
+
+    if manifest_path:
+        with open(manifest_path) as f:
+            manifest = json.load(f)
+        url = manifest.get("url", "")
+        manifest["url"] = url[:url.rfind("/") + 1] + os.path.basename(path)
+        manifest.update(fields)
+        with open(manifest_path, "w") as f:
+            json.dump(manifest, f, indent=2)
+        print(f"Updated {manifest_path}")
+    else:
+        print("Manifest fields:")
+        print(json.dumps(fields, indent=2))
+
+
+def cmd_zlib(args):
+    target = read_file(args.image)
+    data = zlib.compress(target, 9)
+    if zlib.decompress(data) != target:
+        sys.exit("zlib round trip failed")
+    write_output(args.output, data, target, {"encoding": "zlib"}, args.manifest)
+
+
+def cmd_delta(args):
+    base = read_file(args.base)
+    target = read_file(args.image)
+    patch, counts = make_patch(base, target)
+    data = zlib.compress(patch, 9)
+    if apply_patch(base, data) != target:
+        sys.exit("patch does not reproduce the new image")
+
+    print(f"Base:     {len(base):,} bytes")
+    print(f"Ops:      copy {counts['copy']:,}  add {counts['add']:,}  data {counts['data']:,} bytes")
+    fields = {
+        "encoding": "delta",
+        "base_size": len(base),
+        "base_sha256": hashlib.sha256(base).hexdigest(),
+    }
+    if args.base_version:
+        fields["base_version"] = args.base_version
+    write_output(args.output, data, target, fields, args.manifest)
+
+
+def cmd_apply(args):
+    try:
+        out = apply_patch(read_file(args.base), read_file(args.patch))
+    except (ValueError, IndexError, zlib.error) as e:
+        sys.exit(f"apply failed: {e}")
+    with open(args.output, "wb") as f:
+        f.write(out)
+    print(f"{len(out):,} bytes, sha256 {hashlib.sha256(out).hexdigest()} -> {args.output}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Build compressed and delta OTA images")
+    sub = parser.add_subparsers(dest="command", required=True)
+
+    p = sub.add_parser("zlib", help="Compress an image")
+    p.add_argument("image")
+    p.add_argument("-o", "--output", required=True)
+    p.add_argument("--manifest", help="Manifest JSON to update in place")
+    p.set_defaults(func=cmd_zlib)
+
+    p = sub.add_parser("delta", help="Patch from a base image to a new one")
+    p.add_argument("base", help="Image the device is running")
+    p.add_argument("image", help="New image")
+    p.add_argument("-o", "--output", required=True)
+    p.add_argument("--base-version", help="Version string of the base image")
+    p.add_argument("--manifest", help="Manifest JSON to update in place")
+    p.set_defaults(func=cmd_delta)
+
+    p = sub.add_parser("apply", help="Apply a delta transfer (for checking)")
+    p.add_argument("base")
+    p.add_argument("patch")
+    p.add_argument("-o", "--output", required=True)
+    p.set_defaults(func=cmd_apply)
+
+    args = parser.parse_args()
+    args.func(args)
+
+
+if __name__ == "__main__":
+    main()
@@ -24,6 +24,8 @@ extern "C" {
 #define HTTP_PORT_DEFAULT       80
 #define HTTP_MAX_URI_LEN        128
 #define HTTP_MAX_HANDLERS       64
+#define HTTP_MAX_PATH_PARAMS    4
+#define HTTP_MAX_QUERY_PARAMS   12
 #define HTTP_MAX_HEADER_LEN     256
 #define HTTP_CHUNK_SIZE         4096
 
@@ -57,6 +59,14 @@ typedef enum {
     CONTENT_TYPE_JPEG,
 } http_content_type_t;
 
+/**
+ * @brief Non-owning slice of the request URI (ptr is NULL when absent)
+ */
+typedef struct {
+    const char* ptr;
+    uint16_t len;
+} http_view_t;
+
 /**
  * @brief HTTP request info
  */
@@ -171,8 +181,14 @@ result_t http_server_get_status(http_server_status_t* status);
 
 /**
  * @brief Register HTTP handler
+ *
+ * Patterns are compiled into a prefix trie of path segments at
+ * registration, so dispatch walks the request path once. A {name}
+ * segment captures any one segment (e.g. "/api/logs/{seq}/ack");
+ * literal segments win over a capture at the same depth.
+ *
  * @param method HTTP method
- * @param uri URI pattern (may include wildcards)
+ * @param uri URI pattern (literal and {name} segments)
  * @param handler Handler callback
  * @param user_data User context
  * @return RESULT_OK on success
@@ -280,6 +296,36 @@ result_t http_respond_chunk_end(const http_request_t* req);
 // QUERY PARSING
 // ============================================================================
 
+/**
+ * @brief Get a {name} capture of the matched route
+ * @param req Request
+ * @param name Capture name, without braces
+ * @param value Output view into the request URI
+ * @return RESULT_OK if the route has that capture
+ */
+result_t http_get_path_param(
+    const http_request_t* req,
+    const char* name,
+    http_view_t* value
+);
+
+/**
+ * @brief Get query parameter as a view, without copying
+ *
+ * The query string is tokenized once per request, at dispatch; the view
+ * is not percent-decoded and is valid until the handler returns.
+ *
+ * @param req Request
+ * @param key Parameter key
+ * @param value Output view into the request URI
+ * @return RESULT_OK if found
+ */
+result_t http_get_query_view(
+    const http_request_t* req,
+    const char* key,
+    http_view_t* value
+);
+
 /**
  * @brief Get query parameter value
  * @param req Request
@@ -10,7 +10,8 @@
  * - Unique device identity from hardware RNG
  * - Monotonic sequence numbers (persist across reboots)
  * - Hash chain with domain separation (tamper-evident)
- * - Ed25519 signatures on every record
+ * - Ed25519 signatures on every record, or on a Merkle root per batch
+ * - Signed checkpoints, so verification starts at the latest one
  * - Time coarsening for privacy
  */
 
@@ -40,6 +41,83 @@ extern "C" {
 #define DOMAIN_PAYLOAD_HASH     "securacv:payload:v1"
 #define DOMAIN_BOOT_ATTEST      "securacv:boot:v1"
 
+#define DOMAIN_MERKLE_LEAF      "securacv:merkle:leaf:v1"
+#define DOMAIN_MERKLE_NODE      "securacv:merkle:node:v1"
+#define DOMAIN_BATCH_ROOT       "securacv:batch:v1"
+
+// Deferred-audit ring capacity (records awaiting background verification)
+#define WITNESS_AUDIT_RING_SIZE 16
+
+// Merkle batch limits (WITNESS_BATCH_MAX <= 2^WITNESS_MERKLE_DEPTH)
+#define WITNESS_BATCH_MAX       16
+#define WITNESS_MERKLE_DEPTH    4
+
+// Records between signed checkpoints (0 = none)
+#define WITNESS_CHECKPOINT_INTERVAL 256
+
+// ============================================================================
+// VERIFICATION POLICY
+// ============================================================================
+
+/**
+ * @brief When the Ed25519 check on a record is performed
+ *
+ * Chain-hash linkage and sequence checks are cheap and always run. The
+ * policy only governs the signature check. Boot attestations and tamper
+ * alerts are verified inline under every policy.
+ */
+typedef enum {
+    WITNESS_VERIFY_ALWAYS = 0,      // Check every signature inline
+    WITNESS_VERIFY_SAMPLED = 1,     // Check every Nth record inline
+    WITNESS_VERIFY_DEFERRED = 2,    // Queue for witness_chain_audit_pending()
+} witness_verify_policy_t;
+
+// ============================================================================
+// MERKLE BATCHING
+// ============================================================================
+
+/**
+ * @brief Inclusion proof for a record signed as part of a batch
+ *
+ * In batch mode every record is still hash-chained individually, but only
+ * the batch digest H(DOMAIN_BATCH_ROOT || root || first_sequence || size)
+ * is signed. The record's signature field carries that batch signature;
+ * this proof links the record's chain hash to the signed root.
+ *
+ * Leaves are H(DOMAIN_MERKLE_LEAF || chain_hash). Interior nodes are
+ * H(DOMAIN_MERKLE_NODE || left || right). An odd node at the end of a
+ * level is carried up unchanged and contributes no sibling.
+ */
+typedef struct {
+    uint32_t first_sequence;        // Sequence of leaf 0
+    uint8_t batch_size;             // Leaves in the batch
+    uint8_t leaf_index;             // This record's leaf position
+    uint8_t proof_len;              // Valid entries in siblings[]
+    uint8_t root[WITNESS_HASH_SIZE];
+    uint8_t siblings[WITNESS_MERKLE_DEPTH][WITNESS_HASH_SIZE];
+} witness_inclusion_proof_t;
+
+// ============================================================================
+// CHECKPOINTS
+// ============================================================================
+
+/**
+ * @brief Contents of a RECORD_TYPE_CHECKPOINT payload
+ *
+ * A checkpoint is an ordinary, individually signed chain record whose
+ * payload (CBOR, keys in deterministic order: seq, head, prev, boots,
+ * tampers) restates the head it extends. A verifier that has checked its
+ * signature and its link to head trusts everything before it, so boot
+ * checks and audits walk forward from the latest checkpoint only.
+ */
+typedef struct {
+    uint32_t covered_sequence;      // Last record before the checkpoint
+    uint8_t head[WITNESS_HASH_SIZE]; // Chain head at covered_sequence
+    uint32_t prev_checkpoint;       // Previous checkpoint sequence (0 = none)
+    uint32_t boot_count;
+    uint32_t tamper_count;
+} witness_checkpoint_t;
+
 // ============================================================================
 // CHAIN STATE
 // ============================================================================
@@ -56,6 +134,27 @@ typedef struct {
     uint32_t boot_count;
     bool initialized;
     char device_id[32];
+
+    // Verification policy state
+    witness_verify_policy_t verify_policy;
+    uint32_t verify_sample_n;
+    uint32_t verify_failures;       // Raised inline or by the auditor
+    uint32_t verify_skipped;        // Signature checks skipped (sampled)
+    witness_record_t audit_ring[WITNESS_AUDIT_RING_SIZE];
+    uint8_t audit_head;
+    uint8_t audit_count;
+    uint32_t audit_overruns;        // Evicted from the ring unverified
+
+    // Merkle batch state (batch_size 0 = sign every record)
+    uint8_t batch_size;
+    uint32_t batch_window_ms;
+    witness_record_t batch[WITNESS_BATCH_MAX];
+    uint8_t batch_count;
+    uint32_t batch_opened_ms;
+
+    // Checkpoints (checkpoint_interval 0 = none)
+    uint32_t checkpoint_interval;
+    uint32_t checkpoint_sequence;   // Last checkpoint record (persisted)
 } witness_chain_t;
 
 /**
@@ -66,6 +165,11 @@ typedef struct {
     uint32_t time_bucket_ms;        // Time coarsening bucket
     uint32_t persist_interval;      // Records between persists
     bool auto_persist;              // Auto-persist chain state
+    witness_verify_policy_t verify_policy;  // Signature check policy
+    uint32_t verify_sample_n;       // Sampled policy: check 1 in N
+    uint8_t batch_size;             // Records per signed root (0 = off)
+    uint32_t batch_window_ms;       // Seal a partial batch after this long
+    uint32_t checkpoint_interval;   // Records between checkpoints (0 = off)
 } witness_chain_config_t;
 
 // Default configuration
@@ -74,6 +178,11 @@ typedef struct {
     .time_bucket_ms = 5000, \
     .persist_interval = 10, \
     .auto_persist = true, \
+    .verify_policy = WITNESS_VERIFY_ALWAYS, \
+    .verify_sample_n = 8, \
+    .batch_size = 0, \
+    .batch_window_ms = 5000, \
+    .checkpoint_interval = WITNESS_CHECKPOINT_INTERVAL, \
 }
 
 // ============================================================================
@@ -118,7 +227,12 @@ bool witness_chain_is_initialized(const witness_chain_t* chain);
  * - Coarsened timestamp
  * - Domain-separated payload hash
  * - Chain hash linking to previous
- * - Ed25519 signature
+ * - Ed25519 signature (deferred to the batch seal in batch mode)
+ *
+ * In batch mode routine records are appended to the open batch and
+ * returned with a zeroed signature; they are completed by
+ * witness_chain_batch_seal(). Boot attestations and tamper alerts seal
+ * any open batch first and are then signed individually.
  *
  * @param chain Chain state
  * @param type Record type
@@ -149,17 +263,130 @@ result_t witness_chain_create_boot_attestation(
     witness_record_t* record
 );
 
+// ============================================================================
+// MERKLE BATCHING
+// ============================================================================
+
+/**
+ * @brief Seal the open batch
+ *
+ * Builds the Merkle tree over the pending chain hashes, signs the batch
+ * digest once, and emits each record with its inclusion proof.
+ *
+ * @param chain Chain state
+ * @param records Output records (signature = batch signature), WITNESS_BATCH_MAX entries
+ * @param proofs Output proofs, WITNESS_BATCH_MAX entries
+ * @param count Output: records sealed (0 if no batch was open)
+ * @return RESULT_OK on success
+ */
+result_t witness_chain_batch_seal(
+    witness_chain_t* chain,
+    witness_record_t* records,
+    witness_inclusion_proof_t* proofs,
+    size_t* count
+);
+
+/**
+ * @brief Check whether the open batch is due to be sealed
+ *
+ * @param chain Chain state
+ * @param now_ms Current time
+ * @return true if the batch is full or its window has elapsed
+ */
+static inline bool witness_chain_batch_due(const witness_chain_t* chain, uint32_t now_ms) {
+    if (chain->batch_count == 0) return false;
+    if (chain->batch_count >= chain->batch_size) return true;
+    return (now_ms - chain->batch_opened_ms) >= chain->batch_window_ms;
+}
+
+/**
+ * @brief Verify a batched record against its inclusion proof
+ *
+ * Recomputes the root from the record's chain hash and the proof's
+ * siblings, then checks the batch signature over the batch digest.
+ *
+ * @param chain Chain state (public key)
+ * @param record Record whose signature field holds the batch signature
+ * @param proof Inclusion proof emitted at seal time
+ * @return RESULT_OK if the record is included in a validly signed batch
+ */
+result_t witness_chain_verify_inclusion(
+    const witness_chain_t* chain,
+    const witness_record_t* record,
+    const witness_inclusion_proof_t* proof
+);
+
+// ============================================================================
+// CHECKPOINTS
+// ============================================================================
+
+/**
+ * @brief Write a checkpoint record now
+ *
+ * Seals any open batch, then chains and signs a RECORD_TYPE_CHECKPOINT
+ * whose payload is built under the chain lock from the current head.
+ * witness_chain_create_record() calls this itself once the chain is
+ * checkpoint_interval records past the last checkpoint.
+ *
+ * @param chain Chain state
+ * @param record Output record
+ * @return RESULT_OK on success
+ */
+result_t witness_chain_create_checkpoint(
+    witness_chain_t* chain,
+    witness_record_t* record
+);
+
+/**
+ * @brief Check whether a checkpoint is due
+ */
+static inline bool witness_chain_checkpoint_due(const witness_chain_t* chain) {
+    return chain->checkpoint_interval > 0 &&
+           chain->sequence - chain->checkpoint_sequence >= chain->checkpoint_interval;
+}
+
 // ============================================================================
 // VERIFICATION
 // ============================================================================
 
+/**
+ * @brief Check whether the policy calls for an inline signature check
+ *
+ * Attestations, tamper alerts and checkpoints always get full assurance.
+ *
+ * @param chain Chain state
+ * @param record Record about to be verified
+ * @return true if the Ed25519 check should run now
+ */
+static inline bool witness_chain_policy_verifies(const witness_chain_t* chain,
+                                                 const witness_record_t* record) {
+    if (record->type == RECORD_TYPE_BOOT_ATTESTATION ||
+        record->type == RECORD_TYPE_TAMPER_ALERT ||
+        record->type == RECORD_TYPE_CHECKPOINT) {
+        return true;
+    }
+    switch (chain->verify_policy) {
+        case WITNESS_VERIFY_SAMPLED:
+            return chain->verify_sample_n <= 1 ||
+                   (record->sequence % chain->verify_sample_n) == 0;
+        case WITNESS_VERIFY_DEFERRED:
+            return false;
+        default:
+            return true;
+    }
+}
+
 /**
  * @brief Verify a witness record
  *
  * Checks:
- * - Signature is valid
  * - Chain hash is correct
  * - Sequence number is valid
+ * - Signature is valid (subject to chain->verify_policy)
+ *
+ * When the policy skips or defers the signature check, the structural
+ * checks still run and RESULT_OK is returned; deferred records are picked
+ * up by witness_chain_audit_pending().
  *
  * @param chain Chain state
  * @param record Record to verify
@@ -175,18 +402,111 @@ result_t witness_chain_verify_record(
 /**
  * @brief Self-verify the last created record
  *
- * Verifies that the signature we just created is valid.
- * Should be called after every record creation.
+ * Verifies that the signature we just created is valid. Honors
+ * chain->verify_policy: sampled records outside the 1-in-N window are
+ * skipped, and under WITNESS_VERIFY_DEFERRED the record is copied into
+ * the audit ring instead of being checked.
  *
  * @param chain Chain state
  * @param record Record to verify
- * @return RESULT_OK if valid
+ * @return RESULT_OK if valid, skipped, or deferred
  */
 result_t witness_chain_self_verify(
-    const witness_chain_t* chain,
+    witness_chain_t* chain,
     const witness_record_t* record
 );
 
+/**
+ * @brief Set the verification policy
+ *
+ * @param chain Chain state
+ * @param policy New policy
+ * @param sample_n Sampled policy: check 1 in N (ignored otherwise)
+ */
+void witness_chain_set_verify_policy(
+    witness_chain_t* chain,
+    witness_verify_policy_t policy,
+    uint32_t sample_n
+);
+
+/**
+ * @brief Verify records waiting in the deferred-audit ring
+ *
+ * Intended to run from a low-priority background task. Each record's
+ * chain hash is recomputed and its signature checked; failures raise
+ * chain->verify_failures.
+ *
+ * @param chain Chain state
+ * @param max_records Upper bound on records checked in this call
+ * @param failures Output: failures found in this call (may be NULL)
+ * @return Number of records audited
+ */
+uint32_t witness_chain_audit_pending(
+    witness_chain_t* chain,
+    uint32_t max_records,
+    uint32_t* failures
+);
+
+/**
+ * @brief Result of a range verification
+ */
+typedef struct {
+    uint32_t start_sequence;
+    uint32_t end_sequence;          // Last sequence examined
+    uint32_t records;
+    uint32_t sig_checks;            // Ed25519 verifications performed
+    uint32_t chain_failures;        // Recomputed chain hash mismatches
+    uint32_t sig_failures;          // Records failing signature or batch root
+    uint32_t unverified;            // Batched records cut off by the range
+    uint32_t gaps;                  // Missing sequence numbers
+    uint32_t first_bad_sequence;    // 0 if none
+    uint32_t elapsed_ms;
+    uint32_t records_per_sec;       // Throughput, for sizing audit windows
+    bool anchored;                  // First link checked against predecessor
+} witness_range_report_t;
+
+/**
+ * @brief Verify a stored range of records
+ *
+ * Streams records from witness storage, recomputes the hash chain link by
+ * link, and checks signatures. Merkle-batched records are verified with
+ * one signature check per batch root; backends offering batched Ed25519
+ * verification may also group individually signed records.
+ *
+ * @param chain Chain state (public key)
+ * @param start_seq First sequence number
+ * @param end_seq Last sequence number (0 = to end)
+ * @param report Output report
+ * @return RESULT_OK if every examined record verified
+ */
+result_t witness_chain_verify_range(
+    const witness_chain_t* chain,
+    uint32_t start_seq,
+    uint32_t end_seq,
+    witness_range_report_t* report
+);
+
+/**
+ * @brief Verify stored records from the latest checkpoint to the end
+ *
+ * The checkpoint record itself is the first one checked, anchored on its
+ * predecessor, so the cost depends on checkpoint_interval rather than on
+ * the length of the chain. With no stored checkpoint the last max_records
+ * records are checked instead.
+ *
+ * @param chain Chain state (public key)
+ * @param max_records Upper bound on records examined
+ * @param report Output report
+ * @param checkpoint_seq Output: checkpoint started from, 0 if none (may be NULL)
+ * @return RESULT_OK if every examined record verified
+ */
+result_t witness_chain_verify_from_checkpoint(
+    const witness_chain_t* chain,
+    uint32_t max_records,
+    witness_range_report_t* report,
+    uint32_t* checkpoint_seq
+);
+
 // ============================================================================
 // PERSISTENCE
 // ============================================================================
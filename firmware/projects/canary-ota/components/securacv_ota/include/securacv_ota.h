@@ -7,13 +7,23 @@
  *
  * - Manifest-based version checking over HTTPS
  * - Secure firmware download with SHA256 verification
+ * - Resumable downloads: NVS checkpoints and HTTP Range requests survive
+ *   disconnects and reboots
+ * - zlib-compressed and delta images, decoded as they stream into flash
+ * - Conditional manifest polling (ETag / Last-Modified cached in NVS) on a
+ *   jittered schedule that backs off after failures
  * - Dual-partition A/B update scheme with automatic rollback
  * - Self-test validation after OTA to prevent bricking
  * - Progress reporting via callback interface
  *
  * SECURITY MODEL:
  * - All downloads occur over HTTPS with TLS certificate verification
- * - Firmware images are verified against SHA256 hash from manifest
+ * - Firmware images are hashed as they stream in and checked against the
+ *   manifest SHA256 at the end of the download, with no flash read-back
+ * - Compressed and delta downloads are hashed after decoding, so the
+ *   manifest SHA256 always covers the image that was flashed
+ * - A delta is only applied after the running image hashes to its
+ *   base_sha256
  * - ESP-IDF's Secure Boot v2 provides bootloader-level signature verification (Phase 3)
  * - Rollback protection ensures only validated firmware stays active
  *
@@ -22,6 +32,7 @@
  * 2. Call securacv_ota_boot_self_test() early in app_main() to handle OTA validation
  * 3. Use securacv_ota_check_and_install() to trigger update check
  * 4. Monitor progress via the registered callback
+ * 5. Check again whenever securacv_ota_next_poll_ms() reaches 0
  *
  * @author ERRERlabs
  * @copyright MIT License
@@ -95,8 +106,21 @@ typedef enum {
     SECURACV_OTA_ERR_ALREADY_RUNNING,       /**< OTA operation already in progress */
     SECURACV_OTA_ERR_NOT_INITIALIZED,       /**< OTA engine not initialized */
     SECURACV_OTA_ERR_OUT_OF_MEMORY,         /**< Memory allocation failed */
+    SECURACV_OTA_ERR_BASE_MISMATCH,         /**< Delta update made from different firmware than is running */
+    SECURACV_OTA_ERR_DECODE,                /**< Compressed or delta image is corrupt */
 } securacv_ota_error_t;
 
+/**
+ * @brief How the file at the manifest URL encodes the firmware image
+ *
+ * Values match ota_encoding_t in common/encoding/ota_decode.h.
+ */
+typedef enum {
+    SECURACV_OTA_ENCODING_RAW = 0,  /**< The image itself (resumable) */
+    SECURACV_OTA_ENCODING_ZLIB,     /**< One zlib stream */
+    SECURACV_OTA_ENCODING_DELTA,    /**< zlib-compressed SCVD patch against the running image */
+} securacv_ota_encoding_t;
+
 // ============================================================================
 // MANIFEST STRUCTURE
 // ============================================================================
@@ -118,6 +142,16 @@ typedef enum {
  *   "release_notes": "Improved detection accuracy",
  *   "release_url": "https://operacanary.com/changelog#1.3.0"
  * }
+ *
+ * A compressed or delta image adds (common/tools/ota_patch.py writes these):
+ *   "encoding": "delta",            ("raw" when absent, or "zlib")
+ *   "transfer_size": 48213,
+ *   "base_version": "1.2.0",
+ *   "base_size": 1040384,
+ *   "base_sha256": "0f1e2d3c4b5a..."
+ *
+ * sha256 and size always describe the decoded image; size is required
+ * for encoded images.
  */
 typedef struct {
     char product[32];           /**< Product identifier (must match SECURACV_DEVICE_PRODUCT) */
@@ -128,6 +162,11 @@ typedef struct {
     uint32_t size;              /**< Firmware binary size in bytes */
     char release_notes[512];    /**< Human-readable changelog text */
     char release_url[128];      /**< URL to full release notes page */
+    securacv_ota_encoding_t encoding; /**< Encoding of the file at url */
+    uint32_t transfer_size;     /**< Bytes at url when encoded (0 = unchecked) */
+    char base_version[16];      /**< Delta only: version the patch was made from */
+    char base_sha256[65];       /**< Delta only: hex SHA256 of the base image */
+    uint32_t base_size;         /**< Delta only: base image size in bytes */
 } securacv_ota_manifest_t;
 
 // ============================================================================
@@ -141,7 +180,9 @@ typedef struct {
  * The callback is called from the OTA task context, so it should be non-blocking.
  *
  * @param state Current OTA state
- * @param percent Download progress (0-100), only valid during DOWNLOADING state
+ * @param percent Download progress (0-100), only valid during DOWNLOADING state.
+ *                A resumed download reports the resume point first, so percent
+ *                may start above 0.
  * @param error Error code, only valid when state is SECURACV_OTA_ERROR
  * @param user_data User-provided context pointer from configuration
  *
@@ -209,6 +250,12 @@ typedef struct {
     bool auto_reboot;                   /**< Automatically reboot after successful download (default: true) */
     uint32_t http_timeout_ms;           /**< HTTP request timeout in milliseconds (default: 30000) */
     uint32_t download_buffer_size;      /**< Download chunk size in bytes (default: 4096) */
+    uint8_t download_retries;           /**< Retries after a dropped connection: Range resumes for raw
+                                             images, restarts for encoded ones (default: 5) */
+    uint32_t poll_interval_s;           /**< Time between update checks (default: 86400) */
+    uint8_t poll_jitter_percent;        /**< Each interval is randomly +/- this percent (default: 20) */
+    uint32_t poll_retry_s;              /**< Delay after a failed check, doubled per consecutive
+                                             failure up to poll_interval_s (default: 300) */
 } securacv_ota_config_t;
 
 /**
@@ -225,6 +272,10 @@ typedef struct {
     .auto_reboot = true, \
     .http_timeout_ms = 30000, \
     .download_buffer_size = 4096, \
+    .download_retries = 5, \
+    .poll_interval_s = 86400, \
+    .poll_jitter_percent = 20, \
+    .poll_retry_s = 300, \
 }
 
 // ============================================================================
@@ -272,6 +323,11 @@ esp_err_t securacv_ota_deinit(void);
  * If an update is available, the manifest information can be retrieved
  * via securacv_ota_get_manifest().
  *
+ * The request carries If-None-Match / If-Modified-Since from the last
+ * manifest that was fetched and parsed (kept in NVS across reboots). A
+ * 304 Not Modified reply reuses that manifest without downloading or
+ * parsing it again.
+ *
  * @return ESP_OK if check started, ESP_ERR_INVALID_STATE if already running
  */
 esp_err_t securacv_ota_check(void);
@@ -282,7 +338,8 @@ esp_err_t securacv_ota_check(void);
  * This is the main entry point for OTA updates. It:
  * 1. Fetches the manifest
  * 2. Compares versions
- * 3. Downloads the new firmware (if newer version available)
+ * 3. Downloads the new firmware (if newer version available), resuming
+ *    an earlier interrupted download of the same image with a Range request
  * 4. Verifies SHA256 hash
  * 5. Writes to inactive OTA partition
  * 6. Reboots into new firmware (if auto_reboot is true)
@@ -404,6 +461,27 @@ bool securacv_ota_update_available(void);
  */
 uint8_t securacv_ota_get_progress(void);
 
+/**
+ * @brief Time until the next scheduled update check
+ *
+ * After a successful check (including "no update" and 304 Not Modified)
+ * the next one is due poll_interval_s later, randomly shifted by up to
+ * poll_jitter_percent so that a fleet booted together drifts apart. After
+ * a failed check or install the delay is poll_retry_s, doubled for each
+ * further consecutive failure up to poll_interval_s, and randomized
+ * between half and all of that. A Retry-After header on a 429 or 503
+ * manifest response is honoured as a minimum.
+ *
+ * @return Milliseconds until a check is due: 0 before the first check and
+ *         once the delay has passed, UINT32_MAX while a check is running
+ *
+ * Example:
+ *   if (wifi_sta_is_connected() && securacv_ota_next_poll_ms() == 0) {
+ *       securacv_ota_check_and_install();
+ *   }
+ */
+uint32_t securacv_ota_next_poll_ms(void);
+
 // ============================================================================
 // UTILITY FUNCTIONS
 // ============================================================================
@@ -3,14 +3,19 @@
  * @brief SecuraCV Canary OTA Update Engine Implementation
  *
  * This file implements the OTA update engine for the SecuraCV Canary device.
- * It uses ESP-IDF's esp_https_ota APIs for secure firmware downloads with
- * SHA256 verification and automatic rollback support.
+ * Firmware is streamed over HTTPS straight into the inactive OTA partition
+ * with SHA256 verification and automatic rollback support. Downloads are
+ * resumable: progress is checkpointed to NVS and an interrupted transfer
+ * continues with an HTTP Range request instead of starting over. zlib and
+ * delta images are decoded on the way (common/encoding/ota_decode.h), so
+ * flash and the hash only ever see the decoded image.
  *
  * ARCHITECTURE:
  * - OTA operations run in a dedicated FreeRTOS task to avoid blocking
  * - State machine drives the update process
  * - Progress is reported via user-registered callback
  * - Self-test validation runs at boot to confirm OTA success
+ * - Resume checkpoints (flashed length + prefix SHA256) live in NVS
  *
  * SECURITY:
  * - All HTTP communication is over TLS (HTTPS)
@@ -22,6 +27,7 @@
 #include "securacv_ota.h"
 
 #include <string.h>
+#include <strings.h>
 #include <stdlib.h>
 
 #include "freertos/FreeRTOS.h"
@@ -31,13 +37,16 @@
 #include "esp_log.h"
 #include "esp_err.h"
 #include "esp_ota_ops.h"
-#include "esp_https_ota.h"
 #include "esp_http_client.h"
 #include "esp_app_format.h"
+#include "esp_app_desc.h"
 #include "esp_partition.h"
+#include "esp_random.h"
 #include "nvs_flash.h"
+#include "nvs.h"
 #include "cJSON.h"
 #include "mbedtls/sha256.h"
+#include "common/encoding/ota_decode.h"
 
 // ============================================================================
 // LOGGING
@@ -57,6 +66,18 @@ static const char *TAG = "securacv_ota";
 #define HTTP_BUFFER_SIZE        4096  // Large enough for manifest JSON with release notes
 #define SHA256_DIGEST_LENGTH    32
 
+#define OTA_SECTOR_SIZE         4096            // Flash erase unit; writes are staged per sector
+#define OTA_RESUME_CHECKPOINT   (64 * 1024)     // Bytes between NVS resume checkpoints
+#define OTA_RETRY_DELAY_MS      2000            // First retry back-off, doubled per attempt
+#define OTA_RETRY_DELAY_MAX_MS  30000
+
+#define OTA_NVS_NAMESPACE       "securacv_ota"
+#define OTA_NVS_KEY_RESUME      "resume"
+#define OTA_RESUME_MAGIC        0x5245534DU     // "RESM"
+#define OTA_NVS_KEY_MANIFEST    "manifest"
+#define OTA_MANIFEST_MAGIC      0x4D414E46U     // "MANF"
+#define OTA_VALIDATOR_LEN       64              // ETag / Last-Modified, with terminator
+
 // ============================================================================
 // INTERNAL STATE
 // ============================================================================
@@ -75,6 +96,8 @@ typedef struct {
 
     // Manifest from last check
     securacv_ota_manifest_t manifest;
+    uint8_t manifest_sha256[SHA256_DIGEST_LENGTH];  // manifest.sha256, decoded at parse
+    uint8_t base_sha256[SHA256_DIGEST_LENGTH];      // manifest.base_sha256 (delta only)
     bool manifest_valid;
     bool update_available;
 
@@ -92,10 +115,79 @@ typedef struct {
 
     // Operation mode (check only or check+install)
     bool install_mode;
+
+    // Poll schedule, from the outcome of the last check
+    bool poll_scheduled;
+    TickType_t poll_tick;           // When the last check finished
+    uint32_t poll_delay_ms;         // Jittered delay after poll_tick
+    uint8_t poll_failures;          // Consecutive failed checks / installs
+    uint32_t retry_after_s;         // Retry-After from a 429 / 503 manifest or image reply
 } ota_context_t;
 
 static ota_context_t s_ctx = {0};
 
+/**
+ * @brief Resume record persisted in NVS during a download
+ *
+ * Identifies the image (partition, size, manifest hash) and how much of
+ * it is safely in flash. written is always sector aligned.
+ */
+typedef struct {
+    uint32_t magic;                             /**< OTA_RESUME_MAGIC */
+    uint32_t partition_addr;                    /**< Update partition being written */
+    uint32_t image_size;                        /**< Total image bytes */
+    uint32_t written;                           /**< Bytes flashed and hashed */
+    char sha256[65];                            /**< Manifest hash of the target image */
+    uint8_t prefix_digest[SHA256_DIGEST_LENGTH]; /**< SHA256 of the first written bytes */
+} ota_resume_t;
+
+/**
+ * @brief Last parsed manifest and its HTTP validators, persisted in NVS
+ *
+ * A 304 Not Modified reply restores the manifest from here instead of
+ * parsing it again. url_digest ties the entry to the configured
+ * manifest_url.
+ */
+typedef struct {
+    uint32_t magic;                             /**< OTA_MANIFEST_MAGIC */
+    uint8_t url_digest[SHA256_DIGEST_LENGTH];   /**< SHA256 of manifest_url */
+    char etag[OTA_VALIDATOR_LEN];               /**< ETag response header, or "" */
+    char last_modified[OTA_VALIDATOR_LEN];      /**< Last-Modified response header, or "" */
+    securacv_ota_manifest_t manifest;
+    uint8_t manifest_sha256[SHA256_DIGEST_LENGTH];
+    uint8_t base_sha256[SHA256_DIGEST_LENGTH];
+} ota_manifest_cache_t;
+
+/**
+ * @brief Manifest response collected by the HTTP event handler
+ */
+typedef struct {
+    char *body;
+    char etag[OTA_VALIDATOR_LEN];
+    char last_modified[OTA_VALIDATOR_LEN];
+    uint32_t retry_after_s;
+} ota_manifest_response_t;
+
+/**
+ * @brief State of one image download, across Range requests
+ */
+typedef struct {
+    const esp_partition_t *partition;
+    uint8_t *sector;            // Staging for the sector being received
+    size_t sector_fill;
+    uint32_t written;           // Bytes flashed (sector aligned until the tail)
+    uint32_t total;             // Image size, from manifest or Content-Length
+    uint32_t next_checkpoint;
+    bool header_checked;
+    mbedtls_sha256_context sha; // Running hash of the flashed bytes
+
+    // zlib and delta images only
+    const esp_partition_t *base; // Running partition a delta applies to
+    uint8_t *recv;              // Encoded bytes from the network
+    ota_decoder_t decoder;
+    esp_err_t stage_err;        // Why the decoder's write callback failed
+} ota_download_t;
+
 // ============================================================================
 // FORWARD DECLARATIONS
 // ============================================================================
@@ -103,13 +195,18 @@ static ota_context_t s_ctx = {0};
 static void ota_task(void *arg);
 static esp_err_t ota_fetch_manifest(void);
 static esp_err_t ota_parse_manifest(const char *json_data);
+static bool ota_manifest_cache_load(ota_manifest_cache_t *cache, const uint8_t *url_digest);
+static void ota_manifest_cache_save(ota_manifest_cache_t *cache, const uint8_t *url_digest,
+                                    const ota_manifest_response_t *response);
+static void ota_poll_record(bool ok);
 static esp_err_t ota_download_and_flash(void);
-static esp_err_t ota_verify_sha256(const esp_partition_t *partition, size_t image_size, const char *expected_hex);
+static esp_err_t ota_hash_partition(const esp_partition_t *partition, size_t len, mbedtls_sha256_context *ctx);
+static esp_err_t ota_verify_sha256(const uint8_t *computed);
 static void ota_set_state(securacv_ota_state_t state);
 static void ota_set_error(securacv_ota_error_t error);
 static void ota_report_progress(uint8_t percent);
 static bool parse_version(const char *version_str, int *major, int *minor, int *patch);
-static void hex_to_bytes(const char *hex, uint8_t *bytes, size_t byte_len);
+static bool hex_to_bytes(const char *hex, uint8_t *bytes, size_t byte_len);
 
 // ============================================================================
 // PUBLIC API - INITIALIZATION
@@ -140,6 +237,15 @@ esp_err_t securacv_ota_init(const securacv_ota_config_t *config)
     if (s_ctx.config.download_buffer_size == 0) {
         s_ctx.config.download_buffer_size = 4096;
     }
+    if (s_ctx.config.poll_interval_s == 0) {
+        s_ctx.config.poll_interval_s = 86400;
+    }
+    if (s_ctx.config.poll_retry_s == 0) {
+        s_ctx.config.poll_retry_s = 300;
+    }
+    if (s_ctx.config.poll_jitter_percent > 100) {
+        s_ctx.config.poll_jitter_percent = 100;
+    }
 
     // Create mutex for thread-safe state access
     s_ctx.mutex = xSemaphoreCreateMutex();
@@ -439,6 +545,22 @@ uint8_t securacv_ota_get_progress(void)
     return s_ctx.progress_percent;
 }
 
+uint32_t securacv_ota_next_poll_ms(void)
+{
+    if (s_ctx.task_handle != NULL) {
+        return UINT32_MAX;
+    }
+    if (!s_ctx.poll_scheduled) {
+        return 0;
+    }
+
+    uint32_t elapsed_ms = (uint32_t)(xTaskGetTickCount() - s_ctx.poll_tick) * portTICK_PERIOD_MS;
+    if (elapsed_ms >= s_ctx.poll_delay_ms) {
+        return 0;
+    }
+    return s_ctx.poll_delay_ms - elapsed_ms;
+}
+
 // ============================================================================
 // PUBLIC API - UTILITIES
 // ============================================================================
@@ -482,6 +604,8 @@ const char *securacv_ota_error_str(securacv_ota_error_t error)
         case SECURACV_OTA_ERR_ALREADY_RUNNING:  return "OTA already running";
         case SECURACV_OTA_ERR_NOT_INITIALIZED:  return "OTA not initialized";
         case SECURACV_OTA_ERR_OUT_OF_MEMORY:    return "Out of memory";
+        case SECURACV_OTA_ERR_BASE_MISMATCH:    return "Delta base mismatch";
+        case SECURACV_OTA_ERR_DECODE:           return "Image decode failed";
         default:                                return "Unknown error";
     }
 }
@@ -522,6 +646,10 @@ static void ota_task(void *arg)
 
     ESP_LOGI(TAG, "OTA task started");
 
+    // Recorded once at task_exit: a good check followed by a failed
+    // install counts as a failure, so install failures back off too
+    bool poll_ok = false;
+
     // Phase 1: Fetch manifest
     ota_set_state(SECURACV_OTA_CHECKING);
 
@@ -530,6 +658,7 @@ static void ota_task(void *arg)
         ESP_LOGE(TAG, "Manifest fetch failed");
         goto task_exit;
     }
+    poll_ok = true;
 
     // Check if abort was requested
     if (s_ctx.task_should_abort) {
@@ -581,6 +710,8 @@ static void ota_task(void *arg)
     err = ota_download_and_flash();
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "Download/flash failed");
+        // Retry on the failure back-off rather than a full interval later
+        poll_ok = false;
         goto task_exit;
     }
 
@@ -596,6 +727,7 @@ static void ota_task(void *arg)
     }
 
 task_exit:
+    ota_poll_record(poll_ok);
     s_ctx.task_handle = NULL;
     vTaskDelete(NULL);
 }
@@ -604,6 +736,21 @@ task_exit:
 // INTERNAL - MANIFEST FETCH AND PARSE
 // ============================================================================
 
+/**
+ * @brief Copy a validator header, dropping values too long to store whole
+ *
+ * A truncated ETag would never match, so it is not kept at all.
+ */
+static void ota_copy_validator(char *dst, const char *src)
+{
+    size_t len = strlen(src);
+    if (len < OTA_VALIDATOR_LEN) {
+        memcpy(dst, src, len + 1);
+    } else {
+        dst[0] = '\0';
+    }
+}
+
 /**
  * @brief HTTP event handler for manifest fetch
  */
@@ -611,8 +758,20 @@ static esp_err_t http_event_handler(esp_http_client_event_t *evt)
 {
     static char *output_buffer = NULL;
     static int output_len = 0;
+    ota_manifest_response_t *resp = (ota_manifest_response_t *)evt->user_data;
 
     switch (evt->event_id) {
+        case HTTP_EVENT_ON_HEADER:
+            if (strcasecmp(evt->header_key, "ETag") == 0) {
+                ota_copy_validator(resp->etag, evt->header_value);
+            } else if (strcasecmp(evt->header_key, "Last-Modified") == 0) {
+                ota_copy_validator(resp->last_modified, evt->header_value);
+            } else if (strcasecmp(evt->header_key, "Retry-After") == 0) {
+                // Delay-seconds form only; an HTTP-date leaves the back-off alone
+                resp->retry_after_s = (uint32_t)strtoul(evt->header_value, NULL, 10);
+            }
+            break;
+
         case HTTP_EVENT_ON_DATA:
             // Accumulate response data
             if (output_buffer == NULL) {
@@ -635,10 +794,9 @@ static esp_err_t http_event_handler(esp_http_client_event_t *evt)
 
         case HTTP_EVENT_ON_FINISH:
             if (output_buffer != NULL) {
-                // Store response in user_data
-                char **response = (char **)evt->user_data;
-                if (response != NULL && *response == NULL) {
-                    *response = output_buffer;
+                // Hand the body to the caller
+                if (resp != NULL && resp->body == NULL) {
+                    resp->body = output_buffer;
                     output_buffer = NULL;
                 } else {
                     free(output_buffer);
@@ -665,14 +823,30 @@ static esp_err_t http_event_handler(esp_http_client_event_t *evt)
 
 /**
  * @brief Fetch manifest JSON from server
+ *
+ * Sends the validators of the cached manifest, if there is one for this
+ * URL; a 304 reply restores that manifest without parsing anything.
  */
 static esp_err_t ota_fetch_manifest(void)
 {
-    char *response = NULL;
+    ota_manifest_response_t response = {0};
     esp_err_t err = ESP_FAIL;
 
     ESP_LOGI(TAG, "Fetching manifest from: %s", s_ctx.config.manifest_url);
 
+    s_ctx.retry_after_s = 0;
+
+    ota_manifest_cache_t *cache = (ota_manifest_cache_t *)calloc(1, sizeof(*cache));
+    if (cache == NULL) {
+        ota_set_error(SECURACV_OTA_ERR_OUT_OF_MEMORY);
+        return ESP_ERR_NO_MEM;
+    }
+
+    uint8_t url_digest[SHA256_DIGEST_LENGTH];
+    mbedtls_sha256((const unsigned char *)s_ctx.config.manifest_url,
+                   strlen(s_ctx.config.manifest_url), url_digest, 0);
+    bool cached = ota_manifest_cache_load(cache, url_digest);
+
     esp_http_client_config_t http_config = {
         .url = s_ctx.config.manifest_url,
         .event_handler = http_event_handler,
@@ -694,19 +868,41 @@ static esp_err_t ota_fetch_manifest(void)
     if (client == NULL) {
         ESP_LOGE(TAG, "Failed to initialize HTTP client");
         ota_set_error(SECURACV_OTA_ERR_NETWORK);
+        free(cache);
         return ESP_FAIL;
     }
 
+    if (cached) {
+        if (cache->etag[0] != '\0') {
+            esp_http_client_set_header(client, "If-None-Match", cache->etag);
+        }
+        if (cache->last_modified[0] != '\0') {
+            esp_http_client_set_header(client, "If-Modified-Since", cache->last_modified);
+        }
+    }
+
     err = esp_http_client_perform(client);
 
     if (err == ESP_OK) {
         int status = esp_http_client_get_status_code(client);
         ESP_LOGI(TAG, "HTTP status: %d", status);
 
-        if (status == 200 && response != NULL) {
-            ESP_LOGD(TAG, "Manifest response: %s", response);
-            err = ota_parse_manifest(response);
+        if (status == 304 && cached) {
+            memcpy(&s_ctx.manifest, &cache->manifest, sizeof(s_ctx.manifest));
+            memcpy(s_ctx.manifest_sha256, cache->manifest_sha256, SHA256_DIGEST_LENGTH);
+            memcpy(s_ctx.base_sha256, cache->base_sha256, SHA256_DIGEST_LENGTH);
+            s_ctx.manifest_valid = true;
+            ESP_LOGI(TAG, "Manifest not modified (version %s)", s_ctx.manifest.version);
+        } else if (status == 200 && response.body != NULL) {
+            ESP_LOGD(TAG, "Manifest response: %s", response.body);
+            err = ota_parse_manifest(response.body);
+            if (err == ESP_OK) {
+                ota_manifest_cache_save(cache, url_digest, &response);
+            }
         } else {
+            if (status == 429 || status == 503) {
+                s_ctx.retry_after_s = response.retry_after_s;
+            }
             ESP_LOGE(TAG, "HTTP request failed: status=%d", status);
             ota_set_error(SECURACV_OTA_ERR_MANIFEST_FETCH);
             err = ESP_FAIL;
@@ -716,9 +912,10 @@ static esp_err_t ota_fetch_manifest(void)
         ota_set_error(SECURACV_OTA_ERR_NETWORK);
     }
 
-    if (response != NULL) {
-        free(response);
+    if (response.body != NULL) {
+        free(response.body);
     }
+    free(cache);
 
     esp_http_client_cleanup(client);
     return err;
@@ -771,6 +968,15 @@ static esp_err_t ota_parse_manifest(const char *json_data)
     strncpy(s_ctx.manifest.url, url->valuestring, sizeof(s_ctx.manifest.url) - 1);
     strncpy(s_ctx.manifest.sha256, sha256->valuestring, sizeof(s_ctx.manifest.sha256) - 1);
 
+    // Decode the hash now: a malformed one fails the check, not the install
+    if (strlen(sha256->valuestring) != SHA256_DIGEST_LENGTH * 2 ||
+        !hex_to_bytes(sha256->valuestring, s_ctx.manifest_sha256, SHA256_DIGEST_LENGTH)) {
+        ESP_LOGE(TAG, "Manifest sha256 is not 64 hex digits");
+        cJSON_Delete(root);
+        ota_set_error(SECURACV_OTA_ERR_MANIFEST_INVALID);
+        return ESP_FAIL;
+    }
+
     // Optional fields
     cJSON *min_version = cJSON_GetObjectItem(root, "min_version");
     if (cJSON_IsString(min_version)) {
@@ -795,39 +1001,674 @@ static esp_err_t ota_parse_manifest(const char *json_data)
                 sizeof(s_ctx.manifest.release_url) - 1);
     }
 
+    // Transfer encoding; sha256 and size keep describing the decoded image
+    const char *invalid = NULL;
+    cJSON *encoding = cJSON_GetObjectItem(root, "encoding");
+    if (cJSON_IsString(encoding)) {
+        ota_encoding_t enc;
+        if (ota_encoding_parse(encoding->valuestring, &enc)) {
+            s_ctx.manifest.encoding = (securacv_ota_encoding_t)enc;
+        } else {
+            invalid = "unknown encoding";
+        }
+    }
+
+    cJSON *transfer_size = cJSON_GetObjectItem(root, "transfer_size");
+    if (cJSON_IsNumber(transfer_size)) {
+        s_ctx.manifest.transfer_size = (uint32_t)transfer_size->valuedouble;
+    }
+
+    if (s_ctx.manifest.encoding != SECURACV_OTA_ENCODING_RAW && s_ctx.manifest.size == 0) {
+        invalid = "encoded image without its decoded size";
+    }
+
+    if (s_ctx.manifest.encoding == SECURACV_OTA_ENCODING_DELTA) {
+        cJSON *base_version = cJSON_GetObjectItem(root, "base_version");
+        cJSON *base_size = cJSON_GetObjectItem(root, "base_size");
+        cJSON *base_sha256 = cJSON_GetObjectItem(root, "base_sha256");
+        if (cJSON_IsString(base_version)) {
+            strncpy(s_ctx.manifest.base_version, base_version->valuestring,
+                    sizeof(s_ctx.manifest.base_version) - 1);
+        }
+        if (cJSON_IsNumber(base_size)) {
+            s_ctx.manifest.base_size = (uint32_t)base_size->valuedouble;
+        }
+        if (!cJSON_IsString(base_sha256) ||
+            strlen(base_sha256->valuestring) != SHA256_DIGEST_LENGTH * 2 ||
+            !hex_to_bytes(base_sha256->valuestring, s_ctx.base_sha256, SHA256_DIGEST_LENGTH) ||
+            s_ctx.manifest.base_size == 0) {
+            invalid = "delta without base_size and base_sha256";
+        } else {
+            strncpy(s_ctx.manifest.base_sha256, base_sha256->valuestring,
+                    sizeof(s_ctx.manifest.base_sha256) - 1);
+        }
+    }
+
     cJSON_Delete(root);
 
+    if (invalid != NULL) {
+        ESP_LOGE(TAG, "Manifest rejected: %s", invalid);
+        ota_set_error(SECURACV_OTA_ERR_MANIFEST_INVALID);
+        return ESP_FAIL;
+    }
+
     s_ctx.manifest_valid = true;
 
     ESP_LOGI(TAG, "Manifest parsed successfully:");
     ESP_LOGI(TAG, "  Product: %s", s_ctx.manifest.product);
     ESP_LOGI(TAG, "  Version: %s", s_ctx.manifest.version);
     ESP_LOGI(TAG, "  Size: %lu bytes", (unsigned long)s_ctx.manifest.size);
+    if (s_ctx.manifest.encoding != SECURACV_OTA_ENCODING_RAW) {
+        ESP_LOGI(TAG, "  Encoding: %s (%lu bytes to download)",
+                 ota_encoding_name((ota_encoding_t)s_ctx.manifest.encoding),
+                 (unsigned long)s_ctx.manifest.transfer_size);
+    }
 
     return ESP_OK;
 }
 
 // ============================================================================
-// INTERNAL - DOWNLOAD AND FLASH
+// INTERNAL - MANIFEST CACHE
 // ============================================================================
 
 /**
- * @brief Download firmware and flash to OTA partition
+ * @brief Load the cached manifest for this manifest URL, if any
  */
-static esp_err_t ota_download_and_flash(void)
+static bool ota_manifest_cache_load(ota_manifest_cache_t *cache, const uint8_t *url_digest)
+{
+    nvs_handle_t nvs;
+    if (nvs_open(OTA_NVS_NAMESPACE, NVS_READONLY, &nvs) != ESP_OK) {
+        return false;
+    }
+
+    size_t len = sizeof(*cache);
+    esp_err_t err = nvs_get_blob(nvs, OTA_NVS_KEY_MANIFEST, cache, &len);
+    nvs_close(nvs);
+
+    return err == ESP_OK && len == sizeof(*cache) && cache->magic == OTA_MANIFEST_MAGIC &&
+           memcmp(cache->url_digest, url_digest, SHA256_DIGEST_LENGTH) == 0 &&
+           (cache->etag[0] != '\0' || cache->last_modified[0] != '\0');
+}
+
+/**
+ * @brief Cache the manifest just parsed, with the validators it came with
+ *
+ * A response without ETag or Last-Modified erases the entry, so the next
+ * request is unconditional. Only a changed manifest (a 200) gets here,
+ * so NVS is written once per release, not once per poll.
+ */
+static void ota_manifest_cache_save(ota_manifest_cache_t *cache, const uint8_t *url_digest,
+                                    const ota_manifest_response_t *response)
 {
+    nvs_handle_t nvs;
+    if (nvs_open(OTA_NVS_NAMESPACE, NVS_READWRITE, &nvs) != ESP_OK) {
+        return;
+    }
+
     esp_err_t err;
-    esp_https_ota_handle_t https_ota_handle = NULL;
-    size_t image_size = 0;
+    if (response->etag[0] == '\0' && response->last_modified[0] == '\0') {
+        err = nvs_erase_key(nvs, OTA_NVS_KEY_MANIFEST);
+    } else {
+        memset(cache, 0, sizeof(*cache));
+        cache->magic = OTA_MANIFEST_MAGIC;
+        memcpy(cache->url_digest, url_digest, SHA256_DIGEST_LENGTH);
+        memcpy(cache->etag, response->etag, sizeof(cache->etag));
+        memcpy(cache->last_modified, response->last_modified, sizeof(cache->last_modified));
+        memcpy(&cache->manifest, &s_ctx.manifest, sizeof(cache->manifest));
+        memcpy(cache->manifest_sha256, s_ctx.manifest_sha256, SHA256_DIGEST_LENGTH);
+        memcpy(cache->base_sha256, s_ctx.base_sha256, SHA256_DIGEST_LENGTH);
+        err = nvs_set_blob(nvs, OTA_NVS_KEY_MANIFEST, cache, sizeof(*cache));
+    }
+    if (err == ESP_OK) {
+        nvs_commit(nvs);
+    }
+    nvs_close(nvs);
+}
 
-    ota_set_state(SECURACV_OTA_DOWNLOADING);
-    ota_report_progress(0);
+// ============================================================================
+// INTERNAL - POLL SCHEDULE
+// ============================================================================
 
-    ESP_LOGI(TAG, "Downloading firmware from: %s", s_ctx.manifest.url);
+/**
+ * @brief Uniform random value in [0, range)
+ */
+static uint64_t ota_random_below(uint64_t range)
+{
+    return ((uint64_t)esp_random() * range) >> 32;
+}
 
-    // Configure HTTP client
+/**
+ * @brief Schedule the next check from the outcome of this one
+ *
+ * Success: poll_interval_s +/- poll_jitter_percent. Failure: poll_retry_s
+ * doubled per consecutive failure, capped at poll_interval_s, then
+ * "equal jitter" (half fixed, half random) so devices that failed
+ * together retry apart. Retry-After is a floor on either.
+ */
+static void ota_poll_record(bool ok)
+{
+    const securacv_ota_config_t *cfg = &s_ctx.config;
+    uint64_t interval_ms = (uint64_t)cfg->poll_interval_s * 1000;
+    uint64_t delay_ms;
+
+    if (ok) {
+        s_ctx.poll_failures = 0;
+        uint64_t spread = interval_ms * cfg->poll_jitter_percent / 100;
+        delay_ms = interval_ms - spread + ota_random_below(2 * spread + 1);
+    } else {
+        if (s_ctx.poll_failures < UINT8_MAX) {
+            s_ctx.poll_failures++;
+        }
+        uint64_t backoff_ms = (uint64_t)cfg->poll_retry_s * 1000;
+        for (uint8_t i = 1; i < s_ctx.poll_failures && backoff_ms < interval_ms; i++) {
+            backoff_ms *= 2;
+        }
+        if (backoff_ms > interval_ms) {
+            backoff_ms = interval_ms;
+        }
+        delay_ms = backoff_ms / 2 + ota_random_below(backoff_ms / 2 + 1);
+    }
+
+    if (delay_ms < (uint64_t)s_ctx.retry_after_s * 1000) {
+        delay_ms = (uint64_t)s_ctx.retry_after_s * 1000;
+    }
+    if (delay_ms > UINT32_MAX - 1) {
+        delay_ms = UINT32_MAX - 1;
+    }
+
+    s_ctx.poll_delay_ms = (uint32_t)delay_ms;
+    s_ctx.poll_tick = xTaskGetTickCount();
+    s_ctx.poll_scheduled = true;
+
+    ESP_LOGI(TAG, "Next update check in %lu s (%u consecutive failures)",
+             (unsigned long)(s_ctx.poll_delay_ms / 1000), s_ctx.poll_failures);
+}
+
+// ============================================================================
+// INTERNAL - RESUME RECORD
+// ============================================================================
+
+/**
+ * @brief Load the resume record, if any
+ */
+static bool ota_resume_load(ota_resume_t *rec)
+{
+    nvs_handle_t nvs;
+    if (nvs_open(OTA_NVS_NAMESPACE, NVS_READONLY, &nvs) != ESP_OK) {
+        return false;
+    }
+
+    size_t len = sizeof(*rec);
+    esp_err_t err = nvs_get_blob(nvs, OTA_NVS_KEY_RESUME, rec, &len);
+    nvs_close(nvs);
+
+    return err == ESP_OK && len == sizeof(*rec) && rec->magic == OTA_RESUME_MAGIC;
+}
+
+/**
+ * @brief Persist a checkpoint: flashed length and the SHA-256 of that prefix
+ *
+ * The running hash context is cloned and finished so the download can
+ * carry on hashing. The mbedtls context itself is not stored: with the
+ * SHA accelerator its state lives in hardware and does not survive reset.
+ */
+static void ota_resume_save(const ota_download_t *dl)
+{
+    ota_resume_t rec = {0};
+    rec.magic = OTA_RESUME_MAGIC;
+    rec.partition_addr = dl->partition->address;
+    rec.image_size = dl->total;
+    rec.written = dl->written;
+    strncpy(rec.sha256, s_ctx.manifest.sha256, sizeof(rec.sha256) - 1);
+
+    mbedtls_sha256_context prefix;
+    mbedtls_sha256_init(&prefix);
+    mbedtls_sha256_clone(&prefix, &dl->sha);
+    mbedtls_sha256_finish(&prefix, rec.prefix_digest);
+    mbedtls_sha256_free(&prefix);
+
+    nvs_handle_t nvs;
+    if (nvs_open(OTA_NVS_NAMESPACE, NVS_READWRITE, &nvs) != ESP_OK) {
+        return;
+    }
+    if (nvs_set_blob(nvs, OTA_NVS_KEY_RESUME, &rec, sizeof(rec)) == ESP_OK) {
+        nvs_commit(nvs);
+    }
+    nvs_close(nvs);
+
+    ESP_LOGD(TAG, "Resume checkpoint at %lu bytes", (unsigned long)dl->written);
+}
+
+/**
+ * @brief Discard the resume record
+ */
+static void ota_resume_clear(void)
+{
+    nvs_handle_t nvs;
+    if (nvs_open(OTA_NVS_NAMESPACE, NVS_READWRITE, &nvs) != ESP_OK) {
+        return;
+    }
+    if (nvs_erase_key(nvs, OTA_NVS_KEY_RESUME) == ESP_OK) {
+        nvs_commit(nvs);
+    }
+    nvs_close(nvs);
+}
+
+/**
+ * @brief Pick up an interrupted download of the same image, if there is one
+ *
+ * The record must name the same update partition and image hash. The
+ * flashed prefix is re-hashed from flash and checked against the
+ * checkpoint digest, which also seeds the running hash to continue from.
+ * Anything that does not match starts the download from zero.
+ */
+static void ota_resume_prepare(ota_download_t *dl)
+{
+    ota_resume_t rec;
+    if (!ota_resume_load(&rec)) {
+        return;
+    }
+
+    bool same_image = rec.partition_addr == dl->partition->address &&
+                      strncmp(rec.sha256, s_ctx.manifest.sha256, sizeof(rec.sha256)) == 0 &&
+                      (s_ctx.manifest.size == 0 || rec.image_size == s_ctx.manifest.size) &&
+                      rec.written % OTA_SECTOR_SIZE == 0 &&
+                      rec.written < rec.image_size &&
+                      rec.image_size <= dl->partition->size;
+    if (!same_image) {
+        ESP_LOGI(TAG, "Discarding resume record for a different image");
+        ota_resume_clear();
+        return;
+    }
+
+    uint8_t digest[SHA256_DIGEST_LENGTH];
+    mbedtls_sha256_context prefix;
+    mbedtls_sha256_init(&prefix);
+    mbedtls_sha256_starts(&prefix, 0);
+    esp_err_t err = ota_hash_partition(dl->partition, rec.written, &prefix);
+    if (err == ESP_OK) {
+        mbedtls_sha256_clone(&dl->sha, &prefix);
+        mbedtls_sha256_finish(&prefix, digest);
+    }
+    mbedtls_sha256_free(&prefix);
+
+    if (err != ESP_OK || memcmp(digest, rec.prefix_digest, SHA256_DIGEST_LENGTH) != 0) {
+        ESP_LOGW(TAG, "Flashed prefix does not match checkpoint - restarting download");
+        mbedtls_sha256_starts(&dl->sha, 0);
+        ota_resume_clear();
+        return;
+    }
+
+    dl->written = rec.written;
+    dl->total = rec.image_size;
+    dl->next_checkpoint = rec.written + OTA_RESUME_CHECKPOINT;
+    dl->header_checked = true;
+    ESP_LOGI(TAG, "Resuming download at %lu of %lu bytes",
+             (unsigned long)dl->written, (unsigned long)dl->total);
+}
+
+// ============================================================================
+// INTERNAL - DOWNLOAD AND FLASH
+// ============================================================================
+
+/**
+ * @brief Forget all progress and download the image from its first byte
+ */
+static void ota_download_restart(ota_download_t *dl)
+{
+    dl->written = 0;
+    dl->sector_fill = 0;
+    dl->total = s_ctx.manifest.size;
+    dl->next_checkpoint = OTA_RESUME_CHECKPOINT;
+    dl->header_checked = false;
+    mbedtls_sha256_starts(&dl->sha, 0);
+    ota_resume_clear();
+}
+
+/**
+ * @brief Release the download buffers and decoder (not the hash context)
+ */
+static void ota_download_free(ota_download_t *dl)
+{
+    free(dl->sector);
+    free(dl->recv);
+    ota_decoder_free(&dl->decoder);
+    dl->sector = NULL;
+    dl->recv = NULL;
+}
+
+/**
+ * @brief Check the image header in the first sector and log what it is
+ *
+ * Catches an HTML error page or a wrong file before it is flashed;
+ * esp_ota_set_boot_partition() validates the complete image at the end.
+ */
+static esp_err_t ota_check_header(const ota_download_t *dl)
+{
+    const size_t desc_offset = sizeof(esp_image_header_t) + sizeof(esp_image_segment_header_t);
+
+    const esp_image_header_t *header = (const esp_image_header_t *)dl->sector;
+    if (dl->sector_fill < desc_offset + sizeof(esp_app_desc_t) ||
+        header->magic != ESP_IMAGE_HEADER_MAGIC) {
+        ESP_LOGE(TAG, "Download is not a firmware image");
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+
+    esp_app_desc_t new_app_info;
+    memcpy(&new_app_info, dl->sector + desc_offset, sizeof(new_app_info));
+    if (new_app_info.magic_word == ESP_APP_DESC_MAGIC_WORD) {
+        ESP_LOGI(TAG, "New firmware: %s (version %s)",
+                 new_app_info.project_name, new_app_info.version);
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief Erase the next sector and write the staged bytes into it
+ *
+ * Writes are always whole staged sectors, except the image tail, which
+ * is padded to the 16-byte unit that encrypted flash writes need.
+ */
+static esp_err_t ota_flush_sector(ota_download_t *dl)
+{
+    if (dl->sector_fill == 0) {
+        return ESP_OK;
+    }
+
+    if (dl->written == 0 && !dl->header_checked) {
+        esp_err_t err = ota_check_header(dl);
+        if (err != ESP_OK) {
+            return err;
+        }
+        dl->header_checked = true;
+    }
+
+    if (dl->written + OTA_SECTOR_SIZE > dl->partition->size) {
+        ESP_LOGE(TAG, "Image does not fit partition %s", dl->partition->label);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    size_t len = dl->sector_fill;
+    size_t padded = (len + 15) & ~(size_t)15;
+    memset(dl->sector + len, 0xFF, padded - len);
+
+    esp_err_t err = esp_partition_erase_range(dl->partition, dl->written, OTA_SECTOR_SIZE);
+    if (err == ESP_OK) {
+        err = esp_partition_write(dl->partition, dl->written, dl->sector, padded);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Flash write failed at offset %lu: %s",
+                 (unsigned long)dl->written, esp_err_to_name(err));
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    mbedtls_sha256_update(&dl->sha, dl->sector, len);
+    dl->written += len;
+    dl->sector_fill = 0;
+    return ESP_OK;
+}
+
+/**
+ * @brief Report download progress when the percentage changes
+ */
+static void ota_download_progress(const ota_download_t *dl, int *last_progress)
+{
+    uint32_t done = dl->written + dl->sector_fill;
+    int progress = (int)(((uint64_t)done * 100) / dl->total);
+    if (progress != *last_progress) {
+        ota_report_progress((uint8_t)progress);
+        *last_progress = progress;
+
+        if (progress % 10 == 0) {
+            ESP_LOGI(TAG, "Download progress: %d%% (%lu/%lu bytes)", progress,
+                     (unsigned long)done, (unsigned long)dl->total);
+        }
+    }
+}
+
+/**
+ * @brief Read a raw image body straight into sector staging
+ */
+static esp_err_t ota_read_raw(ota_download_t *dl, esp_http_client_handle_t client,
+                              int *last_progress)
+{
+    esp_err_t err = ESP_OK;
+    while (dl->written + dl->sector_fill < dl->total) {
+        if (s_ctx.task_should_abort) {
+            err = ESP_ERR_INVALID_STATE;
+            break;
+        }
+
+        size_t want = OTA_SECTOR_SIZE - dl->sector_fill;
+        size_t left = dl->total - dl->written - dl->sector_fill;
+        if (want > left) {
+            want = left;
+        }
+
+        int n = esp_http_client_read(client, (char *)dl->sector + dl->sector_fill, want);
+        if (n <= 0) {
+            ESP_LOGW(TAG, "Connection lost at %lu bytes",
+                     (unsigned long)(dl->written + dl->sector_fill));
+            err = ESP_ERR_TIMEOUT;
+            break;
+        }
+        dl->sector_fill += n;
+
+        if (dl->sector_fill == OTA_SECTOR_SIZE || dl->written + dl->sector_fill == dl->total) {
+            err = ota_flush_sector(dl);
+            if (err != ESP_OK) {
+                break;
+            }
+            if (dl->written >= dl->next_checkpoint && dl->written < dl->total) {
+                ota_resume_save(dl);
+                dl->next_checkpoint = dl->written + OTA_RESUME_CHECKPOINT;
+            }
+        }
+
+        ota_download_progress(dl, last_progress);
+    }
+    return err;
+}
+
+// ============================================================================
+// INTERNAL - COMPRESSED AND DELTA IMAGES
+// ============================================================================
+
+/**
+ * @brief Decoder output: stage decoded bytes and flash each full sector
+ *
+ * Decoded images go through the same staging as raw ones, so the header
+ * check, the tail padding and the running hash are unchanged.
+ */
+static bool ota_stage_decoded(void *ctx, const uint8_t *data, size_t len)
+{
+    ota_download_t *dl = (ota_download_t *)ctx;
+
+    while (len > 0) {
+        size_t n = OTA_SECTOR_SIZE - dl->sector_fill;
+        if (n > len) {
+            n = len;
+        }
+        memcpy(dl->sector + dl->sector_fill, data, n);
+        dl->sector_fill += n;
+        data += n;
+        len -= n;
+
+        if (dl->sector_fill == OTA_SECTOR_SIZE || dl->written + dl->sector_fill == dl->total) {
+            dl->stage_err = ota_flush_sector(dl);
+            if (dl->stage_err != ESP_OK) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Decoder base reads: the running partition
+ */
+static bool ota_read_base(void *ctx, uint32_t offset, uint8_t *buf, size_t len)
+{
+    const ota_download_t *dl = (const ota_download_t *)ctx;
+    return esp_partition_read(dl->base, offset, buf, len) == ESP_OK;
+}
+
+/**
+ * @brief The patch must name the base from the manifest, checked against flash
+ */
+static bool ota_check_patch_base(void *ctx, uint32_t base_size, const uint8_t base_sha256[32])
+{
+    (void)ctx;
+    return base_size == s_ctx.manifest.base_size &&
+           memcmp(base_sha256, s_ctx.base_sha256, SHA256_DIGEST_LENGTH) == 0;
+}
+
+/**
+ * @brief Check the running image is the one a delta was made from
+ *
+ * Runs before anything is downloaded: the version string gives a cheap
+ * early answer, then the first base_size bytes of the running partition
+ * must hash to the manifest's base_sha256.
+ */
+static esp_err_t ota_check_delta_base(ota_download_t *dl)
+{
+    dl->base = esp_ota_get_running_partition();
+    if (dl->base == NULL || s_ctx.manifest.base_size > dl->base->size) {
+        ESP_LOGE(TAG, "Delta base is larger than the running partition");
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    if (s_ctx.manifest.base_version[0] != '\0' &&
+        strcmp(s_ctx.manifest.base_version, SECURACV_FW_VERSION_STRING) != 0) {
+        ESP_LOGE(TAG, "Delta applies to %s, running %s",
+                 s_ctx.manifest.base_version, SECURACV_FW_VERSION_STRING);
+        return ESP_ERR_INVALID_VERSION;
+    }
+
+    uint8_t digest[SHA256_DIGEST_LENGTH];
+    mbedtls_sha256_context ctx;
+    mbedtls_sha256_init(&ctx);
+    mbedtls_sha256_starts(&ctx, 0);
+    esp_err_t err = ota_hash_partition(dl->base, s_ctx.manifest.base_size, &ctx);
+    if (err == ESP_OK) {
+        mbedtls_sha256_finish(&ctx, digest);
+    }
+    mbedtls_sha256_free(&ctx);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    if (memcmp(digest, s_ctx.base_sha256, SHA256_DIGEST_LENGTH) != 0) {
+        ESP_LOGE(TAG, "Running image does not match the delta base_sha256");
+        return ESP_ERR_INVALID_VERSION;
+    }
+
+    ESP_LOGI(TAG, "Delta base verified: %lu bytes of %s",
+             (unsigned long)s_ctx.manifest.base_size, dl->base->label);
+    return ESP_OK;
+}
+
+/**
+ * @brief Start an encoded download from zero with a fresh decoder
+ *
+ * Encoded downloads are not resumable: the inflate state cannot be
+ * rebuilt from what is in flash, so every attempt starts over.
+ */
+static esp_err_t ota_decode_begin(ota_download_t *dl)
+{
+    ota_download_restart(dl);
+    ota_decoder_free(&dl->decoder);
+    dl->stage_err = ESP_OK;
+
+    ota_decoder_io_t io = { ota_stage_decoded, ota_read_base, ota_check_patch_base, dl };
+    if (!ota_decoder_init(&dl->decoder, (ota_encoding_t)s_ctx.manifest.encoding, dl->total, &io)) {
+        ESP_LOGE(TAG, "No memory for the image decoder");
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief Why decoding stopped, as a download result
+ */
+static esp_err_t ota_decode_error(const ota_download_t *dl)
+{
+    if (dl->stage_err != ESP_OK) {
+        return dl->stage_err;   // Flash or header failure, already logged
+    }
+    ESP_LOGE(TAG, "Image decode failed after %lu bytes: %s",
+             (unsigned long)dl->decoder.in_bytes, ota_decode_status_name(dl->decoder.status));
+    return ESP_ERR_INVALID_RESPONSE;
+}
+
+/**
+ * @brief Decode a zlib or delta body into the update partition
+ */
+static esp_err_t ota_read_encoded(ota_download_t *dl, esp_http_client_handle_t client,
+                                  int *last_progress)
+{
+    while (true) {
+        if (s_ctx.task_should_abort) {
+            return ESP_ERR_INVALID_STATE;
+        }
+
+        int n = esp_http_client_read(client, (char *)dl->recv, OTA_SECTOR_SIZE);
+        if (n < 0 || (n == 0 && !esp_http_client_is_complete_data_received(client))) {
+            ESP_LOGW(TAG, "Connection lost at %lu encoded bytes",
+                     (unsigned long)dl->decoder.in_bytes);
+            return ESP_ERR_TIMEOUT;
+        }
+        if (n == 0) {
+            break;
+        }
+
+        if (!ota_decoder_feed(&dl->decoder, dl->recv, (size_t)n)) {
+            return ota_decode_error(dl);
+        }
+        ota_download_progress(dl, last_progress);
+    }
+
+    if (!ota_decoder_finish(&dl->decoder)) {
+        return ota_decode_error(dl);
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief HTTP event handler for image requests: picks up Retry-After
+ */
+static esp_err_t ota_image_event_handler(esp_http_client_event_t *evt)
+{
+    uint32_t *retry_after_s = (uint32_t *)evt->user_data;
+    if (evt->event_id == HTTP_EVENT_ON_HEADER && retry_after_s != NULL &&
+        strcasecmp(evt->header_key, "Retry-After") == 0) {
+        // Delay-seconds form only, as for the manifest
+        *retry_after_s = (uint32_t)strtoul(evt->header_value, NULL, 10);
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief Download from dl->written to the end of the image in one request
+ *
+ * Sends "Range: bytes=<written>-" when resuming. A server that ignores
+ * the range (200) restarts the download from this response's first byte.
+ * Encoded images always start at zero (see ota_decode_begin()).
+ *
+ * @return ESP_OK when the whole image is flashed,
+ *         ESP_ERR_TIMEOUT on a connection error worth retrying,
+ *         ESP_ERR_INVALID_STATE on abort or flash failure,
+ *         ESP_ERR_NOT_FINISHED on 429 / 503 with Retry-After (kept in
+ *         s_ctx.retry_after_s for the poll schedule),
+ *         other codes when the server or image is unusable
+ */
+static esp_err_t ota_fetch_range(ota_download_t *dl, int *last_progress)
+{
+    uint32_t retry_after_s = 0;
     esp_http_client_config_t http_config = {
         .url = s_ctx.manifest.url,
+        .event_handler = ota_image_event_handler,
+        .user_data = &retry_after_s,
         .timeout_ms = s_ctx.config.http_timeout_ms,
         .buffer_size = s_ctx.config.download_buffer_size,
         .buffer_size_tx = 1024,
@@ -841,114 +1682,248 @@ static esp_err_t ota_download_and_flash(void)
     http_config.skip_cert_common_name_check = true;
 #endif
 
-    // Configure OTA
-    esp_https_ota_config_t ota_config = {
-        .http_config = &http_config,
-        .partial_http_download = true,
-        .max_http_request_size = s_ctx.config.download_buffer_size,
-    };
+    esp_http_client_handle_t client = esp_http_client_init(&http_config);
+    if (client == NULL) {
+        ESP_LOGE(TAG, "Failed to initialize HTTP client");
+        return ESP_ERR_NO_MEM;
+    }
+
+    uint32_t offset = dl->written;
+    if (offset > 0) {
+        char range[32];
+        snprintf(range, sizeof(range), "bytes=%lu-", (unsigned long)offset);
+        esp_http_client_set_header(client, "Range", range);
+    }
 
-    // Begin OTA
-    err = esp_https_ota_begin(&ota_config, &https_ota_handle);
+    esp_err_t err = esp_http_client_open(client, 0);
     if (err != ESP_OK) {
-        ESP_LOGE(TAG, "esp_https_ota_begin failed: %s", esp_err_to_name(err));
-        ota_set_error(SECURACV_OTA_ERR_DOWNLOAD_FAILED);
-        return err;
+        ESP_LOGW(TAG, "Connection failed: %s", esp_err_to_name(err));
+        esp_http_client_cleanup(client);
+        return ESP_ERR_TIMEOUT;
     }
 
-    // Get image info
-    esp_app_desc_t new_app_info;
-    err = esp_https_ota_get_img_desc(https_ota_handle, &new_app_info);
-    if (err == ESP_OK) {
-        ESP_LOGI(TAG, "New firmware: %s (version %s)",
-                 new_app_info.project_name, new_app_info.version);
+    int64_t content_length = esp_http_client_fetch_headers(client);
+    int status = esp_http_client_get_status_code(client);
+
+    if (offset > 0 && status == 200) {
+        ESP_LOGW(TAG, "Server ignored Range - downloading from the start");
+        ota_download_restart(dl);
+        offset = 0;
+    } else if (status == 416) {
+        // The checkpoint is past this server's copy; the image is not the one recorded
+        ESP_LOGW(TAG, "Range not satisfiable - downloading from the start");
+        ota_download_restart(dl);
+        esp_http_client_cleanup(client);
+        return ESP_ERR_TIMEOUT;
+    } else if ((status == 429 || status == 503) && retry_after_s > 0) {
+        // The server asked for a pause: no quick retries, the next check waits it out
+        ESP_LOGW(TAG, "HTTP status %d, retry after %lu s", status, (unsigned long)retry_after_s);
+        s_ctx.retry_after_s = retry_after_s;
+        esp_http_client_cleanup(client);
+        return ESP_ERR_NOT_FINISHED;
+    } else if (status != (offset > 0 ? 206 : 200)) {
+        ESP_LOGE(TAG, "HTTP request failed: status=%d", status);
+        esp_http_client_cleanup(client);
+        return status >= 500 ? ESP_ERR_TIMEOUT : ESP_ERR_INVALID_RESPONSE;
+    }
+
+    if (s_ctx.manifest.encoding != SECURACV_OTA_ENCODING_RAW) {
+        // total is the decoded size; the body is checked against transfer_size
+        if (content_length > 0 && s_ctx.manifest.transfer_size != 0 &&
+            content_length != (int64_t)s_ctx.manifest.transfer_size) {
+            ESP_LOGE(TAG, "Size mismatch: server has %lld encoded bytes, expected %lu",
+                     (long long)content_length, (unsigned long)s_ctx.manifest.transfer_size);
+            esp_http_client_cleanup(client);
+            return ESP_ERR_INVALID_SIZE;
+        }
+    } else if (content_length > 0) {
+        uint64_t end = (uint64_t)offset + (uint64_t)content_length;
+        if (dl->total == 0) {
+            dl->total = (uint32_t)end;
+        } else if (end != dl->total) {
+            ESP_LOGE(TAG, "Size mismatch: server has %llu bytes, expected %lu",
+                     (unsigned long long)end, (unsigned long)dl->total);
+            esp_http_client_cleanup(client);
+            return ESP_ERR_INVALID_SIZE;
+        }
+    }
+    if (dl->total == 0 || dl->total > dl->partition->size) {
+        ESP_LOGE(TAG, "Image size unknown or larger than partition %s", dl->partition->label);
+        esp_http_client_cleanup(client);
+        return ESP_ERR_INVALID_SIZE;
     }
 
-    // Get total size for progress calculation
-    int content_length = esp_https_ota_get_image_len_read(https_ota_handle);
-    int total_size = (s_ctx.manifest.size > 0) ? s_ctx.manifest.size : 1;  // Avoid div by zero
+    if (s_ctx.manifest.encoding == SECURACV_OTA_ENCODING_RAW) {
+        err = ota_read_raw(dl, client, last_progress);
+    } else {
+        err = ota_read_encoded(dl, client, last_progress);
+    }
 
-    // Download loop
-    int bytes_read = 0;
-    int last_progress = 0;
+    // A partial sector is dropped; the next attempt asks for it again
+    dl->sector_fill = 0;
+    esp_http_client_close(client);
+    esp_http_client_cleanup(client);
+    return err;
+}
 
-    while (1) {
-        // Check for abort request
-        if (s_ctx.task_should_abort) {
-            ESP_LOGI(TAG, "Download aborted by user");
-            esp_https_ota_abort(https_ota_handle);
-            ota_set_state(SECURACV_OTA_IDLE);
-            return ESP_ERR_TIMEOUT;
+/**
+ * @brief Download firmware and flash to OTA partition
+ *
+ * The image is written straight into the update partition one sector at
+ * a time while it is hashed. Every OTA_RESUME_CHECKPOINT bytes the
+ * flashed length and prefix digest go to NVS, so after a disconnect the
+ * download carries on with a Range request (up to download_retries
+ * times here), and after a reboot the next install attempt does.
+ *
+ * zlib and delta images are decoded into the same sector staging and
+ * hashed after decoding; a delta's base is verified in flash first.
+ * They retry from the start instead of resuming.
+ */
+static esp_err_t ota_download_and_flash(void)
+{
+    esp_err_t err;
+    bool encoded = s_ctx.manifest.encoding != SECURACV_OTA_ENCODING_RAW;
+
+    ota_set_state(SECURACV_OTA_DOWNLOADING);
+
+    ota_download_t dl = {0};
+    dl.partition = esp_ota_get_next_update_partition(NULL);
+    if (dl.partition == NULL) {
+        ESP_LOGE(TAG, "No OTA partition available");
+        ota_set_error(SECURACV_OTA_ERR_PARTITION);
+        return ESP_FAIL;
+    }
+
+    // Room for the 16-byte pad of the image tail
+    dl.sector = (uint8_t *)malloc(OTA_SECTOR_SIZE + 16);
+    if (encoded) {
+        dl.recv = (uint8_t *)malloc(OTA_SECTOR_SIZE);
+    }
+    if (dl.sector == NULL || (encoded && dl.recv == NULL)) {
+        ota_download_free(&dl);
+        ota_set_error(SECURACV_OTA_ERR_OUT_OF_MEMORY);
+        return ESP_ERR_NO_MEM;
+    }
+
+    if (s_ctx.manifest.encoding == SECURACV_OTA_ENCODING_DELTA) {
+        err = ota_check_delta_base(&dl);
+        if (err != ESP_OK) {
+            ota_download_free(&dl);
+            ota_set_error(err == ESP_ERR_INVALID_SIZE || err == ESP_ERR_INVALID_VERSION
+                              ? SECURACV_OTA_ERR_BASE_MISMATCH : SECURACV_OTA_ERR_FLASH_READ);
+            return ESP_FAIL;
         }
+    }
 
-        err = esp_https_ota_perform(https_ota_handle);
+    mbedtls_sha256_init(&dl.sha);
+    mbedtls_sha256_starts(&dl.sha, 0);  // 0 = SHA-256, not SHA-224
+    dl.total = s_ctx.manifest.size;
+    dl.next_checkpoint = OTA_RESUME_CHECKPOINT;
+    if (!encoded) {
+        ota_resume_prepare(&dl);
+    }
 
-        if (err == ESP_ERR_HTTPS_OTA_IN_PROGRESS) {
-            // Update progress
-            bytes_read = esp_https_ota_get_image_len_read(https_ota_handle);
-            int progress = (bytes_read * 100) / total_size;
-            if (progress > 100) progress = 100;
+    ESP_LOGI(TAG, "Downloading firmware from: %s", s_ctx.manifest.url);
 
-            if (progress != last_progress) {
-                ota_report_progress((uint8_t)progress);
-                last_progress = progress;
+    int last_progress = dl.total ? (int)(((uint64_t)dl.written * 100) / dl.total) : 0;
+    ota_report_progress((uint8_t)last_progress);
 
-                if (progress % 10 == 0) {
-                    ESP_LOGI(TAG, "Download progress: %d%% (%d/%d bytes)",
-                             progress, bytes_read, total_size);
-                }
+    uint32_t retry_delay_ms = OTA_RETRY_DELAY_MS;
+    for (uint8_t attempt = 0; ; attempt++) {
+        if (s_ctx.task_should_abort) {
+            err = ESP_ERR_INVALID_STATE;
+            break;
+        }
+        if (encoded) {
+            err = ota_decode_begin(&dl);
+            if (err != ESP_OK) {
+                break;
             }
-            continue;
         }
-
-        if (err == ESP_OK) {
-            // Download complete
+        err = ota_fetch_range(&dl, &last_progress);
+        if (err == ESP_OK || err != ESP_ERR_TIMEOUT || attempt >= s_ctx.config.download_retries) {
             break;
         }
 
-        // Error occurred
-        ESP_LOGE(TAG, "esp_https_ota_perform failed: %s", esp_err_to_name(err));
-        esp_https_ota_abort(https_ota_handle);
-        ota_set_error(SECURACV_OTA_ERR_DOWNLOAD_FAILED);
+        // Persist what made it to flash, then back off and resume
+        if (!encoded && dl.written > 0) {
+            ota_resume_save(&dl);
+        }
+        ESP_LOGI(TAG, "Retrying download in %lu ms (%u/%u)", (unsigned long)retry_delay_ms,
+                 attempt + 1, s_ctx.config.download_retries);
+        for (uint32_t waited = 0; waited < retry_delay_ms && !s_ctx.task_should_abort; waited += 100) {
+            vTaskDelay(pdMS_TO_TICKS(100));
+        }
+        retry_delay_ms = retry_delay_ms * 2 > OTA_RETRY_DELAY_MAX_MS ? OTA_RETRY_DELAY_MAX_MS
+                                                                      : retry_delay_ms * 2;
+    }
+
+    if (err != ESP_OK) {
+        ota_download_free(&dl);
+        if (s_ctx.task_should_abort) {
+            ESP_LOGI(TAG, "Download aborted by user");
+            mbedtls_sha256_free(&dl.sha);
+            ota_resume_clear();
+            ota_set_state(SECURACV_OTA_IDLE);
+            return ESP_ERR_TIMEOUT;
+        }
+        if (!encoded && (err == ESP_ERR_TIMEOUT || err == ESP_ERR_NOT_FINISHED) && dl.written > 0) {
+            // Keep the checkpoint; the next install attempt resumes from it
+            ota_resume_save(&dl);
+        } else {
+            ota_resume_clear();
+        }
+        mbedtls_sha256_free(&dl.sha);
+        ESP_LOGE(TAG, "Download failed: %s", esp_err_to_name(err));
+        securacv_ota_error_t error = SECURACV_OTA_ERR_DOWNLOAD_FAILED;
+        if (err == ESP_ERR_INVALID_STATE) {
+            error = SECURACV_OTA_ERR_FLASH_WRITE;
+        } else if (err == ESP_ERR_NO_MEM) {
+            error = SECURACV_OTA_ERR_OUT_OF_MEMORY;
+        } else if (dl.decoder.status == OTA_DECODE_BASE_MISMATCH) {
+            error = SECURACV_OTA_ERR_BASE_MISMATCH;
+        } else if (dl.decoder.status != OTA_DECODE_OK && dl.stage_err == ESP_OK) {
+            error = SECURACV_OTA_ERR_DECODE;
+        }
+        ota_set_error(error);
         return err;
     }
 
-    // Get final image size
-    image_size = esp_https_ota_get_image_len_read(https_ota_handle);
-    ESP_LOGI(TAG, "Download complete: %zu bytes", image_size);
+    if (encoded) {
+        ESP_LOGI(TAG, "Download complete: %lu bytes decoded from %lu",
+                 (unsigned long)dl.written, (unsigned long)dl.decoder.in_bytes);
+    } else {
+        ESP_LOGI(TAG, "Download complete: %lu bytes", (unsigned long)dl.written);
+    }
+    ota_download_free(&dl);
 
-    // Verify before finishing
+    // The hash was accumulated over exactly the bytes that were flashed, as
+    // each sector went out, so verifying is a compare with no flash read-back
     ota_set_state(SECURACV_OTA_VERIFYING);
 
-    // Get the OTA partition that was written to
-    const esp_partition_t *update_partition = esp_ota_get_next_update_partition(NULL);
-    if (update_partition == NULL) {
-        ESP_LOGE(TAG, "No OTA partition available");
-        esp_https_ota_abort(https_ota_handle);
-        ota_set_error(SECURACV_OTA_ERR_PARTITION);
-        return ESP_FAIL;
-    }
+    uint8_t computed[SHA256_DIGEST_LENGTH];
+    mbedtls_sha256_finish(&dl.sha, computed);
+    mbedtls_sha256_free(&dl.sha);
+    ota_resume_clear();
 
-    // Verify SHA256
-    err = ota_verify_sha256(update_partition, image_size, s_ctx.manifest.sha256);
+    err = ota_verify_sha256(computed);
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "SHA256 verification failed!");
-        esp_https_ota_abort(https_ota_handle);
         ota_set_error(SECURACV_OTA_ERR_SHA256_MISMATCH);
         return ESP_FAIL;
     }
 
     ESP_LOGI(TAG, "SHA256 verification passed");
 
-    // Finish OTA (commit the update)
+    // Validate the image in flash and make it the next boot partition
     ota_set_state(SECURACV_OTA_FLASHING);
 
-    err = esp_https_ota_finish(https_ota_handle);
+    err = esp_ota_set_boot_partition(dl.partition);
     if (err != ESP_OK) {
         if (err == ESP_ERR_OTA_VALIDATE_FAILED) {
             ESP_LOGE(TAG, "OTA image validation failed");
         }
-        ESP_LOGE(TAG, "esp_https_ota_finish failed: %s", esp_err_to_name(err));
+        ESP_LOGE(TAG, "esp_ota_set_boot_partition failed: %s", esp_err_to_name(err));
         ota_set_error(SECURACV_OTA_ERR_FLASH_WRITE);
         return err;
     }
@@ -958,65 +1933,47 @@ static esp_err_t ota_download_and_flash(void)
 }
 
 /**
- * @brief Verify SHA256 hash of downloaded firmware
+ * @brief Feed the first len bytes of a partition into a SHA-256 context
  */
-static esp_err_t ota_verify_sha256(const esp_partition_t *partition, size_t image_size, const char *expected_hex)
+static esp_err_t ota_hash_partition(const esp_partition_t *partition, size_t len,
+                                    mbedtls_sha256_context *ctx)
 {
-    ESP_LOGI(TAG, "Verifying SHA256...");
-
-    // Convert expected hex to bytes
-    if (strlen(expected_hex) != 64) {
-        ESP_LOGE(TAG, "Invalid SHA256 hex length: %zu", strlen(expected_hex));
-        return ESP_FAIL;
-    }
-
-    uint8_t expected[SHA256_DIGEST_LENGTH];
-    hex_to_bytes(expected_hex, expected, SHA256_DIGEST_LENGTH);
-
-    // Calculate SHA256 of flash content
-    mbedtls_sha256_context ctx;
-    mbedtls_sha256_init(&ctx);
-    mbedtls_sha256_starts(&ctx, 0);  // 0 = SHA-256, not SHA-224
-
-    // Read and hash in chunks
     const size_t chunk_size = 4096;
     uint8_t *buffer = (uint8_t *)malloc(chunk_size);
     if (buffer == NULL) {
-        mbedtls_sha256_free(&ctx);
         return ESP_ERR_NO_MEM;
     }
 
-    size_t remaining = image_size;
     size_t offset = 0;
-
-    while (remaining > 0) {
-        size_t to_read = (remaining < chunk_size) ? remaining : chunk_size;
+    while (offset < len) {
+        size_t to_read = (len - offset < chunk_size) ? len - offset : chunk_size;
 
         esp_err_t err = esp_partition_read(partition, offset, buffer, to_read);
         if (err != ESP_OK) {
             ESP_LOGE(TAG, "Failed to read partition at offset %zu: %s",
                      offset, esp_err_to_name(err));
             free(buffer);
-            mbedtls_sha256_free(&ctx);
             return err;
         }
 
-        mbedtls_sha256_update(&ctx, buffer, to_read);
-
+        mbedtls_sha256_update(ctx, buffer, to_read);
         offset += to_read;
-        remaining -= to_read;
     }
 
     free(buffer);
+    return ESP_OK;
+}
 
-    uint8_t computed[SHA256_DIGEST_LENGTH];
-    mbedtls_sha256_finish(&ctx, computed);
-    mbedtls_sha256_free(&ctx);
+/**
+ * @brief Compare the streamed SHA256 digest with the manifest's
+ */
+static esp_err_t ota_verify_sha256(const uint8_t *computed)
+{
+    ESP_LOGI(TAG, "Verifying SHA256...");
 
-    // Compare hashes
-    if (memcmp(computed, expected, SHA256_DIGEST_LENGTH) != 0) {
+    if (memcmp(computed, s_ctx.manifest_sha256, SHA256_DIGEST_LENGTH) != 0) {
         ESP_LOGE(TAG, "SHA256 mismatch!");
-        ESP_LOG_BUFFER_HEX_LEVEL(TAG, expected, SHA256_DIGEST_LENGTH, ESP_LOG_ERROR);
+        ESP_LOG_BUFFER_HEX_LEVEL(TAG, s_ctx.manifest_sha256, SHA256_DIGEST_LENGTH, ESP_LOG_ERROR);
         ESP_LOG_BUFFER_HEX_LEVEL(TAG, computed, SHA256_DIGEST_LENGTH, ESP_LOG_ERROR);
         return ESP_FAIL;
     }
@@ -1086,11 +2043,23 @@ static bool parse_version(const char *version_str, int *major, int *minor, int *
     return (parsed >= 2);  // At least major.minor
 }
 
-static void hex_to_bytes(const char *hex, uint8_t *bytes, size_t byte_len)
+static int hex_nibble(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+static bool hex_to_bytes(const char *hex, uint8_t *bytes, size_t byte_len)
 {
     for (size_t i = 0; i < byte_len; i++) {
-        unsigned int val;
-        sscanf(hex + (i * 2), "%2x", &val);
-        bytes[i] = (uint8_t)val;
+        int hi = hex_nibble(hex[i * 2]);
+        int lo = hi < 0 ? -1 : hex_nibble(hex[i * 2 + 1]);
+        if (lo < 0) {
+            return false;
+        }
+        bytes[i] = (uint8_t)((hi << 4) | lo);
     }
+    return true;
 }
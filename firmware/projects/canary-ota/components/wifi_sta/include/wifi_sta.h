@@ -37,6 +37,16 @@ typedef struct {
     uint32_t timeout_ms;        /**< Connection timeout in milliseconds (0 = no timeout) */
 } wifi_sta_config_t;
 
+/**
+ * @brief Connect latency and fast-reconnect counters
+ */
+typedef struct {
+    uint32_t last_connect_ms;   /**< Last successful connect, start to IP (0 = none yet) */
+    bool last_connect_fast;     /**< Last connect reused the cached BSSID and channel */
+    uint32_t fast_connects;     /**< Connects made on the cached association */
+    uint32_t fast_fallbacks;    /**< Cached attempts that fell back to a full scan */
+} wifi_sta_connect_stats_t;
+
 /**
  * @brief Initialize WiFi in station mode
  *
@@ -60,7 +70,10 @@ esp_err_t wifi_sta_deinit(void);
  * @brief Connect to a WiFi network
  *
  * Initiates connection to the specified WiFi network. This function
- * blocks until connected, failed, or timeout expires.
+ * blocks until connected, failed, or timeout expires. If the last good
+ * BSSID and channel for this SSID are cached, they are tried first (no
+ * scan); a full scan follows if that fails. A lease bound earlier in this
+ * boot is reused as a static address until its T1, otherwise DHCP runs.
  *
  * @param config Connection configuration
  * @return ESP_OK if connected, ESP_ERR_TIMEOUT if timed out,
@@ -95,6 +108,14 @@ esp_err_t wifi_sta_disconnect(void);
  */
 wifi_sta_status_t wifi_sta_get_status(void);
 
+/**
+ * @brief Get connect latency and fast-reconnect counters
+ *
+ * @param stats Filled with the current counters
+ * @return ESP_OK, or ESP_ERR_INVALID_ARG if stats is NULL
+ */
+esp_err_t wifi_sta_get_connect_stats(wifi_sta_connect_stats_t *stats);
+
 /**
  * @brief Check if connected to WiFi
  *
@@ -4,6 +4,14 @@
  *
  * Implements WiFi station mode connectivity using ESP-IDF APIs.
  * Uses event groups for synchronous connection waiting.
+ *
+ * Each successful connect caches the AP's BSSID and channel and the DHCP
+ * lease in NVS. The next connect to the same SSID is first attempted
+ * directed at that AP (no scan); if it has not linked up within
+ * WIFI_FAST_TIMEOUT_MS it falls back to a full scan. DHCP runs from the
+ * start unless a lease bound earlier in this boot is still short of its
+ * renewal time (T1, half the lease): only then is it reused as a static
+ * address, and DHCP takes over when T1 arrives.
  */
 
 #include "wifi_sta.h"
@@ -18,6 +26,9 @@
 #include "esp_event.h"
 #include "esp_log.h"
 #include "esp_netif.h"
+#include "esp_netif_net_stack.h"
+#include "esp_timer.h"
+#include "lwip/dhcp.h"
 #include "nvs_flash.h"
 #include "nvs.h"
 
@@ -34,6 +45,14 @@ static const char *TAG = "wifi_sta";
 #define NVS_NAMESPACE           "wifi"
 #define NVS_KEY_SSID            "ssid"
 #define NVS_KEY_PASSWORD        "password"
+#define NVS_KEY_FAST            "fast"
+
+// Directed reconnect budget before the full scan
+#define WIFI_FAST_TIMEOUT_MS    3000
+#define FAST_CACHE_VERSION      1
+
+// Longest lease trusted for static reuse; longer ones are revalidated daily
+#define WIFI_LEASE_MAX_S        86400
 
 // Event group bits
 #define WIFI_CONNECTED_BIT      BIT0
@@ -50,7 +69,70 @@ static EventGroupHandle_t s_wifi_event_group = NULL;
 static esp_netif_t *s_sta_netif = NULL;
 static wifi_sta_status_t s_status = WIFI_STA_DISCONNECTED;
 static int s_retry_count = 0;
+static int s_max_retry = WIFI_MAX_RETRY;
 static bool s_initialized = false;
+static wifi_sta_connect_stats_t s_stats = {0};
+
+// DHCP lease bound earlier in this boot; the only one reused as static
+static bool s_static_ip = false;
+static int64_t s_lease_start_us = 0;
+static uint32_t s_lease_s = 0;          // 0 = none bound this boot
+static esp_timer_handle_t s_dhcp_timer = NULL;
+
+// Last good association, bound to the SSID it was learned on
+typedef struct {
+    uint8_t version;
+    uint8_t channel;
+    uint8_t bssid[6];
+    esp_netif_ip_info_t ip_info;
+    esp_ip4_addr_t dns;
+    char ssid[33];
+} fast_cache_t;
+
+// ============================================================================
+// DHCP LEASE
+// ============================================================================
+
+static void lease_note(void)
+{
+    struct netif *netif = esp_netif_get_netif_impl(s_sta_netif);
+    if (netif == NULL || !dhcp_supplied_address(netif)) {
+        return;
+    }
+    uint32_t lease_s = netif_dhcp_data(netif)->offered_t0_lease;
+    s_lease_s = lease_s < WIFI_LEASE_MAX_S ? lease_s : WIFI_LEASE_MAX_S;
+    s_lease_start_us = esp_timer_get_time();
+}
+
+// Microseconds until the noted lease reaches T1, 0 if it already has
+static int64_t lease_t1_remaining_us(void)
+{
+    if (s_lease_s == 0) {
+        return 0;
+    }
+    int64_t left = s_lease_start_us + (int64_t)s_lease_s * 500000 - esp_timer_get_time();
+    return left > 0 ? left : 0;
+}
+
+static void start_dhcp(void)
+{
+    if (s_dhcp_timer) {
+        esp_timer_stop(s_dhcp_timer);
+    }
+    s_static_ip = false;
+    esp_netif_dhcpc_start(s_sta_netif);
+}
+
+// T1 of a reused lease: renew it through DHCP
+static void dhcp_timer_cb(void *arg)
+{
+    (void)arg;
+    if (s_static_ip) {
+        ESP_LOGI(TAG, "Reused lease at T1, handing over to DHCP");
+        s_lease_s = 0;  // Noted again once DHCP binds
+        start_dhcp();
+    }
+}
 
 // ============================================================================
 // EVENT HANDLERS
@@ -68,12 +150,12 @@ static void wifi_event_handler(void *arg, esp_event_base_t event_base,
 
             case WIFI_EVENT_STA_DISCONNECTED:
                 s_status = WIFI_STA_DISCONNECTED;
-                if (s_retry_count < WIFI_MAX_RETRY) {
-                    ESP_LOGI(TAG, "Retry connection (%d/%d)", s_retry_count + 1, WIFI_MAX_RETRY);
+                if (s_retry_count < s_max_retry) {
+                    ESP_LOGI(TAG, "Retry connection (%d/%d)", s_retry_count + 1, s_max_retry);
                     esp_wifi_connect();
                     s_retry_count++;
                 } else {
-                    ESP_LOGE(TAG, "Connection failed after %d retries", WIFI_MAX_RETRY);
+                    ESP_LOGE(TAG, "Connection failed after %d retries", s_retry_count);
                     s_status = WIFI_STA_FAILED;
                     if (s_wifi_event_group) {
                         xEventGroupSetBits(s_wifi_event_group, WIFI_FAIL_BIT);
@@ -96,6 +178,10 @@ static void wifi_event_handler(void *arg, esp_event_base_t event_base,
                 ESP_LOGI(TAG, "Got IP address: " IPSTR, IP2STR(&event->ip_info.ip));
                 s_status = WIFI_STA_CONNECTED;
                 s_retry_count = 0;
+                s_max_retry = WIFI_MAX_RETRY;
+                if (!s_static_ip) {
+                    lease_note();
+                }
                 if (s_wifi_event_group) {
                     xEventGroupSetBits(s_wifi_event_group, WIFI_CONNECTED_BIT);
                 }
@@ -113,6 +199,94 @@ static void wifi_event_handler(void *arg, esp_event_base_t event_base,
     }
 }
 
+// ============================================================================
+// FAST RECONNECT CACHE
+// ============================================================================
+
+static bool fast_cache_load(const char *ssid, fast_cache_t *cache)
+{
+    nvs_handle_t nvs;
+    if (nvs_open(NVS_NAMESPACE, NVS_READONLY, &nvs) != ESP_OK) {
+        return false;
+    }
+    size_t len = sizeof(*cache);
+    esp_err_t err = nvs_get_blob(nvs, NVS_KEY_FAST, cache, &len);
+    nvs_close(nvs);
+
+    if (err != ESP_OK || len != sizeof(*cache)) {
+        return false;
+    }
+    cache->ssid[sizeof(cache->ssid) - 1] = '\0';
+    return cache->version == FAST_CACHE_VERSION &&
+           cache->channel >= 1 && cache->channel <= 14 &&
+           cache->ip_info.ip.addr != 0 &&
+           strcmp(cache->ssid, ssid) == 0;
+}
+
+static void fast_cache_save(const char *ssid)
+{
+    fast_cache_t cache;
+    memset(&cache, 0, sizeof(cache));
+    cache.version = FAST_CACHE_VERSION;
+
+    wifi_ap_record_t ap_info;
+    esp_netif_dns_info_t dns;
+    if (esp_wifi_sta_get_ap_info(&ap_info) != ESP_OK ||
+        esp_netif_get_ip_info(s_sta_netif, &cache.ip_info) != ESP_OK) {
+        return;
+    }
+    memcpy(cache.bssid, ap_info.bssid, sizeof(cache.bssid));
+    cache.channel = ap_info.primary;
+    if (esp_netif_get_dns_info(s_sta_netif, ESP_NETIF_DNS_MAIN, &dns) == ESP_OK) {
+        cache.dns = dns.ip.u_addr.ip4;
+    }
+    strncpy(cache.ssid, ssid, sizeof(cache.ssid) - 1);
+
+    // Skip the flash write when nothing changed
+    fast_cache_t old;
+    if (fast_cache_load(ssid, &old) && memcmp(&old, &cache, sizeof(cache)) == 0) {
+        return;
+    }
+
+    nvs_handle_t nvs;
+    if (nvs_open(NVS_NAMESPACE, NVS_READWRITE, &nvs) != ESP_OK) {
+        return;
+    }
+    if (nvs_set_blob(nvs, NVS_KEY_FAST, &cache, sizeof(cache)) == ESP_OK) {
+        nvs_commit(nvs);
+    }
+    nvs_close(nvs);
+}
+
+// Caller checks the lease is short of T1; DHCP takes over when it gets there
+static void apply_static_ip(const fast_cache_t *cache, int64_t t1_remaining_us)
+{
+    s_static_ip = true;
+    esp_netif_dhcpc_stop(s_sta_netif);
+    esp_netif_set_ip_info(s_sta_netif, &cache->ip_info);
+    if (cache->dns.addr != 0) {
+        esp_netif_dns_info_t dns = {0};
+        dns.ip.type = ESP_IPADDR_TYPE_V4;
+        dns.ip.u_addr.ip4 = cache->dns;
+        esp_netif_set_dns_info(s_sta_netif, ESP_NETIF_DNS_MAIN, &dns);
+    }
+    if (s_dhcp_timer) {
+        esp_timer_stop(s_dhcp_timer);
+        esp_timer_start_once(s_dhcp_timer, t1_remaining_us);
+    }
+}
+
+static EventBits_t wait_for_link(TickType_t timeout)
+{
+    return xEventGroupWaitBits(
+        s_wifi_event_group,
+        WIFI_CONNECTED_BIT | WIFI_FAIL_BIT,
+        pdFALSE,
+        pdFALSE,
+        timeout
+    );
+}
+
 // ============================================================================
 // PUBLIC API
 // ============================================================================
@@ -187,6 +361,16 @@ esp_err_t wifi_sta_init(void)
         return err;
     }
 
+    const esp_timer_create_args_t timer_args = {
+        .callback = dhcp_timer_cb,
+        .name = "wifi_dhcp_t1",
+    };
+    err = esp_timer_create(&timer_args, &s_dhcp_timer);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create DHCP timer");
+        return err;
+    }
+
     // Set WiFi mode to station
     err = esp_wifi_set_mode(WIFI_MODE_STA);
     if (err != ESP_OK) {
@@ -209,6 +393,12 @@ esp_err_t wifi_sta_deinit(void)
 
     wifi_sta_disconnect();
 
+    if (s_dhcp_timer) {
+        esp_timer_stop(s_dhcp_timer);
+        esp_timer_delete(s_dhcp_timer);
+        s_dhcp_timer = NULL;
+    }
+
     esp_wifi_stop();
     esp_wifi_deinit();
 
@@ -261,16 +451,34 @@ esp_err_t wifi_sta_connect(const wifi_sta_config_t *config)
     wifi_config.sta.pmf_cfg.capable = true;
     wifi_config.sta.pmf_cfg.required = false;
 
+    // Directed at the last good AP when one is cached. Its lease is reused
+    // only if DHCP bound it this boot and it has not reached T1.
+    fast_cache_t cache;
+    bool fast = fast_cache_load(config->ssid, &cache);
+    int64_t t1_remaining_us = lease_t1_remaining_us();
+    if (fast) {
+        wifi_config.sta.bssid_set = true;
+        memcpy(wifi_config.sta.bssid, cache.bssid, sizeof(wifi_config.sta.bssid));
+        wifi_config.sta.channel = cache.channel;
+    }
+    if (fast && t1_remaining_us > 0) {
+        apply_static_ip(&cache, t1_remaining_us);
+    } else {
+        start_dhcp();
+    }
+
     esp_err_t err = esp_wifi_set_config(WIFI_IF_STA, &wifi_config);
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "esp_wifi_set_config failed: %s", esp_err_to_name(err));
         return err;
     }
 
-    // Clear event bits and retry counter
+    // Clear event bits and retry counter; the directed attempt gets no retries
     xEventGroupClearBits(s_wifi_event_group, WIFI_CONNECTED_BIT | WIFI_FAIL_BIT);
     s_retry_count = 0;
+    s_max_retry = fast ? 0 : WIFI_MAX_RETRY;
     s_status = WIFI_STA_CONNECTING;
+    TickType_t start = xTaskGetTickCount();
 
     // Start WiFi
     err = esp_wifi_start();
@@ -285,16 +493,49 @@ esp_err_t wifi_sta_connect(const wifi_sta_config_t *config)
         timeout = pdMS_TO_TICKS(config->timeout_ms);
     }
 
-    EventBits_t bits = xEventGroupWaitBits(
-        s_wifi_event_group,
-        WIFI_CONNECTED_BIT | WIFI_FAIL_BIT,
-        pdFALSE,
-        pdFALSE,
-        timeout
-    );
+    EventBits_t bits;
+    if (fast) {
+        TickType_t fast_timeout = pdMS_TO_TICKS(WIFI_FAST_TIMEOUT_MS);
+        bits = wait_for_link(fast_timeout < timeout ? fast_timeout : timeout);
+        if (!(bits & WIFI_CONNECTED_BIT)) {
+            ESP_LOGW(TAG, "Cached reconnect failed, falling back to full scan");
+            s_stats.fast_fallbacks++;
+            fast = false;
+
+            // With no retries left the handler reports the disconnect as
+            // FAIL; wait for it so it cannot land on the fresh attempt
+            esp_wifi_disconnect();
+            wait_for_link(pdMS_TO_TICKS(100));
+
+            wifi_config.sta.bssid_set = false;
+            wifi_config.sta.channel = 0;
+            start_dhcp();
+            esp_wifi_set_config(WIFI_IF_STA, &wifi_config);
+
+            xEventGroupClearBits(s_wifi_event_group, WIFI_CONNECTED_BIT | WIFI_FAIL_BIT);
+            s_retry_count = 0;
+            s_max_retry = WIFI_MAX_RETRY;
+            s_status = WIFI_STA_CONNECTING;
+            esp_wifi_connect();
+
+            TickType_t elapsed = xTaskGetTickCount() - start;
+            bits = timeout == portMAX_DELAY ? wait_for_link(portMAX_DELAY) :
+                   elapsed < timeout ? wait_for_link(timeout - elapsed) : 0;
+        }
+    } else {
+        bits = wait_for_link(timeout);
+    }
 
     if (bits & WIFI_CONNECTED_BIT) {
-        ESP_LOGI(TAG, "Connected to %s", config->ssid);
+        s_stats.last_connect_ms = pdTICKS_TO_MS(xTaskGetTickCount() - start);
+        s_stats.last_connect_fast = fast;
+        if (fast) {
+            s_stats.fast_connects++;
+        } else {
+            fast_cache_save(config->ssid);
+        }
+        ESP_LOGI(TAG, "Connected to %s in %u ms%s", config->ssid,
+                 (unsigned)s_stats.last_connect_ms, fast ? " (cached)" : "");
         return ESP_OK;
     } else if (bits & WIFI_FAIL_BIT) {
         ESP_LOGE(TAG, "Failed to connect to %s", config->ssid);
@@ -379,6 +620,15 @@ wifi_sta_status_t wifi_sta_get_status(void)
     return s_status;
 }
 
+esp_err_t wifi_sta_get_connect_stats(wifi_sta_connect_stats_t *stats)
+{
+    if (stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *stats = s_stats;
+    return ESP_OK;
+}
+
 bool wifi_sta_is_connected(void)
 {
     return s_status == WIFI_STA_CONNECTED;
@@ -437,6 +687,8 @@ esp_err_t wifi_sta_save_credentials(const char *ssid, const char *password)
         return err;
     }
 
+    nvs_erase_key(nvs, NVS_KEY_FAST);   // Learned again on the next connect
+
     err = nvs_set_str(nvs, NVS_KEY_SSID, ssid);
     if (err != ESP_OK) {
         nvs_close(nvs);
@@ -470,6 +722,7 @@ esp_err_t wifi_sta_clear_credentials(void)
 
     nvs_erase_key(nvs, NVS_KEY_SSID);
     nvs_erase_key(nvs, NVS_KEY_PASSWORD);
+    nvs_erase_key(nvs, NVS_KEY_FAST);
     err = nvs_commit(nvs);
     nvs_close(nvs);
 
@@ -377,6 +377,15 @@ void app_main(void)
 
     uint32_t loop_count = 0;
     while (1) {
+        // Re-check on the engine's schedule: a jittered interval, with
+        // back-off after failures (and a first check once WiFi is up)
+        if (wifi_sta_is_connected() && securacv_ota_next_poll_ms() == 0) {
+            err = securacv_ota_check_and_install();
+            if (err != ESP_OK) {
+                ESP_LOGW(TAG, "OTA check failed to start: %s", esp_err_to_name(err));
+            }
+        }
+
         // Log status every 30 seconds
         if (loop_count % 30 == 0) {
             securacv_ota_state_t ota_state = securacv_ota_get_state();
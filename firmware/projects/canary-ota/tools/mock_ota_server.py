@@ -16,6 +16,13 @@ USAGE:
     # Start server (serves from current directory):
     python mock_ota_server.py serve
 
+    # Simulate a flaky link: drop each firmware response after 200 KB
+    # (the device resumes with a Range request):
+    python mock_ota_server.py serve --drop-after 204800
+
+    # The manifest is served with ETag / Last-Modified and answers
+    # conditional requests with 304 Not Modified.
+
     # Or just run with defaults:
     python mock_ota_server.py
 
@@ -41,6 +48,8 @@ import sys
 import os
 import argparse
 import functools
+import re
+import email.utils
 from datetime import datetime
 
 # Default settings
@@ -48,6 +57,9 @@ DEFAULT_PORT = 8443
 DEFAULT_PRODUCT = "securacv-canary"
 DEFAULT_VERSION = "1.1.0"
 
+# Raw images, plus zlib and delta transfers from common/tools/ota_patch.py
+FIRMWARE_EXTENSIONS = ('.bin', '.z', '.scvd')
+
 # ANSI colors for output
 class Colors:
     HEADER = '\033[95m'
@@ -171,15 +183,110 @@ def generate_self_signed_cert(cert_path: str = "cert.pem",
 
 class OTARequestHandler(http.server.SimpleHTTPRequestHandler):
     """
-    Custom HTTP request handler with CORS and logging.
+    Custom HTTP request handler with CORS, logging and single byte-range
+    support for resumable firmware downloads.
     """
 
+    # Close firmware responses after this many body bytes (0 = never)
+    drop_after = 0
+
+    # Sent by end_headers(); the manifest asks for revalidation instead
+    cache_control = 'no-store'
+
+    def do_GET(self):
+        """Serve firmware (.bin, .z, .scvd) with Range support, the manifest
+        with validators; everything else as usual."""
+        path = self.translate_path(self.path)
+        if path.endswith('.json') and os.path.isfile(path):
+            return self.send_manifest(path)
+        if not path.endswith(FIRMWARE_EXTENSIONS) or not os.path.isfile(path):
+            return super().do_GET()
+
+        size = os.path.getsize(path)
+        start, end = 0, size - 1
+        status = 200
+
+        range_header = self.headers.get('Range')
+        if range_header:
+            match = re.fullmatch(r'bytes=(\d+)-(\d*)', range_header.strip())
+            if match is None:
+                self.send_error(400, "Unsupported Range")
+                return
+            start = int(match.group(1))
+            if match.group(2):
+                end = min(int(match.group(2)), size - 1)
+            if start >= size or start > end:
+                self.send_response(416)
+                self.send_header('Content-Range', f'bytes */{size}')
+                self.send_header('Content-Length', '0')
+                self.end_headers()
+                return
+            status = 206
+
+        self.send_response(status)
+        self.send_header('Content-Type', 'application/octet-stream')
+        self.send_header('Accept-Ranges', 'bytes')
+        self.send_header('Content-Length', str(end - start + 1))
+        if status == 206:
+            self.send_header('Content-Range', f'bytes {start}-{end}/{size}')
+        self.end_headers()
+
+        remaining = end - start + 1
+        budget = self.drop_after if self.drop_after > 0 else remaining
+        with open(path, 'rb') as f:
+            f.seek(start)
+            while remaining > 0 and budget > 0:
+                chunk = f.read(min(4096, remaining, budget))
+                if not chunk:
+                    break
+                self.wfile.write(chunk)
+                remaining -= len(chunk)
+                budget -= len(chunk)
+
+        if remaining > 0:
+            print(f"{Colors.YELLOW}Dropped connection at byte {end - remaining + 1}{Colors.END}")
+            self.close_connection = True
+
+    def send_manifest(self, path):
+        """Serve a JSON file with ETag / Last-Modified, honouring conditional GETs."""
+        with open(path, 'rb') as f:
+            body = f.read()
+        etag = '"' + hashlib.sha256(body).hexdigest()[:16] + '"'
+        mtime = int(os.path.getmtime(path))
+        last_modified = email.utils.formatdate(mtime, usegmt=True)
+
+        # If-None-Match wins over If-Modified-Since (RFC 9110 13.2.2)
+        not_modified = False
+        if_none_match = self.headers.get('If-None-Match')
+        if if_none_match is not None:
+            not_modified = etag in [t.strip() for t in if_none_match.split(',')]
+        else:
+            if_modified_since = self.headers.get('If-Modified-Since')
+            if if_modified_since:
+                try:
+                    since = email.utils.parsedate_to_datetime(if_modified_since)
+                    not_modified = mtime <= since.timestamp()
+                except (TypeError, ValueError):
+                    pass
+
+        self.cache_control = 'no-cache'
+        self.send_response(304 if not_modified else 200)
+        self.send_header('ETag', etag)
+        self.send_header('Last-Modified', last_modified)
+        if not_modified:
+            self.end_headers()
+            return
+        self.send_header('Content-Type', 'application/json')
+        self.send_header('Content-Length', str(len(body)))
+        self.end_headers()
+        self.wfile.write(body)
+
     def end_headers(self):
         # Add CORS headers
         self.send_header('Access-Control-Allow-Origin', '*')
         self.send_header('Access-Control-Allow-Methods', 'GET, OPTIONS')
         self.send_header('Access-Control-Allow-Headers', '*')
-        self.send_header('Cache-Control', 'no-store')
+        self.send_header('Cache-Control', self.cache_control)
         super().end_headers()
 
     def do_OPTIONS(self):
@@ -210,7 +317,8 @@ class OTARequestHandler(http.server.SimpleHTTPRequestHandler):
 def run_server(port: int = DEFAULT_PORT,
                cert_path: str = "cert.pem",
                key_path: str = "key.pem",
-               directory: str = "."):
+               directory: str = ".",
+               drop_after: int = 0):
     """
     Start the HTTPS server.
 
@@ -219,6 +327,7 @@ def run_server(port: int = DEFAULT_PORT,
         cert_path: Path to SSL certificate
         key_path: Path to SSL private key
         directory: Directory to serve files from
+        drop_after: Cut each firmware response after this many bytes (0 = off)
     """
     # Check for certificate files
     if not os.path.exists(cert_path) or not os.path.exists(key_path):
@@ -237,6 +346,7 @@ def run_server(port: int = DEFAULT_PORT,
     context.load_cert_chain(cert_path, key_path)
 
     # Create handler with directory argument (avoids os.chdir side effects)
+    OTARequestHandler.drop_after = drop_after
     handler_class = functools.partial(OTARequestHandler, directory=directory)
 
     # Create and configure server
@@ -334,6 +444,8 @@ Examples:
                               help='SSL certificate file (default: cert.pem)')
     serve_parser.add_argument('--key', default='key.pem',
                               help='SSL private key file (default: key.pem)')
+    serve_parser.add_argument('--drop-after', type=int, default=0, metavar='BYTES',
+                              help='Drop each firmware response after BYTES (tests resume)')
 
     # generate command
     gen_parser = subparsers.add_parser('generate', help='Generate manifest.json')
@@ -366,9 +478,10 @@ Examples:
         args.directory = '.'
         args.cert = 'cert.pem'
         args.key = 'key.pem'
+        args.drop_after = 0
 
     if args.command == 'serve':
-        run_server(args.port, args.cert, args.key, args.directory)
+        run_server(args.port, args.cert, args.key, args.directory, args.drop_after)
     elif args.command == 'generate':
         generate_manifest(args.firmware, args.version, args.product,
                          args.port, args.output)
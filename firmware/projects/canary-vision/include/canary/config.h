@@ -21,21 +21,76 @@ static constexpr uint32_t DWELL_START_MS      = 10000;
 static constexpr uint32_t DWELL_END_GRACE_MS  = 0;
 
 // Interaction heuristic
-static constexpr uint32_t INTERACTION_AFTER_LEAVE_WINDOW_MS = 3000;
 static constexpr uint32_t ZONE_INTERACTION_MS               = 2500;
 
+// Multi-person tracking (per-frame cost: MAX_DETECTIONS x MAX_TRACKS pairs)
+static constexpr uint8_t  MAX_DETECTIONS     = 8;     // person boxes kept per frame
+static constexpr uint8_t  MAX_TRACKS         = 4;     // extra people are not tracked
+static constexpr int      TRACK_IOU_MIN_PCT  = 20;    // IoU to continue a track
+static constexpr int      TRACK_MAX_JUMP_PX  = 60;    // centroid fallback (fast movers)
+static constexpr uint8_t  TRACK_CONFIRM_HITS = 2;     // frames before a track counts
+
 // Voxel grid
 static constexpr uint8_t VOXEL_COLS = 3;
 static constexpr uint8_t VOXEL_ROWS = 3;
 
+// Occupancy heatmap: decayed dwell milliseconds per cell, on its own grid
+// (finer than the voxel grid), published every HEATMAP_PUBLISH_MS
+static constexpr uint8_t  HEATMAP_ROWS            = 8;
+static constexpr uint8_t  HEATMAP_COLS            = 8;
+static constexpr uint32_t HEATMAP_PUBLISH_MS      = 5UL * 60UL * 1000UL;
+static constexpr uint32_t HEATMAP_DECAY_PERIOD_MS = 60000;
+static constexpr uint16_t HEATMAP_DECAY_Q15       = 29491;  // x0.9 per period (half-life ~6.6 min)
+static constexpr uint32_t HEATMAP_MAX_STEP_MS     = 1000;   // caps credit after a stalled loop
+
 // Frame dims (common SSCMA models)
 static constexpr int FRAME_W = 240;
 static constexpr int FRAME_H = 240;
 
 // Timing
-static constexpr uint32_t INVOKE_PERIOD_MS = 100;
+static constexpr uint32_t INVOKE_PERIOD_MS      = 100;   // while presence is active
+static constexpr uint32_t INVOKE_PERIOD_IDLE_MS = 400;   // empty scene
 static constexpr uint32_t HEARTBEAT_MS     = 5000;
 
+// Vision pipeline: start an invoke, keep the loop running, collect the
+// result when a poll finds it (no ready interrupt on the Grove I2C link)
+static constexpr bool     VISION_ASYNC_INVOKE      = true;
+static constexpr uint32_t VISION_INVOKE_TIMEOUT_MS = 1000;
+static constexpr size_t   VISION_RX_BYTES          = 1024;  // one AT reply line
+static constexpr size_t   VISION_READ_CHUNK        = 64;    // bytes per poll read
+
+// Recorder: print every VisionSample as an "S," trace line on the debug
+// serial for tools/replay.cpp (verbose; development builds only)
+static constexpr bool     VISION_TRACE_SERIAL      = false;
+
 // MQTT / HA
 static constexpr const char* HA_DISCOVERY_PREFIX = "homeassistant";
 static constexpr size_t MQTT_BUFFER_BYTES        = 1536;  // discovery payloads > 256
+
+// Discovery is republished only when its rendered hash differs from the one
+// stored in NVS, or when the broker no longer holds the retained probe
+// config within DISCOVERY_VERIFY_MS of subscribing to it
+static constexpr uint32_t DISCOVERY_VERIFY_MS    = 2000;
+static constexpr const char* NVS_NAMESPACE       = "canary_vision";
+
+// Compact payloads: events, state and heartbeat also go out as CBOR under
+// securacv/<device_id>/cbor/. JSON events and heartbeats are then dropped;
+// JSON state, status and HA discovery stay, since Home Assistant reads them.
+static constexpr bool MQTT_CBOR_PAYLOADS         = false;
+
+// Retained state is republished only when it changes meaningfully
+// (confidence / bbox moves below these steps are ignored), and at least
+// every STATE_REFRESH_MS so presence_ms / uptime stay current
+static constexpr int      STATE_CONFIDENCE_STEP  = 10;    // percent
+static constexpr int      STATE_BBOX_STEP_PX     = 16;
+static constexpr uint32_t STATE_REFRESH_MS       = 60000;
+
+// MQTT reconnect (non-blocking, exponential backoff)
+static constexpr uint32_t MQTT_BACKOFF_MIN_MS    = 1000;
+static constexpr uint32_t MQTT_BACKOFF_MAX_MS    = 60000;
+static constexpr uint16_t MQTT_SOCKET_TIMEOUT_S  = 2;     // bounds one connect attempt
+
+// Offline event queue (RAM; oldest dropped when full)
+static constexpr size_t EVENT_QUEUE_DEPTH        = 16;
+static constexpr size_t EVENT_MAX_BYTES          = 512;
+static constexpr size_t EVENT_DRAIN_PER_LOOP     = 4;
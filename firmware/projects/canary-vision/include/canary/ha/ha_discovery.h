@@ -3,5 +3,13 @@
 #include "canary/topics.h"
 
 namespace canary::ha {
-  void publish_discovery(PubSubClient& mqtt, const Topics& topics);
+  // Publish every retained config; false if any publish failed
+  bool publish_discovery(PubSubClient& mqtt, const Topics& topics);
+
+  // FNV-1a over every rendered topic and payload, so firmware version,
+  // topics and entity set all change it
+  uint32_t discovery_hash(const Topics& topics);
+
+  // One config topic whose retained copy shows the set is still on the broker
+  void discovery_probe_topic(char* out, size_t n);
 }
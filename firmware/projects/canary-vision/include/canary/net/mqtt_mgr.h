@@ -6,17 +6,43 @@
 namespace canary::net {
 
   void mqtt_init(const Topics& topics);
-  void mqtt_loop();
   bool mqtt_connected();
-  void mqtt_reconnect_blocking();
+
+  // Call every loop. Runs the client, makes at most one connect attempt when
+  // the backoff allows, and drains queued events in order. Returns true on
+  // the call that (re)connected, so the caller can republish its state.
+  bool mqtt_service(uint32_t now_ms);
+
+  struct MqttStats {
+    uint32_t connects;
+    uint32_t connect_failures;
+    uint32_t backoff_ms;        // current retry delay
+    uint32_t events_queued;     // waiting for the broker
+    uint32_t events_dropped;    // queue overflow (oldest first)
+  };
+  MqttStats mqtt_stats();
 
   // Publishing
   void publish_status_retained(const Topics& topics, const char* status);   // online/offline
   void publish_heartbeat(const Topics& topics, const StateSnapshot& s);     // online + booleans
   void publish_state_retained(const Topics& topics, const StateSnapshot& s);
-  void publish_event(const Topics& topics, const char* json_payload);       // non-retained
+  // Publishes only if the snapshot's significant fields changed since the
+  // last successful publish, or STATE_REFRESH_MS has passed. Returns true
+  // if it published.
+  bool publish_state_if_changed(const Topics& topics, const StateSnapshot& s, uint32_t now_ms);
+  void publish_event(const Topics& topics, const char* json_payload);       // non-retained, queued while offline
+  void publish_event_cbor(const Topics& topics, const uint8_t* data, size_t len);  // same queue, CBOR tree
+
+  // CBOR event map (keys as in the state map plus e/r/k/q). Returns 0 if it
+  // does not fit.
+  size_t encode_event_cbor(uint8_t* buf, size_t cap, const char* event_name, const char* reason,
+                           uint16_t track_id, uint32_t seq, uint32_t ts_ms, const StateSnapshot& s);
+
+  // Occupancy heatmap (non-retained): row-major cells in deciseconds
+  void publish_heatmap(const Topics& topics, uint8_t rows, uint8_t cols, const uint32_t* cells_ms);
 
-  // HA discovery (retained)
+  // HA discovery (retained): once per boot, and only if the rendered set
+  // changed or its retained copy is missing; see DISCOVERY_VERIFY_MS
   void ha_discovery_publish_once(const Topics& topics);
 
 } // namespace
@@ -0,0 +1,33 @@
+#pragma once
+#include "canary/types.h"
+
+namespace canary::state {
+
+// Zone occupancy without per-frame uplink. Each sample credits the time
+// since the previous one to the cell under every detection's centre;
+// every HEATMAP_DECAY_PERIOD_MS all cells are scaled by HEATMAP_DECAY_Q15,
+// so the map describes recent occupancy. Cells are integer milliseconds,
+// decayed with a Q15 multiply; no floating point per frame.
+class Heatmap {
+public:
+  static constexpr size_t CELLS = (size_t)HEATMAP_ROWS * HEATMAP_COLS;
+
+  void reset(uint32_t now_ms);
+  void add(const VisionSample& vs, uint32_t now_ms);
+
+  // Dwell per cell in ms, row-major, decayed up to now_ms first so a map
+  // published after a quiet spell does not report stale occupancy
+  const uint32_t* cells(uint32_t now_ms) {
+    decay_to(now_ms);
+    return cells_;
+  }
+
+private:
+  void decay_to(uint32_t now_ms);
+
+  uint32_t cells_[CELLS] = {};
+  uint32_t last_sample_ms_ = 0;
+  uint32_t last_decay_ms_ = 0;
+};
+
+} // namespace canary::state
@@ -4,37 +4,55 @@
 
 namespace canary::state {
 
+// Scene presence plus one track per person. Detections are matched to
+// tracks greedily by IoU (centroid distance as a fallback), so each frame
+// costs at most MAX_DETECTIONS x MAX_TRACKS comparisons.
+//
+// Events:
+//   presence_started / presence_ended   scene-level (track_id 0)
+//   dwell_started / dwell_ended         per track
+//   interaction_likely                  per track, as a qualified track ends
 class PresenceFSM {
 public:
+  static constexpr size_t MAX_EVENTS = 2 + 3 * MAX_TRACKS;
+
   void reset();
-  // returns true if an event was emitted
-  bool tick(const VisionSample& vs, uint32_t now_ms, EventMsg& out_event);
+  // Writes up to max_events into out; returns how many were emitted
+  size_t tick(const VisionSample& vs, uint32_t now_ms, EventMsg* out, size_t max_events);
 
-  StateSnapshot snapshot(uint32_t now_ms, const char* last_event) const;
+  // Scene summary; the detail fields describe track_id (empty once that
+  // track has ended), or the oldest track when track_id is 0
+  StateSnapshot snapshot(uint32_t now_ms, const char* last_event, uint16_t track_id = 0) const;
+  bool presence() const { return presence_; }
 
 private:
-  // state
-  bool presence_=false;
-  bool dwelling_=false;
+  struct Track {
+    bool active=false;
+    bool confirmed=false;
+    bool seen=false;          // matched in the latest frame
+    uint16_t id=0;
+    uint8_t hits=0;
 
-  uint32_t presence_start_ms_=0;
-  uint32_t last_seen_ms_=0;
-  uint32_t dwell_start_ms_=0;
-  uint32_t last_leave_ms_=0;
+    BBox bbox{};
+    VoxelTracker voxel;
 
-  bool interaction_candidate_=false;
+    uint32_t first_seen_ms=0;
+    uint32_t last_seen_ms=0;
+    uint32_t dwell_start_ms=0;
 
-  // interaction tracking
-  bool dwell_latch_=false;
-  bool interaction_latch_=false;
-  bool interaction_emitted_=false;
-  uint32_t last_leave_seen_=0;
+    bool dwelling=false;
+    bool interaction_candidate=false;
+  };
 
-  // current
-  BBox bbox_{};
-  int confidence_=0;
+  void associate(const VisionSample& vs, int8_t* match) const;
+  const Track* primary(uint16_t track_id) const;
+
+  // scene
+  bool presence_=false;
+  uint32_t presence_start_ms_=0;
+  uint16_t next_id_=1;
 
-  VoxelTracker voxel_tracker_;
+  Track tracks_[MAX_TRACKS];
 };
 
 } // namespace
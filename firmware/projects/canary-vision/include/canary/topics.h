@@ -6,6 +6,13 @@ struct Topics {
   char events[96];
   char state[96];
   char status[96];
+  char heatmap[96];
+
+  // CBOR tree (MQTT_CBOR_PAYLOADS)
+  char cbor_events[96];
+  char cbor_heatmap[96];
+  char cbor_state[96];
+  char cbor_heartbeat[96];
 };
 
 static inline Topics build_topics() {
@@ -13,5 +20,10 @@ static inline Topics build_topics() {
   snprintf(t.events, sizeof(t.events), "securacv/%s/events", DEVICE_ID);
   snprintf(t.state,  sizeof(t.state),  "securacv/%s/state",  DEVICE_ID);
   snprintf(t.status, sizeof(t.status), "securacv/%s/status", DEVICE_ID);
+  snprintf(t.heatmap, sizeof(t.heatmap), "securacv/%s/heatmap", DEVICE_ID);
+  snprintf(t.cbor_events,    sizeof(t.cbor_events),    "securacv/%s/cbor/events",    DEVICE_ID);
+  snprintf(t.cbor_heatmap,   sizeof(t.cbor_heatmap),   "securacv/%s/cbor/heatmap",   DEVICE_ID);
+  snprintf(t.cbor_state,     sizeof(t.cbor_state),     "securacv/%s/cbor/state",     DEVICE_ID);
+  snprintf(t.cbor_heartbeat, sizeof(t.cbor_heartbeat), "securacv/%s/cbor/heartbeat", DEVICE_ID);
   return t;
 }
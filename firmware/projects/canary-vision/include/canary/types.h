@@ -1,5 +1,6 @@
 #pragma once
 #include <stdint.h>
+#include "canary/config.h"
 
 struct BBox {
   int x=0, y=0, w=0, h=0;
@@ -26,10 +27,20 @@ struct Voxel {
 
 
 
+struct Detection {
+  BBox bbox;
+  Voxel voxel;
+};
+
 struct VisionSample {
+  // Best box (highest score)
   bool person_now=false;
   BBox bbox;
   Voxel voxel;
+
+  // Every person box above SCORE_MIN, highest score first
+  uint8_t count=0;
+  Detection det[MAX_DETECTIONS];
 };
 
 struct StateSnapshot {
@@ -43,6 +54,9 @@ struct StateSnapshot {
   Voxel voxel;
   BBox bbox;
 
+  uint8_t tracks=0;       // people currently tracked
+  uint16_t track_id=0;    // track the fields above describe (0 = none)
+
   const char* last_event="boot";
   uint32_t uptime_s=0;
   uint32_t ts_ms=0;
@@ -51,4 +65,5 @@ struct StateSnapshot {
 struct EventMsg {
   const char* event_name=nullptr;
   const char* reason=nullptr;
+  uint16_t track_id=0;    // 0 for scene-level events
 };
@@ -3,5 +3,14 @@
 
 namespace canary::vision {
   void init();
-  bool sample(VisionSample& out); // returns true if sample is valid
+  bool sample(VisionSample& out); // blocking invoke; returns true if sample is valid
+
+  // Async invoke: start() sends one AT+INVOKE and returns; poll() reads
+  // whatever the module has produced so far and returns true once, when
+  // the result is complete. An invoke with no reply after
+  // VISION_INVOKE_TIMEOUT_MS is abandoned; each invoke carries its own
+  // request id, so a late reply to it is ignored.
+  bool start();
+  bool busy();
+  bool poll(VisionSample& out);
 }
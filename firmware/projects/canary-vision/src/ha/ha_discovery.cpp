@@ -22,7 +22,14 @@ static bool publish_cfg(PubSubClient& mqtt, const char* topic, const char* paylo
   return ok;
 }
 
-void publish_discovery(PubSubClient& mqtt, const Topics& topics) {
+static void probe_topic_for(char* out, size_t n) {
+  snprintf(out, n, "%s/%s/%s/%s/config", HA_DISCOVERY_PREFIX, "binary_sensor", DEVICE_ID, "presence");
+}
+
+// Called once per rendered config (topic, payload)
+using ConfigSink = void (*)(const char* topic, const char* payload, void* ctx);
+
+static void render_discovery(const Topics& topics, ConfigSink sink, void* ctx) {
   char devObj[256];
   snprintf(devObj, sizeof(devObj),
            "\"device\":{"
@@ -42,6 +49,7 @@ void publish_discovery(PubSubClient& mqtt, const Topics& topics) {
            "\"payload_not_available\":\"offline\"",
            topics.status);
 
+  // The presence topic must match probe_topic_for()
   auto topic_for = [&](const char* component, const char* objectId, char* out, size_t n) {
     snprintf(out, n, "%s/%s/%s/%s/config", HA_DISCOVERY_PREFIX, component, DEVICE_ID, objectId);
   };
@@ -63,7 +71,7 @@ void publish_discovery(PubSubClient& mqtt, const Topics& topics) {
              "%s,%s"
              "}",
              DEVICE_ID, topics.state, availObj, devObj);
-    publish_cfg(mqtt, t, p);
+    sink(t, p, ctx);
   }
 
   // Dwelling
@@ -82,7 +90,7 @@ void publish_discovery(PubSubClient& mqtt, const Topics& topics) {
              "%s,%s"
              "}",
              DEVICE_ID, topics.state, availObj, devObj);
-    publish_cfg(mqtt, t, p);
+    sink(t, p, ctx);
   }
 
   // Confidence
@@ -100,7 +108,7 @@ void publish_discovery(PubSubClient& mqtt, const Topics& topics) {
              "%s,%s"
              "}",
              DEVICE_ID, topics.state, availObj, devObj);
-    publish_cfg(mqtt, t, p);
+    sink(t, p, ctx);
   }
 
   // Voxel
@@ -117,7 +125,7 @@ void publish_discovery(PubSubClient& mqtt, const Topics& topics) {
              "%s,%s"
              "}",
              DEVICE_ID, topics.state, availObj, devObj);
-    publish_cfg(mqtt, t, p);
+    sink(t, p, ctx);
   }
 
   // Last event
@@ -134,7 +142,7 @@ void publish_discovery(PubSubClient& mqtt, const Topics& topics) {
              "%s,%s"
              "}",
              DEVICE_ID, topics.state, availObj, devObj);
-    publish_cfg(mqtt, t, p);
+    sink(t, p, ctx);
   }
 
   // Uptime
@@ -153,10 +161,44 @@ void publish_discovery(PubSubClient& mqtt, const Topics& topics) {
              "%s,%s"
              "}",
              DEVICE_ID, topics.state, availObj, devObj);
-    publish_cfg(mqtt, t, p);
+    sink(t, p, ctx);
   }
 
-  log_line("DISC", "Home Assistant discovery published (retained).");
+}
+
+struct PublishCtx {
+  PubSubClient* mqtt;
+  bool ok;
+};
+
+bool publish_discovery(PubSubClient& mqtt, const Topics& topics) {
+  PublishCtx ctx{ &mqtt, true };
+  render_discovery(topics, [](const char* topic, const char* payload, void* c) {
+    PublishCtx* pc = static_cast<PublishCtx*>(c);
+    pc->ok = publish_cfg(*pc->mqtt, topic, payload) && pc->ok;
+  }, &ctx);
+
+  log_line("DISC", ctx.ok ? "Home Assistant discovery published (retained)."
+                          : "Home Assistant discovery publish incomplete.");
+  return ctx.ok;
+}
+
+uint32_t discovery_hash(const Topics& topics) {
+  uint32_t h = 2166136261u;
+  render_discovery(topics, [](const char* topic, const char* payload, void* c) {
+    uint32_t& hh = *static_cast<uint32_t*>(c);
+    for (const char* s : { topic, "\n", payload, "\n" }) {
+      for (; *s; s++) {
+        hh ^= (uint8_t)*s;
+        hh *= 16777619u;
+      }
+    }
+  }, &h);
+  return h;
+}
+
+void discovery_probe_topic(char* out, size_t n) {
+  probe_topic_for(out, n);
 }
 
 } // namespace canary::ha
@@ -20,13 +20,46 @@
 #include "canary/net/mqtt_mgr.h"
 #include "canary/vision/vision_mgr.h"
 #include "canary/state/presence_fsm.h"
+#include "canary/state/heatmap.h"
 
 static Topics TOPICS;
 static canary::state::PresenceFSM fsm;
+static canary::state::Heatmap heatmap;
 
 static char last_event_name[48] = "boot";
 static uint32_t last_invoke_ms = 0;
 static uint32_t last_heartbeat_ms = 0;
+static uint32_t last_heatmap_ms = 0;
+
+// Next vision sample at the presence-dependent cadence. Async mode keeps
+// an invoke in flight and returns without waiting for the module.
+static bool next_sample(uint32_t now_ms, VisionSample& vs) {
+  const uint32_t period = fsm.presence() ? INVOKE_PERIOD_MS : INVOKE_PERIOD_IDLE_MS;
+
+  if (!VISION_ASYNC_INVOKE) {
+    if ((now_ms - last_invoke_ms) < period) return false;
+    last_invoke_ms = now_ms;
+    return canary::vision::sample(vs);
+  }
+
+  if (!canary::vision::busy() && (now_ms - last_invoke_ms) >= period) {
+    last_invoke_ms = now_ms;
+    canary::vision::start();
+  }
+  return canary::vision::poll(vs);
+}
+
+// Trace line for tools/replay.cpp: S,<ts>,<count>[,x,y,w,h,score,r,c]...
+static void trace_sample(uint32_t now_ms, const VisionSample& vs) {
+  auto& out = canary::dbg_serial();
+  out.printf("S,%lu,%u", (unsigned long)now_ms, (unsigned)vs.count);
+  for (uint8_t i = 0; i < vs.count; i++) {
+    const Detection& d = vs.det[i];
+    out.printf(",%d,%d,%d,%d,%d,%d,%d", d.bbox.x, d.bbox.y, d.bbox.w, d.bbox.h,
+               d.bbox.score, d.voxel.r, d.voxel.c);
+  }
+  out.printf("\n");
+}
 
 static void set_last_event(const char* e) {
   strncpy(last_event_name, e ? e : "boot", sizeof(last_event_name) - 1);
@@ -35,7 +68,7 @@ static void set_last_event(const char* e) {
 
 static void publish_state_now(uint32_t now_ms) {
   const auto snap = fsm.snapshot(now_ms, last_event_name);
-  canary::net::publish_state_retained(TOPICS, snap);
+  canary::net::publish_state_if_changed(TOPICS, snap, now_ms);
 }
 
 static void publish_heartbeat_now(uint32_t now_ms) {
@@ -44,15 +77,26 @@ static void publish_heartbeat_now(uint32_t now_ms) {
 }
 
 static void publish_event_json(
-  const char* event_name,
-  const char* reason,
+  const EventMsg& ev,
   uint32_t now_ms,
   const VisionSample& vs
 ) {
   (void)vs;
   static uint32_t seq = 0;
+  const char* event_name = ev.event_name;
+  const char* reason = ev.reason;
+
+  // Track events describe their own track; scene events the oldest one
+  const auto snap = fsm.snapshot(now_ms, last_event_name, ev.track_id);
+
+  if (MQTT_CBOR_PAYLOADS) {
+    uint8_t buf[160];
+    const size_t len = canary::net::encode_event_cbor(buf, sizeof(buf), event_name, reason,
+                                                       ev.track_id, ++seq, now_ms, snap);
+    if (len > 0) canary::net::publish_event_cbor(TOPICS, buf, len);
+    return;
+  }
 
-  const auto snap = fsm.snapshot(now_ms, last_event_name);
   char msg[768];
 
   if (reason) {
@@ -62,6 +106,8 @@ static void publish_event_json(
         "\"device_type\":\"%s\","
         "\"event\":\"%s\","
         "\"reason\":\"%s\","
+        "\"track_id\":%u,"
+        "\"tracks\":%u,"
         "\"seq\":%lu,"
         "\"ts_ms\":%lu,"
         "\"presence_ms\":%lu,"
@@ -72,6 +118,7 @@ static void publish_event_json(
       "}",
       DEVICE_ID, DEVICE_TYPE,
       event_name, reason,
+      (unsigned)ev.track_id, (unsigned)snap.tracks,
       (unsigned long)(++seq),
       (unsigned long)now_ms,
       (unsigned long)snap.presence_ms,
@@ -86,6 +133,8 @@ static void publish_event_json(
         "\"device_id\":\"%s\","
         "\"device_type\":\"%s\","
         "\"event\":\"%s\","
+        "\"track_id\":%u,"
+        "\"tracks\":%u,"
         "\"seq\":%lu,"
         "\"ts_ms\":%lu,"
         "\"presence_ms\":%lu,"
@@ -96,6 +145,7 @@ static void publish_event_json(
       "}",
       DEVICE_ID, DEVICE_TYPE,
       event_name,
+      (unsigned)ev.track_id, (unsigned)snap.tracks,
       (unsigned long)(++seq),
       (unsigned long)now_ms,
       (unsigned long)snap.presence_ms,
@@ -125,62 +175,62 @@ void setup() {
   );
 
   fsm.reset();
+  heatmap.reset(canary::ms_now());
 
   canary::net::wifi_init_or_reboot();
   canary::net::mqtt_init(TOPICS);
   canary::vision::init();
 
-  canary::net::mqtt_reconnect_blocking();
-  canary::net::ha_discovery_publish_once(TOPICS);
-
-  canary::net::publish_status_retained(TOPICS, "online");
-
   set_last_event("boot");
-  publish_state_now(canary::ms_now());
-  delay(250);
-  publish_state_now(canary::ms_now());
+
+  // First attempt now; if the broker is down, loop() keeps retrying while
+  // detection runs and events queue until it is back.
+  if (canary::net::mqtt_service(canary::ms_now())) {
+    publish_state_now(canary::ms_now());
+  }
 
   last_invoke_ms = canary::ms_now();
   last_heartbeat_ms = canary::ms_now();
+  last_heatmap_ms = canary::ms_now();
 
   canary::log_line("RUN", "Loop started.");
 }
 
 void loop() {
-  if (!canary::net::mqtt_connected()) {
-    canary::log_line("MQTT", "Disconnected. Reconnecting...");
-    canary::net::mqtt_reconnect_blocking();
-    canary::net::publish_status_retained(TOPICS, "online");
-    publish_state_now(canary::ms_now());
-    delay(250);
-    publish_state_now(canary::ms_now());
-  }
-
-  canary::net::mqtt_loop();
-
   const uint32_t now_ms = canary::ms_now();
 
+  // Never blocks beyond one bounded connect attempt; status and discovery
+  // are republished inside on reconnect
+  if (canary::net::mqtt_service(now_ms)) {
+    publish_state_now(now_ms);
+  }
+
   if ((now_ms - last_heartbeat_ms) > HEARTBEAT_MS) {
     last_heartbeat_ms = now_ms;
     publish_heartbeat_now(now_ms);
     publish_state_now(now_ms);
   }
 
-  if ((now_ms - last_invoke_ms) < INVOKE_PERIOD_MS) {
-    delay(5);
-    return;
+  if ((now_ms - last_heatmap_ms) >= HEATMAP_PUBLISH_MS) {
+    last_heatmap_ms = now_ms;
+    canary::net::publish_heatmap(TOPICS, HEATMAP_ROWS, HEATMAP_COLS, heatmap.cells(now_ms));
   }
-  last_invoke_ms = now_ms;
 
   VisionSample vs{};
-  if (!canary::vision::sample(vs)) return;
+  if (!next_sample(now_ms, vs)) {
+    delay(VISION_ASYNC_INVOKE ? 1 : 5);
+    return;
+  }
 
-  EventMsg ev{};
-  const bool emitted = fsm.tick(vs, now_ms, ev);
+  if (VISION_TRACE_SERIAL) trace_sample(now_ms, vs);
+  heatmap.add(vs, now_ms);
 
-  if (emitted && ev.event_name) {
-    set_last_event(ev.event_name);
-    publish_event_json(ev.event_name, ev.reason, now_ms, vs);
-    publish_state_now(now_ms);
+  EventMsg events[canary::state::PresenceFSM::MAX_EVENTS];
+  const size_t emitted = fsm.tick(vs, now_ms, events, canary::state::PresenceFSM::MAX_EVENTS);
+
+  for (size_t i = 0; i < emitted; i++) {
+    set_last_event(events[i].event_name);
+    publish_event_json(events[i], now_ms, vs);
   }
+  if (emitted > 0) publish_state_now(now_ms);
 }
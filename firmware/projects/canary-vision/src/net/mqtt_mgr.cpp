@@ -6,10 +6,12 @@
 
 #include <WiFi.h>
 #include <PubSubClient.h>
+#include <Preferences.h>
 
 #include "canary/config.h"
 #include "canary/log.h"
 #include "canary/ha/ha_discovery.h"
+#include "encoding/cbor.h"
 
 // Prefer local dev secrets if present; otherwise use CI stub.
 // IMPORTANT: the CI header must live at: include/secrets/secrets.ci.h
@@ -26,6 +28,37 @@ static PubSubClient mqtt(wifiClient);
 static Topics g_topics{};
 static bool discovery_done = false;
 
+// Discovery probe: waiting for the retained copy of one config
+static bool discovery_verifying = false;
+static bool discovery_seen = false;
+static uint32_t discovery_hash_now = 0;
+static uint32_t discovery_verify_ms = 0;
+static char discovery_probe[192];
+static void on_message(char* topic, uint8_t* payload, unsigned int len);
+
+// Last successfully published state
+static uint32_t state_hash = 0;
+static bool state_published = false;
+static uint32_t state_published_ms = 0;
+
+// Reconnect state
+static uint32_t next_attempt_ms = 0;
+static uint32_t backoff_ms = MQTT_BACKOFF_MIN_MS;
+static bool was_connected = false;
+static uint32_t connects = 0;
+static uint32_t connect_failures = 0;
+
+// Offline event queue: ring of fixed-size payloads, published in order
+struct QueuedEvent {
+  uint8_t payload[EVENT_MAX_BYTES];
+  uint16_t len;
+  bool cbor;
+};
+static QueuedEvent event_queue[EVENT_QUEUE_DEPTH];
+static size_t event_head = 0;
+static size_t event_count = 0;
+static uint32_t events_dropped = 0;
+
 static bool publish_checked(const char* tag, const char* topic, const char* payload, bool retain) {
   const bool ok = mqtt.publish(topic, payload, retain);
 
@@ -39,15 +72,66 @@ static bool publish_checked(const char* tag, const char* topic, const char* payl
   return ok;
 }
 
+static bool publish_bytes_checked(const char* tag, const char* topic,
+                                  const uint8_t* data, size_t len, bool retain) {
+  const bool ok = mqtt.publish(topic, data, (unsigned)len, retain);
+
+  log_header(tag);
+  canary::dbg_serial().printf("%s => %s (retain=%s len=%u cbor)\n",
+                              topic,
+                              ok ? "OK" : "FAIL",
+                              retain ? "true" : "false",
+                              (unsigned)len);
+  return ok;
+}
+
+// Compact keys; the topic carries device_type. Arrays mirror the JSON objects:
+// v = [rows, cols, r, c], b = [x, y, w, h].
+static void cbor_snapshot_fields(cbor_writer_t* w, const StateSnapshot& s) {
+  CBOR_KV_BOOL(w, "p", s.presence);
+  CBOR_KV_BOOL(w, "w", s.dwelling);
+  CBOR_KV_UINT(w, "pm", s.presence_ms);
+  CBOR_KV_UINT(w, "dm", s.dwell_ms);
+  CBOR_KV_INT(w, "c", s.confidence);
+  CBOR_KV_UINT(w, "n", s.tracks);
+  cbor_write_tstr(w, "v");
+  cbor_write_array(w, 4);
+  cbor_write_uint(w, s.voxel.rows);
+  cbor_write_uint(w, s.voxel.cols);
+  cbor_write_int(w, s.voxel.r);
+  cbor_write_int(w, s.voxel.c);
+  cbor_write_tstr(w, "b");
+  cbor_write_array(w, 4);
+  cbor_write_int(w, s.bbox.x);
+  cbor_write_int(w, s.bbox.y);
+  cbor_write_int(w, s.bbox.w);
+  cbor_write_int(w, s.bbox.h);
+}
+
 void mqtt_init(const Topics& topics) {
   g_topics = topics;
   mqtt.setServer(MQTT_HOST, MQTT_PORT);
   mqtt.setBufferSize(MQTT_BUFFER_BYTES);
+  mqtt.setSocketTimeout(MQTT_SOCKET_TIMEOUT_S);
+  mqtt.setCallback(on_message);
 }
 
 bool mqtt_connected() { return mqtt.connected(); }
 
-void mqtt_loop() { mqtt.loop(); }
+size_t encode_event_cbor(uint8_t* buf, size_t cap, const char* event_name, const char* reason,
+                         uint16_t track_id, uint32_t seq, uint32_t ts_ms, const StateSnapshot& s) {
+  cbor_writer_t w;
+  cbor_init(&w, buf, cap);
+  cbor_write_map(&w, reason ? 14 : 13);
+  CBOR_KV_STR(&w, "d", DEVICE_ID);
+  CBOR_KV_STR(&w, "e", event_name);
+  if (reason) CBOR_KV_STR(&w, "r", reason);
+  CBOR_KV_UINT(&w, "k", track_id);
+  CBOR_KV_UINT(&w, "q", seq);
+  CBOR_KV_UINT(&w, "t", ts_ms);
+  cbor_snapshot_fields(&w, s);
+  return cbor_has_error(&w) ? 0 : cbor_size(&w);
+}
 
 void publish_status_retained(const Topics& topics, const char* status) {
   char msg[256];
@@ -66,6 +150,21 @@ void publish_status_retained(const Topics& topics, const char* status) {
 }
 
 void publish_heartbeat(const Topics& topics, const StateSnapshot& s) {
+  if (MQTT_CBOR_PAYLOADS) {
+    uint8_t buf[64];
+    cbor_writer_t w;
+    cbor_init(&w, buf, sizeof(buf));
+    cbor_write_map(&w, 4);
+    CBOR_KV_STR(&w, "d", DEVICE_ID);
+    CBOR_KV_BOOL(&w, "p", s.presence);
+    CBOR_KV_BOOL(&w, "w", s.dwelling);
+    CBOR_KV_UINT(&w, "t", ms_now());
+    if (!cbor_has_error(&w)) {
+      publish_bytes_checked("HEART", topics.cbor_heartbeat, buf, cbor_size(&w), true);
+    }
+    return;
+  }
+
   char msg[256];
   snprintf(msg, sizeof(msg),
            "{"
@@ -94,6 +193,7 @@ void publish_state_retained(const Topics& topics, const StateSnapshot& s) {
            "\"presence_ms\":%lu,"
            "\"dwell_ms\":%lu,"
            "\"confidence\":%d,"
+           "\"tracks\":%u,"
            "\"voxel\":{\"rows\":%u,\"cols\":%u,\"r\":%d,\"c\":%d},"
            "\"bbox\":{\"x\":%d,\"y\":%d,\"w\":%d,\"h\":%d},"
            "\"last_event\":\"%s\","
@@ -106,26 +206,224 @@ void publish_state_retained(const Topics& topics, const StateSnapshot& s) {
            (unsigned long)s.presence_ms,
            (unsigned long)s.dwell_ms,
            (int)s.confidence,
+           (unsigned)s.tracks,
            (unsigned)s.voxel.rows, (unsigned)s.voxel.cols, s.voxel.r, s.voxel.c,
            s.bbox.x, s.bbox.y, s.bbox.w, s.bbox.h,
            s.last_event ? s.last_event : "boot",
            (unsigned long)s.uptime_s,
            (unsigned long)s.ts_ms);
 
-  publish_checked("STATE", topics.state, msg, true);
+  bool ok = publish_checked("STATE", topics.state, msg, true);
+
+  if (MQTT_CBOR_PAYLOADS) {
+    uint8_t buf[128];
+    cbor_writer_t w;
+    cbor_init(&w, buf, sizeof(buf));
+    cbor_write_map(&w, 12);
+    CBOR_KV_STR(&w, "d", DEVICE_ID);
+    cbor_snapshot_fields(&w, s);
+    CBOR_KV_STR(&w, "le", s.last_event ? s.last_event : "boot");
+    CBOR_KV_UINT(&w, "up", s.uptime_s);
+    CBOR_KV_UINT(&w, "t", s.ts_ms);
+    ok = !cbor_has_error(&w) &&
+         publish_bytes_checked("STATE", topics.cbor_state, buf, cbor_size(&w), true) && ok;
+  }
+
+  if (ok) {
+    state_published = true;
+    state_published_ms = s.ts_ms;
+  }
+}
+
+// FNV-1a over the fields a subscriber acts on. Timers and uptime are left
+// out; confidence and bbox are quantized so detector jitter is not a change.
+static uint32_t state_signature(const StateSnapshot& s) {
+  uint32_t h = 2166136261u;
+  auto mix = [&h](int32_t v) {
+    for (int i = 0; i < 4; i++) {
+      h ^= (uint8_t)(v >> (8 * i));
+      h *= 16777619u;
+    }
+  };
+  mix(s.presence);
+  mix(s.dwelling);
+  mix(s.confidence / STATE_CONFIDENCE_STEP);
+  mix(s.tracks);
+  mix(s.voxel.r);
+  mix(s.voxel.c);
+  mix(s.bbox.x / STATE_BBOX_STEP_PX);
+  mix(s.bbox.y / STATE_BBOX_STEP_PX);
+  mix(s.bbox.w / STATE_BBOX_STEP_PX);
+  mix(s.bbox.h / STATE_BBOX_STEP_PX);
+  for (const char* p = s.last_event ? s.last_event : "boot"; *p; p++) {
+    h ^= (uint8_t)*p;
+    h *= 16777619u;
+  }
+  return h;
+}
+
+bool publish_state_if_changed(const Topics& topics, const StateSnapshot& s, uint32_t now_ms) {
+  const uint32_t sig = state_signature(s);
+  if (state_published && sig == state_hash && (now_ms - state_published_ms) < STATE_REFRESH_MS) {
+    return false;
+  }
+  state_published = false;
+  publish_state_retained(topics, s);
+  if (state_published) state_hash = sig;
+  return state_published;
+}
+
+void publish_heatmap(const Topics& topics, uint8_t rows, uint8_t cols, const uint32_t* cells_ms) {
+  const size_t n = (size_t)rows * cols;
+  auto ds = [&](size_t i) { return (unsigned long)(cells_ms[i] / 100); };
+
+  if (MQTT_CBOR_PAYLOADS) {
+    static uint8_t buf[32 + 256 * 5];  // static: too large for the loop stack
+    cbor_writer_t w;
+    cbor_init(&w, buf, sizeof(buf));
+    cbor_write_map(&w, 5);
+    CBOR_KV_STR(&w, "d", DEVICE_ID);
+    CBOR_KV_UINT(&w, "t", ms_now());
+    CBOR_KV_UINT(&w, "hc", cols);
+    CBOR_KV_UINT(&w, "hr", rows);
+    cbor_write_tstr(&w, "h");
+    cbor_write_array(&w, n);
+    for (size_t i = 0; i < n; i++) cbor_write_uint(&w, ds(i));
+    if (!cbor_has_error(&w)) {
+      publish_bytes_checked("HEAT", topics.cbor_heatmap, buf, cbor_size(&w), false);
+    }
+    return;
+  }
+
+  static char msg[MQTT_BUFFER_BYTES];
+  int len = snprintf(msg, sizeof(msg),
+                     "{"
+                     "\"device_id\":\"%s\","
+                     "\"rows\":%u,"
+                     "\"cols\":%u,"
+                     "\"decay_period_s\":%lu,"
+                     "\"decay_q15\":%u,"
+                     "\"ts_ms\":%lu,"
+                     "\"cells_ds\":[",
+                     DEVICE_ID, (unsigned)rows, (unsigned)cols,
+                     (unsigned long)(HEATMAP_DECAY_PERIOD_MS / 1000),
+                     (unsigned)HEATMAP_DECAY_Q15,
+                     (unsigned long)ms_now());
+  for (size_t i = 0; i < n && len > 0 && (size_t)len < sizeof(msg); i++) {
+    len += snprintf(msg + len, sizeof(msg) - len, i ? ",%lu" : "%lu", ds(i));
+  }
+  if (len <= 0 || (size_t)len + 3 > sizeof(msg)) {
+    log_line("HEAT", "Heatmap too large for MQTT_BUFFER_BYTES");
+    return;
+  }
+  snprintf(msg + len, sizeof(msg) - len, "]}");
+  publish_checked("HEAT", topics.heatmap, msg, false);
+}
+
+static bool send_event(const Topics& topics, const uint8_t* data, size_t len, bool cbor) {
+  return publish_bytes_checked("EVENT", cbor ? topics.cbor_events : topics.events, data, len, false);
+}
+
+static void enqueue_event(const uint8_t* data, size_t len, bool cbor) {
+  if (len > EVENT_MAX_BYTES) {
+    events_dropped++;
+    return;
+  }
+  if (event_count == EVENT_QUEUE_DEPTH) {
+    event_head = (event_head + 1) % EVENT_QUEUE_DEPTH;
+    event_count--;
+    events_dropped++;
+  }
+  QueuedEvent& e = event_queue[(event_head + event_count) % EVENT_QUEUE_DEPTH];
+  memcpy(e.payload, data, len);
+  e.len = (uint16_t)len;
+  e.cbor = cbor;
+  event_count++;
+}
+
+static void drain_events(const Topics& topics) {
+  for (size_t n = 0; n < EVENT_DRAIN_PER_LOOP && event_count > 0; n++) {
+    const QueuedEvent& e = event_queue[event_head];
+    if (!send_event(topics, e.payload, e.len, e.cbor)) return;
+    event_head = (event_head + 1) % EVENT_QUEUE_DEPTH;
+    event_count--;
+  }
+}
+
+static void publish_or_queue(const Topics& topics, const uint8_t* data, size_t len, bool cbor) {
+  // Older events go first; a failed publish keeps this one for the retry
+  if (event_count == 0 && mqtt.connected() && send_event(topics, data, len, cbor)) {
+    return;
+  }
+  enqueue_event(data, len, cbor);
 }
 
 void publish_event(const Topics& topics, const char* json_payload) {
-  publish_checked("EVENT", topics.events, json_payload, false);
+  publish_or_queue(topics, (const uint8_t*)json_payload, strlen(json_payload), false);
+}
+
+void publish_event_cbor(const Topics& topics, const uint8_t* data, size_t len) {
+  publish_or_queue(topics, data, len, true);
+}
+
+static uint32_t stored_discovery_hash() {
+  Preferences prefs;
+  if (!prefs.begin(NVS_NAMESPACE, true)) return 0;
+  const uint32_t h = prefs.getUInt("disc_hash", 0);
+  prefs.end();
+  return h;
+}
+
+static void publish_discovery_and_store(const Topics& topics) {
+  if (!canary::ha::publish_discovery(mqtt, topics)) return;  // retry next boot
+  Preferences prefs;
+  if (prefs.begin(NVS_NAMESPACE, false)) {
+    prefs.putUInt("disc_hash", discovery_hash_now);
+    prefs.end();
+  }
+}
+
+static void on_message(char* topic, uint8_t* payload, unsigned int len) {
+  (void)payload;
+  if (discovery_verifying && len > 0 && strcmp(topic, discovery_probe) == 0) {
+    discovery_seen = true;
+  }
+}
+
+// Finish the retained-copy check started by ha_discovery_publish_once()
+static void service_discovery_probe(uint32_t now_ms) {
+  if (!discovery_verifying) return;
+  if (!discovery_seen && (now_ms - discovery_verify_ms) < DISCOVERY_VERIFY_MS) return;
+
+  discovery_verifying = false;
+  mqtt.unsubscribe(discovery_probe);
+  if (discovery_seen) {
+    log_line("DISC", "Discovery unchanged and retained; not republished.");
+    return;
+  }
+  log_line("DISC", "Retained discovery missing; republishing.");
+  publish_discovery_and_store(g_topics);
 }
 
 void ha_discovery_publish_once(const Topics& topics) {
   if (discovery_done) return;
-  canary::ha::publish_discovery(mqtt, topics);
   discovery_done = true;
+
+  discovery_hash_now = canary::ha::discovery_hash(topics);
+  if (discovery_hash_now != stored_discovery_hash()) {
+    publish_discovery_and_store(topics);
+    return;
+  }
+
+  // Same set as last time: confirm the broker still holds it
+  canary::ha::discovery_probe_topic(discovery_probe, sizeof(discovery_probe));
+  discovery_seen = false;
+  discovery_verify_ms = ms_now();
+  discovery_verifying = mqtt.subscribe(discovery_probe);
+  if (!discovery_verifying) publish_discovery_and_store(topics);
 }
 
-void mqtt_reconnect_blocking() {
+static bool try_connect() {
   char lwtPayload[160];
   snprintf(lwtPayload, sizeof(lwtPayload),
            "{"
@@ -136,29 +434,65 @@ void mqtt_reconnect_blocking() {
            "}",
            DEVICE_ID, DEVICE_TYPE);
 
-  while (!mqtt.connected()) {
-    String clientId = String("securacv-") + DEVICE_ID + "-" + String((uint32_t)ESP.getEfuseMac(), HEX);
+  String clientId = String("securacv-") + DEVICE_ID + "-" + String((uint32_t)ESP.getEfuseMac(), HEX);
 
-    log_header("MQTT");
-    canary::dbg_serial().printf("Connecting %s:%u as %s ...\n", MQTT_HOST, MQTT_PORT, clientId.c_str());
+  log_header("MQTT");
+  canary::dbg_serial().printf("Connecting %s:%u as %s ...\n", MQTT_HOST, MQTT_PORT, clientId.c_str());
 
-    bool ok = false;
-    if (MQTT_USER != nullptr && MQTT_PASS != nullptr) {
-      ok = mqtt.connect(clientId.c_str(), MQTT_USER, MQTT_PASS, g_topics.status, 1, true, lwtPayload);
-    } else {
-      ok = mqtt.connect(clientId.c_str(), nullptr, nullptr, g_topics.status, 1, true, lwtPayload);
-    }
+  if (MQTT_USER != nullptr && MQTT_PASS != nullptr) {
+    return mqtt.connect(clientId.c_str(), MQTT_USER, MQTT_PASS, g_topics.status, 1, true, lwtPayload);
+  }
+  return mqtt.connect(clientId.c_str(), nullptr, nullptr, g_topics.status, 1, true, lwtPayload);
+}
 
-    if (!ok) {
-      log_header("MQTT");
-      canary::dbg_serial().printf("Connect FAIL rc=%d. Retry 1s\n", mqtt.state());
-      delay(1000);
-    }
+bool mqtt_service(uint32_t now_ms) {
+  if (mqtt.connected()) {
+    mqtt.loop();
+    service_discovery_probe(now_ms);
+    drain_events(g_topics);
+    return false;
   }
 
+  if (was_connected) {
+    was_connected = false;
+    backoff_ms = MQTT_BACKOFF_MIN_MS;
+    next_attempt_ms = now_ms;
+    log_line("MQTT", "Disconnected. Reconnecting in background...");
+  }
+
+  // One attempt per backoff period; without WiFi there is nothing to try
+  if ((int32_t)(now_ms - next_attempt_ms) < 0) return false;
+  if (WiFi.status() != WL_CONNECTED || !try_connect()) {
+    connect_failures++;
+    log_header("MQTT");
+    canary::dbg_serial().printf("Connect FAIL rc=%d. Retry %lums (%u events queued)\n",
+                                mqtt.state(), (unsigned long)backoff_ms, (unsigned)event_count);
+    // +/-25% jitter keeps a fleet from reconnecting in lockstep after a broker restart
+    const uint32_t jitter = backoff_ms / 4;
+    next_attempt_ms = canary::ms_now() + backoff_ms - jitter + (esp_random() % (2 * jitter + 1));
+    backoff_ms = backoff_ms >= MQTT_BACKOFF_MAX_MS / 2 ? MQTT_BACKOFF_MAX_MS : backoff_ms * 2;
+    return false;
+  }
+
+  was_connected = true;
+  connects++;
+  state_published = false;  // A publish may have failed while offline
+  backoff_ms = MQTT_BACKOFF_MIN_MS;
   log_line("MQTT", "Connected.");
   publish_status_retained(g_topics, "online");
   ha_discovery_publish_once(g_topics);
+  drain_events(g_topics);
+  return true;
+}
+
+MqttStats mqtt_stats() {
+  MqttStats s{};
+  s.connects = connects;
+  s.connect_failures = connect_failures;
+  s.backoff_ms = backoff_ms;
+  s.events_queued = (uint32_t)event_count;
+  s.events_dropped = events_dropped;
+  return s;
 }
 
 } // namespace canary::net
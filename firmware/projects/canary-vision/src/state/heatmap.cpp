@@ -0,0 +1,45 @@
+#include "canary/state/heatmap.h"
+#include "canary/config.h"
+
+namespace canary::state {
+
+static_assert(HEATMAP_ROWS > 0 && HEATMAP_COLS > 0, "heatmap grid must be non-empty");
+static_assert(Heatmap::CELLS <= 256, "heatmap publish buffers assume <= 256 cells");
+
+void Heatmap::reset(uint32_t now_ms) {
+  for (auto& c : cells_) c = 0;
+  last_sample_ms_ = now_ms;
+  last_decay_ms_ = now_ms;
+}
+
+void Heatmap::decay_to(uint32_t now_ms) {
+  while ((now_ms - last_decay_ms_) >= HEATMAP_DECAY_PERIOD_MS) {
+    last_decay_ms_ += HEATMAP_DECAY_PERIOD_MS;
+    for (auto& c : cells_) {
+      c = (uint32_t)(((uint64_t)c * HEATMAP_DECAY_Q15) >> 15);
+    }
+  }
+}
+
+void Heatmap::add(const VisionSample& vs, uint32_t now_ms) {
+  decay_to(now_ms);
+
+  uint32_t dt = now_ms - last_sample_ms_;
+  last_sample_ms_ = now_ms;
+  if (dt > HEATMAP_MAX_STEP_MS) dt = HEATMAP_MAX_STEP_MS;
+
+  for (uint8_t i = 0; i < vs.count; i++) {
+    const BBox& bb = vs.det[i].bbox;
+    int c = ((bb.x + bb.w / 2) * HEATMAP_COLS) / FRAME_W;
+    int r = ((bb.y + bb.h / 2) * HEATMAP_ROWS) / FRAME_H;
+    if (c < 0) c = 0;
+    if (c > HEATMAP_COLS - 1) c = HEATMAP_COLS - 1;
+    if (r < 0) r = 0;
+    if (r > HEATMAP_ROWS - 1) r = HEATMAP_ROWS - 1;
+
+    uint32_t& cell = cells_[r * HEATMAP_COLS + c];
+    cell = (cell > UINT32_MAX - dt) ? UINT32_MAX : cell + dt;
+  }
+}
+
+} // namespace canary::state
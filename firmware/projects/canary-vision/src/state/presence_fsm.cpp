@@ -1,120 +1,200 @@
 #include "canary/state/presence_fsm.h"
 #include "canary/config.h"
 
+#include <algorithm>
+
 namespace canary::state {
 
 void PresenceFSM::reset() {
   presence_=false;
-  dwelling_=false;
   presence_start_ms_=0;
-  last_seen_ms_=0;
-  dwell_start_ms_=0;
-  last_leave_ms_=0;
-
-  interaction_candidate_=false;
+  next_id_=1;
 
-  dwell_latch_=false;
-  interaction_latch_=false;
-  interaction_emitted_=false;
-  last_leave_seen_=0;
-
-  bbox_ = BBox{};
-  confidence_=0;
+  for (auto& t : tracks_) {
+    t = Track{};
+    t.voxel.reset();
+  }
+}
 
-  voxel_tracker_.reset();
+static inline void emit(EventMsg* out, size_t max, size_t& n,
+                        const char* name, const char* reason=nullptr, uint16_t track_id=0) {
+  if (n >= max) return;
+  out[n].event_name = name;
+  out[n].reason = reason;
+  out[n].track_id = track_id;
+  n++;
 }
 
-static inline bool emit(EventMsg& out, const char* name, const char* reason=nullptr) {
-  out.event_name = name;
-  out.reason = reason;
-  return true;
+// Association score: IoU percent, or 1 for a centroid within
+// TRACK_MAX_JUMP_PX; 0 means no match
+static int match_score(const BBox& a, const BBox& b) {
+  const int ix = std::max(0, std::min(a.x + a.w, b.x + b.w) - std::max(a.x, b.x));
+  const int iy = std::max(0, std::min(a.y + a.h, b.y + b.h) - std::max(a.y, b.y));
+  const int32_t inter = (int32_t)ix * iy;
+  const int32_t uni = (int32_t)a.w * a.h + (int32_t)b.w * b.h - inter;
+  if (uni > 0 && inter * 100 >= (int32_t)TRACK_IOU_MIN_PCT * uni) {
+    return (int)(inter * 100 / uni);
+  }
+
+  const int dx = (a.x + a.w / 2) - (b.x + b.w / 2);
+  const int dy = (a.y + a.h / 2) - (b.y + b.h / 2);
+  return (dx * dx + dy * dy <= TRACK_MAX_JUMP_PX * TRACK_MAX_JUMP_PX) ? 1 : 0;
 }
 
-bool PresenceFSM::tick(const VisionSample& vs, uint32_t now_ms, EventMsg& out_event) {
-  out_event = EventMsg{};
-
-  bbox_ = vs.bbox;
-  confidence_ = vs.person_now ? vs.bbox.score : 0;
-
-  if (vs.person_now) {
-    last_seen_ms_ = now_ms;
-    voxel_tracker_.update(vs.voxel, now_ms);
-
-    if (!presence_) {
-      presence_ = true;
-      dwelling_ = false;
-      presence_start_ms_ = now_ms;
-      interaction_candidate_ = false;
-      dwell_latch_ = false;
-      interaction_latch_ = false;
-      interaction_emitted_ = false;
-      return emit(out_event, "presence_started");
+// Greedy best-pair-first matching; match[t] is the detection index for
+// track t, or -1
+void PresenceFSM::associate(const VisionSample& vs, int8_t* match) const {
+  int score[MAX_TRACKS][MAX_DETECTIONS];
+  for (uint8_t t = 0; t < MAX_TRACKS; t++) {
+    match[t] = -1;
+    for (uint8_t d = 0; d < vs.count; d++) {
+      score[t][d] = tracks_[t].active ? match_score(tracks_[t].bbox, vs.det[d].bbox) : 0;
     }
+  }
 
-    if (!dwelling_ && (now_ms - presence_start_ms_) >= DWELL_START_MS) {
-      dwelling_ = true;
-      dwell_start_ms_ = now_ms;
-      return emit(out_event, "dwell_started");
+  bool det_used[MAX_DETECTIONS] = {};
+  for (uint8_t round = 0; round < MAX_TRACKS; round++) {
+    int best = 0, bt = -1, bd = -1;
+    for (uint8_t t = 0; t < MAX_TRACKS; t++) {
+      if (match[t] >= 0) continue;
+      for (uint8_t d = 0; d < vs.count; d++) {
+        if (!det_used[d] && score[t][d] > best) {
+          best = score[t][d];
+          bt = t;
+          bd = d;
+        }
+      }
     }
+    if (bt < 0) break;
+    match[bt] = (int8_t)bd;
+    det_used[bd] = true;
+  }
+}
 
-    if (!interaction_candidate_ && (now_ms - voxel_tracker_.stable_enter_ms()) >= ZONE_INTERACTION_MS) {
-      interaction_candidate_ = true;
-    }
+size_t PresenceFSM::tick(const VisionSample& vs, uint32_t now_ms, EventMsg* out, size_t max_events) {
+  size_t n = 0;
 
-    if (dwelling_) dwell_latch_ = true;
-    if (interaction_candidate_) interaction_latch_ = true;
+  int8_t match[MAX_TRACKS];
+  associate(vs, match);
 
-    return false;
+  bool det_used[MAX_DETECTIONS] = {};
+  for (uint8_t t = 0; t < MAX_TRACKS; t++) {
+    if (match[t] >= 0) det_used[match[t]] = true;
   }
 
-  if (presence_ && (now_ms - last_seen_ms_) > LOST_TIMEOUT_MS) {
-    if (dwelling_) {
-      if (DWELL_END_GRACE_MS == 0 || (now_ms - last_seen_ms_) >= DWELL_END_GRACE_MS) {
-        dwelling_ = false;
-        return emit(out_event, "dwell_ended");
-      }
-      dwelling_ = false;
+  // Continue matched tracks
+  for (uint8_t t = 0; t < MAX_TRACKS; t++) {
+    tracks_[t].seen = false;
+    if (match[t] < 0) continue;
+    Track& tr = tracks_[t];
+    const Detection& d = vs.det[match[t]];
+    tr.bbox = d.bbox;
+    tr.seen = true;
+    tr.last_seen_ms = now_ms;
+    tr.voxel.update(d.voxel, now_ms);
+    if (tr.hits < 255) tr.hits++;
+    if (!tr.confirmed && tr.hits >= TRACK_CONFIRM_HITS) tr.confirmed = true;
+  }
+
+  // Start tracks for unmatched detections while slots last
+  for (uint8_t d = 0; d < vs.count; d++) {
+    if (det_used[d]) continue;
+    for (auto& tr : tracks_) {
+      if (tr.active) continue;
+      tr = Track{};
+      tr.voxel.reset();
+      tr.active = true;
+      tr.id = next_id_++;
+      if (next_id_ == 0) next_id_ = 1;
+      tr.bbox = vs.det[d].bbox;
+      tr.seen = true;
+      tr.first_seen_ms = now_ms;
+      tr.last_seen_ms = now_ms;
+      tr.hits = 1;
+      tr.confirmed = (TRACK_CONFIRM_HITS <= 1);
+      tr.voxel.update(vs.det[d].voxel, now_ms);
+      break;
     }
+  }
 
-    presence_ = false;
-    last_leave_ms_ = now_ms;
-    return emit(out_event, "presence_ended");
+  // Expire lost tracks; a qualified track reports its interaction as it ends
+  uint8_t confirmed = 0;
+  for (auto& tr : tracks_) {
+    if (!tr.active) continue;
+    if ((now_ms - tr.last_seen_ms) <= LOST_TIMEOUT_MS) {
+      if (tr.confirmed) confirmed++;
+      continue;
+    }
+    if (tr.confirmed) {
+      if (tr.dwelling) emit(out, max_events, n, "dwell_ended", nullptr, tr.id);
+      if (tr.dwelling || tr.interaction_candidate) {
+        const char* reason = tr.dwelling ? "dwell_then_left" : "zone_interaction_then_left";
+        emit(out, max_events, n, "interaction_likely", reason, tr.id);
+      }
+    }
+    tr.active = false;
   }
 
-  if (!presence_ && last_leave_ms_ != 0 && last_leave_ms_ != last_leave_seen_) {
-    last_leave_seen_ = last_leave_ms_;
-    interaction_emitted_ = false;
+  if (!presence_ && confirmed > 0) {
+    presence_ = true;
+    presence_start_ms_ = now_ms;
+    emit(out, max_events, n, "presence_started");
   }
 
-  if (!presence_ && last_leave_ms_ != 0 && !interaction_emitted_) {
-    const bool qualified = (dwell_latch_ || interaction_latch_);
-    if (qualified && (now_ms - last_leave_ms_) <= INTERACTION_AFTER_LEAVE_WINDOW_MS) {
-      interaction_emitted_ = true;
-      const char* reason = dwell_latch_ ? "dwell_then_left" : "zone_interaction_then_left";
-      dwell_latch_ = false;
-      interaction_latch_ = false;
-      return emit(out_event, "interaction_likely", reason);
+  for (auto& tr : tracks_) {
+    if (!tr.active || !tr.confirmed) continue;
+
+    if (!tr.dwelling && (now_ms - tr.first_seen_ms) >= DWELL_START_MS) {
+      tr.dwelling = true;
+      tr.dwell_start_ms = now_ms;
+      emit(out, max_events, n, "dwell_started", nullptr, tr.id);
     }
-    if ((now_ms - last_leave_ms_) > INTERACTION_AFTER_LEAVE_WINDOW_MS) {
-      interaction_emitted_ = true;
-      dwell_latch_ = false;
-      interaction_latch_ = false;
+
+    if (!tr.interaction_candidate && (now_ms - tr.voxel.stable_enter_ms()) >= ZONE_INTERACTION_MS) {
+      tr.interaction_candidate = true;
     }
   }
 
-  return false;
+  if (presence_ && confirmed == 0) {
+    presence_ = false;
+    emit(out, max_events, n, "presence_ended");
+  }
+
+  return n;
+}
+
+const PresenceFSM::Track* PresenceFSM::primary(uint16_t track_id) const {
+  const Track* oldest = nullptr;
+  for (const auto& tr : tracks_) {
+    if (!tr.active || !tr.confirmed) continue;
+    if (track_id != 0) {
+      if (tr.id == track_id) return &tr;
+      continue;
+    }
+    if (!oldest || (int32_t)(tr.first_seen_ms - oldest->first_seen_ms) < 0) oldest = &tr;
+  }
+  return oldest;
 }
 
-StateSnapshot PresenceFSM::snapshot(uint32_t now_ms, const char* last_event) const {
+StateSnapshot PresenceFSM::snapshot(uint32_t now_ms, const char* last_event, uint16_t track_id) const {
   StateSnapshot s{};
   s.presence = presence_;
-  s.dwelling = dwelling_;
   s.presence_ms = presence_ ? (now_ms - presence_start_ms_) : 0;
-  s.dwell_ms    = dwelling_ ? (now_ms - dwell_start_ms_) : 0;
 
-  s.confidence = confidence_;
-  s.voxel = voxel_tracker_.stable();
-  s.bbox  = bbox_;
+  for (const auto& tr : tracks_) {
+    if (!tr.active || !tr.confirmed) continue;
+    s.tracks++;
+    if (tr.dwelling) s.dwelling = true;
+  }
+
+  const Track* tr = primary(track_id);
+  if (tr) {
+    s.track_id   = tr->id;
+    s.dwell_ms   = tr->dwelling ? (now_ms - tr->dwell_start_ms) : 0;
+    s.confidence = tr->seen ? tr->bbox.score : 0;
+    s.voxel      = tr->voxel.stable();
+    s.bbox       = tr->bbox;
+  }
 
   s.last_event = last_event ? last_event : "boot";
   s.uptime_s   = now_ms / 1000;
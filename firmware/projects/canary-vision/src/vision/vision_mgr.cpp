@@ -4,32 +4,50 @@
 
 #include <Wire.h>
 #include <Seeed_Arduino_SSCMA.h>
+#include <ArduinoJson.h>
 
 namespace canary::vision {
 
 static SSCMA AI;
 static bool g_inited = false;
 
-static bool pick_best_person_box(BBox& out) {
-  bool found = false;
-  int best = -1;
+// Async invoke state
+static bool g_busy = false;
+static uint32_t g_started_ms = 0;
+static uint16_t g_tag = 0;            // Request id of the invoke in flight
+static char g_rx[VISION_RX_BYTES];
+static size_t g_rx_len = 0;
+
+static void bbox_to_voxel(const BBox& bb, Voxel& v);
+
+// Keep person boxes above SCORE_MIN in out.det, highest score first; when
+// more than MAX_DETECTIONS qualify, the lowest scores are dropped
+static void consider_box(int x, int y, int w, int h, int score, int target, VisionSample& out) {
+  if (target != PERSON_TARGET) return;
+  if (score < SCORE_MIN) return;
+
+  uint8_t i = out.count < MAX_DETECTIONS ? out.count++ : MAX_DETECTIONS;
+  while (i > 0 && out.det[i - 1].bbox.score < score) {
+    if (i < MAX_DETECTIONS) out.det[i] = out.det[i - 1];
+    i--;
+  }
+  if (i >= MAX_DETECTIONS) return;
+
+  Detection& d = out.det[i];
+  d.bbox.x = x;
+  d.bbox.y = y;
+  d.bbox.w = w;
+  d.bbox.h = h;
+  d.bbox.score = score;
+  bbox_to_voxel(d.bbox, d.voxel);
+}
 
+static void collect_person_boxes(VisionSample& out) {
   auto& boxes = AI.boxes();
   for (int i = 0; i < boxes.size(); i++) {
     const auto& b = boxes[i];
-    if (b.target != PERSON_TARGET) continue;
-    if (b.score < SCORE_MIN) continue;
-    if (b.score > best) {
-      best = b.score;
-      out.x = b.x;
-      out.y = b.y;
-      out.w = b.w;
-      out.h = b.h;
-      out.score = b.score;
-      found = true;
-    }
+    consider_box(b.x, b.y, b.w, b.h, b.score, b.target, out);
   }
-  return found;
 }
 
 static void bbox_to_voxel(const BBox& bb, Voxel& v) {
@@ -64,22 +82,142 @@ void init() {
   g_inited = true;
 }
 
+// Best box summary, after the detections are collected
+static void fill_sample(VisionSample& out) {
+  out.person_now = out.count > 0;
+  out.bbox = out.person_now ? out.det[0].bbox : BBox{};
+  out.voxel = out.person_now ? out.det[0].voxel : Voxel{ -1, -1, VOXEL_ROWS, VOXEL_COLS };
+}
+
 bool sample(VisionSample& out) {
   if (!g_inited) return false;
 
-  const bool invokeOk = AI.invoke(1, false, false);
+  // invoke() returns CMD_OK (0) on success
+  const bool invokeOk = (AI.invoke(1, false, false) == CMD_OK);
   const bool hasBoxes = (AI.boxes().size() > 0);
   if (!(invokeOk || hasBoxes)) return false;
 
-  BBox bb{};
-  const bool personNow = pick_best_person_box(bb);
+  out.count = 0;
+  collect_person_boxes(out);
+  fill_sample(out);
+  return true;
+}
+
+// -------------------- Async invoke --------------------
+// Sends AT+INVOKE=<times>,<differed>,<result_only> as AT+INVOKE=1,0,1:
+// one run, reported as soon as it finishes, boxes only with no image
+// frame. The module answers with a command reply line and then an INVOKE
+// event line carrying the boxes as [x, y, w, h, score, target]. Lines are
+// JSON framed by '\r' ... '\n'.
+// Each invoke is sent as AT+<tag>@INVOKE; the module echoes the tag in
+// "name", so a late reply to an abandoned invoke never completes the next.
+
+// Formats the command into buf; 0 if an argument is out of range or the
+// command does not fit. Only single, immediate, result-only invokes fit
+// the poll loop: more results or an image would overrun g_rx.
+static size_t format_invoke(char* buf, size_t cap, uint16_t tag,
+                            int times, int differed, int result_only) {
+  if (times != 1 || differed != 0 || result_only != 1) return 0;
+  const int n = snprintf(buf, cap, "AT+%u@INVOKE=%d,%d,%d\r\n",
+                         (unsigned)tag, times, differed, result_only);
+  return (n > 0 && (size_t)n < cap) ? (size_t)n : 0;
+}
 
-  out.person_now = personNow;
-  out.bbox = bb;
-  out.voxel = Voxel{ -1, -1, VOXEL_ROWS, VOXEL_COLS };
+bool start() {
+  if (!g_inited || g_busy) return false;
+
+  // Ids 1..9999 and never 0, so an untagged reply cannot match
+  const uint16_t tag = (uint16_t)(g_tag % 9999 + 1);
+  char cmd[32];
+  const size_t len = format_invoke(cmd, sizeof(cmd), tag, 1, 0, 1);
+  if (len == 0) return false;
+
+  // Drop what is still queued from an earlier invoke (bounded; the tag
+  // catches anything later)
+  char junk[VISION_READ_CHUNK];
+  for (size_t dropped = 0; dropped < VISION_RX_BYTES;) {
+    const int avail = AI.available();
+    if (avail <= 0) break;
+    const int n = AI.read(junk, avail < (int)sizeof(junk) ? avail : (int)sizeof(junk));
+    if (n <= 0) break;
+    dropped += (size_t)n;
+  }
+  g_rx_len = 0;
+  if (AI.write(cmd, len) <= 0) return false;
 
-  if (personNow) bbox_to_voxel(bb, out.voxel);
+  g_tag = tag;
+  g_busy = true;
+  g_started_ms = ms_now();
   return true;
 }
 
+bool busy() { return g_busy; }
+
+// Returns true when `line` is the INVOKE event; ok is false on an error code
+static bool parse_line(const char* line, size_t len, VisionSample& out, bool& ok) {
+  JsonDocument filter;
+  filter["type"] = true;
+  filter["name"] = true;
+  filter["code"] = true;
+  filter["data"]["boxes"] = true;
+
+  JsonDocument doc;
+  if (deserializeJson(doc, line, len, DeserializationOption::Filter(filter))) return false;
+  if ((doc["type"] | -1) != 1) return false;                       // command reply, not the event
+
+  // "<tag>@INVOKE" for the invoke in flight; anything else is stale
+  char name[16];
+  snprintf(name, sizeof(name), "%u@INVOKE", (unsigned)g_tag);
+  if (strcmp(doc["name"] | "", name) != 0) return false;
+
+  ok = (doc["code"] | -1) == 0;
+  if (!ok) return true;
+
+  out.count = 0;
+  for (JsonArrayConst b : doc["data"]["boxes"].as<JsonArrayConst>()) {
+    if (b.size() < 6) continue;
+    consider_box(b[0], b[1], b[2], b[3], b[4], b[5], out);
+  }
+  fill_sample(out);
+  return true;
+}
+
+bool poll(VisionSample& out) {
+  if (!g_busy) return false;
+
+  if ((ms_now() - g_started_ms) > VISION_INVOKE_TIMEOUT_MS) {
+    log_line("VISION", "Invoke timeout");
+    g_busy = false;
+    return false;
+  }
+
+  const int avail = AI.available();
+  if (avail <= 0) return false;
+
+  // Bounded read per poll so the loop stays responsive
+  char chunk[VISION_READ_CHUNK];
+  const int n = AI.read(chunk, avail < (int)sizeof(chunk) ? avail : (int)sizeof(chunk));
+
+  for (int i = 0; i < n; i++) {
+    const char ch = chunk[i];
+    if (ch == '\r') {
+      g_rx_len = 0;
+      continue;
+    }
+    if (ch != '\n') {
+      if (g_rx_len < sizeof(g_rx)) g_rx[g_rx_len++] = ch;
+      continue;
+    }
+
+    bool ok = false;
+    const bool done = parse_line(g_rx, g_rx_len, out, ok);
+    g_rx_len = 0;
+    if (done) {
+      g_busy = false;
+      return ok;
+    }
+  }
+  return false;
+}
+
 } // namespace canary::vision
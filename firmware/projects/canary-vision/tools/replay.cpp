@@ -0,0 +1,162 @@
+/*
+  SecuraCV Canary Vision — Host Replay / Benchmark Harness
+  ---------------------------------------------------------
+  Replays a recorded VisionSample trace through PresenceFSM on the host,
+  prints the event timeline and reports ns/tick, so thresholds such as
+  DWELL_START_MS can be tuned and latency regressions caught without a
+  camera. Builds against the firmware's own state sources and config.h.
+
+  USAGE:
+    make replay                          # build .pio/replay
+    .pio/replay trace.log                # timeline + timing
+    .pio/replay -q -n 200 trace.log      # timing only, 200 passes
+    pio device monitor | tee trace.log   # record (VISION_TRACE_SERIAL)
+
+  TRACE FORMAT (one sample per line; other lines are ignored, so a raw
+  serial log works as-is):
+    S,<ts_ms>,<count>[,<x>,<y>,<w>,<h>,<score>,<voxel_r>,<voxel_c>]...
+
+  License: Apache-2.0 (use repository license unless otherwise specified).
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "canary/config.h"
+#include "canary/types.h"
+#include "canary/state/presence_fsm.h"
+
+struct Sample {
+  uint32_t ts_ms;
+  VisionSample vs;
+};
+
+static bool parse_line(const char* line, Sample& out) {
+  if (strncmp(line, "S,", 2) != 0) return false;
+
+  const char* p = line + 2;
+  char* end = nullptr;
+  auto next = [&](long& v) {
+    v = strtol(p, &end, 10);
+    if (end == p) return false;
+    p = (*end == ',') ? end + 1 : end;
+    return true;
+  };
+
+  long ts = 0, count = 0;
+  if (!next(ts) || !next(count) || count < 0) return false;
+
+  out = Sample{};
+  out.ts_ms = (uint32_t)ts;
+  for (long i = 0; i < count; i++) {
+    long f[7];
+    for (long& v : f) {
+      if (!next(v)) return false;
+    }
+    if (out.vs.count >= MAX_DETECTIONS) continue;
+    Detection& d = out.vs.det[out.vs.count++];
+    d.bbox.x = (int)f[0];
+    d.bbox.y = (int)f[1];
+    d.bbox.w = (int)f[2];
+    d.bbox.h = (int)f[3];
+    d.bbox.score = (int)f[4];
+    d.voxel = Voxel((int)f[5], (int)f[6], VOXEL_ROWS, VOXEL_COLS);
+  }
+
+  out.vs.person_now = out.vs.count > 0;
+  if (out.vs.person_now) {
+    out.vs.bbox = out.vs.det[0].bbox;
+    out.vs.voxel = out.vs.det[0].voxel;
+  }
+  return true;
+}
+
+static void usage(const char* argv0) {
+  fprintf(stderr, "usage: %s [-q] [-n passes] trace.log|-\n", argv0);
+}
+
+int main(int argc, char** argv) {
+  bool quiet = false;
+  int passes = 1;
+  const char* path = nullptr;
+
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "-q")) {
+      quiet = true;
+    } else if (!strcmp(argv[i], "-n") && i + 1 < argc) {
+      passes = std::max(1, atoi(argv[++i]));
+    } else if (!path) {
+      path = argv[i];
+    } else {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+  if (!path) {
+    usage(argv[0]);
+    return 2;
+  }
+
+  FILE* f = strcmp(path, "-") ? fopen(path, "r") : stdin;
+  if (!f) {
+    perror(path);
+    return 1;
+  }
+
+  std::vector<Sample> trace;
+  char line[1024];
+  while (fgets(line, sizeof(line), f)) {
+    Sample s;
+    if (parse_line(line, s)) trace.push_back(s);
+  }
+  if (f != stdin) fclose(f);
+
+  if (trace.empty()) {
+    fprintf(stderr, "no samples in %s\n", path);
+    return 1;
+  }
+
+  std::vector<uint32_t> tick_ns;
+  tick_ns.reserve(trace.size() * passes);
+  size_t events_total = 0;
+
+  for (int pass = 0; pass < passes; pass++) {
+    canary::state::PresenceFSM fsm;
+    fsm.reset();
+    const bool print = !quiet && pass == 0;
+
+    for (const Sample& s : trace) {
+      EventMsg ev[canary::state::PresenceFSM::MAX_EVENTS];
+
+      const auto t0 = std::chrono::steady_clock::now();
+      const size_t n = fsm.tick(s.vs, s.ts_ms, ev, canary::state::PresenceFSM::MAX_EVENTS);
+      const auto t1 = std::chrono::steady_clock::now();
+      tick_ns.push_back((uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
+
+      if (pass == 0) events_total += n;
+      if (!print) continue;
+      for (size_t i = 0; i < n; i++) {
+        const auto snap = fsm.snapshot(s.ts_ms, ev[i].event_name, ev[i].track_id);
+        printf("%10lu  %-20s %-28s track=%-3u tracks=%u dwell_ms=%lu\n",
+               (unsigned long)s.ts_ms, ev[i].event_name, ev[i].reason ? ev[i].reason : "",
+               (unsigned)ev[i].track_id, (unsigned)snap.tracks, (unsigned long)snap.dwell_ms);
+      }
+    }
+  }
+
+  std::sort(tick_ns.begin(), tick_ns.end());
+  uint64_t sum = 0;
+  for (uint32_t ns : tick_ns) sum += ns;
+  const size_t n = tick_ns.size();
+
+  printf("\nsamples=%zu span_ms=%lu events=%zu passes=%d\n",
+         trace.size(), (unsigned long)(trace.back().ts_ms - trace.front().ts_ms),
+         events_total, passes);
+  printf("ns/tick mean=%llu p50=%u p99=%u max=%u\n",
+         (unsigned long long)(sum / n), tick_ns[n / 2], tick_ns[(n * 99) / 100], tick_ns[n - 1]);
+  return 0;
+}
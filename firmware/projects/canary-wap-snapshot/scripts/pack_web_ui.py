@@ -0,0 +1,114 @@
+#!/usr/bin/env python3
+"""
+SecuraCV Canary WAP — Web UI Asset Packer
+
+Splits the CANARY_UI_HTML raw literal in web_ui.h into a page, a
+stylesheet and a script, gzips each and writes them under the sketch's
+data/ui/ directory, ready for the LittleFS upload tool:
+
+    data/ui/index.html.gz         Page shell, revalidated on every visit
+    data/ui/app.<hash>.css.gz     Named by content hash, cached immutably
+    data/ui/app.<hash>.js.gz
+    data/ui/index.etag            Entity tag for index.html
+
+web_ui.h stays the single source: the firmware falls back to the embedded
+literal when the partition is empty, and the packed files are regenerated
+from it. Output is deterministic (mtime 0, fixed level), so an unchanged
+UI packs to identical files and identical names.
+
+Usage:
+    python scripts/pack_web_ui.py
+    then upload snapshot/canary_wap/data with the LittleFS upload tool
+
+Copyright (c) 2026 ERRERlabs / Karl May
+License: Apache-2.0
+"""
+
+import gzip
+import hashlib
+import os
+import sys
+
+SKETCH_DIR = os.path.join("snapshot", "canary_wap")
+SOURCE_NAME = "web_ui.h"
+OUTPUT_DIR = os.path.join("data", "ui")
+LITERAL_OPEN = 'CANARY_UI_HTML[] PROGMEM = R"rawliteral('
+LITERAL_CLOSE = ')rawliteral"'
+HASH_CHARS = 16
+
+
+def extract_html(source):
+    start = source.find(LITERAL_OPEN)
+    if start < 0:
+        raise ValueError("CANARY_UI_HTML literal not found")
+    start += len(LITERAL_OPEN)
+    end = source.find(LITERAL_CLOSE, start)
+    if end < 0:
+        raise ValueError("CANARY_UI_HTML literal is not terminated")
+    return source[start:end]
+
+
+def split_block(html, open_tag, close_tag):
+    """Return (before, body, after) around the single open_tag..close_tag block."""
+    start = html.find(open_tag)
+    if start < 0:
+        raise ValueError(open_tag + " block not found")
+    end = html.find(close_tag, start)
+    if end < 0:
+        raise ValueError(open_tag + " block is not terminated")
+    if html.find(open_tag, end) >= 0:
+        raise ValueError("more than one " + open_tag + " block")
+    body = html[start + len(open_tag):end]
+    return html[:start], body, html[end + len(close_tag):]
+
+
+def digest(data):
+    return hashlib.sha256(data).hexdigest()[:HASH_CHARS]
+
+
+def pack(html):
+    """Return {filename: bytes} for the page and its hashed assets."""
+    head, css, rest = split_block(html, "<style>", "</style>")
+    css = css.strip().encode("utf-8") + b"\n"
+    css_name = "app.%s.css" % digest(css)
+    html = head + '<link rel="stylesheet" href="/ui/%s">' % css_name + rest
+
+    head, js, rest = split_block(html, "<script>", "</script>")
+    js = js.strip().encode("utf-8") + b"\n"
+    js_name = "app.%s.js" % digest(js)
+    # Scripts at the end of <body> still run after the DOM is parsed
+    page = (head + '<script src="/ui/%s"></script>' % js_name + rest).encode("utf-8")
+
+    files = {}
+    for name, data in (("index.html", page), (css_name, css), (js_name, js)):
+        files[name + ".gz"] = gzip.compress(data, compresslevel=9, mtime=0)
+    files["index.etag"] = ('"%s"' % digest(page)).encode("ascii")
+    return files
+
+
+def generate(project_dir):
+    sketch_dir = os.path.join(project_dir, SKETCH_DIR)
+    out_dir = os.path.join(sketch_dir, OUTPUT_DIR)
+
+    with open(os.path.join(sketch_dir, SOURCE_NAME), "r", encoding="utf-8") as f:
+        files = pack(extract_html(f.read()))
+
+    os.makedirs(out_dir, exist_ok=True)
+    # Drop assets from earlier builds so stale hashes don't fill the partition
+    for name in os.listdir(out_dir):
+        if name not in files:
+            os.remove(os.path.join(out_dir, name))
+    for name, data in sorted(files.items()):
+        path = os.path.join(out_dir, name)
+        if os.path.exists(path):
+            with open(path, "rb") as f:
+                if f.read() == data:
+                    continue
+        with open(path, "wb") as f:
+            f.write(data)
+        print("[pack_web_ui] %s: %d bytes" % (name, len(data)))
+
+
+if __name__ == "__main__":
+    generate(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+    sys.exit(0)
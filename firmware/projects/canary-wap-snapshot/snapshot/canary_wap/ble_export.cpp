@@ -0,0 +1,347 @@
+/*
+ * SecuraCV Canary — BLE Export Channel Implementation
+ *
+ * NimBLE callbacks run in the host task and never write to the channel: a
+ * CoC write waits for credits that the host task itself delivers. They
+ * only record state and start the export task. Error replies are queued
+ * in s_reply and sent by the export task between SDUs, or by a short
+ * reply task when nothing is streaming.
+ */
+
+#include "ble_export.h"
+#include "bluetooth_channel.h"
+#define HARDWARE_STATE_NO_IMPL
+#include "hardware_state.h"
+
+// NimBLE headers must come before health_log.h to allow #undef of conflicting macros
+#include <NimBLEDevice.h>
+#include <NimBLEL2CAPServer.h>
+#include <NimBLEL2CAPChannel.h>
+
+#ifdef LOG_LEVEL_DEBUG
+#undef LOG_LEVEL_DEBUG
+#endif
+#ifdef LOG_LEVEL_INFO
+#undef LOG_LEVEL_INFO
+#endif
+#ifdef LOG_LEVEL_NOTICE
+#undef LOG_LEVEL_NOTICE
+#endif
+#ifdef LOG_LEVEL_WARNING
+#undef LOG_LEVEL_WARNING
+#endif
+#ifdef LOG_LEVEL_ERROR
+#undef LOG_LEVEL_ERROR
+#endif
+#ifdef LOG_LEVEL_CRITICAL
+#undef LOG_LEVEL_CRITICAL
+#endif
+
+#include "health_log.h"
+#include <mbedtls/sha256.h>
+#include <atomic>
+#include <vector>
+
+namespace ble_export {
+
+// ════════════════════════════════════════════════════════════════════════════
+// PRIVATE STATE
+// ════════════════════════════════════════════════════════════════════════════
+
+static NimBLEL2CAPChannel* s_channel = nullptr;
+static std::atomic<bool> s_open{false};
+static std::atomic<bool> s_streaming{false};
+static std::atomic<bool> s_cancel{false};
+static std::atomic<uint8_t> s_reply{0};    // Pending ERROR code, 0 = none
+static uint16_t s_sdu_mtu = EXPORT_COC_MTU;
+static BundleSource s_source = nullptr;
+
+// Request, written by the host task before the export task starts
+static char s_start_date[DATE_LEN + 1];
+static char s_end_date[DATE_LEN + 1];
+static uint32_t s_offset = 0;
+
+static uint32_t s_bytes_sent = 0;
+static uint32_t s_started_ms = 0;
+static uint32_t s_finished_ms = 0;
+static uint32_t s_completed = 0;
+static uint32_t s_resumed = 0;
+static uint32_t s_aborted = 0;
+
+struct StreamCtx {
+  uint32_t pos;                   // Bundle bytes produced so far
+  bool resume_sent;
+  std::vector<uint8_t> sdu;       // SDU_DATA followed by pending bytes
+  mbedtls_sha256_context prefix;  // Bytes before s_offset
+};
+
+// ════════════════════════════════════════════════════════════════════════════
+// PRIVATE HELPERS
+// ════════════════════════════════════════════════════════════════════════════
+
+static bool send_sdu(const std::vector<uint8_t>& sdu) {
+  if (!s_open.load() || s_cancel.load() || !s_channel) return false;
+  return s_channel->write(sdu);
+}
+
+static void send_error(uint8_t code) {
+  std::vector<uint8_t> sdu = { SDU_ERROR, code };
+  send_sdu(sdu);
+}
+
+static void send_pending_reply() {
+  uint8_t code = s_reply.exchange(0);
+  if (code) send_error(code);
+}
+
+static bool send_resume(StreamCtx* c) {
+  std::vector<uint8_t> sdu(1 + 4 + 32);
+  sdu[0] = SDU_RESUME;
+  for (int i = 0; i < 4; i++) sdu[1 + i] = (s_offset >> (8 * i)) & 0xFF;
+  mbedtls_sha256_finish(&c->prefix, sdu.data() + 5);
+  c->resume_sent = true;
+  return send_sdu(sdu);
+}
+
+static bool flush_data(StreamCtx* c) {
+  if (c->sdu.size() <= 1) return true;
+  size_t payload = c->sdu.size() - 1;
+  send_pending_reply();
+  if (!send_sdu(c->sdu)) return false;
+  s_bytes_sent += payload;
+  c->sdu.resize(1);
+  return true;
+}
+
+// ExportWriteFn: skip and hash up to the resume offset, then pack SDUs
+static bool write_bundle(const uint8_t* data, size_t len, void* ctx) {
+  StreamCtx* c = static_cast<StreamCtx*>(ctx);
+  if (s_cancel.load() || !s_open.load()) return false;
+
+  while (len > 0) {
+    if (c->pos < s_offset) {
+      size_t n = s_offset - c->pos;
+      if (n > len) n = len;
+      mbedtls_sha256_update(&c->prefix, data, n);
+      c->pos += n;
+      data += n;
+      len -= n;
+      continue;
+    }
+    if (!c->resume_sent && !send_resume(c)) return false;
+
+    size_t room = s_sdu_mtu - c->sdu.size();
+    size_t n = len < room ? len : room;
+    c->sdu.insert(c->sdu.end(), data, data + n);
+    c->pos += n;
+    data += n;
+    len -= n;
+    if (c->sdu.size() >= s_sdu_mtu && !flush_data(c)) return false;
+  }
+  return true;
+}
+
+static bool run_export() {
+  if (!s_source || !sd_is_available()) {
+    send_error(ERR_NO_STORAGE);
+    return false;
+  }
+
+  StreamCtx c;
+  c.pos = 0;
+  c.resume_sent = false;
+  c.sdu.reserve(s_sdu_mtu);
+  c.sdu.push_back(SDU_DATA);
+  mbedtls_sha256_init(&c.prefix);
+  mbedtls_sha256_starts(&c.prefix, 0);
+
+  uint8_t digest[32];
+  bool ok = s_source(s_start_date, s_end_date, write_bundle, &c, digest);
+  if (ok && !c.resume_sent) {
+    // Bundle ended at or before the offset
+    if (c.pos < s_offset) {
+      mbedtls_sha256_free(&c.prefix);
+      send_error(ERR_OFFSET_PAST_END);
+      return false;
+    }
+    ok = send_resume(&c);
+  }
+  mbedtls_sha256_free(&c.prefix);
+
+  if (ok) ok = flush_data(&c);
+  if (!ok) {
+    if (!s_cancel.load() && s_open.load()) send_error(ERR_READ_FAILED);
+    return false;
+  }
+
+  std::vector<uint8_t> end(1 + 4 + 32);
+  end[0] = SDU_END;
+  for (int i = 0; i < 4; i++) end[1 + i] = (c.pos >> (8 * i)) & 0xFF;
+  memcpy(end.data() + 5, digest, 32);
+  return send_sdu(end);
+}
+
+// Clear s_streaming, sending any reply queued while it was set. A reply
+// queued after the last check saw s_streaming still set, so retake it.
+static void finish_streaming() {
+  for (;;) {
+    send_pending_reply();
+    s_streaming.store(false);
+    bool idle = false;
+    if (s_reply.load() == 0 || !s_streaming.compare_exchange_strong(idle, true)) return;
+  }
+}
+
+static void reply_task(void* arg) {
+  (void)arg;
+  finish_streaming();
+  vTaskDelete(nullptr);
+}
+
+// Host task: hand the code to whichever task owns the channel writes
+static void reply_error(uint8_t code) {
+  s_reply.store(code);
+  bool idle = false;
+  if (!s_streaming.compare_exchange_strong(idle, true)) return;  // Export task sends it
+  s_cancel.store(false);  // Left over from a cancelled export
+  if (xTaskCreate(reply_task, "ble_export_err", TASK_STACK_BYTES / 2, nullptr,
+                  tskIDLE_PRIORITY + 1, nullptr) != pdPASS) {
+    s_reply.store(0);
+    s_streaming.store(false);
+  }
+}
+
+static void export_task(void* arg) {
+  (void)arg;
+  s_bytes_sent = 0;
+  s_started_ms = millis();
+  if (s_offset > 0) s_resumed++;
+
+  bool ok = run_export();
+  s_finished_ms = millis();
+  if (ok) {
+    s_completed++;
+  } else {
+    s_aborted++;
+  }
+
+  char detail[64];
+  snprintf(detail, sizeof(detail), "%lu bytes in %lu ms from offset %lu",
+           (unsigned long)s_bytes_sent, (unsigned long)(s_finished_ms - s_started_ms),
+           (unsigned long)s_offset);
+  log_health(ok ? LOG_LEVEL_INFO : LOG_LEVEL_WARNING, LOG_CAT_BLUETOOTH,
+             ok ? "BLE export complete" : "BLE export aborted", detail);
+
+  finish_streaming();
+  vTaskDelete(nullptr);
+}
+
+static bool valid_date(const uint8_t* p) {
+  for (size_t i = 0; i < DATE_LEN; i++) {
+    bool dash = (i == 4 || i == 7);
+    if (dash ? p[i] != '-' : !isdigit(p[i])) return false;
+  }
+  return true;
+}
+
+// Runs in the NimBLE host task
+static void handle_start(const std::vector<uint8_t>& sdu) {
+  if (sdu.size() != 1 + 2 * DATE_LEN + 4 ||
+      !valid_date(sdu.data() + 1) || !valid_date(sdu.data() + 1 + DATE_LEN)) {
+    log_health(LOG_LEVEL_WARNING, LOG_CAT_BLUETOOTH, "BLE export: bad request", nullptr);
+    reply_error(ERR_BAD_REQUEST);
+    return;
+  }
+  bool idle = false;
+  if (!s_streaming.compare_exchange_strong(idle, true)) {
+    log_health(LOG_LEVEL_WARNING, LOG_CAT_BLUETOOTH, "BLE export: already streaming", nullptr);
+    reply_error(ERR_BUSY);
+    return;
+  }
+
+  memcpy(s_start_date, sdu.data() + 1, DATE_LEN);
+  s_start_date[DATE_LEN] = '\0';
+  memcpy(s_end_date, sdu.data() + 1 + DATE_LEN, DATE_LEN);
+  s_end_date[DATE_LEN] = '\0';
+  const uint8_t* off = sdu.data() + 1 + 2 * DATE_LEN;
+  s_offset = (uint32_t)off[0] | ((uint32_t)off[1] << 8) |
+             ((uint32_t)off[2] << 16) | ((uint32_t)off[3] << 24);
+  s_cancel.store(false);
+
+  if (xTaskCreate(export_task, "ble_export", TASK_STACK_BYTES, nullptr,
+                  tskIDLE_PRIORITY + 1, nullptr) != pdPASS) {
+    s_streaming.store(false);
+    log_health(LOG_LEVEL_ERROR, LOG_CAT_BLUETOOTH, "BLE export: task create failed", nullptr);
+  }
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// L2CAP CALLBACKS (NimBLE host task)
+// ════════════════════════════════════════════════════════════════════════════
+
+class ExportChannelCallbacks : public NimBLEL2CAPChannelCallbacks {
+  void onConnect(NimBLEL2CAPChannel* channel, uint16_t negotiated_mtu) override {
+    const bluetooth_channel::ConnectionInfo* conn = bluetooth_channel::get_connection_info();
+    if (!conn->connected || conn->security == bluetooth_channel::SEC_NONE) {
+      log_health(LOG_LEVEL_WARNING, LOG_CAT_BLUETOOTH, "BLE export refused: link not encrypted", nullptr);
+      channel->disconnect();
+      return;
+    }
+    s_sdu_mtu = negotiated_mtu < EXPORT_COC_MTU ? negotiated_mtu : EXPORT_COC_MTU;
+    s_open.store(true);
+  }
+
+  void onRead(NimBLEL2CAPChannel* channel, std::vector<uint8_t>& data) override {
+    if (data.empty()) return;
+    if (data[0] == SDU_START) {
+      handle_start(data);
+    } else if (data[0] == SDU_CANCEL) {
+      s_cancel.store(true);
+    }
+  }
+
+  void onDisconnect(NimBLEL2CAPChannel* channel) override {
+    // A running export aborts; the phone resumes with START at its offset
+    s_open.store(false);
+    s_cancel.store(true);
+  }
+};
+
+static ExportChannelCallbacks s_callbacks;
+
+// ════════════════════════════════════════════════════════════════════════════
+// PUBLIC API
+// ════════════════════════════════════════════════════════════════════════════
+
+bool init(BundleSource source) {
+  if (s_channel) return true;
+  s_source = source;
+  if (!bluetooth_channel::is_initialized()) return false;
+
+  NimBLEL2CAPServer* server = NimBLEDevice::createL2CAPServer();
+  if (!server) return false;
+  s_channel = server->createService(EXPORT_PSM, EXPORT_COC_MTU, &s_callbacks);
+  if (!s_channel) {
+    log_health(LOG_LEVEL_ERROR, LOG_CAT_BLUETOOTH, "BLE export: L2CAP service failed", nullptr);
+    return false;
+  }
+  return true;
+}
+
+ExportStatus get_status() {
+  ExportStatus st = {};
+  st.channel_open = s_open.load();
+  st.streaming = s_streaming.load();
+  st.sdu_mtu = s_sdu_mtu;
+  st.resume_offset = s_offset;
+  st.bytes_sent = s_bytes_sent;
+  st.elapsed_ms = (st.streaming ? millis() : s_finished_ms) - s_started_ms;
+  if (s_started_ms == 0) st.elapsed_ms = 0;
+  st.throughput_bps = st.elapsed_ms ? (uint32_t)((uint64_t)st.bytes_sent * 1000 / st.elapsed_ms) : 0;
+  st.exports_completed = s_completed;
+  st.exports_resumed = s_resumed;
+  st.exports_aborted = s_aborted;
+  return st;
+}
+
+} // namespace ble_export
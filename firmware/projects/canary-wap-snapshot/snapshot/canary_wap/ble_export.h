@@ -0,0 +1,103 @@
+/*
+ * SecuraCV Canary — BLE Export Channel
+ *
+ * Streams the export bundle to the companion app over an L2CAP
+ * connection-oriented channel on EXPORT_PSM. The sketch supplies the
+ * bundle through init() (a BundleSource reading the card). A CoC moves SDUs of up to
+ * EXPORT_COC_MTU bytes under LE credit-based flow control. The phone grants
+ * credits as it consumes data, so a slow phone stalls the sender instead of
+ * overrunning it, and no GATT round trip is spent per packet.
+ *
+ * Every SDU starts with a type byte. Phone to device:
+ *   START  0x01 [start_date 10][end_date 10][offset u32 LE]
+ *   CANCEL 0x02
+ * Device to phone:
+ *   RESUME 0x81 [offset u32 LE][sha256 of bytes before offset 32]
+ *   DATA   0x82 [bundle bytes]
+ *   END    0x83 [total_len u32 LE][sha256 of the whole bundle 32]
+ *   ERROR  0x84 [code u8]
+ *
+ * A malformed START gets ERROR ERR_BAD_REQUEST. A START sent while an
+ * export is running gets ERROR ERR_BUSY between two DATA SDUs, and the
+ * running export continues.
+ *
+ * Resume: after a disconnect the phone reconnects and sends START with the
+ * same dates and the number of bytes it already holds. The device streams
+ * the bundle again from the card and sends nothing before offset. RESUME
+ * carries the hash of that skipped prefix, and if it does not match the
+ * phone's copy (new records changed the bundle), the phone restarts at 0.
+ *
+ * PRIVACY: exports contain witness records, so the channel is accepted only
+ * on an encrypted link.
+ *
+ * Streaming runs in its own task because each CoC write blocks while the
+ * phone is out of credits.
+ */
+
+#ifndef SECURACV_BLE_EXPORT_H
+#define SECURACV_BLE_EXPORT_H
+
+#include <Arduino.h>
+#include "sd_storage.h"
+
+namespace ble_export {
+
+// ════════════════════════════════════════════════════════════════════════════
+// CONFIGURATION
+// ════════════════════════════════════════════════════════════════════════════
+
+static const uint16_t EXPORT_PSM = 0x00C5;        // Dynamic LE PSM range 0x80-0xFF
+static const uint16_t EXPORT_COC_MTU = 2048;      // SDU size offered to the phone
+static const size_t   DATE_LEN = 10;              // "YYYY-MM-DD"
+static const uint32_t TASK_STACK_BYTES = 8192;
+
+// SDU types
+static const uint8_t SDU_START = 0x01;
+static const uint8_t SDU_CANCEL = 0x02;
+static const uint8_t SDU_RESUME = 0x81;
+static const uint8_t SDU_DATA = 0x82;
+static const uint8_t SDU_END = 0x83;
+static const uint8_t SDU_ERROR = 0x84;
+
+// ERROR codes
+static const uint8_t ERR_BAD_REQUEST = 1;
+static const uint8_t ERR_BUSY = 2;
+static const uint8_t ERR_NO_STORAGE = 3;
+static const uint8_t ERR_READ_FAILED = 4;
+static const uint8_t ERR_OFFSET_PAST_END = 5;
+
+// ════════════════════════════════════════════════════════════════════════════
+// TYPES
+// ════════════════════════════════════════════════════════════════════════════
+
+// Produces the bundle for [start_date, end_date] into write() as it is
+// read, and its SHA-256 into sha256_out. Runs on the export task.
+typedef bool (*BundleSource)(const char* start_date, const char* end_date,
+                             sd_storage::ExportWriteFn write, void* ctx,
+                             uint8_t sha256_out[32]);
+
+struct ExportStatus {
+  bool     channel_open;
+  bool     streaming;
+  uint16_t sdu_mtu;             // Negotiated SDU size
+  uint32_t resume_offset;       // Offset the current export started at
+  uint32_t bytes_sent;          // Sent in the current / last export
+  uint32_t elapsed_ms;
+  uint32_t throughput_bps;      // bytes_sent over elapsed_ms
+  uint32_t exports_completed;
+  uint32_t exports_resumed;     // Started at a non-zero offset
+  uint32_t exports_aborted;
+};
+
+// ════════════════════════════════════════════════════════════════════════════
+// PUBLIC API
+// ════════════════════════════════════════════════════════════════════════════
+
+// Register the L2CAP service; call after bluetooth_channel::init()
+bool init(BundleSource source);
+
+ExportStatus get_status();
+
+} // namespace ble_export
+
+#endif // SECURACV_BLE_EXPORT_H
@@ -11,8 +11,12 @@
 #define SECURACV_BLUETOOTH_API_H
 
 #include "esp_http_server.h"
+#include "rate_limiter.h"
 #include "bluetooth_channel.h"
+#include "ble_export.h"
+#include "scan_scheduler.h"
 #include <ArduinoJson.h>
+#include "response_pool.h"
 
 namespace bluetooth_api {
 
@@ -27,7 +31,7 @@ static inline esp_err_t send_json_response(httpd_req_t* req, const char* json) {
 }
 
 static inline esp_err_t send_success(httpd_req_t* req, const char* message = nullptr) {
-  StaticJsonDocument<128> doc;
+  response_pool::PooledJsonDocument doc;
   doc["success"] = true;
   if (message) doc["message"] = message;
 
@@ -37,7 +41,7 @@ static inline esp_err_t send_success(httpd_req_t* req, const char* message = nul
 }
 
 static inline esp_err_t send_error(httpd_req_t* req, const char* error) {
-  StaticJsonDocument<128> doc;
+  response_pool::PooledJsonDocument doc;
   doc["success"] = false;
   doc["error"] = error;
 
@@ -54,7 +58,7 @@ static inline esp_err_t send_error(httpd_req_t* req, const char* error) {
 inline esp_err_t handle_bluetooth_status(httpd_req_t* req) {
   bluetooth_channel::BluetoothStatus status = bluetooth_channel::get_status();
 
-  DynamicJsonDocument doc(2048);
+  response_pool::PooledJsonDocument doc;
 
   doc["state"] = bluetooth_channel::state_name(status.state);
   doc["enabled"] = status.enabled;
@@ -79,6 +83,8 @@ inline esp_err_t handle_bluetooth_status(httpd_req_t* req) {
     conn["connected_sec"] = (millis() - status.connection.connected_since_ms) / 1000;
     conn["bytes_sent"] = status.connection.bytes_sent;
     conn["bytes_received"] = status.connection.bytes_received;
+    conn["mtu"] = status.connection.mtu;
+    conn["phy"] = status.connection.phy_2m ? "2M" : "1M";
   }
 
   // Pairing info
@@ -102,12 +108,46 @@ inline esp_err_t handle_bluetooth_status(httpd_req_t* req) {
   stats["advertising_time_sec"] = status.advertising_time_ms / 1000;
   stats["connected_time_sec"] = status.connected_time_ms / 1000;
 
-  String buffer;
-  if (!buffer.reserve(2048)) {
-    return send_error(req, "Memory allocation failed");
-  }
-  serializeJson(doc, buffer);
-  return send_json_response(req, buffer.c_str());
+  bluetooth_channel::BulkStats bulk = bluetooth_channel::get_bulk_stats();
+  JsonObject bulk_obj = doc.createNestedObject("bulk");
+  bulk_obj["records_queued"] = bulk.records_queued;
+  bulk_obj["records_dropped"] = bulk.records_dropped;
+  bulk_obj["notifications"] = bulk.notifications;
+  bulk_obj["retries"] = bulk.retries;
+  bulk_obj["bytes_sent"] = bulk.bytes_sent;
+  bulk_obj["pending_bytes"] = bulk.pending_bytes;
+  bulk_obj["throughput_bps"] = bulk.throughput_bps;
+
+  ble_export::ExportStatus exp = ble_export::get_status();
+  JsonObject exp_obj = doc.createNestedObject("export");
+  exp_obj["channel_open"] = exp.channel_open;
+  exp_obj["streaming"] = exp.streaming;
+  exp_obj["sdu_mtu"] = exp.sdu_mtu;
+  exp_obj["resume_offset"] = exp.resume_offset;
+  exp_obj["bytes_sent"] = exp.bytes_sent;
+  exp_obj["throughput_bps"] = exp.throughput_bps;
+  exp_obj["completed"] = exp.exports_completed;
+  exp_obj["resumed"] = exp.exports_resumed;
+  exp_obj["aborted"] = exp.exports_aborted;
+
+  scan_scheduler::ScanSchedulerStats scan = scan_scheduler::get_stats();
+  JsonObject scan_obj = doc.createNestedObject("presence_scan");
+  scan_obj["level"] = scan_scheduler::level_name(scan.level);
+  scan_obj["interval_ms"] = scan.interval_ms;
+  scan_obj["window_ms"] = scan.window_ms;
+  scan_obj["active"] = scan.active;
+  scan_obj["duty_pct"] = scan.duty_pct;
+  scan_obj["avg_duty_pct"] = scan.avg_duty_pct;
+  scan_obj["ap_busy"] = scan.ap_busy;
+  scan_obj["mesh_busy"] = scan.mesh_busy;
+  scan_obj["profile_changes"] = scan.profile_changes;
+  scan_obj["results"] = scan.results;
+  JsonObject scan_time = scan_obj.createNestedObject("level_sec");
+  for (uint8_t i = 0; i < scan_scheduler::LEVEL_COUNT; i++) {
+    scan_time[scan_scheduler::level_name((scan_scheduler::ScanLevel)i)] = scan.level_ms[i] / 1000;
+  }
+
+  return response_pool::send_json(req, doc);
 }
 
 // POST /api/bluetooth/enable - Enable Bluetooth
@@ -147,7 +187,7 @@ inline esp_err_t handle_bluetooth_scan_start(httpd_req_t* req) {
   int content_len = httpd_req_recv(req, content, sizeof(content) - 1);
   if (content_len > 0) {
     content[content_len] = '\0';
-    StaticJsonDocument<64> input;
+    response_pool::PooledJsonDocument input;
     if (deserializeJson(input, content) == DeserializationError::Ok) {
       if (input.containsKey("duration_sec")) {
         duration_ms = input["duration_sec"].as<uint32_t>() * 1000;
@@ -156,7 +196,7 @@ inline esp_err_t handle_bluetooth_scan_start(httpd_req_t* req) {
   }
 
   if (bluetooth_channel::start_scan(duration_ms)) {
-    StaticJsonDocument<128> doc;
+    response_pool::PooledJsonDocument doc;
     doc["success"] = true;
     doc["message"] = "Scan started";
     doc["duration_sec"] = duration_ms / 1000;
@@ -179,7 +219,7 @@ inline esp_err_t handle_bluetooth_scan_results(httpd_req_t* req) {
   size_t count;
   const bluetooth_channel::ScannedDevice* devices = bluetooth_channel::get_scanned_devices(&count);
 
-  DynamicJsonDocument doc(4096);
+  response_pool::PooledJsonDocument doc;
   doc["scanning"] = bluetooth_channel::is_scanning();
   doc["count"] = count;
 
@@ -198,12 +238,7 @@ inline esp_err_t handle_bluetooth_scan_results(httpd_req_t* req) {
     dev["age_sec"] = (millis() - devices[i].last_seen_ms) / 1000;
   }
 
-  String buffer;
-  if (!buffer.reserve(4096)) {
-    return send_error(req, "Memory allocation failed");
-  }
-  serializeJson(doc, buffer);
-  return send_json_response(req, buffer.c_str());
+  return response_pool::send_json(req, doc);
 }
 
 // DELETE /api/bluetooth/scan/results - Clear scan results
@@ -235,7 +270,7 @@ inline esp_err_t handle_bluetooth_pair_confirm(httpd_req_t* req) {
   }
   content[content_len] = '\0';
 
-  StaticJsonDocument<64> input;
+  response_pool::PooledJsonDocument input;
   if (deserializeJson(input, content) != DeserializationError::Ok) {
     return send_error(req, "Invalid JSON");
   }
@@ -264,7 +299,7 @@ inline esp_err_t handle_bluetooth_paired_list(httpd_req_t* req) {
   size_t count;
   const bluetooth_channel::PairedDevice* devices = bluetooth_channel::get_paired_devices(&count);
 
-  DynamicJsonDocument doc(2048);
+  response_pool::PooledJsonDocument doc;
   doc["count"] = count;
 
   JsonArray arr = doc.createNestedArray("devices");
@@ -283,12 +318,7 @@ inline esp_err_t handle_bluetooth_paired_list(httpd_req_t* req) {
     dev["blocked"] = devices[i].blocked;
   }
 
-  String buffer;
-  if (!buffer.reserve(2048)) {
-    return send_error(req, "Memory allocation failed");
-  }
-  serializeJson(doc, buffer);
-  return send_json_response(req, buffer.c_str());
+  return response_pool::send_json(req, doc);
 }
 
 // DELETE /api/bluetooth/paired - Remove a paired device
@@ -300,7 +330,7 @@ inline esp_err_t handle_bluetooth_paired_remove(httpd_req_t* req) {
   }
   content[content_len] = '\0';
 
-  StaticJsonDocument<64> input;
+  response_pool::PooledJsonDocument input;
   if (deserializeJson(input, content) != DeserializationError::Ok) {
     return send_error(req, "Invalid JSON");
   }
@@ -337,7 +367,7 @@ inline esp_err_t handle_bluetooth_paired_trust(httpd_req_t* req) {
   }
   content[content_len] = '\0';
 
-  StaticJsonDocument<128> input;
+  response_pool::PooledJsonDocument input;
   if (deserializeJson(input, content) != DeserializationError::Ok) {
     return send_error(req, "Invalid JSON");
   }
@@ -367,7 +397,7 @@ inline esp_err_t handle_bluetooth_paired_block(httpd_req_t* req) {
   }
   content[content_len] = '\0';
 
-  StaticJsonDocument<128> input;
+  response_pool::PooledJsonDocument input;
   if (deserializeJson(input, content) != DeserializationError::Ok) {
     return send_error(req, "Invalid JSON");
   }
@@ -400,7 +430,7 @@ inline esp_err_t handle_bluetooth_disconnect(httpd_req_t* req) {
 inline esp_err_t handle_bluetooth_settings_get(httpd_req_t* req) {
   bluetooth_channel::BluetoothSettings settings = bluetooth_channel::get_settings();
 
-  StaticJsonDocument<512> doc;
+  response_pool::PooledJsonDocument doc;
   doc["enabled"] = settings.enabled;
   doc["auto_advertise"] = settings.auto_advertise;
   doc["allow_pairing"] = settings.allow_pairing;
@@ -424,7 +454,7 @@ inline esp_err_t handle_bluetooth_settings_set(httpd_req_t* req) {
   }
   content[content_len] = '\0';
 
-  StaticJsonDocument<512> input;
+  response_pool::PooledJsonDocument input;
   if (deserializeJson(input, content) != DeserializationError::Ok) {
     return send_error(req, "Invalid JSON");
   }
@@ -473,7 +503,7 @@ inline esp_err_t handle_bluetooth_name_set(httpd_req_t* req) {
   }
   content[content_len] = '\0';
 
-  StaticJsonDocument<128> input;
+  response_pool::PooledJsonDocument input;
   if (deserializeJson(input, content) != DeserializationError::Ok) {
     return send_error(req, "Invalid JSON");
   }
@@ -498,7 +528,7 @@ inline esp_err_t handle_bluetooth_power_set(httpd_req_t* req) {
   }
   content[content_len] = '\0';
 
-  StaticJsonDocument<64> input;
+  response_pool::PooledJsonDocument input;
   if (deserializeJson(input, content) != DeserializationError::Ok) {
     return send_error(req, "Invalid JSON");
   }
@@ -509,7 +539,7 @@ inline esp_err_t handle_bluetooth_power_set(httpd_req_t* req) {
 
   int8_t power = input["power"].as<int8_t>();
   if (bluetooth_channel::set_tx_power(power)) {
-    StaticJsonDocument<128> doc;
+    response_pool::PooledJsonDocument doc;
     doc["success"] = true;
     doc["message"] = "TX power updated";
     doc["power"] = power;
@@ -530,7 +560,7 @@ static inline void register_api_handler(httpd_handle_t server, const char* uri,
                                         httpd_method_t method,
                                         esp_err_t (*handler)(httpd_req_t*)) {
   httpd_uri_t route = { .uri = uri, .method = method, .handler = handler, .user_ctx = nullptr };
-  httpd_register_uri_handler(server, &route);
+  rate_limiter::register_uri_handler(server, &route);
 }
 
 // Call this to register all Bluetooth API routes with the HTTP server
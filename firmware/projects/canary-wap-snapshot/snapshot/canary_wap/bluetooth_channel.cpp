@@ -8,6 +8,7 @@
 
 #include "bluetooth_channel.h"
 #include "nvs_store.h"
+#include "rf_presence.h"
 
 // NimBLE headers must come before health_log.h to allow #undef of conflicting macros
 #include <NimBLEDevice.h>
@@ -37,6 +38,8 @@
 #endif
 
 #include "health_log.h"
+#include "mem_budget.h"
+#include <atomic>
 
 namespace bluetooth_channel {
 
@@ -53,6 +56,8 @@ static NimBLEService* g_service = nullptr;
 static NimBLECharacteristic* g_status_char = nullptr;
 static NimBLECharacteristic* g_command_char = nullptr;
 static NimBLECharacteristic* g_notify_char = nullptr;
+static NimBLECharacteristic* g_bulk_char = nullptr;
+static uint16_t g_conn_handle = BLE_HS_CONN_HANDLE_NONE;
 static NimBLEAdvertising* g_advertising = nullptr;
 static NimBLEScan* g_scanner = nullptr;
 
@@ -83,6 +88,13 @@ static bool g_scanning = false;
 static uint32_t g_scan_start_ms = 0;
 static uint32_t g_scan_duration_ms = 0;
 
+// Background presence scan (see set_presence_scan)
+static bool g_presence_wanted = false;
+static bool g_presence_running = false;
+static volatile bool g_presence_dirty = false;  // Set from onScanEnd
+static ScanParams g_presence_params = { SCAN_INTERVAL_MS, SCAN_WINDOW_MS, false };
+static std::atomic<uint32_t> g_presence_results{0};
+
 // Statistics
 static uint32_t g_total_connections = 0;
 static uint32_t g_total_bytes_sent = 0;
@@ -91,6 +103,25 @@ static uint32_t g_advertising_start_ms = 0;
 static uint32_t g_advertising_total_ms = 0;
 static uint32_t g_connected_total_ms = 0;
 
+// Bulk transfer: stream ring filled by bulk_send_record() (the witness
+// writer task), drained by pump_bulk() from update(). g_bulk_mux guards the
+// ring indices and stats; only pump_bulk() moves the head, so it can read
+// queued bytes unlocked. Credits return from the NimBLE host task, and
+// connection changes there only request a reset that update() performs.
+PSRAM_BSS static uint8_t g_bulk_buf[BULK_BUFFER_SIZE];
+MEM_BUDGET_STATIC("ble", g_bulk_buf);
+static size_t g_bulk_head = 0;
+static size_t g_bulk_len = 0;
+static uint16_t g_bulk_seq = 0;
+static bool g_bulk_flush = false;
+static uint32_t g_bulk_oldest_ms = 0;       // When the unsent tail was queued
+static uint32_t g_bulk_burst_start_ms = 0;  // 0 when the queue is empty
+static uint32_t g_bulk_active_ms = 0;
+static std::atomic<uint8_t> g_bulk_in_flight{0};
+static BulkStats g_bulk_stats = {};
+static std::atomic<bool> g_bulk_reset_pending{false};
+static portMUX_TYPE g_bulk_mux = portMUX_INITIALIZER_UNLOCKED;
+
 // Callbacks
 static ConnectionCallback g_conn_callback = nullptr;
 static PairingCallback g_pair_callback = nullptr;
@@ -120,6 +151,9 @@ static void update_status_characteristic();
 static void handle_inactivity_timeout();
 static void handle_scan_timeout();
 static DeviceType detect_device_type(const NimBLEAdvertisedDevice* device);
+static void reset_bulk();
+static void apply_presence_scan();
+static void pump_bulk(uint32_t now);
 
 // ════════════════════════════════════════════════════════════════════════════
 // BLE CALLBACKS
@@ -138,6 +172,16 @@ class ServerCallbacks : public NimBLEServerCallbacks {
     g_connection.last_activity_ms = millis();
     g_connection.bytes_sent = 0;
     g_connection.bytes_received = 0;
+    g_connection.mtu = connInfo.getMTU();
+    g_connection.phy_2m = false;
+    g_conn_handle = connInfo.getConnHandle();
+    g_bulk_reset_pending.store(true);
+
+    // Bulk throughput: 2M PHY, full-length LL packets, short interval
+    // (7.5-15 ms). The central may refuse any of these.
+    server->updatePhy(g_conn_handle, BLE_GAP_LE_PHY_2M_MASK, BLE_GAP_LE_PHY_2M_MASK, 0);
+    server->setDataLen(g_conn_handle, BULK_DATA_LEN);
+    server->updateConnParams(g_conn_handle, 6, 12, 0, 400);
 
     // Update security level
     if (connInfo.isEncrypted()) {
@@ -181,6 +225,8 @@ class ServerCallbacks : public NimBLEServerCallbacks {
     }
 
     memset(&g_connection, 0, sizeof(g_connection));
+    g_conn_handle = BLE_HS_CONN_HANDLE_NONE;
+    g_bulk_reset_pending.store(true);
     set_state(BT_IDLE);
 
     // Resume advertising if enabled
@@ -189,6 +235,14 @@ class ServerCallbacks : public NimBLEServerCallbacks {
     }
   }
 
+  void onMTUChange(uint16_t mtu, NimBLEConnInfo& connInfo) override {
+    g_connection.mtu = mtu;
+  }
+
+  void onPhyUpdate(NimBLEConnInfo& connInfo, uint8_t txPhy, uint8_t rxPhy) override {
+    g_connection.phy_2m = (txPhy == BLE_GAP_LE_PHY_2M);
+  }
+
   void onAuthenticationComplete(NimBLEConnInfo& connInfo) override {
     if (connInfo.isAuthenticated()) {
       g_connection.security = SEC_AUTHENTICATED;
@@ -295,8 +349,27 @@ class CharacteristicCallbacks : public NimBLECharacteristicCallbacks {
   }
 };
 
+class BulkCallbacks : public NimBLECharacteristicCallbacks {
+  // Fires once per notification the host hands to the controller
+  void onStatus(NimBLECharacteristic* characteristic, int code) override {
+    uint8_t n = g_bulk_in_flight.load(std::memory_order_relaxed);
+    while (n > 0 && !g_bulk_in_flight.compare_exchange_weak(n, n - 1, std::memory_order_relaxed)) {
+    }
+  }
+};
+
 class ScanCallbacks : public NimBLEScanCallbacks {
   void onResult(const NimBLEAdvertisedDevice* device) override {
+    // PRIVACY: presence gets the address only to derive its session token
+    if (g_presence_wanted) {
+      rf_presence::feed_ble_scan(device->getAddress().getBase()->val,
+                                 device->getRSSI(), device->isConnectable());
+      g_presence_results.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // The device list belongs to manual scans only
+    if (!g_scanning) return;
+
     // Check if already in list
     for (size_t i = 0; i < g_scanned_count; i++) {
       if (memcmp(g_scanned_devices[i].address, device->getAddress().getBase()->val, BLE_ADDRESS_LENGTH) == 0) {
@@ -332,6 +405,9 @@ class ScanCallbacks : public NimBLEScanCallbacks {
   }
 
   void onScanEnd(const NimBLEScanResults& /*results*/, int /*reason*/) override {
+    g_presence_running = false;
+    g_presence_dirty = true;  // Resume presence scanning from update()
+    if (!g_scanning) return;
     g_scanning = false;
     set_state(g_connection.connected ? BT_CONNECTED : BT_IDLE);
     log_health(LOG_LEVEL_INFO, LOG_CAT_BLUETOOTH, "BLE scan complete",
@@ -341,6 +417,7 @@ class ScanCallbacks : public NimBLEScanCallbacks {
 
 static ServerCallbacks g_server_callbacks;
 static CharacteristicCallbacks g_char_callbacks;
+static BulkCallbacks g_bulk_callbacks;
 static ScanCallbacks g_scan_callbacks;
 
 // ════════════════════════════════════════════════════════════════════════════
@@ -441,6 +518,100 @@ static void update_status_characteristic() {
   }
 }
 
+// ════════════════════════════════════════════════════════════════════════════
+// BULK TRANSFER
+// ════════════════════════════════════════════════════════════════════════════
+
+// update() only: pump_bulk() must not be mid-notification
+static void reset_bulk() {
+  portENTER_CRITICAL(&g_bulk_mux);
+  g_bulk_head = 0;
+  g_bulk_len = 0;
+  g_bulk_seq = 0;
+  g_bulk_flush = false;
+  if (g_bulk_burst_start_ms) {
+    g_bulk_active_ms += millis() - g_bulk_burst_start_ms;
+    g_bulk_burst_start_ms = 0;
+  }
+  g_bulk_in_flight.store(0, std::memory_order_relaxed);
+  portEXIT_CRITICAL(&g_bulk_mux);
+}
+
+static void bulk_append(const uint8_t* data, size_t len) {
+  size_t tail = (g_bulk_head + g_bulk_len) % BULK_BUFFER_SIZE;
+  size_t first = BULK_BUFFER_SIZE - tail;
+  if (first > len) first = len;
+  memcpy(g_bulk_buf + tail, data, first);
+  memcpy(g_bulk_buf, data + first, len - first);
+  g_bulk_len += len;
+}
+
+static void bulk_peek(uint8_t* out, size_t len) {
+  size_t first = BULK_BUFFER_SIZE - g_bulk_head;
+  if (first > len) first = len;
+  memcpy(out, g_bulk_buf + g_bulk_head, first);
+  memcpy(out + first, g_bulk_buf, len - first);
+}
+
+static void pump_bulk(uint32_t now) {
+  if (!g_bulk_char || !g_connection.connected) return;
+
+  uint16_t mtu = g_connection.mtu ? g_connection.mtu : BLE_DEFAULT_MTU;
+  if (mtu > BULK_PREFERRED_MTU) mtu = BULK_PREFERRED_MTU;
+  size_t payload_max = mtu - 3 - BULK_HEADER_LEN;  // 3 = ATT notify header
+  uint8_t frame[BULK_PREFERRED_MTU];
+
+  while (g_bulk_in_flight.load(std::memory_order_relaxed) < BULK_CREDITS) {
+    portENTER_CRITICAL(&g_bulk_mux);
+    size_t pending = g_bulk_len;
+    bool flush = g_bulk_flush;
+    uint32_t oldest_ms = g_bulk_oldest_ms;
+    portEXIT_CRITICAL(&g_bulk_mux);
+
+    // Give more records a moment to fill the notification
+    if (pending == 0 ||
+        (pending < payload_max && !flush && now - oldest_ms < BULK_COALESCE_MS)) {
+      break;
+    }
+
+    // The writer only appends past `pending`, so these bytes are stable
+    size_t n = pending < payload_max ? pending : payload_max;
+    frame[0] = g_bulk_seq & 0xFF;
+    frame[1] = g_bulk_seq >> 8;
+    bulk_peek(frame + BULK_HEADER_LEN, n);
+
+    g_bulk_in_flight.fetch_add(1, std::memory_order_relaxed);
+    if (!g_bulk_char->notify(frame, n + BULK_HEADER_LEN, g_conn_handle)) {
+      g_bulk_in_flight.fetch_sub(1, std::memory_order_relaxed);
+      portENTER_CRITICAL(&g_bulk_mux);
+      g_bulk_stats.retries++;  // Host out of mbufs; keep the bytes for later
+      portEXIT_CRITICAL(&g_bulk_mux);
+      break;
+    }
+
+    portENTER_CRITICAL(&g_bulk_mux);
+    g_bulk_head = (g_bulk_head + n) % BULK_BUFFER_SIZE;
+    g_bulk_len -= n;
+    g_bulk_stats.notifications++;
+    g_bulk_stats.bytes_sent += n;
+    portEXIT_CRITICAL(&g_bulk_mux);
+    g_bulk_seq++;
+    g_connection.bytes_sent += n + BULK_HEADER_LEN;
+    g_total_bytes_sent += n + BULK_HEADER_LEN;
+    g_connection.last_activity_ms = now;
+  }
+
+  portENTER_CRITICAL(&g_bulk_mux);
+  if (g_bulk_len == 0) {
+    g_bulk_flush = false;
+    if (g_bulk_burst_start_ms) {
+      g_bulk_active_ms += now - g_bulk_burst_start_ms;
+      g_bulk_burst_start_ms = 0;
+    }
+  }
+  portEXIT_CRITICAL(&g_bulk_mux);
+}
+
 static void handle_inactivity_timeout() {
   if (!g_connection.connected) return;
   if (g_settings.inactivity_timeout_ms == 0) return;
@@ -515,6 +686,7 @@ bool init() {
   // Initialize NimBLE
   NimBLEDevice::init(g_settings.device_name);
   NimBLEDevice::setPower(ESP_PWR_LVL_P3);  // +3 dBm
+  NimBLEDevice::setMTU(BULK_PREFERRED_MTU);
 
   // Set security
   NimBLEDevice::setSecurityAuth(true, true, true);  // bonding, MITM, SC
@@ -545,6 +717,12 @@ bool init() {
     NIMBLE_PROPERTY::NOTIFY | NIMBLE_PROPERTY::INDICATE
   );
 
+  g_bulk_char = g_service->createCharacteristic(
+    BULK_CHAR_UUID,
+    NIMBLE_PROPERTY::NOTIFY
+  );
+  g_bulk_char->setCallbacks(&g_bulk_callbacks);
+
   // Start service
   g_service->start();
 
@@ -590,6 +768,7 @@ void deinit() {
   g_status_char = nullptr;
   g_command_char = nullptr;
   g_notify_char = nullptr;
+  g_bulk_char = nullptr;
   g_advertising = nullptr;
   g_scanner = nullptr;
 
@@ -671,6 +850,15 @@ bool start_scan(uint32_t duration_ms) {
   // Clear previous results
   clear_scan_results();
 
+  // Manual scans take the scanner at the fixed interactive duty cycle
+  if (g_presence_running) {
+    g_scanner->stop();
+    g_presence_running = false;
+  }
+  g_scanner->setActiveScan(true);
+  g_scanner->setInterval(SCAN_INTERVAL_MS);
+  g_scanner->setWindow(SCAN_WINDOW_MS);
+
   g_scan_start_ms = millis();
   g_scan_duration_ms = duration_ms;
   g_scanning = true;
@@ -692,9 +880,48 @@ void stop_scan() {
       set_state(g_connection.connected ? BT_CONNECTED : BT_IDLE);
     }
     log_health(LOG_LEVEL_DEBUG, LOG_CAT_BLUETOOTH, "BLE scan stopped", nullptr);
+    g_presence_dirty = true;
   }
 }
 
+static void apply_presence_scan() {
+  g_presence_dirty = false;
+  if (!g_scanner || g_scanning) return;  // A manual scan owns the scanner
+
+  if (g_presence_running) {
+    g_scanner->stop();
+    g_presence_running = false;
+  }
+  if (!g_presence_wanted || !g_settings.enabled) return;
+
+  g_scanner->setActiveScan(g_presence_params.active);
+  g_scanner->setInterval(g_presence_params.interval_ms);
+  g_scanner->setWindow(g_presence_params.window_ms);
+  g_presence_running = g_scanner->start(0, false);  // 0 = until stopped
+}
+
+void set_presence_scan(bool enabled, const ScanParams& params) {
+  ScanParams p = params;
+  if (p.interval_ms == 0) p.interval_ms = SCAN_INTERVAL_MS;
+  if (p.window_ms == 0 || p.window_ms > p.interval_ms) p.window_ms = p.interval_ms;
+
+  bool changed = enabled != g_presence_wanted ||
+                 p.interval_ms != g_presence_params.interval_ms ||
+                 p.window_ms != g_presence_params.window_ms ||
+                 p.active != g_presence_params.active;
+  g_presence_wanted = enabled;
+  g_presence_params = p;
+  if (changed) apply_presence_scan();
+}
+
+bool is_presence_scanning() {
+  return g_presence_running;
+}
+
+uint32_t get_presence_scan_results() {
+  return g_presence_results.load(std::memory_order_relaxed);
+}
+
 bool is_scanning() {
   return g_scanning;
 }
@@ -1000,12 +1227,73 @@ void set_data_callback(DataCallback cb) {
   g_data_callback = cb;
 }
 
+bool bulk_send_record(const uint8_t* data, size_t len) {
+  // Bulk data may be logs or witness records: encrypted links only
+  if (!g_connection.connected || g_connection.security == SEC_NONE) return false;
+
+  uint32_t now = millis();
+  uint8_t prefix[2] = { (uint8_t)(len & 0xFF), (uint8_t)(len >> 8) };
+  bool queued = false;
+
+  // Queue only; update() pumps. A pending reset would discard the record.
+  portENTER_CRITICAL(&g_bulk_mux);
+  if (len > 0 && len <= BULK_MAX_RECORD_LEN && !g_bulk_reset_pending.load() &&
+      g_bulk_len + sizeof(prefix) + len <= BULK_BUFFER_SIZE) {
+    if (g_bulk_len == 0) {
+      g_bulk_oldest_ms = now;
+      g_bulk_burst_start_ms = now;
+    }
+    bulk_append(prefix, sizeof(prefix));
+    bulk_append(data, len);
+    g_bulk_stats.records_queued++;
+    queued = true;
+  } else {
+    g_bulk_stats.records_dropped++;
+  }
+  portEXIT_CRITICAL(&g_bulk_mux);
+  return queued;
+}
+
+// loop() only
+void bulk_flush() {
+  g_bulk_flush = true;
+  pump_bulk(millis());
+}
+
+BulkStats get_bulk_stats() {
+  uint32_t now = millis();
+  portENTER_CRITICAL(&g_bulk_mux);
+  BulkStats stats = g_bulk_stats;
+  stats.pending_bytes = g_bulk_len;
+  uint32_t active_ms = g_bulk_active_ms;
+  if (g_bulk_burst_start_ms) active_ms += now - g_bulk_burst_start_ms;
+  portEXIT_CRITICAL(&g_bulk_mux);
+
+  stats.mtu = g_connection.mtu;
+  stats.phy_2m = g_connection.phy_2m;
+  stats.in_flight = g_bulk_in_flight.load(std::memory_order_relaxed);
+  stats.throughput_bps = active_ms ? (uint32_t)((uint64_t)stats.bytes_sent * 1000 / active_ms) : 0;
+  return stats;
+}
+
 void update() {
   if (!g_initialized || !g_settings.enabled) return;
 
   static uint32_t last_status_update = 0;
   uint32_t now = millis();
 
+  // Connection changed on the host task since the last pass
+  if (g_bulk_reset_pending.load()) {
+    reset_bulk();
+    g_bulk_reset_pending.store(false);
+  }
+  pump_bulk(now);
+
+  // Presence scanning was paused by a user scan or a scan window ended
+  if (g_presence_dirty) {
+    apply_presence_scan();
+  }
+
   // Update status characteristic periodically
   if (g_connection.connected && now - last_status_update >= STATUS_UPDATE_INTERVAL_MS) {
     last_status_update = now;
@@ -9,7 +9,7 @@
  * - Secure pairing with PIN confirmation
  * - Device whitelist for trusted connections
  * - Auto-disconnect on inactivity
- * - No sensitive data over BLE (status only)
+ * - Bulk data (logs, witness records) only over encrypted links
  *
  * Features:
  * - Device status broadcasting
@@ -17,6 +17,16 @@
  * - Scan for nearby BLE devices
  * - Connection status monitoring
  * - Device name configuration
+ * - Bulk transfer with negotiated MTU and 2M PHY
+ *
+ * Bulk transfer: bulk_send_record() queues records, and each notification
+ * on BULK_CHAR_UUID carries as many as fit:
+ *   [seq u16 LE][stream bytes]
+ * The stream is a run of records, each [len u16 LE][len bytes]. A record
+ * may continue into the next notification. seq restarts at 0 on every
+ * connection, and the stream starts on a record boundary. At most
+ * BULK_CREDITS notifications are in flight; a credit returns when the stack
+ * reports the notification sent.
  */
 
 #ifndef SECURACV_BLUETOOTH_CHANNEL_H
@@ -48,11 +58,22 @@ static const uint32_t INACTIVITY_TIMEOUT_MS = 300000;  // 5 minutes
 static const uint32_t STATUS_UPDATE_INTERVAL_MS = 1000;
 static const uint32_t PAIRING_TIMEOUT_MS = 60000;
 
+// Bulk transfer
+static const uint16_t BLE_DEFAULT_MTU = 23;
+static const uint16_t BULK_PREFERRED_MTU = 517;   // Offered in the client's MTU exchange
+static const uint16_t BULK_DATA_LEN = 251;        // LL data length extension (octets)
+static const size_t BULK_BUFFER_SIZE = 4096;      // Queued stream bytes
+static const size_t BULK_MAX_RECORD_LEN = 1024;
+static const size_t BULK_HEADER_LEN = 2;          // seq
+static const uint8_t BULK_CREDITS = 6;            // Notifications in flight
+static const uint32_t BULK_COALESCE_MS = 20;      // Hold a part-filled notification
+
 // BLE UUIDs (SecuraCV custom service)
 static const char* SERVICE_UUID = "8fc1ceca-b162-4401-9607-c8ac21383e90";
 static const char* STATUS_CHAR_UUID = "8fc1cecb-b162-4401-9607-c8ac21383e90";
 static const char* COMMAND_CHAR_UUID = "8fc1cecc-b162-4401-9607-c8ac21383e90";
 static const char* NOTIFY_CHAR_UUID = "8fc1cecd-b162-4401-9607-c8ac21383e90";
+static const char* BULK_CHAR_UUID = "8fc1cece-b162-4401-9607-c8ac21383e90";
 
 // ════════════════════════════════════════════════════════════════════════════
 // ENUMS
@@ -138,6 +159,22 @@ struct ConnectionInfo {
   uint32_t last_activity_ms;
   uint32_t bytes_sent;
   uint32_t bytes_received;
+  uint16_t mtu;                             // Negotiated ATT MTU
+  bool phy_2m;                              // LE 2M PHY in use
+};
+
+// Bulk transfer statistics
+struct BulkStats {
+  uint16_t mtu;
+  bool phy_2m;
+  uint32_t records_queued;
+  uint32_t records_dropped;                 // Not connected, unencrypted or buffer full
+  uint32_t notifications;
+  uint32_t retries;                         // Stack out of buffers, resent later
+  uint32_t bytes_sent;                      // Stream bytes handed to the stack
+  uint32_t pending_bytes;
+  uint8_t in_flight;
+  uint32_t throughput_bps;                  // Bytes/s while data was queued
 };
 
 // Pairing session
@@ -174,6 +211,13 @@ struct BluetoothStatus {
   uint32_t connected_time_ms;
 };
 
+// Scanner duty cycle (window <= interval; duty = window / interval)
+struct ScanParams {
+  uint16_t interval_ms;
+  uint16_t window_ms;
+  bool active;                              // Send scan requests (extra TX airtime)
+};
+
 // Bluetooth settings (persisted to NVS)
 struct BluetoothSettings {
   bool enabled;
@@ -228,6 +272,13 @@ bool is_scanning();
 const ScannedDevice* get_scanned_devices(size_t* count);
 void clear_scan_results();
 
+// Background presence scan, paced by scan_scheduler. Results go only to
+// rf_presence::feed_ble_scan(); no address is kept here. A manual
+// start_scan() pauses it, and it resumes once the manual scan ends.
+void set_presence_scan(bool enabled, const ScanParams& params);
+bool is_presence_scanning();
+uint32_t get_presence_scan_results();
+
 // Pairing
 bool start_pairing();
 void cancel_pairing();
@@ -254,6 +305,11 @@ bool set_settings(const BluetoothSettings& settings);
 bool set_device_name(const char* name);
 bool set_tx_power(int8_t power);
 
+// Bulk transfer (queue a record from any task; false if it cannot be sent)
+bool bulk_send_record(const uint8_t* data, size_t len);
+void bulk_flush();                          // loop(): send a part-filled notification now
+BulkStats get_bulk_stats();
+
 // Status
 BluetoothStatus get_status();
 BluetoothState get_state();
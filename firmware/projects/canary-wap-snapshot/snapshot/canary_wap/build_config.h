@@ -47,6 +47,8 @@
   #define FEATURE_MESH_NETWORK  0
   #define FEATURE_BLUETOOTH     0
   #define FEATURE_SYS_MONITOR   0
+  #define FEATURE_RF_PRESENCE   0
+  #define FEATURE_WITNESS_COALESCE 0   // One record per sample for chain testing
 
   #define DEBUG_NMEA            0
   #define DEBUG_CBOR            0
@@ -69,6 +71,8 @@
   #define FEATURE_MESH_NETWORK  0   // Skip mesh (saves ~15s)
   #define FEATURE_BLUETOOTH     0   // Skip BLE (saves ~25s)
   #define FEATURE_SYS_MONITOR   1
+  #define FEATURE_RF_PRESENCE   0   // Skip RF presence and probe capture
+  #define FEATURE_WITNESS_COALESCE 1
 
   #define DEBUG_NMEA            0
   #define DEBUG_CBOR            0
@@ -90,6 +94,8 @@
   #define FEATURE_MESH_NETWORK  1
   #define FEATURE_BLUETOOTH     1
   #define FEATURE_SYS_MONITOR   1
+  #define FEATURE_RF_PRESENCE   1   // BLE tokens + duty-cycled probe capture
+  #define FEATURE_WITNESS_COALESCE 1   // Fold unchanged stationary samples into runs
 
   #define DEBUG_NMEA            0
   #define DEBUG_CBOR            0
@@ -12,8 +12,10 @@
 #define SECURACV_CHIRP_API_H
 
 #include "esp_http_server.h"
+#include "rate_limiter.h"
 #include "mesh_network.h"
 #include <ArduinoJson.h>
+#include "response_pool.h"
 
 namespace chirp_api {
 
@@ -25,7 +27,7 @@ namespace chirp_api {
 inline esp_err_t handle_chirp_status(httpd_req_t* req) {
   chirp_channel::ChirpStatus status = chirp_channel::get_status();
 
-  StaticJsonDocument<768> doc;
+  response_pool::PooledJsonDocument doc;
   doc["state"] = chirp_channel::state_name(status.state);
   doc["session_emoji"] = status.session_emoji;
   doc["nearby_count"] = status.nearby_count;
@@ -64,7 +66,7 @@ inline esp_err_t handle_chirp_nearby(httpd_req_t* req) {
   size_t count;
   const chirp_channel::NearbyDevice* devices = chirp_channel::get_nearby_devices(&count);
 
-  StaticJsonDocument<3072> doc;
+  response_pool::PooledJsonDocument doc;
   doc["count"] = count;
 
   JsonArray arr = doc.createNestedArray("devices");
@@ -76,12 +78,7 @@ inline esp_err_t handle_chirp_nearby(httpd_req_t* req) {
     dev["listening"] = devices[i].listening;
   }
 
-  char buffer[3072];
-  serializeJson(doc, buffer);
-
-  httpd_resp_set_type(req, "application/json");
-  httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
-  return httpd_resp_sendstr(req, buffer);
+  return response_pool::send_json(req, doc);
 }
 
 // GET /api/chirp/recent - Recent community chirps
@@ -89,7 +86,7 @@ inline esp_err_t handle_chirp_recent(httpd_req_t* req) {
   size_t count;
   const chirp_channel::ReceivedChirp* chirps = chirp_channel::get_recent_chirps(&count);
 
-  DynamicJsonDocument doc(4096);
+  response_pool::PooledJsonDocument doc;
   JsonArray arr = doc.createNestedArray("chirps");
 
   for (size_t i = 0; i < count; i++) {
@@ -124,25 +121,14 @@ inline esp_err_t handle_chirp_recent(httpd_req_t* req) {
     c["nonce"] = nonce_hex;
   }
 
-  char* buffer = (char*)malloc(4096);
-  if (!buffer) {
-    httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Memory allocation failed");
-    return ESP_FAIL;
-  }
-
-  serializeJson(doc, buffer, 4096);
-  httpd_resp_set_type(req, "application/json");
-  httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
-  esp_err_t ret = httpd_resp_sendstr(req, buffer);
-  free(buffer);
-  return ret;
+  return response_pool::send_json(req, doc);
 }
 
 // POST /api/chirp/enable - Enable chirp channel
 inline esp_err_t handle_chirp_enable(httpd_req_t* req) {
   bool success = chirp_channel::enable();
 
-  StaticJsonDocument<128> doc;
+  response_pool::PooledJsonDocument doc;
   doc["success"] = success;
   if (success) {
     doc["session_emoji"] = chirp_channel::get_session_emoji();
@@ -162,7 +148,7 @@ inline esp_err_t handle_chirp_enable(httpd_req_t* req) {
 inline esp_err_t handle_chirp_disable(httpd_req_t* req) {
   chirp_channel::disable();
 
-  StaticJsonDocument<64> doc;
+  response_pool::PooledJsonDocument doc;
   doc["success"] = true;
 
   char buffer[64];
@@ -187,7 +173,7 @@ inline esp_err_t handle_chirp_send(httpd_req_t* req) {
   content[content_len] = '\0';
 
   // Parse JSON
-  StaticJsonDocument<256> input;
+  response_pool::PooledJsonDocument input;
   DeserializationError err = deserializeJson(input, content);
   if (err) {
     httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid JSON");
@@ -204,7 +190,7 @@ inline esp_err_t handle_chirp_send(httpd_req_t* req) {
 
   // Validate template exists
   if (!chirp_channel::is_valid_template(template_id)) {
-    StaticJsonDocument<256> doc;
+    response_pool::PooledJsonDocument doc;
     doc["success"] = false;
     doc["error"] = "invalid_template";
     doc["message"] = "Unknown template ID";
@@ -229,7 +215,7 @@ inline esp_err_t handle_chirp_send(httpd_req_t* req) {
   // Attempt to send
   bool success = chirp_channel::send_chirp(template_id, urgency, detail, ttl);
 
-  StaticJsonDocument<384> doc;
+  response_pool::PooledJsonDocument doc;
   doc["success"] = success;
 
   if (success) {
@@ -263,7 +249,7 @@ inline esp_err_t handle_chirp_send(httpd_req_t* req) {
 
 // GET /api/chirp/templates - List available templates
 inline esp_err_t handle_chirp_templates(httpd_req_t* req) {
-  DynamicJsonDocument doc(4096);
+  response_pool::PooledJsonDocument doc;
 
   // Authority templates
   JsonArray auth = doc.createNestedArray("authority");
@@ -348,18 +334,7 @@ inline esp_err_t handle_chirp_templates(httpd_req_t* req) {
   details.add(JsonObject());
   details[5]["id"] = 12; details[5]["text"] = "spreading";
 
-  char* buffer = (char*)malloc(4096);
-  if (!buffer) {
-    httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Memory allocation failed");
-    return ESP_FAIL;
-  }
-
-  serializeJson(doc, buffer, 4096);
-  httpd_resp_set_type(req, "application/json");
-  httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
-  esp_err_t ret = httpd_resp_sendstr(req, buffer);
-  free(buffer);
-  return ret;
+  return response_pool::send_json(req, doc);
 }
 
 // POST /api/chirp/ack - Acknowledge a chirp
@@ -372,7 +347,7 @@ inline esp_err_t handle_chirp_ack(httpd_req_t* req) {
   }
   content[content_len] = '\0';
 
-  StaticJsonDocument<128> input;
+  response_pool::PooledJsonDocument input;
   DeserializationError err = deserializeJson(input, content);
   if (err) {
     httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid JSON");
@@ -401,7 +376,7 @@ inline esp_err_t handle_chirp_ack(httpd_req_t* req) {
 
   bool success = chirp_channel::acknowledge_chirp(nonce, ack_type);
 
-  StaticJsonDocument<64> doc;
+  response_pool::PooledJsonDocument doc;
   doc["success"] = success;
 
   char buffer[64];
@@ -422,7 +397,7 @@ inline esp_err_t handle_chirp_dismiss(httpd_req_t* req) {
   }
   content[content_len] = '\0';
 
-  StaticJsonDocument<64> input;
+  response_pool::PooledJsonDocument input;
   DeserializationError err = deserializeJson(input, content);
   if (err) {
     httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid JSON");
@@ -444,7 +419,7 @@ inline esp_err_t handle_chirp_dismiss(httpd_req_t* req) {
 
   bool success = chirp_channel::dismiss_chirp(nonce);
 
-  StaticJsonDocument<64> doc;
+  response_pool::PooledJsonDocument doc;
   doc["success"] = success;
 
   char buffer[64];
@@ -465,7 +440,7 @@ inline esp_err_t handle_chirp_mute(httpd_req_t* req) {
   }
   content[content_len] = '\0';
 
-  StaticJsonDocument<64> input;
+  response_pool::PooledJsonDocument input;
   DeserializationError err = deserializeJson(input, content);
   if (err) {
     httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid JSON");
@@ -476,7 +451,7 @@ inline esp_err_t handle_chirp_mute(httpd_req_t* req) {
 
   bool success = chirp_channel::mute(duration);
 
-  StaticJsonDocument<64> doc;
+  response_pool::PooledJsonDocument doc;
   doc["success"] = success;
   if (!success) {
     doc["error"] = "invalid_duration";
@@ -495,7 +470,7 @@ inline esp_err_t handle_chirp_mute(httpd_req_t* req) {
 inline esp_err_t handle_chirp_unmute(httpd_req_t* req) {
   chirp_channel::unmute();
 
-  StaticJsonDocument<64> doc;
+  response_pool::PooledJsonDocument doc;
   doc["success"] = true;
 
   char buffer[64];
@@ -516,7 +491,7 @@ inline esp_err_t handle_chirp_settings(httpd_req_t* req) {
   }
   content[content_len] = '\0';
 
-  StaticJsonDocument<128> input;
+  response_pool::PooledJsonDocument input;
   DeserializationError err = deserializeJson(input, content);
   if (err) {
     httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid JSON");
@@ -538,7 +513,7 @@ inline esp_err_t handle_chirp_settings(httpd_req_t* req) {
   }
 
   // Return current settings
-  StaticJsonDocument<128> doc;
+  response_pool::PooledJsonDocument doc;
   doc["success"] = true;
   doc["relay_enabled"] = chirp_channel::is_relay_enabled();
   doc["urgency_filter"] = chirp_channel::urgency_name(chirp_channel::get_urgency_filter());
@@ -561,7 +536,7 @@ inline esp_err_t handle_chirp_confirm(httpd_req_t* req) {
   }
   content[content_len] = '\0';
 
-  StaticJsonDocument<64> input;
+  response_pool::PooledJsonDocument input;
   DeserializationError err = deserializeJson(input, content);
   if (err) {
     httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid JSON");
@@ -583,7 +558,7 @@ inline esp_err_t handle_chirp_confirm(httpd_req_t* req) {
 
   bool success = chirp_channel::confirm_chirp(nonce);
 
-  StaticJsonDocument<64> doc;
+  response_pool::PooledJsonDocument doc;
   doc["success"] = success;
   if (!success) {
     doc["error"] = "not_found";
@@ -611,7 +586,7 @@ inline void register_routes(httpd_handle_t server) {
     .handler = handle_chirp_status,
     .user_ctx = nullptr
   };
-  httpd_register_uri_handler(server, &chirp_status);
+  rate_limiter::register_uri_handler(server, &chirp_status);
 
   httpd_uri_t chirp_nearby = {
     .uri = "/api/chirp/nearby",
@@ -619,7 +594,7 @@ inline void register_routes(httpd_handle_t server) {
     .handler = handle_chirp_nearby,
     .user_ctx = nullptr
   };
-  httpd_register_uri_handler(server, &chirp_nearby);
+  rate_limiter::register_uri_handler(server, &chirp_nearby);
 
   httpd_uri_t chirp_recent = {
     .uri = "/api/chirp/recent",
@@ -627,7 +602,7 @@ inline void register_routes(httpd_handle_t server) {
     .handler = handle_chirp_recent,
     .user_ctx = nullptr
   };
-  httpd_register_uri_handler(server, &chirp_recent);
+  rate_limiter::register_uri_handler(server, &chirp_recent);
 
   httpd_uri_t chirp_templates = {
     .uri = "/api/chirp/templates",
@@ -635,7 +610,7 @@ inline void register_routes(httpd_handle_t server) {
     .handler = handle_chirp_templates,
     .user_ctx = nullptr
   };
-  httpd_register_uri_handler(server, &chirp_templates);
+  rate_limiter::register_uri_handler(server, &chirp_templates);
 
   // POST endpoints
   httpd_uri_t chirp_enable = {
@@ -644,7 +619,7 @@ inline void register_routes(httpd_handle_t server) {
     .handler = handle_chirp_enable,
     .user_ctx = nullptr
   };
-  httpd_register_uri_handler(server, &chirp_enable);
+  rate_limiter::register_uri_handler(server, &chirp_enable);
 
   httpd_uri_t chirp_disable = {
     .uri = "/api/chirp/disable",
@@ -652,7 +627,7 @@ inline void register_routes(httpd_handle_t server) {
     .handler = handle_chirp_disable,
     .user_ctx = nullptr
   };
-  httpd_register_uri_handler(server, &chirp_disable);
+  rate_limiter::register_uri_handler(server, &chirp_disable);
 
   httpd_uri_t chirp_send = {
     .uri = "/api/chirp/send",
@@ -660,7 +635,7 @@ inline void register_routes(httpd_handle_t server) {
     .handler = handle_chirp_send,
     .user_ctx = nullptr
   };
-  httpd_register_uri_handler(server, &chirp_send);
+  rate_limiter::register_uri_handler(server, &chirp_send);
 
   httpd_uri_t chirp_ack = {
     .uri = "/api/chirp/ack",
@@ -668,7 +643,7 @@ inline void register_routes(httpd_handle_t server) {
     .handler = handle_chirp_ack,
     .user_ctx = nullptr
   };
-  httpd_register_uri_handler(server, &chirp_ack);
+  rate_limiter::register_uri_handler(server, &chirp_ack);
 
   httpd_uri_t chirp_dismiss = {
     .uri = "/api/chirp/dismiss",
@@ -676,7 +651,7 @@ inline void register_routes(httpd_handle_t server) {
     .handler = handle_chirp_dismiss,
     .user_ctx = nullptr
   };
-  httpd_register_uri_handler(server, &chirp_dismiss);
+  rate_limiter::register_uri_handler(server, &chirp_dismiss);
 
   httpd_uri_t chirp_mute = {
     .uri = "/api/chirp/mute",
@@ -684,7 +659,7 @@ inline void register_routes(httpd_handle_t server) {
     .handler = handle_chirp_mute,
     .user_ctx = nullptr
   };
-  httpd_register_uri_handler(server, &chirp_mute);
+  rate_limiter::register_uri_handler(server, &chirp_mute);
 
   httpd_uri_t chirp_unmute = {
     .uri = "/api/chirp/unmute",
@@ -692,7 +667,7 @@ inline void register_routes(httpd_handle_t server) {
     .handler = handle_chirp_unmute,
     .user_ctx = nullptr
   };
-  httpd_register_uri_handler(server, &chirp_unmute);
+  rate_limiter::register_uri_handler(server, &chirp_unmute);
 
   httpd_uri_t chirp_confirm = {
     .uri = "/api/chirp/confirm",
@@ -700,7 +675,7 @@ inline void register_routes(httpd_handle_t server) {
     .handler = handle_chirp_confirm,
     .user_ctx = nullptr
   };
-  httpd_register_uri_handler(server, &chirp_confirm);
+  rate_limiter::register_uri_handler(server, &chirp_confirm);
 
   httpd_uri_t chirp_settings = {
     .uri = "/api/chirp/settings",
@@ -708,7 +683,7 @@ inline void register_routes(httpd_handle_t server) {
     .handler = handle_chirp_settings,
     .user_ctx = nullptr
   };
-  httpd_register_uri_handler(server, &chirp_settings);
+  rate_limiter::register_uri_handler(server, &chirp_settings);
 }
 
 } // namespace chirp_api
@@ -22,6 +22,7 @@
 #include "mesh_network.h"
 #include "nvs_store.h"
 #include "health_log.h"
+#include "radio_scheduler.h"
 #include <esp_now.h>
 #include <esp_wifi.h>
 #include <WiFi.h>
@@ -63,8 +64,27 @@ static ReceivedChirp g_recent_chirps[MAX_RECENT_CHIRPS];
 static size_t g_recent_chirp_count = 0;
 static NearbyDevice g_nearby_devices[MAX_NEARBY_CACHE];
 static size_t g_nearby_count = 0;
-static uint8_t g_nonce_cache[MAX_NONCE_CACHE][8];
-static size_t g_nonce_cache_idx = 0;
+
+// Nonce set: open addressing, an entry is free once it outlives CHIRP_TTL_MS
+struct NonceEntry {
+  uint8_t nonce[8];
+  uint32_t seen_ms;                             // 0 = never used
+};
+static NonceEntry g_nonce_set[NONCE_SET_SIZE];
+static uint32_t g_nonce_hash_key = 0;           // Random odd multiplier
+static uint32_t g_nonce_evictions = 0;          // Live nonces displaced
+
+// Relays waiting out their backoff, keyed by nonce
+struct PendingRelay {
+  uint8_t nonce[8];
+  uint32_t due_ms;
+  uint8_t p_base;                               // Percent before duplicates
+  uint8_t dups;                                 // Weighted duplicates heard
+  bool active;
+};
+static PendingRelay g_pending_relays[RELAY_PENDING_SLOTS];
+static uint32_t g_relays_sent = 0;
+static uint32_t g_relays_suppressed = 0;
 
 // Callbacks
 static ChirpReceivedCallback g_chirp_callback = nullptr;
@@ -96,59 +116,63 @@ static const char* EMOJI_SET[16] = {
 // Emergency-focused templates — "Witness authority, not neighbors"
 // ════════════════════════════════════════════════════════════════════════════
 
+// Template flags
+static const uint8_t TPL_NIGHT_OK = 0x01;  // Can be sent during night mode
+static const uint8_t TPL_SAFETY = 0x02;    // Relays after CONFIRMATIONS_SAFETY
+
 struct TemplateEntry {
   ChirpTemplate id;
   const char* text;
   ChirpCategory category;
-  bool night_allowed;  // Can be sent during night mode
+  uint8_t flags;
 };
 
-static const TemplateEntry TEMPLATE_TABLE[] = {
+static constexpr TemplateEntry TEMPLATE_TABLE[] = {
   // Authority Presence — When power shows up
-  { TPL_AUTH_POLICE_ACTIVITY,     "police activity in area",       CHIRP_CAT_AUTHORITY, true },
-  { TPL_AUTH_HEAVY_RESPONSE,      "heavy law enforcement response", CHIRP_CAT_AUTHORITY, true },
-  { TPL_AUTH_ROAD_BLOCKED_LE,     "road blocked by law enforcement", CHIRP_CAT_AUTHORITY, true },
-  { TPL_AUTH_HELICOPTER,          "helicopter circling area",       CHIRP_CAT_AUTHORITY, true },
-  { TPL_AUTH_FEDERAL_PRESENCE,    "federal agents in area",         CHIRP_CAT_AUTHORITY, true },
+  { TPL_AUTH_POLICE_ACTIVITY,     "police activity in area",         CHIRP_CAT_AUTHORITY,   TPL_NIGHT_OK },
+  { TPL_AUTH_HEAVY_RESPONSE,      "heavy law enforcement response",  CHIRP_CAT_AUTHORITY,   TPL_NIGHT_OK },
+  { TPL_AUTH_ROAD_BLOCKED_LE,     "road blocked by law enforcement", CHIRP_CAT_AUTHORITY,   TPL_NIGHT_OK },
+  { TPL_AUTH_HELICOPTER,          "helicopter circling area",        CHIRP_CAT_AUTHORITY,   TPL_NIGHT_OK },
+  { TPL_AUTH_FEDERAL_PRESENCE,    "federal agents in area",          CHIRP_CAT_AUTHORITY,   TPL_NIGHT_OK },
 
   // Infrastructure — Systems failing
-  { TPL_INFRA_POWER_OUT,          "power outage",                   CHIRP_CAT_INFRA, true },
-  { TPL_INFRA_WATER_ISSUE,        "water service disruption",       CHIRP_CAT_INFRA, true },
-  { TPL_INFRA_GAS_SMELL,          "gas smell - evacuate?",          CHIRP_CAT_INFRA, true },
-  { TPL_INFRA_INTERNET_DOWN,      "internet outage in area",        CHIRP_CAT_INFRA, false },
-  { TPL_INFRA_ROAD_CLOSED,        "road closed or blocked",         CHIRP_CAT_INFRA, false },
+  { TPL_INFRA_POWER_OUT,          "power outage",                    CHIRP_CAT_INFRA,       TPL_NIGHT_OK },
+  { TPL_INFRA_WATER_ISSUE,        "water service disruption",        CHIRP_CAT_INFRA,       TPL_NIGHT_OK },
+  { TPL_INFRA_GAS_SMELL,          "gas smell - evacuate?",           CHIRP_CAT_INFRA,       TPL_NIGHT_OK },
+  { TPL_INFRA_INTERNET_DOWN,      "internet outage in area",         CHIRP_CAT_INFRA,       0 },
+  { TPL_INFRA_ROAD_CLOSED,        "road closed or blocked",          CHIRP_CAT_INFRA,       0 },
 
   // Emergency — Immediate danger
-  { TPL_EMERG_FIRE_VISIBLE,       "fire or smoke visible",          CHIRP_CAT_EMERGENCY, true },
-  { TPL_EMERG_MEDICAL_SCENE,      "medical emergency scene",        CHIRP_CAT_EMERGENCY, true },
-  { TPL_EMERG_MULTIPLE_AMBULANCE, "multiple ambulances responding", CHIRP_CAT_EMERGENCY, true },
-  { TPL_EMERG_EVACUATION,         "evacuation in progress",         CHIRP_CAT_EMERGENCY, true },
-  { TPL_EMERG_SHELTER_IN_PLACE,   "shelter in place advisory",      CHIRP_CAT_EMERGENCY, true },
+  { TPL_EMERG_FIRE_VISIBLE,       "fire or smoke visible",           CHIRP_CAT_EMERGENCY,   TPL_NIGHT_OK | TPL_SAFETY },
+  { TPL_EMERG_MEDICAL_SCENE,      "medical emergency scene",         CHIRP_CAT_EMERGENCY,   TPL_NIGHT_OK | TPL_SAFETY },
+  { TPL_EMERG_MULTIPLE_AMBULANCE, "multiple ambulances responding",  CHIRP_CAT_EMERGENCY,   TPL_NIGHT_OK | TPL_SAFETY },
+  { TPL_EMERG_EVACUATION,         "evacuation in progress",          CHIRP_CAT_EMERGENCY,   TPL_NIGHT_OK | TPL_SAFETY },
+  { TPL_EMERG_SHELTER_IN_PLACE,   "shelter in place advisory",       CHIRP_CAT_EMERGENCY,   TPL_NIGHT_OK | TPL_SAFETY },
 
   // Weather — Environmental threats
-  { TPL_WX_SEVERE_WARNING,        "severe weather warning",         CHIRP_CAT_WEATHER, true },
-  { TPL_WX_TORNADO,               "tornado warning",                CHIRP_CAT_WEATHER, true },
-  { TPL_WX_FLOOD,                 "flooding reported",              CHIRP_CAT_WEATHER, true },
-  { TPL_WX_LIGHTNING_CLOSE,       "dangerous lightning nearby",     CHIRP_CAT_WEATHER, true },
+  { TPL_WX_SEVERE_WARNING,        "severe weather warning",          CHIRP_CAT_WEATHER,     TPL_NIGHT_OK | TPL_SAFETY },
+  { TPL_WX_TORNADO,               "tornado warning",                 CHIRP_CAT_WEATHER,     TPL_NIGHT_OK | TPL_SAFETY },
+  { TPL_WX_FLOOD,                 "flooding reported",               CHIRP_CAT_WEATHER,     TPL_NIGHT_OK | TPL_SAFETY },
+  { TPL_WX_LIGHTNING_CLOSE,       "dangerous lightning nearby",      CHIRP_CAT_WEATHER,     TPL_NIGHT_OK | TPL_SAFETY },
 
   // Mutual Aid — Community support
-  { TPL_AID_WELFARE_CHECK,        "neighbor may need help",         CHIRP_CAT_MUTUAL_AID, false },
-  { TPL_AID_SUPPLIES_NEEDED,      "supplies needed in area",        CHIRP_CAT_MUTUAL_AID, false },
-  { TPL_AID_OFFERING_HELP,        "offering assistance",            CHIRP_CAT_MUTUAL_AID, false },
+  { TPL_AID_WELFARE_CHECK,        "neighbor may need help",          CHIRP_CAT_MUTUAL_AID,  0 },
+  { TPL_AID_SUPPLIES_NEEDED,      "supplies needed in area",         CHIRP_CAT_MUTUAL_AID,  0 },
+  { TPL_AID_OFFERING_HELP,        "offering assistance",             CHIRP_CAT_MUTUAL_AID,  0 },
 
   // All Clear — De-escalation
-  { TPL_CLR_RESOLVED,             "situation resolved",             CHIRP_CAT_ALL_CLEAR, true },
-  { TPL_CLR_SAFE,                 "area appears safe now",          CHIRP_CAT_ALL_CLEAR, true },
-  { TPL_CLR_FALSE_ALARM,          "false alarm",                    CHIRP_CAT_ALL_CLEAR, true },
+  { TPL_CLR_RESOLVED,             "situation resolved",              CHIRP_CAT_ALL_CLEAR,   TPL_NIGHT_OK },
+  { TPL_CLR_SAFE,                 "area appears safe now",           CHIRP_CAT_ALL_CLEAR,   TPL_NIGHT_OK },
+  { TPL_CLR_FALSE_ALARM,          "false alarm",                     CHIRP_CAT_ALL_CLEAR,   TPL_NIGHT_OK },
 };
-static const size_t TEMPLATE_COUNT = sizeof(TEMPLATE_TABLE) / sizeof(TEMPLATE_TABLE[0]);
+static constexpr size_t TEMPLATE_COUNT = sizeof(TEMPLATE_TABLE) / sizeof(TEMPLATE_TABLE[0]);
 
 struct DetailEntry {
   ChirpDetailSlot id;
   const char* text;
 };
 
-static const DetailEntry DETAIL_TABLE[] = {
+static constexpr DetailEntry DETAIL_TABLE[] = {
   { DETAIL_NONE,             "" },
   { DETAIL_SCALE_FEW,        "few vehicles" },
   { DETAIL_SCALE_MANY,       "many vehicles" },
@@ -161,7 +185,58 @@ static const DetailEntry DETAIL_TABLE[] = {
   { DETAIL_DIR_EAST,         "east" },
   { DETAIL_DIR_WEST,         "west" },
 };
-static const size_t DETAIL_COUNT = sizeof(DETAIL_TABLE) / sizeof(DETAIL_TABLE[0]);
+static constexpr size_t DETAIL_COUNT = sizeof(DETAIL_TABLE) / sizeof(DETAIL_TABLE[0]);
+
+// Wire IDs index these directly; both are built at compile time and live
+// in flash. NO_ENTRY marks IDs that are not in the table.
+static constexpr uint8_t NO_ENTRY = 0xFF;
+static constexpr size_t DETAIL_ID_LIMIT = 32;
+
+struct TemplateIndex { uint8_t slot[256]; };
+struct DetailIndex { const char* text[DETAIL_ID_LIMIT]; };
+
+static constexpr TemplateIndex build_template_index() {
+  TemplateIndex idx = {};
+  for (size_t i = 0; i < 256; i++) idx.slot[i] = NO_ENTRY;
+  for (size_t i = 0; i < TEMPLATE_COUNT; i++) idx.slot[TEMPLATE_TABLE[i].id] = (uint8_t)i;
+  return idx;
+}
+
+static constexpr DetailIndex build_detail_index() {
+  DetailIndex idx = {};
+  for (size_t i = 0; i < DETAIL_COUNT; i++) idx.text[DETAIL_TABLE[i].id] = DETAIL_TABLE[i].text;
+  return idx;
+}
+
+static constexpr bool templates_valid() {
+  for (size_t i = 0; i < TEMPLATE_COUNT; i++) {
+    const TemplateEntry& e = TEMPLATE_TABLE[i];
+    if (e.id == TPL_INVALID) return false;
+    bool safety = e.category == CHIRP_CAT_EMERGENCY || e.category == CHIRP_CAT_WEATHER;
+    if (((e.flags & TPL_SAFETY) != 0) != safety) return false;
+    for (size_t j = i + 1; j < TEMPLATE_COUNT; j++) {
+      if (TEMPLATE_TABLE[j].id == e.id) return false;
+    }
+  }
+  return true;
+}
+
+static constexpr bool details_valid() {
+  for (size_t i = 0; i < DETAIL_COUNT; i++) {
+    if (DETAIL_TABLE[i].id >= DETAIL_ID_LIMIT) return false;
+    for (size_t j = i + 1; j < DETAIL_COUNT; j++) {
+      if (DETAIL_TABLE[j].id == DETAIL_TABLE[i].id) return false;
+    }
+  }
+  return true;
+}
+
+static_assert(TEMPLATE_COUNT < NO_ENTRY, "template slots must fit in uint8_t");
+static_assert(templates_valid(), "template IDs must be unique and TPL_SAFETY must match category");
+static_assert(details_valid(), "detail IDs must be unique and below DETAIL_ID_LIMIT");
+
+static constexpr TemplateIndex TEMPLATE_INDEX = build_template_index();
+static constexpr DetailIndex DETAIL_INDEX = build_detail_index();
 
 // ════════════════════════════════════════════════════════════════════════════
 // FORWARD DECLARATIONS
@@ -179,6 +254,9 @@ static void handle_witness(const uint8_t* data, size_t len, int8_t rssi);
 static void handle_ack(const uint8_t* data, size_t len);
 static void handle_mute(const uint8_t* data, size_t len);
 static void relay_chirp(const ReceivedChirp* chirp);
+static void schedule_relay(const ReceivedChirp* chirp);
+static void note_duplicate(const uint8_t* nonce, int8_t rssi);
+static void pump_pending_relays(uint32_t now);
 static void prune_stale_nearby();
 static void prune_old_chirps();
 static void load_settings();
@@ -264,12 +342,8 @@ static void generate_emoji_string(const uint8_t* session_id, char* emoji_out) {
 // ════════════════════════════════════════════════════════════════════════════
 
 static const TemplateEntry* find_template(ChirpTemplate id) {
-  for (size_t i = 0; i < TEMPLATE_COUNT; i++) {
-    if (TEMPLATE_TABLE[i].id == id) {
-      return &TEMPLATE_TABLE[i];
-    }
-  }
-  return nullptr;
+  uint8_t slot = TEMPLATE_INDEX.slot[(uint8_t)id];
+  return slot == NO_ENTRY ? nullptr : &TEMPLATE_TABLE[slot];
 }
 
 static ChirpCategory template_to_category(ChirpTemplate id) {
@@ -278,6 +352,12 @@ static ChirpCategory template_to_category(ChirpTemplate id) {
   return CHIRP_CAT_ALL_CLEAR;  // Default
 }
 
+// Safety templates only need CONFIRMATIONS_SAFETY, others CONFIRMATIONS_REQUIRED
+static uint8_t confirmations_needed(ChirpTemplate id) {
+  const TemplateEntry* entry = find_template(id);
+  return (entry && (entry->flags & TPL_SAFETY)) ? CONFIRMATIONS_SAFETY : CONFIRMATIONS_REQUIRED;
+}
+
 static uint32_t get_cooldown_for_tier(uint8_t tier) {
   switch (tier) {
     case 1: return COOLDOWN_TIER_1_MS;
@@ -300,25 +380,66 @@ static void reset_cooldown_if_stale() {
 
 static bool is_template_night_allowed(ChirpTemplate id) {
   const TemplateEntry* entry = find_template(id);
-  return entry ? entry->night_allowed : false;
+  return entry ? (entry->flags & TPL_NIGHT_OK) != 0 : false;
 }
 
 // ════════════════════════════════════════════════════════════════════════════
 // NONCE DEDUPLICATION
 // ════════════════════════════════════════════════════════════════════════════
 
+// Keyed so a sender cannot pick nonces that pile into one probe window
+static size_t nonce_bucket(const uint8_t* nonce) {
+  uint32_t lo, hi;
+  memcpy(&lo, nonce, 4);
+  memcpy(&hi, nonce + 4, 4);
+  uint32_t h = (lo ^ (hi * 0x9E3779B1u)) * g_nonce_hash_key;
+  return (h >> 16) & (NONCE_SET_SIZE - 1);
+}
+
+static bool nonce_live(const NonceEntry& e, uint32_t now) {
+  return e.seen_ms != 0 && (now - e.seen_ms) < CHIRP_TTL_MS;
+}
+
+// Expired slots are not a stop marker: an entry further along the window
+// may have been inserted before the slot expired, so scan the whole window
 static bool is_nonce_seen(const uint8_t* nonce) {
-  for (size_t i = 0; i < MAX_NONCE_CACHE; i++) {
-    if (memcmp(g_nonce_cache[i], nonce, 8) == 0) {
-      return true;
-    }
+  uint32_t now = millis();
+  size_t b = nonce_bucket(nonce);
+  for (size_t i = 0; i < NONCE_PROBE_LIMIT; i++) {
+    const NonceEntry& e = g_nonce_set[(b + i) & (NONCE_SET_SIZE - 1)];
+    if (e.seen_ms == 0) return false;           // Never used: end of chain
+    if (nonce_live(e, now) && memcmp(e.nonce, nonce, 8) == 0) return true;
   }
   return false;
 }
 
 static void cache_nonce(const uint8_t* nonce) {
-  memcpy(g_nonce_cache[g_nonce_cache_idx], nonce, 8);
-  g_nonce_cache_idx = (g_nonce_cache_idx + 1) % MAX_NONCE_CACHE;
+  uint32_t now = millis();
+  size_t b = nonce_bucket(nonce);
+  NonceEntry* slot = nullptr;
+  NonceEntry* oldest = nullptr;
+
+  for (size_t i = 0; i < NONCE_PROBE_LIMIT; i++) {
+    NonceEntry* e = &g_nonce_set[(b + i) & (NONCE_SET_SIZE - 1)];
+    if (!nonce_live(*e, now)) {
+      if (!slot) slot = e;
+      if (e->seen_ms == 0) break;
+      continue;
+    }
+    if (memcmp(e->nonce, nonce, 8) == 0) {
+      e->seen_ms = now | 1;                     // Already cached: refresh
+      return;
+    }
+    if (!oldest || (now - e->seen_ms) > (now - oldest->seen_ms)) oldest = e;
+  }
+
+  if (!slot) {
+    // Window full of live nonces: drop the one closest to expiry
+    slot = oldest;
+    g_nonce_evictions++;
+  }
+  memcpy(slot->nonce, nonce, 8);
+  slot->seen_ms = now | 1;                      // Never 0 (free marker)
 }
 
 // ════════════════════════════════════════════════════════════════════════════
@@ -328,19 +449,11 @@ static void cache_nonce(const uint8_t* nonce) {
 static void broadcast_message(const uint8_t* data, size_t len) {
   static const uint8_t BROADCAST_ADDR[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
 
-  // Add broadcast peer if not already added
-  esp_now_peer_info_t peer;
-  memset(&peer, 0, sizeof(peer));
-  memcpy(peer.peer_addr, BROADCAST_ADDR, 6);
-  peer.channel = CHIRP_CHANNEL;
-  peer.encrypt = false;
-
-  if (!esp_now_is_peer_exist(BROADCAST_ADDR)) {
-    esp_now_add_peer(&peer);
-  }
+  // A fresh presence beacon replaces one still waiting for the chirp slot
+  const ChirpHeader* hdr = (const ChirpHeader*)data;
+  uint8_t replace_key = hdr->msg_type == CHIRP_MSG_PRESENCE ? (uint8_t)CHIRP_MSG_PRESENCE : 0;
 
-  esp_err_t err = esp_now_send(BROADCAST_ADDR, data, len);
-  if (err != ESP_OK) {
+  if (!radio_scheduler::send(radio_scheduler::SLOT_CHIRP, BROADCAST_ADDR, data, len, replace_key)) {
     health_log(LOG_LEVEL_WARNING, LOG_CAT_NETWORK, "chirp: broadcast failed");
   }
 }
@@ -419,7 +532,6 @@ static void handle_presence(const uint8_t* data, size_t len, int8_t rssi) {
 }
 
 static void handle_witness(const uint8_t* data, size_t len, int8_t rssi) {
-  (void)rssi;  // Could be used for signal strength filtering in future
   if (len < sizeof(ChirpHeader) + sizeof(ChirpWitnessPayload)) return;
 
   const ChirpHeader* hdr = (const ChirpHeader*)data;
@@ -427,6 +539,7 @@ static void handle_witness(const uint8_t* data, size_t len, int8_t rssi) {
 
   // Check nonce deduplication
   if (is_nonce_seen(hdr->nonce)) {
+    note_duplicate(hdr->nonce, rssi);  // Someone else relayed it
     return;  // Already seen this chirp
   }
   cache_nonce(hdr->nonce);
@@ -481,13 +594,10 @@ static void handle_witness(const uint8_t* data, size_t len, int8_t rssi) {
     chirp->relayed = false;
     chirp->dismissed = false;
     chirp->suppressed = false;
+    chirp->rssi = rssi;
 
     // Determine if validated (has enough witness confirmations)
-    // Safety templates only need 1, others need CONFIRMATIONS_REQUIRED
-    ChirpCategory cat = template_to_category(template_id);
-    uint8_t needed = (cat == CHIRP_CAT_EMERGENCY || cat == CHIRP_CAT_WEATHER)
-                     ? CONFIRMATIONS_SAFETY : CONFIRMATIONS_REQUIRED;
-    chirp->validated = (payload->confirm_count >= needed);
+    chirp->validated = (payload->confirm_count >= confirmations_needed(template_id));
 
     // Notify callback
     if (g_chirp_callback) {
@@ -503,7 +613,7 @@ static void handle_witness(const uint8_t* data, size_t len, int8_t rssi) {
 
     // Only relay if validated and under hop limit
     if (g_relay_enabled && chirp->validated && hdr->hop_count < MAX_HOP_COUNT) {
-      relay_chirp(chirp);
+      schedule_relay(chirp);
     }
   }
 }
@@ -524,15 +634,11 @@ static void handle_ack(const uint8_t* data, size_t len) {
         chirp->confirm_count++;
 
         // Check if now validated and can relay
-        ChirpCategory cat = template_to_category(chirp->template_id);
-        uint8_t needed = (cat == CHIRP_CAT_EMERGENCY || cat == CHIRP_CAT_WEATHER)
-                         ? CONFIRMATIONS_SAFETY : CONFIRMATIONS_REQUIRED;
-
-        if (!chirp->validated && chirp->confirm_count >= needed) {
+        if (!chirp->validated && chirp->confirm_count >= confirmations_needed(chirp->template_id)) {
           chirp->validated = true;
           // Relay now that it's validated
           if (g_relay_enabled && !chirp->relayed && chirp->hop_count < MAX_HOP_COUNT) {
-            relay_chirp(chirp);
+            schedule_relay(chirp);
           }
         }
       } else if (payload->ack_type == CHIRP_ACK_SEEN) {
@@ -593,6 +699,7 @@ static void relay_chirp(const ReceivedChirp* chirp) {
 
   broadcast_message(buf, sizeof(buf));
   g_relays_this_minute++;
+  g_relays_sent++;
 
   // Mark chirp as relayed
   for (size_t i = 0; i < g_recent_chirp_count; i++) {
@@ -605,6 +712,91 @@ static void relay_chirp(const ReceivedChirp* chirp) {
   health_log(LOG_LEVEL_DEBUG, LOG_CAT_NETWORK, "chirp: relayed");
 }
 
+// ════════════════════════════════════════════════════════════════════════════
+// GOSSIP RELAY
+// ════════════════════════════════════════════════════════════════════════════
+
+// 0 at RELAY_RSSI_FAR or weaker, 100 at RELAY_RSSI_NEAR or stronger. A
+// strong signal means the last transmitter is close, so our relay would
+// mostly reach devices that already heard it.
+static uint8_t relay_proximity(int8_t rssi) {
+  if (rssi <= RELAY_RSSI_FAR) return 0;
+  if (rssi >= RELAY_RSSI_NEAR) return 100;
+  return (uint8_t)((rssi - RELAY_RSSI_FAR) * 100 / (RELAY_RSSI_NEAR - RELAY_RSSI_FAR));
+}
+
+static PendingRelay* find_pending_relay(const uint8_t* nonce) {
+  for (size_t i = 0; i < RELAY_PENDING_SLOTS; i++) {
+    if (g_pending_relays[i].active &&
+        memcmp(g_pending_relays[i].nonce, nonce, 8) == 0) {
+      return &g_pending_relays[i];
+    }
+  }
+  return nullptr;
+}
+
+// Distant receivers wait less and are more likely to relay, so the chirp
+// is carried outward first and nearby devices hear it repeated and stay quiet
+static void schedule_relay(const ReceivedChirp* chirp) {
+  if (!chirp || find_pending_relay(chirp->nonce)) return;
+
+  PendingRelay* slot = nullptr;
+  for (size_t i = 0; i < RELAY_PENDING_SLOTS; i++) {
+    if (!g_pending_relays[i].active) {
+      slot = &g_pending_relays[i];
+      break;
+    }
+  }
+  if (!slot) {
+    relay_chirp(chirp);  // Backlog full: relay now, per-minute cap still applies
+    return;
+  }
+
+  uint8_t proximity = relay_proximity(chirp->rssi);
+  memcpy(slot->nonce, chirp->nonce, 8);
+  slot->due_ms = millis() + RELAY_BACKOFF_MIN_MS
+               + RELAY_BACKOFF_SPAN_MS * proximity / 100
+               + esp_random() % RELAY_JITTER_MS;
+  slot->p_base = (uint8_t)(100 - (100 - RELAY_P_MIN) * proximity / 100);
+  slot->dups = 0;
+  slot->active = true;
+}
+
+// A duplicate heard loudly came from a neighbour whose relay covered
+// most of our own range, so it counts double
+static void note_duplicate(const uint8_t* nonce, int8_t rssi) {
+  PendingRelay* pending = find_pending_relay(nonce);
+  if (!pending) return;
+  uint8_t weight = (rssi >= RELAY_RSSI_NEAR) ? 2 : 1;
+  pending->dups = (pending->dups + weight > RELAY_DUP_SUPPRESS)
+                ? RELAY_DUP_SUPPRESS : pending->dups + weight;
+}
+
+static void pump_pending_relays(uint32_t now) {
+  for (size_t i = 0; i < RELAY_PENDING_SLOTS; i++) {
+    PendingRelay* pending = &g_pending_relays[i];
+    if (!pending->active || (int32_t)(now - pending->due_ms) < 0) continue;
+    pending->active = false;
+
+    const ReceivedChirp* chirp = nullptr;
+    for (size_t j = 0; j < g_recent_chirp_count; j++) {
+      if (memcmp(g_recent_chirps[j].nonce, pending->nonce, 8) == 0) {
+        chirp = &g_recent_chirps[j];
+        break;
+      }
+    }
+    if (!chirp || chirp->relayed || chirp->suppressed || !g_relay_enabled) continue;
+
+    // Each duplicate halves the chance; enough of them cancel outright
+    uint8_t p = (pending->dups >= RELAY_DUP_SUPPRESS) ? 0 : (pending->p_base >> pending->dups);
+    if (esp_random() % 100 < p) {
+      relay_chirp(chirp);
+    } else {
+      g_relays_suppressed++;
+    }
+  }
+}
+
 // ════════════════════════════════════════════════════════════════════════════
 // ESP-NOW CALLBACK
 // ════════════════════════════════════════════════════════════════════════════
@@ -701,8 +893,10 @@ static void load_settings() {
 }
 
 static void save_settings() {
-  nvs_set_u8("chirp_relay", g_relay_enabled ? 1 : 0);
-  nvs_set_u8("chirp_filter", (uint8_t)g_urgency_filter);
+  NvsTransaction tx(NVS_CHIRP_NS);
+  tx.putUChar("chirp_relay", g_relay_enabled ? 1 : 0);
+  tx.putUChar("chirp_filter", (uint8_t)g_urgency_filter);
+  tx.commit();
 }
 
 // ════════════════════════════════════════════════════════════════════════════
@@ -716,10 +910,15 @@ bool init() {
   memset(&g_session, 0, sizeof(g_session));
   memset(g_recent_chirps, 0, sizeof(g_recent_chirps));
   memset(g_nearby_devices, 0, sizeof(g_nearby_devices));
-  memset(g_nonce_cache, 0, sizeof(g_nonce_cache));
+  memset(g_nonce_set, 0, sizeof(g_nonce_set));
+  memset(g_pending_relays, 0, sizeof(g_pending_relays));
+  g_relays_sent = 0;
+  g_relays_suppressed = 0;
   g_recent_chirp_count = 0;
   g_nearby_count = 0;
-  g_nonce_cache_idx = 0;
+  g_nonce_evictions = 0;
+  esp_fill_random(&g_nonce_hash_key, sizeof(g_nonce_hash_key));
+  g_nonce_hash_key |= 1;
 
   // Load settings from NVS
   load_settings();
@@ -754,6 +953,8 @@ bool enable() {
   if (esp_now_init() != ESP_OK) {
     // May already be initialized by mesh_network
   }
+  // Paced sends and the broadcast peer; keeps mesh_network's result hook
+  radio_scheduler::attach_espnow(nullptr);
 
   // Reset cooldown tracking for new session
   memset(&g_cooldown, 0, sizeof(g_cooldown));
@@ -810,6 +1011,8 @@ void update() {
     }
   }
 
+  pump_pending_relays(now);
+
   // Send presence beacon
   if (now - g_last_presence_ms >= PRESENCE_INTERVAL_MS) {
     send_presence();
@@ -854,6 +1057,10 @@ ChirpStatus get_status() {
     status.mute_remaining_ms = 0;
   }
 
+  status.nonce_evictions = g_nonce_evictions;
+  status.relays_sent = g_relays_sent;
+  status.relays_suppressed = g_relays_suppressed;
+
   return status;
 }
 
@@ -932,12 +1139,8 @@ const char* get_template_text(ChirpTemplate template_id) {
 }
 
 const char* get_detail_text(ChirpDetailSlot detail) {
-  for (size_t i = 0; i < DETAIL_COUNT; i++) {
-    if (DETAIL_TABLE[i].id == detail) {
-      return DETAIL_TABLE[i].text;
-    }
-  }
-  return "";
+  const char* text = (uint8_t)detail < DETAIL_ID_LIMIT ? DETAIL_INDEX.text[detail] : nullptr;
+  return text ? text : "";
 }
 
 uint8_t get_cooldown_tier() {
@@ -958,10 +1161,7 @@ const char* get_validation_status(const ReceivedChirp* chirp) {
   if (!chirp) return "unknown";
   if (chirp->suppressed) return "suppressed";
   if (chirp->validated) return "validated";
-  ChirpCategory cat = template_to_category(chirp->template_id);
-  uint8_t needed = (cat == CHIRP_CAT_EMERGENCY || cat == CHIRP_CAT_WEATHER)
-                   ? CONFIRMATIONS_SAFETY : CONFIRMATIONS_REQUIRED;
-  if (chirp->confirm_count < needed) return "awaiting_confirmation";
+  if (chirp->confirm_count < confirmations_needed(chirp->template_id)) return "awaiting_confirmation";
   return "validated";
 }
 
@@ -979,7 +1179,7 @@ bool send_chirp(ChirpTemplate template_id, ChirpUrgency urgency,
   }
 
   // Night mode restriction
-  if (is_night_mode() && !entry->night_allowed) {
+  if (is_night_mode() && !(entry->flags & TPL_NIGHT_OK)) {
     health_log(LOG_LEVEL_INFO, LOG_CAT_NETWORK, "chirp: template not allowed at night");
     return false;
   }
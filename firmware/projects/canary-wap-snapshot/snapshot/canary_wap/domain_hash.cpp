@@ -0,0 +1,82 @@
+/*
+ * SecuraCV Canary — Domain-Separated Hashing Implementation
+ */
+
+#include "domain_hash.h"
+#include "../../../../common/core/midstate_cache.h"
+#include <string.h>
+
+namespace domain_hash {
+
+// ════════════════════════════════════════════════════════════════════════════
+// PREFIX STATE
+// ════════════════════════════════════════════════════════════════════════════
+
+Prefix::Prefix() : m_ready(false) {
+  mbedtls_sha256_init(&m_ctx);
+}
+
+Prefix::~Prefix() {
+  mbedtls_sha256_free(&m_ctx);  // Zeroizes the context
+}
+
+void Prefix::begin(const char* domain, bool separator) {
+  mbedtls_sha256_free(&m_ctx);
+  mbedtls_sha256_init(&m_ctx);
+  mbedtls_sha256_starts(&m_ctx, 0);
+  mbedtls_sha256_update(&m_ctx, (const uint8_t*)domain, strlen(domain));
+  if (separator) {
+    uint8_t sep = 0x00;
+    mbedtls_sha256_update(&m_ctx, &sep, 1);
+  }
+  m_ready = true;
+}
+
+void Prefix::absorb(const void* data, size_t len) {
+  if (data && len > 0) {
+    mbedtls_sha256_update(&m_ctx, (const uint8_t*)data, len);
+  }
+}
+
+void Prefix::finish(const void* tail, size_t len, uint8_t out[32]) const {
+  finish2(tail, len, nullptr, 0, out);
+}
+
+void Prefix::finish2(const void* a, size_t a_len, const void* b, size_t b_len, uint8_t out[32]) const {
+  mbedtls_sha256_context ctx;
+  mbedtls_sha256_init(&ctx);
+  mbedtls_sha256_clone(&ctx, &m_ctx);
+  if (a && a_len > 0) mbedtls_sha256_update(&ctx, (const uint8_t*)a, a_len);
+  if (b && b_len > 0) mbedtls_sha256_update(&ctx, (const uint8_t*)b, b_len);
+  mbedtls_sha256_finish(&ctx, out);
+  mbedtls_sha256_free(&ctx);
+}
+
+void Prefix::wipe() {
+  mbedtls_sha256_free(&m_ctx);
+  mbedtls_sha256_init(&m_ctx);
+  m_ready = false;
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// CACHED DOMAIN HASH
+// ════════════════════════════════════════════════════════════════════════════
+
+// Shared with the canary's crypto backend; variant 1 = with separator
+static MidstateCache<Prefix, CACHE_SIZE> s_cache;
+
+void hash(const char* domain, const void* data, size_t len, uint8_t out[32], bool separator) {
+  const Prefix* pre = s_cache.get(domain, separator ? 1 : 0,
+      [domain, separator](Prefix& p) { p.begin(domain, separator); });
+  if (pre) {
+    pre->finish(data, len, out);
+    return;
+  }
+
+  // Cache full, or another task is still building this entry
+  Prefix tmp;
+  tmp.begin(domain, separator);
+  tmp.finish(data, len, out);
+}
+
+} // namespace domain_hash
@@ -0,0 +1,76 @@
+/*
+ * SecuraCV Canary — Domain-Separated Hashing
+ *
+ * Shared SHA-256 helper for every domain-tagged hash in the firmware
+ * (witness chain, mesh, RF session keys). The constant prefix (domain
+ * tag, optional 0x00 separator, and for keyed uses the device secret) is
+ * absorbed once; each hash clones that state and absorbs only the tail.
+ */
+
+#ifndef SECURACV_DOMAIN_HASH_H
+#define SECURACV_DOMAIN_HASH_H
+
+#include <Arduino.h>
+#include <mbedtls/sha256.h>
+
+namespace domain_hash {
+
+// Distinct domains cached by hash(); further domains fall back to a full hash
+static const size_t CACHE_SIZE = 16;
+
+// ════════════════════════════════════════════════════════════════════════════
+// PREFIX STATE
+// ════════════════════════════════════════════════════════════════════════════
+
+/*
+ * Cached SHA-256 state after a constant prefix.
+ *
+ * Example usage:
+ *   domain_hash::Prefix p;
+ *   p.begin("canary:session:v0:", false);
+ *   p.absorb(secret, 32);           // keyed prefix
+ *   p.finish(mac, 6, out);          // per-call tail only
+ *   p.wipe();                       // when the secret goes away
+ */
+class Prefix {
+public:
+  Prefix();
+  ~Prefix();
+
+  // Start a prefix with the domain tag (and 0x00 separator when requested)
+  void begin(const char* domain, bool separator = true);
+
+  // Extend the prefix with constant data (e.g. a device secret)
+  void absorb(const void* data, size_t len);
+
+  // H(prefix || tail)
+  void finish(const void* tail, size_t len, uint8_t out[32]) const;
+
+  // H(prefix || a || b), saves callers a concatenation buffer
+  void finish2(const void* a, size_t a_len, const void* b, size_t b_len, uint8_t out[32]) const;
+
+  // Zeroize the cached state (required for keyed prefixes)
+  void wipe();
+
+  bool ready() const { return m_ready; }
+
+  Prefix(const Prefix&) = delete;
+  Prefix& operator=(const Prefix&) = delete;
+
+private:
+  mbedtls_sha256_context m_ctx;
+  bool m_ready;
+};
+
+// ════════════════════════════════════════════════════════════════════════════
+// CACHED DOMAIN HASH
+// ════════════════════════════════════════════════════════════════════════════
+
+// H(domain || 0x00 || data), or H(domain || data) with separator=false for the
+// mesh wire format. domain must be a string with static lifetime (a literal).
+void hash(const char* domain, const void* data, size_t len, uint8_t out[32],
+          bool separator = true);
+
+} // namespace domain_hash
+
+#endif // SECURACV_DOMAIN_HASH_H
@@ -3,7 +3,8 @@
  *
  * Provides resilient hardware management for optional peripherals:
  * - GPS: Auto-detection, state machine, non-blocking reads
- * - SD Card: Hot-plug detection, safe operations, timeouts
+ * - SD Card: Hot-plug detection, safe operations, timeouts, on a
+ *   background worker that holds writes in RAM while the card is away
  * - Safe Mode: Anti-reboot-loop protection
  *
  * SECURITY PRINCIPLE: A witness device that can be trivially disabled
@@ -23,6 +24,10 @@
 #include <SD.h>
 #include <SPI.h>
 #include <Preferences.h>
+#include <freertos/ringbuf.h>
+#include <freertos/semphr.h>
+#include "snapshot_buffer.h"
+#include "mem_budget.h"
 
 // ============================================================================
 // CONFIGURATION
@@ -40,11 +45,28 @@ namespace hw_config {
   static const uint32_t SD_OP_TIMEOUT_MS        = 1000;   // Timeout for individual SD operations
   static const uint8_t  SD_MAX_RETRIES          = 2;      // Max retries before marking SD failed
 
+  // Background SD worker: every mount, presence check, space scan and
+  // queued write runs here, so a missing or slow card only stalls this task
+  static const uint32_t SD_WORKER_STACK         = 4096;
+  static const UBaseType_t SD_WORKER_PRIORITY   = 1;      // loop()'s level, below the witness writer
+  static const uint32_t SD_FLUSH_INTERVAL_MS    = 2000;   // Write queued data this often while mounted
+#if defined(EXT_RAM_BSS_ATTR) && defined(CONFIG_SPIRAM_ALLOW_BSS_SEG_EXTERNAL_MEMORY)
+  static const size_t   SD_PENDING_BYTES        = 256 * 1024; // RAM queue (PSRAM), ~9 min of 1 Hz records
+#else
+  static const size_t   SD_PENDING_BYTES        = 16 * 1024;  // Internal RAM only: ~30 s of records
+#endif
+  static const size_t   SD_EVENT_DEPTH          = 8;      // State changes waiting for loop()
+  static const size_t   SD_MAX_PATH             = 47;
+
   // Safe mode protection
   static const uint32_t SAFE_MODE_WINDOW_MS     = 60000;  // 60 second window
   static const uint8_t  SAFE_MODE_REBOOT_LIMIT  = 3;      // 3 reboots in window triggers safe mode
   static const uint32_t SAFE_MODE_RECOVERY_MS   = 300000; // 5 minutes stable to clear safe mode
 
+  // Cached JSON for API readers
+  static const uint32_t JSON_REFRESH_MS         = 1000;   // Re-render at most this often
+  static const size_t   JSON_CAPACITY           = 512;
+
   // NVS keys for boot tracking
   static const char* NVS_BOOT_TIMES      = "boot_times";   // Array of recent boot timestamps
   static const char* NVS_SAFE_MODE       = "safe_mode";    // Safe mode flag
@@ -190,7 +212,9 @@ bool sd_verify_present();
  * - Re-attempts mount if card absent
  * - Updates cached space info
  * - Clears error count after sustained success
- * Call from loop() periodically.
+ * - Writes queued appends once the card is back
+ * Call from loop() periodically. With the worker running it only applies
+ * the worker's events, so it never touches the card.
  */
 void sd_periodic_check(SPIClass& spi, int cs_pin, uint32_t speed);
 
@@ -205,6 +229,70 @@ void sd_op_failure();
  */
 void sd_unmount_safe();
 
+/**
+ * Card I/O lock. The worker holds it across every mount, check, flush and
+ * unmount; code on other tasks that opens files directly holds it from
+ * SD.open() to close() so SD.end() never runs under an open file.
+ * Recursive. Returns false if it was not free within timeout_ms.
+ *
+ * Lock order: sd_lock() is the outermost lock. A module that guards its
+ * own state with a mutex (e.g. rf_history's s_lock) takes that inside
+ * sd_lock(), and never waits for sd_lock() while holding it.
+ */
+bool sd_lock(uint32_t timeout_ms = UINT32_MAX);
+void sd_unlock();
+
+// Scoped sd_lock(); check held before touching the card
+struct SdLockGuard {
+  bool held;
+  explicit SdLockGuard(uint32_t timeout_ms = UINT32_MAX) : held(sd_lock(timeout_ms)) {}
+  ~SdLockGuard() { if (held) sd_unlock(); }
+  SdLockGuard(const SdLockGuard&) = delete;
+  SdLockGuard& operator=(const SdLockGuard&) = delete;
+};
+
+/**
+ * Start the background SD worker. Call once from setup() after spi.begin().
+ * The worker tries the first mount at once and from then on owns every
+ * mount, presence check and space scan. on_mount runs on the worker after
+ * each successful mount (e.g. to create directories). The worker reports
+ * its results as events. sd_periodic_check() applies them to g_hw on the
+ * loop task, and sd_update_space_cache() only asks for a rescan.
+ * Returns false if the task could not be created; the synchronous
+ * functions above then keep working as before.
+ */
+bool sd_worker_start(SPIClass& spi, int cs_pin, uint32_t speed, void (*on_mount)() = nullptr);
+
+/**
+ * Queue an append of head then body to path. Safe from any task and
+ * never blocks. Appends are held in RAM while the card is absent, then
+ * written in order once it mounts. An append cut short by a card failure
+ * is written again in full after the next mount, over its partial bytes
+ * when the file still ends past where it began. Returns false, and
+ * counts a drop, if the queue is full.
+ */
+bool sd_append_async(const char* path, const void* head, size_t head_len,
+                     const void* body = nullptr, size_t body_len = 0);
+
+/**
+ * True once sd_worker_start() has created the write queue.
+ */
+bool sd_async_enabled();
+
+struct SdWorkerStats {
+  bool     running;           // Worker task exists
+  uint32_t queued;            // Appends waiting for the card
+  uint32_t queued_bytes;
+  uint32_t flushed;           // Appends written
+  uint32_t dropped;           // Queue full
+  uint32_t write_errors;      // Failed writes; the append is kept for the next mount
+  uint32_t mount_attempts;
+  uint32_t longest_op_ms;     // Slowest mount, check or flush (off the loop task)
+  uint32_t events_dropped;    // Event queue full; the next event carries the state
+};
+
+SdWorkerStats sd_worker_get_stats();
+
 /**
  * Check if SD is currently available and mounted.
  */
@@ -218,6 +306,7 @@ inline uint64_t sd_get_free_bytes() { return g_hw.sd_free_bytes; }
 
 /**
  * Update cached SD space info (call periodically, not on every request).
+ * With the worker running this only requests a rescan.
  */
 void sd_update_space_cache();
 
@@ -268,15 +357,26 @@ void hw_state_init();
  */
 void hw_state_print();
 
+/**
+ * Re-render the cached JSON from g_hw.
+ * Call from loop(), which owns g_hw; rate-limited to JSON_REFRESH_MS.
+ */
+void hw_state_publish();
+
 /**
  * Get hardware state as JSON for API responses.
- * Non-blocking, uses cached values.
+ * Copies the JSON cached by hw_state_publish(); safe from any task.
  */
 size_t hw_state_json(char* buf, size_t buf_size);
 
 // ============================================================================
 // IMPLEMENTATION
 // ============================================================================
+// Compiled once, in the sketch. Other translation units that need the SD
+// or GPS state define HARDWARE_STATE_NO_IMPL before including this and
+// link against the sketch's definitions.
+
+#ifndef HARDWARE_STATE_NO_IMPL
 
 // Global instance
 HardwareState g_hw = {0};
@@ -284,6 +384,14 @@ HardwareState g_hw = {0};
 // NVS for persistent state
 static Preferences g_hw_nvs;
 
+// JSON rendered on the loop task, copied out by readers
+struct HwStateJson {
+  uint16_t len;
+  char text[hw_config::JSON_CAPACITY];
+};
+static SnapshotBuffer<HwStateJson> g_hw_json;
+static uint32_t g_hw_json_ms = 0;
+
 // ────────────────────────────────────────────────────────────────────────────
 
 void hw_state_init() {
@@ -293,6 +401,9 @@ void hw_state_init() {
   g_hw.sd_state = SD_ABSENT;
 
   g_hw.last_stable_ms = millis();
+
+  g_hw_json_ms = millis() - hw_config::JSON_REFRESH_MS;
+  hw_state_publish();
 }
 
 // ────────────────────────────────────────────────────────────────────────────
@@ -396,6 +507,24 @@ void gps_update_state(bool received_data, bool has_valid_fix) {
 // SD CARD FUNCTIONS
 // ────────────────────────────────────────────────────────────────────────────
 
+static StaticSemaphore_t g_sd_lock_buf;
+static SemaphoreHandle_t g_sd_lock = nullptr;
+static portMUX_TYPE g_sd_lock_mux = portMUX_INITIALIZER_UNLOCKED;
+
+bool sd_lock(uint32_t timeout_ms) {
+  // Created on first use: the first SD call may come before setup() does
+  portENTER_CRITICAL(&g_sd_lock_mux);
+  if (!g_sd_lock) g_sd_lock = xSemaphoreCreateRecursiveMutexStatic(&g_sd_lock_buf);
+  portEXIT_CRITICAL(&g_sd_lock_mux);
+
+  TickType_t wait = timeout_ms == UINT32_MAX ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+  return xSemaphoreTakeRecursive(g_sd_lock, wait) == pdTRUE;
+}
+
+void sd_unlock() {
+  xSemaphoreGiveRecursive(g_sd_lock);
+}
+
 static bool sd_try_mount(SPIClass& spi, int cs_pin, uint32_t speed) {
   // Try to mount with given speed
   if (SD.begin(cs_pin, spi, speed)) {
@@ -404,42 +533,50 @@ static bool sd_try_mount(SPIClass& spi, int cs_pin, uint32_t speed) {
   return false;
 }
 
-bool sd_mount_safe(SPIClass& spi, int cs_pin, uint32_t speed) {
+// Reads card size and usage; slow on a large card
+static void sd_read_space(uint64_t* total, uint64_t* free_bytes) {
+  *total = SD.totalBytes();
+  uint64_t used = SD.usedBytes();
+  // Protect against wraparound if filesystem is corrupted
+  *free_bytes = (*total > used) ? (*total - used) : 0;
+}
+
+// Mount with a slower-speed fallback; touches only the card, not g_hw
+static bool sd_mount_card(SPIClass& spi, int cs_pin, uint32_t speed) {
   uint32_t start = millis();
 
   Serial.print("[SD] Attempting mount...");
 
   // First try at requested speed
   if (sd_try_mount(spi, cs_pin, speed)) {
-    goto mount_success;
+    return true;
   }
 
   // Check timeout
   if (millis() - start > hw_config::SD_MOUNT_TIMEOUT_MS / 2) {
     Serial.println(" fast mount timeout");
-    goto mount_failed;
+    return false;
   }
 
   // Fallback to slower speed
   Serial.print(" (trying slower speed)...");
   if (sd_try_mount(spi, cs_pin, speed / 4)) {
-    goto mount_success;
-  }
-
-  // Check final timeout
-  if (millis() - start > hw_config::SD_MOUNT_TIMEOUT_MS) {
-    Serial.println(" timeout");
-    goto mount_failed;
+    return true;
   }
 
-mount_failed:
-  g_hw.sd_available = false;
-  g_hw.sd_state = SD_ABSENT;
-  g_hw.sd_consecutive_errors++;
   Serial.println(" not present or failed");
   return false;
+}
+
+bool sd_mount_safe(SPIClass& spi, int cs_pin, uint32_t speed) {
+  SdLockGuard lock;
+  if (!sd_mount_card(spi, cs_pin, speed)) {
+    g_hw.sd_available = false;
+    g_hw.sd_state = SD_ABSENT;
+    g_hw.sd_consecutive_errors++;
+    return false;
+  }
 
-mount_success:
   g_hw.sd_available = true;
   g_hw.sd_state = SD_MOUNTED;
   g_hw.sd_mount_time_ms = millis();
@@ -447,10 +584,7 @@ mount_success:
   g_hw.sd_consecutive_errors = 0;
 
   // Cache card info (only do this once on mount, not on every request)
-  g_hw.sd_total_bytes = SD.totalBytes();
-  uint64_t used = SD.usedBytes();
-  // Protect against wraparound if filesystem is corrupted
-  g_hw.sd_free_bytes = (g_hw.sd_total_bytes > used) ? (g_hw.sd_total_bytes - used) : 0;
+  sd_read_space(&g_hw.sd_total_bytes, &g_hw.sd_free_bytes);
 
   Serial.printf(" mounted (%llu MB, %llu MB free)\n",
                 g_hw.sd_total_bytes / (1024*1024),
@@ -458,6 +592,351 @@ mount_success:
   return true;
 }
 
+// ────────────────────────────────────────────────────────────────────────────
+// SD WORKER
+// ────────────────────────────────────────────────────────────────────────────
+
+enum SdEventType : uint8_t {
+  SD_EVENT_MOUNTED      = 0,
+  SD_EVENT_MOUNT_FAILED = 1,
+  SD_EVENT_REMOVED      = 2,   // Check or write failed, or unmounted on request
+  SD_EVENT_SPACE        = 3    // Fresh total/free while mounted
+};
+
+struct SdEvent {
+  SdEventType type;
+  uint32_t    at_ms;
+  uint64_t    total_bytes;
+  uint64_t    free_bytes;
+};
+
+// Task notification bits: requests from other tasks
+static const uint32_t SD_NOTE_CHECK   = 1 << 0;   // Check or mount now
+static const uint32_t SD_NOTE_LOST    = 1 << 1;   // A caller saw the card fail
+static const uint32_t SD_NOTE_SPACE   = 1 << 2;   // Rescan total/free
+static const uint32_t SD_NOTE_UNMOUNT = 1 << 3;
+
+// A queued append: header, NUL-terminated path, data
+struct SdPendingHeader {
+  uint16_t path_len;
+  uint16_t data_len;
+};
+
+struct SdWorker {
+  TaskHandle_t    task;
+  SPIClass*       spi;
+  int             cs_pin;
+  uint32_t        speed;
+  void          (*on_mount)();
+  bool            mounted;          // The worker's own view; g_hw follows via events
+  uint32_t        last_check_ms;
+  uint8_t*        held;             // Append taken from the queue, not yet written
+  bool            held_failed;      // Its write failed; part of it may be on the card
+  size_t          held_offset;      // File size before that write
+  QueueHandle_t   events;
+  RingbufHandle_t pending;
+};
+
+static SdWorker g_sd_worker = {};
+static StaticQueue_t g_sd_events_buf;
+static uint8_t g_sd_events_storage[hw_config::SD_EVENT_DEPTH * sizeof(SdEvent)];
+static StaticRingbuffer_t g_sd_pending_buf;
+PSRAM_BSS static uint8_t g_sd_pending_storage[hw_config::SD_PENDING_BYTES];
+MEM_BUDGET_STATIC("sd", g_sd_pending_storage);
+
+// Producers on any task and the worker update the counters
+static portMUX_TYPE g_sd_stats_mux = portMUX_INITIALIZER_UNLOCKED;
+static SdWorkerStats g_sd_stats = {};
+
+static void sd_worker_publish(SdEventType type, uint64_t total, uint64_t free_bytes) {
+  SdEvent e = { type, millis(), total, free_bytes };
+  if (xQueueSend(g_sd_worker.events, &e, 0) != pdTRUE) {
+    portENTER_CRITICAL(&g_sd_stats_mux);
+    g_sd_stats.events_dropped++;
+    portEXIT_CRITICAL(&g_sd_stats_mux);
+  }
+}
+
+static void sd_worker_note_op(uint32_t start_ms) {
+  uint32_t elapsed = millis() - start_ms;
+  portENTER_CRITICAL(&g_sd_stats_mux);
+  if (elapsed > g_sd_stats.longest_op_ms) g_sd_stats.longest_op_ms = elapsed;
+  portEXIT_CRITICAL(&g_sd_stats_mux);
+}
+
+static void sd_worker_lose() {
+  SD.end();
+  g_sd_worker.mounted = false;
+  sd_worker_publish(SD_EVENT_REMOVED, 0, 0);
+}
+
+// Presence check while mounted, mount attempt otherwise
+static void sd_worker_check() {
+  SdWorker& w = g_sd_worker;
+  uint64_t total = 0, free_bytes = 0;
+
+  if (w.mounted) {
+    File root = SD.open("/");
+    if (!root) {
+      Serial.println("[SD] Card removed or failed");
+      sd_worker_lose();
+      return;
+    }
+    root.close();
+    sd_read_space(&total, &free_bytes);
+    sd_worker_publish(SD_EVENT_SPACE, total, free_bytes);
+    return;
+  }
+
+  portENTER_CRITICAL(&g_sd_stats_mux);
+  g_sd_stats.mount_attempts++;
+  portEXIT_CRITICAL(&g_sd_stats_mux);
+
+  if (!sd_mount_card(*w.spi, w.cs_pin, w.speed)) {
+    sd_worker_publish(SD_EVENT_MOUNT_FAILED, 0, 0);
+    return;
+  }
+  w.mounted = true;
+  if (w.on_mount) w.on_mount();
+  sd_read_space(&total, &free_bytes);
+  Serial.printf(" mounted (%llu MB, %llu MB free)\n",
+                total / (1024*1024), free_bytes / (1024*1024));
+  sd_worker_publish(SD_EVENT_MOUNTED, total, free_bytes);
+}
+
+// Reopen a failed append's file positioned where that append began, so
+// the retry overwrites any partial record instead of following it
+static File sd_open_retry(const char* path, size_t offset, size_t* at) {
+  File file = SD.open(path, "r+");
+  if (file && file.size() >= offset && file.seek(offset)) {
+    *at = offset;
+    return file;
+  }
+  if (file) file.close();
+  file = SD.open(path, FILE_APPEND);  // Gone or shorter: nothing to overwrite
+  *at = file ? file.size() : 0;
+  return file;
+}
+
+// Write every queued append in order. Returns false on a failed write;
+// that append stays held and goes first after the next mount.
+// Caller holds sd_lock().
+static bool sd_flush_pending() {
+  SdWorker& w = g_sd_worker;
+  File file;
+  char open_path[hw_config::SD_MAX_PATH + 1] = "";
+  size_t at = 0;  // Where the next write lands in the open file
+  bool ok = true;
+
+  for (;;) {
+    if (!w.held) {
+      size_t size = 0;
+      w.held = (uint8_t*)xRingbufferReceive(w.pending, &size, 0);
+      if (!w.held) break;
+      w.held_failed = false;
+    }
+    const SdPendingHeader* hdr = (const SdPendingHeader*)w.held;
+    const char* path = (const char*)(w.held + sizeof(SdPendingHeader));
+    const uint8_t* data = (const uint8_t*)path + hdr->path_len + 1;
+
+    // Consecutive appends to one file share the open
+    if (w.held_failed) {
+      if (file) file.close();
+      file = sd_open_retry(path, w.held_offset, &at);
+      strncpy(open_path, path, sizeof(open_path) - 1);
+    } else if (!file || strcmp(open_path, path) != 0) {
+      if (file) file.close();
+      file = SD.open(path, FILE_APPEND);
+      at = file ? file.size() : 0;
+      strncpy(open_path, path, sizeof(open_path) - 1);
+    }
+    if (!file || file.write(data, hdr->data_len) != hdr->data_len) {
+      // A retry keeps the first failure's offset: that is where it began.
+      // No file at all means nothing partial to cover.
+      if (!w.held_failed) {
+        w.held_offset = file ? at : SIZE_MAX;
+        w.held_failed = true;
+      }
+      ok = false;
+      break;
+    }
+    at += hdr->data_len;
+
+    vRingbufferReturnItem(w.pending, w.held);
+    w.held = nullptr;
+    w.held_failed = false;
+
+    portENTER_CRITICAL(&g_sd_stats_mux);
+    g_sd_stats.flushed++;
+    g_sd_stats.queued--;
+    portEXIT_CRITICAL(&g_sd_stats_mux);
+  }
+  if (file) file.close();
+
+  if (!ok) {
+    portENTER_CRITICAL(&g_sd_stats_mux);
+    g_sd_stats.write_errors++;
+    portEXIT_CRITICAL(&g_sd_stats_mux);
+  }
+  return ok;
+}
+
+static void sd_worker_task(void*) {
+  SdWorker& w = g_sd_worker;
+  sd_lock();
+  w.last_check_ms = millis();
+  uint32_t start = millis();
+  sd_worker_check();
+  sd_worker_note_op(start);
+  sd_unlock();
+
+  for (;;) {
+    uint32_t since_check = millis() - w.last_check_ms;
+    uint32_t recheck_in = since_check >= hw_config::SD_RECHECK_INTERVAL_MS
+                            ? 0 : hw_config::SD_RECHECK_INTERVAL_MS - since_check;
+    uint32_t wait = w.mounted && recheck_in > hw_config::SD_FLUSH_INTERVAL_MS
+                      ? hw_config::SD_FLUSH_INTERVAL_MS : recheck_in;
+    uint32_t notes = 0;
+    xTaskNotifyWait(0, UINT32_MAX, &notes, pdMS_TO_TICKS(wait));
+
+    // Direct SD users on other tasks finish their file first
+    sd_lock();
+    start = millis();
+    if ((notes & SD_NOTE_UNMOUNT) && w.mounted) {
+      Serial.println("[SD] Unmounting...");
+      sd_flush_pending();
+      sd_worker_lose();
+      w.last_check_ms = millis();
+    } else if ((notes & SD_NOTE_LOST) && w.mounted) {
+      sd_worker_lose();
+    }
+
+    bool due = millis() - w.last_check_ms >= hw_config::SD_RECHECK_INTERVAL_MS;
+    if (due || (notes & SD_NOTE_CHECK) || ((notes & SD_NOTE_SPACE) && w.mounted)) {
+      w.last_check_ms = millis();
+      sd_worker_check();
+    }
+
+    if (w.mounted && !sd_flush_pending()) {
+      Serial.println("[SD] Write failed - card treated as removed");
+      sd_worker_lose();
+    }
+    sd_worker_note_op(start);
+    sd_unlock();
+  }
+}
+
+static void sd_worker_notify(uint32_t note) {
+  if (g_sd_worker.task) xTaskNotify(g_sd_worker.task, note, eSetBits);
+}
+
+// Loop task: g_hw follows the worker's results
+static void sd_apply_event(const SdEvent& e) {
+  switch (e.type) {
+    case SD_EVENT_MOUNTED:
+      g_hw.sd_available = true;
+      g_hw.sd_state = SD_MOUNTED;
+      g_hw.sd_mount_time_ms = e.at_ms;
+      g_hw.sd_last_success_ms = e.at_ms;
+      g_hw.sd_consecutive_errors = 0;
+      g_hw.sd_total_bytes = e.total_bytes;
+      g_hw.sd_free_bytes = e.free_bytes;
+      break;
+    case SD_EVENT_MOUNT_FAILED:
+      g_hw.sd_available = false;
+      g_hw.sd_state = SD_ABSENT;
+      g_hw.sd_consecutive_errors++;
+      break;
+    case SD_EVENT_REMOVED:
+      // An error state set by sd_op_failure() stays until the next mount
+      g_hw.sd_available = false;
+      if (g_hw.sd_state != SD_ERROR) g_hw.sd_state = SD_ABSENT;
+      g_hw.sd_consecutive_errors++;
+      break;
+    case SD_EVENT_SPACE:
+      g_hw.sd_total_bytes = e.total_bytes;
+      g_hw.sd_free_bytes = e.free_bytes;
+      break;
+  }
+  g_hw.sd_last_check_ms = e.at_ms;
+}
+
+bool sd_worker_start(SPIClass& spi, int cs_pin, uint32_t speed, void (*on_mount)()) {
+  SdWorker& w = g_sd_worker;
+  if (w.task) return true;
+  w.spi = &spi;
+  w.cs_pin = cs_pin;
+  w.speed = speed;
+  w.on_mount = on_mount;
+
+  if (!w.events) {
+    w.events = xQueueCreateStatic(hw_config::SD_EVENT_DEPTH, sizeof(SdEvent),
+                                  g_sd_events_storage, &g_sd_events_buf);
+  }
+  if (!w.pending) {
+    w.pending = xRingbufferCreateStatic(sizeof(g_sd_pending_storage), RINGBUF_TYPE_NOSPLIT,
+                                        g_sd_pending_storage, &g_sd_pending_buf);
+  }
+  if (!w.events || !w.pending) return false;
+
+  if (xTaskCreate(sd_worker_task, "sd_worker", hw_config::SD_WORKER_STACK, nullptr,
+                  hw_config::SD_WORKER_PRIORITY, &w.task) != pdPASS) {
+    w.task = nullptr;
+    Serial.println("[!!] SD worker task failed; SD checks run on loop()");
+    return false;
+  }
+  g_sd_stats.running = true;
+  return true;
+}
+
+bool sd_async_enabled() {
+  return g_sd_worker.pending != nullptr;
+}
+
+bool sd_append_async(const char* path, const void* head, size_t head_len,
+                     const void* body, size_t body_len) {
+  RingbufHandle_t ring = g_sd_worker.pending;
+  size_t path_len = path ? strlen(path) : 0;
+  size_t data_len = head_len + (body ? body_len : 0);
+  bool ok = ring && path_len > 0 && path_len <= hw_config::SD_MAX_PATH && data_len <= UINT16_MAX;
+
+  void* item = nullptr;
+  if (ok) {
+    ok = xRingbufferSendAcquire(ring, &item, sizeof(SdPendingHeader) + path_len + 1 + data_len, 0) == pdTRUE;
+  }
+  if (ok) {
+    uint8_t* p = (uint8_t*)item;
+    SdPendingHeader hdr = { (uint16_t)path_len, (uint16_t)data_len };
+    memcpy(p, &hdr, sizeof(hdr));
+    p += sizeof(hdr);
+    memcpy(p, path, path_len + 1);
+    p += path_len + 1;
+    if (head_len) memcpy(p, head, head_len);
+    if (body && body_len) memcpy(p + head_len, body, body_len);
+    xRingbufferSendComplete(ring, item);
+  }
+
+  portENTER_CRITICAL(&g_sd_stats_mux);
+  if (ok) {
+    g_sd_stats.queued++;
+  } else if (ring) {
+    g_sd_stats.dropped++;
+  }
+  portEXIT_CRITICAL(&g_sd_stats_mux);
+  return ok;
+}
+
+SdWorkerStats sd_worker_get_stats() {
+  SdWorkerStats out;
+  portENTER_CRITICAL(&g_sd_stats_mux);
+  out = g_sd_stats;
+  portEXIT_CRITICAL(&g_sd_stats_mux);
+  if (g_sd_worker.pending) {
+    out.queued_bytes = sizeof(g_sd_pending_storage) - xRingbufferGetCurFreeSize(g_sd_worker.pending);
+  }
+  return out;
+}
+
 bool sd_verify_present() {
   if (!g_hw.sd_available || g_hw.sd_state != SD_MOUNTED) {
     return false;
@@ -465,6 +944,7 @@ bool sd_verify_present() {
 
   // Quick check - try to stat the root directory
   // This is fast and will fail if card removed
+  SdLockGuard lock;
   File root = SD.open("/");
   if (!root) {
     // Card was removed or failed
@@ -472,7 +952,11 @@ bool sd_verify_present() {
     g_hw.sd_state = SD_ABSENT;
     g_hw.sd_consecutive_errors++;
     Serial.println("[SD] Card removed or failed");
-    SD.end();  // Clean up
+    if (g_sd_worker.task) {
+      sd_worker_notify(SD_NOTE_LOST);  // The worker unmounts and retries
+    } else {
+      SD.end();  // Clean up
+    }
     return false;
   }
   root.close();
@@ -480,6 +964,15 @@ bool sd_verify_present() {
 }
 
 void sd_periodic_check(SPIClass& spi, int cs_pin, uint32_t speed) {
+  // The worker does the card I/O; here its results land in g_hw
+  if (g_sd_worker.task) {
+    SdEvent e;
+    while (xQueueReceive(g_sd_worker.events, &e, 0) == pdTRUE) {
+      sd_apply_event(e);
+    }
+    return;
+  }
+
   uint32_t now = millis();
 
   // Don't check too frequently
@@ -487,6 +980,7 @@ void sd_periodic_check(SPIClass& spi, int cs_pin, uint32_t speed) {
     return;
   }
   g_hw.sd_last_check_ms = now;
+  SdLockGuard lock;
 
   if (g_hw.sd_state == SD_MOUNTED) {
     // Verify still mounted
@@ -495,13 +989,15 @@ void sd_periodic_check(SPIClass& spi, int cs_pin, uint32_t speed) {
     } else {
       // Periodically update space cache
       sd_update_space_cache();
+      if (g_sd_worker.pending && !sd_flush_pending()) sd_op_failure();
     }
   } else {
     // Not mounted - try to mount (card may have been re-inserted)
     Serial.println("[SD] Periodic check - attempting remount...");
     if (sd_mount_safe(spi, cs_pin, speed)) {
       Serial.println("[SD] Card re-detected and mounted");
-      // TODO: Flush any buffered data to SD
+      if (g_sd_worker.on_mount) g_sd_worker.on_mount();
+      if (g_sd_worker.pending && !sd_flush_pending()) sd_op_failure();
     }
   }
 }
@@ -526,15 +1022,25 @@ void sd_op_failure() {
       Serial.println("[SD] Multiple consecutive errors - marking as error state");
       g_hw.sd_state = SD_ERROR;
       g_hw.sd_available = false;
-      SD.end();
+      if (g_sd_worker.task) {
+        sd_worker_notify(SD_NOTE_LOST);
+      } else {
+        SdLockGuard lock;
+        SD.end();
+      }
     }
   }
 }
 
 void sd_unmount_safe() {
   if (g_hw.sd_state == SD_MOUNTED) {
-    Serial.println("[SD] Unmounting...");
-    SD.end();
+    if (g_sd_worker.task) {
+      sd_worker_notify(SD_NOTE_UNMOUNT);  // Flushes the queue first
+    } else {
+      Serial.println("[SD] Unmounting...");
+      SdLockGuard lock;
+      SD.end();
+    }
     g_hw.sd_available = false;
     g_hw.sd_state = SD_ABSENT;
   }
@@ -544,8 +1050,13 @@ void sd_update_space_cache() {
   if (g_hw.sd_state != SD_MOUNTED || !g_hw.sd_available) {
     return;
   }
+  if (g_sd_worker.task) {
+    sd_worker_notify(SD_NOTE_SPACE);  // Answered with an SD_EVENT_SPACE
+    return;
+  }
 
   // These calls can be slow, so we only do them periodically, not on every API request
+  SdLockGuard lock;
   g_hw.sd_total_bytes = SD.totalBytes();
   uint64_t used = SD.usedBytes();
   g_hw.sd_free_bytes = (g_hw.sd_total_bytes > used) ? (g_hw.sd_total_bytes - used) : 0;
@@ -669,12 +1180,23 @@ void hw_state_print() {
     Serial.printf("           Writes: %lu, Errors: %lu\n",
                   g_hw.sd_write_count, g_hw.sd_error_count);
   }
+  if (sd_async_enabled()) {
+    SdWorkerStats ws = sd_worker_get_stats();
+    Serial.printf("           Queue: %lu waiting (%lu B), %lu written, %lu dropped, %lu write errors\n",
+                  (unsigned long)ws.queued, (unsigned long)ws.queued_bytes,
+                  (unsigned long)ws.flushed, (unsigned long)ws.dropped,
+                  (unsigned long)ws.write_errors);
+    Serial.printf("           Worker: %s, %lu mount attempts, slowest op %lu ms\n",
+                  ws.running ? "running" : "off (loop)",
+                  (unsigned long)ws.mount_attempts, (unsigned long)ws.longest_op_ms);
+  }
   Serial.println();
   Serial.printf("  Camera: %s\n", g_hw.camera_available ? "available" : "not initialized");
   Serial.println("========================");
 }
 
-size_t hw_state_json(char* buf, size_t buf_size) {
+static size_t hw_state_render(char* buf, size_t buf_size) {
+  SdWorkerStats ws = sd_worker_get_stats();
   int len = snprintf(buf, buf_size,
     "{"
     "\"safe_mode\":%s,"
@@ -690,7 +1212,14 @@ size_t hw_state_json(char* buf, size_t buf_size) {
       "\"total_bytes\":%llu,"
       "\"free_bytes\":%llu,"
       "\"writes\":%lu,"
-      "\"errors\":%lu"
+      "\"errors\":%lu,"
+      "\"worker\":%s,"
+      "\"queued\":%lu,"
+      "\"queued_bytes\":%lu,"
+      "\"flushed\":%lu,"
+      "\"dropped\":%lu,"
+      "\"write_errors\":%lu,"
+      "\"longest_op_ms\":%lu"
     "},"
     "\"camera\":{\"available\":%s}"
     "}",
@@ -705,10 +1234,39 @@ size_t hw_state_json(char* buf, size_t buf_size) {
     g_hw.sd_free_bytes,
     g_hw.sd_write_count,
     g_hw.sd_error_count,
+    ws.running ? "true" : "false",
+    (unsigned long)ws.queued,
+    (unsigned long)ws.queued_bytes,
+    (unsigned long)ws.flushed,
+    (unsigned long)ws.dropped,
+    (unsigned long)ws.write_errors,
+    (unsigned long)ws.longest_op_ms,
     g_hw.camera_available ? "true" : "false"
   );
 
   return (len > 0 && len < (int)buf_size) ? len : 0;
 }
 
+void hw_state_publish() {
+  uint32_t now = millis();
+  if (now - g_hw_json_ms < hw_config::JSON_REFRESH_MS) return;
+  g_hw_json_ms = now;
+
+  HwStateJson& out = g_hw_json.begin();
+  out.len = (uint16_t)hw_state_render(out.text, sizeof(out.text));
+  g_hw_json.publish();
+}
+
+size_t hw_state_json(char* buf, size_t buf_size) {
+  size_t len = 0;
+  bool ok = g_hw_json.read([&](const HwStateJson& cached) {
+    len = cached.len;
+    if (len == 0 || len >= buf_size) { len = 0; return; }
+    memcpy(buf, cached.text, len + 1);
+  });
+  return ok ? len : 0;
+}
+
+#endif // HARDWARE_STATE_NO_IMPL
+
 #endif // SECURACV_HARDWARE_STATE_H
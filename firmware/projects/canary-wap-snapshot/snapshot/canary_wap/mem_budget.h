@@ -0,0 +1,178 @@
+/*
+ * SecuraCV Canary — Memory Placement and Budget Report
+ *
+ * Internal SRAM runs out long before PSRAM is touched, so large buffers
+ * are placed by how they are used:
+ *
+ *   PSRAM_BSS     Cold bulk buffers: histories, reassembly and stream
+ *                 rings, JSON arenas. Touched from loop() or httpd, never
+ *                 from an ISR or while the flash cache is off.
+ *   (default)     Latency-critical and secret state stays in internal
+ *                 DRAM: rings filled from radio callbacks, AEAD contexts
+ *                 and key material (PSRAM is an external chip).
+ *
+ * PSRAM_BSS needs CONFIG_SPIRAM_ALLOW_BSS_SEG_EXTERNAL_MEMORY, as
+ * MEM_POOL_PSRAM in mem_pool.h does; without it the buffer stays in
+ * internal BSS, and the report shows that. Camera frame buffers are heap
+ * allocations (CAMERA_FB_IN_PSRAM) and show in the PSRAM heap line.
+ *
+ * Each module registers its large statics with MEM_BUDGET_STATIC next to
+ * the definition. print_report() runs once at boot (and on the 'm' serial
+ * command): heap per region, then registered statics by region and
+ * subsystem, classified by address so the real placement is reported.
+ * On the ESP32-S3, IRAM and DRAM are carved from the same internal SRAM,
+ * so the internal line covers both.
+ */
+
+#ifndef SECURACV_MEM_BUDGET_H
+#define SECURACV_MEM_BUDGET_H
+
+#include <Arduino.h>
+#include <esp_attr.h>
+#include <esp_heap_caps.h>
+#if __has_include(<esp_memory_utils.h>)
+#include <esp_memory_utils.h>         // IDF 5
+#else
+#include <soc/soc_memory_layout.h>     // IDF 4.4
+#endif
+
+// ════════════════════════════════════════════════════════════════════════════
+// PLACEMENT
+// ════════════════════════════════════════════════════════════════════════════
+
+#if defined(EXT_RAM_BSS_ATTR) && defined(CONFIG_SPIRAM_ALLOW_BSS_SEG_EXTERNAL_MEMORY)
+#define PSRAM_BSS EXT_RAM_BSS_ATTR
+#else
+#define PSRAM_BSS
+#endif
+
+// Register a static buffer with the budget report (file scope, once)
+#define MEM_BUDGET_STATIC(subsystem, var) \
+  static mem_budget::Entry var##_budget(subsystem, #var, &(var), sizeof(var))
+
+// Linker symbols bounding internal .data and .bss
+extern "C" int _data_start, _data_end, _bss_start, _bss_end;
+
+namespace mem_budget {
+
+// ════════════════════════════════════════════════════════════════════════════
+// REGISTRY
+// ════════════════════════════════════════════════════════════════════════════
+
+enum Region : uint8_t {
+  REGION_INTERNAL = 0,
+  REGION_PSRAM    = 1,
+  REGION_OTHER    = 2,
+  REGION_COUNT
+};
+
+static const size_t MAX_SUBSYSTEMS = 12;
+
+// Linked at static-init time; the head is constant-initialized, so the
+// order in which translation units construct their entries does not matter
+struct Entry {
+  const char* subsystem;
+  const char* name;
+  const void* addr;
+  size_t bytes;
+  Entry* next;
+
+  Entry(const char* sub, const char* n, const void* a, size_t b);
+};
+
+inline Entry*& registry_head() {
+  static Entry* head = nullptr;
+  return head;
+}
+
+inline Entry::Entry(const char* sub, const char* n, const void* a, size_t b)
+  : subsystem(sub), name(n), addr(a), bytes(b), next(registry_head()) {
+  registry_head() = this;
+}
+
+inline Region region_of(const void* p) {
+  if (esp_ptr_external_ram(p)) return REGION_PSRAM;
+  if (esp_ptr_internal(p)) return REGION_INTERNAL;
+  return REGION_OTHER;
+}
+
+inline const char* region_name(Region r) {
+  switch (r) {
+    case REGION_INTERNAL: return "internal";
+    case REGION_PSRAM:    return "psram";
+    default:              return "other";
+  }
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// REPORT
+// ════════════════════════════════════════════════════════════════════════════
+
+inline void print_heap(const char* label, uint32_t caps) {
+  size_t total = heap_caps_get_total_size(caps);
+  if (total == 0) {
+    Serial.printf("  %-9s heap: none\n", label);
+    return;
+  }
+  Serial.printf("  %-9s heap: %6u KB total, %6u KB free, %6u KB min free, %6u KB largest\n",
+                label, (unsigned)(total / 1024),
+                (unsigned)(heap_caps_get_free_size(caps) / 1024),
+                (unsigned)(heap_caps_get_minimum_free_size(caps) / 1024),
+                (unsigned)(heap_caps_get_largest_free_block(caps) / 1024));
+}
+
+inline void print_report() {
+  size_t data_bytes = (size_t)((uint8_t*)&_data_end - (uint8_t*)&_data_start);
+  size_t bss_bytes = (size_t)((uint8_t*)&_bss_end - (uint8_t*)&_bss_start);
+
+  Serial.println("[..] Memory budget:");
+  print_heap("internal", MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+  print_heap("dma", MALLOC_CAP_DMA);
+  print_heap("psram", MALLOC_CAP_SPIRAM);
+  Serial.printf("  internal static: %u B .data, %u B .bss\n",
+                (unsigned)data_bytes, (unsigned)bss_bytes);
+
+  size_t region_total[REGION_COUNT] = {};
+  for (uint8_t r = 0; r < REGION_COUNT; r++) {
+    // Sum per subsystem in this region; subsystem names are string literals
+    const char* subs[MAX_SUBSYSTEMS];
+    size_t sub_bytes[MAX_SUBSYSTEMS];
+    size_t nsubs = 0;
+    for (Entry* e = registry_head(); e; e = e->next) {
+      if (region_of(e->addr) != (Region)r) continue;
+      region_total[r] += e->bytes;
+      size_t i = 0;
+      while (i < nsubs && strcmp(subs[i], e->subsystem) != 0) i++;
+      if (i == nsubs) {
+        if (nsubs == MAX_SUBSYSTEMS) continue;
+        subs[nsubs] = e->subsystem;
+        sub_bytes[nsubs++] = 0;
+      }
+      sub_bytes[i] += e->bytes;
+    }
+    if (nsubs == 0) continue;
+
+    Serial.printf("  %s static, registered: %u B\n", region_name((Region)r), (unsigned)region_total[r]);
+    for (size_t i = 0; i < nsubs; i++) {
+      Serial.printf("    %-12s %7u B\n", subs[i], (unsigned)sub_bytes[i]);
+      for (Entry* e = registry_head(); e; e = e->next) {
+        if (region_of(e->addr) == (Region)r && strcmp(e->subsystem, subs[i]) == 0) {
+          Serial.printf("      %-22s %7u B\n", e->name, (unsigned)e->bytes);
+        }
+      }
+    }
+  }
+
+  size_t internal_static = data_bytes + bss_bytes;
+  if (internal_static >= region_total[REGION_INTERNAL]) {
+    Serial.printf("  internal static, unregistered: %u B\n",
+                  (unsigned)(internal_static - region_total[REGION_INTERNAL]));
+  }
+  #if !defined(CONFIG_SPIRAM_ALLOW_BSS_SEG_EXTERNAL_MEMORY)
+  Serial.println("  [--] PSRAM BSS disabled in sdkconfig: cold buffers are in internal RAM");
+  #endif
+}
+
+}  // namespace mem_budget
+
+#endif // SECURACV_MEM_BUDGET_H
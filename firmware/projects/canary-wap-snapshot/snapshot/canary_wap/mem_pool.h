@@ -0,0 +1,167 @@
+/*
+ * SecuraCV Canary — Fixed-Block Memory Pools
+ *
+ * Matches common/core/mem_pool.h (this sketch cannot include common/).
+ * A MemPool<BlockSize, Count> is a static array of blocks plus a free-bit
+ * map, so hot-path buffers come from BSS instead of the heap and the heap
+ * does not fragment over long uptimes. alloc() and free() are lock-free;
+ * an empty pool returns nullptr and counts a failure, it never grows.
+ * stats() reports blocks in use, the high-water mark and failures.
+ */
+
+#ifndef SECURACV_MEM_POOL_H
+#define SECURACV_MEM_POOL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+// ════════════════════════════════════════════════════════════════════════════
+// PLACEMENT
+// ════════════════════════════════════════════════════════════════════════════
+
+// PSRAM BSS needs CONFIG_SPIRAM_ALLOW_BSS_SEG_EXTERNAL_MEMORY; without it
+// (or off target) the pool stays in internal RAM
+#if defined(ESP_PLATFORM)
+#include <esp_attr.h>
+#endif
+#if defined(EXT_RAM_BSS_ATTR) && defined(CONFIG_SPIRAM_ALLOW_BSS_SEG_EXTERNAL_MEMORY)
+#define MEM_POOL_PSRAM EXT_RAM_BSS_ATTR
+#else
+#define MEM_POOL_PSRAM
+#endif
+
+// ════════════════════════════════════════════════════════════════════════════
+// STATISTICS
+// ════════════════════════════════════════════════════════════════════════════
+
+typedef struct {
+  uint32_t block_size;
+  uint32_t blocks;
+  uint32_t in_use;
+  uint32_t high_water;        // Most blocks ever held at once
+  uint32_t failures;          // alloc() calls that found the pool empty
+} mem_pool_stats_t;
+
+// ════════════════════════════════════════════════════════════════════════════
+// FIXED-BLOCK POOL
+// ════════════════════════════════════════════════════════════════════════════
+
+template <size_t BlockSize, size_t Count>
+class MemPool {
+  static_assert(BlockSize > 0 && Count > 0, "empty pool");
+
+  static constexpr size_t ALIGN = alignof(max_align_t);
+  static constexpr size_t STRIDE = (BlockSize + ALIGN - 1) & ~(ALIGN - 1);
+  static constexpr size_t WORDS = (Count + 31) / 32;
+
+public:
+  static constexpr size_t block_size = BlockSize;
+  static constexpr size_t block_count = Count;
+
+  // All-zero state is an empty pool (bits mark blocks in use), so a pool
+  // needs no initializer and can sit in a NOLOAD section such as PSRAM BSS
+  constexpr MemPool()
+      : used_{}, in_use_(0), high_water_(0), failures_(0), storage_{} {}
+
+  MemPool(const MemPool&) = delete;
+  MemPool& operator=(const MemPool&) = delete;
+
+  // Take one block of at least BlockSize bytes; nullptr if exhausted
+  void* alloc() {
+    for (size_t w = 0; w < WORDS; w++) {
+      uint32_t cur = used_[w].load(std::memory_order_relaxed);
+      for (;;) {
+        uint32_t free_bits = ~cur & valid_mask(w);
+        if (free_bits == 0) break;
+        uint32_t bit = free_bits & (0u - free_bits);
+        if (used_[w].compare_exchange_weak(cur, cur | bit,
+                                           std::memory_order_acquire,
+                                           std::memory_order_relaxed)) {
+          note_alloc();
+          return storage_ + (w * 32 + index_of(bit)) * STRIDE;
+        }
+      }
+    }
+    failures_.fetch_add(1, std::memory_order_relaxed);
+    return nullptr;
+  }
+
+  // Return a block from alloc(); nullptr and foreign pointers are ignored
+  void free(void* p) {
+    if (!owns(p)) return;
+    size_t idx = (static_cast<uint8_t*>(p) - storage_) / STRIDE;
+    uint32_t bit = 1u << (idx % 32);
+    uint32_t prev = used_[idx / 32].fetch_and(~bit, std::memory_order_release);
+    if (prev & bit) in_use_.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  bool owns(const void* p) const {
+    const uint8_t* b = static_cast<const uint8_t*>(p);
+    return b >= storage_ && b < storage_ + Count * STRIDE &&
+           (size_t)(b - storage_) % STRIDE == 0;
+  }
+
+  size_t in_use() const { return in_use_.load(std::memory_order_relaxed); }
+  size_t high_water() const { return high_water_.load(std::memory_order_relaxed); }
+
+  mem_pool_stats_t stats() const {
+    mem_pool_stats_t s;
+    s.block_size = (uint32_t)BlockSize;
+    s.blocks = (uint32_t)Count;
+    s.in_use = in_use_.load(std::memory_order_relaxed);
+    s.high_water = high_water_.load(std::memory_order_relaxed);
+    s.failures = failures_.load(std::memory_order_relaxed);
+    return s;
+  }
+
+private:
+  static constexpr uint32_t valid_mask(size_t w) {
+    return (w + 1 < WORDS || Count % 32 == 0) ? 0xFFFFFFFFu
+                                              : (1u << (Count % 32)) - 1;
+  }
+
+  static size_t index_of(uint32_t bit) {
+    size_t i = 0;
+    while (!(bit & 1u)) { bit >>= 1; i++; }
+    return i;
+  }
+
+  void note_alloc() {
+    uint32_t n = in_use_.fetch_add(1, std::memory_order_relaxed) + 1;
+    uint32_t hw = high_water_.load(std::memory_order_relaxed);
+    while (n > hw && !high_water_.compare_exchange_weak(hw, n, std::memory_order_relaxed)) {}
+  }
+
+  std::atomic<uint32_t> used_[WORDS];
+  std::atomic<uint32_t> in_use_;
+  std::atomic<uint32_t> high_water_;
+  std::atomic<uint32_t> failures_;
+  alignas(max_align_t) uint8_t storage_[Count * STRIDE];
+};
+
+// ════════════════════════════════════════════════════════════════════════════
+// RAII BLOCK
+// ════════════════════════════════════════════════════════════════════════════
+
+// Holds one pool block for a scope; check ok() before use
+template <typename Pool>
+class PoolBlock {
+public:
+  explicit PoolBlock(Pool& pool) : pool_(pool), p_(static_cast<uint8_t*>(pool.alloc())) {}
+  ~PoolBlock() { pool_.free(p_); }
+
+  PoolBlock(const PoolBlock&) = delete;
+  PoolBlock& operator=(const PoolBlock&) = delete;
+
+  bool ok() const { return p_ != nullptr; }
+  uint8_t* data() { return p_; }
+  char* str() { return reinterpret_cast<char*>(p_); }
+  static constexpr size_t size() { return Pool::block_size; }
+
+private:
+  Pool& pool_;
+  uint8_t* p_;
+};
+
+#endif // SECURACV_MEM_POOL_H
@@ -8,6 +8,10 @@
 
 #include "mesh_network.h"
 #include "log_level.h"
+#include "domain_hash.h"
+#include "nvs_store.h"
+#include "radio_scheduler.h"
+#include "mem_budget.h"
 
 #include <Arduino.h>
 #include <Preferences.h>
@@ -19,7 +23,9 @@
 #include <Curve25519.h>
 #include <mbedtls/sha256.h>
 #include <mbedtls/hkdf.h>
+#include <mbedtls/gcm.h>
 #include <ChaChaPoly.h>
+#include <atomic>
 
 namespace mesh_network {
 
@@ -37,7 +43,11 @@ static const char* DOMAIN_FLOCK_ID = "securacv:opera:id:v0";
 static const char* DOMAIN_AUTH = "securacv:mesh:auth:v0";
 static const char* DOMAIN_SESSION = "securacv:mesh:session:v0";
 static const char* DOMAIN_MESSAGE = "securacv:mesh:message:v0";
+static const char* DOMAIN_SESSION_AEAD = "securacv:mesh:session-aead:v0";
 static const char* DOMAIN_PAIR_CONFIRM = "securacv:pair:confirm:v0";
+static const char* DOMAIN_DEDUP = "securacv:mesh:dedup:v0";
+static const char* DOMAIN_ANCHOR_LEAF = "securacv:mesh:anchor-leaf:v0";
+static const char* DOMAIN_ANCHOR_NODE = "securacv:mesh:anchor-node:v0";
 
 // ════════════════════════════════════════════════════════════════════════════
 // NVS KEYS
@@ -57,6 +67,7 @@ static const char* NVS_PEER_PREFIX = "peer_";   // peer_0, peer_1, etc.
 
 static bool g_initialized = false;
 static Preferences g_prefs;
+static NvsTransaction g_nvs_tx(NVS_NS);   // Static: a full peer table is ~3.5 KB
 
 // Device identity (references to main firmware keys)
 static const uint8_t* g_device_privkey = nullptr;
@@ -69,6 +80,13 @@ static OperaConfig g_opera_config;
 static OperaPeer g_peers[MAX_OPERA_SIZE];
 static uint8_t g_peer_count = 0;
 
+// Fingerprint index: open addressing over g_peers, rebuilt when peers move
+static const size_t FP_INDEX_SIZE = 128;
+static const uint8_t FP_INDEX_NONE = 0xFF;
+static_assert((FP_INDEX_SIZE & (FP_INDEX_SIZE - 1)) == 0, "fingerprint index must be a power of two");
+static_assert(FP_INDEX_SIZE >= 2 * MAX_OPERA_SIZE, "fingerprint index load factor above 1/2");
+static uint8_t g_fp_index[FP_INDEX_SIZE];
+
 // Mesh state
 static MeshState g_mesh_state = MESH_DISABLED;
 static bool g_espnow_initialized = false;
@@ -80,17 +98,70 @@ static uint32_t g_message_errors = 0;
 static uint32_t g_alerts_sent = 0;
 static uint32_t g_alerts_received = 0;
 static uint32_t g_auth_failures = 0;
+static uint32_t g_alerts_relayed = 0;
+static uint32_t g_duplicates = 0;
+
+// Relayable alerts carry one device-wide counter, the same in every copy,
+// so a relayed frame is replay-checked like a direct one
+static uint64_t g_alert_counter_tx = 0;
+
+// Relay election (re-run with each peer check)
+static uint8_t g_relay_score = 0;
+static bool g_is_relay = false;
+
+// Alerts already handled, by origin and content, whichever path they came by
+struct SeenAlert {
+  uint32_t key;
+  uint32_t seen_ms;
+};
+static SeenAlert g_seen[DEDUP_CACHE_SIZE];
+static size_t g_seen_head = 0;
 static uint32_t g_start_time_ms = 0;
 
 // Timing
 static uint32_t g_last_heartbeat_ms = 0;
+static uint32_t g_heartbeat_interval_ms = HEARTBEAT_INTERVAL_MS;  // Last advertised
+static uint32_t g_heartbeats_skipped = 0;
+static uint32_t g_last_alert_ms = 0;           // Last alert sent or received (0 = none)
 static uint32_t g_last_peer_check_ms = 0;
 
 // Pairing
 static PairingSession g_pairing;
 
+// Chain heads noted by the witness writer (the only producer), folded by
+// update() into the anchor for the next heartbeat
+struct PendingHead {
+  uint32_t seq;
+  uint8_t chain_hash[32];
+};
+static_assert((ANCHOR_PENDING_SLOTS & (ANCHOR_PENDING_SLOTS - 1)) == 0, "pending head ring must be a power of two");
+static PendingHead g_head_slots[ANCHOR_PENDING_SLOTS];
+static std::atomic<uint32_t> g_head_head{0};
+static std::atomic<uint32_t> g_head_tail{0};
+static std::atomic<uint32_t> g_heads_dropped{0};
+
+// Our heads since the last anchor. g_anchor_peaks[h] is the root of a
+// complete subtree of 2^h heads, present while bit h of g_anchor_count is set.
+static uint8_t g_anchor_peaks[ANCHOR_MAX_HEIGHT + 1][32];
+static uint16_t g_anchor_count = 0;
+static uint32_t g_anchor_first_seq = 0;
+static uint32_t g_anchor_last_seq = 0;
+static uint32_t g_anchors_sent = 0;
+static uint32_t g_anchor_sent_seq = 0;
+static uint32_t g_anchors_received = 0;
+static uint32_t g_anchor_gaps = 0;
+static uint32_t g_anchor_conflicts = 0;
+static uint32_t g_anchors_dropped = 0;
+
+// Anchors received from peers
+PSRAM_BSS static AnchorReceipt g_receipts[MAX_ANCHOR_RECEIPTS];
+MEM_BUDGET_STATIC("mesh", g_receipts);
+static size_t g_receipt_count = 0;
+static size_t g_receipt_head = 0;
+
 // Alert history
-static MeshAlert g_alert_history[MAX_ALERT_HISTORY];
+PSRAM_BSS static MeshAlert g_alert_history[MAX_ALERT_HISTORY];
+MEM_BUDGET_STATIC("mesh", g_alert_history);
 static size_t g_alert_count = 0;
 static size_t g_alert_head = 0;
 
@@ -98,13 +169,103 @@ static size_t g_alert_head = 0;
 static AlertCallback g_alert_callback = nullptr;
 static PeerStateCallback g_peer_state_callback = nullptr;
 static PairingCallback g_pairing_callback = nullptr;
-
-// Receive buffer
-static uint8_t g_rx_buffer[MAX_MESSAGE_SIZE];
-static size_t g_rx_len = 0;
-static uint8_t g_rx_mac[6];
-static int8_t g_rx_rssi = 0;
-static volatile bool g_rx_pending = false;
+static BulkCallback g_bulk_callback = nullptr;
+static AnchorCallback g_anchor_callback = nullptr;
+
+// Receive ring: the ESP-NOW callback (WiFi task) is the only producer and
+// update() the only consumer, so head and tail each have a single writer
+static_assert((RX_QUEUE_SLOTS & (RX_QUEUE_SLOTS - 1)) == 0, "receive ring must be a power of two");
+
+struct RxSlot {
+  uint8_t mac[6];
+  int8_t rssi;
+  uint8_t len;
+  uint8_t data[MAX_MESSAGE_SIZE];
+};
+
+// Filled from the WiFi task on every frame: stays in internal RAM
+static RxSlot g_rx_slots[RX_QUEUE_SLOTS];
+MEM_BUDGET_STATIC("mesh", g_rx_slots);
+static std::atomic<uint32_t> g_rx_head{0};     // Next slot the callback fills
+static std::atomic<uint32_t> g_rx_tail{0};     // Next slot update() reads
+static std::atomic<uint32_t> g_rx_dropped{0};
+static std::atomic<uint32_t> g_rx_rejected{0};
+static std::atomic<uint32_t> g_rx_peak{0};
+static int8_t g_rx_rssi = 0;                   // RSSI of the message being handled
+
+// Send-status ring: the ESP-NOW send callback (WiFi task) produces,
+// update() consumes and credits the result to the peer
+static_assert((TX_STATUS_SLOTS & (TX_STATUS_SLOTS - 1)) == 0, "send-status ring must be a power of two");
+
+struct TxStatusSlot {
+  uint8_t mac[6];
+  bool delivered;
+};
+
+static TxStatusSlot g_tx_status[TX_STATUS_SLOTS];
+static std::atomic<uint32_t> g_tx_status_head{0};
+static std::atomic<uint32_t> g_tx_status_tail{0};
+static uint32_t g_tx_acked = 0;
+static uint32_t g_tx_failed = 0;
+
+// Session AEAD contexts, keyed once per session and reused for every
+// message. mbedtls runs AES-GCM on the ESP32 AES accelerator. Peers hold a
+// slot index so the table never moves when g_peers is compacted.
+static_assert(MAX_SESSIONS <= 16, "AEAD slot mask is 16 bits");
+static mbedtls_gcm_context g_aead_ctx[MAX_SESSIONS];   // Key schedules: internal RAM only
+MEM_BUDGET_STATIC("mesh", g_aead_ctx);
+static uint16_t g_aead_used = 0;
+
+// Bulk transfers: fixed pools, addressed by peer fingerprint because
+// g_peers entries move when a peer is removed
+static_assert(MAX_FRAGMENTS <= 32, "fragment masks are 32 bits");
+static_assert(sizeof(PeerListPayload) <= MAX_MESSAGE_SIZE - 38 - SIGNATURE_SIZE, "peer list exceeds a signed frame");
+static_assert(MAX_BULK_SIZE <= MAX_FRAGMENTS * FRAGMENT_DATA_SIGNED, "bulk payload needs too many fragments");
+static_assert(sizeof(FragmentHeader) + FRAGMENT_DATA_SEALED <=
+              MAX_MESSAGE_SIZE - 38 - NONCE_SIZE - SESSION_TAG_SIZE, "sealed fragment exceeds a frame");
+static_assert(sizeof(FragmentHeader) + FRAGMENT_DATA_SIGNED <=
+              MAX_MESSAGE_SIZE - 38 - SIGNATURE_SIZE, "signed fragment exceeds a frame");
+
+struct TxTransfer {
+  bool active;
+  uint8_t peer_fp[FINGERPRINT_SIZE];
+  uint16_t id;
+  uint16_t len;
+  uint8_t count;
+  uint8_t frag_size;
+  uint8_t bulk_type;
+  uint8_t window;                       // Receiver's last credit
+  uint8_t busy_count;
+  uint32_t acked;
+  uint32_t stall_until_ms;
+  uint32_t sent_ms[MAX_FRAGMENTS];      // 0 = not in flight
+  uint8_t tries[MAX_FRAGMENTS];
+  uint8_t data[MAX_BULK_SIZE];
+};
+
+struct RxTransfer {
+  bool active;
+  bool complete;                        // Delivered; kept to re-ack late duplicates
+  uint8_t peer_fp[FINGERPRINT_SIZE];
+  uint16_t id;
+  uint16_t len;
+  uint8_t count;
+  uint8_t frag_size;
+  uint8_t bulk_type;
+  uint32_t received;
+  uint32_t last_ms;
+  uint8_t data[MAX_BULK_SIZE];
+};
+
+PSRAM_BSS static TxTransfer g_bulk_tx[BULK_TX_SLOTS];
+PSRAM_BSS static RxTransfer g_bulk_rx[BULK_RX_SLOTS];
+MEM_BUDGET_STATIC("mesh", g_bulk_tx);
+MEM_BUDGET_STATIC("mesh", g_bulk_rx);
+static uint16_t g_next_transfer_id = 1;
+static uint32_t g_bulk_sent = 0;
+static uint32_t g_bulk_received = 0;
+static uint32_t g_bulk_failed = 0;
+static uint32_t g_fragments_retransmitted = 0;
 
 // ════════════════════════════════════════════════════════════════════════════
 // FORWARD DECLARATIONS
@@ -119,15 +280,35 @@ static bool decrypt_message(const uint8_t* key, const uint8_t* ciphertext, size_
                            const uint8_t* nonce, const uint8_t* tag, uint8_t* plaintext);
 static bool sign_message(const uint8_t* privkey, const uint8_t* data, size_t len, uint8_t* sig_out);
 static bool verify_signature(const uint8_t* pubkey, const uint8_t* data, size_t len, const uint8_t* sig);
+static bool key_peer_aead(OperaPeer* peer);
+static void release_peer_aead(OperaPeer* peer);
+static bool uses_session_aead(MessageType type);
 static void update_peer_state(OperaPeer* peer, PeerState new_state);
 static OperaPeer* find_peer_by_mac(const uint8_t* mac);
 static OperaPeer* find_peer_by_fingerprint(const uint8_t* fp);
 static bool add_peer(const uint8_t* pubkey, const uint8_t* mac, const char* name);
-static bool send_raw_message(const uint8_t* mac, const uint8_t* data, size_t len);
-static bool send_to_peer(OperaPeer* peer, MessageType type, const uint8_t* payload, size_t len);
+static bool send_raw_message(const uint8_t* mac, const uint8_t* data, size_t len, uint8_t replace_key = 0);
+static bool send_to_peer(OperaPeer* peer, MessageType type, const uint8_t* payload, size_t len,
+                         bool replaceable = true);
 static bool broadcast_message(MessageType type, const uint8_t* payload, size_t len);
-static void handle_received_message(const uint8_t* mac, const uint8_t* data, size_t len);
-static void handle_heartbeat(OperaPeer* peer, const uint8_t* payload);
+static void handle_received_message(const uint8_t* mac, const uint8_t* data, size_t len, int relay_hops = -1);
+static bool is_relayable(MessageType type);
+static bool seen_alert(const uint8_t* origin_fp, MessageType type, const uint8_t* payload, size_t len);
+static void forward_relay(const uint8_t* frame, size_t len, uint8_t hops_left);
+static void elect_relay();
+static void rebuild_fp_index();
+static void handle_heartbeat(OperaPeer* peer, const uint8_t* payload, size_t len);
+static void update_link_rssi(OperaPeer* peer, int8_t rssi);
+static void drain_tx_status();
+static void handle_peer_list(OperaPeer* peer, const uint8_t* payload, size_t len);
+static void handle_anchor(OperaPeer* peer, const uint8_t* data, size_t len);
+static void fold_chain_heads();
+static uint32_t heartbeat_interval_ms(uint32_t now);
+static uint32_t peer_heartbeat_ms(const OperaPeer* peer);
+static void send_heartbeats(bool force);
+static void handle_fragment(OperaPeer* peer, const uint8_t* payload, size_t len);
+static void handle_fragment_ack(OperaPeer* peer, const uint8_t* payload, size_t len);
+static void pump_bulk_transfers(uint32_t now);
 static void handle_auth_challenge(const uint8_t* mac, const uint8_t* payload);
 static void handle_auth_response(OperaPeer* peer, const uint8_t* payload);
 static void handle_tamper_alert(OperaPeer* peer, const uint8_t* payload);
@@ -148,22 +329,46 @@ static void store_alert(const MeshAlert* alert);
 // ESP-NOW CALLBACKS
 // ════════════════════════════════════════════════════════════════════════════
 
-static void espnow_send_cb(const wifi_tx_info_t* info, esp_now_send_status_t status) {
-  (void)info;  // Unused - MAC available in info->peer_addr if needed
-  if (status != ESP_NOW_SEND_SUCCESS) {
+// Every attempt's result, passed on by radio_scheduler (WiFi task)
+static void espnow_send_cb(const uint8_t* mac, bool delivered) {
+  if (!delivered) {
     g_message_errors++;
   }
+
+  // Full ring: the result is lost, which only thins the delivery sample
+  uint32_t head = g_tx_status_head.load(std::memory_order_relaxed);
+  if (head - g_tx_status_tail.load(std::memory_order_acquire) >= TX_STATUS_SLOTS) {
+    return;
+  }
+  TxStatusSlot& slot = g_tx_status[head & (TX_STATUS_SLOTS - 1)];
+  memcpy(slot.mac, mac, 6);
+  slot.delivered = delivered;
+  g_tx_status_head.store(head + 1, std::memory_order_release);
 }
 
 static void espnow_recv_cb(const esp_now_recv_info_t* info, const uint8_t* data, int len) {
-  if (len <= 0 || len > MAX_MESSAGE_SIZE || g_rx_pending) {
+  if (len <= 0 || len > (int)MAX_MESSAGE_SIZE) {
+    g_rx_rejected.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  uint32_t head = g_rx_head.load(std::memory_order_relaxed);
+  uint32_t used = head - g_rx_tail.load(std::memory_order_acquire);
+  if (used >= RX_QUEUE_SLOTS) {
+    g_rx_dropped.fetch_add(1, std::memory_order_relaxed);
     return;
   }
-  memcpy(g_rx_mac, info->src_addr, 6);
-  memcpy(g_rx_buffer, data, len);
-  g_rx_len = len;
-  g_rx_rssi = info->rx_ctrl->rssi;  // Store actual RSSI from ESP-NOW
-  g_rx_pending = true;
+
+  RxSlot& slot = g_rx_slots[head & (RX_QUEUE_SLOTS - 1)];
+  memcpy(slot.mac, info->src_addr, 6);
+  memcpy(slot.data, data, len);
+  slot.len = len;
+  slot.rssi = info->rx_ctrl->rssi;  // Actual RSSI from ESP-NOW
+  g_rx_head.store(head + 1, std::memory_order_release);
+
+  if (used + 1 > g_rx_peak.load(std::memory_order_relaxed)) {
+    g_rx_peak.store(used + 1, std::memory_order_relaxed);
+  }
 }
 
 // ════════════════════════════════════════════════════════════════════════════
@@ -171,13 +376,8 @@ static void espnow_recv_cb(const esp_now_recv_info_t* info, const uint8_t* data,
 // ════════════════════════════════════════════════════════════════════════════
 
 static void sha256_domain(const char* domain, const uint8_t* data, size_t len, uint8_t* out) {
-  mbedtls_sha256_context ctx;
-  mbedtls_sha256_init(&ctx);
-  mbedtls_sha256_starts(&ctx, 0);
-  mbedtls_sha256_update(&ctx, (const uint8_t*)domain, strlen(domain));
-  mbedtls_sha256_update(&ctx, data, len);
-  mbedtls_sha256_finish(&ctx, out);
-  mbedtls_sha256_free(&ctx);
+  // Mesh hashes have no 0x00 separator; kept for wire compatibility
+  domain_hash::hash(domain, data, len, out, false);
 }
 
 static void compute_fingerprint(const uint8_t* pubkey, uint8_t* fp_out) {
@@ -269,6 +469,51 @@ static bool verify_signature(const uint8_t* pubkey, const uint8_t* data, size_t
   return Ed25519::verify(sig, pubkey, hash, 32);
 }
 
+static bool key_peer_aead(OperaPeer* peer) {
+  // A live session re-keys its own slot; a new one takes a free slot
+  if (!peer->session_established) {
+    uint8_t slot = 0;
+    while (slot < MAX_SESSIONS && (g_aead_used & (1u << slot))) slot++;
+    if (slot == MAX_SESSIONS) return false;  // Stays on signatures
+    g_aead_used |= (1u << slot);
+    peer->aead_slot = slot;
+    peer->session_established = true;
+    mbedtls_gcm_init(&g_aead_ctx[slot]);
+  }
+
+  // Separate AEAD key, so the session key itself never keys AES
+  uint8_t aead_key[32];
+  const mbedtls_md_info_t* md = mbedtls_md_info_from_type(MBEDTLS_MD_SHA256);
+  int ret = mbedtls_hkdf(md, nullptr, 0,
+                         peer->session_key, SESSION_KEY_SIZE,
+                         (const uint8_t*)DOMAIN_SESSION_AEAD, strlen(DOMAIN_SESSION_AEAD),
+                         aead_key, sizeof(aead_key));
+  if (ret == 0) {
+    ret = mbedtls_gcm_setkey(&g_aead_ctx[peer->aead_slot], MBEDTLS_CIPHER_ID_AES, aead_key, 256);
+  }
+  memset(aead_key, 0, sizeof(aead_key));
+
+  if (ret != 0) {
+    release_peer_aead(peer);
+    return false;
+  }
+  return true;
+}
+
+static void release_peer_aead(OperaPeer* peer) {
+  if (!peer->session_established) return;
+  mbedtls_gcm_free(&g_aead_ctx[peer->aead_slot]);
+  g_aead_used &= ~(1u << peer->aead_slot);
+  peer->session_established = false;
+  peer->session_confirmed = false;
+}
+
+static bool uses_session_aead(MessageType type) {
+  // Routine, high-rate traffic; anything a peer may need to prove later stays signed
+  return type == MSG_HEARTBEAT || type == MSG_PEER_LIST ||
+         type == MSG_FRAGMENT || type == MSG_FRAGMENT_ACK;
+}
+
 // ════════════════════════════════════════════════════════════════════════════
 // PEER MANAGEMENT
 // ════════════════════════════════════════════════════════════════════════════
@@ -293,10 +538,31 @@ static OperaPeer* find_peer_by_mac(const uint8_t* mac) {
   return nullptr;
 }
 
-static OperaPeer* find_peer_by_fingerprint(const uint8_t* fp) {
+static size_t fp_bucket(const uint8_t* fp) {
+  // Fingerprints are hash output, so their leading bytes are already uniform
+  return (fp[0] | (fp[1] << 8)) & (FP_INDEX_SIZE - 1);
+}
+
+static void fp_index_insert(uint8_t peer_idx) {
+  size_t b = fp_bucket(g_peers[peer_idx].fingerprint);
+  while (g_fp_index[b] != FP_INDEX_NONE) {
+    b = (b + 1) & (FP_INDEX_SIZE - 1);
+  }
+  g_fp_index[b] = peer_idx;
+}
+
+static void rebuild_fp_index() {
+  memset(g_fp_index, FP_INDEX_NONE, sizeof(g_fp_index));
   for (uint8_t i = 0; i < g_peer_count; i++) {
-    if (memcmp(g_peers[i].fingerprint, fp, FINGERPRINT_SIZE) == 0) {
-      return &g_peers[i];
+    fp_index_insert(i);
+  }
+}
+
+static OperaPeer* find_peer_by_fingerprint(const uint8_t* fp) {
+  for (size_t b = fp_bucket(fp); g_fp_index[b] != FP_INDEX_NONE; b = (b + 1) & (FP_INDEX_SIZE - 1)) {
+    OperaPeer* peer = &g_peers[g_fp_index[b]];
+    if (memcmp(peer->fingerprint, fp, FINGERPRINT_SIZE) == 0) {
+      return peer;
     }
   }
   return nullptr;
@@ -318,8 +584,10 @@ static bool add_peer(const uint8_t* pubkey, const uint8_t* mac, const char* name
   peer->state = PEER_UNKNOWN;
   peer->msg_counter_tx = 0;
   peer->msg_counter_rx = 0;
+  peer->alert_counter_rx = 0;
   peer->last_seen_ms = 0;
   peer->session_established = false;
+  peer->session_confirmed = false;
 
   // Register with ESP-NOW
   esp_now_peer_info_t peer_info = {};
@@ -328,13 +596,14 @@ static bool add_peer(const uint8_t* pubkey, const uint8_t* mac, const char* name
   peer_info.encrypt = false;  // We use our own encryption
 
   if (esp_now_add_peer(&peer_info) != ESP_OK) {
-    // Peer might already exist, try to update
+    // Peer might already exist, try to update. If the ESP-NOW peer table
+    // (20 entries) is full, the member is still added and hears us
+    // through relay broadcasts.
     esp_now_del_peer(mac);
-    if (esp_now_add_peer(&peer_info) != ESP_OK) {
-      return false;
-    }
+    esp_now_add_peer(&peer_info);
   }
 
+  fp_index_insert(g_peer_count);
   g_peer_count++;
   return true;
 }
@@ -343,13 +612,12 @@ static bool add_peer(const uint8_t* pubkey, const uint8_t* mac, const char* name
 // MESSAGE SENDING
 // ════════════════════════════════════════════════════════════════════════════
 
-static bool send_raw_message(const uint8_t* mac, const uint8_t* data, size_t len) {
+static bool send_raw_message(const uint8_t* mac, const uint8_t* data, size_t len, uint8_t replace_key) {
   if (!g_espnow_initialized || len > MAX_MESSAGE_SIZE) {
     return false;
   }
 
-  esp_err_t result = esp_now_send(mac, data, len);
-  if (result == ESP_OK) {
+  if (radio_scheduler::send(radio_scheduler::SLOT_MESH, mac, data, len, replace_key)) {
     g_messages_sent++;
     return true;
   }
@@ -357,7 +625,8 @@ static bool send_raw_message(const uint8_t* mac, const uint8_t* data, size_t len
   return false;
 }
 
-static bool send_to_peer(OperaPeer* peer, MessageType type, const uint8_t* payload, size_t payload_len) {
+static bool send_to_peer(OperaPeer* peer, MessageType type, const uint8_t* payload, size_t payload_len,
+                         bool replaceable) {
   if (!peer || !g_opera_config.configured) {
     return false;
   }
@@ -366,16 +635,19 @@ static bool send_to_peer(OperaPeer* peer, MessageType type, const uint8_t* paylo
   uint8_t msg[MAX_MESSAGE_SIZE];
   size_t offset = 0;
 
+  bool sealed = peer->session_confirmed && uses_session_aead(type);
+  size_t auth_size = sealed ? NONCE_SIZE + SESSION_TAG_SIZE : SIGNATURE_SIZE;
+
   // Header
   msg[offset++] = PROTOCOL_VERSION;
-  msg[offset++] = (uint8_t)type;
+  msg[offset++] = (uint8_t)type | (sealed ? MSG_FLAG_SESSION_AEAD : 0);
   memcpy(msg + offset, g_opera_config.opera_id, OPERA_ID_SIZE);
   offset += OPERA_ID_SIZE;
   memcpy(msg + offset, g_device_fingerprint, FINGERPRINT_SIZE);
   offset += FINGERPRINT_SIZE;
 
   // Counter (8 bytes, little-endian)
-  uint64_t counter = peer->msg_counter_tx++;
+  uint64_t counter = is_relayable(type) ? g_alert_counter_tx : peer->msg_counter_tx++;
   for (int i = 0; i < 8; i++) {
     msg[offset++] = (counter >> (i * 8)) & 0xFF;
   }
@@ -386,25 +658,43 @@ static bool send_to_peer(OperaPeer* peer, MessageType type, const uint8_t* paylo
   offset += 4;
 
   // Payload
+  size_t header_len = offset;
   if (payload && payload_len > 0) {
-    if (offset + payload_len > MAX_MESSAGE_SIZE - SIGNATURE_SIZE) {
+    if (offset + payload_len > MAX_MESSAGE_SIZE - auth_size) {
       return false;
     }
     memcpy(msg + offset, payload, payload_len);
     offset += payload_len;
   }
 
-  // Sign the message (excluding signature space)
-  uint8_t signature[SIGNATURE_SIZE];
-  sign_message(g_device_privkey, msg, offset, signature);
-  memcpy(msg + offset, signature, SIGNATURE_SIZE);
-  offset += SIGNATURE_SIZE;
+  if (sealed) {
+    // Encrypt the payload in place in the frame; the header is AAD
+    uint8_t* nonce = msg + offset;
+    esp_fill_random(nonce, NONCE_SIZE);
+    if (mbedtls_gcm_crypt_and_tag(&g_aead_ctx[peer->aead_slot], MBEDTLS_GCM_ENCRYPT, offset - header_len,
+                                  nonce, NONCE_SIZE, msg, header_len,
+                                  msg + header_len, msg + header_len,
+                                  SESSION_TAG_SIZE, nonce + NONCE_SIZE) != 0) {
+      return false;
+    }
+  } else {
+    // Sign the message (excluding signature space)
+    uint8_t signature[SIGNATURE_SIZE];
+    sign_message(g_device_privkey, msg, offset, signature);
+    memcpy(msg + offset, signature, SIGNATURE_SIZE);
+  }
+  offset += auth_size;
 
+  // A newer heartbeat supersedes one still waiting for the channel; the
+  // skipped counter only looks like a lost frame to the peer. One carrying
+  // an anchor is never superseded: its heads are already out of the fold.
+  bool supersedes = replaceable && (type == MSG_HEARTBEAT || type == MSG_PEER_LIST);
   peer->last_tx_ms = millis();
-  return send_raw_message(peer->mac_addr, msg, offset);
+  return send_raw_message(peer->mac_addr, msg, offset, supersedes ? (uint8_t)type : 0);
 }
 
 static bool broadcast_message(MessageType type, const uint8_t* payload, size_t payload_len) {
+  if (is_relayable(type)) g_alert_counter_tx++;
   bool any_sent = false;
   for (uint8_t i = 0; i < g_peer_count; i++) {
     if (g_peers[i].state >= PEER_CONNECTED) {
@@ -420,9 +710,306 @@ static bool broadcast_message(MessageType type, const uint8_t* payload, size_t p
 // MESSAGE HANDLING
 // ════════════════════════════════════════════════════════════════════════════
 
-static void handle_received_message(const uint8_t* mac, const uint8_t* data, size_t len) {
-  // Minimum message size: header (2+16+8+8+4) + signature (64) = 102
-  if (len < 102) {
+static bool is_relayable(MessageType type) {
+  // Signed alerts only: they are meaningful to every member, not just a neighbour
+  return type == MSG_TAMPER_ALERT || type == MSG_POWER_ALERT || type == MSG_OFFLINE_IMMINENT;
+}
+
+static bool seen_alert(const uint8_t* origin_fp, MessageType type, const uint8_t* payload, size_t len) {
+  // The per-link counter differs on every path, so key on origin and content
+  uint8_t input[FINGERPRINT_SIZE + 1 + MAX_MESSAGE_SIZE];
+  memcpy(input, origin_fp, FINGERPRINT_SIZE);
+  input[FINGERPRINT_SIZE] = (uint8_t)type;
+  memcpy(input + FINGERPRINT_SIZE + 1, payload, len);
+  uint8_t hash[32];
+  sha256_domain(DOMAIN_DEDUP, input, FINGERPRINT_SIZE + 1 + len, hash);
+  uint32_t key;
+  memcpy(&key, hash, sizeof(key));
+
+  uint32_t now = millis();
+  for (size_t i = 0; i < DEDUP_CACHE_SIZE; i++) {
+    if (g_seen[i].seen_ms != 0 && g_seen[i].key == key &&
+        now - g_seen[i].seen_ms < MESSAGE_TTL_MS) {
+      g_duplicates++;
+      return true;
+    }
+  }
+
+  g_seen[g_seen_head].key = key;
+  g_seen[g_seen_head].seen_ms = now ? now : 1;
+  g_seen_head = (g_seen_head + 1) % DEDUP_CACHE_SIZE;
+  return false;
+}
+
+static void forward_relay(const uint8_t* frame, size_t len, uint8_t hops_left) {
+  if (len + 3 > MAX_MESSAGE_SIZE) return;
+
+  uint8_t msg[MAX_MESSAGE_SIZE];
+  msg[0] = PROTOCOL_VERSION;
+  msg[1] = MSG_RELAY;
+  msg[2] = hops_left;
+  memcpy(msg + 3, frame, len);
+
+  // One broadcast reaches every neighbour; duplicate suppression stops
+  // echoes. radio_scheduler registered the broadcast peer.
+  if (send_raw_message(BROADCAST_ADDR, msg, len + 3)) {
+    g_alerts_relayed++;
+  }
+}
+
+static void elect_relay() {
+  // Score: neighbours heard well enough to relay for
+  uint8_t score = 0;
+  for (uint8_t i = 0; i < g_peer_count; i++) {
+    const OperaPeer* peer = &g_peers[i];
+    int16_t rssi = peer->rssi_avg_x16 != 0 ? peer->rssi_avg_x16 / 16 : peer->rssi;
+    if ((peer->state == PEER_CONNECTED || peer->state == PEER_ALERT) && rssi >= RELAY_MIN_RSSI) {
+      score++;
+    }
+  }
+  g_relay_score = score;
+
+  // Relay if fewer than RELAY_SLOTS neighbours advertise a better score
+  // (fingerprint breaks ties, so both sides of a tie agree)
+  uint8_t better = 0;
+  for (uint8_t i = 0; i < g_peer_count; i++) {
+    const OperaPeer* peer = &g_peers[i];
+    if (peer->state != PEER_CONNECTED && peer->state != PEER_ALERT) continue;
+    if (peer->relay_score > score ||
+        (peer->relay_score == score &&
+         memcmp(peer->fingerprint, g_device_fingerprint, FINGERPRINT_SIZE) < 0)) {
+      better++;
+    }
+  }
+  g_is_relay = score >= 2 && better < RELAY_SLOTS;
+}
+
+// ────────────────────────────────────────────────────────────────────────────
+// Chain-head anchoring
+// ────────────────────────────────────────────────────────────────────────────
+
+static void anchor_node(const uint8_t* left, const uint8_t* right, uint8_t* out) {
+  uint8_t pair[64];
+  memcpy(pair, left, 32);
+  memcpy(pair + 32, right, 32);
+  sha256_domain(DOMAIN_ANCHOR_NODE, pair, sizeof(pair), out);
+}
+
+// Send the open anchor now, before a new one replaces it. It is lost (and
+// counted) only if no peer takes it.
+static void close_anchor() {
+  if (g_mesh_state == MESH_ACTIVE) send_heartbeats(true);
+  if (g_anchor_count > 0) {
+    g_anchors_dropped++;
+    g_anchor_count = 0;
+  }
+}
+
+// Add one head to the anchor, merging equal-sized subtrees like a binary
+// counter carries. An anchor always covers consecutive seqs: a skipped seq,
+// or one too many heads for ANCHOR_MAX_HEIGHT, closes it and starts a new one.
+static void fold_anchor_head(uint32_t seq, const uint8_t* chain_hash) {
+  if (g_anchor_count > 0 &&
+      (seq != g_anchor_last_seq + 1 || g_anchor_count == (1u << ANCHOR_MAX_HEIGHT))) {
+    close_anchor();
+  }
+
+  uint8_t leaf[4 + 32];
+  for (int i = 0; i < 4; i++) {
+    leaf[i] = (seq >> (i * 8)) & 0xFF;
+  }
+  memcpy(leaf + 4, chain_hash, 32);
+  uint8_t node[32];
+  sha256_domain(DOMAIN_ANCHOR_LEAF, leaf, sizeof(leaf), node);
+
+  uint8_t h = 0;
+  while (g_anchor_count & (1u << h)) {
+    anchor_node(g_anchor_peaks[h], node, node);
+    h++;
+  }
+  memcpy(g_anchor_peaks[h], node, 32);
+
+  if (g_anchor_count == 0) g_anchor_first_seq = seq;
+  g_anchor_last_seq = seq;
+  g_anchor_count++;
+}
+
+static void fold_chain_heads() {
+  uint32_t tail = g_head_tail.load(std::memory_order_relaxed);
+  uint32_t head = g_head_head.load(std::memory_order_acquire);
+  for (; tail != head; tail++) {
+    const PendingHead& slot = g_head_slots[tail & (ANCHOR_PENDING_SLOTS - 1)];
+    fold_anchor_head(slot.seq, slot.chain_hash);
+    g_head_tail.store(tail + 1, std::memory_order_release);
+  }
+}
+
+// Root over the folded heads: subtree roots combined from the smallest
+// (newest) up, each larger one on the left
+static void anchor_root(uint8_t* out) {
+  uint8_t acc[32];
+  bool have = false;
+  for (uint8_t h = 0; h <= ANCHOR_MAX_HEIGHT; h++) {
+    if (!(g_anchor_count & (1u << h))) continue;
+    if (have) {
+      anchor_node(g_anchor_peaks[h], acc, acc);
+    } else {
+      memcpy(acc, g_anchor_peaks[h], 32);
+      have = true;
+    }
+  }
+  memcpy(out, acc, ANCHOR_ROOT_SIZE);
+}
+
+// Keep a receipt of a peer's anchor. Its chain only moves forward, so an
+// anchor going back over seqs it already anchored means the history it
+// showed us was rewritten or reset.
+static void handle_anchor(OperaPeer* peer, const uint8_t* data, size_t len) {
+  if (!peer || len < sizeof(AnchorPayload)) return;  // Older firmware sends none
+
+  AnchorPayload anchor;
+  memcpy(&anchor, data, sizeof(anchor));
+  if (anchor.leaf_count == 0 || anchor.last_seq < anchor.first_seq ||
+      anchor.last_seq - anchor.first_seq + 1 != anchor.leaf_count) {
+    return;
+  }
+
+  AnchorReceipt& r = g_receipts[g_receipt_head];
+  memcpy(r.peer_fp, peer->fingerprint, FINGERPRINT_SIZE);
+  r.received_ms = millis();
+  r.first_seq = anchor.first_seq;
+  r.last_seq = anchor.last_seq;
+  r.leaf_count = anchor.leaf_count;
+  memcpy(r.root, anchor.root, ANCHOR_ROOT_SIZE);
+  r.conflict = peer->anchor_seq != 0 && anchor.first_seq <= peer->anchor_seq;
+  g_receipt_head = (g_receipt_head + 1) % MAX_ANCHOR_RECEIPTS;
+  if (g_receipt_count < MAX_ANCHOR_RECEIPTS) {
+    g_receipt_count++;
+  }
+
+  if (r.conflict) {
+    peer->anchor_conflicts++;
+    g_anchor_conflicts++;
+  } else if (peer->anchor_seq != 0 && anchor.first_seq != peer->anchor_seq + 1) {
+    g_anchor_gaps++;
+  }
+  peer->anchor_seq = anchor.last_seq;
+  peer->anchors++;
+  g_anchors_received++;
+
+  if (g_anchor_callback) g_anchor_callback(&r);
+}
+
+static uint32_t heartbeat_interval_ms(uint32_t now) {
+  if (g_last_alert_ms != 0 && now - g_last_alert_ms < ALERT_ACTIVE_MS) {
+    return HEARTBEAT_FAST_MS;
+  }
+
+  // Slow down once nobody is in a transitional state
+  bool any_connected = false;
+  for (uint8_t i = 0; i < g_peer_count; i++) {
+    if (g_peers[i].state == PEER_STALE || g_peers[i].state == PEER_ALERT) {
+      return HEARTBEAT_INTERVAL_MS;
+    }
+    if (g_peers[i].state == PEER_CONNECTED) any_connected = true;
+  }
+  return any_connected ? HEARTBEAT_SLOW_MS : HEARTBEAT_INTERVAL_MS;
+}
+
+static uint32_t peer_heartbeat_ms(const OperaPeer* peer) {
+  return peer->heartbeat_s ? peer->heartbeat_s * 1000u : HEARTBEAT_INTERVAL_MS;
+}
+
+static void send_heartbeats(bool force) {
+  if (!g_opera_config.configured) return;
+
+  uint32_t now = millis();
+  uint32_t interval = heartbeat_interval_ms(now);
+  bool interval_changed = interval != g_heartbeat_interval_ms;
+
+  // Relays send MSG_PEER_LIST: their heartbeat plus the peers they hear
+  PeerListPayload list;
+  HeartbeatPayload& payload = list.heartbeat;
+  memset(&list, 0, sizeof(list));
+  payload.status = 0;  // Online
+  payload.uptime_sec = (now - g_start_time_ms) / 1000;
+  payload.peer_count = g_peer_count;
+  payload.battery_pct = 255;  // Unknown
+  payload.relay_score = g_relay_score;
+  payload.interval_s = interval / 1000;
+  payload.sent_ms = now | 1;
+
+  if (g_is_relay) {
+    for (uint8_t i = 0; i < g_peer_count && list.count < MAX_LIVENESS_ENTRIES; i++) {
+      const OperaPeer* peer = &g_peers[i];
+      if (peer->state != PEER_CONNECTED && peer->state != PEER_ALERT) continue;
+      uint32_t age_ms = now - peer->last_seen_ms;
+      if (peer->last_seen_ms == 0 || age_ms > peer_heartbeat_ms(peer) * HEARTBEAT_STALE_FACTOR) continue;
+      memcpy(list.entries[list.count].fingerprint, peer->fingerprint, FINGERPRINT_SIZE);
+      list.entries[list.count].age_s = age_ms / 1000 > 255 ? 255 : age_ms / 1000;
+      list.count++;
+    }
+  }
+  size_t list_len = offsetof(PeerListPayload, entries) + list.count * sizeof(LivenessEntry);
+
+  // Our chain heads since the last anchor go along, when the frame has room
+  AnchorPayload anchor;
+  memset(&anchor, 0, sizeof(anchor));
+  bool anchored = g_anchor_count > 0 &&
+                  (!g_is_relay || list_len + sizeof(anchor) <= MAX_MESSAGE_SIZE - 38 - SIGNATURE_SIZE);
+  if (anchored) {
+    anchor.first_seq = g_anchor_first_seq;
+    anchor.last_seq = g_anchor_last_seq;
+    anchor.leaf_count = g_anchor_count;
+    anchor_root(anchor.root);
+  }
+  uint8_t frame[sizeof(PeerListPayload) + sizeof(AnchorPayload)];
+  bool anchor_sent = false;
+
+  for (uint8_t i = 0; i < g_peer_count; i++) {
+    OperaPeer* peer = &g_peers[i];
+    if (peer->state < PEER_CONNECTED) continue;
+
+    // Any authenticated frame already told this peer we are alive. A new
+    // interval has to be announced, though, or the peer misjudges the gap.
+    if (!force && !interval_changed && now - peer->last_tx_ms < interval / 2) {
+      g_heartbeats_skipped++;
+      continue;
+    }
+
+    // Echo the peer's last heartbeat so it can time the round trip
+    uint32_t held_ms = now - peer->echo_rx_ms;
+    bool echo = peer->echo_ts != 0 && held_ms <= UINT16_MAX;
+    payload.echo_ms = echo ? peer->echo_ts : 0;
+    payload.echo_delay_ms = echo ? held_ms : 0;
+
+    size_t len = g_is_relay ? list_len : sizeof(payload);
+    memcpy(frame, g_is_relay ? (const void*)&list : (const void*)&payload, len);
+    if (anchored) {
+      memcpy(frame + len, &anchor, sizeof(anchor));
+      len += sizeof(anchor);
+    }
+    if (send_to_peer(peer, g_is_relay ? MSG_PEER_LIST : MSG_HEARTBEAT, frame, len, !anchored)) {
+      anchor_sent = anchored;
+    }
+  }
+
+  // A peer skipped this round sees a gap in our seqs; the heads keep
+  // accumulating only if nobody got them
+  if (anchor_sent) {
+    g_anchors_sent++;
+    g_anchor_sent_seq = g_anchor_last_seq;
+    g_anchor_count = 0;
+  }
+
+  g_heartbeat_interval_ms = interval;
+  g_last_heartbeat_ms = now;
+}
+
+static void handle_received_message(const uint8_t* mac, const uint8_t* data, size_t len, int relay_hops) {
+  // Minimum message size: header (2+16+8+8+4) + nonce (12) + tag (16) = 66;
+  // signed messages need header + signature (64) = 102
+  if (len < 66) {
     return;
   }
 
@@ -434,7 +1021,25 @@ static void handle_received_message(const uint8_t* mac, const uint8_t* data, siz
     return;  // Incompatible version
   }
 
-  MessageType msg_type = (MessageType)data[offset++];
+  uint8_t type_byte = data[offset++];
+  bool sealed = (type_byte & MSG_FLAG_SESSION_AEAD) != 0;
+  MessageType msg_type = (MessageType)(type_byte & ~MSG_FLAG_SESSION_AEAD);
+  size_t auth_size = sealed ? NONCE_SIZE + SESSION_TAG_SIZE : SIGNATURE_SIZE;
+  if (msg_type == MSG_RELAY) {
+    // Unwrap once; the inner message must be a signed alert
+    if (relay_hops >= 0 || len < 3 || data[2] > RELAY_MAX_HOPS - 2) {
+      return;
+    }
+    handle_received_message(mac, data + 3, len - 3, data[2]);
+    return;
+  }
+  bool relayed = relay_hops >= 0;
+  if (relayed && (sealed || !is_relayable(msg_type))) {
+    return;
+  }
+  if (len < 38 + auth_size) {
+    return;
+  }
 
   const uint8_t* opera_id = data + offset;
   offset += OPERA_ID_SIZE;
@@ -452,11 +1057,14 @@ static void handle_received_message(const uint8_t* mac, const uint8_t* data, siz
   offset += 4;
 
   const uint8_t* payload = data + offset;
-  size_t payload_len = len - offset - SIGNATURE_SIZE;
-  const uint8_t* signature = data + len - SIGNATURE_SIZE;
+  size_t payload_len = len - offset - auth_size;
+  const uint8_t* signature = data + len - auth_size;
 
   // Pairing messages don't require opera membership
   if (msg_type >= MSG_PAIR_DISCOVER && msg_type <= MSG_PAIR_COMPLETE) {
+    if (sealed) {
+      return;  // Pairing is always signed
+    }
     switch (msg_type) {
       case MSG_PAIR_DISCOVER:
         handle_pair_discover(mac, payload);
@@ -496,8 +1104,9 @@ static void handle_received_message(const uint8_t* mac, const uint8_t* data, siz
     return;
   }
 
-  // Update MAC address if changed (device might have reconnected)
-  if (memcmp(peer->mac_addr, mac, 6) != 0) {
+  // Update MAC address if changed (device might have reconnected); a
+  // relayed message arrives from the relay's address, not the origin's
+  if (!relayed && memcmp(peer->mac_addr, mac, 6) != 0) {
     memcpy(peer->mac_addr, mac, 6);
 
     // Re-register with ESP-NOW
@@ -509,17 +1118,39 @@ static void handle_received_message(const uint8_t* mac, const uint8_t* data, siz
     esp_now_add_peer(&peer_info);
   }
 
-  // Verify signature
-  if (!verify_signature(peer->pubkey, data, len - SIGNATURE_SIZE, signature)) {
+  // Decrypt and authenticate, or verify signature
+  uint8_t plaintext[MAX_MESSAGE_SIZE];
+  if (sealed) {
+    const uint8_t* nonce = signature;
+    if (!peer->session_established || !uses_session_aead(msg_type) ||
+        mbedtls_gcm_auth_decrypt(&g_aead_ctx[peer->aead_slot], payload_len,
+                                 nonce, NONCE_SIZE, data, offset,
+                                 nonce + NONCE_SIZE, SESSION_TAG_SIZE,
+                                 payload, plaintext) != 0) {
+      g_auth_failures++;
+      return;
+    }
+    payload = plaintext;
+    peer->session_confirmed = true;  // Only a holder of the key could have sent it
+  } else if (!verify_signature(peer->pubkey, data, len - auth_size, signature)) {
     g_auth_failures++;
     return;
   }
 
-  // Check for replay (counter must be greater than last seen)
-  if (counter <= peer->msg_counter_rx && peer->msg_counter_rx > 0) {
-    return;  // Replay attack
+  // Check for replay (counter must be greater than last seen). Alerts
+  // count on the origin's alert counter, whichever path they arrive by;
+  // copies of one alert share a value, and duplicate suppression drops them.
+  if (is_relayable(msg_type)) {
+    if (counter < peer->alert_counter_rx) {
+      return;  // Replay attack
+    }
+    peer->alert_counter_rx = counter;
+  } else {
+    if (counter <= peer->msg_counter_rx && peer->msg_counter_rx > 0) {
+      return;  // Replay attack
+    }
+    peer->msg_counter_rx = counter;
   }
-  peer->msg_counter_rx = counter;
 
   // Check timestamp (within 5 minutes)
   uint32_t now_sec = millis() / 1000;
@@ -527,20 +1158,47 @@ static void handle_received_message(const uint8_t* mac, const uint8_t* data, siz
     return;  // Message too old or from future
   }
 
-  // Update peer state
-  peer->last_seen_ms = millis();
-  peer->rssi = g_rx_rssi;  // Actual RSSI from ESP-NOW callback
+  // Update peer state (link quality only from frames the peer sent us)
+  if (!relayed) {
+    peer->last_seen_ms = millis();
+    peer->rssi = g_rx_rssi;  // Actual RSSI from ESP-NOW callback
+    update_link_rssi(peer, g_rx_rssi);
 
-  if (peer->state == PEER_STALE || peer->state == PEER_OFFLINE || peer->state == PEER_UNKNOWN) {
-    update_peer_state(peer, PEER_CONNECTED);
+    if (peer->state == PEER_STALE || peer->state == PEER_OFFLINE || peer->state == PEER_UNKNOWN) {
+      update_peer_state(peer, PEER_CONNECTED);
+    }
   }
 
   g_messages_received++;
 
+  // An alert can arrive directly and via any number of relays: handle it once
+  if (is_relayable(msg_type)) {
+    if (seen_alert(sender_fp, msg_type, payload, payload_len)) {
+      return;
+    }
+    g_last_alert_ms = millis() | 1;
+    if (g_is_relay && (!relayed || relay_hops > 0)) {
+      forward_relay(data, len, relayed ? relay_hops - 1 : RELAY_MAX_HOPS - 2);
+    }
+  }
+
   // Handle by message type
   switch (msg_type) {
     case MSG_HEARTBEAT:
-      handle_heartbeat(peer, payload);
+      handle_heartbeat(peer, payload, payload_len);
+      if (payload_len > sizeof(HeartbeatPayload)) {
+        handle_anchor(peer, payload + sizeof(HeartbeatPayload), payload_len - sizeof(HeartbeatPayload));
+      }
+      break;
+    case MSG_PEER_LIST:
+      handle_heartbeat(peer, payload, payload_len);
+      handle_peer_list(peer, payload, payload_len);
+      break;
+    case MSG_FRAGMENT:
+      handle_fragment(peer, payload, payload_len);
+      break;
+    case MSG_FRAGMENT_ACK:
+      handle_fragment_ack(peer, payload, payload_len);
       break;
     case MSG_AUTH_CHALLENGE:
       handle_auth_challenge(mac, payload);
@@ -548,6 +1206,10 @@ static void handle_received_message(const uint8_t* mac, const uint8_t* data, siz
     case MSG_AUTH_RESPONSE:
       handle_auth_response(peer, payload);
       break;
+    case MSG_AUTH_COMPLETE:
+      // Initiator derived the key on our response; switch to session MACs
+      peer->session_confirmed = peer->session_established;
+      break;
     case MSG_TAMPER_ALERT:
       handle_tamper_alert(peer, payload);
       break;
@@ -562,10 +1224,63 @@ static void handle_received_message(const uint8_t* mac, const uint8_t* data, siz
   }
 }
 
-static void handle_heartbeat(OperaPeer* peer, const uint8_t* payload) {
+static void update_link_rssi(OperaPeer* peer, int8_t rssi) {
+  // EWMA with alpha 1/8 in 1/16 dBm, seeded by the first sample
+  int16_t sample = rssi * 16;
+  if (peer->rssi_avg_x16 == 0) {
+    peer->rssi_avg_x16 = sample;
+  } else {
+    peer->rssi_avg_x16 += (sample - peer->rssi_avg_x16) / 8;
+  }
+}
+
+static void drain_tx_status() {
+  uint32_t tail = g_tx_status_tail.load(std::memory_order_relaxed);
+  uint32_t head = g_tx_status_head.load(std::memory_order_acquire);
+  for (; tail != head; tail++) {
+    const TxStatusSlot& slot = g_tx_status[tail & (TX_STATUS_SLOTS - 1)];
+    if (slot.delivered) {
+      g_tx_acked++;
+    } else {
+      g_tx_failed++;
+    }
+    OperaPeer* peer = find_peer_by_mac(slot.mac);
+    if (peer) {
+      if (slot.delivered) {
+        peer->tx_acked++;
+      } else {
+        peer->tx_failed++;
+      }
+    }
+    g_tx_status_tail.store(tail + 1, std::memory_order_release);
+  }
+}
+
+static void handle_heartbeat(OperaPeer* peer, const uint8_t* payload, size_t len) {
   if (!peer) return;
 
   const HeartbeatPayload* hb = (const HeartbeatPayload*)payload;
+  peer->relay_score = hb->relay_score;
+
+  // Echo: keep the peer's send time for our next heartbeat, and time the
+  // round trip of ours (minus however long the peer held it)
+  if (len >= sizeof(HeartbeatPayload)) {
+    uint32_t now = millis();
+    peer->echo_ts = hb->sent_ms;
+    peer->echo_rx_ms = now;
+    if (hb->echo_ms != 0) {
+      uint32_t rtt = now - hb->echo_ms - hb->echo_delay_ms;
+      if (rtt < 10000) {
+        peer->rtt_ms = peer->rtt_ms == 0 ? rtt : peer->rtt_ms + ((int32_t)rtt - peer->rtt_ms) / 8;
+        if (peer->rtt_ms == 0) peer->rtt_ms = 1;
+      }
+    }
+  }
+
+  // Older firmware leaves interval_s unset; out-of-range means the default
+  uint8_t interval_s = hb->interval_s;
+  bool valid = interval_s >= HEARTBEAT_FAST_MS / 1000 && interval_s <= HEARTBEAT_SLOW_MS / 1000;
+  peer->heartbeat_s = valid ? interval_s : 0;
 
   // Peer is alive
   if (peer->state != PEER_CONNECTED && peer->state != PEER_ALERT) {
@@ -573,6 +1288,37 @@ static void handle_heartbeat(OperaPeer* peer, const uint8_t* payload) {
   }
 }
 
+static void handle_peer_list(OperaPeer* peer, const uint8_t* payload, size_t len) {
+  if (!peer || len < offsetof(PeerListPayload, entries)) return;
+
+  const PeerListPayload* list = (const PeerListPayload*)payload;
+  size_t count = list->count;
+  if (count > MAX_LIVENESS_ENTRIES ||
+      offsetof(PeerListPayload, entries) + count * sizeof(LivenessEntry) > len) {
+    return;
+  }
+
+  uint32_t now = millis();
+  for (size_t i = 0; i < count; i++) {
+    OperaPeer* attested = find_peer_by_fingerprint(list->entries[i].fingerprint);
+    if (!attested || attested == peer) continue;
+
+    uint32_t heard_ms = now - list->entries[i].age_s * 1000u;
+    if (attested->last_attested_ms == 0 || (int32_t)(heard_ms - attested->last_attested_ms) > 0) {
+      attested->last_attested_ms = heard_ms | 1;
+    }
+    if (attested->state == PEER_STALE || attested->state == PEER_OFFLINE ||
+        attested->state == PEER_UNKNOWN) {
+      if (now - attested->last_attested_ms < peer_heartbeat_ms(attested) * HEARTBEAT_STALE_FACTOR) {
+        update_peer_state(attested, PEER_CONNECTED);
+      }
+    }
+  }
+
+  size_t used = offsetof(PeerListPayload, entries) + count * sizeof(LivenessEntry);
+  handle_anchor(peer, payload + used, len - used);
+}
+
 static void handle_auth_challenge(const uint8_t* mac, const uint8_t* payload) {
   // Someone is trying to authenticate with us
   const AuthChallengePayload* challenge = (const AuthChallengePayload*)payload;
@@ -609,9 +1355,11 @@ static void handle_auth_challenge(const uint8_t* mac, const uint8_t* payload) {
   sha256_domain(DOMAIN_AUTH, g_opera_config.opera_id, OPERA_ID_SIZE, hash);
   Ed25519::sign(response.opera_proof, g_device_privkey, g_device_pubkey, hash, 32);
 
-  // Derive session key
-  derive_session_key(g_device_privkey, peer->pubkey, peer->session_key);
-  peer->session_established = true;
+  // Derive session key; session encryption waits for the initiator's MSG_AUTH_COMPLETE
+  if (!derive_session_key(g_device_privkey, peer->pubkey, peer->session_key) || !key_peer_aead(peer)) {
+    release_peer_aead(peer);
+  }
+  peer->session_confirmed = false;
 
   update_peer_state(peer, PEER_AUTHENTICATING);
   send_to_peer(peer, MSG_AUTH_RESPONSE, (uint8_t*)&response, sizeof(response));
@@ -636,9 +1384,11 @@ static void handle_auth_response(OperaPeer* peer, const uint8_t* payload) {
     return;
   }
 
-  // Derive session key
-  derive_session_key(g_device_privkey, peer->pubkey, peer->session_key);
-  peer->session_established = true;
+  // Derive session key; the responder derived it before answering
+  if (!derive_session_key(g_device_privkey, peer->pubkey, peer->session_key) || !key_peer_aead(peer)) {
+    release_peer_aead(peer);
+  }
+  peer->session_confirmed = peer->session_established;
 
   update_peer_state(peer, PEER_CONNECTED);
 
@@ -733,6 +1483,194 @@ static void handle_offline_imminent(OperaPeer* peer, const uint8_t* payload) {
   }
 }
 
+// ════════════════════════════════════════════════════════════════════════════
+// FRAGMENTATION
+// ════════════════════════════════════════════════════════════════════════════
+
+static uint32_t fragment_mask(uint8_t count) {
+  return count >= 32 ? 0xFFFFFFFFu : (1u << count) - 1;
+}
+
+static void send_fragment_ack(OperaPeer* peer, uint16_t id, uint32_t received, uint8_t credit) {
+  FragmentAckPayload ack = {};
+  ack.transfer_id = id;
+  ack.credit = credit;
+  ack.received = received;
+  send_to_peer(peer, MSG_FRAGMENT_ACK, (uint8_t*)&ack, sizeof(ack));
+}
+
+static void handle_fragment(OperaPeer* peer, const uint8_t* payload, size_t len) {
+  if (!peer || len < sizeof(FragmentHeader)) return;
+
+  FragmentHeader hdr;
+  memcpy(&hdr, payload, sizeof(hdr));
+  if (hdr.count == 0 || hdr.count > MAX_FRAGMENTS || hdr.index >= hdr.count ||
+      hdr.frag_size == 0 || hdr.total_len > MAX_BULK_SIZE ||
+      hdr.total_len > hdr.count * hdr.frag_size ||
+      hdr.total_len <= (hdr.count - 1) * hdr.frag_size) {
+    return;
+  }
+  size_t offset = hdr.index * hdr.frag_size;
+  size_t expected = hdr.total_len - offset < hdr.frag_size ? hdr.total_len - offset : hdr.frag_size;
+  if (len - sizeof(hdr) != expected) return;
+
+  uint32_t now = millis();
+  RxTransfer* rx = nullptr;
+  RxTransfer* spare = nullptr;
+  for (size_t i = 0; i < BULK_RX_SLOTS; i++) {
+    RxTransfer* slot = &g_bulk_rx[i];
+    if (slot->active && slot->id == hdr.transfer_id &&
+        memcmp(slot->peer_fp, peer->fingerprint, FINGERPRINT_SIZE) == 0) {
+      rx = slot;
+      break;
+    }
+    // Free, delivered or stalled slots can be taken; a stalled one would
+    // otherwise block new transfers until pump_bulk_transfers() sweeps it
+    if (!spare && (!slot->active || slot->complete ||
+                   now - slot->last_ms > REASSEMBLY_TIMEOUT_MS)) {
+      spare = slot;
+    }
+  }
+
+  if (!rx) {
+    if (!spare) {
+      send_fragment_ack(peer, hdr.transfer_id, 0, 0);  // No buffer: back off
+      return;
+    }
+    if (spare->active && !spare->complete) g_bulk_failed++;
+    rx = spare;
+    memset(rx, 0, offsetof(RxTransfer, data));
+    rx->active = true;
+    memcpy(rx->peer_fp, peer->fingerprint, FINGERPRINT_SIZE);
+    rx->id = hdr.transfer_id;
+    rx->len = hdr.total_len;
+    rx->count = hdr.count;
+    rx->frag_size = hdr.frag_size;
+    rx->bulk_type = hdr.bulk_type;
+  } else if (rx->len != hdr.total_len || rx->count != hdr.count || rx->frag_size != hdr.frag_size) {
+    return;  // Not the transfer this id started
+  }
+
+  uint32_t bit = 1u << hdr.index;
+  bool duplicate = (rx->received & bit) != 0;
+  if (!duplicate) {
+    memcpy(rx->data + offset, payload + sizeof(hdr), expected);
+    rx->received |= bit;
+  }
+  rx->last_ms = now;
+
+  bool done = rx->received == fragment_mask(rx->count);
+  if (done && !rx->complete) {
+    rx->complete = true;
+    g_bulk_received++;
+    if (g_bulk_callback) {
+      g_bulk_callback(peer, (BulkType)rx->bulk_type, rx->data, rx->len);
+    }
+  }
+
+  // A duplicate means our last ack was lost: answer it at once
+  if (done || duplicate || (hdr.index + 1) % FRAGMENT_ACK_EVERY == 0) {
+    send_fragment_ack(peer, rx->id, rx->received, FRAGMENT_WINDOW);
+  }
+}
+
+static void handle_fragment_ack(OperaPeer* peer, const uint8_t* payload, size_t len) {
+  if (!peer || len < sizeof(FragmentAckPayload)) return;
+
+  FragmentAckPayload ack;
+  memcpy(&ack, payload, sizeof(ack));
+
+  for (size_t i = 0; i < BULK_TX_SLOTS; i++) {
+    TxTransfer* tx = &g_bulk_tx[i];
+    if (!tx->active || tx->id != ack.transfer_id ||
+        memcmp(tx->peer_fp, peer->fingerprint, FINGERPRINT_SIZE) != 0) {
+      continue;
+    }
+
+    uint32_t now = millis();
+    tx->acked |= ack.received & fragment_mask(tx->count);
+    if (tx->acked == fragment_mask(tx->count)) {
+      tx->active = false;
+      g_bulk_sent++;
+      return;
+    }
+
+    if (ack.credit == 0) {
+      // Receiver is out of buffers: resend from scratch after a pause
+      if (++tx->busy_count > FRAGMENT_MAX_TRIES) {
+        tx->active = false;
+        g_bulk_failed++;
+        return;
+      }
+      tx->stall_until_ms = now + FRAGMENT_BUSY_BACKOFF_MS;
+      memset(tx->sent_ms, 0, sizeof(tx->sent_ms));
+      memset(tx->tries, 0, sizeof(tx->tries));
+    }
+    tx->window = ack.credit > FRAGMENT_WINDOW ? FRAGMENT_WINDOW : ack.credit;
+    if (tx->window == 0) tx->window = 1;
+    return;
+  }
+}
+
+static bool pump_transfer(TxTransfer* tx, uint32_t now) {
+  OperaPeer* peer = find_peer_by_fingerprint(tx->peer_fp);
+  if (!peer) return false;
+  if ((int32_t)(now - tx->stall_until_ms) < 0) return true;
+
+  uint8_t frame[sizeof(FragmentHeader) + FRAGMENT_DATA_SEALED];
+  uint8_t in_flight = 0;
+  for (uint8_t i = 0; i < tx->count; i++) {
+    if (tx->acked & (1u << i)) continue;
+    if (tx->sent_ms[i] != 0 && now - tx->sent_ms[i] < FRAGMENT_RTO_MS) {
+      in_flight++;
+      continue;
+    }
+    if (in_flight >= tx->window) break;
+
+    if (tx->sent_ms[i] != 0) {
+      if (tx->tries[i] >= FRAGMENT_MAX_TRIES) return false;
+      g_fragments_retransmitted++;
+      if (peer->retransmits < UINT16_MAX) peer->retransmits++;
+    }
+
+    FragmentHeader hdr;
+    hdr.transfer_id = tx->id;
+    hdr.total_len = tx->len;
+    hdr.index = i;
+    hdr.count = tx->count;
+    hdr.frag_size = tx->frag_size;
+    hdr.bulk_type = tx->bulk_type;
+
+    size_t offset = i * tx->frag_size;
+    size_t n = tx->len - offset < tx->frag_size ? tx->len - offset : tx->frag_size;
+    memcpy(frame, &hdr, sizeof(hdr));
+    memcpy(frame + sizeof(hdr), tx->data + offset, n);
+    send_to_peer(peer, MSG_FRAGMENT, frame, sizeof(hdr) + n);
+
+    tx->sent_ms[i] = now | 1;
+    tx->tries[i]++;
+    in_flight++;
+  }
+  return true;
+}
+
+static void pump_bulk_transfers(uint32_t now) {
+  for (size_t i = 0; i < BULK_TX_SLOTS; i++) {
+    if (g_bulk_tx[i].active && !pump_transfer(&g_bulk_tx[i], now)) {
+      g_bulk_tx[i].active = false;
+      g_bulk_failed++;
+    }
+  }
+
+  for (size_t i = 0; i < BULK_RX_SLOTS; i++) {
+    RxTransfer* rx = &g_bulk_rx[i];
+    if (rx->active && now - rx->last_ms > REASSEMBLY_TIMEOUT_MS) {
+      if (!rx->complete) g_bulk_failed++;
+      rx->active = false;
+    }
+  }
+}
+
 // ════════════════════════════════════════════════════════════════════════════
 // PAIRING HANDLERS
 // ════════════════════════════════════════════════════════════════════════════
@@ -931,13 +1869,11 @@ static void handle_pair_complete(const uint8_t* mac, const uint8_t* payload) {
 // ════════════════════════════════════════════════════════════════════════════
 
 static bool persist_opera_config() {
-  g_prefs.begin(NVS_NS, false);
-  g_prefs.putBool(NVS_ENABLED, g_opera_config.enabled);
-  g_prefs.putBytes(NVS_FLOCK_ID, g_opera_config.opera_id, OPERA_ID_SIZE);
-  g_prefs.putBytes(NVS_FLOCK_SECRET, g_opera_config.opera_secret, OPERA_SECRET_SIZE);
-  g_prefs.putString(NVS_FLOCK_NAME, g_opera_config.opera_name);
-  g_prefs.end();
-  return true;
+  g_nvs_tx.putBytes(NVS_FLOCK_ID, g_opera_config.opera_id, OPERA_ID_SIZE);
+  g_nvs_tx.putBytes(NVS_FLOCK_SECRET, g_opera_config.opera_secret, OPERA_SECRET_SIZE);
+  g_nvs_tx.putString(NVS_FLOCK_NAME, g_opera_config.opera_name);
+  g_nvs_tx.putBool(NVS_ENABLED, g_opera_config.enabled);
+  return g_nvs_tx.commit();
 }
 
 static bool load_opera_config() {
@@ -959,9 +1895,7 @@ static bool load_opera_config() {
 }
 
 static bool persist_peers() {
-  g_prefs.begin(NVS_NS, false);
-  g_prefs.putUChar(NVS_PEER_COUNT, g_peer_count);
-
+  // Unchanged peers are skipped, so re-saving after a state change is cheap
   for (uint8_t i = 0; i < g_peer_count; i++) {
     char key[16];
     snprintf(key, sizeof(key), "%s%d", NVS_PEER_PREFIX, i);
@@ -972,11 +1906,12 @@ static bool persist_peers() {
     memcpy(peer_data + PUBKEY_SIZE, g_peers[i].mac_addr, 6);
     memcpy(peer_data + PUBKEY_SIZE + 6, g_peers[i].name, MAX_PEER_NAME_LEN);
 
-    g_prefs.putBytes(key, peer_data, sizeof(peer_data));
+    g_nvs_tx.putBytes(key, peer_data, sizeof(peer_data));
   }
 
-  g_prefs.end();
-  return true;
+  // Count last, so a reset mid-commit never points past a written peer
+  g_nvs_tx.putUChar(NVS_PEER_COUNT, g_peer_count);
+  return g_nvs_tx.commit();
 }
 
 static bool load_peers() {
@@ -1003,6 +1938,7 @@ static bool load_peers() {
       compute_fingerprint(g_peers[i].pubkey, g_peers[i].fingerprint);
       g_peers[i].state = PEER_OFFLINE;
       g_peers[i].session_established = false;
+      g_peers[i].session_confirmed = false;
 
       // Register with ESP-NOW
       esp_now_peer_info_t peer_info = {};
@@ -1012,6 +1948,7 @@ static bool load_peers() {
       esp_now_add_peer(&peer_info);
     }
   }
+  rebuild_fp_index();
 
   g_prefs.end();
   return true;
@@ -1046,7 +1983,7 @@ bool init(const uint8_t* device_privkey, const uint8_t* device_pubkey, const cha
     return false;
   }
 
-  esp_now_register_send_cb(espnow_send_cb);
+  radio_scheduler::attach_espnow(espnow_send_cb);
   esp_now_register_recv_cb(espnow_recv_cb);
   g_espnow_initialized = true;
 
@@ -1055,6 +1992,7 @@ bool init(const uint8_t* device_privkey, const uint8_t* device_pubkey, const cha
   if (g_opera_config.configured) {
     load_peers();
   }
+  rebuild_fp_index();
 
   g_start_time_ms = millis();
   g_initialized = true;
@@ -1073,10 +2011,18 @@ bool init(const uint8_t* device_privkey, const uint8_t* device_pubkey, const cha
 void deinit() {
   if (!g_initialized) return;
 
-  esp_now_unregister_send_cb();
+  radio_scheduler::detach_espnow();
   esp_now_unregister_recv_cb();
   esp_now_deinit();
 
+  // Callback is gone: discard anything still queued
+  g_rx_tail.store(g_rx_head.load(std::memory_order_acquire), std::memory_order_release);
+  g_tx_status_tail.store(g_tx_status_head.load(std::memory_order_acquire), std::memory_order_release);
+
+  for (uint8_t i = 0; i < g_peer_count; i++) {
+    release_peer_aead(&g_peers[i]);
+  }
+
   g_espnow_initialized = false;
   g_initialized = false;
   g_mesh_state = MESH_DISABLED;
@@ -1108,12 +2054,21 @@ void update() {
 
   uint32_t now = millis();
 
-  // Process received messages
-  if (g_rx_pending) {
-    handle_received_message(g_rx_mac, g_rx_buffer, g_rx_len);
-    g_rx_pending = false;
+  // Process received messages: drain what is queued now, so a steady
+  // stream cannot starve the rest of update()
+  uint32_t tail = g_rx_tail.load(std::memory_order_relaxed);
+  uint32_t head = g_rx_head.load(std::memory_order_acquire);
+  for (; tail != head; tail++) {
+    const RxSlot& slot = g_rx_slots[tail & (RX_QUEUE_SLOTS - 1)];
+    g_rx_rssi = slot.rssi;
+    handle_received_message(slot.mac, slot.data, slot.len);
+    g_rx_tail.store(tail + 1, std::memory_order_release);
   }
 
+  drain_tx_status();
+  pump_bulk_transfers(now);
+  fold_chain_heads();
+
   // Check pairing timeout
   if ((g_mesh_state == MESH_PAIRING_INIT || g_mesh_state == MESH_PAIRING_JOIN ||
        g_mesh_state == MESH_PAIRING_CONFIRM) &&
@@ -1121,10 +2076,12 @@ void update() {
     cancel_pairing();
   }
 
-  // Send periodic heartbeat
-  if (g_mesh_state == MESH_ACTIVE && now - g_last_heartbeat_ms >= HEARTBEAT_INTERVAL_MS) {
-    send_heartbeat();
-    g_last_heartbeat_ms = now;
+  // Send periodic heartbeat; an alert starting mid-interval shortens the
+  // wait to the fast rate straight away
+  uint32_t interval = heartbeat_interval_ms(now);
+  if (interval > g_heartbeat_interval_ms) interval = g_heartbeat_interval_ms;
+  if (g_mesh_state == MESH_ACTIVE && now - g_last_heartbeat_ms >= interval) {
+    send_heartbeats(false);
   }
 
   // Check peer states
@@ -1134,17 +2091,26 @@ void update() {
     bool any_online = false;
     for (uint8_t i = 0; i < g_peer_count; i++) {
       OperaPeer* peer = &g_peers[i];
-      uint32_t since_seen = now - peer->last_seen_ms;
+
+      // Heard directly or vouched for by a relay, whichever is later
+      uint32_t seen_ms = peer->last_seen_ms;
+      if (peer->last_attested_ms != 0 && (int32_t)(peer->last_attested_ms - seen_ms) > 0) {
+        seen_ms = peer->last_attested_ms;
+      }
+      uint32_t since_seen = now - seen_ms;
+      uint32_t expected_ms = peer_heartbeat_ms(peer);
+      uint32_t stale_ms = expected_ms * HEARTBEAT_STALE_FACTOR;
+      uint32_t offline_ms = expected_ms * HEARTBEAT_OFFLINE_FACTOR;
 
       if (peer->state == PEER_CONNECTED || peer->state == PEER_ALERT) {
-        if (since_seen > PEER_OFFLINE_MS) {
+        if (since_seen > offline_ms) {
           update_peer_state(peer, PEER_OFFLINE);
-        } else if (since_seen > PEER_STALE_MS) {
+        } else if (since_seen > stale_ms) {
           update_peer_state(peer, PEER_STALE);
         }
         any_online = true;
       } else if (peer->state == PEER_STALE) {
-        if (since_seen > PEER_OFFLINE_MS) {
+        if (since_seen > offline_ms) {
           update_peer_state(peer, PEER_OFFLINE);
         } else {
           any_online = true;
@@ -1152,6 +2118,8 @@ void update() {
       }
     }
 
+    elect_relay();
+
     // Update mesh state based on peer connectivity
     if (g_mesh_state == MESH_ACTIVE && !any_online && g_peer_count > 0) {
       g_mesh_state = MESH_CONNECTING;
@@ -1205,8 +2173,40 @@ MeshStatus get_status() {
   status.alerts_sent = g_alerts_sent;
   status.alerts_received = g_alerts_received;
   status.auth_failures = g_auth_failures;
+  status.rx_dropped = g_rx_dropped.load(std::memory_order_relaxed);
+  status.is_relay = g_is_relay;
+  status.relay_score = g_relay_score;
+  status.alerts_relayed = g_alerts_relayed;
+  status.duplicates_suppressed = g_duplicates;
+  status.rx_rejected = g_rx_rejected.load(std::memory_order_relaxed);
+  status.rx_queue_peak = g_rx_peak.load(std::memory_order_relaxed);
   status.uptime_ms = millis() - g_start_time_ms;
   status.last_heartbeat_ms = g_last_heartbeat_ms;
+  status.heartbeat_interval_ms = g_heartbeat_interval_ms;
+  status.heartbeats_skipped = g_heartbeats_skipped;
+  status.anchors_sent = g_anchors_sent;
+  status.anchor_seq = g_anchor_sent_seq;
+  status.anchors_received = g_anchors_received;
+  status.anchor_gaps = g_anchor_gaps;
+  status.anchor_conflicts = g_anchor_conflicts;
+  status.anchor_heads_dropped = g_heads_dropped.load(std::memory_order_relaxed);
+  status.anchors_dropped = g_anchors_dropped;
+  status.bulk_sent = g_bulk_sent;
+  status.bulk_received = g_bulk_received;
+  status.bulk_failed = g_bulk_failed;
+  status.fragments_retransmitted = g_fragments_retransmitted;
+  status.tx_acked = g_tx_acked;
+  status.tx_failed = g_tx_failed;
+
+  uint32_t rtt_sum = 0;
+  uint8_t rtt_peers = 0;
+  for (uint8_t i = 0; i < g_peer_count; i++) {
+    if (g_peers[i].rtt_ms != 0) {
+      rtt_sum += g_peers[i].rtt_ms;
+      rtt_peers++;
+    }
+  }
+  status.rtt_avg_ms = rtt_peers ? rtt_sum / rtt_peers : 0;
 
   // Format opera ID as hex
   for (size_t i = 0; i < OPERA_ID_SIZE; i++) {
@@ -1298,12 +2298,14 @@ bool remove_peer(const uint8_t* fingerprint) {
     if (memcmp(g_peers[i].fingerprint, fingerprint, FINGERPRINT_SIZE) == 0) {
       // Remove from ESP-NOW
       esp_now_del_peer(g_peers[i].mac_addr);
+      release_peer_aead(&g_peers[i]);
 
       // Shift remaining peers
       for (uint8_t j = i; j < g_peer_count - 1; j++) {
         g_peers[j] = g_peers[j + 1];
       }
       g_peer_count--;
+      rebuild_fp_index();
 
       persist_peers();
       return true;
@@ -1332,8 +2334,10 @@ bool leave_opera() {
   // Remove all peers
   for (uint8_t i = 0; i < g_peer_count; i++) {
     esp_now_del_peer(g_peers[i].mac_addr);
+    release_peer_aead(&g_peers[i]);
   }
   g_peer_count = 0;
+  rebuild_fp_index();
 
   // Persist
   persist_opera_config();
@@ -1444,6 +2448,7 @@ bool broadcast_tamper_alert(AlertType type, LogLevel severity, uint32_t witness_
   }
 
   g_alerts_sent++;
+  g_last_alert_ms = millis() | 1;
   return broadcast_message(MSG_TAMPER_ALERT, (uint8_t*)&payload, sizeof(payload));
 }
 
@@ -1458,6 +2463,7 @@ bool broadcast_power_alert(AlertType type, uint16_t voltage_mv, uint16_t estimat
   payload.estimated_runtime_sec = estimated_runtime_sec;
 
   g_alerts_sent++;
+  g_last_alert_ms = millis() | 1;
   return broadcast_message(MSG_POWER_ALERT, (uint8_t*)&payload, sizeof(payload));
 }
 
@@ -1473,8 +2479,10 @@ bool broadcast_offline_imminent(AlertType reason, uint32_t final_seq, const uint
   memcpy(payload.final_chain_hash, final_chain_hash, 8);
 
   g_alerts_sent++;
+  g_last_alert_ms = millis() | 1;
 
   // Send to all known peers regardless of connection state
+  g_alert_counter_tx++;
   bool any_sent = false;
   for (uint8_t i = 0; i < g_peer_count; i++) {
     if (send_to_peer(&g_peers[i], MSG_OFFLINE_IMMINENT, (uint8_t*)&payload, sizeof(payload))) {
@@ -1484,6 +2492,32 @@ bool broadcast_offline_imminent(AlertType reason, uint32_t final_seq, const uint
   return any_sent;
 }
 
+void note_chain_head(uint32_t seq, const uint8_t* chain_hash) {
+  if (!g_initialized || g_mesh_state == MESH_DISABLED || !chain_hash) return;
+
+  // Full ring: the head is lost and the next anchor starts after it
+  uint32_t head = g_head_head.load(std::memory_order_relaxed);
+  if (head - g_head_tail.load(std::memory_order_acquire) >= ANCHOR_PENDING_SLOTS) {
+    g_heads_dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  PendingHead& slot = g_head_slots[head & (ANCHOR_PENDING_SLOTS - 1)];
+  slot.seq = seq;
+  memcpy(slot.chain_hash, chain_hash, 32);
+  g_head_head.store(head + 1, std::memory_order_release);
+}
+
+size_t get_anchor_receipt_count() {
+  return g_receipt_count;
+}
+
+bool get_anchor_receipt(size_t index, AnchorReceipt* out) {
+  if (index >= g_receipt_count) return false;
+  size_t oldest = (g_receipt_head + MAX_ANCHOR_RECEIPTS - g_receipt_count) % MAX_ANCHOR_RECEIPTS;
+  *out = g_receipts[(oldest + index) % MAX_ANCHOR_RECEIPTS];
+  return true;
+}
+
 const MeshAlert* get_alerts(size_t* count) {
   *count = g_alert_count;
   return g_alert_history;
@@ -1507,16 +2541,44 @@ void set_pairing_callback(PairingCallback callback) {
   g_pairing_callback = callback;
 }
 
-void send_heartbeat() {
-  if (!g_opera_config.configured) return;
+void set_bulk_callback(BulkCallback callback) {
+  g_bulk_callback = callback;
+}
 
-  HeartbeatPayload payload;
-  payload.status = 0;  // Online
-  payload.uptime_sec = (millis() - g_start_time_ms) / 1000;
-  payload.peer_count = g_peer_count;
-  payload.battery_pct = 255;  // Unknown
+void set_anchor_callback(AnchorCallback callback) {
+  g_anchor_callback = callback;
+}
 
-  broadcast_message(MSG_HEARTBEAT, (uint8_t*)&payload, sizeof(payload));
+bool send_bulk(const uint8_t* fingerprint, BulkType type, const uint8_t* data, size_t len) {
+  if (!g_opera_config.configured || len == 0 || len > MAX_BULK_SIZE) {
+    return false;
+  }
+  OperaPeer* peer = find_peer_by_fingerprint(fingerprint);
+  if (!peer) return false;
+
+  for (size_t i = 0; i < BULK_TX_SLOTS; i++) {
+    TxTransfer* tx = &g_bulk_tx[i];
+    if (tx->active) continue;
+
+    memset(tx, 0, offsetof(TxTransfer, data));
+    tx->active = true;
+    memcpy(tx->peer_fp, fingerprint, FINGERPRINT_SIZE);
+    tx->id = g_next_transfer_id++;
+    tx->len = len;
+    tx->frag_size = peer->session_confirmed ? FRAGMENT_DATA_SEALED : FRAGMENT_DATA_SIGNED;
+    tx->count = (len + tx->frag_size - 1) / tx->frag_size;
+    tx->bulk_type = (uint8_t)type;
+    tx->window = FRAGMENT_WINDOW;
+    memcpy(tx->data, data, len);
+
+    pump_transfer(tx, millis());
+    return true;
+  }
+  return false;
+}
+
+void send_heartbeat() {
+  send_heartbeats(true);
 }
 
 void get_message_stats(uint32_t* sent, uint32_t* received, uint32_t* errors) {
@@ -7,10 +7,13 @@
  *
  * Security Properties:
  * - Ed25519 device key authentication
- * - ChaCha20-Poly1305 encrypted messages
+ * - AES-GCM session encryption of routine traffic once a peer is authenticated
+ * - ChaCha20-Poly1305 encrypted opera secret during pairing
  * - Opera isolation (prevents neighbor interference)
  * - Visual pairing confirmation codes
  * - Replay prevention with monotonic counters
+ * - Elected relays forward alerts with a hop limit and duplicate suppression
+ * - Heartbeats anchor each device's recent chain heads with its neighbours
  *
  * See spec/canary_mesh_network_v0.md for full protocol specification.
  */
@@ -32,20 +35,55 @@ namespace mesh_network {
 static const uint8_t PROTOCOL_VERSION = 0;
 
 // Network limits
-static const size_t MAX_OPERA_SIZE = 16;           // Maximum peers in an opera
+static const size_t MAX_OPERA_SIZE = 48;           // Maximum peers in an opera (direct or relayed)
+static const size_t MAX_SESSIONS = 16;             // Direct neighbours with an AES-GCM session
 static const size_t MAX_PEER_NAME_LEN = 24;        // Max device name length
 static const size_t MAX_OPERA_NAME_LEN = 32;       // Max opera name length
 static const size_t MAX_MESSAGE_SIZE = 250;        // ESP-NOW limit
 static const size_t MAX_ALERT_HISTORY = 32;        // Stored alerts
+static const size_t RX_QUEUE_SLOTS = 32;           // Receive ring (power of two): one burst from a busy neighbourhood
+static const size_t TX_STATUS_SLOTS = 32;          // Send-status ring (power of two), for delivery ratios
+
+// Relay topology
+static const uint8_t RELAY_MAX_HOPS = 3;           // Transmissions from origin to the farthest peer
+static const uint8_t RELAY_SLOTS = 2;              // Relays elected per neighbourhood
+static const int8_t RELAY_MIN_RSSI = -80;          // Weaker links don't count toward relay score
+static const size_t DEDUP_CACHE_SIZE = 32;         // Recently seen alerts, for duplicate suppression
+static const size_t MAX_LIVENESS_ENTRIES = 13;     // Peers a relay attests per frame (fits a signed frame)
+
+// Fragmentation (bulk payloads over several frames)
+static const size_t MAX_BULK_SIZE = 2048;          // Largest reassembled payload
+static const size_t MAX_FRAGMENTS = 16;            // Fragments per transfer
+static const size_t FRAGMENT_DATA_SEALED = 176;    // Fragment data in a session-sealed frame
+static const size_t FRAGMENT_DATA_SIGNED = 140;    // Fragment data in a signed frame
+static const size_t BULK_TX_SLOTS = 2;             // Outgoing transfers in progress
+static const size_t BULK_RX_SLOTS = 2;             // Reassembly buffers
+static const uint8_t FRAGMENT_WINDOW = 4;          // Unacknowledged fragments in flight
+static const uint8_t FRAGMENT_ACK_EVERY = 2;       // Receiver acks every Nth fragment
+static const uint8_t FRAGMENT_MAX_TRIES = 5;       // Sends of one fragment before giving up
+
+// Chain-head anchoring (Merkle root of recent heads, carried by heartbeats)
+static const size_t ANCHOR_ROOT_SIZE = 16;         // Truncated SHA-256 root on the wire
+static const uint8_t ANCHOR_MAX_HEIGHT = 10;       // Heads per anchor: up to 2^10
+static const size_t ANCHOR_PENDING_SLOTS = 16;     // Heads noted, not yet folded (power of two)
+static const size_t MAX_ANCHOR_RECEIPTS = 32;      // Peer anchors kept in RAM (all are witnessed)
 
 // Timing (milliseconds)
-static const uint32_t HEARTBEAT_INTERVAL_MS = 30000;   // Send heartbeat every 30s
-static const uint32_t PEER_STALE_MS = 90000;           // Peer stale after 90s
-static const uint32_t PEER_OFFLINE_MS = 300000;        // Peer offline after 5min
+static const uint32_t HEARTBEAT_INTERVAL_MS = 30000;   // Send heartbeat every 30s (default)
+static const uint32_t HEARTBEAT_FAST_MS = 10000;       // While an alert is active
+static const uint32_t HEARTBEAT_SLOW_MS = 60000;       // While every peer is settled
+static const uint32_t ALERT_ACTIVE_MS = 300000;        // Alert keeps the fast rate for 5min
+static const uint8_t HEARTBEAT_STALE_FACTOR = 3;       // Missed intervals before stale
+static const uint8_t HEARTBEAT_OFFLINE_FACTOR = 10;    // Missed intervals before offline
+static const uint32_t PEER_STALE_MS = 90000;           // Peer stale after 90s (default interval)
+static const uint32_t PEER_OFFLINE_MS = 300000;        // Peer offline after 5min (default interval)
 static const uint32_t AUTH_TIMEOUT_MS = 10000;         // Authentication timeout
 static const uint32_t PAIRING_TIMEOUT_MS = 120000;     // Pairing timeout (2min)
 static const uint32_t RECONNECT_INTERVAL_MS = 5000;    // Reconnect attempt interval
 static const uint32_t MESSAGE_TTL_MS = 300000;         // Message validity (5min)
+static const uint32_t FRAGMENT_RTO_MS = 150;           // Resend an unacknowledged fragment
+static const uint32_t FRAGMENT_BUSY_BACKOFF_MS = 500;  // Wait when the receiver has no buffer
+static const uint32_t REASSEMBLY_TIMEOUT_MS = 5000;    // Drop a stalled reassembly
 
 // Crypto sizes
 static const size_t OPERA_ID_SIZE = 16;
@@ -57,6 +95,7 @@ static const size_t FINGERPRINT_SIZE = 8;
 static const size_t NONCE_SIZE = 12;
 static const size_t SESSION_KEY_SIZE = 32;
 static const size_t AUTH_CHALLENGE_SIZE = 32;
+static const size_t SESSION_TAG_SIZE = 16;         // AES-GCM tag under the session key
 
 // ESP-NOW configuration
 static const uint8_t ESPNOW_CHANNEL = 1;
@@ -107,9 +146,25 @@ enum MessageType : uint8_t {
   MSG_PAIR_CONFIRM,
   MSG_PAIR_COMPLETE,
   MSG_LEAVE_OPERA,
-  MSG_ENCRYPTED            // Encrypted payload wrapper
+  MSG_ENCRYPTED,           // Encrypted payload wrapper
+  MSG_RELAY,               // Hop budget + an alert forwarded verbatim
+  MSG_FRAGMENT,            // One piece of a bulk payload
+  MSG_FRAGMENT_ACK         // Selective acknowledgement + flow control
 };
 
+// Bulk payload types, carried by fragmentation
+enum BulkType : uint8_t {
+  BULK_WITNESS_RECORDS = 0,  // Recent witness records, for cross-witnessing
+  BULK_CHAIN_HEAD            // Chain head summary
+};
+
+// Set in the msg_type byte when the payload is AES-GCM encrypted under the
+// session key and the message ends in nonce + tag instead of an Ed25519
+// signature. Only routine traffic from a peer whose session is confirmed
+// takes this path; auth, pairing and alerts stay signed so they remain
+// attributable to the device key.
+static const uint8_t MSG_FLAG_SESSION_AEAD = 0x80;
+
 // Alert types
 enum AlertType : uint8_t {
   ALERT_TAMPER = 0,        // Physical tamper detected
@@ -145,11 +200,31 @@ struct OperaPeer {
   PeerState state;
   uint64_t msg_counter_tx;                  // Outgoing message counter
   uint64_t msg_counter_rx;                  // Last received counter
+  uint64_t alert_counter_rx;                // Last alert counter, direct or relayed
   uint32_t last_seen_ms;                    // Last heartbeat received
   uint32_t last_tx_ms;                      // Last message sent
   int8_t rssi;                              // Signal strength
   uint8_t alerts_received;                  // Alert count from this peer
   bool session_established;                 // Session key derived
+  bool session_confirmed;                   // Peer is known to hold the session key
+  uint8_t aead_slot;                        // Keyed AES-GCM context (valid with session_established)
+  uint8_t relay_score;                      // Strong links the peer advertises
+  uint8_t heartbeat_s;                      // Interval the peer advertises (0 = default)
+  uint32_t last_attested_ms;                // A relay last vouched it was heard
+
+  // Link metrics
+  int16_t rssi_avg_x16;                     // RSSI EWMA in 1/16 dBm (0 = no sample yet)
+  uint32_t tx_acked;                        // Frames the MAC layer delivered
+  uint32_t tx_failed;                       // Frames lost after MAC retries
+  uint16_t rtt_ms;                          // Round-trip EWMA from heartbeat echoes (0 = none)
+  uint16_t retransmits;                     // Fragments resent to this peer
+  uint32_t echo_ts;                         // Sent time of the peer's last heartbeat (its clock)
+  uint32_t echo_rx_ms;                      // When that heartbeat arrived (our clock)
+
+  // Chain-head anchoring
+  uint32_t anchor_seq;                      // Last seq the peer anchored with us (0 = none)
+  uint16_t anchors;                         // Anchors received from it
+  uint16_t anchor_conflicts;                // Anchors that went back over anchored seqs
 };
 
 // Opera configuration (persisted to NVS)
@@ -176,8 +251,31 @@ struct MeshStatus {
   uint32_t alerts_sent;
   uint32_t alerts_received;
   uint32_t auth_failures;
+  uint32_t rx_dropped;        // Lost to a full receive ring
+  uint32_t rx_rejected;       // Empty or oversized frames
+  uint8_t  rx_queue_peak;     // Most slots ever in use
+  bool     is_relay;          // Elected to forward alerts
+  uint8_t  relay_score;       // Our strong links (RSSI >= RELAY_MIN_RSSI)
+  uint32_t alerts_relayed;    // Alerts forwarded as a relay
+  uint32_t duplicates_suppressed;
   uint32_t uptime_ms;
   uint32_t last_heartbeat_ms;
+  uint32_t heartbeat_interval_ms;   // Interval currently advertised
+  uint32_t heartbeats_skipped;      // Covered by other recent traffic
+  uint32_t bulk_sent;                // Transfers fully acknowledged
+  uint32_t bulk_received;            // Transfers reassembled
+  uint32_t bulk_failed;              // Transfers abandoned (either side)
+  uint32_t fragments_retransmitted;
+  uint32_t tx_acked;                 // MAC-layer delivery confirmations
+  uint32_t tx_failed;                // MAC-layer delivery failures
+  uint16_t rtt_avg_ms;               // Mean round trip over peers with a sample
+  uint32_t anchors_sent;             // Heartbeat rounds that carried our anchor
+  uint32_t anchor_seq;               // Last of our seqs anchored
+  uint32_t anchors_received;
+  uint32_t anchor_gaps;              // Peer anchors that skipped seqs (a missed heartbeat)
+  uint32_t anchor_conflicts;         // Peer anchors that overlapped earlier ones
+  uint32_t anchor_heads_dropped;     // Heads lost to a full pending ring
+  uint32_t anchors_dropped;          // Anchors no peer received before the next began
   char opera_id_hex[OPERA_ID_SIZE * 2 + 1];
 };
 
@@ -195,6 +293,18 @@ struct PairingSession {
   bool code_confirmed;
 };
 
+// Stored anchor from a peer: what it committed to, and when we heard it.
+// The root is recomputed from the peer's records first_seq..last_seq.
+struct AnchorReceipt {
+  uint8_t peer_fp[FINGERPRINT_SIZE];
+  uint32_t received_ms;
+  uint32_t first_seq;
+  uint32_t last_seq;
+  uint16_t leaf_count;
+  bool conflict;                            // Overlapped the peer's previous anchor
+  uint8_t root[ANCHOR_ROOT_SIZE];
+};
+
 // Alert record
 struct MeshAlert {
   uint32_t timestamp_ms;
@@ -220,12 +330,67 @@ struct MessageHeader {
   uint32_t timestamp;
 };
 
+// Relay frame (not signed itself): version, MSG_RELAY, hops_left, then the
+// originator's signed alert byte for byte. hops_left is the number of
+// further forwards allowed, at most RELAY_MAX_HOPS - 2.
+
+// Fragment (MSG_FRAGMENT): header, then frag_size bytes of the bulk
+// payload at index * frag_size (the last fragment may be shorter)
+struct FragmentHeader {
+  uint16_t transfer_id;
+  uint16_t total_len;
+  uint8_t index;
+  uint8_t count;
+  uint8_t frag_size;
+  uint8_t bulk_type;                        // BulkType
+};
+
+// Fragment acknowledgement (MSG_FRAGMENT_ACK)
+struct FragmentAckPayload {
+  uint16_t transfer_id;
+  uint8_t credit;                           // Fragments the sender may have in flight; 0 = busy
+  uint8_t reserved;
+  uint32_t received;                        // Bit i set: fragment i held
+};
+
 // Heartbeat payload
 struct HeartbeatPayload {
   uint8_t status;                           // 0=online, 1=low_battery, 2=warning
   uint32_t uptime_sec;
   uint8_t peer_count;
   uint8_t battery_pct;                      // 0-100 or 255 if unknown
+  uint8_t relay_score;                      // Strong links, for relay election
+  uint8_t interval_s;                       // Seconds until the next heartbeat
+  uint32_t sent_ms;                         // Sender's clock, echoed back for RTT
+  uint32_t echo_ms;                         // Receiver's last sent_ms from us (0 = none)
+  uint16_t echo_delay_ms;                   // How long the echo was held before this send
+};
+
+// Chain-head anchor, appended to a heartbeat (after the liveness entries
+// of a MSG_PEER_LIST). root is the Merkle root over the sender's chain
+// heads first_seq..last_seq made since its previous anchor, so one
+// heartbeat commits to every record in between. Leaves are
+// H("securacv:mesh:anchor-leaf:v0" || seq_le || chain_hash) in seq order;
+// complete subtrees are built left to right and their roots folded right
+// to left, node = H("securacv:mesh:anchor-node:v0" || left || right).
+struct AnchorPayload {
+  uint32_t first_seq;
+  uint32_t last_seq;
+  uint16_t leaf_count;
+  uint8_t root[ANCHOR_ROOT_SIZE];
+};
+
+// Relay heartbeat (MSG_PEER_LIST): the relay's own heartbeat plus peers it
+// heard directly, so members out of their range are not marked stale
+struct LivenessEntry {
+  uint8_t fingerprint[FINGERPRINT_SIZE];
+  uint8_t age_s;                            // Seconds since the relay heard it
+};
+
+struct PeerListPayload {
+  HeartbeatPayload heartbeat;
+  uint8_t count;
+  LivenessEntry entries[MAX_LIVENESS_ENTRIES];  // Only count are sent
 };
 
 // Authentication challenge
@@ -302,6 +467,14 @@ typedef void (*PeerStateCallback)(const OperaPeer* peer, PeerState old_state, Pe
 // Callback when pairing state changes
 typedef void (*PairingCallback)(PairingRole role, uint32_t confirmation_code, bool success);
 
+// Callback when a bulk payload from a peer is reassembled
+typedef void (*BulkCallback)(const OperaPeer* peer, BulkType type, const uint8_t* data, size_t len);
+
+// Callback when a peer's anchor is received, from update(). The RAM ring
+// keeps only the newest MAX_ANCHOR_RECEIPTS; the sketch witnesses each one
+// so the receipts survive a reboot.
+typedef void (*AnchorCallback)(const AnchorReceipt* receipt);
+
 // ════════════════════════════════════════════════════════════════════════════
 // FUNCTION DECLARATIONS
 // ════════════════════════════════════════════════════════════════════════════
@@ -419,6 +592,19 @@ bool broadcast_power_alert(AlertType type, uint16_t voltage_mv, uint16_t estimat
 // Broadcast offline imminent to all peers (call just before shutdown)
 bool broadcast_offline_imminent(AlertType reason, uint32_t final_seq, const uint8_t* final_chain_hash);
 
+// ──────────────────────────────────────────────────────────────────────────
+// Chain-head anchoring
+// ──────────────────────────────────────────────────────────────────────────
+
+// Note a new witness chain head. Safe from any task; the head is folded
+// into the next anchor from update() and sent with the next heartbeat.
+void note_chain_head(uint32_t seq, const uint8_t* chain_hash);
+
+// Anchors received from peers: how many are kept, and each by index,
+// oldest first
+size_t get_anchor_receipt_count();
+bool get_anchor_receipt(size_t index, AnchorReceipt* out);
+
 // Get recent alerts
 const MeshAlert* get_alerts(size_t* count);
 
@@ -438,6 +624,21 @@ void set_peer_state_callback(PeerStateCallback callback);
 // Set callback for pairing events
 void set_pairing_callback(PairingCallback callback);
 
+// Set callback for reassembled bulk payloads
+void set_bulk_callback(BulkCallback callback);
+
+// Set callback for received peer anchors
+void set_anchor_callback(AnchorCallback callback);
+
+// ──────────────────────────────────────────────────────────────────────────
+// Bulk transfer
+// ──────────────────────────────────────────────────────────────────────────
+
+// Queue a payload of up to MAX_BULK_SIZE bytes for a peer. It is sent as
+// fragments from update(), with selective retransmission; false if the
+// peer is unknown or every transfer slot is busy.
+bool send_bulk(const uint8_t* fingerprint, BulkType type, const uint8_t* data, size_t len);
+
 // ──────────────────────────────────────────────────────────────────────────
 // Low-level (for testing/debugging)
 // ──────────────────────────────────────────────────────────────────────────
@@ -474,7 +675,8 @@ static const uint8_t CHIRP_MAGIC = 0xC4;           // Message identifier
 static const uint8_t CHIRP_CHANNEL = 6;            // WiFi channel (separate from Opera)
 static const size_t MAX_MESSAGE_LEN = 64;          // Max chirp message length
 static const size_t MAX_RECENT_CHIRPS = 16;        // Stored chirps
-static const size_t MAX_NONCE_CACHE = 100;         // Deduplication cache
+static const size_t NONCE_SET_SIZE = 512;          // Dedup hash set (power of two)
+static const size_t NONCE_PROBE_LIMIT = 16;        // Slots scanned per lookup
 static const size_t MAX_NEARBY_CACHE = 32;         // Nearby device cache
 static const size_t SESSION_ID_SIZE = 8;           // Ephemeral session ID
 static const size_t EMOJI_DISPLAY_SIZE = 19;       // 3 emojis (up to 6 bytes each) + null
@@ -499,6 +701,17 @@ static const uint8_t MAX_HOP_COUNT = 3;
 static const uint8_t CONFIRMATIONS_REQUIRED = 2;       // Need 2 witnesses before relay
 static const uint8_t CONFIRMATIONS_SAFETY = 1;         // Safety templates need only 1
 
+// Gossip relay: wait out a backoff, then relay with a probability that
+// falls with reception strength and with duplicates heard meanwhile
+static const size_t RELAY_PENDING_SLOTS = 8;           // Relays waiting out backoff
+static const uint32_t RELAY_BACKOFF_MIN_MS = 50;
+static const uint32_t RELAY_BACKOFF_SPAN_MS = 400;     // Added in full at RELAY_RSSI_NEAR
+static const uint32_t RELAY_JITTER_MS = 150;           // Random part of the backoff
+static const int8_t RELAY_RSSI_FAR = -85;              // At or below: relay first, p = 100%
+static const int8_t RELAY_RSSI_NEAR = -50;             // At or above: relay last, p = RELAY_P_MIN
+static const uint8_t RELAY_P_MIN = 20;                 // Percent
+static const uint8_t RELAY_DUP_SUPPRESS = 3;           // Duplicate weight that cancels a relay
+
 // Night mode (restricted hours)
 static const uint8_t NIGHT_START_HOUR = 22;            // 10 PM
 static const uint8_t NIGHT_END_HOUR = 6;               // 6 AM
@@ -650,6 +863,9 @@ struct ChirpStatus {
   bool relay_enabled;
   bool muted;
   uint32_t mute_remaining_ms;
+  uint32_t nonce_evictions;                     // Live nonces displaced from dedup set
+  uint32_t relays_sent;
+  uint32_t relays_suppressed;                   // Dropped by the gossip policy
 };
 
 // Nearby device (anonymous, just presence)
@@ -677,6 +893,7 @@ struct ReceivedChirp {
   bool validated;                               // Has enough confirmations to relay
   bool suppressed;                              // Community voted to suppress
   bool relayed;                                 // Did we relay this
+  int8_t rssi;                                  // Reception strength (relay backoff)
   bool dismissed;                               // User dismissed locally
 };
 
@@ -3,7 +3,8 @@
  *
  * Encapsulated NVS (Non-Volatile Storage) access using the Arduino Preferences
  * library. Provides both a singleton manager for the main namespace and an
- * RAII session class for module-specific namespaces.
+ * RAII session class for module-specific namespaces, plus a transaction class
+ * for writing several keys at once.
  */
 
 #ifndef SECURACV_NVS_STORE_H
@@ -12,6 +13,8 @@
 #include <Arduino.h>
 #include <Preferences.h>
 #include <cstddef>  // For std::nullptr_t
+#include <string.h>
+#include <nvs.h>
 
 // ════════════════════════════════════════════════════════════════════════════
 // NVS NAMESPACES (centralized definitions)
@@ -291,6 +294,221 @@ private:
   bool m_open;
 };
 
+// ════════════════════════════════════════════════════════════════════════════
+// NVS TRANSACTION (batched multi-key writes)
+// ════════════════════════════════════════════════════════════════════════════
+
+static const size_t NVS_TXN_MAX_KEYS = 49;       // A full (48) mesh peer table plus its count
+static const size_t NVS_TXN_MAX_BYTES = 3072;    // Staged value bytes (48 peers x 62)
+static const size_t NVS_TXN_COMPARE_MAX = 64;    // Larger blobs are rewritten without a compare
+
+/*
+ * NvsTransaction stages several key updates and applies them with one
+ * namespace open and one nvs_commit(). Preferences commits after every put,
+ * so N keys through NvsSession or NvsManager cost N commits; a transaction
+ * costs one, and a staged value that already matches the stored one is not
+ * rewritten at all, so re-saving an unchanged peer table wears no flash.
+ *
+ * Values use the same NVS types as Preferences (bool/u8, u32, blob, string),
+ * so keys written here read back through Preferences unchanged.
+ *
+ * Entries are applied in staging order. NVS has no multi-key atomicity, so a
+ * reset mid-commit can leave the earlier entries written and the later ones
+ * not: stage the key that makes the others meaningful (a count) last.
+ *
+ * Example usage:
+ *   NvsTransaction tx(NVS_CHIRP_NS);
+ *   tx.putUChar("chirp_relay", 1);
+ *   tx.putUChar("chirp_filter", 2);
+ *   tx.commit();
+ */
+class NvsTransaction {
+public:
+  explicit NvsTransaction(const char* ns = NVS_MAIN_NS)
+    : m_ns(ns), m_count(0), m_used(0), m_rejected(false), m_written(0), m_skipped(0) {}
+
+  // Anything not committed is dropped (and zeroed: values may be secrets)
+  ~NvsTransaction() { discard(); }
+
+  // Staging. Returns false if the key is too long or the transaction is full.
+  // Staging a key again replaces its earlier value.
+  bool putBool(const char* key, bool value) {
+    uint8_t v = value ? 1 : 0;   // Same encoding as Preferences::putBool
+    return stage(key, ENTRY_U8, &v, 1);
+  }
+
+  bool putUChar(const char* key, uint8_t value) {
+    return stage(key, ENTRY_U8, &value, 1);
+  }
+
+  bool putUInt(const char* key, uint32_t value) {
+    return stage(key, ENTRY_U32, &value, sizeof(value));
+  }
+
+  bool putBytes(const char* key, const void* value, size_t len) {
+    // An empty blob removes the key rather than leaving the old value behind
+    if (len == 0) return stage(key, ENTRY_ERASE, nullptr, 0);
+    return stage(key, ENTRY_BLOB, value, len);
+  }
+
+  bool putString(const char* key, const char* value) {
+    return stage(key, ENTRY_STR, value, strlen(value) + 1);
+  }
+
+  bool remove(const char* key) {
+    return stage(key, ENTRY_ERASE, nullptr, 0);
+  }
+
+  // Apply everything staged and clear the stage. Returns false if the
+  // namespace did not open, any write failed, or an earlier put was rejected.
+  bool commit() {
+    m_written = 0;
+    m_skipped = 0;
+    bool ok = !m_rejected;
+
+    nvs_handle_t h;
+    if (m_count > 0 && ::nvs_open(m_ns, NVS_READWRITE, &h) != ESP_OK) {
+      ok = false;
+    } else if (m_count > 0) {
+      for (uint8_t i = 0; i < m_count; i++) {
+        bool same = false;
+        if (apply(h, m_entries[i], &same) != ESP_OK) {
+          ok = false;
+        } else if (same) {
+          m_skipped++;
+        } else {
+          m_written++;
+        }
+      }
+      if (m_written > 0 && ::nvs_commit(h) != ESP_OK) ok = false;
+      ::nvs_close(h);
+    }
+
+    discard();
+    return ok;
+  }
+
+  // Drop everything staged without writing
+  void discard() {
+    volatile uint8_t* p = m_data;
+    for (size_t i = 0; i < m_used; i++) p[i] = 0;
+    m_count = 0;
+    m_used = 0;
+    m_rejected = false;
+  }
+
+  size_t pending() const { return m_count; }
+  uint8_t written() const { return m_written; }   // Set by the last commit()
+  uint8_t skipped() const { return m_skipped; }   // Unchanged, not rewritten
+
+  // Prevent copying
+  NvsTransaction(const NvsTransaction&) = delete;
+  NvsTransaction& operator=(const NvsTransaction&) = delete;
+
+private:
+  enum EntryType : uint8_t { ENTRY_U8, ENTRY_U32, ENTRY_BLOB, ENTRY_STR, ENTRY_ERASE };
+
+  struct Entry {
+    char key[16];           // NVS keys are at most 15 characters
+    EntryType type;
+    uint16_t off;           // Value offset in m_data
+    uint16_t len;
+  };
+
+  bool stage(const char* key, EntryType type, const void* value, size_t len) {
+    size_t key_len = strlen(key);
+    if (key_len == 0 || key_len >= sizeof(m_entries[0].key)) {
+      m_rejected = true;
+      return false;
+    }
+
+    Entry* e = nullptr;
+    for (uint8_t i = 0; i < m_count; i++) {
+      if (strcmp(m_entries[i].key, key) == 0) {
+        e = &m_entries[i];
+        break;
+      }
+    }
+
+    // A restaged value reuses its old bytes when it fits there
+    uint16_t off = m_used;
+    if (e && len <= e->len) {
+      off = e->off;
+    } else if (m_used + len > sizeof(m_data)) {
+      m_rejected = true;
+      return false;
+    }
+    if (!e) {
+      if (m_count >= NVS_TXN_MAX_KEYS) {
+        m_rejected = true;
+        return false;
+      }
+      e = &m_entries[m_count++];
+      memcpy(e->key, key, key_len + 1);
+    }
+
+    if (len > 0) memcpy(m_data + off, value, len);
+    if (off == m_used) m_used += len;
+    e->type = type;
+    e->off = off;
+    e->len = (uint16_t)len;
+    return true;
+  }
+
+  // Write one entry unless the stored value already matches it
+  esp_err_t apply(nvs_handle_t h, const Entry& e, bool* same) {
+    const uint8_t* v = m_data + e.off;
+    *same = false;
+
+    switch (e.type) {
+      case ENTRY_U8: {
+        uint8_t cur;
+        *same = ::nvs_get_u8(h, e.key, &cur) == ESP_OK && cur == v[0];
+        return *same ? ESP_OK : ::nvs_set_u8(h, e.key, v[0]);
+      }
+      case ENTRY_U32: {
+        uint32_t cur, val;
+        memcpy(&val, v, sizeof(val));
+        *same = ::nvs_get_u32(h, e.key, &cur) == ESP_OK && cur == val;
+        return *same ? ESP_OK : ::nvs_set_u32(h, e.key, val);
+      }
+      case ENTRY_BLOB:
+      case ENTRY_STR: {
+        bool blob = e.type == ENTRY_BLOB;
+        size_t cur_len = 0;
+        esp_err_t err = blob ? ::nvs_get_blob(h, e.key, nullptr, &cur_len)
+                             : ::nvs_get_str(h, e.key, nullptr, &cur_len);
+        if (err == ESP_OK && cur_len == e.len && e.len <= NVS_TXN_COMPARE_MAX) {
+          uint8_t cur[NVS_TXN_COMPARE_MAX];
+          err = blob ? ::nvs_get_blob(h, e.key, cur, &cur_len)
+                     : ::nvs_get_str(h, e.key, (char*)cur, &cur_len);
+          *same = err == ESP_OK && memcmp(cur, v, e.len) == 0;
+          volatile uint8_t* p = cur;
+          for (size_t i = 0; i < sizeof(cur); i++) p[i] = 0;
+        }
+        if (*same) return ESP_OK;
+        return blob ? ::nvs_set_blob(h, e.key, v, e.len) : ::nvs_set_str(h, e.key, (const char*)v);
+      }
+      case ENTRY_ERASE: {
+        esp_err_t err = ::nvs_erase_key(h, e.key);
+        if (err != ESP_ERR_NVS_NOT_FOUND) return err;
+        *same = true;
+        return ESP_OK;
+      }
+    }
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  const char* m_ns;
+  Entry m_entries[NVS_TXN_MAX_KEYS];
+  uint8_t m_data[NVS_TXN_MAX_BYTES];
+  uint8_t m_count;
+  uint16_t m_used;
+  bool m_rejected;
+  uint8_t m_written;
+  uint8_t m_skipped;
+};
+
 // ════════════════════════════════════════════════════════════════════════════
 // CONVENIENCE FUNCTIONS (for single operations on chirp namespace)
 // ════════════════════════════════════════════════════════════════════════════
@@ -0,0 +1,139 @@
+/*
+ * SecuraCV Canary — WiFi Probe Capture Implementation
+ *
+ * The ESP32 promiscuous filter selects by packet type only. Management
+ * subtypes are told apart by the first frame-control byte, which is the
+ * one byte of the frame this module reads.
+ */
+
+#include "probe_capture.h"
+#include "rf_presence.h"
+#include "esp_wifi.h"
+#include <atomic>
+
+namespace probe_capture {
+
+// Frame control byte 0 of a probe request: type 0 (mgmt), subtype 4
+static const uint8_t FC_PROBE_REQUEST = 0x40;
+static const uint8_t FC_TYPE_SUBTYPE_MASK = 0xFC;
+
+// ════════════════════════════════════════════════════════════════════════════
+// PRIVATE STATE
+// ════════════════════════════════════════════════════════════════════════════
+
+static bool s_running = false;
+static bool s_sniffing = false;
+static uint32_t s_window_ms = WINDOW_MS;
+static uint32_t s_period_ms = PERIOD_MS;
+static uint32_t s_window_start_ms = 0;
+static uint32_t s_windows = 0;
+
+// Written from the WiFi task callback, collected in update()
+static std::atomic<uint32_t> s_win_probes{0};
+static std::atomic<int32_t> s_win_rssi_peak{INT8_MIN};
+static std::atomic<uint32_t> s_mgmt_frames{0};
+static std::atomic<uint32_t> s_probe_total{0};
+
+// ════════════════════════════════════════════════════════════════════════════
+// PROMISCUOUS CALLBACK (WiFi task context)
+// ════════════════════════════════════════════════════════════════════════════
+
+static void IRAM_ATTR on_frame(void* buf, wifi_promiscuous_pkt_type_t type) {
+  if (type != WIFI_PKT_MGMT || buf == nullptr) return;
+  const wifi_promiscuous_pkt_t* pkt = static_cast<const wifi_promiscuous_pkt_t*>(buf);
+  s_mgmt_frames.fetch_add(1, std::memory_order_relaxed);
+
+  if (pkt->rx_ctrl.sig_len < 1) return;
+  if ((pkt->payload[0] & FC_TYPE_SUBTYPE_MASK) != FC_PROBE_REQUEST) return;
+
+  int32_t rssi = pkt->rx_ctrl.rssi;
+  if (rssi < rf_presence::RSSI_NOISE_FLOOR) return;
+
+  s_win_probes.fetch_add(1, std::memory_order_relaxed);
+  s_probe_total.fetch_add(1, std::memory_order_relaxed);
+  int32_t peak = s_win_rssi_peak.load(std::memory_order_relaxed);
+  while (rssi > peak &&
+         !s_win_rssi_peak.compare_exchange_weak(peak, rssi, std::memory_order_relaxed)) {
+  }
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// PRIVATE HELPERS
+// ════════════════════════════════════════════════════════════════════════════
+
+static void open_window(uint32_t now_ms) {
+  s_win_probes.store(0, std::memory_order_relaxed);
+  s_win_rssi_peak.store(INT8_MIN, std::memory_order_relaxed);
+  if (esp_wifi_set_promiscuous(true) == ESP_OK) {
+    s_sniffing = true;
+  }
+  s_window_start_ms = now_ms;
+}
+
+static void close_window() {
+  esp_wifi_set_promiscuous(false);
+  s_sniffing = false;
+  s_windows++;
+
+  // Promiscuous mode is off, so the callback has stopped counting
+  uint32_t probes = s_win_probes.exchange(0, std::memory_order_relaxed);
+  int32_t peak = s_win_rssi_peak.exchange(INT8_MIN, std::memory_order_relaxed);
+  if (probes > 0) {
+    rf_presence::feed_probe_window(probes > UINT8_MAX ? UINT8_MAX : probes,
+                                   static_cast<int8_t>(peak));
+  }
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// PUBLIC API
+// ════════════════════════════════════════════════════════════════════════════
+
+bool start(uint32_t window_ms, uint32_t period_ms) {
+  if (window_ms < MIN_WINDOW_MS) window_ms = MIN_WINDOW_MS;
+  if (period_ms < MIN_PERIOD_MS) period_ms = MIN_PERIOD_MS;
+  if (window_ms > period_ms) window_ms = period_ms;
+
+  wifi_promiscuous_filter_t filter = {};
+  filter.filter_mask = WIFI_PROMIS_FILTER_MASK_MGMT;
+  if (esp_wifi_set_promiscuous_filter(&filter) != ESP_OK) return false;
+  if (esp_wifi_set_promiscuous_rx_cb(on_frame) != ESP_OK) return false;
+
+  s_window_ms = window_ms;
+  s_period_ms = period_ms;
+  s_running = true;
+  open_window(millis());
+  return true;
+}
+
+void stop() {
+  if (!s_running) return;
+  if (s_sniffing) close_window();
+  esp_wifi_set_promiscuous_rx_cb(nullptr);
+  s_running = false;
+}
+
+void update() {
+  if (!s_running) return;
+  uint32_t now_ms = millis();
+  uint32_t elapsed = now_ms - s_window_start_ms;
+
+  if (s_sniffing && elapsed >= s_window_ms) {
+    close_window();
+  } else if (!s_sniffing && elapsed >= s_period_ms) {
+    open_window(now_ms);
+  }
+}
+
+CaptureStats get_stats() {
+  return CaptureStats{
+    .running = s_running,
+    .sniffing = s_sniffing,
+    .window_ms = s_window_ms,
+    .period_ms = s_period_ms,
+    .windows = s_windows,
+    .mgmt_frames = s_mgmt_frames.load(std::memory_order_relaxed),
+    .probe_requests = s_probe_total.load(std::memory_order_relaxed)
+  };
+}
+
+} // namespace probe_capture
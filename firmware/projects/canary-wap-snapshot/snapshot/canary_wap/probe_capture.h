@@ -0,0 +1,67 @@
+/*
+ * SecuraCV Canary — WiFi Probe Capture
+ *
+ * Duty-cycled promiscuous sniffing for RF presence. The radio only
+ * listens for a short window each period and spends the rest serving the
+ * AP. The hardware filter passes management frames only, and the callback
+ * keeps just probe requests, counting them into per-window totals.
+ * Counting is the only work done in the callback: no frame is queued or
+ * copied, and no source address is read.
+ *
+ * At the end of each window, rf_presence::feed_probe_window() receives
+ * the window's probe count and peak RSSI.
+ *
+ * Example usage:
+ *   probe_capture::start();          // after WiFi is up
+ *   loop() { probe_capture::update(); rf_presence::update(); }
+ */
+
+#ifndef SECURACV_PROBE_CAPTURE_H
+#define SECURACV_PROBE_CAPTURE_H
+
+#include <Arduino.h>
+
+namespace probe_capture {
+
+// ════════════════════════════════════════════════════════════════════════════
+// CONFIGURATION
+// ════════════════════════════════════════════════════════════════════════════
+
+static const uint32_t WINDOW_MS = 250;        // Sniffing window
+static const uint32_t PERIOD_MS = 2500;       // Window start to start (10% duty)
+static const uint32_t MIN_WINDOW_MS = 50;
+static const uint32_t MIN_PERIOD_MS = 500;
+
+// ════════════════════════════════════════════════════════════════════════════
+// TYPES
+// ════════════════════════════════════════════════════════════════════════════
+
+struct CaptureStats {
+  bool     running;           // start() called and not stopped
+  bool     sniffing;          // Inside a window right now
+  uint32_t window_ms;
+  uint32_t period_ms;
+  uint32_t windows;           // Windows completed
+  uint32_t mgmt_frames;       // Management frames passed by the filter
+  uint32_t probe_requests;    // Probe requests counted
+};
+
+// ════════════════════════════════════════════════════════════════════════════
+// PUBLIC API
+// ════════════════════════════════════════════════════════════════════════════
+
+// Program the promiscuous filter and begin duty-cycling; WiFi must be started
+bool start(uint32_t window_ms = WINDOW_MS, uint32_t period_ms = PERIOD_MS);
+
+// Leave promiscuous mode and stop duty-cycling
+void stop();
+
+// Open and close windows on schedule (call from loop, same task as
+// rf_presence::update())
+void update();
+
+CaptureStats get_stats();
+
+} // namespace probe_capture
+
+#endif // SECURACV_PROBE_CAPTURE_H
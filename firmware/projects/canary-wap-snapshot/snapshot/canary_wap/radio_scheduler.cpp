@@ -0,0 +1,584 @@
+/*
+ * SecuraCV Canary — Radio Time-Division Scheduler Implementation
+ *
+ * The frame is a fixed sequence: home, then each off-home slot in Slot
+ * order. Only update() retunes the radio, so a slot's queue drains in one
+ * batch right after its switch instead of costing a switch per frame. A
+ * switch waits for the frames in flight, which would otherwise be sent on
+ * the new channel.
+ *
+ * The send callback runs on the WiFi task; it only pushes the result to
+ * an SPSC ring that pump() matches against the in-flight list. Frames
+ * sent from other tasks arrive through s_inbox, so every other piece of
+ * state here is touched by the loop task alone.
+ */
+
+#include "radio_scheduler.h"
+#include "mesh_network.h"
+#include "mem_budget.h"
+#include <esp_now.h>
+#include <esp_wifi.h>
+#include <WiFi.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include <atomic>
+
+namespace radio_scheduler {
+
+// ════════════════════════════════════════════════════════════════════════════
+// PRIVATE STATE
+// ════════════════════════════════════════════════════════════════════════════
+
+enum FrameState : uint8_t {
+  FRAME_FREE = 0,
+  FRAME_QUEUED,
+  FRAME_IN_FLIGHT
+};
+
+struct QueuedFrame {
+  uint8_t  mac[6];
+  uint8_t  len;
+  uint8_t  state;               // FrameState
+  uint8_t  replace_key;
+  uint8_t  attempts;
+  uint32_t order;               // Submission order, for per-destination FIFO
+  uint32_t not_before_ms;       // Retry backoff
+  uint8_t  data[MAX_FRAME_LEN];
+};
+
+struct SlotState {
+  uint8_t  channel;
+  uint32_t dwell_ms;
+  uint8_t  count;               // Frames not FRAME_FREE
+  uint32_t visits;
+  uint32_t skipped;
+  uint32_t frames_sent;
+  uint32_t frames_failed;
+  uint32_t frames_dropped;
+  uint32_t frames_retried;
+  uint32_t frames_replaced;
+  uint32_t on_channel_ms;
+  uint64_t airtime_us;
+};
+
+// Queues are touched from the loop task only (ESP-NOW copies on send)
+PSRAM_BSS static QueuedFrame s_queues[SLOT_COUNT][QUEUE_DEPTH];
+
+// A send() from a task other than the loop, waiting for update()
+struct InboxFrame {
+  uint8_t  slot;
+  uint8_t  mac[6];
+  uint8_t  len;
+  uint8_t  replace_key;
+  uint8_t  data[MAX_FRAME_LEN];
+};
+
+// Cold: filled by httpd handlers, never from a radio callback
+PSRAM_BSS static uint8_t s_inbox_storage[INBOX_DEPTH * sizeof(InboxFrame)];
+MEM_BUDGET_STATIC("radio", s_inbox_storage);
+static StaticQueue_t s_inbox_buf;
+static QueueHandle_t s_inbox = nullptr;
+static TaskHandle_t s_owner = nullptr;         // The loop task, set by init()
+static std::atomic<uint32_t> s_inbox_dropped{0};
+
+struct InFlight {
+  uint8_t  slot;
+  uint8_t  index;
+  uint32_t seq;                                // s_send_seq at the send
+  uint32_t sent_ms;
+};
+
+// Send results: the ESP-NOW callback (WiFi task) produces, pump() consumes
+static const size_t TX_DONE_SLOTS = 8;
+static_assert((TX_DONE_SLOTS & (TX_DONE_SLOTS - 1)) == 0, "send-result ring must be a power of two");
+static_assert(TX_DONE_SLOTS >= TX_WINDOW, "send-result ring must hold a full window");
+
+struct TxDone {
+  uint32_t seq;                                // s_result_seq at the result
+  uint8_t  mac[6];
+  bool     delivered;
+};
+
+static TxDone s_done[TX_DONE_SLOTS];
+static std::atomic<uint32_t> s_done_head{0};
+static std::atomic<uint32_t> s_done_tail{0};
+
+// ESP-NOW reports one result per accepted send, in send order, so the
+// n-th result is for the n-th send. Both count from the same point on
+// attach; a result then names its frame even when a retry to the same
+// peer is already in flight.
+static uint32_t s_send_seq = 0;                // Loop task
+static std::atomic<uint32_t> s_result_seq{0};  // WiFi task
+static bool s_seq_skewed = false;              // Realign once the window drains
+static SendDoneCallback s_on_done = nullptr;
+static bool s_attached = false;
+
+static InFlight s_in_flight[TX_WINDOW];        // Oldest first
+static uint8_t s_in_flight_count = 0;
+static uint32_t s_order = 0;
+static uint32_t s_no_mem = 0;                  // Sends deferred on ESP_ERR_ESPNOW_NO_MEM
+static uint32_t s_timeouts = 0;                // Results that never came
+
+static const uint8_t BROADCAST_MAC[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+
+static SlotState s_slots[SLOT_COUNT];
+static bool s_initialized = false;
+static uint8_t s_home_channel = 1;
+static uint8_t s_tuned_channel = 0;
+static Slot s_current = SLOT_HOME;
+static uint32_t s_phase_start_ms = 0;
+
+// ════════════════════════════════════════════════════════════════════════════
+// PRIVATE HELPERS
+// ════════════════════════════════════════════════════════════════════════════
+
+static bool is_off_home(Slot slot) {
+  return slot != SLOT_HOME && s_slots[slot].channel != s_home_channel;
+}
+
+static uint32_t home_dwell_ms() {
+  uint32_t away = 0;
+  for (uint8_t i = SLOT_HOME + 1; i < SLOT_COUNT; i++) {
+    if (is_off_home((Slot)i)) away += s_slots[i].dwell_ms;
+  }
+  return FRAME_MS - away;
+}
+
+static uint32_t phase_dwell_ms(Slot slot) {
+  return slot == SLOT_HOME ? home_dwell_ms() : s_slots[slot].dwell_ms;
+}
+
+// Leaving the home channel would drop the router link or the AP clients
+static bool home_links_active() {
+  wifi_ap_record_t ap;
+  return esp_wifi_sta_get_ap_info(&ap) == ESP_OK || WiFi.softAPgetStationNum() > 0;
+}
+
+static bool tune(uint8_t channel) {
+  if (s_tuned_channel == channel) return true;
+  if (esp_wifi_set_channel(channel, WIFI_SECOND_CHAN_NONE) != ESP_OK) return false;
+  s_tuned_channel = channel;
+  return true;
+}
+
+// The AP follows the station onto the router's channel, so re-read home
+static void refresh_home_channel() {
+  uint8_t primary = 0;
+  wifi_second_chan_t second;
+  if (esp_wifi_get_channel(&primary, &second) == ESP_OK && primary != 0) {
+    s_home_channel = primary;
+    s_tuned_channel = primary;
+  }
+}
+
+static void espnow_send_done(const wifi_tx_info_t* info, esp_now_send_status_t status) {
+  bool delivered = status == ESP_NOW_SEND_SUCCESS;
+  uint32_t seq = s_result_seq.load(std::memory_order_relaxed);
+  s_result_seq.store(seq + 1, std::memory_order_release);
+
+  // Full ring: the frame times out in pump() instead
+  uint32_t head = s_done_head.load(std::memory_order_relaxed);
+  if (head - s_done_tail.load(std::memory_order_acquire) < TX_DONE_SLOTS) {
+    TxDone& d = s_done[head & (TX_DONE_SLOTS - 1)];
+    d.seq = seq;
+    memcpy(d.mac, info->des_addr, 6);
+    d.delivered = delivered;
+    s_done_head.store(head + 1, std::memory_order_release);
+  }
+
+  SendDoneCallback cb = s_on_done;
+  if (cb) cb(info->des_addr, delivered);
+}
+
+static bool is_broadcast(const uint8_t* mac) {
+  return memcmp(mac, BROADCAST_MAC, 6) == 0;
+}
+
+static bool before(uint32_t a, uint32_t b) {
+  return (int32_t)(a - b) < 0;
+}
+
+static void release(Slot slot, QueuedFrame& f) {
+  f.state = FRAME_FREE;
+  s_slots[slot].count--;
+}
+
+// A broadcast is never acknowledged by a peer, so only unicast is retried
+static void complete(Slot slot, QueuedFrame& f, bool delivered, uint32_t now_ms) {
+  SlotState& s = s_slots[slot];
+  if (!delivered && !is_broadcast(f.mac) && f.attempts <= TX_RETRIES) {
+    f.state = FRAME_QUEUED;
+    f.not_before_ms = now_ms + (TX_RETRY_BASE_MS << (f.attempts - 1));
+    s.frames_retried++;
+    return;
+  }
+  if (!delivered) s.frames_failed++;
+  release(slot, f);
+}
+
+static void retire_in_flight(uint8_t n, bool delivered, uint32_t now_ms) {
+  const InFlight& e = s_in_flight[n];
+  complete((Slot)e.slot, s_queues[e.slot][e.index], delivered, now_ms);
+  for (uint8_t i = n + 1; i < s_in_flight_count; i++) s_in_flight[i - 1] = s_in_flight[i];
+  s_in_flight_count--;
+}
+
+// Results arrive in send order and carry their send's sequence number.
+// One that matches no frame in flight is for a frame already timed out,
+// even if a later frame to the same peer is in flight; frames sent before
+// the match lost theirs.
+static void collect_results(uint32_t now_ms) {
+  uint32_t tail = s_done_tail.load(std::memory_order_relaxed);
+  uint32_t head = s_done_head.load(std::memory_order_acquire);
+  for (; tail != head; tail++) {
+    const TxDone& d = s_done[tail & (TX_DONE_SLOTS - 1)];
+    for (uint8_t n = 0; n < s_in_flight_count; n++) {
+      const InFlight& e = s_in_flight[n];
+      if (e.seq != d.seq) continue;
+      // Out of step: a result from before a detach/attach came in late
+      if (memcmp(s_queues[e.slot][e.index].mac, d.mac, 6) != 0) {
+        s_seq_skewed = true;
+        break;
+      }
+      while (n-- > 0) {
+        s_timeouts++;
+        retire_in_flight(0, false, now_ms);
+      }
+      retire_in_flight(0, d.delivered, now_ms);
+      break;
+    }
+    s_done_tail.store(tail + 1, std::memory_order_release);
+  }
+
+  while (s_in_flight_count > 0 && now_ms - s_in_flight[0].sent_ms >= TX_COMPLETE_TIMEOUT_MS) {
+    s_timeouts++;
+    retire_in_flight(0, false, now_ms);
+  }
+
+  if (s_seq_skewed && s_in_flight_count == 0) {
+    s_send_seq = s_result_seq.load(std::memory_order_acquire);
+    s_seq_skewed = false;
+  }
+}
+
+// Oldest due frame whose destination has nothing older still waiting or
+// unacknowledged. Broadcasts are never retried, so they may overlap.
+static int next_frame(Slot slot, uint32_t now_ms) {
+  QueuedFrame* q = s_queues[slot];
+  int best = -1;
+  for (size_t i = 0; i < QUEUE_DEPTH; i++) {
+    const QueuedFrame& f = q[i];
+    if (f.state != FRAME_QUEUED || before(now_ms, f.not_before_ms)) continue;
+    if (best >= 0 && before(q[best].order, f.order)) continue;
+
+    bool blocked = false;
+    bool bcast = is_broadcast(f.mac);
+    for (size_t j = 0; j < QUEUE_DEPTH && !blocked; j++) {
+      const QueuedFrame& g = q[j];
+      if (g.state == FRAME_FREE || !before(g.order, f.order)) continue;
+      if (bcast && g.state == FRAME_IN_FLIGHT) continue;
+      blocked = memcmp(g.mac, f.mac, 6) == 0;
+    }
+    if (!blocked) best = (int)i;
+  }
+  return best;
+}
+
+// Hand frame to ESP-NOW. False if ESP-NOW is out of buffers (the frame
+// stays queued and the window waits for a result).
+static bool transmit(Slot slot, uint8_t index, uint32_t now_ms) {
+  SlotState& s = s_slots[slot];
+  QueuedFrame& f = s_queues[slot][index];
+  esp_err_t err = esp_now_send(f.mac, f.data, f.len);
+  if (err == ESP_ERR_ESPNOW_NO_MEM) {
+    s_no_mem++;
+    return false;
+  }
+  if (err != ESP_OK) {
+    s.frames_failed++;
+    release(slot, f);
+    return true;
+  }
+
+  s.frames_sent++;
+  s.airtime_us += FRAME_OVERHEAD_US + f.len * US_PER_BYTE;
+  f.attempts++;
+  if (!s_attached) {
+    // No results to wait for: sent is as good as it gets
+    release(slot, f);
+    return true;
+  }
+  f.state = FRAME_IN_FLIGHT;
+  s_in_flight[s_in_flight_count++] = { (uint8_t)slot, index, s_send_seq++, now_ms };
+  return true;
+}
+
+// Fill the window from every slot on the tuned channel
+static void pump(uint32_t now_ms) {
+  collect_results(now_ms);
+  for (uint8_t i = 0; i < SLOT_COUNT; i++) {
+    Slot slot = (Slot)i;
+    if (s_slots[i].channel != s_tuned_channel) continue;
+    while (s_slots[i].count > 0 && (!s_attached || s_in_flight_count < TX_WINDOW)) {
+      int index = next_frame(slot, now_ms);
+      if (index < 0) break;
+      if (!transmit(slot, (uint8_t)index, now_ms)) return;
+    }
+  }
+}
+
+static void leave_phase(uint32_t now_ms) {
+  uint32_t elapsed = now_ms - s_phase_start_ms;
+  if (s_current == SLOT_HOME) {
+    for (uint8_t i = 0; i < SLOT_COUNT; i++) {
+      if (i == SLOT_HOME || !is_off_home((Slot)i)) s_slots[i].on_channel_ms += elapsed;
+    }
+  } else {
+    s_slots[s_current].on_channel_ms += elapsed;
+  }
+}
+
+static void enter_home(uint32_t now_ms) {
+  s_current = SLOT_HOME;
+  s_phase_start_ms = now_ms;
+  tune(s_home_channel);
+  refresh_home_channel();
+  s_slots[SLOT_HOME].visits++;
+  s_slots[SLOT_HOME].channel = s_home_channel;
+  pump(now_ms);
+}
+
+// Next off-home slot after `after`, or home when the frame is done
+static void enter_next(Slot after, uint32_t now_ms) {
+  bool stay_home = home_links_active();
+  for (uint8_t i = after + 1; i < SLOT_COUNT; i++) {
+    Slot slot = (Slot)i;
+    if (!is_off_home(slot)) continue;
+    if (stay_home || !tune(s_slots[i].channel)) {
+      s_slots[i].skipped++;
+      continue;
+    }
+    s_current = slot;
+    s_phase_start_ms = now_ms;
+    s_slots[i].visits++;
+    pump(now_ms);
+    return;
+  }
+  enter_home(now_ms);
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// PUBLIC API
+// ════════════════════════════════════════════════════════════════════════════
+
+bool init(uint8_t home_channel) {
+  if (!s_inbox) {
+    s_inbox = xQueueCreateStatic(INBOX_DEPTH, sizeof(InboxFrame), s_inbox_storage, &s_inbox_buf);
+    if (!s_inbox) return false;
+  }
+  s_owner = xTaskGetCurrentTaskHandle();
+  memset(s_slots, 0, sizeof(s_slots));
+  memset(s_queues, 0, sizeof(s_queues));
+  s_in_flight_count = 0;
+  s_home_channel = home_channel;
+  s_tuned_channel = 0;
+  s_slots[SLOT_HOME].channel = home_channel;
+  s_slots[SLOT_MESH].channel = mesh_network::ESPNOW_CHANNEL;
+  s_slots[SLOT_MESH].dwell_ms = MESH_DWELL_MS;
+  s_slots[SLOT_CHIRP].channel = chirp_channel::CHIRP_CHANNEL;
+  s_slots[SLOT_CHIRP].dwell_ms = CHIRP_DWELL_MS;
+  s_initialized = true;
+  enter_home(millis());
+  return s_tuned_channel == s_home_channel;
+}
+
+void set_slot(Slot slot, uint8_t channel, uint32_t dwell_ms) {
+  if (slot == SLOT_HOME || slot >= SLOT_COUNT || channel == 0 || channel > 13) return;
+
+  // Keep total time away from the AP bounded
+  uint32_t others = 0;
+  for (uint8_t i = SLOT_HOME + 1; i < SLOT_COUNT; i++) {
+    if (i != slot && is_off_home((Slot)i)) others += s_slots[i].dwell_ms;
+  }
+  uint32_t budget = others < MAX_OFF_HOME_MS ? MAX_OFF_HOME_MS - others : 0;
+  s_slots[slot].channel = channel;
+  s_slots[slot].dwell_ms = dwell_ms > budget ? budget : dwell_ms;
+}
+
+bool attach_espnow(SendDoneCallback on_done) {
+  if (on_done) s_on_done = on_done;
+  // Count sends from the results seen so far; the callback was unregistered
+  if (!s_attached) s_send_seq = s_result_seq.load(std::memory_order_acquire);
+  if (esp_now_register_send_cb(espnow_send_done) != ESP_OK) return false;
+
+  if (!esp_now_is_peer_exist(BROADCAST_MAC)) {
+    esp_now_peer_info_t peer = {};
+    memcpy(peer.peer_addr, BROADCAST_MAC, 6);
+    peer.channel = 0;             // Whatever channel the scheduler tuned
+    peer.encrypt = false;
+    esp_now_add_peer(&peer);
+  }
+  s_attached = true;
+  return true;
+}
+
+void detach_espnow() {
+  esp_now_unregister_send_cb();
+  s_attached = false;
+  s_on_done = nullptr;
+
+  // No results will come for these; queued frames fail on their turn
+  for (uint8_t n = 0; n < s_in_flight_count; n++) {
+    const InFlight& e = s_in_flight[n];
+    s_slots[e.slot].frames_failed++;
+    release((Slot)e.slot, s_queues[e.slot][e.index]);
+  }
+  s_in_flight_count = 0;
+  s_done_tail.store(s_done_head.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+// Loop task: place a frame in its slot queue
+static bool enqueue(Slot slot, const uint8_t* mac, const uint8_t* data, size_t len,
+                    uint8_t replace_key) {
+  SlotState& s = s_slots[slot];
+  QueuedFrame* q = s_queues[slot];
+  QueuedFrame* f = nullptr;
+  if (replace_key != 0) {
+    for (size_t i = 0; i < QUEUE_DEPTH && !f; i++) {
+      if (q[i].state == FRAME_QUEUED && q[i].replace_key == replace_key &&
+          memcmp(q[i].mac, mac, 6) == 0) {
+        f = &q[i];
+      }
+    }
+    if (f) s.frames_replaced++;
+  }
+  if (!f) {
+    for (size_t i = 0; i < QUEUE_DEPTH && !f; i++) {
+      if (q[i].state == FRAME_FREE) f = &q[i];
+    }
+    if (!f) {
+      s.frames_dropped++;
+      return false;
+    }
+    // A superseding frame keeps its predecessor's place in line
+    f->order = s_order++;
+    f->state = FRAME_QUEUED;
+    s.count++;
+  }
+
+  memcpy(f->mac, mac, 6);
+  memcpy(f->data, data, len);
+  f->len = (uint8_t)len;
+  f->replace_key = replace_key;
+  f->attempts = 0;
+  f->not_before_ms = 0;
+  return true;
+}
+
+static void drain_inbox() {
+  InboxFrame in;
+  while (xQueueReceive(s_inbox, &in, 0) == pdTRUE) {
+    enqueue((Slot)in.slot, in.mac, in.data, in.len, in.replace_key);
+  }
+}
+
+bool send(Slot slot, const uint8_t* mac, const uint8_t* data, size_t len, uint8_t replace_key) {
+  if (slot >= SLOT_COUNT || len == 0 || len > MAX_FRAME_LEN) return false;
+  if (!s_initialized) return esp_now_send(mac, data, len) == ESP_OK;
+
+  // Queue only: transmitting here would consume results and edit the
+  // window outside update()
+  if (xTaskGetCurrentTaskHandle() == s_owner) {
+    return enqueue(slot, mac, data, len, replace_key);
+  }
+
+  InboxFrame in;
+  in.slot = slot;
+  memcpy(in.mac, mac, 6);
+  in.len = (uint8_t)len;
+  in.replace_key = replace_key;
+  memcpy(in.data, data, len);
+  if (xQueueSend(s_inbox, &in, 0) != pdTRUE) {
+    s_inbox_dropped.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  return true;
+}
+
+void update() {
+  if (!s_initialized) return;
+  uint32_t now_ms = millis();
+  drain_inbox();
+  pump(now_ms);
+  if (now_ms - s_phase_start_ms < phase_dwell_ms(s_current)) return;
+
+  // Let the frames in flight finish on this channel (bounded by the timeout)
+  if (s_in_flight_count > 0) return;
+
+  leave_phase(now_ms);
+  enter_next(s_current, now_ms);
+}
+
+Slot current_slot() {
+  return s_current;
+}
+
+uint8_t current_channel() {
+  return s_tuned_channel;
+}
+
+SlotStats get_slot_stats(Slot slot) {
+  SlotStats stats = {};
+  if (slot >= SLOT_COUNT) return stats;
+  const SlotState& s = s_slots[slot];
+
+  stats.channel = slot == SLOT_HOME ? s_home_channel : s.channel;
+  stats.on_home = !is_off_home(slot);
+  stats.dwell_ms = slot == SLOT_HOME ? home_dwell_ms() : s.dwell_ms;
+  stats.visits = s.visits;
+  stats.skipped = s.skipped;
+  stats.frames_sent = s.frames_sent;
+  stats.frames_failed = s.frames_failed;
+  stats.frames_dropped = s.frames_dropped;
+  stats.frames_retried = s.frames_retried;
+  stats.frames_replaced = s.frames_replaced;
+  stats.queued = s.count;
+  stats.on_channel_ms = s.on_channel_ms;
+  if (s.on_channel_ms > 0) {
+    uint64_t pct = s.airtime_us / 10 / s.on_channel_ms;
+    stats.utilization_pct = pct > 100 ? 100 : (uint8_t)pct;
+  }
+  return stats;
+}
+
+const char* slot_name(Slot slot) {
+  switch (slot) {
+    case SLOT_HOME:  return "home";
+    case SLOT_MESH:  return "mesh";
+    case SLOT_CHIRP: return "chirp";
+    default:         return "unknown";
+  }
+}
+
+void print_status() {
+  Serial.println();
+  Serial.printf("Radio scheduler: %s, tuned to ch %u (home ch %u)\n",
+                s_initialized ? "running" : "not started", s_tuned_channel, s_home_channel);
+  Serial.printf("  tx window %u/%u%s  no-mem deferrals %u  result timeouts %u"
+                "  inbox %u/%u dropped %u\n",
+                s_in_flight_count, TX_WINDOW, s_attached ? "" : " (unpaced)",
+                s_no_mem, s_timeouts, s_inbox ? (unsigned)uxQueueMessagesWaiting(s_inbox) : 0u, INBOX_DEPTH,
+                (unsigned)s_inbox_dropped.load(std::memory_order_relaxed));
+  for (uint8_t i = 0; i < SLOT_COUNT; i++) {
+    SlotStats st = get_slot_stats((Slot)i);
+    Serial.printf("  %-5s ch %-2u %4u ms%s  visits %u  skipped %u  sent %u  failed %u"
+                  "  dropped %u  retried %u  replaced %u  queued %u  util %u%%\n",
+                  slot_name((Slot)i), st.channel, st.dwell_ms,
+                  (i != SLOT_HOME && st.on_home) ? " (shared with home)" : "",
+                  st.visits, st.skipped, st.frames_sent, st.frames_failed,
+                  st.frames_dropped, st.frames_retried, st.frames_replaced,
+                  st.queued, st.utilization_pct);
+  }
+}
+
+} // namespace radio_scheduler
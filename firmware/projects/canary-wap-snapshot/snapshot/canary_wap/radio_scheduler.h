@@ -0,0 +1,150 @@
+/*
+ * SecuraCV Canary — Radio Time-Division Scheduler
+ *
+ * One radio serves the soft-AP, the opera mesh (ESP-NOW, ESPNOW_CHANNEL)
+ * and the chirp channel (ESP-NOW, CHIRP_CHANNEL). The scheduler owns the
+ * channel: each FRAME_MS it parks on the AP's home channel, then visits
+ * every slot whose channel differs from home for that slot's dwell time.
+ * A slot on the home channel shares the home time and never switches.
+ *
+ * Modules hand frames to send() instead of calling esp_now_send(). Every
+ * frame waits in its slot's queue and goes out while the radio is on the
+ * slot's channel, at most TX_WINDOW frames ahead of the ESP-NOW send
+ * callback, so a burst runs at the rate the radio completes frames rather
+ * than overrunning ESP-NOW's buffers (ESP_ERR_ESPNOW_NO_MEM). A full queue
+ * drops the new frame. Off-home visits are skipped while the station
+ * interface is associated or soft-AP clients are connected, since leaving
+ * the home channel would drop those links; queued frames then age out
+ * through the drop count.
+ *
+ * Frames to one destination leave in order, one at a time; other
+ * destinations are not held up behind it. A unicast frame the peer did
+ * not acknowledge is retried TX_RETRIES times, backing off from
+ * TX_RETRY_BASE_MS. A frame sent with a replace_key takes the place of a
+ * still-queued frame with the same key and destination (a newer heartbeat
+ * or presence beacon supersedes an older one that never left); the wire
+ * formats carry one message per frame, so nothing is packed together.
+ *
+ * attach_espnow() after esp_now_init() makes the scheduler the ESP-NOW
+ * send callback and registers the broadcast peer once (channel 0: the
+ * channel the radio is on). Until then frames are not paced or retried.
+ *
+ * Devices hear each other's off-home slots only while their slots
+ * overlap. Slots repeat every frame, so a dwell of D ms overlaps a peer's
+ * at random phase about 2D/FRAME_MS of the time.
+ *
+ * The queues belong to the loop task (the one that called init()). A
+ * send() from there queues directly; from any other task (httpd
+ * handlers, via chirp_channel or pairing) the frame is copied into an
+ * INBOX_DEPTH FreeRTOS queue that update() moves into the slot queues.
+ * Call update() from the loop task only.
+ *
+ * Example usage:
+ *   radio_scheduler::init(AP_CHANNEL);           // after the AP is up
+ *   radio_scheduler::set_slot(radio_scheduler::SLOT_CHIRP, CHIRP_CHANNEL, 60);
+ *   loop() { radio_scheduler::update(); mesh_network::update(); }
+ */
+
+#ifndef SECURACV_RADIO_SCHEDULER_H
+#define SECURACV_RADIO_SCHEDULER_H
+
+#include <Arduino.h>
+
+namespace radio_scheduler {
+
+// ════════════════════════════════════════════════════════════════════════════
+// CONFIGURATION
+// ════════════════════════════════════════════════════════════════════════════
+
+static const uint32_t FRAME_MS = 1000;            // Home + all off-home visits
+static const uint32_t MESH_DWELL_MS = 120;        // Used only if mesh is off home
+static const uint32_t CHIRP_DWELL_MS = 60;
+static const uint32_t MAX_OFF_HOME_MS = 300;      // AP beacons stop while away
+static const size_t   QUEUE_DEPTH = 64;           // Frames per slot: an alert to a full opera
+static const size_t   MAX_FRAME_LEN = 250;        // ESP-NOW payload limit
+static const size_t   INBOX_DEPTH = 16;           // Frames from other tasks awaiting update()
+
+// Send pacing: frames handed to ESP-NOW and not yet reported by the send
+// callback. One is on air while the next is staged.
+static const uint8_t  TX_WINDOW = 2;
+static const uint8_t  TX_RETRIES = 3;             // Extra attempts for an unacknowledged unicast
+static const uint32_t TX_RETRY_BASE_MS = 8;       // Doubles per attempt
+static const uint32_t TX_COMPLETE_TIMEOUT_MS = 50; // No callback by then: counted as not delivered
+
+// Airtime estimate for utilization: 1 Mbps ESP-NOW rate plus preamble,
+// MAC header and ACK turnaround
+static const uint32_t FRAME_OVERHEAD_US = 400;
+static const uint32_t US_PER_BYTE = 8;
+
+// ════════════════════════════════════════════════════════════════════════════
+// TYPES
+// ════════════════════════════════════════════════════════════════════════════
+
+enum Slot : uint8_t {
+  SLOT_HOME = 0,    // Soft-AP service (and any slot sharing its channel)
+  SLOT_MESH,
+  SLOT_CHIRP,
+  SLOT_COUNT
+};
+
+struct SlotStats {
+  uint8_t  channel;
+  bool     on_home;             // Shares the home channel (no switching)
+  uint32_t dwell_ms;            // Per-frame dwell (home: the remainder)
+  uint32_t visits;              // Times the radio tuned to this slot
+  uint32_t skipped;             // Off-home visits skipped (STA or AP clients associated)
+  uint32_t frames_sent;         // Accepted by esp_now_send(), retries included
+  uint32_t frames_failed;       // Rejected, or undelivered after the last retry
+  uint32_t frames_dropped;      // Queue full
+  uint32_t frames_retried;      // Unicast attempts repeated after a failure
+  uint32_t frames_replaced;     // Queued frames superseded by a newer one
+  uint8_t  queued;              // Waiting for the channel or the window
+  uint32_t on_channel_ms;       // Total time tuned to the slot
+  uint8_t  utilization_pct;     // Estimated TX airtime / on_channel_ms
+};
+
+// Every send attempt's result, from the WiFi task (keep it short)
+typedef void (*SendDoneCallback)(const uint8_t* mac, bool delivered);
+
+// ════════════════════════════════════════════════════════════════════════════
+// PUBLIC API
+// ════════════════════════════════════════════════════════════════════════════
+
+// Take ownership of the channel; mesh and chirp slots get their default
+// channels and dwell times
+bool init(uint8_t home_channel);
+
+// Move a slot to another channel or dwell; ignored for SLOT_HOME
+void set_slot(Slot slot, uint8_t channel, uint32_t dwell_ms);
+
+// Own the ESP-NOW send callback (call after esp_now_init()); on_done, when
+// given, sees every result. nullptr keeps the callback already attached.
+bool attach_espnow(SendDoneCallback on_done);
+
+// Before esp_now_deinit(): stop pacing and forget frames in flight
+void detach_espnow();
+
+// Queue the frame; the next update() sends it once tuned to the slot's
+// channel and the window has room. A nonzero replace_key supersedes a queued frame with
+// the same key and destination. Before init() this is a plain
+// esp_now_send(). Safe from any task (see INBOX_DEPTH). Returns false if
+// the frame was rejected or dropped.
+bool send(Slot slot, const uint8_t* mac, const uint8_t* data, size_t len,
+          uint8_t replace_key = 0);
+
+// Collect send results, advance the frame and drain queues (call from
+// loop). The only caller of the send path, so the in-flight window and
+// the result ring have a single consumer.
+void update();
+
+Slot current_slot();
+uint8_t current_channel();
+SlotStats get_slot_stats(Slot slot);
+const char* slot_name(Slot slot);
+
+// Print per-slot utilization to Serial
+void print_status();
+
+} // namespace radio_scheduler
+
+#endif // SECURACV_RADIO_SCHEDULER_H
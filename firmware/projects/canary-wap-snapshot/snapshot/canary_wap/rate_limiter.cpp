@@ -0,0 +1,211 @@
+/*
+ * SecuraCV Canary — Per-Client HTTP Rate Limiter Implementation
+ */
+
+#include "rate_limiter.h"
+#include "mem_budget.h"
+#include "freertos/FreeRTOS.h"
+#include "lwip/sockets.h"
+#include <string.h>
+
+namespace rate_limiter {
+
+// ════════════════════════════════════════════════════════════════════════════
+// PRIVATE STATE
+// ════════════════════════════════════════════════════════════════════════════
+
+static_assert((SETS & (SETS - 1)) == 0, "SETS must be a power of two");
+
+// Tokens are kept in 1/WINDOW_MS units, so a bucket refills by exactly its
+// per-window limit per millisecond and lazy refill needs no division
+static const uint32_t TOKEN = WINDOW_MS;
+static const uint32_t REQUEST_CAP = REQUESTS_PER_WINDOW * TOKEN;
+static const uint32_t ACTION_CAP = ACTIONS_PER_WINDOW * TOKEN;
+
+struct Bucket {
+  uint32_t ip;                 // 0 = free
+  uint32_t last_ms;            // Last refill; also the LRU key
+  uint32_t requests;
+  uint32_t actions;
+};
+
+struct Set {
+  Bucket ways[WAYS];
+  uint32_t allowed;            // Per row, so counting needs no shared lock
+  uint32_t rejected;
+  uint32_t evictions;
+};
+
+static Set s_sets[SETS];
+static portMUX_TYPE s_locks[SETS];
+MEM_BUDGET_STATIC("http", s_sets);
+
+struct Route {
+  esp_err_t (*handler)(httpd_req_t* req);
+  void* user_ctx;
+};
+
+static Route s_routes[MAX_ROUTES];
+static size_t s_route_count = 0;
+
+// Unlocked is not all-zero, so the locks are set up before setup() runs
+static struct LockInit {
+  LockInit() {
+    for (size_t i = 0; i < SETS; i++) s_locks[i] = portMUX_INITIALIZER_UNLOCKED;
+  }
+} s_lock_init;
+
+static inline size_t set_of(uint32_t ip) {
+  return ((ip * 2654435761u) >> 16) & (SETS - 1);   // Multiplicative hash, mixed bits
+}
+
+static void refill(Bucket& b, uint32_t now) {
+  uint32_t elapsed = now - b.last_ms;
+  b.last_ms = now;
+  if (elapsed >= WINDOW_MS) {
+    b.requests = REQUEST_CAP;
+    b.actions = ACTION_CAP;
+    return;
+  }
+  b.requests += elapsed * REQUESTS_PER_WINDOW;
+  if (b.requests > REQUEST_CAP) b.requests = REQUEST_CAP;
+  b.actions += elapsed * ACTIONS_PER_WINDOW;
+  if (b.actions > ACTION_CAP) b.actions = ACTION_CAP;
+}
+
+// Milliseconds until `have` reaches one token at `rate` units per ms
+static inline uint32_t wait_ms(uint32_t have, uint32_t rate) {
+  return have >= TOKEN ? 0 : (TOKEN - have + rate - 1) / rate;
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// PUBLIC API
+// ════════════════════════════════════════════════════════════════════════════
+
+bool allow(uint32_t ipv4, bool is_action, uint32_t* retry_ms) {
+  if (ipv4 == 0) return true;
+
+  uint32_t now = millis();
+  size_t si = set_of(ipv4);
+  Set& set = s_sets[si];
+  bool ok;
+  uint32_t wait = 0;
+
+  portENTER_CRITICAL(&s_locks[si]);
+  Bucket* b = nullptr;
+  Bucket* victim = &set.ways[0];
+  for (size_t w = 0; w < WAYS; w++) {
+    Bucket& c = set.ways[w];
+    if (c.ip == ipv4) { b = &c; break; }
+    // Free ways first, then the least recently seen
+    if (victim->ip != 0 && (c.ip == 0 || now - c.last_ms > now - victim->last_ms)) victim = &c;
+  }
+  if (b) {
+    refill(*b, now);
+  } else {
+    if (victim->ip != 0) set.evictions++;
+    b = victim;
+    b->ip = ipv4;
+    b->last_ms = now;
+    b->requests = REQUEST_CAP;
+    b->actions = ACTION_CAP;
+  }
+
+  ok = b->requests >= TOKEN && (!is_action || b->actions >= TOKEN);
+  if (ok) {
+    b->requests -= TOKEN;
+    if (is_action) b->actions -= TOKEN;
+    set.allowed++;
+  } else {
+    wait = wait_ms(b->requests, REQUESTS_PER_WINDOW);
+    uint32_t action_wait = is_action ? wait_ms(b->actions, ACTIONS_PER_WINDOW) : 0;
+    if (action_wait > wait) wait = action_wait;
+    set.rejected++;
+  }
+  portEXIT_CRITICAL(&s_locks[si]);
+
+  if (retry_ms) *retry_ms = wait;
+  return ok;
+}
+
+uint32_t client_ipv4(httpd_req_t* req) {
+  int fd = httpd_req_to_sockfd(req);
+  if (fd < 0) return 0;
+
+  struct sockaddr_storage addr;
+  socklen_t len = sizeof(addr);
+  if (getpeername(fd, (struct sockaddr*)&addr, &len) != 0) return 0;
+
+  uint32_t ip = 0;
+  if (addr.ss_family == AF_INET) {
+    ip = ((struct sockaddr_in*)&addr)->sin_addr.s_addr;
+  } else if (addr.ss_family == AF_INET6) {
+    // httpd listens on IPv6; IPv4 peers arrive as ::ffff:a.b.c.d
+    memcpy(&ip, ((struct sockaddr_in6*)&addr)->sin6_addr.s6_addr + 12, sizeof(ip));
+  }
+  return ip;
+}
+
+static esp_err_t limited_handler(httpd_req_t* req) {
+  const Route* route = (const Route*)req->user_ctx;
+  bool is_action = req->method == HTTP_POST || req->method == HTTP_PUT ||
+                   req->method == HTTP_DELETE;
+
+  uint32_t retry_ms = 0;
+  if (!allow(client_ipv4(req), is_action, &retry_ms)) {
+    char retry[12];
+    snprintf(retry, sizeof(retry), "%u", (unsigned)((retry_ms + 999) / 1000));
+    httpd_resp_set_status(req, "429 Too Many Requests");
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Retry-After", retry);
+    return httpd_resp_sendstr(req, "{\"ok\":false,\"error\":\"rate_limited\"}");
+  }
+
+  req->user_ctx = route->user_ctx;
+  return route->handler(req);
+}
+
+esp_err_t register_uri_handler(httpd_handle_t server, const httpd_uri_t* uri) {
+  Route* route = nullptr;
+  for (size_t i = 0; i < s_route_count; i++) {
+    if (s_routes[i].handler == uri->handler && s_routes[i].user_ctx == uri->user_ctx) {
+      route = &s_routes[i];
+      break;
+    }
+  }
+  if (!route) {
+    if (s_route_count >= MAX_ROUTES) return httpd_register_uri_handler(server, uri);
+    route = &s_routes[s_route_count++];
+    route->handler = uri->handler;
+    route->user_ctx = uri->user_ctx;
+  }
+
+  httpd_uri_t wrapped = *uri;
+  wrapped.handler = limited_handler;
+  wrapped.user_ctx = route;
+  return httpd_register_uri_handler(server, &wrapped);
+}
+
+void reset() {
+  for (size_t i = 0; i < SETS; i++) {
+    portENTER_CRITICAL(&s_locks[i]);
+    memset(s_sets[i].ways, 0, sizeof(s_sets[i].ways));
+    portEXIT_CRITICAL(&s_locks[i]);
+  }
+}
+
+Stats get_stats() {
+  Stats st = {};
+  for (size_t i = 0; i < SETS; i++) {
+    const Set& set = s_sets[i];
+    st.allowed += set.allowed;
+    st.rejected += set.rejected;
+    st.evictions += set.evictions;
+    for (size_t w = 0; w < WAYS; w++) {
+      if (set.ways[w].ip != 0) st.tracked++;
+    }
+  }
+  return st;
+}
+
+} // namespace rate_limiter
@@ -0,0 +1,83 @@
+/*
+ * SecuraCV Canary — Per-Client HTTP Rate Limiter
+ *
+ * Every request is checked against a token bucket for its client, keyed by
+ * packed IPv4 address. The table is fixed size and set-associative: the
+ * address hashes to one SETS row of WAYS buckets, so a lookup touches at
+ * most WAYS entries however many clients have come and gone. A new client
+ * takes the least recently seen bucket in its row.
+ *
+ * Buckets refill lazily on access from the time since the last one, so
+ * nothing runs between requests. Each client may burst REQUESTS_PER_WINDOW
+ * requests, sustained at that many per WINDOW_MS; state-changing methods
+ * (POST, PUT, DELETE) also draw from a smaller ACTIONS_PER_WINDOW bucket.
+ * A rejected request consumes nothing.
+ *
+ * Each row has its own spinlock, held only for the bucket update, so
+ * httpd and any worker task contend only when their clients share a row.
+ *
+ * register_uri_handler() is a drop-in for httpd_register_uri_handler()
+ * that puts the check in front of the handler; a limited client gets
+ * 429 with Retry-After and the handler never runs.
+ *
+ * Example usage:
+ *   httpd_uri_t status = { .uri = "/api/status", .method = HTTP_GET, .handler = handle_status };
+ *   rate_limiter::register_uri_handler(server, &status);
+ */
+
+#ifndef SECURACV_RATE_LIMITER_H
+#define SECURACV_RATE_LIMITER_H
+
+#include <Arduino.h>
+#include "esp_http_server.h"
+
+namespace rate_limiter {
+
+// ════════════════════════════════════════════════════════════════════════════
+// CONFIGURATION
+// ════════════════════════════════════════════════════════════════════════════
+
+static const uint32_t WINDOW_MS           = 60000;   // Refill period
+static const uint16_t REQUESTS_PER_WINDOW = 120;     // Burst and sustained requests
+static const uint16_t ACTIONS_PER_WINDOW  = 30;      // Burst and sustained POST actions
+
+static const size_t SETS = 16;                       // Hash rows, power of two
+static const size_t WAYS = 4;                        // Buckets per row (LRU)
+static const size_t MAX_ROUTES = 96;                 // Handlers wrapped by register_uri_handler()
+
+// ════════════════════════════════════════════════════════════════════════════
+// TYPES
+// ════════════════════════════════════════════════════════════════════════════
+
+struct Stats {
+  uint32_t allowed;
+  uint32_t rejected;
+  uint32_t evictions;          // Buckets taken over by a new client
+  uint8_t tracked;             // Buckets in use
+};
+
+// ════════════════════════════════════════════════════════════════════════════
+// API
+// ════════════════════════════════════════════════════════════════════════════
+
+// Take a request token (and an action token if is_action) for the client.
+// False if either bucket is empty; retry_ms then says when it refills.
+// Address 0 (unknown peer) is always allowed.
+bool allow(uint32_t ipv4, bool is_action, uint32_t* retry_ms = nullptr);
+
+// Peer IPv4 of the request's socket (v4-mapped IPv6 unwrapped); 0 if unknown
+uint32_t client_ipv4(httpd_req_t* req);
+
+// httpd_register_uri_handler() with the rate check in front. Registering
+// the same handler again (server restart) reuses its slot; past
+// MAX_ROUTES the handler is registered unchecked.
+esp_err_t register_uri_handler(httpd_handle_t server, const httpd_uri_t* uri);
+
+// Forget all clients
+void reset();
+
+Stats get_stats();
+
+} // namespace rate_limiter
+
+#endif // SECURACV_RATE_LIMITER_H
@@ -0,0 +1,147 @@
+/*
+ * SecuraCV Canary — Pooled HTTP Response Buffers Implementation
+ */
+
+#include "response_pool.h"
+#include "mem_budget.h"
+#include <atomic>
+
+namespace response_pool {
+
+// ════════════════════════════════════════════════════════════════════════════
+// PRIVATE STATE
+// ════════════════════════════════════════════════════════════════════════════
+
+MEM_POOL_PSRAM static MemPool<JSON_ARENA_BYTES, JSON_ARENAS> s_arenas;
+MEM_POOL_PSRAM static MemPool<CHUNK_BYTES, CHUNK_BLOCKS> s_chunks;
+MEM_BUDGET_STATIC("http", s_arenas);
+MEM_BUDGET_STATIC("http", s_chunks);
+
+static std::atomic<uint32_t> s_overflowed{0};
+static std::atomic<uint32_t> s_busy{0};
+
+static const size_t ARENA_ALIGN = 8;
+
+// ════════════════════════════════════════════════════════════════════════════
+// JSON ARENA
+// ════════════════════════════════════════════════════════════════════════════
+
+JsonArena::JsonArena()
+  : m_base(static_cast<uint8_t*>(s_arenas.alloc())), m_top(0), m_last(JSON_ARENA_BYTES) {}
+
+JsonArena::~JsonArena() {
+  s_arenas.free(m_base);
+}
+
+void* JsonArena::allocate(size_t size) {
+  size_t n = (size + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+  if (!m_base || n > JSON_ARENA_BYTES - m_top) return nullptr;
+  m_last = m_top;
+  m_top += n;
+  return m_base + m_last;
+}
+
+void JsonArena::deallocate(void* ptr) {
+  if (m_base && ptr == m_base + m_last) {
+    m_top = m_last;
+    m_last = JSON_ARENA_BYTES;
+  }
+}
+
+void* JsonArena::reallocate(void* ptr, size_t new_size) {
+  if (!ptr) return allocate(new_size);
+
+  // The document grows its string buffer and slot list in place when they
+  // are the most recent allocation, which is the usual case
+  size_t n = (new_size + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+  if (ptr == m_base + m_last) {
+    if (n > JSON_ARENA_BYTES - m_last) return nullptr;
+    m_top = m_last + n;
+    return ptr;
+  }
+
+  // Old size is unknown; copy up to the top, which covers it
+  size_t extent = (m_base + m_top) - static_cast<uint8_t*>(ptr);
+  void* moved = allocate(new_size);
+  if (!moved) return nullptr;
+  memcpy(moved, ptr, new_size < extent ? new_size : extent);
+  return moved;
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// CHUNKED WRITER
+// ════════════════════════════════════════════════════════════════════════════
+
+// ArduinoJson custom writer: stages bytes, sends full blocks as chunks
+class ChunkWriter {
+public:
+  ChunkWriter(httpd_req_t* req, char* buf) : m_req(req), m_buf(buf), m_len(0), m_err(ESP_OK) {}
+
+  size_t write(uint8_t c) {
+    return write(&c, 1);
+  }
+
+  size_t write(const uint8_t* data, size_t len) {
+    size_t done = 0;
+    while (done < len && m_err == ESP_OK) {
+      size_t n = CHUNK_BYTES - m_len;
+      if (n > len - done) n = len - done;
+      memcpy(m_buf + m_len, data + done, n);
+      m_len += n;
+      done += n;
+      if (m_len == CHUNK_BYTES) flush();
+    }
+    return m_err == ESP_OK ? len : 0;
+  }
+
+  esp_err_t finish() {
+    flush();
+    if (m_err != ESP_OK) return m_err;
+    return httpd_resp_send_chunk(m_req, nullptr, 0);
+  }
+
+private:
+  void flush() {
+    if (m_len == 0 || m_err != ESP_OK) return;
+    m_err = httpd_resp_send_chunk(m_req, m_buf, m_len);
+    m_len = 0;
+  }
+
+  httpd_req_t* m_req;
+  char* m_buf;
+  size_t m_len;
+  esp_err_t m_err;
+};
+
+// ════════════════════════════════════════════════════════════════════════════
+// PUBLIC API
+// ════════════════════════════════════════════════════════════════════════════
+
+esp_err_t send_json(httpd_req_t* req, const PooledJsonDocument& doc) {
+  PoolBlock<MemPool<CHUNK_BYTES, CHUNK_BLOCKS>> chunk(s_chunks);
+
+  httpd_resp_set_type(req, "application/json");
+  httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+
+  if (!doc.ok() || !chunk.ok()) {
+    s_busy.fetch_add(1, std::memory_order_relaxed);
+    httpd_resp_set_status(req, "503 Service Unavailable");
+    return httpd_resp_sendstr(req, "{\"ok\":false,\"error\":\"busy\"}");
+  }
+  if (doc.overflowed()) s_overflowed.fetch_add(1, std::memory_order_relaxed);
+
+  ChunkWriter writer(req, chunk.str());
+  serializeJson(doc, writer);
+  return writer.finish();
+}
+
+PoolStats get_stats() {
+  PoolStats st;
+  st.json = s_arenas.stats();
+  st.chunk = s_chunks.stats();
+  st.overflowed = s_overflowed.load(std::memory_order_relaxed);
+  st.busy = s_busy.load(std::memory_order_relaxed);
+  return st;
+}
+
+} // namespace response_pool
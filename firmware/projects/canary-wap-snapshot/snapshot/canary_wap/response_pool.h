@@ -0,0 +1,105 @@
+/*
+ * SecuraCV Canary — Pooled HTTP Response Buffers
+ *
+ * Every API request used to build its reply on the heap: ArduinoJson's
+ * default allocator for the document, then a String (or malloc) sized to
+ * the serialized text. The sizes differ per endpoint and per request, and
+ * after days of dashboard polling the heap fragments (min_heap drifts
+ * down while free_heap looks fine).
+ *
+ * Both now come from fixed pools (mem_pool.h):
+ *   - PooledJsonDocument is a JsonDocument whose allocator carves from one
+ *     JSON_ARENA_BYTES arena. The arena goes back to the pool when the
+ *     document leaves scope. A document that outgrows it stops adding
+ *     members and reports overflowed(), as a fixed-capacity document did;
+ *     it never falls back to the heap.
+ *   - send_json() streams the document through a CHUNK_BYTES staging
+ *     block with chunked transfer encoding, so no buffer is sized to the
+ *     whole reply.
+ *
+ * Handlers run one at a time in the httpd task; JSON_ARENAS covers a
+ * request body document plus the reply with one to spare. The pools go to
+ * PSRAM when the build places BSS there (MEM_POOL_PSRAM). get_stats()
+ * feeds the "pools" object of /api/status, whose high-water marks show
+ * whether the reservation can shrink.
+ *
+ * Example usage:
+ *   response_pool::PooledJsonDocument doc;
+ *   doc["ok"] = true;
+ *   return response_pool::send_json(req, doc);
+ */
+
+#ifndef SECURACV_RESPONSE_POOL_H
+#define SECURACV_RESPONSE_POOL_H
+
+#include <Arduino.h>
+#include "esp_http_server.h"
+#include <ArduinoJson.h>
+#include "mem_pool.h"
+
+namespace response_pool {
+
+// ════════════════════════════════════════════════════════════════════════════
+// CONFIGURATION
+// ════════════════════════════════════════════════════════════════════════════
+
+static const size_t JSON_ARENA_BYTES = 12288;     // Largest reply: /api/logs
+static const size_t JSON_ARENAS = 3;              // Body + reply + spare
+static const size_t CHUNK_BYTES = 1024;           // Staging for chunked send
+static const size_t CHUNK_BLOCKS = 2;
+
+// ════════════════════════════════════════════════════════════════════════════
+// TYPES
+// ════════════════════════════════════════════════════════════════════════════
+
+// Bump allocator over one arena block. deallocate() only reclaims the most
+// recent allocation; everything else is returned with the block.
+class JsonArena : public ArduinoJson::Allocator {
+public:
+  JsonArena();
+  ~JsonArena();
+
+  JsonArena(const JsonArena&) = delete;
+  JsonArena& operator=(const JsonArena&) = delete;
+
+  bool has_block() const { return m_base != nullptr; }
+
+  void* allocate(size_t size) override;
+  void deallocate(void* ptr) override;
+  void* reallocate(void* ptr, size_t new_size) override;
+
+private:
+  uint8_t* m_base;
+  size_t m_top;       // First free byte
+  size_t m_last;      // Offset of the most recent allocation
+};
+
+// The arena base is constructed before, and destroyed after, the document
+class PooledJsonDocument : private JsonArena, public JsonDocument {
+public:
+  PooledJsonDocument() : JsonArena(), JsonDocument(static_cast<JsonArena*>(this)) {}
+
+  // False when every arena was in use; the document holds nothing
+  bool ok() const { return has_block(); }
+};
+
+struct PoolStats {
+  mem_pool_stats_t json;        // Arenas
+  mem_pool_stats_t chunk;       // Send staging blocks
+  uint32_t overflowed;          // Replies cut short by a full arena
+  uint32_t busy;                // Requests refused with no block free
+};
+
+// ════════════════════════════════════════════════════════════════════════════
+// PUBLIC API
+// ════════════════════════════════════════════════════════════════════════════
+
+// Serialize doc as the application/json reply, streamed in chunks. Sends
+// 503 if the document or the staging block could not get a pool block.
+esp_err_t send_json(httpd_req_t* req, const PooledJsonDocument& doc);
+
+PoolStats get_stats();
+
+} // namespace response_pool
+
+#endif // SECURACV_RESPONSE_POOL_H
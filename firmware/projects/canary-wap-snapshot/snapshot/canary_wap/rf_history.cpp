@@ -0,0 +1,644 @@
+/*
+ * SecuraCV Canary — RF Presence History Implementation
+ *
+ * Only closed hours are persisted. On SD each one is appended as a single
+ * packed record; once the file passes FILE_MAX_BYTES maintain() copies
+ * its newer half into HISTORY_TMP_PATH a slice at a time and swaps it in.
+ * Closed hours wait in the RAM ring (s_unsaved) until maintain() appends
+ * them, and the compaction copy reads to the end of the file, so hours
+ * closed mid-compaction are carried over. maintain() only try-locks
+ * sd_lock(): while another task holds the card the work waits for the
+ * next call. Without a card the last NVS_HOURS hours are re-packed into
+ * one fixed-size NVS blob each hour.
+ *
+ * Lock order: sd_lock() before s_lock, never the other way round (see
+ * hardware_state.h). add() never touches the card. Every writer of
+ * s_index holds sd_lock(), so query() reads the card holding only that
+ * and takes s_lock just to copy RAM state.
+ */
+
+#include "rf_history.h"
+#include "nvs_store.h"
+#include "mem_budget.h"
+#define HARDWARE_STATE_NO_IMPL
+#include "hardware_state.h"
+#include <SD.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+namespace rf_history {
+
+// ════════════════════════════════════════════════════════════════════════════
+// PRIVATE STATE
+// ════════════════════════════════════════════════════════════════════════════
+
+// Open bucket: raw sums, turned into an RfBucket when it closes
+struct Accum {
+  uint32_t start;
+  uint32_t samples;
+  uint32_t occupied;
+  uint32_t device_sum;
+  int32_t  rssi_sum;
+  uint8_t  devices_max;
+  uint8_t  probes_max;
+  uint8_t  flags;
+  bool     open;
+};
+
+// NVS fallback blob (fixed size, so nvs_store::get_blob can read it back)
+struct NvsBlob {
+  uint32_t magic;
+  uint16_t len;
+  uint8_t  data[NVS_HOURS * RECORD_MAX_BYTES];
+};
+
+static const char* NVS_KEY = "rf_hours";
+
+static bool s_initialized = false;
+static SemaphoreHandle_t s_lock = nullptr;   // Taken inside sd_lock(), never around it
+
+static RfBucket s_hours[HOUR_BUCKETS];
+static size_t s_hour_head = 0;     // Next write index
+static size_t s_hour_count = 0;
+
+static Accum s_hour_acc;
+
+// minute index = s_base_minute + (millis() - s_base_ms) / 60000
+static uint32_t s_base_minute = 0;
+static uint32_t s_base_ms = 0;
+static bool s_boot_flag = true;
+
+static bool s_have_last = false;   // A persisted hour exists
+static uint32_t s_last_hour = 0;   // Start of the newest persisted hour
+static size_t s_unsaved = 0;       // Newest ring hours not yet on the card
+
+// query() runs on the httpd task and may wait this long for the card
+static const uint32_t QUERY_SD_WAIT_MS = 200;
+
+// Offset of one record in HISTORY_PATH and the start of the record before
+// it, which is the base its dhour is relative to
+struct IndexEntry {
+  uint32_t offset;
+  uint32_t start;
+  uint32_t prev_hour;
+};
+
+struct FileIndex {
+  IndexEntry entries[INDEX_ENTRIES];
+  size_t     count;
+  uint32_t   stride;       // Records between entries; doubles when full
+  uint32_t   records;      // Records in the file
+  uint32_t   size;         // Bytes in the file
+};
+
+// In progress rewrite of HISTORY_PATH into HISTORY_TMP_PATH
+struct Compaction {
+  bool     active;
+  uint32_t read_off;       // Next byte of HISTORY_PATH to decode
+  uint32_t prev_in;        // Delta base at read_off
+  uint32_t prev_out;       // Start of the last record copied
+  uint32_t skip;           // Records before this offset are dropped
+};
+
+// Cold: read by query() and rebuilt on compaction (see mem_budget.h)
+PSRAM_BSS static FileIndex s_index;
+PSRAM_BSS static FileIndex s_tmp_index;
+MEM_BUDGET_STATIC("rf_history", s_index);
+MEM_BUDGET_STATIC("rf_history", s_tmp_index);
+
+static Compaction s_compact;
+static bool s_compact_due = false;
+
+// ════════════════════════════════════════════════════════════════════════════
+// PRIVATE HELPERS — ENCODING
+// ════════════════════════════════════════════════════════════════════════════
+
+static size_t put_varint(uint8_t* out, size_t cap, size_t pos, uint32_t v) {
+  do {
+    if (pos >= cap) return 0;
+    uint8_t b = v & 0x7F;
+    v >>= 7;
+    out[pos++] = v ? (b | 0x80) : b;
+  } while (v);
+  return pos;
+}
+
+static bool get_varint(const uint8_t* data, size_t len, size_t* pos, uint32_t* v) {
+  uint32_t result = 0;
+  for (int shift = 0; shift < 35 && *pos < len; shift += 7) {
+    uint8_t b = data[(*pos)++];
+    result |= static_cast<uint32_t>(b & 0x7F) << shift;
+    if (!(b & 0x80)) {
+      *v = result;
+      return true;
+    }
+  }
+  return false;
+}
+
+size_t encode(const RfBucket* buckets, size_t count, uint32_t prev_hour,
+              uint8_t* out, size_t cap) {
+  size_t pos = 0;
+  for (size_t i = 0; i < count; i++) {
+    const RfBucket& b = buckets[i];
+    int32_t rssi = b.rssi_mean;
+    uint32_t fields[] = {
+      b.start - prev_hour, b.samples, b.occupied, b.devices_max, b.devices_mean,
+      (static_cast<uint32_t>(rssi) << 1) ^ static_cast<uint32_t>(rssi >> 31), b.probes_max, b.flags
+    };
+    for (uint32_t f : fields) {
+      pos = put_varint(out, cap, pos, f);
+      if (pos == 0) return 0;
+    }
+    prev_hour = b.start;
+  }
+  return pos;
+}
+
+bool decode(const uint8_t* data, size_t len, size_t* pos, uint32_t* prev_hour,
+            RfBucket* out) {
+  uint32_t f[8];
+  size_t p = *pos;
+  for (size_t i = 0; i < 8; i++) {
+    if (!get_varint(data, len, &p, &f[i])) return false;
+  }
+
+  out->start = *prev_hour + f[0];
+  out->samples = f[1] > UINT16_MAX ? UINT16_MAX : f[1];
+  out->occupied = f[2] > UINT16_MAX ? UINT16_MAX : f[2];
+  out->devices_max = f[3];
+  out->devices_mean = f[4];
+  out->rssi_mean = static_cast<int8_t>((f[5] >> 1) ^ -(f[5] & 1));
+  out->probes_max = f[6];
+  out->flags = f[7];
+
+  *prev_hour = out->start;
+  *pos = p;
+  return true;
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// PRIVATE HELPERS — BUCKETS
+// ════════════════════════════════════════════════════════════════════════════
+
+static void accum_reset(Accum* a, uint32_t start) {
+  memset(a, 0, sizeof(*a));
+  a->start = start;
+  a->open = true;
+}
+
+static void accum_add(Accum* a, const rf_presence::RfObservation& obs) {
+  a->samples++;
+  a->device_sum += obs.ble_device_count;
+  if (obs.ble_device_count > 0) {
+    a->occupied++;
+    a->rssi_sum += obs.ble_rssi_mean;
+  }
+  if (obs.ble_device_count > a->devices_max) a->devices_max = obs.ble_device_count;
+  if (obs.wifi_probe_count > a->probes_max) a->probes_max = obs.wifi_probe_count;
+  a->flags |= obs.power_flags;
+}
+
+static RfBucket accum_bucket(const Accum& a) {
+  RfBucket b;
+  b.start = a.start;
+  b.samples = a.samples > UINT16_MAX ? UINT16_MAX : a.samples;
+  b.occupied = a.occupied > UINT16_MAX ? UINT16_MAX : a.occupied;
+  b.devices_max = a.devices_max;
+  b.devices_mean = a.samples ? static_cast<uint8_t>(a.device_sum / a.samples) : 0;
+  b.rssi_mean = a.occupied ? static_cast<int8_t>(a.rssi_sum / static_cast<int32_t>(a.occupied))
+                           : rf_presence::RSSI_NOISE_FLOOR;
+  b.probes_max = a.probes_max;
+  b.flags = a.flags;
+  return b;
+}
+
+static void push_bucket(RfBucket* ring, size_t size, size_t* head, size_t* count,
+                        const RfBucket& b) {
+  ring[*head] = b;
+  *head = (*head + 1) % size;
+  if (*count < size) (*count)++;
+}
+
+// i = 0 is the oldest
+static const RfBucket& ring_at(const RfBucket* ring, size_t size, size_t head,
+                               size_t count, size_t i) {
+  return ring[(head + size - count + i) % size];
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// PRIVATE HELPERS — PERSISTENCE
+// ════════════════════════════════════════════════════════════════════════════
+
+// Decodes records from an open file through a small refill window
+struct RecordReader {
+  File*    f;
+  uint8_t  buf[256];
+  size_t   len;
+  size_t   pos;
+  uint32_t offset;         // File offset of buf[0]
+  uint32_t prev;           // Delta base of the next record
+};
+
+static void reader_begin(RecordReader* r, File* f, uint32_t offset, uint32_t prev) {
+  r->f = f;
+  r->len = r->pos = 0;
+  r->offset = offset;
+  r->prev = prev;
+  f->seek(offset);
+}
+
+// Next record; *at is its offset in the file
+static bool reader_next(RecordReader* r, RfBucket* b, uint32_t* at) {
+  if (r->len - r->pos < RECORD_MAX_BYTES && r->f->available()) {
+    memmove(r->buf, r->buf + r->pos, r->len - r->pos);
+    r->len -= r->pos;
+    r->offset += r->pos;
+    r->pos = 0;
+    r->len += r->f->read(r->buf + r->len, sizeof(r->buf) - r->len);
+  }
+  size_t p = r->pos;
+  if (!decode(r->buf, r->len, &r->pos, &r->prev, b)) return false;
+  if (at) *at = r->offset + p;
+  return true;
+}
+
+static uint32_t reader_tell(const RecordReader& r) {
+  return r.offset + r.pos;
+}
+
+static void index_reset(FileIndex* ix, uint32_t size) {
+  ix->count = 0;
+  ix->stride = INDEX_STRIDE;
+  ix->records = 0;
+  ix->size = size;
+}
+
+// Account for a record of len bytes written at offset
+static void index_note(FileIndex* ix, uint32_t offset, uint32_t start, uint32_t prev_hour,
+                       size_t len) {
+  if (ix->records % ix->stride == 0 && ix->count == INDEX_ENTRIES) {
+    // Keep every other entry; the record number is a multiple of the new stride
+    for (size_t i = 0; i < INDEX_ENTRIES / 2; i++) ix->entries[i] = ix->entries[i * 2];
+    ix->count = INDEX_ENTRIES / 2;
+    ix->stride *= 2;
+  }
+  if (ix->records % ix->stride == 0) {
+    ix->entries[ix->count++] = { offset, start, prev_hour };
+  }
+  ix->records++;
+  ix->size = offset + len;
+}
+
+// Last entry starting at or before hour, else the first (entries are in
+// start order); nullptr for an empty index
+static const IndexEntry* index_seek(const FileIndex& ix, uint32_t hour) {
+  size_t lo = 0, hi = ix.count;
+  while (lo < hi) {
+    size_t mid = (lo + hi) / 2;
+    if (ix.entries[mid].start <= hour) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  if (ix.count == 0) return nullptr;
+  return &ix.entries[lo ? lo - 1 : 0];
+}
+
+static void compact_abort() {
+  SD.remove(HISTORY_TMP_PATH);
+  s_compact.active = false;
+}
+
+static void compact_begin() {
+  File out = SD.open(HISTORY_TMP_PATH, FILE_WRITE);
+  if (!out) return;
+  uint32_t magic = HISTORY_MAGIC;
+  bool ok = out.write(reinterpret_cast<const uint8_t*>(&magic), sizeof(magic)) == sizeof(magic);
+  out.close();
+  if (!ok) {
+    SD.remove(HISTORY_TMP_PATH);
+    return;
+  }
+
+  s_compact.active = true;
+  s_compact.read_off = sizeof(magic);
+  s_compact.prev_in = 0;
+  s_compact.prev_out = 0;
+  s_compact.skip = s_index.size / 2;
+  index_reset(&s_tmp_index, sizeof(magic));
+}
+
+// Copy up to COMPACT_STEP_RECORDS records; swap the files in on reaching
+// the end of HISTORY_PATH
+static void compact_step() {
+  File in = SD.open(HISTORY_PATH, FILE_READ);
+  File out = SD.open(HISTORY_TMP_PATH, FILE_APPEND);
+  if (!in || !out) {
+    if (in) in.close();
+    if (out) out.close();
+    compact_abort();
+    return;
+  }
+
+  RecordReader r;
+  reader_begin(&r, &in, s_compact.read_off, s_compact.prev_in);
+  bool ok = true;
+  bool done = true;
+  for (size_t i = 0; i < COMPACT_STEP_RECORDS; i++) {
+    RfBucket b;
+    uint32_t at;
+    if (!reader_next(&r, &b, &at)) {
+      done = true;
+      break;
+    }
+    done = false;
+    if (at < s_compact.skip) continue;
+
+    // First record kept becomes absolute (prev_out starts at 0)
+    uint8_t rec[RECORD_MAX_BYTES];
+    size_t n = encode(&b, 1, s_compact.prev_out, rec, sizeof(rec));
+    uint32_t offset = s_tmp_index.size;
+    ok = n > 0 && out.write(rec, n) == n;
+    if (!ok) break;
+    index_note(&s_tmp_index, offset, b.start, s_compact.prev_out, n);
+    s_compact.prev_out = b.start;
+  }
+  s_compact.read_off = reader_tell(r);
+  s_compact.prev_in = r.prev;
+  in.close();
+  out.close();
+
+  if (!ok) {
+    compact_abort();
+    return;
+  }
+  if (!done) return;
+
+  SD.remove(HISTORY_PATH);
+  if (SD.rename(HISTORY_TMP_PATH, HISTORY_PATH)) {
+    s_index = s_tmp_index;
+  } else {
+    // The hours are still in RAM; the next one starts a fresh file
+    index_reset(&s_index, 0);
+    s_have_last = false;
+  }
+  s_compact.active = false;
+}
+
+static void persist_sd(const RfBucket& b) {
+  if (!SD.exists("/RF")) SD.mkdir("/RF");
+
+  bool fresh = !SD.exists(HISTORY_PATH);
+  File f = SD.open(HISTORY_PATH, FILE_APPEND);
+  if (!f) return;
+  if (fresh || f.size() == 0) {
+    uint32_t magic = HISTORY_MAGIC;
+    f.write(reinterpret_cast<const uint8_t*>(&magic), sizeof(magic));
+    s_have_last = false;
+    index_reset(&s_index, sizeof(magic));
+  }
+
+  uint32_t prev = s_have_last ? s_last_hour : 0;
+  uint8_t rec[RECORD_MAX_BYTES];
+  size_t n = encode(&b, 1, prev, rec, sizeof(rec));
+  uint32_t offset = f.size();
+  bool ok = n > 0 && f.write(rec, n) == n;
+  f.close();
+  if (!ok) return;
+
+  index_note(&s_index, offset, b.start, prev, n);
+  s_have_last = true;
+  s_last_hour = b.start;
+  if (s_index.size > FILE_MAX_BYTES && !s_compact.active) s_compact_due = true;
+}
+
+// Card writes of closed hours; a failed one is not retried. Caller holds
+// sd_lock(), then s_lock.
+static void persist_unsaved() {
+  while (s_unsaved > 0) {
+    persist_sd(ring_at(s_hours, HOUR_BUCKETS, s_hour_head, s_hour_count, s_hour_count - s_unsaved));
+    s_unsaved--;
+  }
+}
+
+static void persist_nvs() {
+  NvsBlob blob;
+  memset(&blob, 0, sizeof(blob));
+  blob.magic = HISTORY_MAGIC;
+
+  size_t n = s_hour_count < NVS_HOURS ? s_hour_count : NVS_HOURS;
+  RfBucket recent[NVS_HOURS];
+  for (size_t i = 0; i < n; i++) {
+    recent[i] = ring_at(s_hours, HOUR_BUCKETS, s_hour_head, s_hour_count, s_hour_count - n + i);
+  }
+  blob.len = encode(recent, n, 0, blob.data, sizeof(blob.data));
+  nvs_store::set_blob(NVS_KEY, &blob, sizeof(blob));
+}
+
+// Read every persisted hour once: fills the RAM ring and the file index
+static void load_sd() {
+  index_reset(&s_index, 0);
+  SdLockGuard lock;
+  File f = SD.open(HISTORY_PATH, FILE_READ);
+  if (!f) return;
+
+  uint32_t magic = 0;
+  if (f.read(reinterpret_cast<uint8_t*>(&magic), sizeof(magic)) != sizeof(magic) ||
+      magic != HISTORY_MAGIC) {
+    f.close();
+    return;
+  }
+  index_reset(&s_index, sizeof(magic));
+
+  RecordReader r;
+  reader_begin(&r, &f, sizeof(magic), 0);
+  RfBucket b;
+  uint32_t at;
+  uint32_t prev = 0;
+  while (reader_next(&r, &b, &at)) {
+    push_bucket(s_hours, HOUR_BUCKETS, &s_hour_head, &s_hour_count, b);
+    index_note(&s_index, at, b.start, prev, reader_tell(r) - at);
+    prev = b.start;
+    s_have_last = true;
+    s_last_hour = b.start;
+  }
+  f.close();
+  if (s_index.size > FILE_MAX_BYTES) s_compact_due = true;
+}
+
+static void load_nvs() {
+  NvsBlob blob;
+  if (!nvs_store::get_blob(NVS_KEY, &blob, sizeof(blob)) || blob.magic != HISTORY_MAGIC) return;
+
+  size_t pos = 0;
+  uint32_t prev = 0;
+  RfBucket b;
+  size_t len = blob.len < sizeof(blob.data) ? blob.len : sizeof(blob.data);
+  while (decode(blob.data, len, &pos, &prev, &b)) {
+    push_bucket(s_hours, HOUR_BUCKETS, &s_hour_head, &s_hour_count, b);
+    s_have_last = true;
+    s_last_hour = b.start;
+  }
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// PRIVATE HELPERS — CLOCK
+// ════════════════════════════════════════════════════════════════════════════
+
+static uint32_t minute_at(uint32_t ms) {
+  return s_base_minute + (ms - s_base_ms) / 60000;
+}
+
+static void close_hour() {
+  if (!s_hour_acc.open || s_hour_acc.samples == 0) return;
+  RfBucket b = accum_bucket(s_hour_acc);
+  push_bucket(s_hours, HOUR_BUCKETS, &s_hour_head, &s_hour_count, b);
+  if (sd_is_available()) {
+    if (s_unsaved < s_hour_count) s_unsaved++;  // Appended by maintain()
+  } else {
+    persist_nvs();
+  }
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// PUBLIC API
+// ════════════════════════════════════════════════════════════════════════════
+
+bool init() {
+  if (s_initialized) return true;
+  s_lock = xSemaphoreCreateMutex();
+  if (!s_lock) return false;
+
+  s_hour_head = s_hour_count = 0;
+  s_have_last = false;
+  s_unsaved = 0;
+  s_compact.active = false;
+  s_compact_due = false;
+  if (sd_is_available()) {
+    load_sd();
+  } else {
+    load_nvs();
+  }
+
+  // Resume after the newest persisted hour; the gap while off is unknown
+  s_base_ms = millis();
+  s_base_minute = s_have_last ? (s_last_hour + 1) * 60 : 0;
+  s_hour_acc.open = false;
+  s_boot_flag = true;
+
+  s_initialized = true;
+  return true;
+}
+
+void add(const rf_presence::RfObservation& obs) {
+  if (!s_initialized) return;
+  xSemaphoreTake(s_lock, portMAX_DELAY);
+
+  uint32_t hour = minute_at(obs.timestamp_ms) / 60;
+
+  if (!s_hour_acc.open || s_hour_acc.start != hour) {
+    close_hour();
+    accum_reset(&s_hour_acc, hour);
+  }
+  if (s_boot_flag) {
+    s_hour_acc.flags |= FLAG_BOOT;
+    s_boot_flag = false;
+  }
+
+  accum_add(&s_hour_acc, obs);
+
+  xSemaphoreGive(s_lock);
+}
+
+void maintain() {
+  if (!s_initialized) return;
+  if (!sd_is_available()) {
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    // HOURS.TMP is truncated when the next compaction begins
+    s_compact.active = false;
+    if (s_unsaved > 0) {
+      s_unsaved = 0;
+      persist_nvs();  // The card went before they were written
+    }
+    xSemaphoreGive(s_lock);
+    return;
+  }
+
+  SdLockGuard sd(0);
+  if (!sd.held) return;  // Card busy: try again next call
+  xSemaphoreTake(s_lock, portMAX_DELAY);
+  if (s_unsaved > 0) {
+    persist_unsaved();
+  } else if (s_compact.active) {
+    compact_step();
+  } else if (s_compact_due) {
+    s_compact_due = false;
+    compact_begin();
+  }
+  xSemaphoreGive(s_lock);
+}
+
+void set_clock(uint32_t unix_s) {
+  if (!s_initialized) return;
+  xSemaphoreTake(s_lock, portMAX_DELAY);
+  uint32_t now_ms = millis();
+  uint32_t target = unix_s / 60;
+  if (target >= minute_at(now_ms)) {
+    s_base_minute = target;
+    s_base_ms = now_ms;
+  }
+  xSemaphoreGive(s_lock);
+}
+
+uint32_t current_hour() {
+  return minute_at(millis()) / 60;
+}
+
+size_t query(uint32_t from, uint32_t to, RfBucket* out, size_t cap) {
+  if (!s_initialized || out == nullptr || cap == 0 || from > to) return 0;
+  size_t n = 0;
+
+  xSemaphoreTake(s_lock, portMAX_DELAY);
+  uint32_t ram_first = s_hour_count
+                         ? ring_at(s_hours, HOUR_BUCKETS, s_hour_head, s_hour_count, 0).start
+                         : UINT32_MAX;
+  xSemaphoreGive(s_lock);
+
+  // Hours before the RAM window come from the card, which holds every
+  // persisted hour (the RAM ring repeats the newest of them). The index
+  // puts the read at most one stride before from.
+  if (from < ram_first && sd_is_available()) {
+    SdLockGuard sd(QUERY_SD_WAIT_MS);  // Busy: answer from RAM only
+    const IndexEntry* seek = sd.held ? index_seek(s_index, from) : nullptr;
+    File f = seek ? SD.open(HISTORY_PATH, FILE_READ) : File();
+    if (f) {
+      RecordReader r;
+      reader_begin(&r, &f, seek->offset, seek->prev_hour);
+      RfBucket b;
+      while (n < cap && reader_next(&r, &b, nullptr)) {
+        if (b.start >= ram_first || b.start > to) break;
+        if (b.start >= from) out[n++] = b;
+      }
+      f.close();
+    }
+  }
+
+  // The ring may have moved on while the card was read; carry on after
+  // the last hour already returned
+  uint32_t next = n ? out[n - 1].start + 1 : from;
+  xSemaphoreTake(s_lock, portMAX_DELAY);
+  for (size_t i = 0; i < s_hour_count && n < cap; i++) {
+    const RfBucket& b = ring_at(s_hours, HOUR_BUCKETS, s_hour_head, s_hour_count, i);
+    if (b.start >= next && b.start <= to) out[n++] = b;
+  }
+  if (s_hour_acc.open && s_hour_acc.samples > 0 && s_hour_acc.start >= next &&
+      s_hour_acc.start <= to && n < cap) {
+    out[n++] = accum_bucket(s_hour_acc);
+  }
+  xSemaphoreGive(s_lock);
+  return n;
+}
+
+} // namespace rf_history
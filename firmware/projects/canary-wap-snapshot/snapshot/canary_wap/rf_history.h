@@ -0,0 +1,110 @@
+/*
+ * SecuraCV Canary — RF Presence History
+ *
+ * Long-term occupancy trends from RF presence. Each RfObservation is
+ * rolled up into an hour bucket (the last week stays in RAM and every
+ * closed hour is persisted).
+ * Hours are appended to HISTORY_PATH on SD, or kept as a short NVS blob
+ * when no card is mounted.
+ *
+ * PRIVACY: buckets hold only counts and RSSI summaries of observations
+ * that are already anonymous aggregates. Nothing stored or served is finer
+ * than one hour, coarser than the 10-minute buckets of PWK invariant III.
+ *
+ * Time is a minute counter that continues from the last persisted hour
+ * after a reboot, so unpowered gaps are collapsed. Once set_clock() has
+ * anchored it to UTC (e.g. from a GPS fix), hour indexes are Unix hours.
+ *
+ * Packed record (LEB128 varints; rssi_mean zigzag):
+ *   dhour      hours after the previous record (first record: absolute)
+ *   samples, occupied, devices_max, devices_mean, rssi_mean,
+ *   probes_max, flags
+ * HISTORY_PATH is HISTORY_MAGIC followed by records, appended in order.
+ * A sparse RAM index (every INDEX_STRIDE-th record's offset and delta
+ * base) lets query() seek to the hour it wants instead of scanning.
+ *
+ * Example usage:
+ *   rf_history::RfBucket buf[24];
+ *   uint32_t now = rf_history::current_hour();
+ *   size_t n = rf_history::query(now - 23, now, buf, 24);
+ */
+
+#ifndef SECURACV_RF_HISTORY_H
+#define SECURACV_RF_HISTORY_H
+
+#include <Arduino.h>
+#include "rf_presence.h"
+
+namespace rf_history {
+
+// ════════════════════════════════════════════════════════════════════════════
+// CONFIGURATION
+// ════════════════════════════════════════════════════════════════════════════
+
+static const size_t   HOUR_BUCKETS = 168;               // RAM: last week
+static const size_t   NVS_HOURS = 24;                   // Without SD: last day
+static const size_t   FILE_MAX_BYTES = 64 * 1024;       // ~9 months of hours
+static const size_t   RECORD_MAX_BYTES = 24;            // Worst-case packed record
+static const size_t   INDEX_ENTRIES = 256;              // Sparse file index (stride doubles when full)
+static const uint32_t INDEX_STRIDE = 32;                // Records between index entries
+static const size_t   COMPACT_STEP_RECORDS = 64;        // Records copied per maintain() call
+static const char*    HISTORY_PATH = "/RF/HOURS.BIN";
+static const char*    HISTORY_TMP_PATH = "/RF/HOURS.TMP";
+static const uint32_t HISTORY_MAGIC = 0x31484652;       // "RFH1"
+
+// ════════════════════════════════════════════════════════════════════════════
+// TYPES
+// ════════════════════════════════════════════════════════════════════════════
+
+// Bit in RfBucket::flags alongside rf_presence::POWER_FLAG_*
+static const uint8_t FLAG_BOOT = 0x80;  // First bucket after init()
+
+// One roll-up bucket (aggregates of aggregates, never identifiers)
+struct RfBucket {
+  uint32_t start;           // Hour index
+  uint16_t samples;         // Observations rolled up
+  uint16_t occupied;        // Observations with at least one device
+  uint8_t  devices_max;     // Highest device count seen
+  uint8_t  devices_mean;    // Mean device count over all samples
+  int8_t   rssi_mean;       // Mean RSSI over occupied samples
+  uint8_t  probes_max;      // Highest probe burst count
+  uint8_t  flags;           // OR of power flags, plus FLAG_BOOT
+};
+
+// ════════════════════════════════════════════════════════════════════════════
+// PUBLIC API
+// ════════════════════════════════════════════════════════════════════════════
+
+// Load persisted hours (from SD if mounted, else NVS) and resume the clock
+bool init();
+
+// Roll one observation into the open hour bucket. Never touches the card:
+// closed hours are appended by maintain().
+void add(const rf_presence::RfObservation& obs);
+
+// Background upkeep: append closed hours and, once HISTORY_PATH passes
+// FILE_MAX_BYTES, rewrite it without its oldest half, COMPACT_STEP_RECORDS
+// records per call. Call from loop().
+void maintain();
+
+// Anchor the clock to UTC; ignored if it would move time back
+void set_clock(uint32_t unix_s);
+
+uint32_t current_hour();
+
+// Hours with from <= start <= to, oldest first, including the open one.
+// Hours older than the RAM window are read from SD.
+size_t query(uint32_t from, uint32_t to, RfBucket* out, size_t cap);
+
+// Pack buckets; prev_hour is the start of the record before buckets[0].
+// Returns bytes written, or 0 if out is too small.
+size_t encode(const RfBucket* buckets, size_t count, uint32_t prev_hour,
+              uint8_t* out, size_t cap);
+
+// Unpack one record at data[*pos], advancing *pos and *prev_hour
+bool decode(const uint8_t* data, size_t len, size_t* pos, uint32_t* prev_hour,
+            RfBucket* out);
+
+} // namespace rf_history
+
+#endif // SECURACV_RF_HISTORY_H
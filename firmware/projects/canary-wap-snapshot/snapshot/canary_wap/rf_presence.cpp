@@ -20,7 +20,10 @@
 #include "rf_presence.h"
 #include "nvs_store.h"
 #include "health_log.h"
-#include <mbedtls/sha256.h>
+#include "domain_hash.h"
+#include "rf_history.h"
+#include "mem_budget.h"
+#include <atomic>
 
 // ════════════════════════════════════════════════════════════════════════════
 // SECURITY PRIMITIVES
@@ -37,6 +40,49 @@ static void secure_wipe(void* ptr, size_t len) {
   asm volatile("" ::: "memory");
 }
 
+// SipHash-2-4 keyed PRF (Aumasson & Bernstein). A handful of ARX rounds on
+// a 6-byte MAC instead of a SHA-256 compression per advertisement.
+static inline uint64_t sip_rotl(uint64_t x, int b) {
+  return (x << b) | (x >> (64 - b));
+}
+
+static inline void sip_round(uint64_t& v0, uint64_t& v1, uint64_t& v2, uint64_t& v3) {
+  v0 += v1; v1 = sip_rotl(v1, 13); v1 ^= v0; v0 = sip_rotl(v0, 32);
+  v2 += v3; v3 = sip_rotl(v3, 16); v3 ^= v2;
+  v0 += v3; v3 = sip_rotl(v3, 21); v3 ^= v0;
+  v2 += v1; v1 = sip_rotl(v1, 17); v1 ^= v2; v2 = sip_rotl(v2, 32);
+}
+
+static uint64_t siphash24(const uint64_t key[2], const uint8_t* data, size_t len) {
+  uint64_t v0 = key[0] ^ 0x736f6d6570736575ULL;
+  uint64_t v1 = key[1] ^ 0x646f72616e646f6dULL;
+  uint64_t v2 = key[0] ^ 0x6c7967656e657261ULL;
+  uint64_t v3 = key[1] ^ 0x7465646279746573ULL;
+
+  size_t full = len & ~static_cast<size_t>(7);
+  for (size_t i = 0; i < full; i += 8) {
+    uint64_t m = 0;
+    for (int j = 7; j >= 0; j--) m = (m << 8) | data[i + j];
+    v3 ^= m;
+    sip_round(v0, v1, v2, v3);
+    sip_round(v0, v1, v2, v3);
+    v0 ^= m;
+  }
+
+  uint64_t b = static_cast<uint64_t>(len) << 56;
+  for (size_t j = len - full; j > 0; j--) {
+    b |= static_cast<uint64_t>(data[full + j - 1]) << (8 * (j - 1));
+  }
+  v3 ^= b;
+  sip_round(v0, v1, v2, v3);
+  sip_round(v0, v1, v2, v3);
+  v0 ^= b;
+
+  v2 ^= 0xff;
+  for (int i = 0; i < 4; i++) sip_round(v0, v1, v2, v3);
+  return v0 ^ v1 ^ v2 ^ v3;
+}
+
 // Safe elapsed time calculation that handles millis() wrap-around
 // millis() wraps every ~49.7 days (2^32 ms)
 static inline uint32_t elapsed_ms(uint32_t start_ms, uint32_t now_ms) {
@@ -63,6 +109,11 @@ static RfEventCallback s_event_callback = nullptr;
 static uint32_t s_session_epoch = 0;
 static uint32_t s_session_start_ms = 0;
 static uint8_t s_device_secret[32] = {0};  // Per-device secret for token derivation
+static uint64_t s_session_key[2] = {0, 0};  // SipHash key for this epoch
+static bool s_session_key_ready = false;
+// Odd while the key is being replaced; radio callbacks read the key
+// seqlock-style and drop the observation if the generation moved
+static std::atomic<uint32_t> s_key_gen{0};
 
 // FSM state
 static RfState s_state = RF_EMPTY;
@@ -88,11 +139,91 @@ static float s_current_temp_c = 0.0f;
 static uint8_t s_power_flags = 0;
 
 // Session token map (ephemeral deduplication)
+// Entries are found through an open-addressing index and kept on an LRU
+// list, so a lookup and an eviction are both O(1) on average
+static const uint16_t TOKEN_NONE = 0xFFFF;
+static const size_t   TOKEN_INDEX_SIZE = SESSION_TOKEN_MAP_SIZE * 2;  // Load factor <= 0.5
+static_assert((TOKEN_INDEX_SIZE & (TOKEN_INDEX_SIZE - 1)) == 0, "Token index size must be a power of two");
+static_assert(SESSION_TOKEN_MAP_SIZE <= 255, "Active token counts are reported as uint8_t");
+
 static SessionToken s_token_map[SESSION_TOKEN_MAP_SIZE];
 static size_t s_token_count = 0;
+static uint16_t s_token_index[TOKEN_INDEX_SIZE];      // Map slot, or TOKEN_NONE
+static uint16_t s_token_prev[SESSION_TOKEN_MAP_SIZE]; // Toward most recent
+static uint16_t s_token_next[SESSION_TOKEN_MAP_SIZE]; // Toward least recent
+static uint16_t s_lru_head = TOKEN_NONE;              // Most recently seen
+static uint16_t s_lru_tail = TOKEN_NONE;              // Least recently seen
+
+// Aggregates over tokens seen within OBSERVATION_TTL_MS, kept up to date
+// on every insert, RSSI update and expiry. Active tokens are always a
+// prefix of the LRU list ending at s_active_tail.
+static const int    RSSI_BUCKETS = 128 - RSSI_NOISE_FLOOR;  // One per dBm, floor..127
+static bool     s_token_active[SESSION_TOKEN_MAP_SIZE];
+static uint16_t s_active_tail = TOKEN_NONE;           // Oldest active token
+static uint8_t  s_active_count = 0;
+static int32_t  s_active_rssi_sum = 0;
+static uint8_t  s_rssi_hist[RSSI_BUCKETS];            // Active tokens per RSSI value
+static int      s_rssi_hi = 0;                        // Highest non-empty bucket
+static int      s_rssi_lo = 0;                        // Lowest non-empty bucket
+
+// Radio ingest queues: fed from the BLE scan and WiFi promiscuous
+// callbacks, drained by update(). Each has exactly one producer task and
+// one consumer, and carries session tokens only, never MACs.
+template <typename T, size_t N>
+class SpscRing {
+  static_assert((N & (N - 1)) == 0, "ingest queue size must be a power of two");
+
+public:
+  // Producer side
+  bool push(const T& item) {
+    uint32_t head = m_head.load(std::memory_order_relaxed);
+    if (head - m_tail.load(std::memory_order_acquire) >= N) return false;
+    m_items[head & (N - 1)] = item;
+    m_head.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer side
+  bool pop(T* out) {
+    uint32_t tail = m_tail.load(std::memory_order_relaxed);
+    if (tail == m_head.load(std::memory_order_acquire)) return false;
+    *out = m_items[tail & (N - 1)];
+    m_tail.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer side: drop everything queued so far
+  void clear() {
+    m_tail.store(m_head.load(std::memory_order_acquire), std::memory_order_release);
+  }
+
+private:
+  T m_items[N];
+  std::atomic<uint32_t> m_head{0};
+  std::atomic<uint32_t> m_tail{0};
+};
+
+struct BleIngest {
+  uint32_t token;
+  uint32_t seen_ms;
+  uint32_t key_gen;         // Key generation the token was derived under
+  int8_t   rssi;
+};
+
+struct ProbeIngest {
+  int8_t rssi;
+};
+
+static SpscRing<BleIngest, INGEST_QUEUE_SIZE> s_ble_queue;
+static SpscRing<ProbeIngest, INGEST_QUEUE_SIZE> s_probe_queue;
+static std::atomic<uint32_t> s_ingest_dropped{0};
+// Set by clear_session_tokens(), which may run on any task; only the
+// consumer may move a queue's tail, so update() does the clearing
+static std::atomic<bool> s_ingest_clear{false};
 
 // Observation ring buffer
-static RfObservation s_observations[OBSERVATION_BUFFER_SIZE];
+PSRAM_BSS static RfObservation s_observations[OBSERVATION_BUFFER_SIZE];
+MEM_BUDGET_STATIC("rf_presence", s_observations);
 static size_t s_obs_head = 0;
 static size_t s_obs_count = 0;
 
@@ -136,43 +267,172 @@ static bool validate_device_secret() {
 // PRIVATE HELPERS — TOKEN DERIVATION (PRIVACY BARRIER)
 // ════════════════════════════════════════════════════════════════════════════
 
+// Derive this epoch's PRF key: the first 128 bits of
+// H("canary:session:key:v1:" || secret || epoch). The secret is only
+// hashed here, once per epoch; per-MAC work uses the derived key.
+static void rekey_session() {
+  domain_hash::Prefix prefix;
+  prefix.begin("canary:session:key:v1:", false);
+  prefix.absorb(s_device_secret, sizeof(s_device_secret));
+
+  uint8_t hash[32];
+  prefix.finish(&s_session_epoch, sizeof(s_session_epoch), hash);
+
+  s_key_gen.fetch_add(1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  memcpy(s_session_key, hash, sizeof(s_session_key));
+  s_session_key_ready = true;
+  s_key_gen.fetch_add(1, std::memory_order_release);
+
+  secure_wipe(hash, sizeof(hash));
+}
+
+static void wipe_session_key() {
+  s_key_gen.fetch_add(1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  secure_wipe(s_session_key, sizeof(s_session_key));
+  s_session_key_ready = false;
+  s_key_gen.fetch_add(1, std::memory_order_release);
+}
+
 // Derive session token from MAC address
 // INVARIANT: Token cannot be reversed to MAC
 // INVARIANT: Token is only valid within current session epoch
-// SECURITY: Uses secure wipe to prevent sensitive data leakage
+// SECURITY: The key is secret and changes every epoch, so tokens are
+// unlinkable across sessions and cannot be brute-forced back to a MAC
 static uint32_t derive_session_token(const uint8_t* mac_address) {
   // Null pointer guard - return zero token for invalid input
   if (mac_address == nullptr) {
     return 0;
   }
 
-  // Domain separation + session binding
-  uint8_t input[64];
-  memcpy(input, "canary:session:v0:", 18);
-  memcpy(input + 18, s_device_secret, 32);
-  memcpy(input + 50, &s_session_epoch, 4);
-  memcpy(input + 54, mac_address, 6);
+  // The key is set up by init() and replaced only by rotate_session();
+  // this may run in a radio callback, so never rekey here
+  if (!s_session_key_ready) {
+    return 0;
+  }
 
-  uint8_t hash[32];
-  int ret = mbedtls_sha256(input, 60, hash, 0);
+  // Fold the 64-bit PRF output to the 32-bit token
+  uint64_t out = siphash24(s_session_key, mac_address, 6);
+  uint32_t token = static_cast<uint32_t>(out) ^ static_cast<uint32_t>(out >> 32);
 
-  // Validate hash operation succeeded
-  if (ret != 0) {
-    secure_wipe(input, sizeof(input));
-    health_logging::logf(health_logging::LEVEL_ERROR, health_logging::CAT_RF,
-      "SHA256 failed with error %d", ret);
-    return 0;
+  return token;
+}
+
+// Home bucket for a token. Tokens are keyed hash output and already
+// uniform, so the low bits are used directly.
+static inline size_t token_bucket(uint32_t token) {
+  return token & (TOKEN_INDEX_SIZE - 1);
+}
+
+static void token_index_reset() {
+  memset(s_token_index, 0xFF, sizeof(s_token_index));
+  memset(s_token_prev, 0xFF, sizeof(s_token_prev));
+  memset(s_token_next, 0xFF, sizeof(s_token_next));
+  s_lru_head = TOKEN_NONE;
+  s_lru_tail = TOKEN_NONE;
+
+  memset(s_token_active, 0, sizeof(s_token_active));
+  memset(s_rssi_hist, 0, sizeof(s_rssi_hist));
+  s_active_tail = TOKEN_NONE;
+  s_active_count = 0;
+  s_active_rssi_sum = 0;
+  s_rssi_hi = 0;
+  s_rssi_lo = 0;
+}
+
+// Index position holding token, or TOKEN_INDEX_SIZE if absent
+static size_t token_index_find(uint32_t token) {
+  for (size_t pos = token_bucket(token), n = 0; n < TOKEN_INDEX_SIZE;
+       pos = (pos + 1) & (TOKEN_INDEX_SIZE - 1), n++) {
+    uint16_t slot = s_token_index[pos];
+    if (slot == TOKEN_NONE) break;
+    if (s_token_map[slot].token == token) return pos;
   }
+  return TOKEN_INDEX_SIZE;
+}
 
-  // Use first 4 bytes as token
-  uint32_t token;
-  memcpy(&token, hash, 4);
+static void token_index_insert(uint32_t token, uint16_t slot) {
+  size_t pos = token_bucket(token);
+  while (s_token_index[pos] != TOKEN_NONE) {
+    pos = (pos + 1) & (TOKEN_INDEX_SIZE - 1);
+  }
+  s_token_index[pos] = slot;
+}
 
-  // Secure wipe of sensitive data - prevents compiler optimization
-  secure_wipe(input, sizeof(input));
-  secure_wipe(hash, sizeof(hash));  // Wipe entire hash, not just partial
+// Remove the entry at pos, shifting later members of its probe run back
+// so lookups never need tombstones
+static void token_index_erase(size_t pos) {
+  size_t hole = pos;
+  size_t next = (pos + 1) & (TOKEN_INDEX_SIZE - 1);
+  while (s_token_index[next] != TOKEN_NONE) {
+    size_t home = token_bucket(s_token_map[s_token_index[next]].token);
+    // Move next into the hole unless its home lies in (hole, next]
+    bool stays = (hole <= next) ? (hole < home && home <= next)
+                                : (hole < home || home <= next);
+    if (!stays) {
+      s_token_index[hole] = s_token_index[next];
+      hole = next;
+    }
+    next = (next + 1) & (TOKEN_INDEX_SIZE - 1);
+  }
+  s_token_index[hole] = TOKEN_NONE;
+}
 
-  return token;
+static void lru_unlink(uint16_t slot) {
+  uint16_t prev = s_token_prev[slot];
+  uint16_t next = s_token_next[slot];
+  if (prev != TOKEN_NONE) s_token_next[prev] = next; else s_lru_head = next;
+  if (next != TOKEN_NONE) s_token_prev[next] = prev; else s_lru_tail = prev;
+  s_token_prev[slot] = TOKEN_NONE;
+  s_token_next[slot] = TOKEN_NONE;
+}
+
+static void lru_push_front(uint16_t slot) {
+  s_token_prev[slot] = TOKEN_NONE;
+  s_token_next[slot] = s_lru_head;
+  if (s_lru_head != TOKEN_NONE) s_token_prev[s_lru_head] = slot;
+  s_lru_head = slot;
+  if (s_lru_tail == TOKEN_NONE) s_lru_tail = slot;
+}
+
+// Callers drop readings below RSSI_NOISE_FLOOR, clamp anyway for safety
+static inline int rssi_bucket(int8_t rssi) {
+  int b = rssi - RSSI_NOISE_FLOOR;
+  return b < 0 ? 0 : b;
+}
+
+static void agg_add(int8_t rssi) {
+  int b = rssi_bucket(rssi);
+  s_rssi_hist[b]++;
+  s_active_rssi_sum += rssi;
+  if (s_active_count++ == 0) {
+    s_rssi_hi = s_rssi_lo = b;
+  } else {
+    if (b > s_rssi_hi) s_rssi_hi = b;
+    if (b < s_rssi_lo) s_rssi_lo = b;
+  }
+}
+
+// Bounds only move inward on removal, so the rescans are amortized
+static void agg_remove(int8_t rssi) {
+  int b = rssi_bucket(rssi);
+  s_rssi_hist[b]--;
+  s_active_rssi_sum -= rssi;
+  if (--s_active_count == 0) return;
+  while (s_rssi_hist[s_rssi_hi] == 0) s_rssi_hi--;
+  while (s_rssi_hist[s_rssi_lo] == 0) s_rssi_lo++;
+}
+
+// Retire tokens that have aged out, oldest first; stops at the first
+// token still inside the TTL
+static void agg_expire(uint32_t now_ms) {
+  while (s_active_tail != TOKEN_NONE &&
+         elapsed_ms(s_token_map[s_active_tail].last_seen_ms, now_ms) >= OBSERVATION_TTL_MS) {
+    agg_remove(s_token_map[s_active_tail].rssi);
+    s_token_active[s_active_tail] = false;
+    s_active_tail = s_token_prev[s_active_tail];
+  }
 }
 
 // Find or create token entry in map
@@ -184,80 +444,79 @@ static int find_or_create_token(uint32_t token, uint32_t now_ms, int8_t rssi) {
   }
 
   // Look for existing token
-  for (size_t i = 0; i < s_token_count; i++) {
-    if (s_token_map[i].token == token) {
-      s_token_map[i].last_seen_ms = now_ms;
-      s_token_map[i].rssi = rssi;
-      return static_cast<int>(i);
+  size_t pos = token_index_find(token);
+  if (pos < TOKEN_INDEX_SIZE) {
+    uint16_t slot = s_token_index[pos];
+    if (s_token_active[slot]) {
+      agg_remove(s_token_map[slot].rssi);
+      if (slot == s_active_tail && s_token_prev[slot] != TOKEN_NONE) {
+        s_active_tail = s_token_prev[slot];
+      }
+    } else {
+      s_token_active[slot] = true;
+      if (s_active_tail == TOKEN_NONE) s_active_tail = slot;
+    }
+    s_token_map[slot].last_seen_ms = now_ms;
+    s_token_map[slot].rssi = rssi;
+    agg_add(rssi);
+    if (slot != s_lru_head) {
+      lru_unlink(slot);
+      lru_push_front(slot);
     }
+    return static_cast<int>(slot);
   }
 
-  // Token not found, try to add
+  // Token not found: take a free slot, or evict the least recently seen
+  uint16_t slot;
   if (s_token_count < SESSION_TOKEN_MAP_SIZE) {
-    size_t idx = s_token_count++;
-    s_token_map[idx].token = token;
-    s_token_map[idx].last_seen_ms = now_ms;
-    s_token_map[idx].rssi = rssi;
-    return static_cast<int>(idx);
-  }
-
-  // Map full - evict oldest entry (using wrap-around safe comparison)
-  size_t oldest_idx = 0;
-  uint32_t oldest_age = 0;
-  for (size_t i = 0; i < SESSION_TOKEN_MAP_SIZE; i++) {
-    uint32_t age = elapsed_ms(s_token_map[i].last_seen_ms, now_ms);
-    if (age > oldest_age) {
-      oldest_age = age;
-      oldest_idx = i;
+    slot = static_cast<uint16_t>(s_token_count++);
+  } else {
+    slot = s_lru_tail;
+    if (s_token_active[slot]) {
+      agg_remove(s_token_map[slot].rssi);
+      s_token_active[slot] = false;
+      s_active_tail = s_token_prev[slot];
     }
-  }
+    token_index_erase(token_index_find(s_token_map[slot].token));
+    lru_unlink(slot);
 
-  // Secure wipe before reuse
-  secure_wipe(&s_token_map[oldest_idx], sizeof(SessionToken));
+    // Secure wipe before reuse
+    secure_wipe(&s_token_map[slot], sizeof(SessionToken));
+  }
 
-  s_token_map[oldest_idx].token = token;
-  s_token_map[oldest_idx].last_seen_ms = now_ms;
-  s_token_map[oldest_idx].rssi = rssi;
-  return static_cast<int>(oldest_idx);
+  s_token_map[slot].token = token;
+  s_token_map[slot].last_seen_ms = now_ms;
+  s_token_map[slot].rssi = rssi;
+  token_index_insert(token, slot);
+  lru_push_front(slot);
+  s_token_active[slot] = true;
+  if (s_active_tail == TOKEN_NONE) s_active_tail = slot;
+  agg_add(rssi);
+  return static_cast<int>(slot);
 }
 
 // Count active tokens (seen within TTL)
-// Uses wrap-around safe elapsed time calculation
 static uint8_t count_active_tokens(uint32_t now_ms) {
-  uint8_t count = 0;
-  for (size_t i = 0; i < s_token_count; i++) {
-    if (elapsed_ms(s_token_map[i].last_seen_ms, now_ms) < OBSERVATION_TTL_MS) {
-      count++;
-    }
-  }
-  return count;
+  agg_expire(now_ms);
+  return s_active_count;
 }
 
-// Calculate RSSI statistics from active tokens
-// Uses int32_t accumulator to prevent overflow when summing int8_t values
+// RSSI statistics over active tokens, read from the running aggregates
 static void calc_rssi_stats(uint32_t now_ms, int8_t* out_max, int8_t* out_mean, int8_t* out_min) {
   // Null pointer guards
   if (out_max == nullptr || out_mean == nullptr || out_min == nullptr) {
     return;
   }
 
-  int32_t sum = 0;  // Wide accumulator prevents overflow
-  int8_t max_rssi = RSSI_NOISE_FLOOR;
-  int8_t min_rssi = 0;
-  uint8_t count = 0;
-
-  for (size_t i = 0; i < s_token_count; i++) {
-    if (elapsed_ms(s_token_map[i].last_seen_ms, now_ms) < OBSERVATION_TTL_MS) {
-      sum += s_token_map[i].rssi;
-      if (s_token_map[i].rssi > max_rssi) max_rssi = s_token_map[i].rssi;
-      if (count == 0 || s_token_map[i].rssi < min_rssi) min_rssi = s_token_map[i].rssi;
-      count++;
-    }
+  agg_expire(now_ms);
+  if (s_active_count == 0) {
+    *out_max = *out_mean = *out_min = RSSI_NOISE_FLOOR;
+    return;
   }
 
-  *out_max = max_rssi;
-  *out_min = (count > 0) ? min_rssi : RSSI_NOISE_FLOOR;
-  *out_mean = (count > 0) ? static_cast<int8_t>(sum / count) : RSSI_NOISE_FLOOR;
+  *out_max = static_cast<int8_t>(s_rssi_hi + RSSI_NOISE_FLOOR);
+  *out_min = static_cast<int8_t>(s_rssi_lo + RSSI_NOISE_FLOOR);
+  *out_mean = static_cast<int8_t>(s_active_rssi_sum / s_active_count);
 }
 
 // ════════════════════════════════════════════════════════════════════════════
@@ -268,6 +527,8 @@ static void clear_session_tokens() {
   // Secure wipe all token entries to prevent memory inspection attacks
   secure_wipe(s_token_map, sizeof(s_token_map));
   s_token_count = 0;
+  token_index_reset();
+  s_ingest_clear.store(true, std::memory_order_release);
 }
 
 static void check_session_rotation(uint32_t now_ms) {
@@ -296,13 +557,16 @@ static void push_observation(const RfObservation& obs) {
 }
 
 static void evict_expired_observations(uint32_t now_ms) {
-  // Walk backwards from head, securely wipe expired entries
-  for (size_t i = 0; i < s_obs_count; i++) {
-    size_t idx = (s_obs_head + OBSERVATION_BUFFER_SIZE - 1 - i) % OBSERVATION_BUFFER_SIZE;
+  // The ring is in time order: retire from the oldest end, securely
+  // wiping each entry, and stop at the first one still inside the TTL
+  while (s_obs_count > 0) {
+    size_t idx = (s_obs_head + OBSERVATION_BUFFER_SIZE - s_obs_count) % OBSERVATION_BUFFER_SIZE;
     // Use wrap-around safe elapsed time check
-    if (elapsed_ms(s_observations[idx].timestamp_ms, now_ms) > OBSERVATION_TTL_MS) {
-      secure_wipe(&s_observations[idx], sizeof(RfObservation));
+    if (elapsed_ms(s_observations[idx].timestamp_ms, now_ms) <= OBSERVATION_TTL_MS) {
+      break;
     }
+    secure_wipe(&s_observations[idx], sizeof(RfObservation));
+    s_obs_count--;
   }
 }
 
@@ -542,6 +806,7 @@ bool init() {
   // Load session epoch
   s_session_epoch = nvs_store::get_u32("rf_epoch", 0);
   s_session_start_ms = millis();
+  rekey_session();
 
   // Load settings with validation using named bounds constants
   RfPresenceSettings stored;
@@ -566,6 +831,7 @@ bool init() {
   secure_wipe(s_token_map, sizeof(s_token_map));
   secure_wipe(s_observations, sizeof(s_observations));
   s_token_count = 0;
+  token_index_reset();
   s_obs_head = 0;
   s_obs_count = 0;
   s_state = RF_EMPTY;
@@ -585,6 +851,12 @@ bool init() {
   s_power_flags = 0;
   s_last_event = "boot";
 
+  // Long-term trend buckets (aggregates only)
+  if (!rf_history::init()) {
+    health_logging::log(health_logging::LEVEL_WARNING, health_logging::CAT_RF,
+      "RF history unavailable");
+  }
+
   s_initialized = true;
   s_enabled = s_settings.enabled;
 
@@ -599,11 +871,13 @@ void deinit() {
 
   // Secure wipe of all sensitive data
   secure_wipe(s_device_secret, sizeof(s_device_secret));
+  wipe_session_key();
   secure_wipe(s_token_map, sizeof(s_token_map));
   secure_wipe(s_observations, sizeof(s_observations));
 
   // Reset all counters
   s_token_count = 0;
+  token_index_reset();
   s_obs_head = 0;
   s_obs_count = 0;
   s_probe_burst_count = 0;
@@ -690,9 +964,59 @@ void set_event_callback(RfEventCallback cb) {
 // PUBLIC API — UPDATE
 // ════════════════════════════════════════════════════════════════════════════
 
+// Snapshot the last second into the observation ring and the history
+static void record_observation(uint32_t now_ms) {
+  RfObservation obs;
+  secure_wipe(&obs, sizeof(obs));
+  obs.timestamp_ms = now_ms;
+  obs.ble_device_count = count_active_tokens(now_ms);
+  calc_rssi_stats(now_ms, &obs.ble_rssi_max, &obs.ble_rssi_mean, &obs.ble_rssi_min);
+  obs.ble_adv_density = s_adv_count_this_second;
+  obs.wifi_probe_count = s_probe_burst_count;
+  obs.wifi_rssi_peak = s_probe_rssi_peak;
+  float delta = (s_current_temp_c - s_last_temp_c) * 10.0f;
+  obs.temp_delta_c = static_cast<int8_t>(delta > 127.0f ? 127.0f : (delta < -127.0f ? -127.0f : delta));
+  obs.power_flags = s_power_flags;
+
+  push_observation(obs);
+  rf_history::add(obs);
+}
+
+// Apply queued radio observations in arrival order
+static void drain_ingest_queues() {
+  if (s_ingest_clear.exchange(false, std::memory_order_acq_rel)) {
+    s_ble_queue.clear();
+    s_probe_queue.clear();
+  }
+
+  uint32_t gen = s_key_gen.load(std::memory_order_acquire);
+
+  BleIngest ble;
+  while (s_ble_queue.pop(&ble)) {
+    // Tokens from before the last rotation belong to a wiped epoch
+    if (ble.key_gen != gen) continue;
+
+    // Update token map (contains only ephemeral tokens, no MAC)
+    find_or_create_token(ble.token, ble.seen_ms, ble.rssi);
+
+    // Update advertising density counter
+    s_adv_count_this_second++;
+  }
+
+  ProbeIngest probe;
+  while (s_probe_queue.pop(&probe)) {
+    if (s_probe_burst_count < UINT8_MAX) s_probe_burst_count++;
+    if (probe.rssi > s_probe_rssi_peak) {
+      s_probe_rssi_peak = probe.rssi;
+    }
+  }
+}
+
 void update() {
   if (!s_initialized || !s_enabled) return;
 
+  drain_ingest_queues();
+
   uint32_t now_ms = millis();
 
   // Check for session rotation
@@ -708,12 +1032,17 @@ void update() {
   // Run FSM
   fsm_tick(now_ms);
 
-  // Reset per-second counters
+  // Once per second: record the aggregate observation, then reset the
+  // per-second counters
   uint32_t current_second = now_ms / 1000;
   if (current_second != s_last_adv_second) {
+    record_observation(now_ms);
     s_adv_count_this_second = 0;
     s_last_adv_second = current_second;
   }
+
+  // History file compaction, a bounded slice per call
+  rf_history::maintain();
 }
 
 void rotate_session() {
@@ -722,6 +1051,7 @@ void rotate_session() {
   s_session_epoch++;
   s_session_start_ms = now_ms;
   nvs_store::set_u32("rf_epoch", s_session_epoch);
+  rekey_session();
 
   // Clear all tokens - they're now invalid for privacy
   clear_session_tokens();
@@ -757,18 +1087,30 @@ void feed_ble_scan(const uint8_t* mac_address, int8_t rssi, bool connectable) {
   if (!s_initialized || !s_enabled) return;
   if (rssi < RSSI_NOISE_FLOOR) return;  // Ignore noise
 
-  uint32_t now_ms = millis();
+  // Skip while rotate_session() is replacing the key
+  uint32_t gen = s_key_gen.load(std::memory_order_acquire);
+  if (gen & 1) {
+    s_ingest_dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
 
   // === PRIVACY BARRIER ===
   // MAC address is used ONLY here to derive token, never stored
   uint32_t token = derive_session_token(mac_address);
   // mac_address is NOT passed beyond this point
 
-  // Update token map (contains only ephemeral tokens, no MAC)
-  find_or_create_token(token, now_ms, rssi);
+  // A key change during derivation may have torn the key: drop the token
+  std::atomic_thread_fence(std::memory_order_acquire);
+  if (s_key_gen.load(std::memory_order_relaxed) != gen || token == 0) {
+    s_ingest_dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
 
-  // Update advertising density counter
-  s_adv_count_this_second++;
+  // Hand the token to update() (queue holds only ephemeral tokens, no MAC)
+  BleIngest item = { token, millis(), gen, rssi };
+  if (!s_ble_queue.push(item)) {
+    s_ingest_dropped.fetch_add(1, std::memory_order_relaxed);
+  }
 }
 
 void feed_wifi_probe(const uint8_t* mac_address, int8_t rssi) {
@@ -779,12 +1121,23 @@ void feed_wifi_probe(const uint8_t* mac_address, int8_t rssi) {
   // MAC used only for burst detection, not stored
   // We don't even derive a token for WiFi - just count bursts
 
-  s_probe_burst_count++;
-  if (rssi > s_probe_rssi_peak) {
-    s_probe_rssi_peak = rssi;
+  ProbeIngest item = { rssi };
+  if (!s_probe_queue.push(item)) {
+    s_ingest_dropped.fetch_add(1, std::memory_order_relaxed);
   }
 
-  // Decay probe count over time (in update())
+  // Counted in update(), decayed over time there too
+}
+
+void feed_probe_window(uint8_t probe_count, int8_t rssi_peak) {
+  if (!s_initialized || !s_enabled || probe_count == 0) return;
+
+  // Counts only: the capture window never read a source address
+  uint16_t total = s_probe_burst_count + probe_count;
+  s_probe_burst_count = total > UINT8_MAX ? UINT8_MAX : total;
+  if (rssi_peak > s_probe_rssi_peak) {
+    s_probe_rssi_peak = rssi_peak;
+  }
 }
 
 void feed_temperature(float temp_celsius) {
@@ -933,4 +1286,8 @@ uint32_t get_session_epoch() {
   return s_session_epoch;
 }
 
+uint32_t get_ingest_dropped() {
+  return s_ingest_dropped.load(std::memory_order_relaxed);
+}
+
 } // namespace rf_presence
@@ -31,7 +31,8 @@ namespace rf_presence {
 static const uint32_t SESSION_ROTATE_MS = 4 * 60 * 60 * 1000;  // 4 hours
 static const uint32_t OBSERVATION_TTL_MS = 60 * 1000;          // 60 seconds
 static const size_t   OBSERVATION_BUFFER_SIZE = 64;
-static const size_t   SESSION_TOKEN_MAP_SIZE = 32;
+static const size_t   SESSION_TOKEN_MAP_SIZE = 128;          // Hashed, LRU-evicted
+static const size_t   INGEST_QUEUE_SIZE = 128;               // Per radio, power of two
 
 // FSM timing thresholds (milliseconds)
 static const uint32_t IMPULSE_TIMEOUT_MS = 5000;       // Max impulse duration
@@ -204,9 +205,12 @@ bool set_settings(const RfPresenceSettings& settings);
 void set_event_callback(RfEventCallback cb);
 
 // Update (call from loop)
-// This processes raw BLE/WiFi scans through the privacy barrier
+// Drains the radio ingest queues and runs the FSM
 void update();
 
+// Radio observations lost to a full ingest queue since init()
+uint32_t get_ingest_dropped();
+
 // Manual session rotation (for testing/privacy)
 void rotate_session();
 
@@ -216,12 +220,19 @@ void rotate_session();
 
 // Feed raw BLE scan result through privacy barrier
 // IMPORTANT: mac_address is used ONLY to derive session token, never stored
+// Safe to call from the scan callback: derives the token, queues it for
+// update() and returns without locking
 void feed_ble_scan(const uint8_t* mac_address, int8_t rssi, bool connectable);
 
 // Feed WiFi probe detection through privacy barrier
 // IMPORTANT: mac_address is used ONLY for dedup, never stored
+// Safe to call from the promiscuous callback; queued like feed_ble_scan()
 void feed_wifi_probe(const uint8_t* mac_address, int8_t rssi);
 
+// Feed one probe_capture window: probe requests counted and their peak
+// RSSI. Applied directly, so call from the task that runs update().
+void feed_probe_window(uint8_t probe_count, int8_t rssi_peak);
+
 // Feed environmental signals
 void feed_temperature(float temp_celsius);
 void feed_power_event(uint8_t flags);  // See POWER_FLAG_* constants
@@ -12,8 +12,12 @@
 #define SECURACV_RF_PRESENCE_API_H
 
 #include "esp_http_server.h"
+#include "rate_limiter.h"
 #include "rf_presence.h"
+#include "rf_history.h"
+#include "probe_capture.h"
 #include <ArduinoJson.h>
+#include "response_pool.h"
 #include <cstring>  // for strcmp
 
 namespace rf_presence_api {
@@ -29,7 +33,7 @@ static inline esp_err_t send_json_response(httpd_req_t* req, const char* json) {
 }
 
 static inline esp_err_t send_success(httpd_req_t* req, const char* message = nullptr) {
-  StaticJsonDocument<128> doc;
+  response_pool::PooledJsonDocument doc;
   doc["success"] = true;
   if (message) doc["message"] = message;
 
@@ -39,7 +43,7 @@ static inline esp_err_t send_success(httpd_req_t* req, const char* message = nul
 }
 
 static inline esp_err_t send_error(httpd_req_t* req, const char* error) {
-  StaticJsonDocument<128> doc;
+  response_pool::PooledJsonDocument doc;
   doc["success"] = false;
   doc["error"] = error;
 
@@ -58,7 +62,7 @@ static inline esp_err_t send_error(httpd_req_t* req, const char* error) {
 inline esp_err_t handle_rf_status(httpd_req_t* req) {
   rf_presence::RfStateSnapshot snapshot = rf_presence::get_snapshot();
 
-  StaticJsonDocument<512> doc;
+  response_pool::PooledJsonDocument doc;
 
   // State information
   doc["state"] = snapshot.state_name;
@@ -84,6 +88,14 @@ inline esp_err_t handle_rf_status(httpd_req_t* req) {
   // Session info (for privacy verification)
   doc["session_epoch"] = rf_presence::get_session_epoch();
 
+  // WiFi probe sniffing duty cycle (counts only)
+  probe_capture::CaptureStats capture = probe_capture::get_stats();
+  JsonObject probes = doc.createNestedObject("probe_capture");
+  probes["running"] = capture.running;
+  probes["duty_pct"] = capture.period_ms ? capture.window_ms * 100 / capture.period_ms : 0;
+  probes["windows"] = capture.windows;
+  probes["probe_requests"] = capture.probe_requests;
+
   char buffer[512];
   serializeJson(doc, buffer);
   return send_json_response(req, buffer);
@@ -107,7 +119,7 @@ inline esp_err_t handle_rf_disable(httpd_req_t* req) {
 inline esp_err_t handle_rf_rotate(httpd_req_t* req) {
   rf_presence::rotate_session();
 
-  StaticJsonDocument<128> doc;
+  response_pool::PooledJsonDocument doc;
   doc["success"] = true;
   doc["message"] = "Session rotated";
   doc["new_epoch"] = rf_presence::get_session_epoch();
@@ -121,7 +133,7 @@ inline esp_err_t handle_rf_rotate(httpd_req_t* req) {
 inline esp_err_t handle_rf_settings_get(httpd_req_t* req) {
   rf_presence::RfPresenceSettings settings = rf_presence::get_settings();
 
-  StaticJsonDocument<256> doc;
+  response_pool::PooledJsonDocument doc;
   doc["enabled"] = settings.enabled;
   doc["presence_threshold_sec"] = settings.presence_threshold_ms / 1000;
   doc["dwell_threshold_sec"] = settings.dwell_threshold_ms / 1000;
@@ -156,7 +168,7 @@ inline esp_err_t handle_rf_settings_set(httpd_req_t* req) {
   }
   content[content_len] = '\0';
 
-  StaticJsonDocument<256> input;
+  response_pool::PooledJsonDocument input;
   DeserializationError json_err = deserializeJson(input, content);
   if (json_err != DeserializationError::Ok) {
     return send_error(req, "Invalid JSON");
@@ -237,7 +249,7 @@ inline esp_err_t handle_rf_conformance(httpd_req_t* req) {
     }
   }
 
-  StaticJsonDocument<384> doc;
+  response_pool::PooledJsonDocument doc;
 
   doc["no_mac_storage"] = rf_presence::conformance_check_no_mac_storage();
   doc["aggregate_only"] = rf_presence::conformance_check_aggregate_only();
@@ -265,6 +277,59 @@ inline esp_err_t handle_rf_conformance(httpd_req_t* req) {
   return send_json_response(req, buffer);
 }
 
+// GET /api/rf/history?from=N&to=N - Hourly trend buckets
+// from/to are hour indexes; default is the last 24 hours. Nothing finer
+// than an hour is served (PWK invariant III allows 10-minute buckets).
+// Streams a JSON array in chunks, RF_HISTORY_PAGE buckets at a time.
+// Returns only roll-ups of aggregate counts and RSSI, never identifiers.
+static const size_t RF_HISTORY_PAGE = 24;
+
+inline esp_err_t handle_rf_history(httpd_req_t* req) {
+  uint32_t to = rf_history::current_hour();
+  uint32_t from = 0;
+  bool have_from = false;
+
+  char query_buf[96] = {0};
+  if (httpd_req_get_url_query_str(req, query_buf, sizeof(query_buf)) == ESP_OK) {
+    char val[16] = {0};
+    if (httpd_query_key_value(query_buf, "to", val, sizeof(val)) == ESP_OK) {
+      to = strtoul(val, nullptr, 10);
+    }
+    if (httpd_query_key_value(query_buf, "from", val, sizeof(val)) == ESP_OK) {
+      from = strtoul(val, nullptr, 10);
+      have_from = true;
+    }
+  }
+  if (!have_from) from = to >= RF_HISTORY_PAGE - 1 ? to - (RF_HISTORY_PAGE - 1) : 0;
+
+  httpd_resp_set_type(req, "application/json");
+  httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+
+  char line[192];
+  if (httpd_resp_sendstr_chunk(req, "{\"tier\":\"hour\",\"buckets\":[") != ESP_OK) return ESP_FAIL;
+
+  rf_history::RfBucket page[RF_HISTORY_PAGE];
+  bool first = true;
+  while (from <= to) {
+    size_t n = rf_history::query(from, to, page, RF_HISTORY_PAGE);
+    for (size_t i = 0; i < n; i++) {
+      const rf_history::RfBucket& b = page[i];
+      snprintf(line, sizeof(line),
+               "%s{\"start\":%u,\"samples\":%u,\"occupied\":%u,\"devices_max\":%u,"
+               "\"devices_mean\":%u,\"rssi_mean\":%d,\"probes_max\":%u,\"flags\":%u}",
+               first ? "" : ",", (unsigned)b.start, b.samples, b.occupied, b.devices_max,
+               b.devices_mean, b.rssi_mean, b.probes_max, b.flags);
+      if (httpd_resp_sendstr_chunk(req, line) != ESP_OK) return ESP_FAIL;
+      first = false;
+    }
+    if (n < RF_HISTORY_PAGE || page[n - 1].start >= to) break;
+    from = page[n - 1].start + 1;
+  }
+
+  if (httpd_resp_sendstr_chunk(req, "]}") != ESP_OK) return ESP_FAIL;
+  return httpd_resp_sendstr_chunk(req, nullptr);
+}
+
 // ════════════════════════════════════════════════════════════════════════════
 // ROUTE REGISTRATION
 // ════════════════════════════════════════════════════════════════════════════
@@ -273,7 +338,7 @@ static inline void register_api_handler(httpd_handle_t server, const char* uri,
                                         httpd_method_t method,
                                         esp_err_t (*handler)(httpd_req_t*)) {
   httpd_uri_t route = { .uri = uri, .method = method, .handler = handler, .user_ctx = nullptr };
-  httpd_register_uri_handler(server, &route);
+  rate_limiter::register_uri_handler(server, &route);
 }
 
 // Call this to register all RF Presence API routes with the HTTP server
@@ -282,6 +347,7 @@ inline void register_routes(httpd_handle_t server) {
   register_api_handler(server, "/api/rf/status", HTTP_GET, handle_rf_status);
   register_api_handler(server, "/api/rf/settings", HTTP_GET, handle_rf_settings_get);
   register_api_handler(server, "/api/rf/conformance", HTTP_GET, handle_rf_conformance);
+  register_api_handler(server, "/api/rf/history", HTTP_GET, handle_rf_history);
 
   // POST endpoints
   register_api_handler(server, "/api/rf/enable", HTTP_POST, handle_rf_enable);
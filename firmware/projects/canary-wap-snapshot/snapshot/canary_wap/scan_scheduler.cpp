@@ -0,0 +1,175 @@
+/*
+ * SecuraCV Canary — BLE Scan Duty-Cycle Scheduler Implementation
+ */
+
+#include "scan_scheduler.h"
+#include "bluetooth_channel.h"
+#include "radio_scheduler.h"
+#include "rf_presence.h"
+#include <WiFi.h>
+
+namespace scan_scheduler {
+
+// ════════════════════════════════════════════════════════════════════════════
+// PRIVATE STATE
+// ════════════════════════════════════════════════════════════════════════════
+
+static bool s_initialized = false;
+static uint32_t s_last_eval_ms = 0;
+
+static ScanLevel s_level = LEVEL_OFF;
+static bluetooth_channel::ScanParams s_params = { 0, 0, false };
+static bool s_ap_busy = false;
+static bool s_mesh_busy = false;
+
+static rf_presence::RfState s_last_rf_state = rf_presence::RF_EMPTY;
+static uint32_t s_last_change_ms = 0;
+static uint32_t s_last_frames = 0;
+
+static uint32_t s_level_ms[LEVEL_COUNT];
+static uint64_t s_duty_time = 0;       // Sum of duty_pct * elapsed_ms
+static uint32_t s_profile_changes = 0;
+
+// ════════════════════════════════════════════════════════════════════════════
+// PRIVATE HELPERS
+// ════════════════════════════════════════════════════════════════════════════
+
+static uint32_t mesh_frames_sent() {
+  return radio_scheduler::get_slot_stats(radio_scheduler::SLOT_MESH).frames_sent +
+         radio_scheduler::get_slot_stats(radio_scheduler::SLOT_CHIRP).frames_sent;
+}
+
+static ScanLevel choose_level(uint32_t now_ms) {
+  if (!rf_presence::is_enabled()) return LEVEL_OFF;
+
+  rf_presence::RfState state = rf_presence::get_state();
+  if (state != s_last_rf_state) {
+    s_last_rf_state = state;
+    s_last_change_ms = now_ms;
+  }
+
+  if (state == rf_presence::RF_IMPULSE || state == rf_presence::RF_DEPARTING) {
+    return LEVEL_TRANSITION;
+  }
+  if (s_last_change_ms != 0 && now_ms - s_last_change_ms < TRANSITION_HOLD_MS) {
+    return LEVEL_TRANSITION;
+  }
+  return state == rf_presence::RF_EMPTY ? LEVEL_QUIET : LEVEL_OCCUPIED;
+}
+
+static bluetooth_channel::ScanParams profile_for(ScanLevel level) {
+  bluetooth_channel::ScanParams p = { 0, 0, false };
+  switch (level) {
+    case LEVEL_QUIET:
+      p.interval_ms = QUIET_INTERVAL_MS;
+      p.window_ms = QUIET_WINDOW_MS;
+      break;
+    case LEVEL_OCCUPIED:
+      p.interval_ms = OCCUPIED_INTERVAL_MS;
+      p.window_ms = OCCUPIED_WINDOW_MS;
+      break;
+    case LEVEL_TRANSITION:
+      p.interval_ms = TRANSITION_INTERVAL_MS;
+      p.window_ms = TRANSITION_WINDOW_MS;
+      p.active = !s_ap_busy;
+      break;
+    default:
+      return p;
+  }
+
+  if (s_ap_busy) p.window_ms /= 2;
+  if (s_mesh_busy) p.window_ms /= 2;
+  if (p.window_ms < MIN_WINDOW_MS) p.window_ms = MIN_WINDOW_MS;
+  return p;
+}
+
+static uint8_t duty_pct(const bluetooth_channel::ScanParams& p) {
+  return p.interval_ms ? (uint8_t)(p.window_ms * 100 / p.interval_ms) : 0;
+}
+
+static void evaluate(uint32_t now_ms, uint32_t elapsed_ms) {
+  // Account the profile that ran since the last evaluation
+  s_level_ms[s_level] += elapsed_ms;
+  s_duty_time += (uint64_t)duty_pct(s_params) * elapsed_ms;
+
+  uint32_t frames = mesh_frames_sent();
+  s_mesh_busy = elapsed_ms > 0 &&
+                (frames - s_last_frames) * 1000 > BUSY_FRAMES_PER_SEC * elapsed_ms;
+  s_last_frames = frames;
+  s_ap_busy = WiFi.softAPgetStationNum() > 0;
+
+  ScanLevel level = choose_level(now_ms);
+  bluetooth_channel::ScanParams p = profile_for(level);
+  bool changed = level != s_level ||
+                 p.interval_ms != s_params.interval_ms ||
+                 p.window_ms != s_params.window_ms ||
+                 p.active != s_params.active;
+  if (!changed) return;
+
+  s_level = level;
+  s_params = p;
+  s_profile_changes++;
+  bluetooth_channel::set_presence_scan(level != LEVEL_OFF, p);
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// PUBLIC API
+// ════════════════════════════════════════════════════════════════════════════
+
+bool init() {
+  if (!bluetooth_channel::is_initialized()) return false;
+  memset(s_level_ms, 0, sizeof(s_level_ms));
+  s_duty_time = 0;
+  s_profile_changes = 0;
+  s_level = LEVEL_OFF;
+  s_params = { 0, 0, false };
+  s_last_frames = mesh_frames_sent();
+  s_last_eval_ms = millis();
+  s_initialized = true;
+  evaluate(s_last_eval_ms, 0);
+  return true;
+}
+
+void update() {
+  if (!s_initialized) return;
+  uint32_t now_ms = millis();
+  uint32_t elapsed = now_ms - s_last_eval_ms;
+  if (elapsed < EVAL_INTERVAL_MS) return;
+  s_last_eval_ms = now_ms;
+  evaluate(now_ms, elapsed);
+}
+
+ScanSchedulerStats get_stats() {
+  ScanSchedulerStats st = {};
+  st.level = s_level;
+  st.interval_ms = s_params.interval_ms;
+  st.window_ms = s_params.window_ms;
+  st.active = s_params.active;
+  st.duty_pct = duty_pct(s_params);
+
+  // OFF time counts as zero duty
+  uint64_t total_ms = 0;
+  for (uint8_t i = 0; i < LEVEL_COUNT; i++) {
+    st.level_ms[i] = s_level_ms[i];
+    total_ms += s_level_ms[i];
+  }
+  if (total_ms > 0) st.avg_duty_pct = (uint8_t)(s_duty_time / total_ms);
+
+  st.ap_busy = s_ap_busy;
+  st.mesh_busy = s_mesh_busy;
+  st.profile_changes = s_profile_changes;
+  st.results = bluetooth_channel::get_presence_scan_results();
+  return st;
+}
+
+const char* level_name(ScanLevel level) {
+  switch (level) {
+    case LEVEL_OFF:        return "off";
+    case LEVEL_QUIET:      return "quiet";
+    case LEVEL_OCCUPIED:   return "occupied";
+    case LEVEL_TRANSITION: return "transition";
+    default:               return "unknown";
+  }
+}
+
+} // namespace scan_scheduler
@@ -0,0 +1,94 @@
+/*
+ * SecuraCV Canary — BLE Scan Duty-Cycle Scheduler
+ *
+ * The ESP32-S3 shares one 2.4 GHz front end between WiFi and BLE, and
+ * every millisecond of scan window is time the soft-AP and ESP-NOW cannot
+ * receive. A fixed duty cycle is either too costly when nothing is
+ * happening or too coarse when someone arrives. This module paces the
+ * background presence scan in bluetooth_channel from what rf_presence is
+ * seeing and how busy the radio is.
+ *
+ * Levels, chosen every EVAL_INTERVAL_MS from the presence state:
+ *   TRANSITION  RF_IMPULSE / RF_DEPARTING, or within TRANSITION_HOLD_MS of
+ *               any state change. Dense scanning to confirm arrivals and
+ *               departures quickly.
+ *   OCCUPIED    RF_PRESENCE / RF_DWELLING. Enough to track the count.
+ *   QUIET       RF_EMPTY. Sparse scanning to notice the next arrival.
+ *
+ * Coexistence: the level's window is halved while the AP has stations, and
+ * halved again while mesh and chirp traffic is above BUSY_FRAMES_PER_SEC.
+ * Active scanning (scan requests add TX airtime) is used only in
+ * TRANSITION with no AP stations; otherwise the scan is passive.
+ *
+ * The scanner is restarted only when the resulting profile changes.
+ *
+ * Example usage:
+ *   scan_scheduler::init();      // after bluetooth_channel::init()
+ *   loop() { scan_scheduler::update(); }
+ */
+
+#ifndef SECURACV_SCAN_SCHEDULER_H
+#define SECURACV_SCAN_SCHEDULER_H
+
+#include <Arduino.h>
+
+namespace scan_scheduler {
+
+// ════════════════════════════════════════════════════════════════════════════
+// CONFIGURATION
+// ════════════════════════════════════════════════════════════════════════════
+
+static const uint32_t EVAL_INTERVAL_MS = 2000;
+static const uint32_t TRANSITION_HOLD_MS = 20000;   // Dense scan after a change
+static const uint32_t BUSY_FRAMES_PER_SEC = 4;      // Mesh + chirp TX rate
+static const uint16_t MIN_WINDOW_MS = 12;
+
+// Interval / window per level (duty = window / interval)
+static const uint16_t QUIET_INTERVAL_MS = 1280;     // 5%
+static const uint16_t QUIET_WINDOW_MS = 64;
+static const uint16_t OCCUPIED_INTERVAL_MS = 320;   // 15%
+static const uint16_t OCCUPIED_WINDOW_MS = 48;
+static const uint16_t TRANSITION_INTERVAL_MS = 100; // 90%
+static const uint16_t TRANSITION_WINDOW_MS = 90;
+
+// ════════════════════════════════════════════════════════════════════════════
+// TYPES
+// ════════════════════════════════════════════════════════════════════════════
+
+enum ScanLevel : uint8_t {
+  LEVEL_OFF = 0,      // rf_presence disabled; no background scan
+  LEVEL_QUIET,
+  LEVEL_OCCUPIED,
+  LEVEL_TRANSITION,
+  LEVEL_COUNT
+};
+
+struct ScanSchedulerStats {
+  ScanLevel level;
+  uint16_t  interval_ms;
+  uint16_t  window_ms;
+  bool      active;
+  uint8_t   duty_pct;               // Current window / interval
+  uint8_t   avg_duty_pct;           // Time-weighted since init
+  bool      ap_busy;                // AP has stations
+  bool      mesh_busy;              // Mesh + chirp above BUSY_FRAMES_PER_SEC
+  uint32_t  level_ms[LEVEL_COUNT];  // Time spent at each level
+  uint32_t  profile_changes;        // Scanner restarts
+  uint32_t  results;                // Advertisements fed to rf_presence
+};
+
+// ════════════════════════════════════════════════════════════════════════════
+// PUBLIC API
+// ════════════════════════════════════════════════════════════════════════════
+
+bool init();
+
+// Re-evaluate the duty cycle (call from loop)
+void update();
+
+ScanSchedulerStats get_stats();
+const char* level_name(ScanLevel level);
+
+} // namespace scan_scheduler
+
+#endif // SECURACV_SCAN_SCHEDULER_H
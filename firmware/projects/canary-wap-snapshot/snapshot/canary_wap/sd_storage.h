@@ -9,13 +9,14 @@
  * Storage Layout:
  * /sd/
  * ├── WITNESS/           # Witness records (immutable)
- * │   ├── 2026-01-31.wit # Daily witness log (CBOR + signature)
- * │   └── INDEX.idx      # Quick lookup index
+ * │   ├── 00000000.WIT   # Segment: seq [0, WITNESS_SEGMENT_RECORDS)
+ * │   └── 00000000.IDX   # Sparse seq->offset index for the segment
  * ├── HEALTH/            # Health/diagnostic logs
  * │   ├── 2026-01-31.log # Daily health log (JSON lines)
- * │   └── ACK.json       # Acknowledgment status
+ * │   └── ACK.IDX        # Acknowledgment slots, addressed by log seq
  * ├── CHAIN/             # Chain state backup
- * │   └── state.bin      # Chain head + sequence (redundant to NVS)
+ * │   ├── state.bin      # Chain head + sequence (redundant to NVS)
+ * │   └── COUNTS.DAT     # Record/log/unacked counter checkpoint
  * └── EXPORT/            # Export staging area
  *     └── bundle.json    # PWK-compatible export bundle
  */
@@ -57,6 +58,44 @@ static const size_t MAX_LOG_FILE_SIZE = 1024 * 1024;  // 1 MB per file
 static const size_t MAX_HEALTH_ENTRIES = 10000;       // Max entries per day
 static const size_t MAX_WITNESS_ENTRIES = 86400;      // Max records per day (1/sec)
 
+// Witness log segments: fixed-size headers + payload, one sparse index
+// entry per stride so reads by seq never scan a whole day
+static const uint32_t WITNESS_SEGMENT_RECORDS = 4096;
+static const uint32_t WITNESS_INDEX_STRIDE = 64;
+static const uint32_t WITNESS_LOG_MAGIC = 0x57495431;  // "WIT1"
+
+// Acknowledgments: ACK.IDX is an array of fixed-size AckRecord slots, and
+// log seq S lives at (S % ACK_INDEX_SLOTS) * sizeof(AckRecord). An ack is
+// one positioned write and a lookup one positioned read; a slot whose
+// log_seq differs from S belongs to an older generation and means "unread".
+static const uint32_t ACK_INDEX_SLOTS = 4096;
+
+// Counters: witness, health and unacknowledged counts are kept in RAM and
+// updated by append_*() and acknowledge_log(), so get_status() and the
+// count_*() totals need no SD I/O. COUNTS.DAT holds two alternating
+// StorageCounts slots, saved every COUNTS_SAVE_MS while the counts change.
+// At boot the checkpoint is checked against the last record it counted,
+// and only what follows that record is counted. The whole card is rescanned
+// only if the checkpoint is missing or no longer matches.
+static const char* COUNTS_PATH = "/sd/CHAIN/COUNTS.DAT";
+static const uint32_t COUNTS_MAGIC = 0x434E5431;  // "CNT1"
+static const uint32_t COUNTS_SAVE_MS = 60000;
+
+// Retention: a low-priority task runs retention_step() every
+// RETAIN_INTERVAL_MS. Each step deletes at most one file, oldest date
+// first, and only once that file is past RETAIN_MAX_AGE_DAYS, the dated
+// logs are over RETAIN_MAX_BYTES, or the card has less than
+// RETAIN_FREE_BYTES free. Health logs go before witness files of the same
+// date, and today's files are never deleted. A step that must count a
+// witness file's records first does so RETAIN_STEP_MS at a time and
+// resumes on the next step, so the counters stay exact and no step holds
+// the card for long.
+static const uint32_t RETAIN_MAX_AGE_DAYS = 90;
+static const uint64_t RETAIN_MAX_BYTES = 0;                     // 0 = card size only
+static const uint64_t RETAIN_FREE_BYTES = 64ULL * 1024 * 1024;
+static const uint32_t RETAIN_INTERVAL_MS = 1000;
+static const uint32_t RETAIN_STEP_MS = 20;
+
 // ════════════════════════════════════════════════════════════════════════════
 // TYPES
 // ════════════════════════════════════════════════════════════════════════════
@@ -73,6 +112,7 @@ struct SDStatus {
   uint32_t last_write_ms;
   uint32_t write_errors;
   uint32_t read_errors;
+  uint32_t files_pruned;    // Deleted by retention since init()
 };
 
 struct HealthLogEntry {
@@ -101,6 +141,26 @@ struct ChainState {
   uint32_t checksum;
 };
 
+struct StorageCounts {
+  uint32_t magic;
+  uint32_t generation;      // Higher valid slot is current
+  uint32_t witness_count;
+  uint32_t witness_seq;     // Last record counted (0 = none)
+  uint32_t witness_off;     // Its offset in its segment
+  uint32_t health_count;
+  uint32_t health_seq;      // Last log entry counted
+  uint32_t unacked_count;   // Entries needing attention, net of acks
+  uint32_t crc;             // CRC32 over all preceding bytes
+};
+
+struct RetentionStatus {
+  bool pending;             // A file is over quota and not yet deleted
+  uint32_t files_deleted;
+  uint64_t bytes_freed;
+  uint32_t last_step_ms;    // Card time used by the last step
+  char oldest_date[11];     // YYYY-MM-DD of the oldest file kept ("" = none)
+};
+
 struct AckRecord {
   uint32_t log_seq;
   uint32_t ack_timestamp_ms;
@@ -129,6 +189,12 @@ bool append_witness_record(const uint8_t* cbor_payload, size_t payload_len,
 bool read_witness_records(const char* date, 
                           void (*callback)(const WitnessLogEntry&, const uint8_t* payload, void* ctx),
                           void* ctx, uint32_t start_seq = 0, uint32_t limit = 100);
+bool read_witness_by_seq(uint32_t seq, WitnessLogEntry* entry_out,
+                         uint8_t* payload_out, size_t payload_cap);
+uint32_t export_witness_range(uint32_t start_seq, uint32_t end_seq,
+                              bool (*callback)(const WitnessLogEntry&, const uint8_t* payload, void* ctx),
+                              void* ctx, uint32_t limit = 0);
+// All dates: O(1) from the counters. A specific date scans that day only.
 uint32_t count_witness_records(const char* date = nullptr);
 
 // Health log storage (append-only with acknowledgment)
@@ -138,20 +204,47 @@ bool read_health_logs(const char* date,
                       void (*callback)(const HealthLogEntry&, void* ctx),
                       void* ctx, uint32_t start_seq = 0, uint32_t limit = 100);
 bool acknowledge_log(uint32_t log_seq, AckStatus new_status, const char* reason);
+AckStatus get_log_ack_status(uint32_t log_seq);
+// The default arguments are answered from the counters; others scan
 uint32_t count_health_logs(const char* date = nullptr, LogLevel min_level = LOG_LEVEL_DEBUG);
 uint32_t count_unacknowledged(LogLevel min_level = LOG_LEVEL_WARNING);
 
+// Write the counter checkpoint now (before a deliberate restart)
+bool save_counters();
+
 // Chain state persistence (redundant backup to NVS)
 bool save_chain_state(const uint8_t* chain_head, uint32_t seq, uint32_t boot_count);
 bool load_chain_state(uint8_t* chain_head_out, uint32_t* seq_out, uint32_t* boot_count_out);
 
 // Export functionality
+// Staged: writes the whole bundle to output_path first (needs free space
+// equal to the export). Prefer stream_export_bundle().
 bool create_export_bundle(const char* output_path, const char* start_date, const char* end_date);
+
+// Assemble the bundle (manifest, chain state, witness segments, health
+// logs) into write() as it is read, e.g. httpd_resp_send_chunk(). Nothing
+// is staged on the card. sha256_out receives the hash of every byte
+// written. Returns false if write() failed or the card could not be read.
+typedef bool (*ExportWriteFn)(const uint8_t* data, size_t len, void* ctx);
+bool stream_export_bundle(const char* start_date, const char* end_date,
+                          ExportWriteFn write, void* ctx, uint8_t sha256_out[32]);
 bool list_available_dates(void (*callback)(const char* date, uint32_t witness_count, 
                                            uint32_t health_count, void* ctx), void* ctx);
 
 // Maintenance
+// Synchronous: deletes every expired file in one call and can block for
+// seconds on a slow card. Kept for tools; the device uses retention_step().
 bool rotate_old_logs(uint32_t max_age_days);
+
+// One retention step within budget_ms of card time (see RETAIN_*). Returns
+// true while more files are over quota.
+bool retention_step(uint32_t budget_ms = RETAIN_STEP_MS);
+// Run retention_step() every RETAIN_INTERVAL_MS on a priority-1 task
+bool start_retention_task();
+RetentionStatus get_retention_status();
+
+// Sampled once by init(), then adjusted by every append and retention
+// delete; neither call scans the filesystem
 uint64_t get_storage_used();
 uint64_t get_storage_free();
 
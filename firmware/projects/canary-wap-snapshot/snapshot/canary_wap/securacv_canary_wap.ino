@@ -79,16 +79,26 @@
 #include "esp_camera.h"
 
 #include "log_level.h"
+#include "domain_hash.h"
 #include "health_log.h"
 #include "sd_storage.h"
 #include "nvs_store.h"
 #include "wap_server.h"
 #include "web_ui.h"
 #include "mesh_network.h"
+#include "radio_scheduler.h"
 #include "bluetooth_channel.h"
 #include "bluetooth_api.h"
+#include "ble_export.h"
+#include "scan_scheduler.h"
+#include "rf_presence_api.h"
+#include "response_pool.h"
+#include "rate_limiter.h"
+#include "ui_assets.h"
 #include "sys_monitor.h"
+#include "mem_budget.h"
 #include "hardware_state.h"
+#include "witness_ingest.h"
 
 // ════════════════════════════════════════════════════════════════════════════
 // BUILD CONFIGURATION — Edit build_config.h to select profile
@@ -179,6 +189,15 @@ static const uint32_t FIX_LOST_TIMEOUT_MS  = 3000;    // GPS fix timeout
 static const uint32_t VERIFY_INTERVAL_SEC  = 60;      // Self-verify every N seconds
 static const uint32_t WATCHDOG_TIMEOUT_SEC = 8;       // Watchdog timeout
 static const uint32_t SD_PERSIST_INTERVAL  = 10;      // Persist every N records
+static const uint32_t EXPORT_SD_WAIT_MS    = 2000;    // Wait for the SD lock before giving up
+static const size_t   EXPORT_SD_CHUNK      = 4096;    // Bundle bytes read per SD lock hold
+
+// Stationary run coalescing (FEATURE_WITNESS_COALESCE): samples whose
+// quantized fields match the run's first one are counted, not recorded
+static const uint32_t COALESCE_MAX_MS      = 60000;   // Close a run after this long
+static const double   COALESCE_LATLON_DEG  = 0.0001;  // Position step (~11 m)
+static const double   COALESCE_ALT_M       = 5.0;     // Altitude step
+static const int      COALESCE_SATS_STEP   = 4;       // Satellites-used bucket
 
 // ════════════════════════════════════════════════════════════════════════════
 // USB CDC & OPERATOR INTERFACE
@@ -229,6 +248,15 @@ enum RecordType : uint8_t {
   RECORD_WITNESS_EVENT    = 1,
   RECORD_TAMPER_ALERT     = 2,
   RECORD_STATE_CHANGE     = 3,
+  RECORD_PEER_ALERT       = 4,   // Opera alert received from a mesh peer
+  RECORD_WITNESS_RUN      = 5,   // Stationary samples unchanged since an event
+  RECORD_PEER_ANCHOR      = 6,   // Chain-head anchor received from a mesh peer
+};
+
+enum RunCloseReason : uint8_t {
+  RUN_CLOSE_CHANGED  = 0,        // A quantized field changed
+  RUN_CLOSE_MAX_AGE  = 1,        // COALESCE_MAX_MS reached
+  RUN_CLOSE_STATE    = 2         // Left STATE_STATIONARY
 };
 
 enum GpsFixMode : uint8_t {
@@ -312,6 +340,22 @@ struct WitnessRecord {
   bool        verified;
 };
 
+// A RECORD_WITNESS_EVENT followed by `count` samples that quantized the
+// same. loop() fills it; the writer turns it into the run's CBOR payload.
+struct WitnessRun {
+  uint32_t first_ms;          // Anchor event sampled
+  uint32_t first_sec;         // Uptime of the anchor event
+  uint32_t last_sec;          // Uptime of the newest folded sample
+  uint32_t count;             // Samples folded after the anchor
+  int32_t  lat_q;             // Units of COALESCE_LATLON_DEG
+  int32_t  lon_q;
+  int32_t  alt_q;             // Units of COALESCE_ALT_M
+  uint8_t  sats_q;            // Units of COALESCE_SATS_STEP
+  uint8_t  fix_mode;
+  uint8_t  quality;
+  uint8_t  close_reason;      // RunCloseReason
+};
+
 struct DeviceIdentity {
   uint8_t  privkey[32];
   uint8_t  pubkey[32];
@@ -352,6 +396,8 @@ struct SystemHealth {
   uint32_t sd_errors;
   uint32_t logs_stored;
   uint32_t logs_unacked;
+  uint32_t witness_runs;        // RECORD_WITNESS_RUN records written
+  uint32_t samples_coalesced;   // Samples those runs stand for
   bool     gps_healthy;
   bool     crypto_healthy;
   bool     sd_healthy;
@@ -393,8 +439,10 @@ static FixState       g_state = STATE_NO_FIX;
 static FixState       g_pending_state = STATE_NO_FIX;
 static uint32_t       g_state_entered_ms = 0;
 static uint32_t       g_pending_state_ms = 0;
-static WitnessRecord  g_last_record;
+static WitnessRecord  g_last_record;            // Writer publishes under g_record_mux
 static SystemHealth   g_health;
+static portMUX_TYPE   g_record_mux = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t       g_record_rows = 0;          // Table rows published, printed by loop()
 // NVS access is now encapsulated in NvsManager singleton (see nvs_store.h)
 
 static RingBuffer<2048> g_gps_rb;
@@ -403,6 +451,11 @@ static size_t g_line_len = 0;
 
 static float g_speed_ema = 0.0f;
 static uint32_t g_last_record_ms = 0;
+#if FEATURE_WITNESS_COALESCE
+static WitnessRun g_run;                  // loop() only
+static bool g_run_open = false;
+static uint32_t g_run_anchor_seq = 0;     // Writer only: newest stored WITNESS_EVENT seq
+#endif
 static uint32_t g_last_verify_ms = 0;
 static uint32_t g_boot_button_press_start = 0;
 
@@ -437,8 +490,11 @@ struct HealthLogRingEntry {
   char message[80];
   char detail[48];
 };
+// Entry seq lives in slot seq % HEALTH_LOG_RING_SIZE; the slot's stored seq
+// tells a live entry from one already overwritten
 static const size_t HEALTH_LOG_RING_SIZE = 100;
-static HealthLogRingEntry g_health_log_ring[HEALTH_LOG_RING_SIZE];
+PSRAM_BSS static HealthLogRingEntry g_health_log_ring[HEALTH_LOG_RING_SIZE];
+MEM_BUDGET_STATIC("health_log", g_health_log_ring);
 static size_t g_health_log_ring_head = 0;
 static size_t g_health_log_ring_count = 0;
 
@@ -448,6 +504,8 @@ static size_t g_health_log_ring_count = 0;
 
 static void print_table_header();
 static void print_status_bar();
+static void print_table_row(WitnessRecord* r, GnssFix* fx, FixState st);
+static void print_record_rows();
 static void print_identity_block();
 static void print_time_block();
 static void print_gps_block();
@@ -497,10 +555,22 @@ static const char* record_type_name(RecordType t) {
     case RECORD_WITNESS_EVENT:    return "EVNT";
     case RECORD_TAMPER_ALERT:     return "TAMP";
     case RECORD_STATE_CHANGE:     return "STCH";
+    case RECORD_PEER_ALERT:       return "PEER";
+    case RECORD_WITNESS_RUN:      return "RUN";
+    case RECORD_PEER_ANCHOR:      return "ANCH";
     default:                      return "???";
   }
 }
 
+static const char* run_close_reason_name(uint8_t r) {
+  switch (r) {
+    case RUN_CLOSE_CHANGED: return "changed";
+    case RUN_CLOSE_MAX_AGE: return "max_age";
+    case RUN_CLOSE_STATE:   return "state";
+    default:                return "unknown";
+  }
+}
+
 static const char* fix_mode_name(GpsFixMode m) {
   switch (m) {
     case FIX_MODE_NONE: return "None";
@@ -610,20 +680,8 @@ static void sha256_raw(const uint8_t* data, size_t n, uint8_t out[32]) {
 }
 
 static void sha256_domain(const char* domain, const uint8_t* data, size_t n, uint8_t out[32]) {
-  mbedtls_sha256_context ctx;
-  mbedtls_sha256_init(&ctx);
-  mbedtls_sha256_starts(&ctx, 0);
-  
-  mbedtls_sha256_update(&ctx, (const uint8_t*)domain, strlen(domain));
-  uint8_t sep = 0x00;
-  mbedtls_sha256_update(&ctx, &sep, 1);
-  
-  if (data && n > 0) {
-    mbedtls_sha256_update(&ctx, data, n);
-  }
-  
-  mbedtls_sha256_finish(&ctx, out);
-  mbedtls_sha256_free(&ctx);
+  // Midstate after domain||0x00 is cached per domain (see domain_hash.h)
+  domain_hash::hash(domain, data, n, out);
 }
 
 // ════════════════════════════════════════════════════════════════════════════
@@ -851,11 +909,33 @@ public:
     write_byte(0xF6);
   }
   
+  // Shortest lossless form (float16/32/64), as common/encoding/cbor.h
   void write_float(double v) {
-    write_byte(0xFB);
-    union { double d; uint64_t u; } conv;
-    conv.d = v;
-    for (int i = 7; i >= 0; i--) {
+    if (v != v) {                       // Canonical NaN
+      write_byte(0xF9); write_byte(0x7E); write_byte(0x00);
+      return;
+    }
+    float f = (float)v;
+    if ((double)f != v) {
+      write_byte(0xFB);
+      union { double d; uint64_t u; } conv;
+      conv.d = v;
+      for (int i = 7; i >= 0; i--) {
+        write_byte((conv.u >> (i * 8)) & 0xFF);
+      }
+      return;
+    }
+    uint16_t half;
+    if (float_to_half(f, &half)) {
+      write_byte(0xF9);
+      write_byte(half >> 8);
+      write_byte(half & 0xFF);
+      return;
+    }
+    union { float f; uint32_t u; } conv;
+    conv.f = f;
+    write_byte(0xFA);
+    for (int i = 3; i >= 0; i--) {
       write_byte((conv.u >> (i * 8)) & 0xFF);
     }
   }
@@ -888,6 +968,31 @@ private:
     }
   }
   
+  // Exact float16 bits for f, if it has them
+  static bool float_to_half(float f, uint16_t* half) {
+    union { float f; uint32_t u; } conv;
+    conv.f = f;
+    uint16_t sign = (conv.u >> 16) & 0x8000;
+    int32_t exp = (conv.u >> 23) & 0xFF;
+    uint32_t mant = conv.u & 0x7FFFFF;
+    if (exp == 0xFF) { *half = sign | 0x7C00; return mant == 0; }
+    if (exp == 0) { *half = sign; return mant == 0; }
+    int32_t e = exp - 127;
+    if (e >= -14 && e <= 15) {
+      if (mant & 0x1FFF) return false;
+      *half = sign | ((e + 15) << 10) | (mant >> 13);
+      return true;
+    }
+    if (e >= -24 && e < -14) {
+      uint32_t full = mant | 0x800000;
+      uint32_t shift = -e - 1;
+      if (full & ((1u << shift) - 1)) return false;
+      *half = sign | (full >> shift);
+      return true;
+    }
+    return false;
+  }
+  
   uint8_t* buf_;
   size_t cap_;
   size_t pos_;
@@ -949,6 +1054,58 @@ static bool build_witness_event(const GnssFix* fx, FixState st, uint8_t* out, si
   return true;
 }
 
+#if FEATURE_WITNESS_COALESCE
+// Stands for the anchor event at since_seq and the run->count samples
+// after it; the gps values are the quantized ones all of them share
+static bool build_witness_run(const WitnessRun* run, uint32_t since_seq,
+                              uint8_t* out, size_t cap, size_t* out_len) {
+  CborWriter w(out, cap);
+  
+  w.write_map(8);
+  
+  w.write_text("device_id");
+  w.write_text(g_device.device_id);
+  
+  w.write_text("zone_id");
+  w.write_text(ZONE_ID);
+  
+  w.write_text("state");
+  w.write_text(state_name(STATE_STATIONARY));
+  
+  // "run" (nested map)
+  w.write_text("run");
+  w.write_map(5);
+  w.write_text("since_seq"); w.write_uint(since_seq);
+  w.write_text("count"); w.write_uint(run->count);
+  w.write_text("first_sec"); w.write_uint(run->first_sec);
+  w.write_text("last_sec"); w.write_uint(run->last_sec);
+  w.write_text("closed"); w.write_text(run_close_reason_name(run->close_reason));
+  
+  // "gps" (nested map, quantized)
+  w.write_text("gps");
+  w.write_map(6);
+  w.write_text("valid"); w.write_bool(true);
+  w.write_text("lat"); w.write_float(run->lat_q * COALESCE_LATLON_DEG);
+  w.write_text("lon"); w.write_float(run->lon_q * COALESCE_LATLON_DEG);
+  w.write_text("alt"); w.write_float(run->alt_q * COALESCE_ALT_M);
+  w.write_text("sats_min"); w.write_uint(run->sats_q * COALESCE_SATS_STEP);
+  w.write_text("mode"); w.write_uint(run->fix_mode);
+  
+  w.write_text("quality");
+  w.write_uint(run->quality);
+  
+  w.write_text("time_bucket");
+  w.write_uint(time_bucket());
+  
+  w.write_text("firmware");
+  w.write_text(FIRMWARE_VERSION);
+  
+  if (!w.ok()) return false;
+  *out_len = w.size();
+  return true;
+}
+#endif
+
 static bool build_boot_attestation(uint8_t* out, size_t cap, size_t* out_len) {
   CborWriter w(out, cap);
   
@@ -1012,6 +1169,74 @@ static bool build_state_change(FixState from, FixState to, const char* reason,
   return true;
 }
 
+#if FEATURE_MESH_NETWORK
+static bool build_peer_alert(const mesh_network::MeshAlert* alert,
+                             uint8_t* out, size_t cap, size_t* out_len) {
+  CborWriter w(out, cap);
+  
+  w.write_map(7);
+  
+  w.write_text("device_id");
+  w.write_text(g_device.device_id);
+  
+  w.write_text("peer_fp");
+  w.write_bytes(alert->sender_fp, mesh_network::FINGERPRINT_SIZE);
+  
+  w.write_text("alert");
+  w.write_text(mesh_network::alert_type_name(alert->type));
+  
+  w.write_text("severity");
+  w.write_text(log_level_name(alert->severity));
+  
+  w.write_text("peer_seq");
+  w.write_uint(alert->witness_seq);
+  
+  w.write_text("detail");
+  w.write_text(alert->detail);
+  
+  w.write_text("time_bucket");
+  w.write_uint(time_bucket());
+  
+  if (!w.ok()) return false;
+  *out_len = w.size();
+  return true;
+}
+
+// A peer's anchor as we received it: the chain stores the receipt, so the
+// peer's commitment outlives the RAM ring and a reboot
+static bool build_peer_anchor(const mesh_network::AnchorReceipt* r,
+                              uint8_t* out, size_t cap, size_t* out_len) {
+  CborWriter w(out, cap);
+  
+  w.write_map(7);
+  
+  w.write_text("device_id");
+  w.write_text(g_device.device_id);
+  
+  w.write_text("peer_fp");
+  w.write_bytes(r->peer_fp, mesh_network::FINGERPRINT_SIZE);
+  
+  w.write_text("first_seq");
+  w.write_uint(r->first_seq);
+  
+  w.write_text("last_seq");
+  w.write_uint(r->last_seq);
+  
+  w.write_text("root");
+  w.write_bytes(r->root, mesh_network::ANCHOR_ROOT_SIZE);
+  
+  w.write_text("conflict");
+  w.write_bool(r->conflict);
+  
+  w.write_text("time_bucket");
+  w.write_uint(time_bucket());
+  
+  if (!w.ok()) return false;
+  *out_len = w.size();
+  return true;
+}
+#endif
+
 // ════════════════════════════════════════════════════════════════════════════
 // WITNESS RECORD CREATION
 // ════════════════════════════════════════════════════════════════════════════
@@ -1033,25 +1258,57 @@ static bool create_witness_record(const uint8_t* payload, size_t len, RecordType
   // Verify immediately
   out->verified = verify_signature(g_device.pubkey, out->chain_hash, 32, out->signature);
   
-  if (!out->verified) {
+  portENTER_CRITICAL(&g_record_mux);
+  if (out->verified) {
+    g_health.records_created++;
+    g_health.records_verified++;
+  } else {
     g_health.verify_failures++;
-    return false;
   }
-  
-  g_health.records_created++;
-  g_health.records_verified++;
+  portEXIT_CRITICAL(&g_record_mux);
+  if (!out->verified) return false;
+
+  #if FEATURE_MESH_NETWORK
+  // Anchored with the opera in the next heartbeat
+  mesh_network::note_chain_head(out->seq, out->chain_hash);
+  #endif
   
   // Persist chain state periodically
   if ((g_device.seq - g_device.seq_persisted) >= SD_PERSIST_INTERVAL) {
     persist_chain_state();
   }
   
-  // Store to SD if available
+  sd_storage::WitnessLogEntry entry = {};
+  entry.seq = out->seq;
+  entry.time_bucket = out->time_bucket;
+  entry.record_type = (uint8_t)type;
+  memcpy(entry.chain_hash, out->chain_hash, 32);
+  memcpy(entry.signature, out->signature, 64);
+  entry.payload_len = len;
+
+  // Queue for the card: the SD worker writes it now, or once a card is
+  // mounted, so this writer never waits on SD I/O
   #if FEATURE_SD_STORAGE
-  if (g_sd_mounted) {
-    // Simplified: just store to health log for now
-    // Full witness storage would go to WITNESS directory
-    g_health.sd_writes++;
+  if (sd_async_enabled()) {
+    char path[32];
+    snprintf(path, sizeof(path), "/WITNESS/%08lu.WIT",
+             (unsigned long)(out->seq / sd_storage::WITNESS_SEGMENT_RECORDS));
+    if (sd_append_async(path, &entry, sizeof(entry), payload, len)) {
+      g_health.sd_writes++;
+    } else {
+      g_health.sd_errors++;
+    }
+  }
+  #endif
+
+  // Stream to a connected companion app in the card's layout; the bulk
+  // ring only queues, and bluetooth_channel::update() sends
+  #if FEATURE_BLUETOOTH
+  if (bluetooth_channel::is_connected() && len <= witness_ingest::MAX_PAYLOAD) {
+    uint8_t bulk[sizeof(entry) + witness_ingest::MAX_PAYLOAD];
+    memcpy(bulk, &entry, sizeof(entry));
+    memcpy(bulk + sizeof(entry), payload, len);
+    bluetooth_channel::bulk_send_record(bulk, sizeof(entry) + len);
   }
   #endif
   
@@ -1062,6 +1319,155 @@ static bool verify_record_signature(const WitnessRecord* rec) {
   return verify_signature(g_device.pubkey, rec->chain_hash, 32, rec->signature);
 }
 
+// Once the writer task runs, loop() and the HTTP handlers read the last
+// record through this copy, never the struct the writer publishes into
+static WitnessRecord last_record_snapshot() {
+  portENTER_CRITICAL(&g_record_mux);
+  WitnessRecord rec = g_last_record;
+  portEXIT_CRITICAL(&g_record_mux);
+  return rec;
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// WITNESS INGESTION
+// ════════════════════════════════════════════════════════════════════════════
+
+// Runs on the witness_ingest writer (its task, or loop() as a fallback);
+// after setup() this is the only caller of create_witness_record()
+static bool write_ingested_record(uint8_t type, const uint8_t* payload, size_t len) {
+  #if FEATURE_WITNESS_COALESCE
+  // A run is queued as its WitnessRun and encoded here, where the anchor's
+  // seq is known: routine records are written in submission order
+  WitnessRun run;
+  uint8_t run_payload[256];
+  if (type == RECORD_WITNESS_RUN) {
+    size_t run_len = 0;
+    if (len != sizeof(run)) return false;
+    memcpy(&run, payload, sizeof(run));
+    if (!build_witness_run(&run, g_run_anchor_seq, run_payload, sizeof(run_payload), &run_len)) {
+      log_health(LOG_LEVEL_ERROR, LOG_CAT_WITNESS, "Payload build failed", record_type_name(RECORD_WITNESS_RUN));
+      return false;
+    }
+    payload = run_payload;
+    len = run_len;
+  }
+  #endif
+
+  WitnessRecord rec = {};
+  bool ok = create_witness_record(payload, len, (RecordType)type, &rec);
+  if (!ok) {
+    log_health(LOG_LEVEL_ERROR, LOG_CAT_CRYPTO, "Record verification failed", record_type_name((RecordType)type));
+  }
+
+  #if FEATURE_WITNESS_COALESCE
+  // A run that follows a failed anchor is written with since_seq 0 rather
+  // than pointing at a record that was never stored
+  if (type == RECORD_WITNESS_EVENT) {
+    g_run_anchor_seq = ok ? rec.seq : 0;
+  }
+  #endif
+
+  // Publish for the readers; the table row is printed by loop(), which
+  // owns the serial console
+  portENTER_CRITICAL(&g_record_mux);
+  g_last_record = rec;
+  #if FEATURE_WITNESS_COALESCE
+  if (type == RECORD_WITNESS_RUN && ok) {
+    g_health.witness_runs++;
+    g_health.samples_coalesced += run.count;
+  }
+  #endif
+  if (type == RECORD_WITNESS_EVENT || type == RECORD_WITNESS_RUN) g_record_rows++;
+  portEXIT_CRITICAL(&g_record_mux);
+
+  // Periodic self-verification
+  uint32_t now = millis();
+  if (now - g_last_verify_ms >= VERIFY_INTERVAL_SEC * 1000) {
+    g_last_verify_ms = now;
+    
+    if (!verify_record_signature(&rec)) {
+      log_health(LOG_LEVEL_CRITICAL, LOG_CAT_CRYPTO, "Self-verification FAILED", nullptr);
+      g_health.crypto_healthy = false;
+    } else {
+      g_health.crypto_healthy = true;
+    }
+  }
+
+  return ok;
+}
+
+static bool submit_witness_record(RecordType type, witness_ingest::Priority priority,
+                                  const uint8_t* payload, size_t len) {
+  if (!witness_ingest::submit(type, priority, payload, len)) {
+    log_health(LOG_LEVEL_WARNING, LOG_CAT_WITNESS, "Witness queue full, record dropped",
+               record_type_name(type));
+    return false;
+  }
+  return true;
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// WITNESS RUN COALESCING
+// ════════════════════════════════════════════════════════════════════════════
+
+#if FEATURE_WITNESS_COALESCE
+static void quantize_fix(const GnssFix* fx, WitnessRun* q) {
+  q->lat_q = (int32_t)lround(fx->lat / COALESCE_LATLON_DEG);
+  q->lon_q = (int32_t)lround(fx->lon / COALESCE_LATLON_DEG);
+  q->alt_q = (int32_t)lround(fx->altitude_m / COALESCE_ALT_M);
+  q->sats_q = (uint8_t)((fx->satellites > 0 ? fx->satellites : 0) / COALESCE_SATS_STEP);
+  q->fix_mode = (uint8_t)fx->fix_mode;
+  q->quality = (uint8_t)fx->quality;
+}
+
+static bool run_matches(const WitnessRun& a, const WitnessRun& b) {
+  return a.lat_q == b.lat_q && a.lon_q == b.lon_q && a.alt_q == b.alt_q &&
+         a.sats_q == b.sats_q && a.fix_mode == b.fix_mode && a.quality == b.quality;
+}
+
+// Queue the open run if it folded any samples; a bare anchor needs no run
+static void close_witness_run(RunCloseReason reason) {
+  if (!g_run_open) return;
+  g_run_open = false;
+  if (g_run.count == 0) return;
+  g_run.close_reason = reason;
+  submit_witness_record(RECORD_WITNESS_RUN, witness_ingest::PRIORITY_ROUTINE,
+                        (const uint8_t*)&g_run, sizeof(g_run));
+}
+
+// Called once per RECORD_INTERVAL_MS. True if the sample joined the open
+// run; otherwise any run is closed and the sample is recorded as an event.
+static bool coalesce_witness_sample(uint32_t now) {
+  if (!g_run_open) return false;
+
+  WitnessRun q;
+  quantize_fix(&g_fix, &q);
+  if (g_state != STATE_STATIONARY || !g_fix.valid) {
+    close_witness_run(RUN_CLOSE_STATE);
+  } else if (!run_matches(q, g_run)) {
+    close_witness_run(RUN_CLOSE_CHANGED);
+  } else if (now - g_run.first_ms >= COALESCE_MAX_MS) {
+    close_witness_run(RUN_CLOSE_MAX_AGE);
+  } else {
+    g_run.count++;
+    g_run.last_sec = uptime_seconds();
+    return true;
+  }
+  return false;
+}
+
+// The event just queued anchors a new run while stationary
+static void open_witness_run(uint32_t now) {
+  if (g_state != STATE_STATIONARY || !g_fix.valid) return;
+  memset(&g_run, 0, sizeof(g_run));
+  quantize_fix(&g_fix, &g_run);
+  g_run.first_ms = now;
+  g_run.first_sec = uptime_seconds();
+  g_run.last_sec = g_run.first_sec;
+  g_run_open = true;
+}
+#endif
+
 // ════════════════════════════════════════════════════════════════════════════
 // HEALTH LOGGING
 // ════════════════════════════════════════════════════════════════════════════
@@ -1070,8 +1476,15 @@ void log_health(LogLevel level, LogCategory category, const char* message, const
   // Skip DEBUG by default
   if (level < LOG_LEVEL_INFO) return;
   
-  HealthLogRingEntry& entry = g_health_log_ring[g_health_log_ring_head];
-  entry.seq = ++g_device.log_seq;
+  uint32_t seq = ++g_device.log_seq;
+  size_t slot = seq % HEALTH_LOG_RING_SIZE;
+  // A seq jump (log_seq restored from NVS) restarts the contiguous range
+  if (g_health_log_ring_count > 0 &&
+      g_health_log_ring[(g_health_log_ring_head + HEALTH_LOG_RING_SIZE - 1) % HEALTH_LOG_RING_SIZE].seq != seq - 1) {
+    g_health_log_ring_count = 0;
+  }
+  HealthLogRingEntry& entry = g_health_log_ring[slot];
+  entry.seq = seq;
   entry.timestamp_ms = millis();
   entry.level = level;
   entry.category = category;
@@ -1087,7 +1500,7 @@ void log_health(LogLevel level, LogCategory category, const char* message, const
     entry.detail[0] = '\0';
   }
   
-  g_health_log_ring_head = (g_health_log_ring_head + 1) % HEALTH_LOG_RING_SIZE;
+  g_health_log_ring_head = (slot + 1) % HEALTH_LOG_RING_SIZE;
   if (g_health_log_ring_count < HEALTH_LOG_RING_SIZE) {
     g_health_log_ring_count++;
   }
@@ -1111,18 +1524,23 @@ void health_log(LogLevel level, LogCategory category, const char* message) {
   log_health(level, category, message, nullptr);
 }
 
+// O(1) lookup by seq; nullptr once the entry has been overwritten
+static HealthLogRingEntry* find_log_entry(uint32_t log_seq) {
+  if (log_seq == 0 || g_health_log_ring_count == 0) return nullptr;
+  uint32_t newest = g_health_log_ring[(g_health_log_ring_head + HEALTH_LOG_RING_SIZE - 1) % HEALTH_LOG_RING_SIZE].seq;
+  if (log_seq > newest || newest - log_seq >= g_health_log_ring_count) return nullptr;
+  HealthLogRingEntry& entry = g_health_log_ring[log_seq % HEALTH_LOG_RING_SIZE];
+  return entry.seq == log_seq ? &entry : nullptr;
+}
+
 static bool acknowledge_log_entry(uint32_t log_seq, AckStatus new_status, const char* reason) {
-  for (size_t i = 0; i < g_health_log_ring_count; i++) {
-    HealthLogRingEntry& entry = g_health_log_ring[i];
-    if (entry.seq == log_seq) {
-      if (entry.ack_status == ACK_STATUS_UNREAD && log_level_requires_attention(entry.level)) {
-        if (g_health.logs_unacked > 0) g_health.logs_unacked--;
-      }
-      entry.ack_status = new_status;
-      return true;
-    }
+  HealthLogRingEntry* entry = find_log_entry(log_seq);
+  if (!entry) return false;
+  if (entry->ack_status == ACK_STATUS_UNREAD && log_level_requires_attention(entry->level)) {
+    if (g_health.logs_unacked > 0) g_health.logs_unacked--;
   }
-  return false;
+  entry->ack_status = new_status;
+  return true;
 }
 
 // ════════════════════════════════════════════════════════════════════════════
@@ -1130,6 +1548,11 @@ static bool acknowledge_log_entry(uint32_t log_seq, AckStatus new_status, const
 // ════════════════════════════════════════════════════════════════════════════
 
 static void log_state_transition(FixState from, FixState to, const char* reason) {
+  #if FEATURE_WITNESS_COALESCE
+  // The run covers samples before the transition, so it goes in first
+  close_witness_run(RUN_CLOSE_STATE);
+  #endif
+
   #if FEATURE_STATE_LOG
   g_health.state_changes++;
   
@@ -1141,7 +1564,7 @@ static void log_state_transition(FixState from, FixState to, const char* reason)
   uint8_t payload[256];
   size_t payload_len = 0;
   if (build_state_change(from, to, reason, payload, sizeof(payload), &payload_len)) {
-    create_witness_record(payload, payload_len, RECORD_STATE_CHANGE, &g_last_record);
+    submit_witness_record(RECORD_STATE_CHANGE, witness_ingest::PRIORITY_ROUTINE, payload, payload_len);
   }
   #endif
 }
@@ -1413,6 +1836,12 @@ static esp_err_t http_send_json(httpd_req_t* req, const char* json) {
   return httpd_resp_send(req, json, HTTPD_RESP_USE_STRLEN);
 }
 
+// Handler replies: document and send buffer come from response_pool, not the heap
+static esp_err_t http_send_doc(httpd_req_t* req, const response_pool::PooledJsonDocument& doc) {
+  httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
+  return response_pool::send_json(req, doc);
+}
+
 static esp_err_t http_send_error(httpd_req_t* req, int status_code, const char* error_code) {
   httpd_resp_set_status(req, status_code == 400 ? "400 Bad Request" :
                               status_code == 404 ? "404 Not Found" :
@@ -1424,14 +1853,23 @@ static esp_err_t http_send_error(httpd_req_t* req, int status_code, const char*
 
 static esp_err_t handle_ui(httpd_req_t* req) {
   g_health.http_requests++;
+  // Packed, cacheable copy when the LittleFS partition has one
+  esp_err_t err = wap_server::send_file_response(req, ui_assets::INDEX_PATH, "text/html");
+  if (err != ESP_ERR_NOT_FOUND) return err;
+
   httpd_resp_set_type(req, "text/html");
   return httpd_resp_send(req, CANARY_UI_HTML, HTTPD_RESP_USE_STRLEN);
 }
 
+static esp_err_t handle_ui_asset(httpd_req_t* req) {
+  g_health.http_requests++;
+  return ui_assets::handle_asset(req);
+}
+
 static esp_err_t handle_status(httpd_req_t* req) {
   g_health.http_requests++;
 
-  StaticJsonDocument<1536> doc;
+  response_pool::PooledJsonDocument doc;
   doc["ok"] = true;
   doc["device_id"] = g_device.device_id;
   doc["device_type"] = DEVICE_TYPE;
@@ -1450,9 +1888,49 @@ static esp_err_t handle_status(httpd_req_t* req) {
   doc["boot_count"] = g_device.boot_count;
   doc["chain_seq"] = g_device.seq;
   doc["witness_count"] = g_health.records_created;
+
+  #if FEATURE_WITNESS_COALESCE
+  JsonObject co = doc.createNestedObject("coalesce");
+  co["runs"] = g_health.witness_runs;
+  co["samples"] = g_health.samples_coalesced;
+  co["open"] = g_run_open;
+  co["open_count"] = g_run_open ? g_run.count : 0;
+  #endif
   doc["free_heap"] = ESP.getFreeHeap();
   doc["min_heap"] = g_health.min_heap;
 
+  // Response buffer pools: high water vs blocks says how much is really used
+  response_pool::PoolStats pools = response_pool::get_stats();
+  JsonObject pool_obj = doc.createNestedObject("pools");
+  const mem_pool_stats_t* ps[] = { &pools.json, &pools.chunk };
+  const char* pool_names[] = { "json", "chunk" };
+  for (size_t i = 0; i < 2; i++) {
+    JsonObject p = pool_obj.createNestedObject(pool_names[i]);
+    p["block_bytes"] = ps[i]->block_size;
+    p["blocks"] = ps[i]->blocks;
+    p["in_use"] = ps[i]->in_use;
+    p["high_water"] = ps[i]->high_water;
+    p["failures"] = ps[i]->failures;
+  }
+  pool_obj["overflowed"] = pools.overflowed;
+  pool_obj["busy"] = pools.busy;
+
+  // Per-client request throttling
+  rate_limiter::Stats rl = rate_limiter::get_stats();
+  JsonObject rl_obj = doc.createNestedObject("rate_limit");
+  rl_obj["allowed"] = rl.allowed;
+  rl_obj["rejected"] = rl.rejected;
+  rl_obj["evictions"] = rl.evictions;
+  rl_obj["clients"] = rl.tracked;
+
+  ui_assets::Stats ua = ui_assets::get_stats();
+  JsonObject ua_obj = doc.createNestedObject("ui_assets");
+  ua_obj["mounted"] = ui_assets::available();
+  ua_obj["sent"] = ua.sent;
+  ua_obj["partial"] = ua.partial;
+  ua_obj["not_modified"] = ua.not_modified;
+  ua_obj["bytes"] = ua.bytes;
+
   doc["crypto_healthy"] = g_health.crypto_healthy;
   doc["wifi_active"] = g_health.wifi_active;
 
@@ -1517,9 +1995,7 @@ static esp_err_t handle_status(httpd_req_t* req) {
   gps["fix_mode"] = (int)g_fix.fix_mode;
   gps["state"] = state_name(g_state);
 
-  String response;
-  serializeJson(doc, response);
-  return http_send_json(req, response.c_str());
+  return http_send_doc(req, doc);
 }
 
 #if FEATURE_SYS_MONITOR
@@ -1541,7 +2017,7 @@ static esp_err_t handle_system_metrics(httpd_req_t* req) {
 static esp_err_t handle_chain(httpd_req_t* req) {
   g_health.http_requests++;
 
-  StaticJsonDocument<512> doc;
+  response_pool::PooledJsonDocument doc;
   doc["ok"] = true;
   
   char chain_hex[65];
@@ -1552,19 +2028,34 @@ static esp_err_t handle_chain(httpd_req_t* req) {
   JsonArray blocks = doc.createNestedArray("blocks");
   
   // Add last record info
-  if (g_last_record.seq > 0) {
+  WitnessRecord last = last_record_snapshot();
+  if (last.seq > 0) {
     JsonObject block = blocks.createNestedObject();
     char hash[65];
-    hex_to_str(hash, g_last_record.chain_hash, 32);
-    block["seq"] = g_last_record.seq;
+    hex_to_str(hash, last.chain_hash, 32);
+    block["seq"] = last.seq;
     block["hash"] = hash;
-    block["type"] = record_type_name(g_last_record.type);
-    block["verified"] = g_last_record.verified;
+    block["type"] = record_type_name(last.type);
+    block["verified"] = last.verified;
+  }
+
+  witness_ingest::Stats ingest = witness_ingest::get_stats();
+  JsonObject ing = doc.createNestedObject("ingest");
+  ing["writer_task"] = ingest.writer_running;
+  ing["batches"] = ingest.batches;
+  for (size_t p = 0; p < witness_ingest::PRIORITY_COUNT; p++) {
+    const witness_ingest::PriorityStats& st = ingest.priority[p];
+    JsonObject q = ing.createNestedObject(witness_ingest::priority_name((witness_ingest::Priority)p));
+    q["submitted"] = st.submitted;
+    q["written"] = st.written;
+    q["failed"] = st.failed;
+    q["dropped"] = st.dropped;
+    q["depth"] = st.depth;
+    q["depth_peak"] = st.depth_peak;
+    q["latency_max_ms"] = st.latency_max_ms;
   }
   
-  String response;
-  serializeJson(doc, response);
-  return http_send_json(req, response.c_str());
+  return http_send_doc(req, doc);
 }
 
 static esp_err_t handle_logs(httpd_req_t* req) {
@@ -1579,7 +2070,7 @@ static esp_err_t handle_logs(httpd_req_t* req) {
     }
   }
   
-  DynamicJsonDocument doc(4096);
+  response_pool::PooledJsonDocument doc;
   doc["ok"] = true;
   doc["total"] = g_health_log_ring_count;
   
@@ -1607,9 +2098,7 @@ static esp_err_t handle_logs(httpd_req_t* req) {
     log["ack_status"] = ack_status_name(entry.ack_status);
   }
   
-  String response;
-  serializeJson(doc, response);
-  return http_send_json(req, response.c_str());
+  return http_send_doc(req, doc);
 }
 
 static esp_err_t handle_log_ack(httpd_req_t* req) {
@@ -1630,7 +2119,7 @@ static esp_err_t handle_log_ack(httpd_req_t* req) {
   
   const char* reason = "";
   if (ret > 0) {
-    StaticJsonDocument<128> body;
+    response_pool::PooledJsonDocument body;
     if (deserializeJson(body, content) == DeserializationError::Ok) {
       reason = body["reason"] | "";
     }
@@ -1638,15 +2127,13 @@ static esp_err_t handle_log_ack(httpd_req_t* req) {
   
   bool success = acknowledge_log_entry(seq, ACK_STATUS_ACKNOWLEDGED, reason);
   
-  StaticJsonDocument<128> doc;
+  response_pool::PooledJsonDocument doc;
   doc["ok"] = success;
   if (!success) {
     doc["error"] = "Log entry not found";
   }
   
-  String response;
-  serializeJson(doc, response);
-  return http_send_json(req, response.c_str());
+  return http_send_doc(req, doc);
 }
 
 static esp_err_t handle_ack_all(httpd_req_t* req) {
@@ -1664,56 +2151,51 @@ static esp_err_t handle_ack_all(httpd_req_t* req) {
   
   log_health(LOG_LEVEL_INFO, LOG_CAT_USER, "Bulk acknowledgment", nullptr);
   
-  StaticJsonDocument<128> doc;
+  response_pool::PooledJsonDocument doc;
   doc["ok"] = true;
   doc["acknowledged"] = acked;
   
-  String response;
-  serializeJson(doc, response);
-  return http_send_json(req, response.c_str());
+  return http_send_doc(req, doc);
 }
 
 static esp_err_t handle_witness(httpd_req_t* req) {
   g_health.http_requests++;
   
-  DynamicJsonDocument doc(2048);
+  response_pool::PooledJsonDocument doc;
   doc["ok"] = true;
   doc["total"] = g_health.records_created;
   
   JsonArray records = doc.createNestedArray("records");
   
   // Just show last record info for now
-  if (g_last_record.seq > 0) {
+  WitnessRecord last = last_record_snapshot();
+  if (last.seq > 0) {
     JsonObject rec = records.createNestedObject();
-    rec["seq"] = g_last_record.seq;
-    rec["time_bucket"] = g_last_record.time_bucket;
-    rec["type"] = (int)g_last_record.type;
-    rec["type_name"] = record_type_name(g_last_record.type);
-    rec["payload_len"] = g_last_record.payload_len;
-    rec["verified"] = g_last_record.verified;
+    rec["seq"] = last.seq;
+    rec["time_bucket"] = last.time_bucket;
+    rec["type"] = (int)last.type;
+    rec["type_name"] = record_type_name(last.type);
+    rec["payload_len"] = last.payload_len;
+    rec["verified"] = last.verified;
     
     char hash[65];
-    hex_to_str(hash, g_last_record.chain_hash, 32);
+    hex_to_str(hash, last.chain_hash, 32);
     rec["chain_hash"] = hash;
   }
   
-  String response;
-  serializeJson(doc, response);
-  return http_send_json(req, response.c_str());
+  return http_send_doc(req, doc);
 }
 
 static esp_err_t handle_config_get(httpd_req_t* req) {
   g_health.http_requests++;
   
-  StaticJsonDocument<256> doc;
+  response_pool::PooledJsonDocument doc;
   doc["ok"] = true;
   doc["record_interval_ms"] = RECORD_INTERVAL_MS;
   doc["time_bucket_ms"] = TIME_BUCKET_MS;
   doc["log_level"] = 1;  // Info by default
   
-  String response;
-  serializeJson(doc, response);
-  return http_send_json(req, response.c_str());
+  return http_send_doc(req, doc);
 }
 
 static esp_err_t handle_export(httpd_req_t* req) {
@@ -1721,26 +2203,29 @@ static esp_err_t handle_export(httpd_req_t* req) {
 
   // Check SD card availability using hardware state (non-blocking)
   if (!sd_is_available()) {
-    StaticJsonDocument<192> doc;
+    response_pool::PooledJsonDocument doc;
     doc["ok"] = false;
     doc["error"] = "SD card not available";
     doc["sd_state"] = sd_state_name(g_hw.sd_state);
     doc["sd_available"] = false;
-    String response;
-    serializeJson(doc, response);
-    return http_send_json(req, response.c_str());
+    return http_send_doc(req, doc);
+  }
+
+  // Keep the SD worker from unmounting under the export file
+  SdLockGuard sd_lock_guard(EXPORT_SD_WAIT_MS);
+  if (!sd_lock_guard.held) {
+    httpd_resp_set_status(req, "503 Service Unavailable");
+    return http_send_json(req, "{\"ok\":false,\"error\":\"SD card busy\"}");
   }
 
   // Verify SD card is still present before proceeding
   if (!sd_verify_present()) {
-    StaticJsonDocument<192> doc;
+    response_pool::PooledJsonDocument doc;
     doc["ok"] = false;
     doc["error"] = "SD card was removed during operation";
     doc["sd_state"] = sd_state_name(g_hw.sd_state);
     doc["sd_available"] = false;
-    String response;
-    serializeJson(doc, response);
-    return http_send_json(req, response.c_str());
+    return http_send_doc(req, doc);
   }
 
   // Create export bundle
@@ -1751,17 +2236,15 @@ static esp_err_t handle_export(httpd_req_t* req) {
   if (!file) {
     // SD operation failed - mark as error
     sd_op_failure();
-    StaticJsonDocument<192> doc;
+    response_pool::PooledJsonDocument doc;
     doc["ok"] = false;
     doc["error"] = "Failed to create export file";
     doc["sd_state"] = sd_state_name(g_hw.sd_state);
-    String response;
-    serializeJson(doc, response);
-    return http_send_json(req, response.c_str());
+    return http_send_doc(req, doc);
   }
 
   // Write export header
-  StaticJsonDocument<512> header;
+  response_pool::PooledJsonDocument header;
   header["version"] = PROTOCOL_VERSION;
   header["device_id"] = g_device.device_id;
   header["firmware"] = FIRMWARE_VERSION;
@@ -1782,13 +2265,13 @@ static esp_err_t handle_export(httpd_req_t* req) {
 
   log_health(LOG_LEVEL_INFO, LOG_CAT_USER, "Export created", export_path);
 
-  StaticJsonDocument<128> doc;
+  response_pool::PooledJsonDocument doc;
   doc["ok"] = true;
-  doc["download_url"] = String("/api/download?path=") + export_path;
+  char download_url[96];
+  snprintf(download_url, sizeof(download_url), "/api/download?path=%s", export_path);
+  doc["download_url"] = download_url;
 
-  String response;
-  serializeJson(doc, response);
-  return http_send_json(req, response.c_str());
+  return http_send_doc(req, doc);
 }
 
 static esp_err_t handle_reboot(httpd_req_t* req) {
@@ -1800,13 +2283,11 @@ static esp_err_t handle_reboot(httpd_req_t* req) {
   nvs_store_u32(NVS_KEY_SEQ, g_device.seq);
   nvs_store_bytes(NVS_KEY_CHAIN, g_device.chain_head, 32);
   
-  StaticJsonDocument<64> doc;
+  response_pool::PooledJsonDocument doc;
   doc["ok"] = true;
   doc["message"] = "Rebooting...";
   
-  String response;
-  serializeJson(doc, response);
-  http_send_json(req, response.c_str());
+  http_send_doc(req, doc);
   
   delay(500);
   ESP.restart();
@@ -1914,14 +2395,12 @@ static esp_err_t handle_peek_start(httpd_req_t* req) {
   
   log_health(LOG_LEVEL_INFO, LOG_CAT_NETWORK, "Peek started", nullptr);
   
-  StaticJsonDocument<128> doc;
+  response_pool::PooledJsonDocument doc;
   doc["ok"] = true;
   doc["message"] = "Peek stream activated";
   doc["resolution"] = framesize_name(g_peek_framesize);
   
-  String response;
-  serializeJson(doc, response);
-  return http_send_json(req, response.c_str());
+  return http_send_doc(req, doc);
 }
 
 // ════════════════════════════════════════════════════════════════════════════
@@ -2038,28 +2517,24 @@ static esp_err_t handle_peek_stop(httpd_req_t* req) {
   
   log_health(LOG_LEVEL_INFO, LOG_CAT_NETWORK, "Peek stopped", nullptr);
   
-  StaticJsonDocument<64> doc;
+  response_pool::PooledJsonDocument doc;
   doc["ok"] = true;
   doc["message"] = "Peek stopped";
   
-  String response;
-  serializeJson(doc, response);
-  return http_send_json(req, response.c_str());
+  return http_send_doc(req, doc);
 }
 
 static esp_err_t handle_peek_status(httpd_req_t* req) {
   g_health.http_requests++;
   
-  StaticJsonDocument<256> doc;
+  response_pool::PooledJsonDocument doc;
   doc["ok"] = true;
   doc["camera_initialized"] = g_camera_initialized;
   doc["peek_active"] = g_peek_active;
   doc["resolution"] = (int)g_peek_framesize;
   doc["resolution_name"] = framesize_name(g_peek_framesize);
   
-  String response;
-  serializeJson(doc, response);
-  return http_send_json(req, response.c_str());
+  return http_send_doc(req, doc);
 }
 
 // ════════════════════════════════════════════════════════════════════════════
@@ -2083,7 +2558,7 @@ static esp_err_t handle_peek_resolution(httpd_req_t* req) {
     return http_send_json(req, resp);
   }
   
-  StaticJsonDocument<64> body;
+  response_pool::PooledJsonDocument body;
   if (deserializeJson(body, content) != DeserializationError::Ok) {
     const char* resp = "{\"ok\":false,\"error\":\"Invalid JSON\"}";
     return http_send_json(req, resp);
@@ -2107,7 +2582,7 @@ static esp_err_t handle_peek_resolution(httpd_req_t* req) {
     g_peek_active = true;
   }
   
-  StaticJsonDocument<128> doc;
+  response_pool::PooledJsonDocument doc;
   doc["ok"] = success;
   if (success) {
     doc["resolution"] = size;
@@ -2117,9 +2592,7 @@ static esp_err_t handle_peek_resolution(httpd_req_t* req) {
     doc["error"] = "Failed to set resolution";
   }
   
-  String response;
-  serializeJson(doc, response);
-  return http_send_json(req, response.c_str());
+  return http_send_doc(req, doc);
 }
 
 #endif // FEATURE_CAMERA_PEEK
@@ -2137,7 +2610,7 @@ static esp_err_t handle_mesh_status(httpd_req_t* req) {
   const mesh_network::OperaConfig* config = mesh_network::get_opera_config();
   const mesh_network::PairingSession* pairing = mesh_network::get_pairing_session();
 
-  StaticJsonDocument<512> doc;
+  response_pool::PooledJsonDocument doc;
   doc["ok"] = true;
   doc["state"] = mesh_network::state_name(status.state);
   doc["enabled"] = mesh_network::is_enabled();
@@ -2153,6 +2626,29 @@ static esp_err_t handle_mesh_status(httpd_req_t* req) {
   doc["alerts_sent"] = status.alerts_sent;
   doc["alerts_received"] = status.alerts_received;
   doc["auth_failures"] = status.auth_failures;
+  doc["rx_dropped"] = status.rx_dropped;
+  doc["rx_rejected"] = status.rx_rejected;
+  doc["rx_queue_peak"] = status.rx_queue_peak;
+  doc["is_relay"] = status.is_relay;
+  doc["relay_score"] = status.relay_score;
+  doc["alerts_relayed"] = status.alerts_relayed;
+  doc["duplicates_suppressed"] = status.duplicates_suppressed;
+  doc["heartbeat_interval_ms"] = status.heartbeat_interval_ms;
+  doc["heartbeats_skipped"] = status.heartbeats_skipped;
+  doc["anchors_sent"] = status.anchors_sent;
+  doc["anchor_seq"] = status.anchor_seq;
+  doc["anchors_received"] = status.anchors_received;
+  doc["anchor_gaps"] = status.anchor_gaps;
+  doc["anchor_conflicts"] = status.anchor_conflicts;
+  doc["anchor_heads_dropped"] = status.anchor_heads_dropped;
+  doc["anchors_dropped"] = status.anchors_dropped;
+  doc["bulk_sent"] = status.bulk_sent;
+  doc["bulk_received"] = status.bulk_received;
+  doc["bulk_failed"] = status.bulk_failed;
+  doc["fragments_retransmitted"] = status.fragments_retransmitted;
+  doc["tx_acked"] = status.tx_acked;
+  doc["tx_failed"] = status.tx_failed;
+  doc["rtt_avg_ms"] = status.rtt_avg_ms;
   doc["uptime_ms"] = status.uptime_ms;
 
   // Include pairing code if in pairing confirm state
@@ -2160,16 +2656,14 @@ static esp_err_t handle_mesh_status(httpd_req_t* req) {
     doc["pairing_code"] = pairing->confirmation_code;
   }
 
-  String response;
-  serializeJson(doc, response);
-  return http_send_json(req, response.c_str());
+  return http_send_doc(req, doc);
 }
 
 static esp_err_t handle_mesh_peers(httpd_req_t* req) {
   g_health.http_requests++;
 
   uint8_t count = mesh_network::get_peer_count();
-  DynamicJsonDocument doc(2048);
+  response_pool::PooledJsonDocument doc;
   doc["ok"] = true;
   doc["count"] = count;
 
@@ -2191,14 +2685,69 @@ static esp_err_t handle_mesh_peers(httpd_req_t* req) {
     p["rssi"] = peer->rssi;
     p["alerts_received"] = peer->alerts_received;
 
+    JsonObject link = p.createNestedObject("link");
+    if (peer->rssi_avg_x16 != 0) {
+      link["rssi_avg"] = peer->rssi_avg_x16 / 16.0f;
+    }
+    link["tx_acked"] = peer->tx_acked;
+    link["tx_failed"] = peer->tx_failed;
+    uint32_t tx_total = peer->tx_acked + peer->tx_failed;
+    if (tx_total > 0) {
+      link["delivery_pct"] = (peer->tx_acked * 100) / tx_total;
+    }
+    if (peer->rtt_ms > 0) {
+      link["rtt_ms"] = peer->rtt_ms;
+    }
+    link["retransmits"] = peer->retransmits;
+
+    if (peer->anchors > 0) {
+      JsonObject anchor = p.createNestedObject("anchor");
+      anchor["seq"] = peer->anchor_seq;
+      anchor["received"] = peer->anchors;
+      anchor["conflicts"] = peer->anchor_conflicts;
+    }
+
     if (peer->last_seen_ms > 0) {
       p["last_seen_sec"] = (millis() - peer->last_seen_ms) / 1000;
     }
   }
 
-  String response;
-  serializeJson(doc, response);
-  return http_send_json(req, response.c_str());
+  return http_send_doc(req, doc);
+}
+
+// Receipts of peers' chain-head anchors, oldest first. Each root can be
+// recomputed from that peer's records first_seq..last_seq.
+static esp_err_t handle_mesh_anchors(httpd_req_t* req) {
+  g_health.http_requests++;
+
+  size_t count = mesh_network::get_anchor_receipt_count();
+  response_pool::PooledJsonDocument doc;
+  doc["ok"] = true;
+  doc["count"] = count;
+
+  uint32_t now = millis();
+  JsonArray arr = doc.createNestedArray("receipts");
+  mesh_network::AnchorReceipt r;
+  for (size_t i = 0; i < count && mesh_network::get_anchor_receipt(i, &r); i++) {
+    JsonObject a = arr.createNestedObject();
+
+    char fp_hex[17];
+    for (int j = 0; j < 8; j++) {
+      sprintf(fp_hex + j * 2, "%02X", r.peer_fp[j]);
+    }
+    a["fingerprint"] = fp_hex;
+
+    char root_hex[mesh_network::ANCHOR_ROOT_SIZE * 2 + 1];
+    hex_to_str(root_hex, r.root, mesh_network::ANCHOR_ROOT_SIZE);
+    a["root"] = root_hex;
+
+    a["first_seq"] = r.first_seq;
+    a["last_seq"] = r.last_seq;
+    a["age_sec"] = (now - r.received_ms) / 1000;
+    if (r.conflict) a["conflict"] = true;
+  }
+
+  return http_send_doc(req, doc);
 }
 
 static esp_err_t handle_mesh_alerts(httpd_req_t* req) {
@@ -2207,7 +2756,7 @@ static esp_err_t handle_mesh_alerts(httpd_req_t* req) {
   size_t count = 0;
   const mesh_network::MeshAlert* alerts = mesh_network::get_alerts(&count);
 
-  DynamicJsonDocument doc(2048);
+  response_pool::PooledJsonDocument doc;
   doc["ok"] = true;
   doc["count"] = count;
 
@@ -2224,9 +2773,7 @@ static esp_err_t handle_mesh_alerts(httpd_req_t* req) {
     a["witness_seq"] = alert->witness_seq;
   }
 
-  String response;
-  serializeJson(doc, response);
-  return http_send_json(req, response.c_str());
+  return http_send_doc(req, doc);
 }
 
 static esp_err_t handle_mesh_alerts_clear(httpd_req_t* req) {
@@ -2243,7 +2790,7 @@ static esp_err_t handle_mesh_enable(httpd_req_t* req) {
   if (ret <= 0) return http_send_error(req, 400, "invalid_body");
   buf[ret] = '\0';
 
-  StaticJsonDocument<64> body;
+  response_pool::PooledJsonDocument body;
   if (deserializeJson(body, buf) != DeserializationError::Ok) {
     return http_send_error(req, 400, "invalid_json");
   }
@@ -2263,7 +2810,7 @@ static esp_err_t handle_mesh_pair_start(httpd_req_t* req) {
   buf[ret > 0 ? ret : 0] = '\0';
 
   const char* opera_name = nullptr;
-  StaticJsonDocument<128> body;
+  response_pool::PooledJsonDocument body;
   if (ret > 0 && deserializeJson(body, buf) == DeserializationError::Ok) {
     opera_name = body["name"] | (const char*)nullptr;
   }
@@ -2320,7 +2867,7 @@ static esp_err_t handle_mesh_remove(httpd_req_t* req) {
   if (ret <= 0) return http_send_error(req, 400, "invalid_body");
   buf[ret] = '\0';
 
-  StaticJsonDocument<64> body;
+  response_pool::PooledJsonDocument body;
   if (deserializeJson(body, buf) != DeserializationError::Ok) {
     return http_send_error(req, 400, "invalid_json");
   }
@@ -2352,7 +2899,7 @@ static esp_err_t handle_mesh_name(httpd_req_t* req) {
   if (ret <= 0) return http_send_error(req, 400, "invalid_body");
   buf[ret] = '\0';
 
-  StaticJsonDocument<128> body;
+  response_pool::PooledJsonDocument body;
   if (deserializeJson(body, buf) != DeserializationError::Ok) {
     return http_send_error(req, 400, "invalid_json");
   }
@@ -2380,7 +2927,7 @@ static esp_err_t handle_wifi_status(httpd_req_t* req) {
 
   wifi_update_status();
 
-  StaticJsonDocument<512> doc;
+  response_pool::PooledJsonDocument doc;
   doc["ok"] = true;
   doc["state"] = wifi_state_name(g_wifi_status.state);
   doc["ap_active"] = g_wifi_status.ap_active;
@@ -2399,9 +2946,7 @@ static esp_err_t handle_wifi_status(httpd_req_t* req) {
     doc["connected_sec"] = (millis() - g_wifi_status.connected_since_ms) / 1000;
   }
 
-  String response;
-  serializeJson(doc, response);
-  return http_send_json(req, response.c_str());
+  return http_send_doc(req, doc);
 }
 
 static esp_err_t handle_wifi_scan(httpd_req_t* req) {
@@ -2412,12 +2957,10 @@ static esp_err_t handle_wifi_scan(httpd_req_t* req) {
 
   if (scanResult == WIFI_SCAN_RUNNING) {
     // Scan still in progress - tell client to poll again
-    StaticJsonDocument<64> doc;
+    response_pool::PooledJsonDocument doc;
     doc["ok"] = true;
     doc["scanning"] = true;
-    String response;
-    serializeJson(doc, response);
-    return http_send_json(req, response.c_str());
+    return http_send_doc(req, doc);
   }
 
   if (scanResult == WIFI_SCAN_FAILED || (!g_wifi_scan_in_progress && scanResult < 0)) {
@@ -2426,12 +2969,10 @@ static esp_err_t handle_wifi_scan(httpd_req_t* req) {
     g_wifi_status.state = WIFI_PROV_SCANNING;
     WiFi.scanNetworks(true, false, false, 300);  // async=true
 
-    StaticJsonDocument<64> doc;
+    response_pool::PooledJsonDocument doc;
     doc["ok"] = true;
     doc["scanning"] = true;
-    String response;
-    serializeJson(doc, response);
-    return http_send_json(req, response.c_str());
+    return http_send_doc(req, doc);
   }
 
   // Scan complete - return results
@@ -2441,7 +2982,7 @@ static esp_err_t handle_wifi_scan(httpd_req_t* req) {
   }
 
   int n = scanResult;
-  DynamicJsonDocument doc(2048);
+  response_pool::PooledJsonDocument doc;
   doc["ok"] = true;
   doc["scanning"] = false;
   doc["count"] = n;
@@ -2467,9 +3008,7 @@ static esp_err_t handle_wifi_scan(httpd_req_t* req) {
 
   WiFi.scanDelete();
 
-  String response;
-  serializeJson(doc, response);
-  return http_send_json(req, response.c_str());
+  return http_send_doc(req, doc);
 }
 
 static esp_err_t handle_wifi_connect(httpd_req_t* req) {
@@ -2480,43 +3019,35 @@ static esp_err_t handle_wifi_connect(httpd_req_t* req) {
   int ret = httpd_req_recv(req, content, sizeof(content) - 1);
 
   if (ret <= 0) {
-    StaticJsonDocument<64> doc;
+    response_pool::PooledJsonDocument doc;
     doc["ok"] = false;
     doc["error"] = "No body";
-    String response;
-    serializeJson(doc, response);
-    return http_send_json(req, response.c_str());
+    return http_send_doc(req, doc);
   }
 
-  StaticJsonDocument<256> body;
+  response_pool::PooledJsonDocument body;
   if (deserializeJson(body, content) != DeserializationError::Ok) {
-    StaticJsonDocument<64> doc;
+    response_pool::PooledJsonDocument doc;
     doc["ok"] = false;
     doc["error"] = "Invalid JSON";
-    String response;
-    serializeJson(doc, response);
-    return http_send_json(req, response.c_str());
+    return http_send_doc(req, doc);
   }
 
   const char* ssid = body["ssid"] | "";
   const char* password = body["password"] | "";
 
   if (strlen(ssid) == 0 || strlen(ssid) > 32) {
-    StaticJsonDocument<64> doc;
+    response_pool::PooledJsonDocument doc;
     doc["ok"] = false;
     doc["error"] = "Invalid SSID (1-32 chars required)";
-    String response;
-    serializeJson(doc, response);
-    return http_send_json(req, response.c_str());
+    return http_send_doc(req, doc);
   }
 
   if (strlen(password) > 64) {
-    StaticJsonDocument<64> doc;
+    response_pool::PooledJsonDocument doc;
     doc["ok"] = false;
     doc["error"] = "Password too long (max 64 chars)";
-    String response;
-    serializeJson(doc, response);
-    return http_send_json(req, response.c_str());
+    return http_send_doc(req, doc);
   }
 
   // Save credentials
@@ -2532,14 +3063,12 @@ static esp_err_t handle_wifi_connect(httpd_req_t* req) {
   // Attempt connection
   wifi_connect_to_home();
 
-  StaticJsonDocument<128> doc;
+  response_pool::PooledJsonDocument doc;
   doc["ok"] = true;
   doc["message"] = "Credentials saved, attempting connection";
   doc["ssid"] = g_wifi_creds.ssid;
 
-  String response;
-  serializeJson(doc, response);
-  return http_send_json(req, response.c_str());
+  return http_send_doc(req, doc);
 }
 
 static esp_err_t handle_wifi_disconnect(httpd_req_t* req) {
@@ -2558,13 +3087,11 @@ static esp_err_t handle_wifi_disconnect(httpd_req_t* req) {
 
   log_health(LOG_LEVEL_INFO, LOG_CAT_NETWORK, "WiFi disconnected", nullptr);
 
-  StaticJsonDocument<64> doc;
+  response_pool::PooledJsonDocument doc;
   doc["ok"] = true;
   doc["message"] = "Disconnected from home WiFi";
 
-  String response;
-  serializeJson(doc, response);
-  return http_send_json(req, response.c_str());
+  return http_send_doc(req, doc);
 }
 
 static esp_err_t handle_wifi_forget(httpd_req_t* req) {
@@ -2573,25 +3100,21 @@ static esp_err_t handle_wifi_forget(httpd_req_t* req) {
   WiFi.disconnect(true);
   wifi_clear_credentials();
 
-  StaticJsonDocument<64> doc;
+  response_pool::PooledJsonDocument doc;
   doc["ok"] = true;
   doc["message"] = "WiFi credentials forgotten";
 
-  String response;
-  serializeJson(doc, response);
-  return http_send_json(req, response.c_str());
+  return http_send_doc(req, doc);
 }
 
 static esp_err_t handle_wifi_reconnect(httpd_req_t* req) {
   g_health.http_requests++;
 
   if (!g_wifi_creds.configured) {
-    StaticJsonDocument<64> doc;
+    response_pool::PooledJsonDocument doc;
     doc["ok"] = false;
     doc["error"] = "No WiFi credentials configured";
-    String response;
-    serializeJson(doc, response);
-    return http_send_json(req, response.c_str());
+    return http_send_doc(req, doc);
   }
 
   g_wifi_creds.enabled = true;
@@ -2607,14 +3130,12 @@ static esp_err_t handle_wifi_reconnect(httpd_req_t* req) {
 
   wifi_connect_to_home();
 
-  StaticJsonDocument<128> doc;
+  response_pool::PooledJsonDocument doc;
   doc["ok"] = true;
   doc["message"] = "Attempting to reconnect";
   doc["ssid"] = g_wifi_creds.ssid;
 
-  String response;
-  serializeJson(doc, response);
-  return http_send_json(req, response.c_str());
+  return http_send_doc(req, doc);
 }
 
 // Captive portal handler for iOS/Android/Windows detection
@@ -2640,12 +3161,14 @@ static void start_http_server() {
   config.stack_size = 8192;  // Increased stack for camera streaming
 
   // Calculate max URI handlers based on feature usage
-  const int base_handlers = 19;       // UI, API, WiFi provisioning, captive portal
+  const int base_handlers = 20;       // UI, API, WiFi provisioning, captive portal
   const int camera_handlers = 6;      // Camera peek endpoints
-  const int mesh_handlers = 12;       // Mesh network endpoints
+  const int mesh_handlers = 13;       // Mesh network endpoints
   const int bluetooth_handlers = 23;  // Bluetooth API endpoints
+  const int rf_handlers = 8;          // RF presence endpoints
   const int handler_headroom = 4;     // Reserve for future additions
-  config.max_uri_handlers = base_handlers + camera_handlers + mesh_handlers + bluetooth_handlers + handler_headroom;
+  config.max_uri_handlers = base_handlers + camera_handlers + mesh_handlers + bluetooth_handlers +
+                            rf_handlers + handler_headroom;
   
   if (httpd_start(&g_http_server, &config) != ESP_OK) {
     log_health(LOG_LEVEL_ERROR, LOG_CAT_NETWORK, "HTTP server start failed", nullptr);
@@ -2654,130 +3177,136 @@ static void start_http_server() {
   
   // UI
   httpd_uri_t ui = { .uri = "/", .method = HTTP_GET, .handler = handle_ui };
-  httpd_register_uri_handler(g_http_server, &ui);
+  rate_limiter::register_uri_handler(g_http_server, &ui);
+
+  httpd_uri_t ui_files = { .uri = "/ui/*", .method = HTTP_GET, .handler = handle_ui_asset };
+  rate_limiter::register_uri_handler(g_http_server, &ui_files);
   
   // API endpoints
   httpd_uri_t status = { .uri = "/api/status", .method = HTTP_GET, .handler = handle_status };
-  httpd_register_uri_handler(g_http_server, &status);
+  rate_limiter::register_uri_handler(g_http_server, &status);
 
 #if FEATURE_SYS_MONITOR
   httpd_uri_t sys_metrics = { .uri = "/api/system", .method = HTTP_GET, .handler = handle_system_metrics };
-  httpd_register_uri_handler(g_http_server, &sys_metrics);
+  rate_limiter::register_uri_handler(g_http_server, &sys_metrics);
 #endif
 
   httpd_uri_t chain = { .uri = "/api/chain", .method = HTTP_GET, .handler = handle_chain };
-  httpd_register_uri_handler(g_http_server, &chain);
+  rate_limiter::register_uri_handler(g_http_server, &chain);
   
   httpd_uri_t logs = { .uri = "/api/logs", .method = HTTP_GET, .handler = handle_logs };
-  httpd_register_uri_handler(g_http_server, &logs);
+  rate_limiter::register_uri_handler(g_http_server, &logs);
   
   httpd_uri_t log_ack = { .uri = "/api/logs/*/ack", .method = HTTP_POST, .handler = handle_log_ack };
-  httpd_register_uri_handler(g_http_server, &log_ack);
+  rate_limiter::register_uri_handler(g_http_server, &log_ack);
   
   httpd_uri_t ack_all = { .uri = "/api/logs/ack-all", .method = HTTP_POST, .handler = handle_ack_all };
-  httpd_register_uri_handler(g_http_server, &ack_all);
+  rate_limiter::register_uri_handler(g_http_server, &ack_all);
   
   httpd_uri_t witness = { .uri = "/api/witness", .method = HTTP_GET, .handler = handle_witness };
-  httpd_register_uri_handler(g_http_server, &witness);
+  rate_limiter::register_uri_handler(g_http_server, &witness);
   
   httpd_uri_t config_get = { .uri = "/api/config", .method = HTTP_GET, .handler = handle_config_get };
-  httpd_register_uri_handler(g_http_server, &config_get);
+  rate_limiter::register_uri_handler(g_http_server, &config_get);
   
   httpd_uri_t export_bundle = { .uri = "/api/export", .method = HTTP_POST, .handler = handle_export };
-  httpd_register_uri_handler(g_http_server, &export_bundle);
+  rate_limiter::register_uri_handler(g_http_server, &export_bundle);
   
   httpd_uri_t reboot = { .uri = "/api/reboot", .method = HTTP_POST, .handler = handle_reboot };
-  httpd_register_uri_handler(g_http_server, &reboot);
+  rate_limiter::register_uri_handler(g_http_server, &reboot);
 
   // WiFi provisioning endpoints
   httpd_uri_t wifi_status = { .uri = "/api/wifi", .method = HTTP_GET, .handler = handle_wifi_status };
-  httpd_register_uri_handler(g_http_server, &wifi_status);
+  rate_limiter::register_uri_handler(g_http_server, &wifi_status);
 
   httpd_uri_t wifi_scan = { .uri = "/api/wifi/scan", .method = HTTP_GET, .handler = handle_wifi_scan };
-  httpd_register_uri_handler(g_http_server, &wifi_scan);
+  rate_limiter::register_uri_handler(g_http_server, &wifi_scan);
 
   httpd_uri_t wifi_connect = { .uri = "/api/wifi/connect", .method = HTTP_POST, .handler = handle_wifi_connect };
-  httpd_register_uri_handler(g_http_server, &wifi_connect);
+  rate_limiter::register_uri_handler(g_http_server, &wifi_connect);
 
   httpd_uri_t wifi_disconnect = { .uri = "/api/wifi/disconnect", .method = HTTP_POST, .handler = handle_wifi_disconnect };
-  httpd_register_uri_handler(g_http_server, &wifi_disconnect);
+  rate_limiter::register_uri_handler(g_http_server, &wifi_disconnect);
 
   httpd_uri_t wifi_forget = { .uri = "/api/wifi/forget", .method = HTTP_POST, .handler = handle_wifi_forget };
-  httpd_register_uri_handler(g_http_server, &wifi_forget);
+  rate_limiter::register_uri_handler(g_http_server, &wifi_forget);
 
   httpd_uri_t wifi_reconnect = { .uri = "/api/wifi/reconnect", .method = HTTP_POST, .handler = handle_wifi_reconnect };
-  httpd_register_uri_handler(g_http_server, &wifi_reconnect);
+  rate_limiter::register_uri_handler(g_http_server, &wifi_reconnect);
 
   // Captive portal detection URLs (for iOS/Android automatic redirect)
   httpd_uri_t captive1 = { .uri = "/hotspot-detect.html", .method = HTTP_GET, .handler = handle_captive_portal };
-  httpd_register_uri_handler(g_http_server, &captive1);
+  rate_limiter::register_uri_handler(g_http_server, &captive1);
 
   httpd_uri_t captive2 = { .uri = "/generate_204", .method = HTTP_GET, .handler = handle_captive_portal };
-  httpd_register_uri_handler(g_http_server, &captive2);
+  rate_limiter::register_uri_handler(g_http_server, &captive2);
 
   httpd_uri_t captive3 = { .uri = "/connecttest.txt", .method = HTTP_GET, .handler = handle_captive_portal };
-  httpd_register_uri_handler(g_http_server, &captive3);
+  rate_limiter::register_uri_handler(g_http_server, &captive3);
 
 #if FEATURE_CAMERA_PEEK
   // Camera peek endpoints (for positioning/setup only - no recording)
   // NEW: Start endpoint to explicitly activate streaming
   httpd_uri_t peek_start = { .uri = "/api/peek/start", .method = HTTP_POST, .handler = handle_peek_start };
-  httpd_register_uri_handler(g_http_server, &peek_start);
+  rate_limiter::register_uri_handler(g_http_server, &peek_start);
   
   httpd_uri_t peek_stream = { .uri = "/api/peek/stream", .method = HTTP_GET, .handler = handle_peek_stream };
-  httpd_register_uri_handler(g_http_server, &peek_stream);
+  rate_limiter::register_uri_handler(g_http_server, &peek_stream);
   
   httpd_uri_t peek_snapshot = { .uri = "/api/peek/snapshot", .method = HTTP_GET, .handler = handle_peek_snapshot };
-  httpd_register_uri_handler(g_http_server, &peek_snapshot);
+  rate_limiter::register_uri_handler(g_http_server, &peek_snapshot);
   
   httpd_uri_t peek_stop = { .uri = "/api/peek/stop", .method = HTTP_POST, .handler = handle_peek_stop };
-  httpd_register_uri_handler(g_http_server, &peek_stop);
+  rate_limiter::register_uri_handler(g_http_server, &peek_stop);
   
   httpd_uri_t peek_status = { .uri = "/api/peek/status", .method = HTTP_GET, .handler = handle_peek_status };
-  httpd_register_uri_handler(g_http_server, &peek_status);
+  rate_limiter::register_uri_handler(g_http_server, &peek_status);
   
   // NEW: Resolution control endpoint
   httpd_uri_t peek_resolution = { .uri = "/api/peek/resolution", .method = HTTP_POST, .handler = handle_peek_resolution };
-  httpd_register_uri_handler(g_http_server, &peek_resolution);
+  rate_limiter::register_uri_handler(g_http_server, &peek_resolution);
 #endif
 
 #if FEATURE_MESH_NETWORK
   // Mesh network (opera) endpoints
   httpd_uri_t mesh_status = { .uri = "/api/mesh", .method = HTTP_GET, .handler = handle_mesh_status };
-  httpd_register_uri_handler(g_http_server, &mesh_status);
+  rate_limiter::register_uri_handler(g_http_server, &mesh_status);
 
   httpd_uri_t mesh_peers = { .uri = "/api/mesh/peers", .method = HTTP_GET, .handler = handle_mesh_peers };
-  httpd_register_uri_handler(g_http_server, &mesh_peers);
+  rate_limiter::register_uri_handler(g_http_server, &mesh_peers);
+
+  httpd_uri_t mesh_anchors = { .uri = "/api/mesh/anchors", .method = HTTP_GET, .handler = handle_mesh_anchors };
+  rate_limiter::register_uri_handler(g_http_server, &mesh_anchors);
 
   httpd_uri_t mesh_alerts = { .uri = "/api/mesh/alerts", .method = HTTP_GET, .handler = handle_mesh_alerts };
-  httpd_register_uri_handler(g_http_server, &mesh_alerts);
+  rate_limiter::register_uri_handler(g_http_server, &mesh_alerts);
 
   httpd_uri_t mesh_alerts_clear = { .uri = "/api/mesh/alerts", .method = HTTP_DELETE, .handler = handle_mesh_alerts_clear };
-  httpd_register_uri_handler(g_http_server, &mesh_alerts_clear);
+  rate_limiter::register_uri_handler(g_http_server, &mesh_alerts_clear);
 
   httpd_uri_t mesh_enable = { .uri = "/api/mesh/enable", .method = HTTP_POST, .handler = handle_mesh_enable };
-  httpd_register_uri_handler(g_http_server, &mesh_enable);
+  rate_limiter::register_uri_handler(g_http_server, &mesh_enable);
 
   httpd_uri_t mesh_pair_start = { .uri = "/api/mesh/pair/start", .method = HTTP_POST, .handler = handle_mesh_pair_start };
-  httpd_register_uri_handler(g_http_server, &mesh_pair_start);
+  rate_limiter::register_uri_handler(g_http_server, &mesh_pair_start);
 
   httpd_uri_t mesh_pair_join = { .uri = "/api/mesh/pair/join", .method = HTTP_POST, .handler = handle_mesh_pair_join };
-  httpd_register_uri_handler(g_http_server, &mesh_pair_join);
+  rate_limiter::register_uri_handler(g_http_server, &mesh_pair_join);
 
   httpd_uri_t mesh_pair_confirm = { .uri = "/api/mesh/pair/confirm", .method = HTTP_POST, .handler = handle_mesh_pair_confirm };
-  httpd_register_uri_handler(g_http_server, &mesh_pair_confirm);
+  rate_limiter::register_uri_handler(g_http_server, &mesh_pair_confirm);
 
   httpd_uri_t mesh_pair_cancel = { .uri = "/api/mesh/pair/cancel", .method = HTTP_POST, .handler = handle_mesh_pair_cancel };
-  httpd_register_uri_handler(g_http_server, &mesh_pair_cancel);
+  rate_limiter::register_uri_handler(g_http_server, &mesh_pair_cancel);
 
   httpd_uri_t mesh_leave = { .uri = "/api/mesh/leave", .method = HTTP_POST, .handler = handle_mesh_leave };
-  httpd_register_uri_handler(g_http_server, &mesh_leave);
+  rate_limiter::register_uri_handler(g_http_server, &mesh_leave);
 
   httpd_uri_t mesh_remove = { .uri = "/api/mesh/remove", .method = HTTP_POST, .handler = handle_mesh_remove };
-  httpd_register_uri_handler(g_http_server, &mesh_remove);
+  rate_limiter::register_uri_handler(g_http_server, &mesh_remove);
 
   httpd_uri_t mesh_name = { .uri = "/api/mesh/name", .method = HTTP_POST, .handler = handle_mesh_name };
-  httpd_register_uri_handler(g_http_server, &mesh_name);
+  rate_limiter::register_uri_handler(g_http_server, &mesh_name);
 #endif
 
 #if FEATURE_BLUETOOTH
@@ -2785,6 +3314,11 @@ static void start_http_server() {
   bluetooth_api::register_routes(g_http_server);
 #endif
 
+#if FEATURE_RF_PRESENCE
+  // RF presence endpoints
+  rf_presence_api::register_routes(g_http_server);
+#endif
+
   log_health(LOG_LEVEL_INFO, LOG_CAT_NETWORK, "HTTP server started", "port 80");
 }
 
@@ -3005,6 +3539,80 @@ static bool start_wifi_ap() {
 // which provides timeout protection and graceful failure handling.
 // The legacy sd_init() has been removed to prevent accidental use of blocking SD.begin().
 
+#if FEATURE_SD_STORAGE
+// Runs after every mount; on the SD worker when it is running
+static void sd_create_directories() {
+  if (!SD.exists("/WITNESS")) SD.mkdir("/WITNESS");
+  if (!SD.exists("/HEALTH")) SD.mkdir("/HEALTH");
+  if (!SD.exists("/CHAIN")) SD.mkdir("/CHAIN");
+  if (!SD.exists("/EXPORT")) SD.mkdir("/EXPORT");
+}
+
+// Export bundle: one JSON manifest line, then every /WITNESS segment in
+// seq order, each a run of WitnessLogEntry headers and payloads as
+// create_witness_record() queues them. Segments are keyed by seq, not
+// date, so the requested dates go in the manifest and are not applied.
+// Reads the card on the caller's task (the BLE export task), holding
+// sd_lock() for one EXPORT_SD_CHUNK at a time so the SD worker can flush
+// between chunks; each chunk reopens the segment at its offset.
+static bool export_stream_bundle(const char* start_date, const char* end_date,
+                                 sd_storage::ExportWriteFn write, void* ctx,
+                                 uint8_t sha256_out[32]) {
+  if (!sd_is_available()) return false;
+
+  mbedtls_sha256_context sha;
+  mbedtls_sha256_init(&sha);
+  mbedtls_sha256_starts(&sha, 0);
+  auto emit = [&](const uint8_t* data, size_t len) {
+    mbedtls_sha256_update(&sha, data, len);
+    return write(data, len, ctx);
+  };
+
+  uint32_t seq = g_device.seq;
+  char pubkey_hex[65];
+  hex_to_str(pubkey_hex, g_device.pubkey, 32);
+  char manifest[384];
+  int len = snprintf(manifest, sizeof(manifest),
+    "{\"version\":\"%s\",\"device_id\":\"%s\",\"firmware\":\"%s\",\"ruleset\":\"%s\","
+    "\"pubkey\":\"%s\",\"chain_seq\":%lu,\"start_date\":\"%s\",\"end_date\":\"%s\","
+    "\"segment_records\":%lu}\n",
+    PROTOCOL_VERSION, g_device.device_id, FIRMWARE_VERSION, RULESET_ID, pubkey_hex,
+    (unsigned long)seq, start_date, end_date,
+    (unsigned long)sd_storage::WITNESS_SEGMENT_RECORDS);
+  bool ok = len > 0 && len < (int)sizeof(manifest) &&
+            emit(reinterpret_cast<const uint8_t*>(manifest), len);
+
+  uint8_t buf[512];
+  for (uint32_t segment = 0; ok && segment <= seq / sd_storage::WITNESS_SEGMENT_RECORDS; segment++) {
+    char path[32];
+    snprintf(path, sizeof(path), "/WITNESS/%08lu.WIT", (unsigned long)segment);
+    size_t offset = 0;
+    bool more = true;
+    while (ok && more) {
+      SdLockGuard lock(EXPORT_SD_WAIT_MS);
+      if (!lock.held || !sd_is_available()) {
+        ok = false;
+        break;
+      }
+      File f = SD.open(path, FILE_READ);
+      if (!f) break;  // No card while those records were made
+      more = f.seek(offset);
+      for (size_t chunk = 0; ok && more && chunk < EXPORT_SD_CHUNK; chunk += sizeof(buf)) {
+        size_t n = f.read(buf, sizeof(buf));
+        more = n == sizeof(buf);
+        offset += n;
+        ok = n == 0 || emit(buf, n);
+      }
+      f.close();
+    }
+  }
+
+  mbedtls_sha256_finish(&sha, sha256_out);
+  mbedtls_sha256_free(&sha);
+  return ok;
+}
+#endif
+
 // ════════════════════════════════════════════════════════════════════════════
 // DEVICE PROVISIONING
 // ════════════════════════════════════════════════════════════════════════════
@@ -3093,6 +3701,30 @@ static void print_table_row(WitnessRecord* r, GnssFix* fx, FixState st) {
   );
 }
 
+// Row for the newest record the writer published since the last call;
+// rows published in between are only counted
+static void print_record_rows() {
+  static uint32_t printed = 0;
+  static uint32_t status_at = 0;
+
+  portENTER_CRITICAL(&g_record_mux);
+  uint32_t rows = g_record_rows;
+  uint32_t created = g_health.records_created;
+  WitnessRecord rec = g_last_record;
+  portEXIT_CRITICAL(&g_record_mux);
+  if (rows == printed) return;
+  printed = rows;
+
+  print_table_row(&rec, &g_fix, g_state);
+
+  // Periodic status every 20 records
+  if (created / 20 != status_at / 20) {
+    status_at = created;
+    print_status_bar();
+    print_table_header();
+  }
+}
+
 static void print_status_bar() {
   char uptime_str[16];
   format_uptime(uptime_str, sizeof(uptime_str), uptime_seconds());
@@ -3193,6 +3825,7 @@ static void print_help() {
   Serial.println("│ c     : Show camera status          │");
   Serial.println("│ m     : Show system monitor         │");
   Serial.println("│         (temp, heap, PSRAM)         │");
+  Serial.println("│ r     : Show radio slot utilization │");
   Serial.println("└─────────────────────────────────────┘");
 }
 
@@ -3240,6 +3873,14 @@ static void handle_serial_commands() {
         #else
         Serial.println("System monitor not enabled");
         #endif
+        mem_budget::print_report();
+        break;
+      case 'r':
+        #if FEATURE_MESH_NETWORK
+        radio_scheduler::print_status();
+        #else
+        Serial.println("Radio scheduler not enabled");
+        #endif
         break;
       case '\r':
       case '\n':
@@ -3303,6 +3944,11 @@ void setup() {
     log_health(LOG_LEVEL_CRITICAL, LOG_CAT_CRYPTO, "Provisioning failed", nullptr);
   }
 
+  // Record producers may queue from here on; nothing is written until start()
+  if (!witness_ingest::init(write_ingested_record)) {
+    log_health(LOG_LEVEL_CRITICAL, LOG_CAT_WITNESS, "Witness queue init failed", nullptr);
+  }
+
   pinMode(BOOT_BUTTON_GPIO, INPUT_PULLUP);
 
   // ════════════════════════════════════════════════════════════════════════════
@@ -3334,15 +3980,16 @@ void setup() {
     Serial.println("[..] Initializing SD card storage (with timeout)...");
     g_sd_spi.begin(SD_SCK_PIN, SD_MISO_PIN, SD_MOSI_PIN, SD_CS_PIN);
 
-    if (sd_mount_safe(g_sd_spi, SD_CS_PIN, SD_SPI_FAST)) {
+    // Mounting, hot-plug checks and record writes run on the SD worker;
+    // boot does not wait for the card. loop() logs the mount when it lands.
+    if (sd_worker_start(g_sd_spi, SD_CS_PIN, SD_SPI_FAST, sd_create_directories)) {
+      Serial.println("[OK] SD worker started — card mounts in the background");
+    } else if (sd_mount_safe(g_sd_spi, SD_CS_PIN, SD_SPI_FAST)) {
       g_sd_mounted = true;
       g_health.sd_healthy = true;
 
       // Create directories if needed (non-critical)
-      if (!SD.exists("/WITNESS")) SD.mkdir("/WITNESS");
-      if (!SD.exists("/HEALTH")) SD.mkdir("/HEALTH");
-      if (!SD.exists("/CHAIN")) SD.mkdir("/CHAIN");
-      if (!SD.exists("/EXPORT")) SD.mkdir("/EXPORT");
+      sd_create_directories();
 
       Serial.println("[OK] SD card ready for witness records");
       log_health(LOG_LEVEL_INFO, LOG_CAT_STORAGE, "SD card mounted", nullptr);
@@ -3357,6 +4004,15 @@ void setup() {
   }
   #endif
   
+  // Packed web UI on LittleFS (falls back to the embedded page)
+  #if FEATURE_HTTP_SERVER
+  if (!in_safe_mode && ui_assets::init()) {
+    Serial.println("[OK] Web UI assets mounted from LittleFS");
+  } else {
+    Serial.println("[--] Web UI assets not found — serving embedded UI");
+  }
+  #endif
+
   // Start WiFi Access Point
   #if FEATURE_WIFI_AP
   Serial.println("[..] Starting WiFi Access Point...");
@@ -3392,6 +4048,11 @@ void setup() {
   // Initialize mesh network (opera)
   #if FEATURE_MESH_NETWORK
   if (!in_safe_mode) {
+    // Channel time is shared by the AP, mesh and chirp; start before any ESP-NOW traffic
+    if (!radio_scheduler::init(AP_CHANNEL)) {
+      Serial.println("[--] Radio scheduler could not tune home channel");
+    }
+
     Serial.println("[..] Initializing mesh network (opera)...");
     if (mesh_network::init(g_device.privkey, g_device.pubkey, g_device.device_id)) {
       Serial.println("[OK] Mesh network initialized");
@@ -3404,6 +4065,30 @@ void setup() {
         snprintf(detail, sizeof(detail), "From %s: %s",
                  alert->sender_name, alert->detail);
         log_health((LogLevel)alert->severity, LOG_CAT_MESH, "Opera alert received", detail);
+
+        // Witness it; tamper reports jump ahead of routine telemetry
+        uint8_t payload[256];
+        size_t payload_len = 0;
+        if (build_peer_alert(alert, payload, sizeof(payload), &payload_len)) {
+          bool tamper = alert->type == mesh_network::ALERT_TAMPER ||
+                        alert->type == mesh_network::ALERT_BREACH ||
+                        alert->type == mesh_network::ALERT_OFFLINE_TAMPER;
+          submit_witness_record(RECORD_PEER_ALERT,
+                                tamper ? witness_ingest::PRIORITY_URGENT : witness_ingest::PRIORITY_ROUTINE,
+                                payload, payload_len);
+        }
+      });
+
+      // Witness each peer anchor; one that rewrites history goes first
+      mesh_network::set_anchor_callback([](const mesh_network::AnchorReceipt* receipt) {
+        uint8_t payload[128];
+        size_t payload_len = 0;
+        if (build_peer_anchor(receipt, payload, sizeof(payload), &payload_len)) {
+          submit_witness_record(RECORD_PEER_ANCHOR,
+                                receipt->conflict ? witness_ingest::PRIORITY_URGENT
+                                                  : witness_ingest::PRIORITY_ROUTINE,
+                                payload, payload_len);
+        }
       });
 
       mesh_network::set_peer_state_callback([](const mesh_network::OperaPeer* peer,
@@ -3424,6 +4109,24 @@ void setup() {
   }
   #endif
 
+  // Initialize RF presence before Bluetooth, which feeds it scan tokens.
+  // Probe capture sniffs on the AP's channel, so it needs the AP up.
+  #if FEATURE_RF_PRESENCE
+  if (!in_safe_mode) {
+    Serial.println("[..] Initializing RF presence...");
+    if (rf_presence::init()) {
+      Serial.println("[OK] RF presence initialized");
+      if (!g_wifi_status.ap_active || !probe_capture::start()) {
+        Serial.println("[--] WiFi probe capture unavailable");
+      }
+    } else {
+      Serial.println("[--] RF presence init failed");
+    }
+  } else {
+    Serial.println("[--] RF presence init skipped (safe mode)");
+  }
+  #endif
+
   // Initialize Bluetooth
   #if FEATURE_BLUETOOTH
   if (!in_safe_mode) {
@@ -3431,6 +4134,14 @@ void setup() {
     if (bluetooth_channel::init()) {
       Serial.println("[OK] Bluetooth initialized");
       log_health(LOG_LEVEL_INFO, LOG_CAT_BLUETOOTH, "Bluetooth initialized", nullptr);
+
+      #if FEATURE_SD_STORAGE
+      if (!ble_export::init(export_stream_bundle)) {
+        Serial.println("[--] BLE export channel unavailable");
+      }
+      #endif
+
+      scan_scheduler::init();
     } else {
       Serial.println("[--] Bluetooth init failed");
     }
@@ -3444,20 +4155,24 @@ void setup() {
   Serial.println("[..] Initializing system monitor...");
   sys_monitor::init();
   {
+    sys_monitor::SystemMetrics sys = sys_monitor::get_metrics();
     char psram_str[16];
-    if (sys_monitor::g_sys_metrics.psram_available) {
-      sys_monitor::format_bytes(sys_monitor::g_sys_metrics.psram_total, psram_str, sizeof(psram_str));
+    if (sys.psram_available) {
+      sys_monitor::format_bytes(sys.psram_total, psram_str, sizeof(psram_str));
     } else {
       strcpy(psram_str, "N/A");
     }
     Serial.printf("[OK] System monitor: %.1fC, Heap: %uKB, PSRAM: %s\n",
-                  sys_monitor::g_sys_metrics.temp_celsius,
-                  sys_monitor::g_sys_metrics.heap_free / 1024,
+                  sys.temp_celsius,
+                  sys.heap_free / 1024,
                   psram_str);
   }
   log_health(LOG_LEVEL_INFO, LOG_CAT_SYSTEM, "System monitor initialized", nullptr);
   #endif
 
+  // Where internal RAM went, once every subsystem has allocated
+  mem_budget::print_report();
+
   // ════════════════════════════════════════════════════════════════════════════
   // PHASE 4: GNSS — Initialize serial, probe only if not in safe mode
   // In safe mode, GPS probing is skipped to avoid potential hangs from
@@ -3491,6 +4206,9 @@ void setup() {
     hex_print(g_last_record.chain_hash, 8);
     Serial.println("...");
   }
+
+  // From here the writer task owns the chain
+  witness_ingest::start();
   
   // Log boot event
   log_health(LOG_LEVEL_INFO, LOG_CAT_SYSTEM, "Device boot complete", FIRMWARE_VERSION);
@@ -3593,6 +4311,13 @@ void loop() {
   sd_periodic_check(g_sd_spi, SD_CS_PIN, SD_SPI_FAST);
 
   // Sync SD hardware state to legacy flags
+  if (sd_is_available() != g_sd_mounted) {
+    if (sd_is_available()) {
+      log_health(LOG_LEVEL_INFO, LOG_CAT_STORAGE, "SD card mounted", nullptr);
+    } else {
+      log_health(LOG_LEVEL_WARNING, LOG_CAT_STORAGE, "SD card removed or failed", nullptr);
+    }
+  }
   g_sd_mounted = sd_is_available();
   g_health.sd_healthy = sd_is_available();
   #endif
@@ -3619,18 +4344,27 @@ void loop() {
 
   // Update mesh network
   #if FEATURE_MESH_NETWORK
+  radio_scheduler::update();
   mesh_network::update();
   #endif
 
   // Update Bluetooth
   #if FEATURE_BLUETOOTH
   bluetooth_channel::update();
+  scan_scheduler::update();
+  #endif
+
+  // Probe windows, then the RF state machine on the same task
+  #if FEATURE_RF_PRESENCE
+  probe_capture::update();
+  rf_presence::update();
   #endif
 
-  // Update system monitor (temp, heap, alerts)
+  // Report system monitor samples (alerts, periodic line); sampling is on its own task
   #if FEATURE_SYS_MONITOR
   sys_monitor::update(log_health);
   #endif
+  hw_state_publish();
 
   // Yield before witness record creation
   yield();
@@ -3642,38 +4376,34 @@ void loop() {
   if (now - g_last_record_ms >= RECORD_INTERVAL_MS) {
     g_last_record_ms = now;
 
-    uint8_t payload[512];
-    size_t payload_len = 0;
-    if (!build_witness_event(&g_fix, g_state, payload, sizeof(payload), &payload_len)) {
-      log_health(LOG_LEVEL_ERROR, LOG_CAT_WITNESS, "Payload build failed", nullptr);
-      return;
-    }
-
-    if (!create_witness_record(payload, payload_len, RECORD_WITNESS_EVENT, &g_last_record)) {
-      log_health(LOG_LEVEL_ERROR, LOG_CAT_CRYPTO, "Record verification failed", nullptr);
-    }
+    bool folded = false;
+    #if FEATURE_WITNESS_COALESCE
+    // An unchanged stationary sample only extends the open run
+    folded = coalesce_witness_sample(now);
+    #endif
 
-    // Print table row
-    print_table_row(&g_last_record, &g_fix, g_state);
+    if (!folded) {
+      uint8_t payload[512];
+      size_t payload_len = 0;
+      if (!build_witness_event(&g_fix, g_state, payload, sizeof(payload), &payload_len)) {
+        log_health(LOG_LEVEL_ERROR, LOG_CAT_WITNESS, "Payload build failed", nullptr);
+        return;
+      }
 
-    // Periodic status every 20 records
-    if (g_health.records_created % 20 == 0) {
-      print_status_bar();
-      print_table_header();
-    }
-  }
-  
-  // Periodic self-verification
-  if (now - g_last_verify_ms >= VERIFY_INTERVAL_SEC * 1000) {
-    g_last_verify_ms = now;
-    
-    if (!verify_record_signature(&g_last_record)) {
-      log_health(LOG_LEVEL_CRITICAL, LOG_CAT_CRYPTO, "Self-verification FAILED", nullptr);
-      g_health.crypto_healthy = false;
-    } else {
-      g_health.crypto_healthy = true;
+      // Written, printed and self-verified by the ingest writer
+      bool queued = submit_witness_record(RECORD_WITNESS_EVENT, witness_ingest::PRIORITY_ROUTINE,
+                                          payload, payload_len);
+      #if FEATURE_WITNESS_COALESCE
+      if (queued) open_witness_run(now);
+      #else
+      (void)queued;
+      #endif
     }
   }
+
+  // Fallback writer when the ingest task could not start
+  witness_ingest::poll();
+  print_record_rows();
   
   // Small delay to prevent tight loop
   delay(1);
@@ -0,0 +1,73 @@
+/*
+ * SecuraCV Canary — Double-Buffered Snapshots
+ *
+ * One writer task fills the back slot with begin(), then publish() makes
+ * it the front. Readers copy out of the front with read(), never block and
+ * never touch whatever produced the data. Each slot carries a sequence
+ * count (odd while it is being written), so a reader still copying when
+ * the writer comes round to its slot again notices and retries.
+ *
+ * Example usage:
+ *   static SnapshotBuffer<Sample> s_samples;
+ *   Sample& s = s_samples.begin();  fill(s);  s_samples.publish();
+ *   s_samples.read([&](const Sample& s) { out = s.value; });
+ */
+
+#ifndef SECURACV_SNAPSHOT_BUFFER_H
+#define SECURACV_SNAPSHOT_BUFFER_H
+
+#include <stdint.h>
+#include <atomic>
+
+template <typename T>
+class SnapshotBuffer {
+public:
+  // Writer only: the slot readers are not looking at, marked in progress
+  T& begin() {
+    Slot& s = m_slots[m_front.load(std::memory_order_relaxed) ^ 1];
+    s.seq.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    return s.value;
+  }
+
+  // Writer only: make the slot from begin() the front
+  void publish() {
+    uint8_t back = m_front.load(std::memory_order_relaxed) ^ 1;
+    m_slots[back].seq.fetch_add(1, std::memory_order_release);
+    m_front.store(back, std::memory_order_release);
+    m_published.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  // Call fn(const T&) on a consistent front slot; fn should only copy.
+  // False when every retry raced the writer: whatever fn copied last may
+  // be torn, so the caller must not use it.
+  template <typename Fn>
+  bool read(Fn fn) const {
+    for (uint8_t attempt = 0; attempt < MAX_RETRIES; attempt++) {
+      const Slot& s = m_slots[m_front.load(std::memory_order_acquire)];
+      uint32_t before = s.seq.load(std::memory_order_acquire);
+      if (before & 1) continue;
+      fn(s.value);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (s.seq.load(std::memory_order_relaxed) == before) return true;
+    }
+    return false;
+  }
+
+  // Snapshots published so far; 0 until the first publish()
+  uint32_t published() const { return m_published.load(std::memory_order_relaxed); }
+
+private:
+  static const uint8_t MAX_RETRIES = 8;
+
+  struct Slot {
+    std::atomic<uint32_t> seq{0};
+    T value{};
+  };
+
+  Slot m_slots[2];
+  std::atomic<uint8_t> m_front{0};
+  std::atomic<uint32_t> m_published{0};
+};
+
+#endif // SECURACV_SNAPSHOT_BUFFER_H
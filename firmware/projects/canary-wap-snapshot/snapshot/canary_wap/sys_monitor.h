@@ -10,6 +10,13 @@
  * Note: The ESP32-S3 does NOT have a built-in humidity sensor.
  * Humidity monitoring would require external hardware (DHT22, BME280, etc.)
  *
+ * Sampling runs on its own low-priority task every SAMPLE_INTERVAL_MS: it
+ * reads the sensor and heap, keeps the running statistics, renders the
+ * /api/system JSON and publishes both as one double-buffered snapshot.
+ * Readers (HTTP, serial, loop) copy the latest snapshot and never touch
+ * the hardware, so a slow sensor read stays off the request path. Alert
+ * transitions are logged from update() on the loop task, not the sampler.
+ *
  * Reference: https://docs.espressif.com/projects/esp-idf/en/stable/esp32s3/api-reference/peripherals/temp_sensor.html
  */
 
@@ -20,6 +27,8 @@
 #include <esp_mac.h>
 #include <esp_system.h>
 #include "log_level.h"
+#include "snapshot_buffer.h"
+#include "mem_budget.h"
 
 // ════════════════════════════════════════════════════════════════════════════
 // FEATURE FLAG
@@ -50,6 +59,12 @@ static const uint32_t METRICS_LOG_INTERVAL_MS = 30000;  // Every 30 seconds
 // How often to check for alerts (ms)
 static const uint32_t ALERT_CHECK_INTERVAL_MS = 5000;   // Every 5 seconds
 
+// Background sampler
+static const uint32_t SAMPLE_INTERVAL_MS    = 1000;     // Snapshot and JSON refresh
+static const uint32_t SAMPLER_TASK_STACK    = 4096;
+static const UBaseType_t SAMPLER_TASK_PRIORITY = 1;     // Just above idle
+static const size_t   JSON_CAPACITY         = 2048;     // Pre-rendered /api/system body
+
 // ════════════════════════════════════════════════════════════════════════════
 // TEMPERATURE ALERT STATE
 // ════════════════════════════════════════════════════════════════════════════
@@ -90,13 +105,18 @@ struct SystemMetrics {
   // CPU/System info (static, set once at init)
   uint32_t cpu_freq_mhz;         // CPU frequency
   uint32_t flash_size;           // Flash chip size
+  uint32_t flash_speed_mhz;      // Flash clock
+  uint32_t sketch_size;          // Running image size
+  uint32_t sketch_free;          // Free OTA space
+  uint64_t chip_id;              // eFuse MAC as an integer
   uint8_t  chip_revision;        // Chip revision number
   uint8_t  chip_cores;           // Number of CPU cores
   char     chip_model[24];       // Chip model string
+  char     mac_str[18];          // Default MAC, colon separated
+  esp_reset_reason_t reset_reason;
 
   // Timing
   uint32_t last_update_ms;       // Last metrics update
-  uint32_t last_log_ms;          // Last periodic log
   uint32_t last_alert_check_ms;  // Last alert check
   uint32_t uptime_sec;           // System uptime in seconds
 
@@ -104,14 +124,10 @@ struct SystemMetrics {
   uint32_t cold_alerts;          // Count of cold alerts
   uint32_t hot_alerts;           // Count of hot alerts
   bool     alert_active;         // Currently in an alert state
+  uint32_t temp_transitions;     // Alert state changes so far
+  TempAlertState temp_prev_state;  // State before the latest change
 };
 
-// ════════════════════════════════════════════════════════════════════════════
-// GLOBAL METRICS INSTANCE
-// ════════════════════════════════════════════════════════════════════════════
-
-extern SystemMetrics g_sys_metrics;
-
 // ════════════════════════════════════════════════════════════════════════════
 // API FUNCTIONS
 // ════════════════════════════════════════════════════════════════════════════
@@ -119,19 +135,25 @@ extern SystemMetrics g_sys_metrics;
 /**
  * Initialize the system monitor.
  * Call once in setup() after Serial is ready.
- * Reads initial system info and takes first temperature reading.
+ * Reads static system info, publishes the first snapshot and starts the
+ * sampler task.
  */
 void init();
 
 /**
- * Update system metrics.
- * Call regularly in loop() - internally rate-limited.
- * Updates temperature, heap, and checks for alerts.
+ * Report what the sampler has seen.
+ * Call regularly in loop(). Logs alert state changes and the periodic
+ * status line from the latest snapshot; reads no hardware.
  *
  * @param log_callback Optional callback for logging alerts
  */
 void update(void (*log_callback)(LogLevel, LogCategory, const char*, const char*) = nullptr);
 
+/**
+ * Get a consistent copy of the latest snapshot.
+ */
+SystemMetrics get_metrics();
+
 /**
  * Get the current temperature in Celsius.
  * Uses the ESP32-S3 internal temperature sensor.
@@ -169,7 +191,7 @@ void print_status_line();
 
 /**
  * Get system metrics as JSON string.
- * Useful for HTTP API responses.
+ * Copies the JSON pre-rendered with the latest snapshot.
  *
  * @param buf Buffer to write JSON into
  * @param buf_size Size of buffer
@@ -201,59 +223,92 @@ const char* format_uptime(uint32_t seconds, char* buf, size_t buf_size);
 
 namespace sys_monitor {
 
-// Global metrics instance
-SystemMetrics g_sys_metrics;
-
 // EMA alpha for temperature averaging
 static const float TEMP_EMA_ALPHA = 0.1f;
 
+// What readers copy: the metrics and the JSON rendered from them
+struct Snapshot {
+  SystemMetrics metrics;
+  uint16_t json_len;
+  char json[JSON_CAPACITY];
+};
+
+// Working metrics, owned by the sampler task once init() returns
+static SystemMetrics s_work;
+static SnapshotBuffer<Snapshot> s_snapshots;
+MEM_BUDGET_STATIC("sysmon", s_snapshots);
+
+static size_t render_json(const SystemMetrics& m, char* buf, size_t buf_size);
+static void sample();
+
+static void sampler_task(void*) {
+  TickType_t last_wake = xTaskGetTickCount();
+  for (;;) {
+    vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(SAMPLE_INTERVAL_MS));
+    sample();
+  }
+}
+
 // ────────────────────────────────────────────────────────────────────────────
 
 void init() {
-  memset(&g_sys_metrics, 0, sizeof(g_sys_metrics));
+  memset(&s_work, 0, sizeof(s_work));
 
   // Initialize temperature tracking with extremes
-  g_sys_metrics.temp_min = 999.0f;
-  g_sys_metrics.temp_max = -999.0f;
-  g_sys_metrics.temp_state = TEMP_NORMAL;
+  s_work.temp_min = 999.0f;
+  s_work.temp_max = -999.0f;
+  s_work.temp_state = TEMP_NORMAL;
 
   // Get static system info
-  g_sys_metrics.cpu_freq_mhz = ESP.getCpuFreqMHz();
-  g_sys_metrics.flash_size = ESP.getFlashChipSize();
-  g_sys_metrics.chip_revision = ESP.getChipRevision();
-  g_sys_metrics.chip_cores = ESP.getChipCores();
+  s_work.cpu_freq_mhz = ESP.getCpuFreqMHz();
+  s_work.flash_size = ESP.getFlashChipSize();
+  s_work.flash_speed_mhz = ESP.getFlashChipSpeed() / 1000000;
+  s_work.sketch_size = ESP.getSketchSize();
+  s_work.sketch_free = ESP.getFreeSketchSpace();
+  s_work.chip_id = ESP.getEfuseMac();
+  s_work.chip_revision = ESP.getChipRevision();
+  s_work.chip_cores = ESP.getChipCores();
+  s_work.reset_reason = esp_reset_reason();
 
   // Get chip model (use snprintf for guaranteed null-termination)
   const char* model = ESP.getChipModel();
-  snprintf(g_sys_metrics.chip_model, sizeof(g_sys_metrics.chip_model), "%s", model ? model : "ESP32-S3");
+  snprintf(s_work.chip_model, sizeof(s_work.chip_model), "%s", model ? model : "ESP32-S3");
+
+  uint8_t mac[6];
+  esp_efuse_mac_get_default(mac);
+  snprintf(s_work.mac_str, sizeof(s_work.mac_str), "%02X:%02X:%02X:%02X:%02X:%02X",
+           mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
 
   // Get heap info
-  g_sys_metrics.heap_total = ESP.getHeapSize();
-  g_sys_metrics.heap_free = ESP.getFreeHeap();
-  g_sys_metrics.heap_min_free = g_sys_metrics.heap_free;
-  g_sys_metrics.heap_largest_block = ESP.getMaxAllocHeap();
+  s_work.heap_total = ESP.getHeapSize();
+  s_work.heap_min_free = UINT32_MAX;
 
   // Check for PSRAM
-  g_sys_metrics.psram_available = ESP.getPsramSize() > 0;
-  if (g_sys_metrics.psram_available) {
-    g_sys_metrics.psram_total = ESP.getPsramSize();
-    g_sys_metrics.psram_free = ESP.getFreePsram();
-    g_sys_metrics.psram_min_free = g_sys_metrics.psram_free;
+  s_work.psram_available = ESP.getPsramSize() > 0;
+  if (s_work.psram_available) {
+    s_work.psram_total = ESP.getPsramSize();
+    s_work.psram_min_free = UINT32_MAX;
   }
 
-  // Take initial temperature reading
-  float temp = get_temperature();
-  if (!isnan(temp)) {
-    g_sys_metrics.temp_celsius = temp;
-    g_sys_metrics.temp_min = temp;
-    g_sys_metrics.temp_max = temp;
-    g_sys_metrics.temp_avg = temp;
-    g_sys_metrics.temp_readings = 1;
+  // First snapshot on the caller, so readers never see an empty one
+  s_work.last_alert_check_ms = millis();
+  sample();
+
+  if (xTaskCreate(sampler_task, "sys_monitor", SAMPLER_TASK_STACK, nullptr,
+                  SAMPLER_TASK_PRIORITY, nullptr) != pdPASS) {
+    Serial.println("[!!] System monitor sampler task failed; metrics will not refresh");
   }
+}
+
+// ────────────────────────────────────────────────────────────────────────────
 
-  g_sys_metrics.last_update_ms = millis();
-  g_sys_metrics.last_log_ms = millis();
-  g_sys_metrics.last_alert_check_ms = millis();
+SystemMetrics get_metrics() {
+  // Zeroed rather than torn if the sampler kept winning the race
+  SystemMetrics m{};
+  if (!s_snapshots.read([&](const Snapshot& snap) { m = snap.metrics; })) {
+    m = SystemMetrics{};
+  }
+  return m;
 }
 
 // ────────────────────────────────────────────────────────────────────────────
@@ -267,7 +322,9 @@ float get_temperature() {
 // ────────────────────────────────────────────────────────────────────────────
 
 TempAlertState get_temp_state() {
-  return g_sys_metrics.temp_state;
+  TempAlertState state = TEMP_NORMAL;
+  s_snapshots.read([&](const Snapshot& snap) { state = snap.metrics.temp_state; });
+  return state;
 }
 
 // ────────────────────────────────────────────────────────────────────────────
@@ -286,7 +343,9 @@ const char* temp_state_name(TempAlertState state) {
 // ────────────────────────────────────────────────────────────────────────────
 
 bool is_alert_active() {
-  return g_sys_metrics.alert_active;
+  bool active = false;
+  s_snapshots.read([&](const Snapshot& snap) { active = snap.metrics.alert_active; });
+  return active;
 }
 
 // ────────────────────────────────────────────────────────────────────────────
@@ -334,93 +393,117 @@ static TempAlertState evaluate_temp_state(float temp, TempAlertState current) {
 
 // ────────────────────────────────────────────────────────────────────────────
 
-void update(void (*log_callback)(LogLevel, LogCategory, const char*, const char*)) {
+// Sampler task: read the hardware, fold into s_work, publish
+static void sample() {
   uint32_t now = millis();
 
   // Update uptime
-  g_sys_metrics.uptime_sec = now / 1000;
+  s_work.uptime_sec = now / 1000;
 
   // Update heap metrics
-  g_sys_metrics.heap_free = ESP.getFreeHeap();
-  g_sys_metrics.heap_largest_block = ESP.getMaxAllocHeap();
-  if (g_sys_metrics.heap_free < g_sys_metrics.heap_min_free) {
-    g_sys_metrics.heap_min_free = g_sys_metrics.heap_free;
+  s_work.heap_free = ESP.getFreeHeap();
+  s_work.heap_largest_block = ESP.getMaxAllocHeap();
+  if (s_work.heap_free < s_work.heap_min_free) {
+    s_work.heap_min_free = s_work.heap_free;
   }
 
   // Update PSRAM metrics
-  if (g_sys_metrics.psram_available) {
-    g_sys_metrics.psram_free = ESP.getFreePsram();
-    if (g_sys_metrics.psram_free < g_sys_metrics.psram_min_free) {
-      g_sys_metrics.psram_min_free = g_sys_metrics.psram_free;
+  if (s_work.psram_available) {
+    s_work.psram_free = ESP.getFreePsram();
+    if (s_work.psram_free < s_work.psram_min_free) {
+      s_work.psram_min_free = s_work.psram_free;
     }
   }
 
   // Read temperature
   float temp = get_temperature();
   if (!isnan(temp)) {
-    g_sys_metrics.temp_celsius = temp;
-    g_sys_metrics.temp_readings++;
+    s_work.temp_celsius = temp;
+    s_work.temp_readings++;
 
     // Update min/max
-    if (temp < g_sys_metrics.temp_min) g_sys_metrics.temp_min = temp;
-    if (temp > g_sys_metrics.temp_max) g_sys_metrics.temp_max = temp;
+    if (temp < s_work.temp_min) s_work.temp_min = temp;
+    if (temp > s_work.temp_max) s_work.temp_max = temp;
 
     // Update EMA average
-    if (g_sys_metrics.temp_readings == 1) {
-      g_sys_metrics.temp_avg = temp;
+    if (s_work.temp_readings == 1) {
+      s_work.temp_avg = temp;
     } else {
-      g_sys_metrics.temp_avg = TEMP_EMA_ALPHA * temp + (1.0f - TEMP_EMA_ALPHA) * g_sys_metrics.temp_avg;
+      s_work.temp_avg = TEMP_EMA_ALPHA * temp + (1.0f - TEMP_EMA_ALPHA) * s_work.temp_avg;
     }
   }
 
-  g_sys_metrics.last_update_ms = now;
+  s_work.last_update_ms = now;
 
-  // Check for temperature alerts (rate limited)
-  if (now - g_sys_metrics.last_alert_check_ms >= ALERT_CHECK_INTERVAL_MS) {
-    g_sys_metrics.last_alert_check_ms = now;
+  // Check for temperature alerts (rate limited); update() logs the change
+  if (now - s_work.last_alert_check_ms >= ALERT_CHECK_INTERVAL_MS) {
+    s_work.last_alert_check_ms = now;
 
-    TempAlertState new_state = evaluate_temp_state(g_sys_metrics.temp_celsius, g_sys_metrics.temp_state);
-
-    // State transition - log if changed
-    if (new_state != g_sys_metrics.temp_state) {
-      TempAlertState old_state = g_sys_metrics.temp_state;
-      g_sys_metrics.temp_state = new_state;
+    TempAlertState new_state = evaluate_temp_state(s_work.temp_celsius, s_work.temp_state);
+    if (new_state != s_work.temp_state) {
+      s_work.temp_prev_state = s_work.temp_state;
+      s_work.temp_state = new_state;
+      s_work.temp_transitions++;
 
       // Track alerts
       if (new_state == TEMP_COLD_WARN || new_state == TEMP_COLD_CRIT) {
-        g_sys_metrics.cold_alerts++;
+        s_work.cold_alerts++;
       } else if (new_state == TEMP_HOT_WARN || new_state == TEMP_HOT_CRIT) {
-        g_sys_metrics.hot_alerts++;
+        s_work.hot_alerts++;
       }
 
       // Update alert flag
-      g_sys_metrics.alert_active = (new_state != TEMP_NORMAL);
-
-      // Log the state change
-      if (log_callback) {
-        char detail[64];
-        snprintf(detail, sizeof(detail), "%.1fC %s->%s",
-                 g_sys_metrics.temp_celsius,
-                 temp_state_name(old_state),
-                 temp_state_name(new_state));
-
-        LogLevel level;
-        if (new_state == TEMP_COLD_CRIT || new_state == TEMP_HOT_CRIT) {
-          level = LOG_LEVEL_ALERT;
-        } else if (new_state == TEMP_COLD_WARN || new_state == TEMP_HOT_WARN) {
-          level = LOG_LEVEL_WARNING;
-        } else {
-          level = LOG_LEVEL_INFO;
-        }
-
-        log_callback(level, LOG_CAT_SENSOR, "Temp alert state change", detail);
+      s_work.alert_active = (new_state != TEMP_NORMAL);
+    }
+  }
+
+  Snapshot& snap = s_snapshots.begin();
+  snap.metrics = s_work;
+  snap.json_len = (uint16_t)render_json(s_work, snap.json, sizeof(snap.json));
+  s_snapshots.publish();
+}
+
+// ────────────────────────────────────────────────────────────────────────────
+
+void update(void (*log_callback)(LogLevel, LogCategory, const char*, const char*)) {
+  static uint32_t s_logged_transitions = 0;
+  static uint32_t s_last_log_ms = 0;
+
+  uint32_t now = millis();
+  bool changed = false, due = now - s_last_log_ms >= METRICS_LOG_INTERVAL_MS;
+  SystemMetrics m{};
+  bool ok = s_snapshots.read([&](const Snapshot& snap) {
+    changed = snap.metrics.temp_transitions != s_logged_transitions;
+    if (changed || due) m = snap.metrics;
+  });
+  if (!ok) return;  // Torn copy; the next pass reads again
+
+  // Log the latest state change (several within one loop pass log once)
+  if (changed) {
+    s_logged_transitions = m.temp_transitions;
+    if (log_callback) {
+      char detail[64];
+      snprintf(detail, sizeof(detail), "%.1fC %s->%s",
+               m.temp_celsius,
+               temp_state_name(m.temp_prev_state),
+               temp_state_name(m.temp_state));
+
+      LogLevel level;
+      if (m.temp_state == TEMP_COLD_CRIT || m.temp_state == TEMP_HOT_CRIT) {
+        level = LOG_LEVEL_ALERT;
+      } else if (m.temp_state == TEMP_COLD_WARN || m.temp_state == TEMP_HOT_WARN) {
+        level = LOG_LEVEL_WARNING;
+      } else {
+        level = LOG_LEVEL_INFO;
       }
+
+      log_callback(level, LOG_CAT_SENSOR, "Temp alert state change", detail);
     }
   }
 
   // Periodic status logging
-  if (now - g_sys_metrics.last_log_ms >= METRICS_LOG_INTERVAL_MS) {
-    g_sys_metrics.last_log_ms = now;
+  if (due) {
+    s_last_log_ms = now;
     print_status_line();
   }
 }
@@ -464,22 +547,23 @@ inline float celsius_to_fahrenheit(float c) {
 // ────────────────────────────────────────────────────────────────────────────
 
 void print_status_line() {
+  const SystemMetrics m = get_metrics();
   char heap_str[16], psram_str[16], uptime_str[16];
 
-  format_bytes(g_sys_metrics.heap_free, heap_str, sizeof(heap_str));
-  format_uptime(g_sys_metrics.uptime_sec, uptime_str, sizeof(uptime_str));
+  format_bytes(m.heap_free, heap_str, sizeof(heap_str));
+  format_uptime(m.uptime_sec, uptime_str, sizeof(uptime_str));
 
-  float temp_f = celsius_to_fahrenheit(g_sys_metrics.temp_celsius);
+  float temp_f = celsius_to_fahrenheit(m.temp_celsius);
 
   Serial.printf("[SYS] %s | Temp: %.1fC/%.1fF [%s] | Heap: %s | ",
                 uptime_str,
-                g_sys_metrics.temp_celsius,
+                m.temp_celsius,
                 temp_f,
-                temp_state_name(g_sys_metrics.temp_state),
+                temp_state_name(m.temp_state),
                 heap_str);
 
-  if (g_sys_metrics.psram_available) {
-    format_bytes(g_sys_metrics.psram_free, psram_str, sizeof(psram_str));
+  if (m.psram_available) {
+    format_bytes(m.psram_free, psram_str, sizeof(psram_str));
     Serial.printf("PSRAM: %s\n", psram_str);
   } else {
     Serial.println("No PSRAM");
@@ -559,13 +643,14 @@ static void print_memory_bar(const char* label, uint32_t used, uint32_t total, i
 // ────────────────────────────────────────────────────────────────────────────
 
 void print_status() {
+  const SystemMetrics m = get_metrics();
   char buf1[32], buf2[32];
 
-  float temp_c = g_sys_metrics.temp_celsius;
+  float temp_c = m.temp_celsius;
   float temp_f = celsius_to_fahrenheit(temp_c);
-  float temp_min_f = celsius_to_fahrenheit(g_sys_metrics.temp_min);
-  float temp_max_f = celsius_to_fahrenheit(g_sys_metrics.temp_max);
-  float temp_avg_f = celsius_to_fahrenheit(g_sys_metrics.temp_avg);
+  float temp_min_f = celsius_to_fahrenheit(m.temp_min);
+  float temp_max_f = celsius_to_fahrenheit(m.temp_max);
+  float temp_avg_f = celsius_to_fahrenheit(m.temp_avg);
 
   Serial.println();
   Serial.println("================================================================================");
@@ -578,26 +663,21 @@ void print_status() {
   Serial.println();
   Serial.println("--- DEVICE INFORMATION --------------------------------------------------------");
 
-  Serial.printf("  Chip Model     : %s (rev %u)\n", g_sys_metrics.chip_model, g_sys_metrics.chip_revision);
-  Serial.printf("  CPU            : %u cores @ %u MHz\n", g_sys_metrics.chip_cores, g_sys_metrics.cpu_freq_mhz);
-  Serial.printf("  Flash Size     : %s\n", format_bytes(g_sys_metrics.flash_size, buf1, sizeof(buf1)));
+  Serial.printf("  Chip Model     : %s (rev %u)\n", m.chip_model, m.chip_revision);
+  Serial.printf("  CPU            : %u cores @ %u MHz\n", m.chip_cores, m.cpu_freq_mhz);
+  Serial.printf("  Flash Size     : %s\n", format_bytes(m.flash_size, buf1, sizeof(buf1)));
   Serial.printf("  SDK Version    : %s\n", ESP.getSdkVersion());
-  Serial.printf("  Sketch Size    : %s\n", format_bytes(ESP.getSketchSize(), buf1, sizeof(buf1)));
+  Serial.printf("  Sketch Size    : %s\n", format_bytes(m.sketch_size, buf1, sizeof(buf1)));
   Serial.printf("  Sketch MD5     : %s\n", ESP.getSketchMD5().c_str());
 
-  // MAC Address
-  uint8_t mac[6];
-  esp_efuse_mac_get_default(mac);
-  Serial.printf("  MAC Address    : %02X:%02X:%02X:%02X:%02X:%02X\n",
-                mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
-
-  Serial.printf("  Chip ID        : %llX\n", ESP.getEfuseMac());
+  Serial.printf("  MAC Address    : %s\n", m.mac_str);
+  Serial.printf("  Chip ID        : %llX\n", (unsigned long long)m.chip_id);
   Serial.printf("  Flash Mode     : %s\n",
     ESP.getFlashChipMode() == FM_QIO ? "QIO" :
     ESP.getFlashChipMode() == FM_QOUT ? "QOUT" :
     ESP.getFlashChipMode() == FM_DIO ? "DIO" :
     ESP.getFlashChipMode() == FM_DOUT ? "DOUT" : "Unknown");
-  Serial.printf("  Flash Speed    : %u MHz\n", ESP.getFlashChipSpeed() / 1000000);
+  Serial.printf("  Flash Speed    : %u MHz\n", m.flash_speed_mhz);
 
   // ─────────────────────────────────────────────────────────────────────────
   // TEMPERATURE
@@ -608,17 +688,17 @@ void print_status() {
 
   // Current temperature with big display
   Serial.printf("  CURRENT:  %.1f C  /  %.1f F    [%s]\n",
-                temp_c, temp_f, temp_state_name(g_sys_metrics.temp_state));
+                temp_c, temp_f, temp_state_name(m.temp_state));
   Serial.println();
 
   // Visual meter
   print_temp_meter(temp_c);
 
   Serial.println();
-  Serial.printf("  Session Min  : %6.1f C  / %6.1f F\n", g_sys_metrics.temp_min, temp_min_f);
-  Serial.printf("  Session Max  : %6.1f C  / %6.1f F\n", g_sys_metrics.temp_max, temp_max_f);
-  Serial.printf("  Average (EMA): %6.1f C  / %6.1f F\n", g_sys_metrics.temp_avg, temp_avg_f);
-  Serial.printf("  Readings     : %u\n", g_sys_metrics.temp_readings);
+  Serial.printf("  Session Min  : %6.1f C  / %6.1f F\n", m.temp_min, temp_min_f);
+  Serial.printf("  Session Max  : %6.1f C  / %6.1f F\n", m.temp_max, temp_max_f);
+  Serial.printf("  Average (EMA): %6.1f C  / %6.1f F\n", m.temp_avg, temp_avg_f);
+  Serial.printf("  Readings     : %u\n", m.temp_readings);
 
   // ─────────────────────────────────────────────────────────────────────────
   // TEMPERATURE ZONES REFERENCE
@@ -645,7 +725,7 @@ void print_status() {
 
   Serial.println();
   Serial.printf("  Alert History: %u cold alerts, %u hot alerts\n",
-                g_sys_metrics.cold_alerts, g_sys_metrics.hot_alerts);
+                m.cold_alerts, m.hot_alerts);
 
   // ─────────────────────────────────────────────────────────────────────────
   // MEMORY
@@ -656,20 +736,20 @@ void print_status() {
 
   // Internal Heap
   Serial.println("  INTERNAL HEAP (SRAM):");
-  uint32_t heap_used = g_sys_metrics.heap_total - g_sys_metrics.heap_free;
-  print_memory_bar("Used", heap_used, g_sys_metrics.heap_total);
-  Serial.printf("  Free Now     : %s\n", format_bytes(g_sys_metrics.heap_free, buf1, sizeof(buf1)));
-  Serial.printf("  Min Free Ever: %s (high water mark)\n", format_bytes(g_sys_metrics.heap_min_free, buf1, sizeof(buf1)));
-  Serial.printf("  Largest Block: %s (max single allocation)\n", format_bytes(g_sys_metrics.heap_largest_block, buf1, sizeof(buf1)));
+  uint32_t heap_used = m.heap_total - m.heap_free;
+  print_memory_bar("Used", heap_used, m.heap_total);
+  Serial.printf("  Free Now     : %s\n", format_bytes(m.heap_free, buf1, sizeof(buf1)));
+  Serial.printf("  Min Free Ever: %s (high water mark)\n", format_bytes(m.heap_min_free, buf1, sizeof(buf1)));
+  Serial.printf("  Largest Block: %s (max single allocation)\n", format_bytes(m.heap_largest_block, buf1, sizeof(buf1)));
 
   // PSRAM
   Serial.println();
-  if (g_sys_metrics.psram_available) {
+  if (m.psram_available) {
     Serial.println("  PSRAM (External SPI RAM):");
-    uint32_t psram_used = g_sys_metrics.psram_total - g_sys_metrics.psram_free;
-    print_memory_bar("Used", psram_used, g_sys_metrics.psram_total);
-    Serial.printf("  Free Now     : %s\n", format_bytes(g_sys_metrics.psram_free, buf1, sizeof(buf1)));
-    Serial.printf("  Min Free Ever: %s\n", format_bytes(g_sys_metrics.psram_min_free, buf1, sizeof(buf1)));
+    uint32_t psram_used = m.psram_total - m.psram_free;
+    print_memory_bar("Used", psram_used, m.psram_total);
+    Serial.printf("  Free Now     : %s\n", format_bytes(m.psram_free, buf1, sizeof(buf1)));
+    Serial.printf("  Min Free Ever: %s\n", format_bytes(m.psram_min_free, buf1, sizeof(buf1)));
   } else {
     Serial.println("  PSRAM: Not detected or not enabled");
   }
@@ -677,8 +757,8 @@ void print_status() {
   // Sketch memory
   Serial.println();
   Serial.println("  FLASH PROGRAM MEMORY:");
-  uint32_t sketch_used = ESP.getSketchSize();
-  uint32_t sketch_total = ESP.getFreeSketchSpace() + sketch_used;
+  uint32_t sketch_used = m.sketch_size;
+  uint32_t sketch_total = m.sketch_free + sketch_used;
   print_memory_bar("Used", sketch_used, sketch_total);
 
   // ─────────────────────────────────────────────────────────────────────────
@@ -687,20 +767,20 @@ void print_status() {
   Serial.println();
   Serial.println("--- RUNTIME -------------------------------------------------------------------");
   Serial.printf("  Uptime       : %s (%u seconds)\n",
-                format_uptime(g_sys_metrics.uptime_sec, buf1, sizeof(buf1)),
-                g_sys_metrics.uptime_sec);
+                format_uptime(m.uptime_sec, buf1, sizeof(buf1)),
+                m.uptime_sec);
   Serial.printf("  CPU Cycles   : %llu\n", (unsigned long long)ESP.getCycleCount());
   Serial.printf("  Reset Reason : %s\n",
-    esp_reset_reason() == ESP_RST_POWERON ? "Power-on" :
-    esp_reset_reason() == ESP_RST_EXT ? "External" :
-    esp_reset_reason() == ESP_RST_SW ? "Software" :
-    esp_reset_reason() == ESP_RST_PANIC ? "Panic" :
-    esp_reset_reason() == ESP_RST_INT_WDT ? "Interrupt WDT" :
-    esp_reset_reason() == ESP_RST_TASK_WDT ? "Task WDT" :
-    esp_reset_reason() == ESP_RST_WDT ? "Other WDT" :
-    esp_reset_reason() == ESP_RST_DEEPSLEEP ? "Deep Sleep" :
-    esp_reset_reason() == ESP_RST_BROWNOUT ? "Brownout" :
-    esp_reset_reason() == ESP_RST_SDIO ? "SDIO" : "Unknown");
+    m.reset_reason == ESP_RST_POWERON ? "Power-on" :
+    m.reset_reason == ESP_RST_EXT ? "External" :
+    m.reset_reason == ESP_RST_SW ? "Software" :
+    m.reset_reason == ESP_RST_PANIC ? "Panic" :
+    m.reset_reason == ESP_RST_INT_WDT ? "Interrupt WDT" :
+    m.reset_reason == ESP_RST_TASK_WDT ? "Task WDT" :
+    m.reset_reason == ESP_RST_WDT ? "Other WDT" :
+    m.reset_reason == ESP_RST_DEEPSLEEP ? "Deep Sleep" :
+    m.reset_reason == ESP_RST_BROWNOUT ? "Brownout" :
+    m.reset_reason == ESP_RST_SDIO ? "SDIO" : "Unknown");
 
   // ─────────────────────────────────────────────────────────────────────────
   // NOTES
@@ -718,27 +798,20 @@ void print_status() {
 
 // ────────────────────────────────────────────────────────────────────────────
 
-size_t get_json(char* buf, size_t buf_size) {
+static size_t render_json(const SystemMetrics& m, char* buf, size_t buf_size) {
   char uptime_str[16];
-  format_uptime(g_sys_metrics.uptime_sec, uptime_str, sizeof(uptime_str));
+  format_uptime(m.uptime_sec, uptime_str, sizeof(uptime_str));
 
   // Guard against division by zero
-  float heap_pct = g_sys_metrics.heap_total > 0
-    ? (float)(g_sys_metrics.heap_total - g_sys_metrics.heap_free) / g_sys_metrics.heap_total * 100.0f
+  float heap_pct = m.heap_total > 0
+    ? (float)(m.heap_total - m.heap_free) / m.heap_total * 100.0f
     : 0.0f;
 
-  // Get MAC address
-  uint8_t mac[6];
-  esp_efuse_mac_get_default(mac);
-  char mac_str[18];
-  snprintf(mac_str, sizeof(mac_str), "%02X:%02X:%02X:%02X:%02X:%02X",
-           mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
-
   // Calculate Fahrenheit values
-  float temp_f = celsius_to_fahrenheit(g_sys_metrics.temp_celsius);
-  float temp_min_f = celsius_to_fahrenheit(g_sys_metrics.temp_min);
-  float temp_max_f = celsius_to_fahrenheit(g_sys_metrics.temp_max);
-  float temp_avg_f = celsius_to_fahrenheit(g_sys_metrics.temp_avg);
+  float temp_f = celsius_to_fahrenheit(m.temp_celsius);
+  float temp_min_f = celsius_to_fahrenheit(m.temp_min);
+  float temp_max_f = celsius_to_fahrenheit(m.temp_max);
+  float temp_avg_f = celsius_to_fahrenheit(m.temp_avg);
 
   int len = snprintf(buf, buf_size,
     "{"
@@ -777,62 +850,74 @@ size_t get_json(char* buf, size_t buf_size) {
     "\"humidity_available\":false"
     "}",
     // Celsius
-    g_sys_metrics.temp_celsius,
-    g_sys_metrics.temp_min,
-    g_sys_metrics.temp_max,
-    g_sys_metrics.temp_avg,
+    m.temp_celsius,
+    m.temp_min,
+    m.temp_max,
+    m.temp_avg,
     // Fahrenheit
     temp_f, temp_min_f, temp_max_f, temp_avg_f,
-    temp_state_name(g_sys_metrics.temp_state),
-    g_sys_metrics.alert_active ? "true" : "false",
+    temp_state_name(m.temp_state),
+    m.alert_active ? "true" : "false",
     // Thresholds C and F
     TEMP_COLD_WARNING, celsius_to_fahrenheit(TEMP_COLD_WARNING),
     TEMP_COLD_CRITICAL, celsius_to_fahrenheit(TEMP_COLD_CRITICAL),
     TEMP_HOT_WARNING, celsius_to_fahrenheit(TEMP_HOT_WARNING),
     TEMP_HOT_CRITICAL, celsius_to_fahrenheit(TEMP_HOT_CRITICAL),
-    g_sys_metrics.cold_alerts,
-    g_sys_metrics.hot_alerts,
-    g_sys_metrics.temp_readings,
+    m.cold_alerts,
+    m.hot_alerts,
+    m.temp_readings,
     // Memory
-    g_sys_metrics.heap_total,
-    g_sys_metrics.heap_free,
-    g_sys_metrics.heap_min_free,
-    g_sys_metrics.heap_largest_block,
+    m.heap_total,
+    m.heap_free,
+    m.heap_min_free,
+    m.heap_largest_block,
     heap_pct,
-    g_sys_metrics.psram_available ? "true" : "false",
-    g_sys_metrics.psram_total,
-    g_sys_metrics.psram_free,
-    g_sys_metrics.psram_min_free,
-    ESP.getSketchSize(),
-    ESP.getFreeSketchSpace(),
+    m.psram_available ? "true" : "false",
+    m.psram_total,
+    m.psram_free,
+    m.psram_min_free,
+    m.sketch_size,
+    m.sketch_free,
     // Device
-    g_sys_metrics.chip_model,
-    g_sys_metrics.chip_revision,
-    g_sys_metrics.chip_cores,
-    g_sys_metrics.cpu_freq_mhz,
-    g_sys_metrics.flash_size,
-    ESP.getFlashChipSpeed() / 1000000,
-    mac_str,
-    (unsigned long long)ESP.getEfuseMac(),
+    m.chip_model,
+    m.chip_revision,
+    m.chip_cores,
+    m.cpu_freq_mhz,
+    m.flash_size,
+    m.flash_speed_mhz,
+    m.mac_str,
+    (unsigned long long)m.chip_id,
     ESP.getSdkVersion(),
-    esp_reset_reason() == ESP_RST_POWERON ? "power_on" :
-    esp_reset_reason() == ESP_RST_EXT ? "external" :
-    esp_reset_reason() == ESP_RST_SW ? "software" :
-    esp_reset_reason() == ESP_RST_PANIC ? "panic" :
-    esp_reset_reason() == ESP_RST_INT_WDT ? "interrupt_wdt" :
-    esp_reset_reason() == ESP_RST_TASK_WDT ? "task_wdt" :
-    esp_reset_reason() == ESP_RST_WDT ? "other_wdt" :
-    esp_reset_reason() == ESP_RST_DEEPSLEEP ? "deep_sleep" :
-    esp_reset_reason() == ESP_RST_BROWNOUT ? "brownout" :
-    esp_reset_reason() == ESP_RST_SDIO ? "sdio" : "unknown",
+    m.reset_reason == ESP_RST_POWERON ? "power_on" :
+    m.reset_reason == ESP_RST_EXT ? "external" :
+    m.reset_reason == ESP_RST_SW ? "software" :
+    m.reset_reason == ESP_RST_PANIC ? "panic" :
+    m.reset_reason == ESP_RST_INT_WDT ? "interrupt_wdt" :
+    m.reset_reason == ESP_RST_TASK_WDT ? "task_wdt" :
+    m.reset_reason == ESP_RST_WDT ? "other_wdt" :
+    m.reset_reason == ESP_RST_DEEPSLEEP ? "deep_sleep" :
+    m.reset_reason == ESP_RST_BROWNOUT ? "brownout" :
+    m.reset_reason == ESP_RST_SDIO ? "sdio" : "unknown",
     // Uptime
-    g_sys_metrics.uptime_sec,
+    m.uptime_sec,
     uptime_str
   );
 
   return (len > 0 && len < (int)buf_size) ? len : 0;
 }
 
+// ────────────────────────────────────────────────────────────────────────────
+
+size_t get_json(char* buf, size_t buf_size) {
+  size_t len = 0;
+  bool ok = s_snapshots.read([&](const Snapshot& snap) {
+    len = snap.json_len;
+    if (len == 0 || len >= buf_size) { len = 0; return; }
+    memcpy(buf, snap.json, len + 1);
+  });
+  return ok ? len : 0;
+}
+
 } // namespace sys_monitor
 
 #endif // FEATURE_SYS_MONITOR
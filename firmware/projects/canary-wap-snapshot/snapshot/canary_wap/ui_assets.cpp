@@ -0,0 +1,311 @@
+/*
+ * SecuraCV Canary — Web UI Assets Implementation
+ */
+
+#include "ui_assets.h"
+#include "mem_budget.h"
+#include <LittleFS.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+namespace ui_assets {
+
+// ════════════════════════════════════════════════════════════════════════════
+// PRIVATE STATE
+// ════════════════════════════════════════════════════════════════════════════
+
+static const size_t HASH_LEN = 16;             // Hex digits in a packed asset name
+static const size_t ETAG_LEN = HASH_LEN + 2;   // Quoted
+
+static bool s_available = false;
+static char s_index_etag[ETAG_LEN + 1] = "";
+static Stats s_stats = {};
+
+// httpd runs one handler at a time, so one staging block serves every send
+PSRAM_BSS static uint8_t s_chunk[SEND_CHUNK_BYTES];
+MEM_BUDGET_STATIC("http", s_chunk);
+
+struct MimeType {
+  const char* ext;
+  const char* type;
+};
+
+static const MimeType MIME_TYPES[] = {
+  { ".html", "text/html" },
+  { ".css",  "text/css" },
+  { ".js",   "application/javascript" },
+  { ".json", "application/json" },
+  { ".svg",  "image/svg+xml" },
+  { ".png",  "image/png" },
+  { ".ico",  "image/x-icon" },
+};
+
+static bool is_hex(char c) {
+  return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f');
+}
+
+// Plain asset paths only: rooted, short, [A-Za-z0-9._-/], no ".."
+static bool valid_path(const char* path, size_t len) {
+  if (len < 2 || len >= MAX_PATH_LEN || path[0] != '/') return false;
+  for (size_t i = 0; i < len; i++) {
+    char c = path[i];
+    bool ok = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+              (c >= '0' && c <= '9') || c == '.' || c == '-' || c == '_' || c == '/';
+    if (!ok) return false;
+    if (c == '.' && i + 1 < len && path[i + 1] == '.') return false;
+  }
+  return true;
+}
+
+static const char* mime_type(const char* path) {
+  const char* dot = strrchr(path, '.');
+  if (dot) {
+    for (const MimeType& m : MIME_TYPES) {
+      if (strcmp(dot, m.ext) == 0) return m.type;
+    }
+  }
+  return "application/octet-stream";
+}
+
+// The <hash> of ".../name.<hash>.ext", or nullptr if the name carries none
+static const char* content_hash(const char* path) {
+  const char* ext = strrchr(path, '.');
+  const char* slash = strrchr(path, '/');
+  if (!ext || !slash || ext - slash < (ptrdiff_t)(HASH_LEN + 2)) return nullptr;
+  const char* hash = ext - HASH_LEN;
+  if (hash[-1] != '.') return nullptr;
+  for (size_t i = 0; i < HASH_LEN; i++) {
+    if (!is_hex(hash[i])) return nullptr;
+  }
+  return hash;
+}
+
+// No Accept-Encoding means any coding is acceptable (RFC 9110 12.5.3).
+// Otherwise "gzip" must appear as a whole coding, and "gzip;q=0" refuses it.
+static bool accepts_gzip(httpd_req_t* req) {
+  if (httpd_req_get_hdr_value_len(req, "Accept-Encoding") == 0) return true;
+  char value[96];
+  esp_err_t err = httpd_req_get_hdr_value_str(req, "Accept-Encoding", value, sizeof(value));
+  // A truncated value is still NUL-terminated; match against what fits
+  if (err != ESP_OK && err != ESP_ERR_HTTPD_RESULT_TRUNC) return false;
+
+  const char* p = value;
+  while (*p) {
+    while (*p == ' ' || *p == '\t' || *p == ',') p++;
+    const char* start = p;
+    while (*p && *p != ',' && *p != ';') p++;
+    const char* end = p;
+    while (end > start && (end[-1] == ' ' || end[-1] == '\t')) end--;
+
+    bool refused = false;
+    while (*p == ';') {
+      p++;
+      while (*p == ' ' || *p == '\t') p++;
+      if ((p[0] == 'q' || p[0] == 'Q') && p[1] == '=') {
+        const char* q = p + 2;
+        refused = *q == '0';
+        for (q++; refused && *q && *q != ',' && *q != ';' && *q != ' '; q++) {
+          refused = *q == '.' || *q == '0';
+        }
+      }
+      while (*p && *p != ',' && *p != ';') p++;
+    }
+
+    if (!refused && end - start == 4 && strncasecmp(start, "gzip", 4) == 0) return true;
+  }
+  return false;
+}
+
+static bool header_has(httpd_req_t* req, const char* field, const char* token) {
+  char value[128];
+  if (httpd_req_get_hdr_value_str(req, field, value, sizeof(value)) != ESP_OK) return false;
+  return strstr(value, token) != nullptr;
+}
+
+enum RangeResult { RANGE_NONE, RANGE_OK, RANGE_UNSATISFIABLE };
+
+// One "bytes=first-last", "bytes=first-" or "bytes=-suffix" range. Anything
+// else, including multiple ranges, is ignored and the whole file is sent.
+static RangeResult parse_range(const char* v, size_t size, size_t* first, size_t* last) {
+  if (strncmp(v, "bytes=", 6) != 0 || strchr(v, ',')) return RANGE_NONE;
+  v += 6;
+
+  char* end;
+  if (*v == '-') {
+    unsigned long n = strtoul(v + 1, &end, 10);
+    if (end == v + 1 || *end) return RANGE_NONE;
+    if (n == 0 || size == 0) return RANGE_UNSATISFIABLE;
+    *first = n >= size ? 0 : size - n;
+    *last = size - 1;
+    return RANGE_OK;
+  }
+
+  unsigned long a = strtoul(v, &end, 10);
+  if (end == v || *end != '-') return RANGE_NONE;
+  const char* b_str = end + 1;
+  unsigned long b = size ? size - 1 : 0;
+  if (*b_str) {
+    b = strtoul(b_str, &end, 10);
+    if (end == b_str || *end || b < a) return RANGE_NONE;
+    if (size && b >= size) b = size - 1;
+  }
+  if (a >= size) return RANGE_UNSATISFIABLE;
+  *first = a;
+  *last = b;
+  return RANGE_OK;
+}
+
+static bool load_index_etag() {
+  char path[MAX_PATH_LEN + 16];
+  snprintf(path, sizeof(path), "%s%s", MOUNT_POINT, ETAG_PATH);
+  FILE* f = fopen(path, "rb");
+  if (!f) return false;
+  size_t n = fread(s_index_etag, 1, ETAG_LEN, f);
+  fclose(f);
+  s_index_etag[n == ETAG_LEN ? n : 0] = '\0';
+  return n == ETAG_LEN;
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// PUBLIC API
+// ════════════════════════════════════════════════════════════════════════════
+
+bool init() {
+  s_available = false;
+  if (!LittleFS.begin(false, MOUNT_POINT, 4, PARTITION_LABEL)) return false;
+
+  char path[MAX_PATH_LEN + 16];
+  snprintf(path, sizeof(path), "%s%s.gz", MOUNT_POINT, INDEX_PATH);
+  struct stat st;
+  if (stat(path, &st) != 0) return false;
+
+  if (!load_index_etag()) s_index_etag[0] = '\0';
+  s_available = true;
+  return true;
+}
+
+bool available() {
+  return s_available;
+}
+
+esp_err_t send_file(httpd_req_t* req, const char* path, const char* content_type) {
+  size_t path_len = strcspn(path, "?#");
+  if (!s_available || !valid_path(path, path_len)) return ESP_ERR_NOT_FOUND;
+  if (!accepts_gzip(req)) return ESP_ERR_NOT_FOUND;
+
+  char asset[MAX_PATH_LEN];
+  memcpy(asset, path, path_len);
+  asset[path_len] = '\0';
+
+  char fs_path[MAX_PATH_LEN + 16];
+  snprintf(fs_path, sizeof(fs_path), "%s%s.gz", MOUNT_POINT, asset);
+  FILE* f = fopen(fs_path, "rb");
+  if (!f) return ESP_ERR_NOT_FOUND;
+
+  struct stat st;
+  if (fstat(fileno(f), &st) != 0) {
+    fclose(f);
+    return ESP_ERR_NOT_FOUND;
+  }
+  size_t size = (size_t)st.st_size;
+
+  // Hashed names never change content; anything else revalidates
+  char etag[ETAG_LEN + 1] = "";
+  char cache_control[48];
+  const char* hash = content_hash(asset);
+  if (hash) {
+    snprintf(etag, sizeof(etag), "\"%.*s\"", (int)HASH_LEN, hash);
+    snprintf(cache_control, sizeof(cache_control), "public, max-age=%u, immutable",
+             (unsigned)IMMUTABLE_MAX_AGE_S);
+  } else {
+    if (strcmp(asset, INDEX_PATH) == 0) strcpy(etag, s_index_etag);
+    strcpy(cache_control, "no-cache");
+  }
+
+  httpd_resp_set_hdr(req, "Cache-Control", cache_control);
+  httpd_resp_set_hdr(req, "Vary", "Accept-Encoding");
+  if (etag[0]) {
+    httpd_resp_set_hdr(req, "ETag", etag);
+    if (header_has(req, "If-None-Match", etag)) {
+      fclose(f);
+      s_stats.not_modified++;
+      httpd_resp_set_status(req, "304 Not Modified");
+      return httpd_resp_send(req, nullptr, 0);
+    }
+  }
+
+  httpd_resp_set_type(req, content_type ? content_type : mime_type(asset));
+  httpd_resp_set_hdr(req, "Content-Encoding", "gzip");
+  httpd_resp_set_hdr(req, "Accept-Ranges", "bytes");
+
+  size_t first = 0;
+  size_t last = size ? size - 1 : 0;
+  bool partial = false;
+  char content_range[48];
+  char range[48];
+  if (httpd_req_get_hdr_value_str(req, "Range", range, sizeof(range)) == ESP_OK &&
+      (httpd_req_get_hdr_value_len(req, "If-Range") == 0 ||
+       (etag[0] && header_has(req, "If-Range", etag)))) {
+    RangeResult rr = parse_range(range, size, &first, &last);
+    if (rr == RANGE_UNSATISFIABLE) {
+      fclose(f);
+      snprintf(content_range, sizeof(content_range), "bytes */%u", (unsigned)size);
+      httpd_resp_set_status(req, "416 Range Not Satisfiable");
+      httpd_resp_set_hdr(req, "Content-Range", content_range);
+      return httpd_resp_send(req, nullptr, 0);
+    }
+    if (rr == RANGE_OK) {
+      partial = true;
+      snprintf(content_range, sizeof(content_range), "bytes %u-%u/%u",
+               (unsigned)first, (unsigned)last, (unsigned)size);
+      httpd_resp_set_status(req, "206 Partial Content");
+      httpd_resp_set_hdr(req, "Content-Range", content_range);
+    }
+  }
+
+  if (first > 0 && fseek(f, (long)first, SEEK_SET) != 0) {
+    fclose(f);
+    return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Seek failed");
+  }
+
+  esp_err_t err = ESP_OK;
+  size_t remaining = size ? last - first + 1 : 0;
+  while (remaining > 0) {
+    size_t want = remaining < SEND_CHUNK_BYTES ? remaining : SEND_CHUNK_BYTES;
+    size_t got = fread(s_chunk, 1, want, f);
+    if (got == 0) {
+      err = ESP_FAIL;
+      break;
+    }
+    err = httpd_resp_send_chunk(req, (const char*)s_chunk, got);
+    if (err != ESP_OK) break;
+    remaining -= got;
+    s_stats.bytes += got;
+  }
+  fclose(f);
+
+  if (err != ESP_OK) {
+    // Headers are out; ending the chunked body early is all that is left
+    httpd_resp_send_chunk(req, nullptr, 0);
+    return err;
+  }
+
+  s_stats.sent++;
+  if (partial) s_stats.partial++;
+  return httpd_resp_send_chunk(req, nullptr, 0);
+}
+
+esp_err_t handle_asset(httpd_req_t* req) {
+  esp_err_t err = send_file(req, req->uri);
+  if (err != ESP_ERR_NOT_FOUND) return err;
+  s_stats.not_found++;
+  return httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, nullptr);
+}
+
+Stats get_stats() {
+  return s_stats;
+}
+
+} // namespace ui_assets
@@ -0,0 +1,88 @@
+/*
+ * SecuraCV Canary — Web UI Assets on LittleFS
+ *
+ * scripts/pack_web_ui.py splits web_ui.h into a page shell plus a
+ * stylesheet and script named by content hash, gzips them and lays them
+ * out under data/ui/ for the LittleFS upload tool. The UI can then be
+ * reflashed without rebuilding the sketch, and a browser fetches each
+ * asset once:
+ *
+ *   /ui/app.<hash>.css|js   Cache-Control: immutable for a year; a new
+ *                           build has a new name, so nothing goes stale
+ *   /ui/index.html          no-cache with an ETag, so a repeat visit is
+ *                           a 304 with no body
+ *
+ * Files are stored gzipped and sent as-is with Content-Encoding: gzip;
+ * nothing is compressed on the device. A single "bytes=" Range is
+ * honoured (206 with Content-Range), counted over the stored gzip bytes.
+ * Bodies are read straight from the file in SEND_CHUNK_BYTES blocks and
+ * sent with chunked transfer encoding, so no buffer is sized to a file.
+ *
+ * When the partition is missing or empty, available() is false and GET /
+ * serves the CANARY_UI_HTML literal embedded in web_ui.h, which stays the
+ * source both are built from.
+ *
+ * Example usage:
+ *   ui_assets::init();
+ *   if (ui_assets::send_file(req, ui_assets::INDEX_PATH, "text/html") == ESP_ERR_NOT_FOUND)
+ *     return httpd_resp_send(req, CANARY_UI_HTML, HTTPD_RESP_USE_STRLEN);
+ */
+
+#ifndef SECURACV_UI_ASSETS_H
+#define SECURACV_UI_ASSETS_H
+
+#include <Arduino.h>
+#include "esp_http_server.h"
+
+namespace ui_assets {
+
+// ════════════════════════════════════════════════════════════════════════════
+// CONFIGURATION
+// ════════════════════════════════════════════════════════════════════════════
+
+static const char* const MOUNT_POINT     = "/littlefs";
+static const char* const PARTITION_LABEL = "spiffs";    // Data partition in the stock tables
+static const char* const INDEX_PATH      = "/ui/index.html";
+static const char* const ETAG_PATH       = "/ui/index.etag";
+
+static const size_t SEND_CHUNK_BYTES = 4096;            // Staging per httpd_resp_send_chunk()
+static const size_t MAX_PATH_LEN     = 64;              // Asset path, without MOUNT_POINT
+static const uint32_t IMMUTABLE_MAX_AGE_S = 31536000;   // One year
+
+// ════════════════════════════════════════════════════════════════════════════
+// TYPES
+// ════════════════════════════════════════════════════════════════════════════
+
+struct Stats {
+  uint32_t sent;               // 200 and 206 responses
+  uint32_t partial;            // Of which 206
+  uint32_t not_modified;       // 304 from If-None-Match
+  uint32_t not_found;
+  uint32_t bytes;              // Body bytes sent
+};
+
+// ════════════════════════════════════════════════════════════════════════════
+// API
+// ════════════════════════════════════════════════════════════════════════════
+
+// Mount the partition (never formats it). True if the packed index is there.
+bool init();
+
+// The partition holds a packed UI to serve
+bool available();
+
+// Send `path` (e.g. "/ui/app.1f2e3d4c5b6a7980.js") from the partition,
+// honouring If-None-Match and Range. content_type nullptr picks one by
+// extension. Returns ESP_ERR_NOT_FOUND, with nothing sent, when the file
+// is absent, the path is not a plain asset path, or the client refuses
+// gzip, so the caller can fall back.
+esp_err_t send_file(httpd_req_t* req, const char* path, const char* content_type = nullptr);
+
+// GET /ui/* handler: send_file() on the request path, 404 if absent
+esp_err_t handle_asset(httpd_req_t* req);
+
+Stats get_stats();
+
+} // namespace ui_assets
+
+#endif // SECURACV_UI_ASSETS_H
@@ -25,6 +25,8 @@
 #include <WiFi.h>
 #include <ESPmDNS.h>
 #include "esp_http_server.h"
+#include "rate_limiter.h"
+#include "ui_assets.h"
 
 // ════════════════════════════════════════════════════════════════════════════
 // CONFIGURATION
@@ -45,10 +47,7 @@ static const int   HTTP_PORT         = 80;
 static const int   HTTP_MAX_URI_LEN  = 512;
 static const int   HTTP_MAX_RESP_HDR = 512;
 
-// Rate limiting
-static const uint32_t RATE_LIMIT_WINDOW_MS = 60000;  // 1 minute window
-static const int      RATE_LIMIT_REQUESTS  = 120;    // Max requests per window
-static const int      RATE_LIMIT_ACTIONS   = 30;     // Max POST actions per window
+// Rate limiting: per-client token buckets, see rate_limiter.h
 
 // ════════════════════════════════════════════════════════════════════════════
 // TYPES
@@ -74,12 +73,6 @@ struct ServerStatus {
   uint32_t last_request_ms;
 };
 
-struct RateLimitEntry {
-  uint32_t window_start_ms;
-  uint16_t request_count;
-  uint16_t action_count;
-};
-
 // ════════════════════════════════════════════════════════════════════════════
 // API ENDPOINTS
 // ════════════════════════════════════════════════════════════════════════════
@@ -105,8 +98,9 @@ struct RateLimitEntry {
  * GET  /api/gps             - Current GPS status
  * GET  /api/time            - Time synchronization status
  *
- * POST /api/export          - Create export bundle
+ * POST /api/export          - Create export bundle (staged on SD)
  * GET  /api/export/download - Download export bundle
+ * GET  /api/export/stream   - Stream export bundle (no staging)
  *
  * GET  /api/config          - Get current configuration
  * POST /api/config          - Update configuration
@@ -164,16 +158,25 @@ bool stop_http_server();
 bool start_mdns(const char* hostname = nullptr);
 bool stop_mdns();
 
-// Rate limiting
-bool check_rate_limit(const char* client_ip, bool is_action = false);
-void reset_rate_limits();
+// Rate limiting, keyed by packed IPv4 (rate_limiter::client_ipv4())
+inline bool check_rate_limit(uint32_t client_ip, bool is_action = false) {
+  return rate_limiter::allow(client_ip, is_action);
+}
+inline void reset_rate_limits() { rate_limiter::reset(); }
 
 // Response helpers
 esp_err_t send_json_response(httpd_req_t* req, const char* json);
 esp_err_t send_json_error(httpd_req_t* req, int status_code, 
                           const char* error_code, const char* message);
-esp_err_t send_file_response(httpd_req_t* req, const char* path, 
-                             const char* content_type);
+// Packed UI asset from LittleFS (ui_assets::send_file()); ESP_ERR_NOT_FOUND
+// with nothing sent if the partition does not have it
+inline esp_err_t send_file_response(httpd_req_t* req, const char* path,
+                                    const char* content_type) {
+  return ui_assets::send_file(req, path, content_type);
+}
+// Chunked download of sd_storage::stream_export_bundle(). The last line
+// of the stream carries the SHA-256 of everything before it.
+esp_err_t send_export_stream(httpd_req_t* req, const char* start_date, const char* end_date);
 
 // Security helpers
 bool validate_request(httpd_req_t* req);
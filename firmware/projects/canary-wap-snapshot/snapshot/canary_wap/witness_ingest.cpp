@@ -0,0 +1,200 @@
+/*
+ * SecuraCV Canary — Witness Ingestion Service Implementation
+ *
+ * The writer sleeps on its task notification. Producers notify it for
+ * every urgent entry, for the first routine entry after the queue was
+ * empty (so it can time the batch) and when a routine batch fills; the
+ * wait otherwise ends when the oldest routine entry falls due.
+ */
+
+#include "witness_ingest.h"
+#include "mem_budget.h"
+
+namespace witness_ingest {
+
+// ════════════════════════════════════════════════════════════════════════════
+// PRIVATE STATE
+// ════════════════════════════════════════════════════════════════════════════
+
+struct Entry {
+  uint32_t submitted_ms;
+  uint16_t len;
+  uint8_t  type;
+  uint8_t  reserved;
+  uint8_t  payload[MAX_PAYLOAD];
+};
+
+// Internal DRAM: filled from radio callbacks (see mem_budget.h)
+static uint8_t s_urgent_storage[URGENT_DEPTH * sizeof(Entry)];
+static uint8_t s_routine_storage[ROUTINE_DEPTH * sizeof(Entry)];
+MEM_BUDGET_STATIC("witness", s_urgent_storage);
+MEM_BUDGET_STATIC("witness", s_routine_storage);
+
+static StaticQueue_t s_queue_buf[PRIORITY_COUNT];
+static QueueHandle_t s_queue[PRIORITY_COUNT] = { nullptr, nullptr };
+static TaskHandle_t s_writer_task = nullptr;
+static bool s_started = false;
+static RecordWriter s_writer = nullptr;
+
+// Producers on any task update the counters
+static portMUX_TYPE s_stats_mux = portMUX_INITIALIZER_UNLOCKED;
+static Stats s_stats;
+
+// Writer-owned scratch, so a max-size entry is not on the task stack
+static Entry s_entry;
+
+// ════════════════════════════════════════════════════════════════════════════
+// WRITER
+// ════════════════════════════════════════════════════════════════════════════
+
+static void write_entry(const Entry& e, Priority p) {
+  bool ok = s_writer(e.type, e.payload, e.len);
+  uint32_t latency = millis() - e.submitted_ms;
+
+  portENTER_CRITICAL(&s_stats_mux);
+  PriorityStats& st = s_stats.priority[p];
+  if (ok) {
+    st.written++;
+  } else {
+    st.failed++;
+  }
+  if (latency > st.latency_max_ms) st.latency_max_ms = latency;
+  portEXIT_CRITICAL(&s_stats_mux);
+}
+
+static void drain_urgent() {
+  while (xQueueReceive(s_queue[PRIORITY_URGENT], &s_entry, 0) == pdTRUE) {
+    write_entry(s_entry, PRIORITY_URGENT);
+  }
+}
+
+// Milliseconds until the routine queue is due (0 = now, UINT32_MAX = empty)
+static uint32_t routine_due_in(uint32_t now) {
+  if (uxQueueMessagesWaiting(s_queue[PRIORITY_ROUTINE]) >= ROUTINE_BATCH) return 0;
+  if (xQueuePeek(s_queue[PRIORITY_ROUTINE], &s_entry, 0) != pdTRUE) return UINT32_MAX;
+  uint32_t age = now - s_entry.submitted_ms;
+  return age >= ROUTINE_BATCH_MS ? 0 : ROUTINE_BATCH_MS - age;
+}
+
+// Write everything urgent, then the routine queue if its batch is due
+static void drain() {
+  drain_urgent();
+  if (routine_due_in(millis()) != 0) return;
+
+  bool any = false;
+  while (xQueueReceive(s_queue[PRIORITY_ROUTINE], &s_entry, 0) == pdTRUE) {
+    write_entry(s_entry, PRIORITY_ROUTINE);
+    any = true;
+    // A tamper alert arriving mid-batch does not wait for the rest
+    drain_urgent();
+  }
+  if (any) {
+    portENTER_CRITICAL(&s_stats_mux);
+    s_stats.batches++;
+    portEXIT_CRITICAL(&s_stats_mux);
+  }
+}
+
+static void writer_task(void*) {
+  for (;;) {
+    uint32_t due = routine_due_in(millis());
+    TickType_t wait = due == UINT32_MAX ? portMAX_DELAY : pdMS_TO_TICKS(due);
+    ulTaskNotifyTake(pdTRUE, wait);
+    drain();
+  }
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// PUBLIC API
+// ════════════════════════════════════════════════════════════════════════════
+
+bool init(RecordWriter writer) {
+  if (s_queue[PRIORITY_URGENT] || !writer) return false;
+  s_writer = writer;
+  memset(&s_stats, 0, sizeof(s_stats));
+
+  s_queue[PRIORITY_URGENT] = xQueueCreateStatic(URGENT_DEPTH, sizeof(Entry),
+                                                s_urgent_storage, &s_queue_buf[PRIORITY_URGENT]);
+  s_queue[PRIORITY_ROUTINE] = xQueueCreateStatic(ROUTINE_DEPTH, sizeof(Entry),
+                                                 s_routine_storage, &s_queue_buf[PRIORITY_ROUTINE]);
+  if (!s_queue[PRIORITY_URGENT] || !s_queue[PRIORITY_ROUTINE]) {
+    s_queue[PRIORITY_URGENT] = s_queue[PRIORITY_ROUTINE] = nullptr;
+    return false;
+  }
+  return true;
+}
+
+void start() {
+  if (!s_queue[PRIORITY_URGENT] || s_started) return;
+  s_started = true;
+
+  if (xTaskCreate(writer_task, "witness_ingest", WRITER_TASK_STACK, nullptr,
+                  WRITER_TASK_PRIORITY, &s_writer_task) != pdPASS) {
+    s_writer_task = nullptr;
+    Serial.println("[!!] Witness writer task failed; records are written from loop()");
+  }
+  s_stats.writer_running = s_writer_task != nullptr;
+
+  // Anything queued during setup() has been waiting for this
+  if (s_writer_task) xTaskNotifyGive(s_writer_task);
+}
+
+bool submit(uint8_t type, Priority priority, const uint8_t* payload, size_t len) {
+  if (priority >= PRIORITY_COUNT) return false;
+  QueueHandle_t q = s_queue[priority];
+
+  Entry e;
+  bool ok = q && payload && len <= MAX_PAYLOAD;
+  if (ok) {
+    e.submitted_ms = millis();
+    e.len = (uint16_t)len;
+    e.type = type;
+    e.reserved = 0;
+    memcpy(e.payload, payload, len);
+    ok = xQueueSend(q, &e, 0) == pdTRUE;
+  }
+
+  UBaseType_t depth = q ? uxQueueMessagesWaiting(q) : 0;
+  portENTER_CRITICAL(&s_stats_mux);
+  PriorityStats& st = s_stats.priority[priority];
+  st.submitted++;
+  if (!ok) st.dropped++;
+  if (depth > st.depth_peak) st.depth_peak = depth;
+  portEXIT_CRITICAL(&s_stats_mux);
+
+  if (ok && s_writer_task &&
+      (priority == PRIORITY_URGENT || depth == 1 || depth >= ROUTINE_BATCH)) {
+    xTaskNotifyGive(s_writer_task);
+  }
+  return ok;
+}
+
+void poll() {
+  if (s_writer_task || !s_started) return;
+  drain();
+}
+
+bool writer_running() {
+  return s_writer_task != nullptr;
+}
+
+Stats get_stats() {
+  Stats out;
+  portENTER_CRITICAL(&s_stats_mux);
+  out = s_stats;
+  portEXIT_CRITICAL(&s_stats_mux);
+  for (size_t p = 0; p < PRIORITY_COUNT; p++) {
+    out.priority[p].depth = s_queue[p] ? uxQueueMessagesWaiting(s_queue[p]) : 0;
+  }
+  return out;
+}
+
+const char* priority_name(Priority p) {
+  switch (p) {
+    case PRIORITY_URGENT:  return "urgent";
+    case PRIORITY_ROUTINE: return "routine";
+    default:               return "unknown";
+  }
+}
+
+} // namespace witness_ingest
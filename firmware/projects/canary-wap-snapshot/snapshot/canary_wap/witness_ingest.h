@@ -0,0 +1,113 @@
+/*
+ * SecuraCV Canary — Witness Ingestion Service
+ *
+ * Every witness record source (the GPS timer in loop(), state transitions,
+ * opera alerts from the mesh callbacks, and RF presence or vision events
+ * when those are wired) submits its payload here instead of creating the
+ * record itself. submit() copies the payload into one of two FreeRTOS
+ * queues and returns at once, so it is safe from any task and a burst
+ * never blocks a radio callback.
+ *
+ * A single writer task drains the queues and is the only code that
+ * extends the chain (g_device.seq, chain_head) once start() has run:
+ *
+ *   PRIORITY_URGENT   Tamper alerts. Served as soon as they arrive, and
+ *                     checked again between every routine record.
+ *   PRIORITY_ROUTINE  Telemetry. Held until ROUTINE_BATCH records are
+ *                     waiting or the oldest is ROUTINE_BATCH_MS old, then
+ *                     written back to back.
+ *
+ * Within a priority, records keep submission order. A full queue drops
+ * the new entry and counts it (get_stats()); nothing waits for space.
+ *
+ * init() comes early in setup(), so producers registered before the boot
+ * attestation can already queue; start() hands the chain to the writer
+ * once setup() has made the boot record directly. If the writer task
+ * cannot be created, poll() drains the queues from loop() instead, which
+ * keeps a single writer.
+ *
+ * Example usage:
+ *   witness_ingest::init(write_ingested_record);
+ *   ...boot attestation...
+ *   witness_ingest::start();
+ *   ...
+ *   witness_ingest::submit(RECORD_TAMPER_ALERT, witness_ingest::PRIORITY_URGENT,
+ *                          payload, payload_len);
+ */
+
+#ifndef SECURACV_WITNESS_INGEST_H
+#define SECURACV_WITNESS_INGEST_H
+
+#include <Arduino.h>
+
+namespace witness_ingest {
+
+// ════════════════════════════════════════════════════════════════════════════
+// CONFIGURATION
+// ════════════════════════════════════════════════════════════════════════════
+
+static const size_t   MAX_PAYLOAD         = 320;    // Largest CBOR payload accepted
+static const size_t   URGENT_DEPTH        = 4;
+static const size_t   ROUTINE_DEPTH       = 16;
+static const size_t   ROUTINE_BATCH       = 4;      // Write routine records in runs of this
+static const uint32_t ROUTINE_BATCH_MS    = 2000;   // ...or once the oldest waited this long
+static const uint32_t WRITER_TASK_STACK   = 8192;   // Ed25519 sign + verify
+static const UBaseType_t WRITER_TASK_PRIORITY = 3;  // Above loop() (1)
+
+// ════════════════════════════════════════════════════════════════════════════
+// TYPES
+// ════════════════════════════════════════════════════════════════════════════
+
+enum Priority : uint8_t {
+  PRIORITY_URGENT  = 0,
+  PRIORITY_ROUTINE = 1,
+  PRIORITY_COUNT
+};
+
+// Creates, signs and stores one record on the writer task. type is the
+// sketch's RecordType. Returns false if the record could not be made.
+typedef bool (*RecordWriter)(uint8_t type, const uint8_t* payload, size_t len);
+
+struct PriorityStats {
+  uint32_t submitted;
+  uint32_t written;
+  uint32_t failed;           // Writer returned false
+  uint32_t dropped;          // Queue full or payload too large
+  uint32_t depth;            // Waiting now
+  uint32_t depth_peak;
+  uint32_t latency_max_ms;   // Longest submit-to-written time
+};
+
+struct Stats {
+  PriorityStats priority[PRIORITY_COUNT];
+  uint32_t batches;          // Routine runs written
+  bool     writer_running;
+};
+
+// ════════════════════════════════════════════════════════════════════════════
+// PUBLIC API
+// ════════════════════════════════════════════════════════════════════════════
+
+// Create the queues; submit() works from here on, nothing is written yet
+bool init(RecordWriter writer);
+
+// Start the writer task. Records created before this (boot attestation)
+// are made directly; after it, only through submit().
+void start();
+
+// Queue a record from any task without blocking. The payload is copied.
+bool submit(uint8_t type, Priority priority, const uint8_t* payload, size_t len);
+
+// Drain the queues on the caller when the writer task is not running.
+// Call from loop(); does nothing while the task runs.
+void poll();
+
+bool writer_running();
+
+Stats get_stats();
+
+const char* priority_name(Priority p);
+
+} // namespace witness_ingest
+
+#endif // SECURACV_WITNESS_INGEST_H